@@ -78,6 +78,9 @@ typedef struct sgw_pdn_connection_s {
   // NOT NEEDED s_gw_gre_key_for_dl_traffic_up         ///< user plane for downlink traffic. (For PMIP-based S5/S8 only)
   ebi_t                default_bearer;                 ///< Identifies the default bearer within the PDN connection by its EPS Bearer Id. (For PMIP based S5/S8.)
 
+  // UE IPv4 address pool selected for this APN
+  int                  ue_ipv4_pool_id;
+
   // eps bearers
   hash_table_ts_t     *sgw_eps_bearers;
 
@@ -36,6 +36,8 @@
 #include <string.h>
 #include <errno.h>
 #include <signal.h>
+#include <sched.h>
+#include <time.h>
 
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
@@ -79,6 +81,16 @@ const int                               itti_debug = ITTI_DEBUG_ISSUES | ITTI_DE
 /* Global message size */
 #define MESSAGE_SIZE(mESSAGEiD) (sizeof(MessageHeader) + itti_desc.messages_info[mESSAGEiD].size)
 
+/* Busy-poll: epoll_wait is called every ITTI_BUSY_POLL_EPOLL_PERIOD spins to catch the
+   subscribed fds, at once when a message is counted in the task queue */
+#define ITTI_BUSY_POLL_EPOLL_PERIOD (32)
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define ITTI_CPU_RELAX() __asm__ __volatile__ ("pause" ::: "memory")
+#else
+#  define ITTI_CPU_RELAX() __sync_synchronize ()
+#endif
+
 #define VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME(...)
 #define VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(...)
 #define VCD_SIGNAL_DUMPER_FUNCTIONS_ITTI_ENQUEUE_MESSAGE(...)
@@ -93,6 +105,7 @@ typedef struct message_list_s {
 
   message_number_t                        message_number;       ///< Unique message number
   uint32_t                                message_priority;     ///< Message priority
+  uint64_t                                enqueue_time_us;      ///< Monotonic time of enqueue, for the queueing delay
 } message_list_t;
 
 typedef struct thread_desc_s {
@@ -143,6 +156,18 @@ typedef struct thread_desc_s {
    */
   unsigned                                messages_pending;
   //#endif
+
+  /*
+   * Placement: CPUs (none set: all CPUs) and SCHED_FIFO priority (0: default scheduling)
+   */
+  cpu_set_t                               cpus;
+  int                                     rt_priority;
+
+  /*
+   * Busy-poll before blocking in epoll_wait: configured maximum and current adaptive window
+   */
+  uint32_t                                busy_poll_us;
+  uint32_t                                busy_poll_window_us;
 } thread_desc_t;
 
 typedef struct task_desc_s {
@@ -150,6 +175,13 @@ typedef struct task_desc_s {
    * Queue of messages belonging to the task
    */
   struct lfds611_queue_state             *message_queue;
+
+  /*
+   * Load of the task, read by overload control: messages waiting in the queue
+   * and moving average of the time they wait there (updated by the task only)
+   */
+  volatile uint32_t                       queue_depth;
+  volatile uint32_t                       queue_delay_us;
 } task_desc_t;
 
 typedef struct itti_desc_s {
@@ -188,6 +220,155 @@ typedef struct itti_desc_s {
 
 static itti_desc_t                      itti_desc;
 
+//------------------------------------------------------------------------------
+static inline uint64_t itti_get_monotonic_us (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+// Called by the task owning the queue when it dequeues a message
+static inline void itti_update_queue_load (task_id_t task_id, const message_list_t * const message)
+{
+  task_desc_t                            *task = &itti_desc.tasks[task_id];
+  const uint64_t                          now = itti_get_monotonic_us ();
+  const uint32_t                          delay = (now > message->enqueue_time_us) ? (uint32_t)(now - message->enqueue_time_us) : 0;
+
+  __sync_fetch_and_sub (&task->queue_depth, 1);
+  // moving average with a 1/8 weight for the new sample
+  task->queue_delay_us = task->queue_delay_us - (task->queue_delay_us >> 3) + (delay >> 3);
+}
+
+//------------------------------------------------------------------------------
+uint32_t itti_get_task_queue_depth (task_id_t task_id)
+{
+  AssertFatal (task_id < itti_desc.task_max, "Task id (%d) is out of range (%d)!\n", task_id, itti_desc.task_max);
+  return itti_desc.tasks[task_id].queue_depth;
+}
+
+//------------------------------------------------------------------------------
+uint32_t itti_get_task_queue_delay (task_id_t task_id)
+{
+  AssertFatal (task_id < itti_desc.task_max, "Task id (%d) is out of range (%d)!\n", task_id, itti_desc.task_max);
+  // an idle task keeps its last average, report no delay when nothing is waiting
+  return (itti_desc.tasks[task_id].queue_depth) ? itti_desc.tasks[task_id].queue_delay_us : 0;
+}
+
+//------------------------------------------------------------------------------
+// "0-3,8,10-11" to a CPU set, fails on an empty set
+static int itti_parse_cpu_list (const char * const cpu_list, cpu_set_t * const cpus)
+{
+  const char                             *p = cpu_list;
+
+  CPU_ZERO (cpus);
+  while (*p) {
+    char                                   *end = NULL;
+    long                                    first = strtol (p, &end, 10);
+    long                                    last = first;
+
+    if ((end == p) || (first < 0)) {
+      return -1;
+    }
+    p = end;
+    if ('-' == *p) {
+      p++;
+      last = strtol (p, &end, 10);
+      if ((end == p) || (last < first)) {
+        return -1;
+      }
+      p = end;
+    }
+    if (last >= CPU_SETSIZE) {
+      return -1;
+    }
+    for (long cpu = first; cpu <= last; cpu++) {
+      CPU_SET (cpu, cpus);
+    }
+    while (' ' == *p) {
+      p++;
+    }
+    if (',' == *p) {
+      p++;
+    } else if (*p) {
+      return -1;
+    }
+    while (' ' == *p) {
+      p++;
+    }
+  }
+  return (CPU_COUNT (cpus) > 0) ? 0 : -1;
+}
+
+//------------------------------------------------------------------------------
+// Placement of a thread already running, its queue stays where it was allocated
+static int itti_apply_thread_placement (thread_id_t thread_id)
+{
+  thread_desc_t                          *thread = &itti_desc.threads[thread_id];
+  struct sched_param                      param = {.sched_priority = thread->rt_priority};
+  int                                     result = 0;
+
+  if (CPU_COUNT (&thread->cpus)) {
+    result = pthread_setaffinity_np (thread->task_thread, sizeof (cpu_set_t), &thread->cpus);
+    if (result) {
+      OAILOG_ERROR (LOG_ITTI, "Failed to set the CPUs of thread %d: %s\n", thread_id, strerror (result));
+      return -1;
+    }
+  }
+  result = pthread_setschedparam (thread->task_thread, (thread->rt_priority) ? SCHED_FIFO : SCHED_OTHER, &param);
+  if (result) {
+    OAILOG_ERROR (LOG_ITTI, "Failed to set the real time priority %d of thread %d: %s\n", thread->rt_priority, thread_id, strerror (result));
+    return -1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int itti_set_task_placement (task_id_t task_id, const char * const cpu_list, const int rt_priority, const uint32_t busy_poll_us)
+{
+  thread_id_t                             thread_id;
+  thread_desc_t                          *thread = NULL;
+  cpu_set_t                               cpus;
+
+  AssertFatal (task_id < itti_desc.task_max, "Task id (%d) is out of range (%d)!\n", task_id, itti_desc.task_max);
+  thread_id = TASK_GET_THREAD_ID (task_id);
+  thread = &itti_desc.threads[thread_id];
+  CPU_ZERO (&cpus);
+  if ((cpu_list) && (cpu_list[0]) && (itti_parse_cpu_list (cpu_list, &cpus) < 0)) {
+    OAILOG_ERROR (LOG_ITTI, "Bad CPU list \"%s\" for task %s\n", cpu_list, itti_get_task_name (task_id));
+    return -1;
+  }
+  if ((rt_priority < 0) || (rt_priority > sched_get_priority_max (SCHED_FIFO))) {
+    OAILOG_ERROR (LOG_ITTI, "Bad real time priority %d for task %s\n", rt_priority, itti_get_task_name (task_id));
+    return -1;
+  }
+  thread->cpus = cpus;
+  thread->rt_priority = rt_priority;
+  thread->real_time = (rt_priority > 0);
+  thread->busy_poll_us = busy_poll_us;
+  thread->busy_poll_window_us = busy_poll_us;
+  OAILOG_INFO (LOG_ITTI, "Task %s placed on CPUs \"%s\", real time priority %d, busy-poll %u us\n",
+      itti_get_task_name (task_id), ((cpu_list) && (cpu_list[0])) ? cpu_list : "all", rt_priority, busy_poll_us);
+  if (TASK_STATE_NOT_CONFIGURED != thread->task_state) {
+    return itti_apply_thread_placement (thread_id);
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int itti_set_task_placement_by_name (const char * const task_name, const char * const cpu_list, const int rt_priority, const uint32_t busy_poll_us)
+{
+  for (task_id_t task_id = TASK_FIRST; task_id < itti_desc.task_max; task_id++) {
+    if (0 == strcmp (itti_desc.tasks_info[task_id].name, task_name)) {
+      return itti_set_task_placement (task_id, cpu_list, rt_priority, busy_poll_us);
+    }
+  }
+  OAILOG_ERROR (LOG_ITTI, "Unknown task %s\n", task_name);
+  return -1;
+}
+
 void                                   *
 itti_malloc (
   task_id_t origin_task_id,
@@ -263,7 +444,7 @@ itti_get_task_name (
   return (itti_desc.tasks_info[task_id].name);
 }
 
-static                                  task_id_t
+task_id_t
 itti_get_current_task_id (
   void)
 {
@@ -431,9 +612,11 @@ itti_send_msg_to_task (
       new->msg = message;
       new->message_number = message_number;
       new->message_priority = priority;
+      new->enqueue_time_us = itti_get_monotonic_us ();
       /*
        * Enqueue message in destination task queue
        */
+      __sync_fetch_and_add (&itti_desc.tasks[destination_task_id].queue_depth, 1);
       lfds611_queue_enqueue (itti_desc.tasks[destination_task_id].message_queue, new);
       VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME (VCD_SIGNAL_DUMPER_FUNCTIONS_ITTI_ENQUEUE_MESSAGE, VCD_FUNCTION_OUT);
       {
@@ -472,6 +655,15 @@ void
 itti_subscribe_event_fd (
   task_id_t task_id,
   int fd)
+{
+  itti_subscribe_event_fd_events (task_id, fd, EPOLLIN | EPOLLERR);
+}
+
+void
+itti_subscribe_event_fd_events (
+  task_id_t task_id,
+  int fd,
+  uint32_t events)
 {
   thread_id_t                             thread_id;
   struct epoll_event                      event;
@@ -483,7 +675,7 @@ itti_subscribe_event_fd (
    * Reallocate the events
    */
   itti_desc.threads[thread_id].events = realloc (itti_desc.threads[thread_id].events, itti_desc.threads[thread_id].nb_events * sizeof (struct epoll_event));
-  event.events = EPOLLIN | EPOLLERR;
+  event.events = events;
   event.data.u64 = 0;
   event.data.fd = fd;
 
@@ -538,6 +730,38 @@ itti_get_events (
   return itti_desc.threads[thread_id].epoll_nb_events;
 }
 
+//------------------------------------------------------------------------------
+// Spins up to the busy-poll window of the thread for a message or a subscribed fd. The window
+// is doubled (up to busy_poll_us) when something comes while spinning and halved otherwise, so
+// that a task with sparse traffic soon goes back to blocking in epoll_wait.
+static int itti_busy_poll (task_id_t task_id, thread_desc_t * const thread)
+{
+  const uint64_t                          deadline = itti_get_monotonic_us () + thread->busy_poll_window_us;
+  const uint32_t                          min_window_us = (thread->busy_poll_us >> 4) ? (thread->busy_poll_us >> 4) : 1;
+  uint32_t                                spins = 0;
+  int                                     epoll_ret = 0;
+
+  do {
+    // the queue depth is counted before the event fd is written
+    if ((itti_desc.tasks[task_id].queue_depth) || (0 == (++spins % ITTI_BUSY_POLL_EPOLL_PERIOD))) {
+      epoll_ret = epoll_wait (thread->epoll_fd, thread->events, thread->nb_events, 0);
+      if ((epoll_ret < 0) && (EINTR == errno)) {
+        epoll_ret = 0;
+      } else if (epoll_ret != 0) {
+        break;
+      }
+    }
+    ITTI_CPU_RELAX ();
+  } while (itti_get_monotonic_us () < deadline);
+
+  if (epoll_ret > 0) {
+    thread->busy_poll_window_us = ((thread->busy_poll_window_us << 1) < thread->busy_poll_us) ? (thread->busy_poll_window_us << 1) : thread->busy_poll_us;
+  } else if (0 == epoll_ret) {
+    thread->busy_poll_window_us = ((thread->busy_poll_window_us >> 1) > min_window_us) ? (thread->busy_poll_window_us >> 1) : min_window_us;
+  }
+  return epoll_ret;
+}
+
 static inline void
 itti_receive_msg_internal_event_fd (
   task_id_t task_id,
@@ -567,9 +791,15 @@ itti_receive_msg_internal_event_fd (
     epoll_timeout = -1;
   }
 
-  do {
-    epoll_ret = epoll_wait (itti_desc.threads[thread_id].epoll_fd, itti_desc.threads[thread_id].events, itti_desc.threads[thread_id].nb_events, epoll_timeout);
-  } while (epoll_ret < 0 && errno == EINTR);
+  if ((!polling) && (itti_desc.threads[thread_id].busy_poll_us)) {
+    epoll_ret = itti_busy_poll (task_id, &itti_desc.threads[thread_id]);
+  }
+
+  if (0 == epoll_ret) {
+    do {
+      epoll_ret = epoll_wait (itti_desc.threads[thread_id].epoll_fd, itti_desc.threads[thread_id].events, itti_desc.threads[thread_id].nb_events, epoll_timeout);
+    } while (epoll_ret < 0 && errno == EINTR);
+  }
 
   if (epoll_ret < 0) {
     AssertFatal (0, "epoll_wait failed for task %s: %s!\n", itti_get_task_name (task_id), strerror (errno));
@@ -608,6 +838,7 @@ itti_receive_msg_internal_event_fd (
       }
 
       AssertFatal (message != NULL, "Message from message queue is NULL!\n");
+      itti_update_queue_load (task_id, message);
       *received_msg = message->msg;
       result = itti_free (ITTI_MSG_ORIGIN_ID (message->msg), message);
       AssertFatal (result == EXIT_SUCCESS, "Failed to free memory (%d)!\n", result);
@@ -644,6 +875,7 @@ itti_poll_msg (
     if (lfds611_queue_dequeue (itti_desc.tasks[task_id].message_queue, (void **)&message) == 1) {
       int                                     result;
 
+      itti_update_queue_load (task_id, message);
       *received_msg = message->msg;
       result = itti_free (ITTI_MSG_ORIGIN_ID (*received_msg), message);
       AssertFatal (result == EXIT_SUCCESS, "Failed to free memory (%d)!\n", result);
@@ -670,19 +902,38 @@ itti_create_task (
   AssertFatal (itti_desc.threads[thread_id].task_state == TASK_STATE_NOT_CONFIGURED, "Task %d, thread %d state is not correct (%d)!\n", task_id, thread_id, itti_desc.threads[thread_id].task_state);
   itti_desc.threads[thread_id].task_state = TASK_STATE_STARTING;
   ITTI_DEBUG (ITTI_DEBUG_INIT, " Creating thread for task %s ...\n", itti_get_task_name (task_id));
-#if ITTI_TASK_STACK_SIZE
-  pthread_attr_t                          attr = {.__align = 0};
-  result = pthread_attr_init(&attr);
+  pthread_attr_t                          attr;
+  thread_desc_t                          *thread = &itti_desc.threads[thread_id];
+
+  result = pthread_attr_init (&attr);
   AssertFatal (result == 0, "Thread attributes for task %d, thread %d init failed (%d)!\n", task_id, thread_id, result);
-  result = pthread_attr_setstacksize(&attr, ITTI_TASK_STACK_SIZE);
-  result = pthread_create (&itti_desc.threads[thread_id].task_thread, NULL, start_routine, args_p);
-  AssertFatal (result >= 0, "Thread creation for task %d, thread %d failed (%d)!\n", task_id, thread_id, result);
-  result = pthread_attr_destroy(&attr);
-  AssertFatal (result == 0, "Thread attributes for task %d, thread %d destroy failed (%d)!\n", task_id, thread_id, result);
-#else
-  result = pthread_create (&itti_desc.threads[thread_id].task_thread, NULL, start_routine, args_p);
-  AssertFatal (result >= 0, "Thread creation for task %d, thread %d failed (%d)!\n", task_id, thread_id, result);
+#if ITTI_TASK_STACK_SIZE
+  result = pthread_attr_setstacksize (&attr, ITTI_TASK_STACK_SIZE);
+  AssertFatal (result == 0, "Thread stack size for task %d, thread %d failed (%d)!\n", task_id, thread_id, result);
 #endif
+  if (CPU_COUNT (&thread->cpus)) {
+    result = pthread_attr_setaffinity_np (&attr, sizeof (cpu_set_t), &thread->cpus);
+    AssertFatal (result == 0, "Thread CPUs for task %d, thread %d failed (%d)!\n", task_id, thread_id, result);
+  }
+  if (thread->real_time) {
+    struct sched_param                    param = {.sched_priority = (thread->rt_priority) ? thread->rt_priority : ITTI_TASK_REAL_TIME_PRIORITY};
+
+    pthread_attr_setinheritsched (&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy (&attr, SCHED_FIFO);
+    pthread_attr_setschedparam (&attr, &param);
+  }
+  result = pthread_create (&thread->task_thread, &attr, start_routine, args_p);
+  if ((EPERM == result) && (thread->real_time)) {
+    // no CAP_SYS_NICE: keep the task, without its real time priority
+    OAILOG_WARNING (LOG_ITTI, "Not allowed to give task %s a real time priority, default scheduling used\n", itti_get_task_name (task_id));
+    thread->real_time = false;
+    thread->rt_priority = 0;
+    pthread_attr_setinheritsched (&attr, PTHREAD_INHERIT_SCHED);
+    result = pthread_create (&thread->task_thread, &attr, start_routine, args_p);
+  }
+  AssertFatal (result == 0, "Thread creation for task %d, thread %d failed (%d)!\n", task_id, thread_id, result);
+  result = pthread_attr_destroy (&attr);
+  AssertFatal (result == 0, "Thread attributes for task %d, thread %d destroy failed (%d)!\n", task_id, thread_id, result);
   char                                    name[16];
 
   snprintf (name, sizeof (name), "ITTI %d", thread_id);
@@ -705,6 +956,7 @@ itti_set_task_real_time (
   thread_id_t                             thread_id = TASK_GET_THREAD_ID (task_id);
 
   DevCheck (thread_id < itti_desc.thread_max, thread_id, itti_desc.thread_max, 0);
+  // applied by itti_create_task
   itti_desc.threads[thread_id].real_time = true;
 }
 
@@ -731,6 +983,16 @@ itti_mark_task_ready (
 #if ENABLE_ITTI_ANALYZER
   itti_dump_thread_use_ring_buffer ();
 #endif
+  if (CPU_COUNT (&itti_desc.threads[thread_id].cpus)) {
+    /*
+     * Pinned thread: its queue is allocated again by the thread itself, the first
+     * touch puts it on the NUMA node of its CPUs. Nothing is queued before the
+     * task is ready.
+     */
+    lfds611_queue_delete (itti_desc.tasks[task_id].message_queue, NULL, NULL);
+    AssertFatal (lfds611_queue_new (&itti_desc.tasks[task_id].message_queue, itti_desc.tasks_info[task_id].queue_size),
+        "lfds611_queue_new failed for task %s!\n", itti_get_task_name (task_id));
+  }
   /*
    * Mark the thread as using LFDS queue
    */
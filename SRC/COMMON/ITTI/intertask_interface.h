@@ -120,6 +120,18 @@ int itti_send_broadcast_message(MessageDef *message_p);
  **/
 int itti_send_msg_to_task(task_id_t task_id, instance_t instance, MessageDef *message);
 
+/** \brief Number of messages waiting in the queue of a task
+ *  \param task_id Task ID
+ *  @returns the queue depth
+ **/
+uint32_t itti_get_task_queue_depth(task_id_t task_id);
+
+/** \brief Moving average of the time spent by messages in the queue of a task
+ *  \param task_id Task ID
+ *  @returns the queueing delay in micro seconds, 0 if the queue is empty
+ **/
+uint32_t itti_get_task_queue_delay(task_id_t task_id);
+
 /** \brief Add a new fd to monitor.
  * NOTE: it is up to the user to read data associated with the fd
  *  \param task_id Task ID of the receiving task
@@ -127,6 +139,13 @@ int itti_send_msg_to_task(task_id_t task_id, instance_t instance, MessageDef *me
  **/
 void itti_subscribe_event_fd(task_id_t task_id, int fd);
 
+/** \brief Add a new fd to monitor for the given epoll events (EPOLLOUT...).
+ *  \param task_id Task ID of the receiving task
+ *  \param fd The file descriptor to monitor
+ *  \param events The epoll events to monitor
+ **/
+void itti_subscribe_event_fd_events(task_id_t task_id, int fd, uint32_t events);
+
 /** \brief Remove a fd from the list of fd to monitor
  *  \param task_id Task ID of the task
  *  \param fd The file descriptor to remove
@@ -164,12 +183,31 @@ int itti_create_task(task_id_t task_id,
                      void *args_p);
 
 //#ifdef RTAI
-/** \brief Mark the task as a real time task
+/** \brief Mark the task as a real time task, scheduled SCHED_FIFO with ITTI_TASK_REAL_TIME_PRIORITY
+ *         unless itti_set_task_placement gave it a priority. Must be called before itti_create_task.
  * \param task_id task to mark as real time
  **/
 void itti_set_task_real_time(task_id_t task_id);
 //#endif
 
+#define ITTI_TASK_REAL_TIME_PRIORITY  (50)
+
+/** \brief Place the thread of a task. Called before itti_create_task, it applies to the thread
+ *         from its creation (the task queue is then allocated by the thread, on its NUMA node);
+ *         called later, CPUs and priority are changed on the running thread.
+ * \param task_id task to place
+ * \param cpu_list CPUs the thread may run on, as "0-3,8", NULL or "" for all CPUs
+ * \param rt_priority SCHED_FIFO priority, 0 for default scheduling
+ * \param busy_poll_us longest time itti_receive_msg spins on the queue and fds before blocking, 0 to block at once
+ * @returns -1 on failure, 0 otherwise
+ **/
+int itti_set_task_placement(task_id_t task_id, const char * const cpu_list, const int rt_priority, const uint32_t busy_poll_us);
+
+/** \brief Same as itti_set_task_placement, the task is given by its name in tasks_def.h ("TASK_S1AP")
+ * @returns -1 on failure (unknown task included), 0 otherwise
+ **/
+int itti_set_task_placement_by_name(const char * const task_name, const char * const cpu_list, const int rt_priority, const uint32_t busy_poll_us);
+
 /** \brief Indicates to ITTI if newly created tasks should wait for all tasks to be ready
  * \param wait_tasks non 0 to make new created tasks to wait, 0 to let created tasks to run
  **/
@@ -199,6 +237,11 @@ const char *itti_get_message_name(MessagesIds message_id);
  **/
 const char *itti_get_task_name(task_id_t task_id);
 
+/** \brief Return the id of the task running in the calling thread
+ * \return TASK_UNKNOWN if the calling thread is not an ITTI task
+ **/
+task_id_t itti_get_current_task_id(void);
+
 /** \brief Alloc and memset(0) a new itti message.
  * \param origin_task_id Task ID of the sending task
  * \param message_id Message ID
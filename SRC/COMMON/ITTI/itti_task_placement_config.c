@@ -0,0 +1,98 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file itti_task_placement_config.c
+  \brief TASK_PLACEMENT list of the INTERTASK_INTERFACE section, shared by the node configurations
+*/
+
+#include <stdint.h>
+#include <libconfig.h>
+
+#include "bstrlib.h"
+#include "common_defs.h"
+#include "assertions.h"
+#include "log.h"
+#include "intertask_interface.h"
+#include "itti_task_placement_config.h"
+
+#ifdef LIBCONFIG_LONG
+#  define libconfig_int long
+#else
+#  define libconfig_int int
+#endif
+
+//------------------------------------------------------------------------------
+void itti_task_placements_config_parse (const struct config_setting_t * const itti_setting, itti_task_placements_config_t * const config)
+{
+  config_setting_t                       *placements = config_setting_get_member (itti_setting, ITTI_CONFIG_STRING_TASK_PLACEMENT);
+  const char                             *astring = NULL;
+  int                                     num = 0;
+
+  if (!placements) {
+    return;
+  }
+  num = config_setting_length (placements);
+  AssertFatal (ITTI_TASK_PLACEMENT_CONFIG_MAX >= num, "Too many %s entries %d, max %d\n", ITTI_CONFIG_STRING_TASK_PLACEMENT, num, ITTI_TASK_PLACEMENT_CONFIG_MAX);
+  for (int i = 0; i < num; i++) {
+    config_setting_t                     *placement_setting = config_setting_get_elem (placements, i);
+    itti_task_placement_config_t         *placement = &config->task_placement[i];
+    libconfig_int                         aint = 0;
+
+    AssertFatal (config_setting_lookup_string (placement_setting, ITTI_CONFIG_STRING_TASK, &astring),
+        "Missing %s in %s entry %d\n", ITTI_CONFIG_STRING_TASK, ITTI_CONFIG_STRING_TASK_PLACEMENT, i);
+    placement->task_name = bfromcstr (astring);
+    if (config_setting_lookup_string (placement_setting, ITTI_CONFIG_STRING_CPUS, &astring)) {
+      placement->cpu_list = bfromcstr (astring);
+    }
+    if (config_setting_lookup_int (placement_setting, ITTI_CONFIG_STRING_REAL_TIME_PRIORITY, &aint)) {
+      placement->rt_priority = (int) aint;
+    }
+    if (config_setting_lookup_int (placement_setting, ITTI_CONFIG_STRING_BUSY_POLL_US, &aint)) {
+      AssertFatal (0 <= aint, "Bad %s value %d\n", ITTI_CONFIG_STRING_BUSY_POLL_US, (int) aint);
+      placement->busy_poll_us = (uint32_t) aint;
+    }
+  }
+  config->nb_task_placements = (uint8_t) num;
+}
+
+//------------------------------------------------------------------------------
+void itti_task_placements_config_display (const log_proto_t log_proto, const itti_task_placements_config_t * const config)
+{
+  for (int i = 0; i < config->nb_task_placements; i++) {
+    const itti_task_placement_config_t   *placement = &config->task_placement[i];
+
+    OAILOG_INFO (log_proto, "    %-17s: CPUs %s, real time priority %d, busy-poll %u us\n", bdata(placement->task_name),
+        (placement->cpu_list) ? bdata(placement->cpu_list) : "all", placement->rt_priority, placement->busy_poll_us);
+  }
+}
+
+//------------------------------------------------------------------------------
+int itti_task_placements_config_apply (const itti_task_placements_config_t * const config)
+{
+  for (int i = 0; i < config->nb_task_placements; i++) {
+    const itti_task_placement_config_t   *placement = &config->task_placement[i];
+
+    if (itti_set_task_placement_by_name (bdata(placement->task_name), bdata(placement->cpu_list), placement->rt_priority, placement->busy_poll_us) < 0) {
+      return RETURNerror;
+    }
+  }
+  return RETURNok;
+}
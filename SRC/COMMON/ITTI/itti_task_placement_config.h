@@ -0,0 +1,56 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file itti_task_placement_config.h
+  \brief TASK_PLACEMENT list of the INTERTASK_INTERFACE section, shared by the node configurations
+*/
+
+#ifndef FILE_ITTI_TASK_PLACEMENT_CONFIG_SEEN
+#define FILE_ITTI_TASK_PLACEMENT_CONFIG_SEEN
+
+#include <stdint.h>
+#include "bstrlib.h"
+#include "log.h"
+#include "intertask_interface_conf.h"
+
+typedef struct itti_task_placement_config_s {
+  bstring   task_name;     // as in tasks_def.h, "TASK_S1AP"
+  bstring   cpu_list;      // "0-3,8", NULL: all CPUs
+  int       rt_priority;   // SCHED_FIFO priority, 0: default scheduling
+  uint32_t  busy_poll_us;  // 0: itti_receive_msg blocks at once
+} itti_task_placement_config_t;
+
+typedef struct itti_task_placements_config_s {
+  uint8_t                         nb_task_placements;
+  itti_task_placement_config_t    task_placement[ITTI_TASK_PLACEMENT_CONFIG_MAX];
+} itti_task_placements_config_t;
+
+struct config_setting_t;
+
+// Reads the TASK_PLACEMENT list of the INTERTASK_INTERFACE setting if any, exits on a bad entry as the rest of the configuration
+void itti_task_placements_config_parse (const struct config_setting_t * const itti_setting, itti_task_placements_config_t * const config);
+
+void itti_task_placements_config_display (const log_proto_t log_proto, const itti_task_placements_config_t * const config);
+
+// Before the tasks are created, so that they start on their CPUs
+int itti_task_placements_config_apply (const itti_task_placements_config_t * const config);
+
+#endif /* FILE_ITTI_TASK_PLACEMENT_CONFIG_SEEN */
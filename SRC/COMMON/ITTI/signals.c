@@ -62,6 +62,22 @@
 #endif
 
 static sigset_t                         set;
+static signal_usr2_handler_t            usr2_handler = NULL;
+static signal_hup_handler_t             hup_handler = NULL;
+
+void
+signal_set_usr2_handler (
+  signal_usr2_handler_t handler)
+{
+  usr2_handler = handler;
+}
+
+void
+signal_set_hup_handler (
+  signal_hup_handler_t handler)
+{
+  hup_handler = handler;
+}
 
 int
 signal_mask (
@@ -75,9 +91,11 @@ signal_mask (
   sigemptyset (&set);
   sigaddset (&set, SIGTIMER);
   sigaddset (&set, SIGUSR1);
+  sigaddset (&set, SIGUSR2);
   sigaddset (&set, SIGABRT);
   sigaddset (&set, SIGSEGV);
   sigaddset (&set, SIGINT);
+  sigaddset (&set, SIGHUP);
 
   if (sigprocmask (SIG_BLOCK, &set, NULL) < 0) {
     perror ("sigprocmask");
@@ -97,9 +115,11 @@ signal_handle (
   sigemptyset (&set);
   sigaddset (&set, SIGTIMER);
   sigaddset (&set, SIGUSR1);
+  sigaddset (&set, SIGUSR2);
   sigaddset (&set, SIGABRT);
   sigaddset (&set, SIGSEGV);
   sigaddset (&set, SIGINT);
+  sigaddset (&set, SIGHUP);
 
   if (sigprocmask (SIG_BLOCK, &set, NULL) < 0) {
     perror ("sigprocmask");
@@ -133,6 +153,20 @@ signal_handle (
       *end = 1;
       break;
 
+    case SIGUSR2:
+      SIG_DEBUG ("Received SIGUSR2\n");
+      if (usr2_handler) {
+        usr2_handler ();
+      }
+      break;
+
+    case SIGHUP:
+      SIG_DEBUG ("Received SIGHUP\n");
+      if (hup_handler) {
+        hup_handler ();
+      }
+      break;
+
     case SIGSEGV:              /* Fall through */
     case SIGABRT:
       SIG_DEBUG ("Received SIGABORT\n");
@@ -30,8 +30,17 @@
 #ifndef SIGNALS_H_
 #define SIGNALS_H_
 
+typedef void (*signal_usr2_handler_t)(void);
+typedef void (*signal_hup_handler_t)(void);
+
 int signal_mask(void);
 
 int signal_handle(int *end);
 
+/* SIGUSR2 is free for the application, the handler runs in the thread waiting for signals */
+void signal_set_usr2_handler(signal_usr2_handler_t handler);
+
+/* SIGHUP asks for a configuration reload, the handler runs in the thread waiting for signals */
+void signal_set_hup_handler(signal_hup_handler_t handler);
+
 #endif /* SIGNALS_H_ */
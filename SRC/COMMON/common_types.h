@@ -157,6 +157,15 @@ typedef struct tai_list_s {
   (GuTi_PtR)->gummei.mme_gid,\
   (GuTi_PtR)->gummei.mme_code,\
   (GuTi_PtR)->m_tmsi
+
+/* Checks GUTIs equality */
+#define GUTIS_ARE_EQUAL(g1, g2) ((PLMNS_ARE_EQUAL((g1).gummei.plmn,(g2).gummei.plmn)) && \
+                                 ((g1).gummei.mme_gid == (g2).gummei.mme_gid) &&        \
+                                 ((g1).gummei.mme_code == (g2).gummei.mme_code) &&      \
+                                 ((g1).m_tmsi == (g2).m_tmsi))
+
+// GUTI packed in an integer hashtable key, see guti_key.h
+typedef uint64_t guti_key_t;
 #define MSISDN_LENGTH      (15)
 #define IMEI_DIGITS_MAX    (15)
 #define IMEISV_DIGITS_MAX  (16)
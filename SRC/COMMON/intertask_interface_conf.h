@@ -47,4 +47,14 @@
 #define ITTI_QUEUE_MAX_ELEMENTS  (64 * 1024)
 #define ITTI_DUMP_MAX_CON        (5)    /* Max connections in parallel */
 
+/* Placement of the task threads, list in the INTERTASK_INTERFACE section of the
+ * node configuration files, applied with itti_set_task_placement_by_name() */
+#define ITTI_CONFIG_STRING_TASK_PLACEMENT       "TASK_PLACEMENT"
+#define ITTI_CONFIG_STRING_TASK                 "TASK"
+#define ITTI_CONFIG_STRING_CPUS                 "CPUS"
+#define ITTI_CONFIG_STRING_REAL_TIME_PRIORITY   "REAL_TIME_PRIORITY"
+#define ITTI_CONFIG_STRING_BUSY_POLL_US         "BUSY_POLL_US"
+
+#define ITTI_TASK_PLACEMENT_CONFIG_MAX          (32)
+
 #endif /* FILE_INTERTASK_INTERFACE_CONF_SEEN */
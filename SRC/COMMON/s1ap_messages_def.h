@@ -36,6 +36,7 @@ MESSAGE_DEF(S1AP_NAS_NON_DELIVERY_IND_LOG  , MESSAGE_PRIORITY_MED, IttiMsgText
 MESSAGE_DEF(S1AP_DOWNLINK_NAS_LOG          , MESSAGE_PRIORITY_MED, IttiMsgText                      , s1ap_downlink_nas_log)
 MESSAGE_DEF(S1AP_S1_SETUP_LOG              , MESSAGE_PRIORITY_MED, IttiMsgText                      , s1ap_s1_setup_log)
 MESSAGE_DEF(S1AP_INITIAL_UE_MESSAGE_LOG    , MESSAGE_PRIORITY_MED, IttiMsgText                      , s1ap_initial_ue_message_log)
+MESSAGE_DEF(S1AP_ENB_CONFIGURATION_UPDATE_LOG, MESSAGE_PRIORITY_MED, IttiMsgText                    , s1ap_enb_configuration_update_log)
 MESSAGE_DEF(S1AP_UE_CONTEXT_RELEASE_REQ_LOG, MESSAGE_PRIORITY_MED, IttiMsgText                      , s1ap_ue_context_release_req_log)
 MESSAGE_DEF(S1AP_UE_CONTEXT_RELEASE_COMMAND_LOG, MESSAGE_PRIORITY_MED, IttiMsgText                  , s1ap_ue_context_release_command_log)
 MESSAGE_DEF(S1AP_UE_CONTEXT_RELEASE_LOG    , MESSAGE_PRIORITY_MED, IttiMsgText                      , s1ap_ue_context_release_log)
@@ -47,3 +48,8 @@ MESSAGE_DEF(S1AP_UE_CONTEXT_RELEASE_REQ    ,  MESSAGE_PRIORITY_MED, itti_s1ap_ue
 MESSAGE_DEF(S1AP_UE_CONTEXT_RELEASE_COMMAND,  MESSAGE_PRIORITY_MED, itti_s1ap_ue_context_release_command_t,  s1ap_ue_context_release_command)
 MESSAGE_DEF(S1AP_UE_CONTEXT_RELEASE_COMPLETE, MESSAGE_PRIORITY_MED, itti_s1ap_ue_context_release_complete_t, s1ap_ue_context_release_complete)
 MESSAGE_DEF(S1AP_NAS_DL_DATA_REQ           ,  MESSAGE_PRIORITY_MED, itti_s1ap_nas_dl_data_req_t           ,  s1ap_nas_dl_data_req)
+MESSAGE_DEF(S1AP_DECODED_PDU_IND           ,  MESSAGE_PRIORITY_MED, itti_s1ap_decoded_pdu_ind_t           ,  s1ap_decoded_pdu_ind)
+MESSAGE_DEF(S1AP_ENCODE_PDU_REQ            ,  MESSAGE_PRIORITY_MED, itti_s1ap_encode_pdu_req_t            ,  s1ap_encode_pdu_req)
+MESSAGE_DEF(S1AP_OVERLOAD_START            ,  MESSAGE_PRIORITY_MED, itti_s1ap_overload_start_t            ,  s1ap_overload_start)
+MESSAGE_DEF(S1AP_OVERLOAD_STOP             ,  MESSAGE_PRIORITY_MED, itti_s1ap_overload_stop_t             ,  s1ap_overload_stop)
+MESSAGE_DEF(S1AP_PAGING_REQUEST            ,  MESSAGE_PRIORITY_MED, itti_s1ap_paging_request_t            ,  s1ap_paging_request)
@@ -35,6 +35,11 @@
 #define S1AP_UE_CONTEXT_RELEASE_COMMAND(mSGpTR) (mSGpTR)->ittiMsg.s1ap_ue_context_release_command
 #define S1AP_UE_CONTEXT_RELEASE_COMPLETE(mSGpTR) (mSGpTR)->ittiMsg.s1ap_ue_context_release_complete
 #define S1AP_NAS_DL_DATA_REQ(mSGpTR)        (mSGpTR)->ittiMsg.s1ap_nas_dl_data_req
+#define S1AP_DECODED_PDU_IND(mSGpTR)        (mSGpTR)->ittiMsg.s1ap_decoded_pdu_ind
+#define S1AP_ENCODE_PDU_REQ(mSGpTR)         (mSGpTR)->ittiMsg.s1ap_encode_pdu_req
+#define S1AP_OVERLOAD_START(mSGpTR)         (mSGpTR)->ittiMsg.s1ap_overload_start
+#define S1AP_OVERLOAD_STOP(mSGpTR)          (mSGpTR)->ittiMsg.s1ap_overload_stop
+#define S1AP_PAGING_REQUEST(mSGpTR)         (mSGpTR)->ittiMsg.s1ap_paging_request
 
 typedef struct itti_s1ap_initial_ue_message_s {
   mme_ue_s1ap_id_t     mme_ue_s1ap_id;
@@ -98,7 +103,8 @@ enum s1cause {
   S1AP_NAS_DETACH,
   S1AP_RADIO_EUTRAN_GENERATED_REASON,
   S1AP_IMPLICIT_CONTEXT_RELEASE,
-  S1AP_SCTP_SHUTDOWN_OR_RESET
+  S1AP_SCTP_SHUTDOWN_OR_RESET,
+  S1AP_CONTROL_PROCESSING_OVERLOAD
 };
 typedef struct itti_s1ap_ue_context_release_command_s {
   mme_ue_s1ap_id_t  mme_ue_s1ap_id;
@@ -117,4 +123,60 @@ typedef struct itti_s1ap_ue_context_release_complete_s {
   enb_ue_s1ap_id_t  enb_ue_s1ap_id:24;
 } itti_s1ap_ue_context_release_complete_t;
 
+// generated ASN.1 IEs container (s1ap_ies_defs.h)
+struct s1ap_message_s;
+struct mem_arena_s;
+
+// PDU decoded by a S1AP codec task, forwarded to the S1AP task
+typedef struct itti_s1ap_decoded_pdu_ind_s {
+  sctp_assoc_id_t         assoc_id;
+  sctp_stream_id_t        stream;
+  struct s1ap_message_s  *message;      /* allocated in arena */
+  struct mem_arena_s     *arena;        /* holds the whole decoded PDU, ownership transferred to the receiver */
+} itti_s1ap_decoded_pdu_ind_t;
+
+// PDU to be encoded and sent to SCTP by a S1AP codec task
+typedef struct itti_s1ap_encode_pdu_req_s {
+  sctp_assoc_id_t         assoc_id;
+  sctp_stream_id_t        stream;
+  mme_ue_s1ap_id_t        mme_ue_s1ap_id;
+  struct s1ap_message_s  *message;      /* ownership transferred to the receiver */
+} itti_s1ap_encode_pdu_req_t;
+
+// Overload action requested to the eNBs, same order as S1ap-OverloadAction (36.413 9.2.3.20)
+typedef enum s1ap_overload_action_e {
+  S1AP_OVERLOAD_REJECT_NON_EMERGENCY_MO_DT = 0,
+  S1AP_OVERLOAD_REJECT_ALL_RRC_CR_SIGNALLING,
+  S1AP_OVERLOAD_PERMIT_EMERGENCY_SESSIONS_ONLY
+} s1ap_overload_action_t;
+
+// MME_APP overload control asks S1AP to send OVERLOAD START to a share of the eNBs
+typedef struct itti_s1ap_overload_start_s {
+  s1ap_overload_action_t  action;
+  uint8_t                 enb_percent;  /* 1..100 */
+} itti_s1ap_overload_start_t;
+
+// MME_APP overload control asks S1AP to send OVERLOAD STOP to the eNBs in overload
+typedef struct itti_s1ap_overload_stop_s {
+  uint8_t                 dummy;
+} itti_s1ap_overload_stop_t;
+
+// Core network domain of a paging, same order as S1ap-CNDomain (36.413 9.2.3.22)
+typedef enum s1ap_cn_domain_e {
+  S1AP_CN_DOMAIN_PS = 0,
+  S1AP_CN_DOMAIN_CS
+} s1ap_cn_domain_t;
+
+// NAS asks S1AP to page an idle UE in its TAI list
+typedef struct itti_s1ap_paging_request_s {
+  mme_ue_s1ap_id_t        mme_ue_s1ap_id;
+  imsi64_t                imsi64;         /* UE identity index value is IMSI mod 1024 */
+  bool                    is_imsi_paging; /* page with the IMSI instead of the S-TMSI */
+  uint8_t                 mme_code;
+  uint32_t                m_tmsi;
+  s1ap_cn_domain_t        cn_domain;
+  tai_t                   last_visited_tai; /* first paging attempt, not used if invalid */
+  tai_list_t              tai_list;
+} itti_s1ap_paging_request_t;
+
 #endif /* FILE_S1AP_MESSAGES_TYPES_SEEN */
@@ -35,6 +35,7 @@
 #define S6A_UPDATE_LOCATION_ANS(mSGpTR)  (mSGpTR)->ittiMsg.s6a_update_location_ans
 #define S6A_AUTH_INFO_REQ(mSGpTR)        (mSGpTR)->ittiMsg.s6a_auth_info_req
 #define S6A_AUTH_INFO_ANS(mSGpTR)        (mSGpTR)->ittiMsg.s6a_auth_info_ans
+#define S6A_SUBSCRIPTION_INVALIDATED_IND(mSGpTR) (mSGpTR)->ittiMsg.s6a_subscription_invalidated_ind
 
 
 #define AUTS_LENGTH 14
@@ -100,4 +101,19 @@ typedef struct s6a_auth_info_ans_s {
   authentication_info_t auth_info;
 } s6a_auth_info_ans_t;
 
+// HSS initiated procedure after which the subscription data held by the MME is no longer valid
+typedef enum s6a_invalidation_cause_e {
+  S6A_INVALIDATION_CANCEL_LOCATION = 0,
+  S6A_INVALIDATION_INSERT_SUBSCRIBER_DATA,
+  S6A_INVALIDATION_RESET,
+} s6a_invalidation_cause_t;
+
+typedef struct s6a_subscription_invalidated_ind_s {
+  s6a_invalidation_cause_t cause;
+  uint32_t cancellation_type;               // Cancellation-Type of a Cancel Location
+  char    imsi[IMSI_BCD_DIGITS_MAX + 1];    // empty for a Reset: all subscribers are concerned
+  uint8_t imsi_length;
+  apn_config_profile_t apn_config_profile;  // APN configurations of an Insert Subscriber Data, nb_apns is 0 if none
+} s6a_subscription_invalidated_ind_t;
+
 #endif /* FILE_S6A_MESSAGES_TYPES_SEEN */
@@ -34,3 +34,4 @@ MESSAGE_DEF(SCTP_DATA_IND,          MESSAGE_PRIORITY_MED, sctp_data_ind_t,
 MESSAGE_DEF(SCTP_DATA_CNF,          MESSAGE_PRIORITY_MED, sctp_data_cnf_t,          sctp_data_cnf)
 MESSAGE_DEF(SCTP_NEW_ASSOCIATION,   MESSAGE_PRIORITY_MAX, sctp_new_peer_t,          sctp_new_peer)
 MESSAGE_DEF(SCTP_CLOSE_ASSOCIATION, MESSAGE_PRIORITY_MAX, sctp_close_association_t, sctp_close_association)
+MESSAGE_DEF(SCTP_CONGESTION_IND,    MESSAGE_PRIORITY_MAX, sctp_congestion_ind_t,    sctp_congestion_ind)
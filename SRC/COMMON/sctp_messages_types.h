@@ -34,6 +34,7 @@
 #define SCTP_DATA_CNF(mSGpTR)           (mSGpTR)->ittiMsg.sctp_data_cnf
 #define SCTP_INIT_MSG(mSGpTR)           (mSGpTR)->ittiMsg.sctpInit
 #define SCTP_CLOSE_ASSOCIATION(mSGpTR)  (mSGpTR)->ittiMsg.sctp_close_association
+#define SCTP_CONGESTION_IND(mSGpTR)     (mSGpTR)->ittiMsg.sctp_congestion_ind
 
 
 //typedef struct sctp_data_rej_s {
@@ -87,6 +88,16 @@ typedef struct sctp_new_peer_s {
   uint32_t        instreams;
   uint32_t        outstreams;
   sctp_assoc_id_t assoc_id;
+  // only filled for TASK_SCTP, owner of the send queue of the association
+  int             sd;
+  uint32_t        ppid;
 } sctp_new_peer_t;
 
+// The send queue of the association went past its high watermark (is_congested) or back under its low watermark
+typedef struct sctp_congestion_ind_s {
+  sctp_assoc_id_t assoc_id;
+  bool            is_congested;
+  uint32_t        queue_depth;
+} sctp_congestion_ind_t;
+
 #endif /* FILE_SCTP_MESSAGES_TYPES_SEEN */
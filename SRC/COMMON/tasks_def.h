@@ -35,20 +35,58 @@ TASK_DEF(TASK_TIMER,    TASK_PRIORITY_MED, 10)
 TASK_DEF(TASK_GTPV1_U,  TASK_PRIORITY_MED, 200)
 /// FW_IP task
 TASK_DEF(TASK_FW_IP,    TASK_PRIORITY_MED, 200)
-/// MME Applicative task
+/// MME Applicative task (worker 0)
 TASK_DEF(TASK_MME_APP,  TASK_PRIORITY_MED, 200)
-/// NAS task
+/// MME Applicative additional workers, must follow TASK_MME_APP
+TASK_DEF(TASK_MME_APP_1, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_MME_APP_2, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_MME_APP_3, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_MME_APP_4, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_MME_APP_5, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_MME_APP_6, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_MME_APP_7, TASK_PRIORITY_MED, 200)
+/// NAS task (worker 0)
 TASK_DEF(TASK_NAS_MME,  TASK_PRIORITY_MED, 200)
-/// S11 task
+/// NAS additional workers, must follow TASK_NAS_MME
+TASK_DEF(TASK_NAS_MME_1, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_NAS_MME_2, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_NAS_MME_3, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_NAS_MME_4, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_NAS_MME_5, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_NAS_MME_6, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_NAS_MME_7, TASK_PRIORITY_MED, 200)
+/// S11 task (GTPv2-C stack instance 0, owner of the S11 socket)
 TASK_DEF(TASK_S11,      TASK_PRIORITY_MED, 200)
+/// S11 additional GTPv2-C stack instances, must follow TASK_S11
+TASK_DEF(TASK_S11_1,    TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_S11_2,    TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_S11_3,    TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_S11_4,    TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_S11_5,    TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_S11_6,    TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_S11_7,    TASK_PRIORITY_MED, 200)
 /// S1AP task
 TASK_DEF(TASK_S1AP,     TASK_PRIORITY_MED, 200)
+/// S1AP ASN.1 codec task (worker 0)
+TASK_DEF(TASK_S1AP_CODEC,   TASK_PRIORITY_MED, 200)
+/// S1AP ASN.1 codec additional workers, must follow TASK_S1AP_CODEC
+TASK_DEF(TASK_S1AP_CODEC_1, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_S1AP_CODEC_2, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_S1AP_CODEC_3, TASK_PRIORITY_MED, 200)
 /// S6a task
 TASK_DEF(TASK_S6A,      TASK_PRIORITY_MED, 200)
 /// SCTP task
 TASK_DEF(TASK_SCTP,     TASK_PRIORITY_MED, 200)
-/// Serving and Proxy Gateway Application task
+/// Serving and Proxy Gateway Application task (worker 0)
 TASK_DEF(TASK_SPGW_APP, TASK_PRIORITY_MED, 200)
+/// Serving and Proxy Gateway Application additional workers, must follow TASK_SPGW_APP
+TASK_DEF(TASK_SPGW_APP_1, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_SPGW_APP_2, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_SPGW_APP_3, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_SPGW_APP_4, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_SPGW_APP_5, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_SPGW_APP_6, TASK_PRIORITY_MED, 200)
+TASK_DEF(TASK_SPGW_APP_7, TASK_PRIORITY_MED, 200)
 /// UDP task
 TASK_DEF(TASK_UDP,      TASK_PRIORITY_MED, 200)
 //MESSAGE GENERATOR TASK
@@ -29,7 +29,8 @@
 #ifndef FILE_UDP_MESSAGES_TYPES_SEEN
 #define FILE_UDP_MESSAGES_TYPES_SEEN
 
-#define UDP_INIT(mSGpTR)    (mSGpTR)->ittiMsg.udp_init
+#define UDP_INIT(mSGpTR)        (mSGpTR)->ittiMsg.udp_init
+#define UDP_DATA_IND(mSGpTR)    (mSGpTR)->ittiMsg.udp_data_ind
 
 typedef struct {
   uint32_t  port;
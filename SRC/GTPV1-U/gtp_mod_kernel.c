@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -25,7 +26,9 @@ static struct {
   int                 genl_id;
   struct mnl_socket  *nl;
   bool                is_enabled;
-} gtp_nl;
+  // request/ack exchanges on the netlink socket must not interleave (SPGW_APP workers)
+  pthread_mutex_t     mutex;
+} gtp_nl = {.mutex = PTHREAD_MUTEX_INITIALIZER};
 
 
 #define GTP_DEVNAME "gtp0"
@@ -89,10 +92,22 @@ int gtp_mod_kernel_init(int *fd0, int *fd1u, struct in_addr *ue_net, int mask, i
   }
   bdestroy(system_cmd);
 
+  if (gtp_mod_kernel_add_ue_net(ue_net, mask) < 0) {
+    return RETURNerror;
+  }
+
+  OAILOG_NOTICE (LOG_GTPV1U, "GTP kernel configured\n");
+
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int gtp_mod_kernel_add_ue_net(struct in_addr *ue_net, int mask)
+{
   struct in_addr ue_gw;
   ue_gw.s_addr = ue_net->s_addr | htonl(1);
-  system_cmd = bformat ("ip addr add %s/%u dev %s", inet_ntoa(ue_gw), mask, GTP_DEVNAME);
-  ret = system ((const char *)system_cmd->data);
+  bstring system_cmd = bformat ("ip addr add %s/%u dev %s", inet_ntoa(ue_gw), mask, GTP_DEVNAME);
+  int ret = system ((const char *)system_cmd->data);
   if (ret) {
     OAILOG_ERROR (LOG_GTPV1U, "ERROR in system command %s: %d at %s:%u\n", bdata(system_cmd), ret, __FILE__, __LINE__);
     bdestroy(system_cmd);
@@ -107,9 +122,6 @@ int gtp_mod_kernel_init(int *fd0, int *fd1u, struct in_addr *ue_net, int mask, i
     OAILOG_ERROR (LOG_GTPV1U,         "Cannot add route to reach network\n");
     return RETURNerror;
   }
-
-  OAILOG_NOTICE (LOG_GTPV1U, "GTP kernel configured\n");
-
   return RETURNok;
 }
 
@@ -143,7 +155,9 @@ int gtp_mod_kernel_tunnel_add(struct in_addr ue, struct in_addr enb, uint32_t i_
   gtp_tunnel_set_i_tei(t, i_tei);
   gtp_tunnel_set_o_tei(t, o_tei);
 
+  pthread_mutex_lock(&gtp_nl.mutex);
   ret = gtp_add_tunnel(gtp_nl.genl_id, gtp_nl.nl, t);
+  pthread_mutex_unlock(&gtp_nl.mutex);
   gtp_tunnel_free(t);
 
   return ret;
@@ -169,7 +183,9 @@ int gtp_mod_kernel_tunnel_del(uint32_t i_tei, uint32_t o_tei)
   gtp_tunnel_set_i_tei(t, i_tei);
   gtp_tunnel_set_o_tei(t, o_tei);
 
+  pthread_mutex_lock(&gtp_nl.mutex);
   ret = gtp_del_tunnel(gtp_nl.genl_id, gtp_nl.nl, t);
+  pthread_mutex_unlock(&gtp_nl.mutex);
   gtp_tunnel_free(t);
 
   return ret;
@@ -105,13 +105,15 @@ int gtpv1u_init (spgw_config_t *spgw_config)
     OAILOG_CRITICAL (TASK_GTPV1_U, "ERROR in loading gtp kernel module (check if built in kernel)\n");
     return -1;
   }
-  AssertFatal(spgw_config->pgw_config.num_ue_pool == 1, "No more than 1 UE pool allowed actually");
-  for (int i = 0; i < spgw_config->pgw_config.num_ue_pool; i++) {
-    // GTP device same MTU as SGi.
-    gtp_mod_kernel_init(&sgw_app.gtpv1u_data.fd0, &sgw_app.gtpv1u_data.fd1u,
-        &spgw_config->pgw_config.ue_pool_addr[i],
-        spgw_config->pgw_config.ue_pool_mask[i],
-        spgw_config->pgw_config.ipv4.mtu_SGI);
+  AssertFatal(spgw_config->pgw_config.num_ue_pool >= 1, "At least 1 UE pool must be configured");
+  // GTP device same MTU as SGi, created with the first pool, other pools are added to the device.
+  gtp_mod_kernel_init(&sgw_app.gtpv1u_data.fd0, &sgw_app.gtpv1u_data.fd1u,
+      &spgw_config->pgw_config.ue_pool_addr[0],
+      spgw_config->pgw_config.ue_pool_mask[0],
+      spgw_config->pgw_config.ipv4.mtu_SGI);
+  for (int i = 1; i < spgw_config->pgw_config.num_ue_pool; i++) {
+    gtp_mod_kernel_add_ue_net(&spgw_config->pgw_config.ue_pool_addr[i],
+        spgw_config->pgw_config.ue_pool_mask[i]);
   }
   // END-GTP quick integration only for evaluation purpose
 
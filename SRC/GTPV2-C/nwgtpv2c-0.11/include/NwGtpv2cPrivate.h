@@ -101,6 +101,8 @@ typedef struct NwGtpv2cStack {
   NwGtpv2cLogMgrEntityT         logMgr;
 
   uint32_t                        seqNum;
+  uint32_t                        seqNumFirst;                            /**< Sequence number range of this instance */
+  uint32_t                        seqNumEnd;                              /**< First sequence number after the range  */
   uint32_t                        logLevel;
   uint32_t                        restartCounter;
 
@@ -112,6 +114,12 @@ typedef struct NwGtpv2cStack {
   RB_HEAD( NwGtpv2cOutstandingRxSeqNumTrxnMap, NwGtpv2cTrxn ) outstandingRxSeqNumMap;
   RB_HEAD( NwGtpv2cActiveTimerList, NwGtpv2cTimeoutInfo     ) activeTimerList;
   NwHandleT                     hTmrMinHeap;
+
+  /* Free lists of the instance: a stack and everything it allocates are used by one thread only */
+  struct NwGtpv2cMsgS           *pMsgPool;
+  struct NwGtpv2cTrxn           *pTrxnPool;
+  struct NwGtpv2cTunnel         *pTunnelPool;
+  struct NwGtpv2cTimeoutInfo    *pTimeoutInfoPool;
 } NwGtpv2cStackT;
 
 
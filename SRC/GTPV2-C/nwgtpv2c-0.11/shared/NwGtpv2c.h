@@ -521,6 +521,45 @@ NwRcT
 nwGtpv2cSetLogLevel( NW_IN NwGtpv2cStackHandleT hGtpcStackHandle,
                      NW_IN uint32_t logLevel);
 
+/**
+ Give the stack its share of the sequence number space, when several
+ stack instances of a process serve the same UDP port. Each instance is
+ used by one thread only, the requests it sends use sequence numbers of
+ its own range so that their responses can be dispatched back to it
+ with nwGtpv2cGetUdpReqInstance().
+
+ @param[in] hGtpcStackHandle : Stack handle
+ @param[in] instance : Index of the stack instance, in [0..nbInstances-1].
+ @param[in] nbInstances : Number of stack instances.
+ @return NW_OK on success.
+ */
+
+NwRcT
+nwGtpv2cSetSeqNumRange( NW_IN NwGtpv2cStackHandleT hGtpcStackHandle,
+                        NW_IN uint32_t instance,
+                        NW_IN uint32_t nbInstances);
+
+/**
+ Select the stack instance that has to process a message received on a
+ UDP port shared by several instances, from the message header only.
+ A response goes to the instance owning its sequence number, a request
+ to the instance owning its TEID (TEID % nbInstances), or to the
+ instance owning its sequence number (seqNum % nbInstances) if it has
+ no TEID.
+
+ @param[in] udpData : Pointer to received UDP data.
+ @param[in] udpDataLen : Received data length.
+ @param[in] nbInstances : Number of stack instances.
+ @param[out] pInstance : Index of the stack instance.
+ @return NW_OK on success, NW_FAILURE if the header is too short (instance 0 then discards it).
+ */
+
+NwRcT
+nwGtpv2cGetUdpReqInstance( NW_IN uint8_t* udpData,
+                           NW_IN uint32_t udpDataLen,
+                           NW_IN uint32_t nbInstances,
+                           NW_OUT uint32_t* pInstance);
+
 
 /**
  Process Data Request from UDP entity.
@@ -89,12 +89,22 @@
 
 #define NW_GTPV2C_UDP_PORT                                              (2123)
 
+#define NW_GTPV2C_SEQ_NUM_END                                           (0x800000)
+#define NW_GTPV2C_SEQ_NUM_PARTITION_SPACE                               (0x100000)      /**< Shared by the instances of a process, power of 2 */
+
+#define NW_GTPV2C_PURGE_POOL(__thiz, __pool, __type)                    \
+  do {                                                                  \
+    while ((__thiz)->__pool) {                                          \
+      __type *__next = (__thiz)->__pool->next;                          \
+      NW_GTPV2C_FREE ((__thiz), (__thiz)->__pool);                      \
+      (__thiz)->__pool = __next;                                        \
+    }                                                                   \
+  } while(0)
+
 #ifdef __cplusplus
 extern                                  "C" {
 #endif
 
-  static NwGtpv2cTimeoutInfoT            *gpGtpv2cTimeoutInfoPool = NULL;
-
   typedef struct {
     int                                     currSize;
     int                                     maxSize;
@@ -945,6 +955,8 @@ extern                                  "C" {
       thiz->id = (uint32_t) thiz;
       thiz->seqNum = ((uint32_t) thiz) & 0x0000FFFF;
       OAI_GCC_DIAG_ON(pointer-to-int-cast);
+      thiz->seqNumFirst = 0;
+      thiz->seqNumEnd = NW_GTPV2C_SEQ_NUM_END;
       RB_INIT (&(thiz->tunnelMap));
       RB_INIT (&(thiz->outstandingTxSeqNumMap));
       RB_INIT (&(thiz->outstandingRxSeqNumMap));
@@ -992,13 +1004,109 @@ extern                                  "C" {
 
   NwRcT                                   nwGtpv2cFinalize (
   NW_IN NwGtpv2cStackHandleT hGtpcStackHandle) {
+    NwGtpv2cStackT                         *thiz = (NwGtpv2cStackT *) hGtpcStackHandle;
+
     if (!hGtpcStackHandle)
       return NW_FAILURE;
 
+    NW_GTPV2C_PURGE_POOL (thiz, pMsgPool, NwGtpv2cMsgT);
+    NW_GTPV2C_PURGE_POOL (thiz, pTrxnPool, NwGtpv2cTrxnT);
+    NW_GTPV2C_PURGE_POOL (thiz, pTunnelPool, NwGtpv2cTunnelT);
+    NW_GTPV2C_PURGE_POOL (thiz, pTimeoutInfoPool, NwGtpv2cTimeoutInfoT);
     free_wrapper ((void **) &hGtpcStackHandle);
     return NW_OK;
   }
 
+/**
+   Set the sequence number range of a stack instance
+*/
+
+  NwRcT                                   nwGtpv2cSetSeqNumRange (
+  NW_IN NwGtpv2cStackHandleT hGtpcStackHandle,
+  NW_IN uint32_t instance,
+  NW_IN uint32_t nbInstances) {
+    NwGtpv2cStackT                         *thiz = (NwGtpv2cStackT *) hGtpcStackHandle;
+    uint32_t                                rangeSize = 0;
+
+    if ((!thiz) || (nbInstances == 0) || (nbInstances > NW_GTPV2C_SEQ_NUM_PARTITION_SPACE) || (instance >= nbInstances))
+      return NW_FAILURE;
+
+    /*
+     * Below the command message flag, so that a command triggered response is dispatched with its request
+     */
+    rangeSize = NW_GTPV2C_SEQ_NUM_PARTITION_SPACE / nbInstances;
+    thiz->seqNumFirst = instance * rangeSize;
+    thiz->seqNumEnd = (instance == (nbInstances - 1)) ? NW_GTPV2C_SEQ_NUM_PARTITION_SPACE : thiz->seqNumFirst + rangeSize;
+    thiz->seqNum = thiz->seqNumFirst;
+    return NW_OK;
+  }
+
+/**
+   Select the stack instance of a received message
+*/
+
+  NwRcT                                   nwGtpv2cGetUdpReqInstance (
+  NW_IN uint8_t * udpData,
+  NW_IN uint32_t udpDataLen,
+  NW_IN uint32_t nbInstances,
+  NW_OUT uint32_t * pInstance) {
+    uint8_t                                 msgType = 0;
+    uint32_t                                teid = 0;
+    uint32_t                                seqNum = 0;
+    uint32_t                                instance = 0;
+
+    *pInstance = 0;
+
+    if ((nbInstances == 0) || (nbInstances > NW_GTPV2C_SEQ_NUM_PARTITION_SPACE))
+      return NW_FAILURE;
+
+    if ((udpDataLen < NW_GTPV2C_MINIMUM_HEADER_SIZE) || ((*udpData & 0x08) && (udpDataLen < NW_GTPV2C_EPC_SPECIFIC_HEADER_SIZE)))
+      return NW_FAILURE;
+
+    msgType = *(udpData + 1);
+
+    if (*udpData & 0x08) {
+      teid = ntohl (*((uint32_t *) (udpData + 4)));
+      seqNum = ntohl (*((uint32_t *) (udpData + 8))) >> 8;
+    } else {
+      seqNum = ntohl (*((uint32_t *) (udpData + 4))) >> 8;
+    }
+
+    switch (msgType) {
+    case NW_GTP_ECHO_RSP:
+    case NW_GTP_CREATE_SESSION_RSP:
+    case NW_GTP_MODIFY_BEARER_RSP:
+    case NW_GTP_DELETE_SESSION_RSP:
+    case NW_GTP_CREATE_BEARER_RSP:
+    case NW_GTP_UPDATE_BEARER_RSP:
+    case NW_GTP_DELETE_BEARER_RSP:
+    case NW_GTP_RELEASE_ACCESS_BEARERS_RSP:
+    case NW_GTP_CREATE_INDIRECT_DATA_FORWARDING_TUNNEL_RSP:
+    case NW_GTP_DELETE_INDIRECT_DATA_FORWARDING_TUNNEL_RSP:{
+        /*
+         * The outstanding transaction is in the instance owning the sequence number
+         */
+        instance = (seqNum & (NW_GTPV2C_SEQ_NUM_PARTITION_SPACE - 1)) / (NW_GTPV2C_SEQ_NUM_PARTITION_SPACE / nbInstances);
+
+        if (instance >= nbInstances)
+          instance = nbInstances - 1;
+      }
+      break;
+
+    default:{
+        /*
+         * Requests go to the instance owning the local tunnel, duplicates of a request without TEID
+         * to the instance that received the first one
+         */
+        instance = (teid ? teid : seqNum) % nbInstances;
+      }
+      break;
+    }
+
+    *pInstance = instance;
+    return NW_OK;
+  }
+
 
 /**
    Set ULP entity
@@ -1263,8 +1371,8 @@ extern                                  "C" {
     if (thiz->activeTimerInfo == timeoutInfo) {
       thiz->activeTimerInfo = NULL;
       RB_REMOVE (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-      timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = timeoutInfo;
+      timeoutInfo->next = thiz->pTimeoutInfoPool;
+      thiz->pTimeoutInfoPool = timeoutInfo;
       rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
     } else {
       OAILOG_WARNING (LOG_GTPV2C,  "Received timeout event from ULP for non-existent timeoutInfo 0x%p and activeTimer 0x%p!\n", timeoutInfo, thiz->activeTimerInfo);
@@ -1279,8 +1387,8 @@ extern                                  "C" {
 
       pNextTimeoutInfo = RB_NEXT (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
       RB_REMOVE (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-      timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = timeoutInfo;
+      timeoutInfo->next = thiz->pTimeoutInfoPool;
+      thiz->pTimeoutInfoPool = timeoutInfo;
       rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
       timeoutInfo = pNextTimeoutInfo;
     }
@@ -1319,8 +1427,8 @@ extern                                  "C" {
       OAI_GCC_DIAG_OFF(int-to-pointer-cast);
       rc = nwGtpv2cTmrMinHeapRemove ((NwGtpv2cTmrMinHeapT*)thiz->hTmrMinHeap, timeoutInfo->timerMinHeapIndex);
       OAI_GCC_DIAG_ON(int-to-pointer-cast);
-      timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = timeoutInfo;
+      timeoutInfo->next = thiz->pTimeoutInfoPool;
+      thiz->pTimeoutInfoPool = timeoutInfo;
       rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
     } else {
       OAILOG_WARNING (LOG_GTPV2C,  "Received timeout event from ULP for " "non-existent timeoutInfo 0x%p and activeTimer 0x%p!\n", timeoutInfo, thiz->activeTimerInfo);
@@ -1340,8 +1448,8 @@ extern                                  "C" {
       OAI_GCC_DIAG_OFF(int-to-pointer-cast);
       rc = nwGtpv2cTmrMinHeapRemove ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap, timeoutInfo->timerMinHeapIndex);
       OAI_GCC_DIAG_ON(int-to-pointer-cast);
-      timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = timeoutInfo;
+      timeoutInfo->next = thiz->pTimeoutInfoPool;
+      thiz->pTimeoutInfoPool = timeoutInfo;
       rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
       OAI_GCC_DIAG_OFF(int-to-pointer-cast);
       timeoutInfo = nwGtpv2cTmrMinHeapPeek ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap);
@@ -1389,9 +1497,9 @@ extern                                  "C" {
 
     OAILOG_FUNC_IN (LOG_GTPV2C);
 
-    if (gpGtpv2cTimeoutInfoPool) {
-      timeoutInfo = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = gpGtpv2cTimeoutInfoPool->next;
+    if (thiz->pTimeoutInfoPool) {
+      timeoutInfo = thiz->pTimeoutInfoPool;
+      thiz->pTimeoutInfoPool = thiz->pTimeoutInfoPool->next;
     } else {
       NW_GTPV2C_MALLOC (thiz, sizeof (NwGtpv2cTimeoutInfoT), timeoutInfo, NwGtpv2cTimeoutInfoT *);
     }
@@ -1466,9 +1574,9 @@ extern                                  "C" {
     NW_ASSERT (thiz != NULL);
     OAILOG_FUNC_IN (LOG_GTPV2C);
 
-    if (gpGtpv2cTimeoutInfoPool) {
-      timeoutInfo = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = gpGtpv2cTimeoutInfoPool->next;
+    if (thiz->pTimeoutInfoPool) {
+      timeoutInfo = thiz->pTimeoutInfoPool;
+      thiz->pTimeoutInfoPool = thiz->pTimeoutInfoPool->next;
     } else {
       NW_GTPV2C_MALLOC (thiz, sizeof (NwGtpv2cTimeoutInfoT), timeoutInfo, NwGtpv2cTimeoutInfoT *);
     }
@@ -1537,8 +1645,8 @@ extern                                  "C" {
     OAI_GCC_DIAG_OFF(int-to-pointer-cast);
     rc = nwGtpv2cTmrMinHeapRemove ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap, timeoutInfo->timerMinHeapIndex);
     OAI_GCC_DIAG_ON(int-to-pointer-cast);
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
+    timeoutInfo->next = thiz->pTimeoutInfoPool;
+    thiz->pTimeoutInfoPool = timeoutInfo;
     OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
 
     if (thiz->activeTimerInfo == timeoutInfo) {
@@ -1581,8 +1689,8 @@ extern                                  "C" {
     OAILOG_FUNC_IN (LOG_GTPV2C);
     timeoutInfo = (NwGtpv2cTimeoutInfoT *) hTimer;
     RB_REMOVE (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
+    timeoutInfo->next = thiz->pTimeoutInfoPool;
+    thiz->pTimeoutInfoPool = timeoutInfo;
     OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
 
     if (thiz->activeTimerInfo == timeoutInfo) {
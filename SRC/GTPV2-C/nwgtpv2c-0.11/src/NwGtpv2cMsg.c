@@ -50,12 +50,6 @@ extern                                  "C" {
 #endif
 
 
-/*----------------------------------------------------------------------------*
-                       P R I V A T E     F U N C T I O N S
-  ----------------------------------------------------------------------------*/
-
-  static NwGtpv2cMsgT                    *gpGtpv2cMsgPool = NULL;
-
 /*----------------------------------------------------------------------------*
                          P U B L I C   F U N C T I O N S
   ----------------------------------------------------------------------------*/
@@ -72,9 +66,9 @@ extern                                  "C" {
                                             NW_ASSERT (
   pStack);
 
-    if (gpGtpv2cMsgPool) {
-      pMsg = gpGtpv2cMsgPool;
-      gpGtpv2cMsgPool = gpGtpv2cMsgPool->next;
+    if (pStack->pMsgPool) {
+      pMsg = pStack->pMsgPool;
+      pStack->pMsgPool = pStack->pMsgPool->next;
     } else {
       NW_GTPV2C_MALLOC (pStack, sizeof (NwGtpv2cMsgT), pMsg, NwGtpv2cMsgT *);
     }
@@ -106,9 +100,9 @@ extern                                  "C" {
 
     NW_ASSERT (pStack);
 
-    if (gpGtpv2cMsgPool) {
-      pMsg = gpGtpv2cMsgPool;
-      gpGtpv2cMsgPool = gpGtpv2cMsgPool->next;
+    if (pStack->pMsgPool) {
+      pMsg = pStack->pMsgPool;
+      pStack->pMsgPool = pStack->pMsgPool->next;
     } else {
       NW_GTPV2C_MALLOC (pStack, sizeof (NwGtpv2cMsgT), pMsg, NwGtpv2cMsgT *);
     }
@@ -141,11 +135,13 @@ extern                                  "C" {
   NwRcT                                   nwGtpv2cMsgDelete (
   NW_IN NwGtpv2cStackHandleT hGtpcStackHandle,
   NW_IN NwGtpv2cMsgHandleT hMsg) {
-    // warning: unused variable ‘pStack’ [-Wunused-variable]: NwGtpv2cStackT                         *pStack = (NwGtpv2cStackT *) hGtpcStackHandle;
+    // back to the free list of the stack instance that allocated it
+    NwGtpv2cStackT                         *pStack = (NwGtpv2cStackT *) ((NwGtpv2cMsgT *) hMsg)->hStack;
 
+    NW_ASSERT (pStack);
     OAILOG_DEBUG (LOG_GTPV2C, "Purging message %" PRIxPTR "!\n", hMsg);
-    ((NwGtpv2cMsgT *) hMsg)->next = gpGtpv2cMsgPool;
-    gpGtpv2cMsgPool = (NwGtpv2cMsgT *) hMsg;
+    ((NwGtpv2cMsgT *) hMsg)->next = pStack->pMsgPool;
+    pStack->pMsgPool = (NwGtpv2cMsgT *) hMsg;
     return NW_OK;
   }
 
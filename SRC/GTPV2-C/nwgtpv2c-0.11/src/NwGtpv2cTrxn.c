@@ -50,8 +50,6 @@
 extern                                  "C" {
 #endif
 
-  static NwGtpv2cTrxnT                   *gpGtpv2cTrxnPool = NULL;
-
 /*--------------------------------------------------------------------------*
                      P R I V A T E      F U N C T I O N S
   --------------------------------------------------------------------------*/
@@ -181,9 +179,9 @@ extern                                  "C" {
   NW_IN NwGtpv2cStackT * thiz) {
     NwGtpv2cTrxnT                          *pTrxn;
 
-    if (gpGtpv2cTrxnPool) {
-      pTrxn = gpGtpv2cTrxnPool;
-      gpGtpv2cTrxnPool = gpGtpv2cTrxnPool->next;
+    if (thiz->pTrxnPool) {
+      pTrxn = thiz->pTrxnPool;
+      thiz->pTrxnPool = thiz->pTrxnPool->next;
     } else {
       NW_GTPV2C_MALLOC (thiz, sizeof (NwGtpv2cTrxnT), pTrxn, NwGtpv2cTrxnT *);
     }
@@ -195,12 +193,12 @@ extern                                  "C" {
       pTrxn->t3Timer = 2;
       pTrxn->seqNum = thiz->seqNum;
       /*
-       * Increment sequence number
+       * Increment sequence number, within the range of this stack instance
        */
       thiz->seqNum++;
 
-      if (thiz->seqNum == 0x800000)
-        thiz->seqNum = 0;
+      if (thiz->seqNum == thiz->seqNumEnd)
+        thiz->seqNum = thiz->seqNumFirst;
     }
 
     OAILOG_DEBUG (LOG_GTPV2C,  "Created transaction 0x%p\n", pTrxn);
@@ -219,9 +217,9 @@ extern                                  "C" {
   NW_IN uint32_t seqNum) {
     NwGtpv2cTrxnT                          *pTrxn;
 
-    if (gpGtpv2cTrxnPool) {
-      pTrxn = gpGtpv2cTrxnPool;
-      gpGtpv2cTrxnPool = gpGtpv2cTrxnPool->next;
+    if (thiz->pTrxnPool) {
+      pTrxn = thiz->pTrxnPool;
+      thiz->pTrxnPool = thiz->pTrxnPool->next;
     } else {
       NW_GTPV2C_MALLOC (thiz, sizeof (NwGtpv2cTrxnT), pTrxn, NwGtpv2cTrxnT *);
     }
@@ -261,9 +259,9 @@ extern                                  "C" {
     NwGtpv2cTrxnT                          *pTrxn,
                                            *pCollision;
 
-    if (gpGtpv2cTrxnPool) {
-      pTrxn = gpGtpv2cTrxnPool;
-      gpGtpv2cTrxnPool = gpGtpv2cTrxnPool->next;
+    if (thiz->pTrxnPool) {
+      pTrxn = thiz->pTrxnPool;
+      thiz->pTrxnPool = thiz->pTrxnPool->next;
     } else {
       NW_GTPV2C_MALLOC (thiz, sizeof (NwGtpv2cTrxnT), pTrxn, NwGtpv2cTrxnT *);
     }
@@ -326,8 +324,8 @@ extern                                  "C" {
     }
 
     OAILOG_DEBUG (LOG_GTPV2C,  "Purging  transaction 0x%p\n", thiz);
-    thiz->next = gpGtpv2cTrxnPool;
-    gpGtpv2cTrxnPool = thiz;
+    thiz->next = pStack->pTrxnPool;
+    pStack->pTrxnPool = thiz;
     *pthiz = NULL;
     return rc;
   }
@@ -45,8 +45,6 @@
 extern                                  "C" {
 #endif
 
-  static NwGtpv2cTunnelT                 *gpGtpv2cTunnelPool = NULL;
-
   NwGtpv2cTunnelT                        *nwGtpv2cTunnelNew (
   struct NwGtpv2cStack *pStack,
   uint32_t teid,
@@ -55,9 +53,9 @@ extern                                  "C" {
     NwGtpv2cTunnelT                        *thiz;
 
     if                                      (
-  gpGtpv2cTunnelPool) {
-      thiz = gpGtpv2cTunnelPool;
-      gpGtpv2cTunnelPool = gpGtpv2cTunnelPool->next;
+  pStack->pTunnelPool) {
+      thiz = pStack->pTunnelPool;
+      pStack->pTunnelPool = pStack->pTunnelPool->next;
     } else {
       NW_GTPV2C_MALLOC (pStack, sizeof (NwGtpv2cTunnelT), thiz, NwGtpv2cTunnelT *);
     }
@@ -73,10 +71,10 @@ extern                                  "C" {
   }
 
   NwRcT                                   nwGtpv2cTunnelDelete (
-  __attribute__ ((unused)) struct NwGtpv2cStack * pStack,
+  struct NwGtpv2cStack * pStack,
   NwGtpv2cTunnelT * thiz) {
-    thiz->next = gpGtpv2cTunnelPool;
-    gpGtpv2cTunnelPool = thiz;
+    thiz->next = pStack->pTunnelPool;
+    pStack->pTunnelPool = thiz;
     return NW_OK;
   }
 
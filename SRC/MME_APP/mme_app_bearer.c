@@ -44,6 +44,8 @@
 #include "mme_app_statistics.h"
 #include "timer.h"
 #include "s1ap_mme.h"
+#include "mme_app_overload.h"
+#include "mme_app_idle.h"
 
 //----------------------------------------------------------------------------
 static bool mme_app_construct_guti(const plmn_t * const plmn_p, const as_stmsi_t * const s_tmsi_p,  guti_t * const guti_p);
@@ -75,7 +77,7 @@ mme_app_send_s11_release_access_bearers_req (
 
   MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_S11_MME, NULL, 0, "0 S11_RELEASE_ACCESS_BEARERS_REQUEST teid %u ebi %u",
       release_access_bearers_request_p->teid, release_access_bearers_request_p->list_of_rabs.ebis[0]);
-  rc = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+  rc = itti_send_msg_to_task (S11_TASK_ID(release_access_bearers_request_p->local_teid), INSTANCE_DEFAULT, message_p);
   OAILOG_FUNC_RETURN (LOG_MME_APP, rc);
 }
 
@@ -93,7 +95,7 @@ mme_app_send_s11_create_session_req (
   context_identifier_t                    context_identifier = 0;
   MessageDef                             *message_p = NULL;
   itti_s11_create_session_request_t      *session_request_p = NULL;
-  struct apn_configuration_s             *default_apn_p = NULL;
+  const struct apn_configuration_s       *default_apn_p = NULL;
   int                                     rc = RETURNok;
 
   OAILOG_FUNC_IN (LOG_MME_APP);
@@ -146,14 +148,14 @@ mme_app_send_s11_create_session_req (
    */
   memcpy (&session_request_p->ambr, &ue_context_pP->subscribed_ambr, sizeof (ambr_t));
 
-  if (ue_context_pP->apn_profile.nb_apns == 0) {
+  if ((NULL == ue_context_pP->apn_profile) || (ue_context_pP->apn_profile->nb_apns == 0)) {
     DevMessage ("No APN returned by the HSS");
   }
 
-  context_identifier = ue_context_pP->apn_profile.context_identifier;
+  context_identifier = ue_context_pP->apn_profile->context_identifier;
 
-  for (i = 0; i < ue_context_pP->apn_profile.nb_apns; i++) {
-    default_apn_p = &ue_context_pP->apn_profile.apn_configuration[i];
+  for (i = 0; i < ue_context_pP->apn_profile->nb_apns; i++) {
+    default_apn_p = &ue_context_pP->apn_profile->apn_configuration[i];
 
     /*
      * OK we got our default APN
@@ -182,12 +184,10 @@ mme_app_send_s11_create_session_req (
   session_request_p->bearer_contexts_to_be_created.num_bearer_context = 1;
   /*
    * Asking for default bearer in initial UE message.
-   * Use the address of ue_context as unique TEID: Need to find better here
-   * and will generate unique id only for 32 bits platforms.
+   * The local S11 TEID is owned by the MME_APP worker of the UE so that S11 answers are routed to it.
    */
-  OAI_GCC_DIAG_OFF(pointer-to-int-cast);
-  session_request_p->sender_fteid_for_cp.teid = (teid_t) ue_context_pP;
-  OAI_GCC_DIAG_ON(pointer-to-int-cast);
+  session_request_p->sender_fteid_for_cp.teid = mme_app_ctx_get_new_s11_teid (
+      MME_APP_WORKER_INDEX(mme_config.num_app_workers, ue_context_pP->mme_ue_s1ap_id), mme_config.num_app_workers);
   session_request_p->sender_fteid_for_cp.interface_type = S11_MME_GTP_C;
   mme_config_read_lock (&mme_config);
   session_request_p->sender_fteid_for_cp.ipv4_address = mme_config.ipv4.s11;
@@ -219,7 +219,7 @@ mme_app_send_s11_create_session_req (
     uint8_t                                 j;
 
     for (j = 0; j < default_apn_p->nb_ip_address; j++) {
-      ip_address_t                           *ip_address;
+      const ip_address_t                     *ip_address;
 
       ip_address = &default_apn_p->ip_address[j];
 
@@ -232,8 +232,10 @@ mme_app_send_s11_create_session_req (
     }
   }
 
-  copy_protocol_configuration_options (&session_request_p->pco, &ue_context_pP->pending_pdn_connectivity_req_pco);
-  clear_protocol_configuration_options(&ue_context_pP->pending_pdn_connectivity_req_pco);
+  if (ue_context_pP->pending_pdn_connectivity_req) {
+    copy_protocol_configuration_options (&session_request_p->pco, &ue_context_pP->pending_pdn_connectivity_req->pco);
+    clear_protocol_configuration_options(&ue_context_pP->pending_pdn_connectivity_req->pco);
+  }
 
   mme_config_read_lock (&mme_config);
   session_request_p->peer_ip = mme_config.ipv4.sgw_s11;
@@ -247,7 +249,7 @@ mme_app_send_s11_create_session_req (
   session_request_p->selection_mode = MS_O_N_P_APN_S_V;
   MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_S11_MME, NULL, 0,
       "0 S11_CREATE_SESSION_REQUEST imsi " IMSI_64_FMT, ue_context_pP->imsi);
-  rc = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+  rc = itti_send_msg_to_task (S11_TASK_ID(session_request_p->sender_fteid_for_cp.teid), INSTANCE_DEFAULT, message_p);
   OAILOG_FUNC_RETURN (LOG_MME_APP, rc);
 }
 
@@ -259,6 +261,7 @@ mme_app_handle_nas_pdn_connectivity_req (
   itti_nas_pdn_connectivity_req_t * const nas_pdn_connectivity_req_pP)
 {
   struct ue_context_s                    *ue_context_p = NULL;
+  pending_pdn_connectivity_req_t         *pending = NULL;
   imsi64_t                                imsi64 = INVALID_IMSI64;
   int                                     rc = RETURNok;
 
@@ -279,47 +282,57 @@ mme_app_handle_nas_pdn_connectivity_req (
    */
   ue_context_p->imsi_auth = IMSI_AUTHENTICATED;
   // Temp: save request, in near future merge wisely params in context
-  memset (ue_context_p->pending_pdn_connectivity_req_imsi, 0, 16);
+  pending = mme_app_get_pending_pdn_connectivity_req (ue_context_p);
+  memset (pending->imsi, 0, 16);
   AssertFatal ((nas_pdn_connectivity_req_pP->imsi_length > 0)
                && (nas_pdn_connectivity_req_pP->imsi_length < 16), "BAD IMSI LENGTH %d", nas_pdn_connectivity_req_pP->imsi_length);
   AssertFatal ((nas_pdn_connectivity_req_pP->imsi_length > 0)
                && (nas_pdn_connectivity_req_pP->imsi_length < 16), "STOP ON IMSI LENGTH %d", nas_pdn_connectivity_req_pP->imsi_length);
-  memcpy (ue_context_p->pending_pdn_connectivity_req_imsi, nas_pdn_connectivity_req_pP->imsi, nas_pdn_connectivity_req_pP->imsi_length);
-  ue_context_p->pending_pdn_connectivity_req_imsi_length = nas_pdn_connectivity_req_pP->imsi_length;
+  memcpy (pending->imsi, nas_pdn_connectivity_req_pP->imsi, nas_pdn_connectivity_req_pP->imsi_length);
+  pending->imsi_length = nas_pdn_connectivity_req_pP->imsi_length;
 
   // copy
-  if (ue_context_p->pending_pdn_connectivity_req_apn) {
-    bdestroy (ue_context_p->pending_pdn_connectivity_req_apn);
+  if (pending->apn) {
+    bdestroy (pending->apn);
   }
-  ue_context_p->pending_pdn_connectivity_req_apn =  nas_pdn_connectivity_req_pP->apn;
+  pending->apn =  nas_pdn_connectivity_req_pP->apn;
   nas_pdn_connectivity_req_pP->apn = NULL;
 
   // copy
-  if (ue_context_p->pending_pdn_connectivity_req_pdn_addr) {
-    bdestroy (ue_context_p->pending_pdn_connectivity_req_pdn_addr);
+  if (pending->pdn_addr) {
+    bdestroy (pending->pdn_addr);
   }
-  ue_context_p->pending_pdn_connectivity_req_pdn_addr =  nas_pdn_connectivity_req_pP->pdn_addr;
+  pending->pdn_addr =  nas_pdn_connectivity_req_pP->pdn_addr;
   nas_pdn_connectivity_req_pP->pdn_addr = NULL;
 
-  ue_context_p->pending_pdn_connectivity_req_pti = nas_pdn_connectivity_req_pP->pti;
-  ue_context_p->pending_pdn_connectivity_req_ue_id = nas_pdn_connectivity_req_pP->ue_id;
-  copy_protocol_configuration_options (&ue_context_p->pending_pdn_connectivity_req_pco, &nas_pdn_connectivity_req_pP->pco);
+  pending->pti = nas_pdn_connectivity_req_pP->pti;
+  pending->ue_id = nas_pdn_connectivity_req_pP->ue_id;
+  copy_protocol_configuration_options (&pending->pco, &nas_pdn_connectivity_req_pP->pco);
   clear_protocol_configuration_options(&nas_pdn_connectivity_req_pP->pco);
 #define TEMPORARY_DEBUG 1
 #if TEMPORARY_DEBUG
-  bstring b = protocol_configuration_options_to_xml(&ue_context_p->pending_pdn_connectivity_req_pco);
+  bstring b = protocol_configuration_options_to_xml(&pending->pco);
   OAILOG_DEBUG (LOG_MME_APP, "PCO %s\n", bdata(b));
   bdestroy(b);
 #endif
 
-  memcpy (&ue_context_p->pending_pdn_connectivity_req_qos, &nas_pdn_connectivity_req_pP->qos, sizeof (network_qos_t));
-  ue_context_p->pending_pdn_connectivity_req_proc_data = nas_pdn_connectivity_req_pP->proc_data;
+  memcpy (&pending->qos, &nas_pdn_connectivity_req_pP->qos, sizeof (network_qos_t));
+  pending->proc_data = nas_pdn_connectivity_req_pP->proc_data;
   nas_pdn_connectivity_req_pP->proc_data = NULL;
-  ue_context_p->pending_pdn_connectivity_req_request_type = nas_pdn_connectivity_req_pP->request_type;
+  pending->request_type = nas_pdn_connectivity_req_pP->request_type;
   //if ((nas_pdn_connectivity_req_pP->apn.value == NULL) || (nas_pdn_connectivity_req_pP->apn.length == 0)) {
   /*
    * TODO: Get keys...
    */
+  if (mme_app_subscription_is_valid (ue_context_p)) {
+    /*
+     * The HSS already knows this MME as serving the UE, go on with the subscription data we hold
+     */
+    OAILOG_DEBUG (LOG_MME_APP, "Subscription data of imsi " IMSI_64_FMT " still valid, skipping S6A ULR\n", imsi64);
+    update_mme_app_stats_ulr_skipped_add ();
+    rc = mme_app_send_s11_create_session_req (ue_context_p);
+    OAILOG_FUNC_RETURN (LOG_MME_APP, rc);
+  }
   /*
    * Now generate S6A ULR
    */
@@ -427,6 +440,7 @@ mme_app_handle_conn_est_cnf (
 //------------------------------------------------------------------------------
 void
 mme_app_handle_initial_ue_message (
+  const int worker_index,
   itti_mme_app_initial_ue_message_t * const initial_pP)
 {
   struct ue_context_s                    *ue_context_p = NULL;
@@ -439,6 +453,13 @@ mme_app_handle_initial_ue_message (
   OAILOG_DEBUG (LOG_MME_APP, "Received MME_APP_INITIAL_UE_MESSAGE from S1AP\n");
     
   DevAssert(INVALID_MME_UE_S1AP_ID == initial_pP->mme_ue_s1ap_id);
+
+  // Overload control, shed before any lookup or allocation
+  if (!mme_app_overload_admit_initial_ue (initial_pP)) {
+    OAILOG_DEBUG (LOG_MME_APP, "MME_APP_INITIAL_UE_MESSAGE shed, MME in overload (cause %d)\n", initial_pP->as_cause);
+    mme_app_overload_reject_initial_ue (worker_index, initial_pP);
+    OAILOG_FUNC_OUT (LOG_MME_APP);
+  }
    
   // Check if there is any existing UE context using S-TMSI/GUTI
   if (initial_pP->is_s_tmsi_valid) 
@@ -467,7 +488,7 @@ mme_app_handle_initial_ue_message (
              */
 
             OAILOG_ERROR (LOG_MME_APP, "MME_APP_INITAIL_UE_MESSAGE.ERROR***** enb_s1ap_id_key %ld has valid value.\n" ,ue_context_p->enb_s1ap_id_key);
-            hashtable_ts_remove (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context_p->enb_s1ap_id_key, (void **)&id);
+            hashtable_ts_remove (ENB_UE_S1AP_ID_UE_CONTEXT_HTBL(&mme_app_desc.mme_ue_contexts, ue_context_p->enb_s1ap_id_key), (const hash_key_t)ue_context_p->enb_s1ap_id_key, (void **)&id);
             ue_context_p->enb_s1ap_id_key = INVALID_ENB_UE_S1AP_ID_KEY;
           }
           // Update MME UE context with new enb_ue_s1ap_id
@@ -505,7 +526,7 @@ mme_app_handle_initial_ue_message (
       OAILOG_FUNC_OUT (LOG_MME_APP);
     }
     // Allocate new mme_ue_s1ap_id
-    ue_context_p->mme_ue_s1ap_id    = mme_app_ctx_get_new_ue_id ();
+    ue_context_p->mme_ue_s1ap_id    = mme_app_ctx_get_new_ue_id (worker_index, mme_config.num_app_workers);
     if (ue_context_p->mme_ue_s1ap_id  == INVALID_MME_UE_S1AP_ID) {
       OAILOG_CRITICAL (LOG_MME_APP, "MME_APP_INITIAL_UE_MESSAGE. MME_UE_S1AP_ID allocation Failed.\n");
       mme_remove_ue_context (&mme_app_desc.mme_ue_contexts, ue_context_p);
@@ -520,9 +541,8 @@ mme_app_handle_initial_ue_message (
   ue_context_p->e_utran_cgi = initial_pP->cgi;
   // Notify S1AP about the mapping between mme_ue_s1ap_id and sctp assoc id + enb_ue_s1ap_id 
   notify_s1ap_new_ue_mme_s1ap_id_association (ue_context_p);
-  // Initialize timers to INVALID IDs
-  ue_context_p->mobile_reachability_timer.id = MME_APP_TIMER_INACTIVE_ID;
-  ue_context_p->implicit_detach_timer.id = MME_APP_TIMER_INACTIVE_ID;
+  // Stop the idle UE timers of a known UE
+  mme_app_idle_timer_stop (ue_context_p);
 
   message_p = itti_alloc_new_message (TASK_MME_APP, NAS_INITIAL_UE_MESSAGE);
   // do this because of same message types name but not same struct in different .h
@@ -539,7 +559,7 @@ mme_app_handle_initial_ue_message (
   message_p->ittiMsg.nas_initial_ue_message.nas.initial_nas_msg   =  initial_pP->nas;
   memcpy (&message_p->ittiMsg.nas_initial_ue_message.transparent, (const void*)&initial_pP->transparent, sizeof (message_p->ittiMsg.nas_initial_ue_message.transparent));
   MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_NAS_MME, NULL, 0, "0 NAS_INITIAL_UE_MESSAGE");
-  itti_send_msg_to_task (TASK_NAS_MME, INSTANCE_DEFAULT, message_p);
+  itti_send_msg_to_task (NAS_MME_TASK_ID(ue_context_p->mme_ue_s1ap_id), INSTANCE_DEFAULT, message_p);
   OAILOG_FUNC_OUT (LOG_MME_APP);
 }
 
@@ -562,7 +582,7 @@ mme_app_handle_delete_session_rsp (
     OAILOG_WARNING (LOG_MME_APP, "We didn't find this teid in list of UE: %08x\n", delete_sess_resp_pP->teid);
     OAILOG_FUNC_OUT (LOG_MME_APP);
   }
-  hashtable_ts_remove(mme_app_desc.mme_ue_contexts.tun11_ue_context_htbl,
+  hashtable_ts_remove(TUN11_UE_CONTEXT_HTBL(&mme_app_desc.mme_ue_contexts, ue_context_p->mme_s11_teid),
                       (const hash_key_t) ue_context_p->mme_s11_teid, &id);
   ue_context_p->mme_s11_teid = 0;
   ue_context_p->sgw_s11_teid = 0;
@@ -606,6 +626,7 @@ mme_app_handle_create_sess_resp (
 {
   struct ue_context_s                    *ue_context_p = NULL;
   bearer_context_t                       *current_bearer_p = NULL;
+  pending_pdn_connectivity_req_t         *pending = NULL;
   MessageDef                             *message_p = NULL;
   int16_t                                 bearer_id =0;
   int                                     rc = RETURNok;
@@ -624,6 +645,13 @@ mme_app_handle_create_sess_resp (
   MSC_LOG_RX_MESSAGE (MSC_MMEAPP_MME, MSC_S11_MME, NULL, 0, "0 CREATE_SESSION_RESPONSE local S11 teid " TEID_FMT " IMSI " IMSI_64_FMT " ",
     create_sess_resp_pP->teid, ue_context_p->imsi);
 
+  pending = ue_context_p->pending_pdn_connectivity_req;
+  if (pending == NULL) {
+    OAILOG_WARNING (LOG_MME_APP, "No pending PDN connectivity request for UE " MME_UE_S1AP_ID_FMT ", discarding CREATE_SESSION_RESPONSE\n",
+        ue_context_p->mme_ue_s1ap_id);
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+  }
+
   /* Whether SGW has created the session (IP address allocation, local GTP-U end point creation etc.) 
    * successfully or not , it is indicated by cause value in create session response message.
    * If cause value is not equal to "REQUEST_ACCEPTED" then this implies that SGW could not allocate the resources for
@@ -637,10 +665,11 @@ mme_app_handle_create_sess_resp (
     message_p = itti_alloc_new_message (TASK_MME_APP, NAS_PDN_CONNECTIVITY_FAIL);
     itti_nas_pdn_connectivity_fail_t *nas_pdn_connectivity_fail = &message_p->ittiMsg.nas_pdn_connectivity_fail;
     memset ((void *)nas_pdn_connectivity_fail, 0, sizeof (itti_nas_pdn_connectivity_fail_t));
-    nas_pdn_connectivity_fail->pti = ue_context_p->pending_pdn_connectivity_req_pti;  
-    nas_pdn_connectivity_fail->ue_id = ue_context_p->pending_pdn_connectivity_req_ue_id; 
+    nas_pdn_connectivity_fail->pti = pending->pti;  
+    nas_pdn_connectivity_fail->ue_id = pending->ue_id; 
     nas_pdn_connectivity_fail->cause = (pdn_conn_rsp_cause_t)(create_sess_resp_pP->cause); 
-    rc = itti_send_msg_to_task (TASK_NAS_MME, INSTANCE_DEFAULT, message_p);
+    mme_app_free_pending_pdn_connectivity_req (ue_context_p);
+    rc = itti_send_msg_to_task (NAS_MME_TASK_ID(nas_pdn_connectivity_fail->ue_id), INSTANCE_DEFAULT, message_p);
     OAILOG_FUNC_RETURN (LOG_MME_APP, rc);
   }
 
@@ -724,7 +753,7 @@ mme_app_handle_create_sess_resp (
     OAILOG_DEBUG (LOG_MME_APP, "Set qci %u in bearer %u\n", current_bearer_p->qci, ue_context_p->default_bearer_id);
   } else {
     // if null, it is not modified
-    //current_bearer_p->qci                    = ue_context_p->pending_pdn_connectivity_req_qos.qci;
+    //current_bearer_p->qci                    = pending->qos.qci;
 //#pragma message  "may force QCI here to 9"
     current_bearer_p->qci = 9;
     current_bearer_p->prio_level = 1;
@@ -743,26 +772,26 @@ mme_app_handle_create_sess_resp (
     //derive_keNB(ue_context_p->vector_in_use->kasme, 156, &keNB);
     //memcpy(NAS_PDN_CONNECTIVITY_RSP(message_p).keNB, keNB, 32);
     //free(keNB);
-    nas_pdn_connectivity_rsp->pti = ue_context_p->pending_pdn_connectivity_req_pti;  // NAS internal ref
-    nas_pdn_connectivity_rsp->ue_id = ue_context_p->pending_pdn_connectivity_req_ue_id;      // NAS internal ref
+    nas_pdn_connectivity_rsp->pti = pending->pti;  // NAS internal ref
+    nas_pdn_connectivity_rsp->ue_id = pending->ue_id;      // NAS internal ref
 
     // TO REWORK:
-    if (ue_context_p->pending_pdn_connectivity_req_apn) {
-      nas_pdn_connectivity_rsp->apn = bstrcpy (ue_context_p->pending_pdn_connectivity_req_apn);
+    if (pending->apn) {
+      nas_pdn_connectivity_rsp->apn = bstrcpy (pending->apn);
       OAILOG_DEBUG (LOG_MME_APP, "SET APN FROM NAS PDN CONNECTIVITY CREATE: %s\n", bdata(nas_pdn_connectivity_rsp->apn));
     } else {
       int                                     i;
-      context_identifier_t                    context_identifier = ue_context_p->apn_profile.context_identifier;
+      context_identifier_t                    context_identifier = ue_context_p->apn_profile->context_identifier;
 
-      for (i = 0; i < ue_context_p->apn_profile.nb_apns; i++) {
-        if (ue_context_p->apn_profile.apn_configuration[i].context_identifier == context_identifier) {
-          AssertFatal (ue_context_p->apn_profile.apn_configuration[i].service_selection_length > 0, "Bad APN string (len = 0)");
+      for (i = 0; i < ue_context_p->apn_profile->nb_apns; i++) {
+        if (ue_context_p->apn_profile->apn_configuration[i].context_identifier == context_identifier) {
+          AssertFatal (ue_context_p->apn_profile->apn_configuration[i].service_selection_length > 0, "Bad APN string (len = 0)");
 
-          if (ue_context_p->apn_profile.apn_configuration[i].service_selection_length > 0) {
-            nas_pdn_connectivity_rsp->apn = blk2bstr(ue_context_p->apn_profile.apn_configuration[i].service_selection,
-                ue_context_p->apn_profile.apn_configuration[i].service_selection_length);
-            AssertFatal (ue_context_p->apn_profile.apn_configuration[i].service_selection_length <= APN_MAX_LENGTH, "Bad APN string length %d",
-                ue_context_p->apn_profile.apn_configuration[i].service_selection_length);
+          if (ue_context_p->apn_profile->apn_configuration[i].service_selection_length > 0) {
+            nas_pdn_connectivity_rsp->apn = blk2bstr(ue_context_p->apn_profile->apn_configuration[i].service_selection,
+                ue_context_p->apn_profile->apn_configuration[i].service_selection_length);
+            AssertFatal (ue_context_p->apn_profile->apn_configuration[i].service_selection_length <= APN_MAX_LENGTH, "Bad APN string length %d",
+                ue_context_p->apn_profile->apn_configuration[i].service_selection_length);
 
             OAILOG_DEBUG (LOG_MME_APP, "SET APN FROM HSS ULA: %s\n", bdata(nas_pdn_connectivity_rsp->apn));
             break;
@@ -802,11 +831,10 @@ mme_app_handle_create_sess_resp (
     }
 
     nas_pdn_connectivity_rsp->pdn_type = create_sess_resp_pP->paa.pdn_type;
-    nas_pdn_connectivity_rsp->proc_data = ue_context_p->pending_pdn_connectivity_req_proc_data;      // NAS internal ref
-    ue_context_p->pending_pdn_connectivity_req_proc_data = NULL;
+    nas_pdn_connectivity_rsp->proc_data = pending->proc_data;      // NAS internal ref
 //#pragma message  "QOS hardcoded here"
     //memcpy(&NAS_PDN_CONNECTIVITY_RSP(message_p).qos,
-    //        &ue_context_p->pending_pdn_connectivity_req_qos,
+    //        &pending->qos,
     //        sizeof(network_qos_t));
     nas_pdn_connectivity_rsp->qos.gbrUL = 64;        /* 64=64kb/s   Guaranteed Bit Rate for uplink   */
     nas_pdn_connectivity_rsp->qos.gbrDL = 120;       /* 120=512kb/s Guaranteed Bit Rate for downlink */
@@ -817,8 +845,8 @@ mme_app_handle_create_sess_resp (
      * in Activate Default EPS Bearer Context Setup Request message 
      */ 
     nas_pdn_connectivity_rsp->qos.qci = 9;   /* QoS Class Identifier                           */
-    nas_pdn_connectivity_rsp->request_type = ue_context_p->pending_pdn_connectivity_req_request_type;        // NAS internal ref
-    ue_context_p->pending_pdn_connectivity_req_request_type = 0;
+    nas_pdn_connectivity_rsp->request_type = pending->request_type;        // NAS internal ref
+    mme_app_free_pending_pdn_connectivity_req (ue_context_p);
     // here at this point OctetString are saved in resp, no loss of memory (apn, pdn_addr)
     nas_pdn_connectivity_rsp->ue_id = ue_context_p->mme_ue_s1ap_id;
     nas_pdn_connectivity_rsp->ebi = bearer_id;
@@ -835,7 +863,7 @@ mme_app_handle_create_sess_resp (
 
     MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_NAS_MME, NULL, 0, "0 NAS_PDN_CONNECTIVITY_RSP sgw_s1u_teid %u ebi %u qci %u prio %u", current_bearer_p->s_gw_teid, bearer_id, current_bearer_p->qci, current_bearer_p->prio_level);
 
-    rc = itti_send_msg_to_task (TASK_NAS_MME, INSTANCE_DEFAULT, message_p);
+    rc = itti_send_msg_to_task (NAS_MME_TASK_ID(nas_pdn_connectivity_rsp->ue_id), INSTANCE_DEFAULT, message_p);
     OAILOG_FUNC_RETURN (LOG_MME_APP, rc);
   }
   OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNok);
@@ -890,7 +918,7 @@ mme_app_handle_initial_context_setup_rsp (
   MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME,  MSC_S11_MME ,
                       NULL, 0, "0 S11_MODIFY_BEARER_REQUEST teid %u ebi %u", s11_modify_bearer_request->teid,
                       s11_modify_bearer_request->bearer_contexts_to_be_modified.bearer_contexts[0].eps_bearer_id);
-  itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+  itti_send_msg_to_task (S11_TASK_ID(s11_modify_bearer_request->local_teid), INSTANCE_DEFAULT, message_p);
 
   OAILOG_FUNC_OUT (LOG_MME_APP);
 }
@@ -932,16 +960,10 @@ mme_app_handle_mobile_reachability_timer_expiry (struct ue_context_s *ue_context
 {
   OAILOG_FUNC_IN (LOG_MME_APP);
   DevAssert (ue_context_p != NULL);
-  ue_context_p->mobile_reachability_timer.id = MME_APP_TIMER_INACTIVE_ID;
   OAILOG_DEBUG (LOG_MME_APP, "Expired- Mobile Reachability Timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
   // Start Implicit Detach timer 
-  if (timer_setup (ue_context_p->implicit_detach_timer.sec, 0, 
-                TASK_MME_APP, INSTANCE_DEFAULT, TIMER_ONE_SHOT, (void *)&(ue_context_p->mme_ue_s1ap_id), &(ue_context_p->implicit_detach_timer.id)) < 0) { 
-    OAILOG_ERROR (LOG_MME_APP, "Failed to start Implicit Detach timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
-    ue_context_p->implicit_detach_timer.id = MME_APP_TIMER_INACTIVE_ID;
-  } else {
-    OAILOG_DEBUG (LOG_MME_APP, "Started Implicit Detach timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
-  }
+  mme_app_idle_timer_start (ue_context_p, MME_APP_IDLE_TIMER_IMPLICIT_DETACH, ue_context_p->implicit_detach_timer_sec);
+  OAILOG_DEBUG (LOG_MME_APP, "Started Implicit Detach timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
   OAILOG_FUNC_OUT (LOG_MME_APP);
 }
 //------------------------------------------------------------------------------
@@ -952,14 +974,13 @@ mme_app_handle_implicit_detach_timer_expiry (struct ue_context_s *ue_context_p)
   DevAssert (ue_context_p != NULL);
   MessageDef                             *message_p = NULL;
   OAILOG_DEBUG (LOG_MME_APP, "Expired- Implicit Detach timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
-  ue_context_p->implicit_detach_timer.id = MME_APP_TIMER_INACTIVE_ID;
   
   // Initiate Implicit Detach for the UE
   message_p = itti_alloc_new_message (TASK_MME_APP, NAS_IMPLICIT_DETACH_UE_IND);
   DevAssert (message_p != NULL);
   message_p->ittiMsg.nas_implicit_detach_ue_ind.ue_id = ue_context_p->mme_ue_s1ap_id;
   MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_NAS_MME, NULL, 0, "0 NAS_IMPLICIT_DETACH_UE_IND_MESSAGE");
-  itti_send_msg_to_task (TASK_NAS_MME, INSTANCE_DEFAULT, message_p);
+  itti_send_msg_to_task (NAS_MME_TASK_ID(ue_context_p->mme_ue_s1ap_id), INSTANCE_DEFAULT, message_p);
   OAILOG_FUNC_OUT (LOG_MME_APP);
 }
 
@@ -974,49 +995,38 @@ static bool mme_app_construct_guti(const plmn_t * const plmn_p, const as_stmsi_t
    */
   
   bool                                    is_guti_valid = false; // Set to true if serving MME is found and GUTI is constructed 
-  uint8_t                                 num_mme       = 0;     // Number of configured MME in the MME pool  
+  mme_config_served_t                    *served        = NULL;
+  const gummei_t                         *gummei_p      = NULL;  // Serving MME found in the MME pool
   guti_p->m_tmsi = s_tmsi_p->m_tmsi;
   guti_p->gummei.mme_code = s_tmsi_p->mme_code;
   // Create GUTI by using PLMN Id and MME-Group Id of serving MME
   OAILOG_DEBUG (LOG_MME_APP,
                 "Construct GUTI using S-TMSI received form UE and MME Group Id and PLMN id from MME Conf: %u, %u \n",
                 s_tmsi_p->m_tmsi, s_tmsi_p->mme_code);
-  mme_config_read_lock (&mme_config);
+  served = mme_config_served_acquire ();
   /*
    * Check number of MMEs in the pool.
    * At present it is assumed that one MME is supported in MME pool but in case there are more 
    * than one MME configured then search the serving MME using MME code. 
    * Assumption is that within one PLMN only one pool of MME will be configured
    */
-  if (mme_config.gummei.nb > 1) 
+  if (served->nb_gummei > 1) 
   {
     OAILOG_DEBUG (LOG_MME_APP, "More than one MMEs are configured.");
   }
-  for (num_mme = 0; num_mme < mme_config.gummei.nb; num_mme++)
-  {
-    /*Verify that the MME code within S-TMSI is same as what is configured in MME conf*/
-    if ((plmn_p->mcc_digit2 == mme_config.gummei.gummei[num_mme].plmn.mcc_digit2) &&
-        (plmn_p->mcc_digit1 == mme_config.gummei.gummei[num_mme].plmn.mcc_digit1) &&
-        (plmn_p->mnc_digit3 == mme_config.gummei.gummei[num_mme].plmn.mnc_digit3) &&
-        (plmn_p->mcc_digit3 == mme_config.gummei.gummei[num_mme].plmn.mcc_digit3) &&
-        (plmn_p->mnc_digit2 == mme_config.gummei.gummei[num_mme].plmn.mnc_digit2) && 
-        (plmn_p->mnc_digit1 == mme_config.gummei.gummei[num_mme].plmn.mnc_digit1) &&
-        (guti_p->gummei.mme_code == mme_config.gummei.gummei[num_mme].mme_code))
-    {
-      break;
-    }
-  }          
-  if (num_mme >= mme_config.gummei.nb)
+  /*Verify that the MME code within S-TMSI is same as what is configured in MME conf*/
+  gummei_p = mme_config_served_find_gummei (served, plmn_p, guti_p->gummei.mme_code);
+  if (!gummei_p)
   {
     OAILOG_DEBUG (LOG_MME_APP, "No MME serves this UE");
   }
   else 
   {
-    guti_p->gummei.plmn = mme_config.gummei.gummei[num_mme].plmn;
-    guti_p->gummei.mme_gid = mme_config.gummei.gummei[num_mme].mme_gid;
+    guti_p->gummei.plmn = gummei_p->plmn;
+    guti_p->gummei.mme_gid = gummei_p->mme_gid;
     is_guti_valid = true;
   }
-  mme_config_unlock (&mme_config);
+  mme_config_served_release (served);
   return is_guti_valid;
 }
 
@@ -34,14 +34,17 @@
 #include "msc.h"
 #include "common_types.h"
 #include "conversions.h"
+#include "guti_key.h"
 #include "intertask_interface.h"
 #include "enum_string.h"
 #include "mme_app_ue_context.h"
 #include "mme_app_defs.h"
+#include "mme_app_idle.h"
+#include "mme_config.h"
 #include "mme_app_itti_messaging.h"
 #include "s1ap_mme.h"
-#include "timer.h"
 #include "mme_app_statistics.h"
+#include "mme_app_subscription_profile.h"
 
 
 static void _mme_app_handle_s1ap_ue_context_release (const mme_ue_s1ap_id_t mme_ue_s1ap_id,
@@ -49,6 +52,47 @@ static void _mme_app_handle_s1ap_ue_context_release (const mme_ue_s1ap_id_t mme_
                                                      uint32_t enb_id,
                                                      enum s1cause cause);
 
+static void mme_app_ue_context_free (void **ue_context_pp);
+
+
+//------------------------------------------------------------------------------
+void mme_ue_context_init (mme_ue_context_t * const mme_ue_context_p, const int nb_shards, const hash_size_t max_ues)
+{
+  // each shard is sized for an even share of the UEs
+  const hash_size_t                       shard_size = (max_ues + nb_shards - 1) / nb_shards;
+  bstring                                 b = bfromcstr (" ");
+
+  AssertFatal ((nb_shards >= 1) && (nb_shards <= MME_UE_CONTEXT_SHARDS_MAX), "Bad number of UE context shards %d", nb_shards);
+  AssertFatal (sizeof(uintptr_t) >= sizeof(uint64_t), "Problem with mme_ue_s1ap_id_ue_context_htbl in MME_APP");
+  memset (mme_ue_context_p, 0, sizeof (*mme_ue_context_p));
+  mme_ue_context_p->nb_shards = nb_shards;
+  for (int i = 0; i < nb_shards; i++) {
+    bassignformat (b, "mme_app_imsi_ue_context_htbl_%d", i);
+    mme_ue_context_p->imsi_ue_context_htbl[i] = hashtable_ts_create (shard_size, NULL, hash_free_int_func, b);
+    bassignformat (b, "mme_app_tun11_ue_context_htbl_%d", i);
+    mme_ue_context_p->tun11_ue_context_htbl[i] = hashtable_ts_create (shard_size, NULL, hash_free_int_func, b);
+    bassignformat (b, "mme_app_mme_ue_s1ap_id_ue_context_htbl_%d", i);
+    mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl[i] = hashtable_ts_create (shard_size, NULL, mme_app_ue_context_free, b);
+    bassignformat (b, "mme_app_enb_ue_s1ap_id_ue_context_htbl_%d", i);
+    mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl[i] = hashtable_ts_create (shard_size, NULL, hash_free_int_func, b);
+    bassignformat (b, "mme_app_guti_ue_context_htbl_%d", i);
+    mme_ue_context_p->guti_ue_context_htbl[i] = hashtable_ts_create (shard_size, NULL, hash_free_int_func, b);
+  }
+  bdestroy (b);
+}
+
+//------------------------------------------------------------------------------
+void mme_ue_context_exit (mme_ue_context_t * const mme_ue_context_p)
+{
+  for (int i = 0; i < mme_ue_context_p->nb_shards; i++) {
+    hashtable_ts_destroy (mme_ue_context_p->imsi_ue_context_htbl[i]);
+    hashtable_ts_destroy (mme_ue_context_p->tun11_ue_context_htbl[i]);
+    hashtable_ts_destroy (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl[i]);
+    hashtable_ts_destroy (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl[i]);
+    hashtable_ts_destroy (mme_ue_context_p->guti_ue_context_htbl[i]);
+  }
+  mme_ue_context_p->nb_shards = 0;
+}
 
 //------------------------------------------------------------------------------
 ue_context_t *mme_create_new_ue_context (void)
@@ -56,9 +100,6 @@ ue_context_t *mme_create_new_ue_context (void)
   ue_context_t                           *new_p = calloc (1, sizeof (ue_context_t));
   new_p->mme_ue_s1ap_id = INVALID_MME_UE_S1AP_ID;
   new_p->enb_s1ap_id_key = INVALID_ENB_UE_S1AP_ID_KEY;
-  // Initialize timers to INVALID IDs
-  new_p->mobile_reachability_timer.id = MME_APP_TIMER_INACTIVE_ID;
-  new_p->implicit_detach_timer.id = MME_APP_TIMER_INACTIVE_ID;
   return new_p;
 }
 
@@ -82,7 +123,6 @@ void mme_app_ue_context_free_content (ue_context_t * const ue_context_p)
   //  ecgi_t                  e_utran_cgi;
   //  time_t                 cell_age;
   //  network_access_mode_t  access_mode;
-  //  apn_config_profile_t   apn_profile;
   //  ard_t                  access_restriction_data;
   //  subscriber_status_t    sub_status;
   //  ambr_t                 subscribed_ambr;
@@ -92,42 +132,53 @@ void mme_app_ue_context_free_content (ue_context_t * const ue_context_p)
   // teid_t                 mme_s11_teid;
   // teid_t                 sgw_s11_teid;
   // PAA_t                  paa;
-  // char                   pending_pdn_connectivity_req_imsi[16];
-  // uint8_t                pending_pdn_connectivity_req_imsi_length;
   DevAssert(ue_context_p != NULL);
-  bdestroy(ue_context_p->pending_pdn_connectivity_req_apn);
-  bdestroy(ue_context_p->pending_pdn_connectivity_req_pdn_addr);
+  mme_app_free_pending_pdn_connectivity_req(ue_context_p);
+  subscription_profile_release (&ue_context_p->apn_profile);
   
-  // Stop Mobile reachability timer,if running 
-  if (ue_context_p->mobile_reachability_timer.id != MME_APP_TIMER_INACTIVE_ID) {
-    if (timer_remove(ue_context_p->mobile_reachability_timer.id)) {
-
-      OAILOG_ERROR (LOG_MME_APP, "Failed to stop Mobile Reachability timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
-    } 
-    ue_context_p->mobile_reachability_timer.id = MME_APP_TIMER_INACTIVE_ID;
-  }
-  // Stop Implicit detach timer,if running 
-  if (ue_context_p->implicit_detach_timer.id != MME_APP_TIMER_INACTIVE_ID) {
-    if (timer_remove(ue_context_p->implicit_detach_timer.id)) {
-      OAILOG_ERROR (LOG_MME_APP, "Failed to stop Implicit Detach timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
-    } 
-    ue_context_p->implicit_detach_timer.id = MME_APP_TIMER_INACTIVE_ID;
-  }
+  // Stop Mobile reachability or Implicit detach timer,if running 
+  mme_app_idle_timer_stop (ue_context_p);
   if (ue_context_p->ue_radio_capabilities) {
     free_wrapper((void**) &(ue_context_p->ue_radio_capabilities));
   }
-  // int                    pending_pdn_connectivity_req_pti;
-  // unsigned               pending_pdn_connectivity_req_ue_id;
-  // network_qos_t          pending_pdn_connectivity_req_qos;
-  // pco_flat_t             pending_pdn_connectivity_req_pco;
-  // DO NOT FREE THE FOLLOWING POINTER, IT IS esm_proc_data_t*
-  // void                  *pending_pdn_connectivity_req_proc_data;
-  //int                    pending_pdn_connectivity_req_request_type;
   //ebi_t                  default_bearer_id;
   //bearer_context_t       eps_bearers[BEARERS_PER_UE];
 
 }
 
+//------------------------------------------------------------------------------
+// The MME UE S1AP ID collection owns the UE contexts, those left at exit give back their subscription profile
+static void mme_app_ue_context_free (void **ue_context_pp)
+{
+  mme_app_ue_context_free_content ((ue_context_t *)*ue_context_pp);
+  free_wrapper (ue_context_pp);
+}
+
+//------------------------------------------------------------------------------
+pending_pdn_connectivity_req_t *mme_app_get_pending_pdn_connectivity_req (ue_context_t * const ue_context_p)
+{
+  DevAssert(ue_context_p != NULL);
+  if (!ue_context_p->pending_pdn_connectivity_req) {
+    ue_context_p->pending_pdn_connectivity_req = calloc (1, sizeof (pending_pdn_connectivity_req_t));
+    AssertFatal(ue_context_p->pending_pdn_connectivity_req, "Failed to allocate pending PDN connectivity request\n");
+  }
+  return ue_context_p->pending_pdn_connectivity_req;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_free_pending_pdn_connectivity_req (ue_context_t * const ue_context_p)
+{
+  pending_pdn_connectivity_req_t *pending = ue_context_p->pending_pdn_connectivity_req;
+
+  if (pending) {
+    bdestroy(pending->apn);
+    bdestroy(pending->pdn_addr);
+    clear_protocol_configuration_options(&pending->pco);
+    // proc_data is owned by NAS
+    free_wrapper((void**) &ue_context_p->pending_pdn_connectivity_req);
+  }
+}
+
 //------------------------------------------------------------------------------
 ue_context_t                           *
 mme_ue_context_exists_enb_ue_s1ap_id (
@@ -137,7 +188,7 @@ mme_ue_context_exists_enb_ue_s1ap_id (
   hashtable_rc_t                          h_rc = HASH_TABLE_OK;
   void                                   *id = NULL;
   
-  hashtable_ts_get (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)enb_key, (void **)&id);
+  hashtable_ts_get (ENB_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, enb_key), (const hash_key_t)enb_key, (void **)&id);
   
   if (HASH_TABLE_OK == h_rc) {
     return mme_ue_context_exists_mme_ue_s1ap_id (mme_ue_context_p, (mme_ue_s1ap_id_t)(uintptr_t) id);
@@ -153,7 +204,7 @@ mme_ue_context_exists_mme_ue_s1ap_id (
 {
   struct ue_context_s                    *ue_context_p = NULL;
 
-  hashtable_ts_get (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void **)&ue_context_p);
+  hashtable_ts_get (MME_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, mme_ue_s1ap_id), (const hash_key_t)mme_ue_s1ap_id, (void **)&ue_context_p);
   return ue_context_p;
 
 }
@@ -166,7 +217,7 @@ mme_ue_context_exists_imsi (
   hashtable_rc_t                          h_rc = HASH_TABLE_OK;
   void                                   *id = NULL;
 
-  h_rc = hashtable_ts_get (mme_ue_context_p->imsi_ue_context_htbl, (const hash_key_t)imsi, (void **)&id);
+  h_rc = hashtable_ts_get (IMSI_UE_CONTEXT_HTBL(mme_ue_context_p, imsi), (const hash_key_t)imsi, (void **)&id);
 
   if (HASH_TABLE_OK == h_rc) {
     return mme_ue_context_exists_mme_ue_s1ap_id (mme_ue_context_p, (mme_ue_s1ap_id_t)(uintptr_t) id);
@@ -184,7 +235,7 @@ mme_ue_context_exists_s11_teid (
   hashtable_rc_t                          h_rc = HASH_TABLE_OK;
   void                                   *id = NULL;
 
-  h_rc = hashtable_ts_get (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)teid, (void **)&id);
+  h_rc = hashtable_ts_get (TUN11_UE_CONTEXT_HTBL(mme_ue_context_p, teid), (const hash_key_t)teid, (void **)&id);
 
   if (HASH_TABLE_OK == h_rc) {
     return mme_ue_context_exists_mme_ue_s1ap_id (mme_ue_context_p, (mme_ue_s1ap_id_t)(uintptr_t) id);
@@ -201,7 +252,7 @@ mme_ue_context_exists_guti (
   hashtable_rc_t                          h_rc = HASH_TABLE_OK;
   void                                   *id = NULL;
 
-  h_rc = obj_hashtable_ts_get (mme_ue_context_p->guti_ue_context_htbl, (const void *)guti_p, sizeof (*guti_p), (void **)&id);
+  h_rc = hashtable_ts_get (GUTI_UE_CONTEXT_HTBL(mme_ue_context_p, guti_p), (const hash_key_t)guti_key (guti_p), (void **)&id);
 
   if (HASH_TABLE_OK == h_rc) {
     return mme_ue_context_exists_mme_ue_s1ap_id (mme_ue_context_p, (mme_ue_s1ap_id_t)(uintptr_t)id);
@@ -210,6 +261,24 @@ mme_ue_context_exists_guti (
   return NULL;
 }
 
+//------------------------------------------------------------------------------
+// HASH_TABLE_INSERT_OVERWRITTEN_DATA when the same GUTI was still registered for another UE
+static hashtable_rc_t
+mme_ue_context_insert_guti (
+  mme_ue_context_t * const mme_ue_context_p,
+  const guti_t * const guti_p,
+  const mme_ue_s1ap_id_t mme_ue_s1ap_id)
+{
+  guti_key_t                              key = INVALID_GUTI_KEY;
+
+  if (RETURNok != guti_key_new (guti_p, &key)) {
+    OAILOG_WARNING (LOG_MME_APP, "Too many PLMNs in GUTIs, mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " cannot be found by guti " GUTI_FMT "\n",
+        mme_ue_s1ap_id, GUTI_ARG(guti_p));
+    return HASH_TABLE_BAD_PARAMETER_KEY;
+  }
+  return hashtable_ts_insert (GUTI_UE_CONTEXT_HTBL(mme_ue_context_p, guti_p), (const hash_key_t)key, (void *)(uintptr_t)mme_ue_s1ap_id);
+}
+
 //------------------------------------------------------------------------------
 void mme_app_move_context (ue_context_t *dst, ue_context_t *src)
 {
@@ -222,6 +291,7 @@ void mme_app_move_context (ue_context_t *dst, ue_context_t *src)
     //mme_ue_s1ap_id
     dst->sctp_assoc_id_key       = src->sctp_assoc_id_key;
     dst->subscription_known      = src->subscription_known;
+    dst->subscription_visited_plmn = src->subscription_visited_plmn;
     memcpy((void *)dst->msisdn, (const void *)src->msisdn, sizeof(src->msisdn));
     dst->msisdn_length           = src->msisdn_length;src->msisdn_length = 0;
     dst->mm_state                = src->mm_state;
@@ -232,7 +302,9 @@ void mme_app_move_context (ue_context_t *dst, ue_context_t *src)
     dst->e_utran_cgi             = src->e_utran_cgi;
     dst->cell_age                = src->cell_age;
     dst->access_mode             = src->access_mode;
+    subscription_profile_release (&dst->apn_profile);
     dst->apn_profile             = src->apn_profile;
+    src->apn_profile             = NULL;
     dst->access_restriction_data = src->access_restriction_data;
     dst->sub_status              = src->sub_status;
     dst->subscribed_ambr         = src->subscribed_ambr;
@@ -240,20 +312,9 @@ void mme_app_move_context (ue_context_t *dst, ue_context_t *src)
     dst->rau_tau_timer           = src->rau_tau_timer;
     dst->mme_s11_teid            = src->mme_s11_teid;
     dst->sgw_s11_teid            = src->sgw_s11_teid;
-    memcpy((void *)dst->pending_pdn_connectivity_req_imsi, (const void *)src->pending_pdn_connectivity_req_imsi, sizeof(src->pending_pdn_connectivity_req_imsi));
-    dst->pending_pdn_connectivity_req_imsi_length = src->pending_pdn_connectivity_req_imsi_length;
-    dst->pending_pdn_connectivity_req_apn         = src->pending_pdn_connectivity_req_apn;
-    src->pending_pdn_connectivity_req_apn         = NULL;
-
-    dst->pending_pdn_connectivity_req_pdn_addr    = src->pending_pdn_connectivity_req_pdn_addr;
-    src->pending_pdn_connectivity_req_pdn_addr    = NULL;
-    dst->pending_pdn_connectivity_req_pti         = src->pending_pdn_connectivity_req_pti;
-    dst->pending_pdn_connectivity_req_ue_id       = src->pending_pdn_connectivity_req_ue_id;
-    dst->pending_pdn_connectivity_req_qos         = src->pending_pdn_connectivity_req_qos;
-    dst->pending_pdn_connectivity_req_pco         = src->pending_pdn_connectivity_req_pco;
-    dst->pending_pdn_connectivity_req_proc_data   = src->pending_pdn_connectivity_req_proc_data;
-    src->pending_pdn_connectivity_req_proc_data   = NULL;
-    dst->pending_pdn_connectivity_req_request_type= src->pending_pdn_connectivity_req_request_type;
+    mme_app_free_pending_pdn_connectivity_req(dst);
+    dst->pending_pdn_connectivity_req = src->pending_pdn_connectivity_req;
+    src->pending_pdn_connectivity_req = NULL;
     dst->default_bearer_id       = src->default_bearer_id;
     memcpy((void *)dst->eps_bearers, (const void *)src->eps_bearers, sizeof(bearer_context_t)*BEARERS_PER_UE);
     OAILOG_DEBUG (LOG_MME_APP,
@@ -289,7 +350,7 @@ mme_ue_context_duplicate_enb_ue_s1ap_id_detected (
         enb_ue_s1ap_id, mme_ue_s1ap_id);
     OAILOG_FUNC_OUT (LOG_MME_APP);
   }
-  h_rc = hashtable_ts_get (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id,  (void **)&id);
+  h_rc = hashtable_ts_get (MME_UE_S1AP_ID_UE_CONTEXT_HTBL(&mme_app_desc.mme_ue_contexts, mme_ue_s1ap_id), (const hash_key_t)mme_ue_s1ap_id,  (void **)&id);
   if (HASH_TABLE_OK == h_rc) {
     old_enb_key = (enb_s1ap_id_key_t)(uintptr_t) id;
     if (old_enb_key != enb_key) {
@@ -299,12 +360,12 @@ mme_ue_context_duplicate_enb_ue_s1ap_id_detected (
          * Insert and remove need to be corrected. mme_ue_s1ap_id is used to point to context ptr and
          * enb_ue_s1ap_id_key is used to point to mme_ue_s1ap_id
          */ 
-        h_rc = hashtable_ts_remove (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void **)&id);
-        h_rc = hashtable_ts_insert (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void *)(uintptr_t)enb_key);
-        h_rc = hashtable_ts_remove (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)old_enb_key, (void **)&old);
+        h_rc = hashtable_ts_remove (MME_UE_S1AP_ID_UE_CONTEXT_HTBL(&mme_app_desc.mme_ue_contexts, mme_ue_s1ap_id), (const hash_key_t)mme_ue_s1ap_id, (void **)&id);
+        h_rc = hashtable_ts_insert (MME_UE_S1AP_ID_UE_CONTEXT_HTBL(&mme_app_desc.mme_ue_contexts, mme_ue_s1ap_id), (const hash_key_t)mme_ue_s1ap_id, (void *)(uintptr_t)enb_key);
+        h_rc = hashtable_ts_remove (ENB_UE_S1AP_ID_UE_CONTEXT_HTBL(&mme_app_desc.mme_ue_contexts, old_enb_key), (const hash_key_t)old_enb_key, (void **)&old);
         if (HASH_TABLE_OK == h_rc) {
           ue_context_t                           *new = NULL;
-          h_rc = hashtable_ts_get (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)enb_key, (void **)&new);
+          h_rc = hashtable_ts_get (ENB_UE_S1AP_ID_UE_CONTEXT_HTBL(&mme_app_desc.mme_ue_contexts, enb_key), (const hash_key_t)enb_key, (void **)&new);
           mme_app_move_context(new, old);
           mme_app_ue_context_free_content(old);
           OAILOG_DEBUG (LOG_MME_APP,
@@ -313,7 +374,7 @@ mme_ue_context_duplicate_enb_ue_s1ap_id_detected (
         }
       } else {
         ue_context_t                           *new = NULL;
-        h_rc = hashtable_ts_remove (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)enb_key, (void **)&new);
+        h_rc = hashtable_ts_remove (ENB_UE_S1AP_ID_UE_CONTEXT_HTBL(&mme_app_desc.mme_ue_contexts, enb_key), (const hash_key_t)enb_key, (void **)&new);
         if (HASH_TABLE_OK == h_rc) {
           mme_app_ue_context_free_content(new);
           OAILOG_DEBUG (LOG_MME_APP,
@@ -358,7 +419,7 @@ mme_ue_context_notified_new_ue_s1ap_id_association (
     if (ue_context_p->enb_s1ap_id_key == enb_key) { // useless
       if (INVALID_MME_UE_S1AP_ID == ue_context_p->mme_ue_s1ap_id) {
         // new insertion of mme_ue_s1ap_id, not a change in the id
-        h_rc = hashtable_ts_insert (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void *)ue_context_p);
+        h_rc = hashtable_ts_insert (MME_UE_S1AP_ID_UE_CONTEXT_HTBL(&mme_app_desc.mme_ue_contexts, mme_ue_s1ap_id), (const hash_key_t)mme_ue_s1ap_id, (void *)ue_context_p);
         if (HASH_TABLE_OK == h_rc) {
           ue_context_p->mme_ue_s1ap_id = mme_ue_s1ap_id;
           OAILOG_DEBUG (LOG_MME_APP,
@@ -400,8 +461,8 @@ mme_ue_context_update_coll_keys (
 
   if ((INVALID_ENB_UE_S1AP_ID_KEY != enb_s1ap_id_key) && (ue_context_p->enb_s1ap_id_key != enb_s1ap_id_key)) {
       // new insertion of enb_ue_s1ap_id_key,
-      h_rc = hashtable_ts_remove (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context_p->enb_s1ap_id_key, (void **)&id);
-      h_rc = hashtable_ts_insert (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)enb_s1ap_id_key, (void *)(uintptr_t)mme_ue_s1ap_id);
+      h_rc = hashtable_ts_remove (ENB_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->enb_s1ap_id_key), (const hash_key_t)ue_context_p->enb_s1ap_id_key, (void **)&id);
+      h_rc = hashtable_ts_insert (ENB_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, enb_s1ap_id_key), (const hash_key_t)enb_s1ap_id_key, (void *)(uintptr_t)mme_ue_s1ap_id);
 
       if (HASH_TABLE_OK != h_rc) {
         OAILOG_ERROR (LOG_MME_APP,
@@ -414,8 +475,9 @@ mme_ue_context_update_coll_keys (
 
   if ((INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id) && (ue_context_p->mme_ue_s1ap_id != mme_ue_s1ap_id)) {
       // new insertion of mme_ue_s1ap_id, not a change in the id
-      h_rc = hashtable_ts_remove (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context_p->mme_ue_s1ap_id,  (void **)&ue_context_p);
-      h_rc = hashtable_ts_insert (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void *)ue_context_p);
+      mme_ue_s1ap_id_t old_mme_ue_s1ap_id = ue_context_p->mme_ue_s1ap_id;
+      h_rc = hashtable_ts_remove (MME_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->mme_ue_s1ap_id), (const hash_key_t)ue_context_p->mme_ue_s1ap_id,  (void **)&ue_context_p);
+      h_rc = hashtable_ts_insert (MME_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, mme_ue_s1ap_id), (const hash_key_t)mme_ue_s1ap_id, (void *)ue_context_p);
 
       if (HASH_TABLE_OK != h_rc) {
         OAILOG_ERROR (LOG_MME_APP,
@@ -425,8 +487,8 @@ mme_ue_context_update_coll_keys (
       ue_context_p->mme_ue_s1ap_id = mme_ue_s1ap_id;
 
     if (INVALID_IMSI64 != imsi) {
-      h_rc = hashtable_ts_remove (mme_ue_context_p->imsi_ue_context_htbl, (const hash_key_t)ue_context_p->imsi, (void **)&id);
-      h_rc = hashtable_ts_insert (mme_ue_context_p->imsi_ue_context_htbl, (const hash_key_t)imsi, (void *)(uintptr_t)mme_ue_s1ap_id);
+      h_rc = hashtable_ts_remove (IMSI_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->imsi), (const hash_key_t)ue_context_p->imsi, (void **)&id);
+      h_rc = hashtable_ts_insert (IMSI_UE_CONTEXT_HTBL(mme_ue_context_p, imsi), (const hash_key_t)imsi, (void *)(uintptr_t)mme_ue_s1ap_id);
       if (HASH_TABLE_OK != h_rc) {
        OAILOG_ERROR (LOG_MME_APP,
           "Error could not update this ue context %p enb_ue_s1ap_ue_id " ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " imsi " IMSI_64_FMT ": %s\n",
@@ -434,8 +496,8 @@ mme_ue_context_update_coll_keys (
     }
       ue_context_p->imsi = imsi;
     }
-    h_rc = hashtable_ts_remove (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)ue_context_p->mme_s11_teid, (void **)&id);
-    h_rc = hashtable_ts_insert (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)mme_s11_teid, (void *)(uintptr_t)mme_ue_s1ap_id);
+    h_rc = hashtable_ts_remove (TUN11_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->mme_s11_teid), (const hash_key_t)ue_context_p->mme_s11_teid, (void **)&id);
+    h_rc = hashtable_ts_insert (TUN11_UE_CONTEXT_HTBL(mme_ue_context_p, mme_s11_teid), (const hash_key_t)mme_s11_teid, (void *)(uintptr_t)mme_ue_s1ap_id);
     if (HASH_TABLE_OK != h_rc) {
       OAILOG_TRACE (LOG_MME_APP,
           "Error could not update this ue context %p enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " mme_s11_teid " TEID_FMT " : %s\n",
@@ -445,8 +507,10 @@ mme_ue_context_update_coll_keys (
 
     if (guti_p)
     {
-      h_rc = obj_hashtable_ts_remove (mme_ue_context_p->guti_ue_context_htbl, (const void *const)&ue_context_p->guti, sizeof (ue_context_p->guti), (void **)&id);
-      h_rc = obj_hashtable_ts_insert (mme_ue_context_p->guti_ue_context_htbl, (const void *const)guti_p, sizeof (*guti_p), (void *)(uintptr_t)mme_ue_s1ap_id);
+      // only drop our own entry, another UE may have been given this GUTI since
+      h_rc = hashtable_ts_remove_if_element (GUTI_UE_CONTEXT_HTBL(mme_ue_context_p, &ue_context_p->guti), (const hash_key_t)guti_key (&ue_context_p->guti),
+          (void *)(uintptr_t)old_mme_ue_s1ap_id);
+      h_rc = mme_ue_context_insert_guti (mme_ue_context_p, guti_p, mme_ue_s1ap_id);
       if (HASH_TABLE_OK != h_rc) {
         OAILOG_TRACE (LOG_MME_APP, "Error could not update this ue context %p enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " guti " GUTI_FMT " %s\n",
             ue_context_p, ue_context_p->enb_ue_s1ap_id, ue_context_p->mme_ue_s1ap_id, GUTI_ARG(guti_p), hashtable_rc_code2string(h_rc));
@@ -457,9 +521,9 @@ mme_ue_context_update_coll_keys (
 
   if ((ue_context_p->imsi != imsi)
       || (ue_context_p->mme_ue_s1ap_id != mme_ue_s1ap_id)) {
-    h_rc = hashtable_ts_remove (mme_ue_context_p->imsi_ue_context_htbl, (const hash_key_t)ue_context_p->imsi, (void **)&id);
+    h_rc = hashtable_ts_remove (IMSI_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->imsi), (const hash_key_t)ue_context_p->imsi, (void **)&id);
     if (INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id) {
-      h_rc = hashtable_ts_insert (mme_ue_context_p->imsi_ue_context_htbl, (const hash_key_t)imsi, (void *)(uintptr_t)mme_ue_s1ap_id);
+      h_rc = hashtable_ts_insert (IMSI_UE_CONTEXT_HTBL(mme_ue_context_p, imsi), (const hash_key_t)imsi, (void *)(uintptr_t)mme_ue_s1ap_id);
     } else {
       h_rc = HASH_TABLE_KEY_NOT_EXISTS;
     }
@@ -473,9 +537,9 @@ mme_ue_context_update_coll_keys (
 
   if ((ue_context_p->mme_s11_teid != mme_s11_teid)
       || (ue_context_p->mme_ue_s1ap_id != mme_ue_s1ap_id)) {
-    h_rc = hashtable_ts_remove (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)ue_context_p->mme_s11_teid, (void **)&id);
+    h_rc = hashtable_ts_remove (TUN11_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->mme_s11_teid), (const hash_key_t)ue_context_p->mme_s11_teid, (void **)&id);
     if (INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id) {
-      h_rc = hashtable_ts_insert (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)mme_s11_teid, (void *)(uintptr_t)mme_ue_s1ap_id);
+      h_rc = hashtable_ts_insert (TUN11_UE_CONTEXT_HTBL(mme_ue_context_p, mme_s11_teid), (const hash_key_t)mme_s11_teid, (void *)(uintptr_t)mme_ue_s1ap_id);
     } else {
       h_rc = HASH_TABLE_KEY_NOT_EXISTS;
     }
@@ -498,9 +562,10 @@ mme_ue_context_update_coll_keys (
       || (ue_context_p->mme_ue_s1ap_id != mme_ue_s1ap_id)) {
 
       // may check guti_p with a kind of instanceof()?
-      h_rc = obj_hashtable_ts_remove (mme_ue_context_p->guti_ue_context_htbl, &ue_context_p->guti, sizeof (*guti_p), (void **)&id);
+      h_rc = hashtable_ts_remove_if_element (GUTI_UE_CONTEXT_HTBL(mme_ue_context_p, &ue_context_p->guti), (const hash_key_t)guti_key (&ue_context_p->guti),
+          (void *)(uintptr_t)ue_context_p->mme_ue_s1ap_id);
       if (INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id) {
-        h_rc = obj_hashtable_ts_insert (mme_ue_context_p->guti_ue_context_htbl, (const void *const)guti_p, sizeof (*guti_p), (void *)(uintptr_t)mme_ue_s1ap_id);
+        h_rc = mme_ue_context_insert_guti (mme_ue_context_p, guti_p, mme_ue_s1ap_id);
       } else {
         h_rc = HASH_TABLE_KEY_NOT_EXISTS;
       }
@@ -519,26 +584,29 @@ mme_ue_context_update_coll_keys (
 void mme_ue_context_dump_coll_keys(void)
 {
   bstring tmp = bfromcstr(" ");
-  btrunc(tmp, 0);
 
-  hashtable_ts_dump_content (mme_app_desc.mme_ue_contexts.imsi_ue_context_htbl, tmp);
-  OAILOG_TRACE (LOG_MME_APP,"imsi_ue_context_htbl %s\n", bdata(tmp));
+  for (int i = 0; i < mme_app_desc.mme_ue_contexts.nb_shards; i++) {
+    btrunc(tmp, 0);
+    hashtable_ts_dump_content (mme_app_desc.mme_ue_contexts.imsi_ue_context_htbl[i], tmp);
+    OAILOG_TRACE (LOG_MME_APP,"imsi_ue_context_htbl[%d] %s\n", i, bdata(tmp));
 
-  btrunc(tmp, 0);
-  hashtable_ts_dump_content (mme_app_desc.mme_ue_contexts.tun11_ue_context_htbl, tmp);
-  OAILOG_TRACE (LOG_MME_APP,"tun11_ue_context_htbl %s\n", bdata(tmp));
+    btrunc(tmp, 0);
+    hashtable_ts_dump_content (mme_app_desc.mme_ue_contexts.tun11_ue_context_htbl[i], tmp);
+    OAILOG_TRACE (LOG_MME_APP,"tun11_ue_context_htbl[%d] %s\n", i, bdata(tmp));
 
-  btrunc(tmp, 0);
-  hashtable_ts_dump_content (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl, tmp);
-  OAILOG_TRACE (LOG_MME_APP,"mme_ue_s1ap_id_ue_context_htbl %s\n", bdata(tmp));
+    btrunc(tmp, 0);
+    hashtable_ts_dump_content (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl[i], tmp);
+    OAILOG_TRACE (LOG_MME_APP,"mme_ue_s1ap_id_ue_context_htbl[%d] %s\n", i, bdata(tmp));
 
-  btrunc(tmp, 0);
-  hashtable_ts_dump_content (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl, tmp);
-  OAILOG_TRACE (LOG_MME_APP,"enb_ue_s1ap_id_ue_context_htbl %s\n", bdata(tmp));
+    btrunc(tmp, 0);
+    hashtable_ts_dump_content (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl[i], tmp);
+    OAILOG_TRACE (LOG_MME_APP,"enb_ue_s1ap_id_ue_context_htbl[%d] %s\n", i, bdata(tmp));
 
-  btrunc(tmp, 0);
-  obj_hashtable_ts_dump_content (mme_app_desc.mme_ue_contexts.guti_ue_context_htbl, tmp);
-  OAILOG_TRACE (LOG_MME_APP,"guti_ue_context_htbl %s", bdata(tmp));
+    btrunc(tmp, 0);
+    hashtable_ts_dump_content (mme_app_desc.mme_ue_contexts.guti_ue_context_htbl[i], tmp);
+    OAILOG_TRACE (LOG_MME_APP,"guti_ue_context_htbl[%d] %s", i, bdata(tmp));
+  }
+  bdestroy(tmp);
 }
 
 //------------------------------------------------------------------------------
@@ -555,13 +623,13 @@ mme_insert_ue_context (
 
 
   // filled ENB UE S1AP ID
-  h_rc = hashtable_ts_is_key_exists (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context_p->enb_s1ap_id_key);
+  h_rc = hashtable_ts_is_key_exists (ENB_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->enb_s1ap_id_key), (const hash_key_t)ue_context_p->enb_s1ap_id_key);
   if (HASH_TABLE_OK == h_rc) {
     OAILOG_DEBUG (LOG_MME_APP, "This ue context %p already exists enb_ue_s1ap_id " ENB_UE_S1AP_ID_FMT "\n",
         ue_context_p, ue_context_p->enb_ue_s1ap_id);
     OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
   }
-  h_rc = hashtable_ts_insert (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl,
+  h_rc = hashtable_ts_insert (ENB_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->enb_s1ap_id_key),
                              (const hash_key_t)ue_context_p->enb_s1ap_id_key,
                               (void *)((uintptr_t)ue_context_p->mme_ue_s1ap_id));
 
@@ -572,7 +640,7 @@ mme_insert_ue_context (
   }
 
   if (INVALID_MME_UE_S1AP_ID != ue_context_p->mme_ue_s1ap_id) {
-    h_rc = hashtable_ts_is_key_exists (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context_p->mme_ue_s1ap_id);
+    h_rc = hashtable_ts_is_key_exists (MME_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->mme_ue_s1ap_id), (const hash_key_t)ue_context_p->mme_ue_s1ap_id);
 
     if (HASH_TABLE_OK == h_rc) {
       OAILOG_DEBUG (LOG_MME_APP, "This ue context %p already exists mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT "\n",
@@ -580,7 +648,7 @@ mme_insert_ue_context (
       OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
     }
 
-    h_rc = hashtable_ts_insert (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl,
+    h_rc = hashtable_ts_insert (MME_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->mme_ue_s1ap_id),
                                 (const hash_key_t)ue_context_p->mme_ue_s1ap_id,
                                 (void *)ue_context_p);
 
@@ -592,7 +660,7 @@ mme_insert_ue_context (
 
     // filled IMSI
     if (ue_context_p->imsi) {
-      h_rc = hashtable_ts_insert (mme_ue_context_p->imsi_ue_context_htbl,
+      h_rc = hashtable_ts_insert (IMSI_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->imsi),
                                   (const hash_key_t)ue_context_p->imsi,
                                   (void *)((uintptr_t)ue_context_p->mme_ue_s1ap_id));
 
@@ -605,7 +673,7 @@ mme_insert_ue_context (
 
     // filled S11 tun id
     if (ue_context_p->mme_s11_teid) {
-      h_rc = hashtable_ts_insert (mme_ue_context_p->tun11_ue_context_htbl,
+      h_rc = hashtable_ts_insert (TUN11_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->mme_s11_teid),
                                  (const hash_key_t)ue_context_p->mme_s11_teid,
                                  (void *)((uintptr_t)ue_context_p->mme_ue_s1ap_id));
 
@@ -621,12 +689,9 @@ mme_insert_ue_context (
         (0 != ue_context_p->guti.gummei.plmn.mcc_digit2)
         || (0 != ue_context_p->guti.gummei.plmn.mcc_digit3)) {
 
-      h_rc = obj_hashtable_ts_insert (mme_ue_context_p->guti_ue_context_htbl,
-                                     (const void *const)&ue_context_p->guti,
-                                     sizeof (ue_context_p->guti),
-                                     (void *)((uintptr_t)ue_context_p->mme_ue_s1ap_id));
+      h_rc = mme_ue_context_insert_guti (mme_ue_context_p, &ue_context_p->guti, ue_context_p->mme_ue_s1ap_id);
 
-      if (HASH_TABLE_OK != h_rc) {
+      if ((HASH_TABLE_OK != h_rc) && (HASH_TABLE_INSERT_OVERWRITTEN_DATA != h_rc)) {
         OAILOG_DEBUG (LOG_MME_APP, "Error could not register this ue context %p mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " guti "GUTI_FMT"\n",
                 ue_context_p, ue_context_p->mme_ue_s1ap_id, GUTI_ARG(&ue_context_p->guti));
         OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
@@ -661,21 +726,21 @@ void mme_remove_ue_context (
   
   // IMSI 
   if (ue_context_p->imsi) {
-    hash_rc = hashtable_ts_remove (mme_ue_context_p->imsi_ue_context_htbl, (const hash_key_t)ue_context_p->imsi, (void **)&id);
+    hash_rc = hashtable_ts_remove (IMSI_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->imsi), (const hash_key_t)ue_context_p->imsi, (void **)&id);
     if (HASH_TABLE_OK != hash_rc)
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ", IMSI %" SCNu64 "  not in IMSI collection",
           ue_context_p->enb_ue_s1ap_id, ue_context_p->mme_ue_s1ap_id, ue_context_p->imsi);
   }
   
   // eNB UE S1P UE ID
-  hash_rc = hashtable_ts_remove (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context_p->enb_s1ap_id_key, (void **)&id);
+  hash_rc = hashtable_ts_remove (ENB_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->enb_s1ap_id_key), (const hash_key_t)ue_context_p->enb_s1ap_id_key, (void **)&id);
   if (HASH_TABLE_OK != hash_rc)
     OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ", ENB_UE_S1AP_ID not ENB_UE_S1AP_ID collection",
       ue_context_p->enb_ue_s1ap_id, ue_context_p->mme_ue_s1ap_id);
   
   // filled S11 tun id
   if (ue_context_p->mme_s11_teid) {
-    hash_rc = hashtable_ts_remove (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)ue_context_p->mme_s11_teid, (void **)&id);
+    hash_rc = hashtable_ts_remove (TUN11_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->mme_s11_teid), (const hash_key_t)ue_context_p->mme_s11_teid, (void **)&id);
     if (HASH_TABLE_OK != hash_rc)
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ", MME S11 TEID  " TEID_FMT "  not in S11 collection",
           ue_context_p->enb_ue_s1ap_id, ue_context_p->mme_ue_s1ap_id, ue_context_p->mme_s11_teid);
@@ -683,7 +748,8 @@ void mme_remove_ue_context (
   // filled guti
   if ((ue_context_p->guti.gummei.mme_code) || (ue_context_p->guti.gummei.mme_gid) || (ue_context_p->guti.m_tmsi) ||
       (ue_context_p->guti.gummei.plmn.mcc_digit1) || (ue_context_p->guti.gummei.plmn.mcc_digit2) || (ue_context_p->guti.gummei.plmn.mcc_digit3)) { // MCC 000 does not exist in ITU table
-    hash_rc = obj_hashtable_ts_remove (mme_ue_context_p->guti_ue_context_htbl, (const void *const)&ue_context_p->guti, sizeof (ue_context_p->guti), (void **)&id);
+    hash_rc = hashtable_ts_remove_if_element (GUTI_UE_CONTEXT_HTBL(mme_ue_context_p, &ue_context_p->guti), (const hash_key_t)guti_key (&ue_context_p->guti),
+        (void *)(uintptr_t)ue_context_p->mme_ue_s1ap_id);
     if (HASH_TABLE_OK != hash_rc)
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ", GUTI  not in GUTI collection",
           ue_context_p->enb_ue_s1ap_id, ue_context_p->mme_ue_s1ap_id);
@@ -691,7 +757,7 @@ void mme_remove_ue_context (
   
   // filled NAS UE ID/ MME UE S1AP ID
   if (INVALID_MME_UE_S1AP_ID != ue_context_p->mme_ue_s1ap_id) {
-    hash_rc = hashtable_ts_remove (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context_p->mme_ue_s1ap_id, (void **)&ue_context_p);
+    hash_rc = hashtable_ts_remove (MME_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->mme_ue_s1ap_id), (const hash_key_t)ue_context_p->mme_ue_s1ap_id, (void **)&ue_context_p);
     if (HASH_TABLE_OK != hash_rc)
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT ", mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " not in MME UE S1AP ID collection",
           ue_context_p->enb_ue_s1ap_id, ue_context_p->mme_ue_s1ap_id);
@@ -717,7 +783,7 @@ void mme_ue_context_update_ue_sig_connection_state (
   DevAssert (ue_context_p);
   if (new_ecm_state == ECM_IDLE)
   {
-    hash_rc = hashtable_ts_remove (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context_p->enb_s1ap_id_key, (void **)&id);
+    hash_rc = hashtable_ts_remove (ENB_UE_S1AP_ID_UE_CONTEXT_HTBL(mme_ue_context_p, ue_context_p->enb_s1ap_id_key), (const hash_key_t)ue_context_p->enb_s1ap_id_key, (void **)&id);
     if (HASH_TABLE_OK != hash_rc) 
     {
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id_key %ld mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ", ENB_UE_S1AP_ID_KEY could not be found",
@@ -729,12 +795,8 @@ void mme_ue_context_update_ue_sig_connection_state (
     
     if (mme_config.nas_config.t3412_min > 0) {
       // Start Mobile reachability timer only if peroidic TAU timer is not disabled 
-      if (timer_setup (ue_context_p->mobile_reachability_timer.sec, 0, TASK_MME_APP, INSTANCE_DEFAULT, TIMER_ONE_SHOT, (void *)&(ue_context_p->mme_ue_s1ap_id), &(ue_context_p->mobile_reachability_timer.id)) < 0) {
-        OAILOG_ERROR (LOG_MME_APP, "Failed to start Mobile Reachability timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
-        ue_context_p->mobile_reachability_timer.id = MME_APP_TIMER_INACTIVE_ID;
-      } else {
-        OAILOG_DEBUG (LOG_MME_APP, "Started Mobile Reachability timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
-      }
+      mme_app_idle_timer_start (ue_context_p, MME_APP_IDLE_TIMER_MOBILE_REACHABILITY, ue_context_p->mobile_reachability_timer_sec);
+      OAILOG_DEBUG (LOG_MME_APP, "Started Mobile Reachability timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
     }
     if (ue_context_p->ecm_state == ECM_CONNECTED) {
       ue_context_p->ecm_state       = ECM_IDLE;
@@ -748,23 +810,8 @@ void mme_ue_context_update_ue_sig_connection_state (
 
     OAILOG_DEBUG (LOG_MME_APP, "MME_APP: UE Connection State changed to CONNECTED.enb_ue_s1ap_id = %d, mme_ue_s1ap_id = %d\n", ue_context_p->enb_ue_s1ap_id, ue_context_p->mme_ue_s1ap_id);
     
-    // Stop Mobile reachability timer,if running 
-    if (ue_context_p->mobile_reachability_timer.id != MME_APP_TIMER_INACTIVE_ID)
-    {
-      if (timer_remove(ue_context_p->mobile_reachability_timer.id)) {
-
-        OAILOG_ERROR (LOG_MME_APP, "Failed to stop Mobile Reachability timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
-      } 
-      ue_context_p->mobile_reachability_timer.id = MME_APP_TIMER_INACTIVE_ID;
-    }
-    // Stop Implicit detach timer,if running 
-    if (ue_context_p->implicit_detach_timer.id != MME_APP_TIMER_INACTIVE_ID)
-    {
-      if (timer_remove(ue_context_p->implicit_detach_timer.id)) {
-        OAILOG_ERROR (LOG_MME_APP, "Failed to stop Implicit Detach timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
-      } 
-      ue_context_p->implicit_detach_timer.id = MME_APP_TIMER_INACTIVE_ID;
-    }
+    // Stop Mobile reachability or Implicit detach timer,if running 
+    mme_app_idle_timer_stop (ue_context_p);
     // Update Stats
     update_mme_app_stats_connected_ue_add();
   }
@@ -833,14 +880,14 @@ mme_app_dump_ue_context (
 
       OAILOG_DEBUG (LOG_MME_APP, "    - PDN List:\n");
 
-      for (j = 0; j < context_p->apn_profile.nb_apns; j++) {
-        struct apn_configuration_s             *apn_config_p;
+      for (j = 0; (context_p->apn_profile) && (j < context_p->apn_profile->nb_apns); j++) {
+        const struct apn_configuration_s       *apn_config_p;
 
-        apn_config_p = &context_p->apn_profile.apn_configuration[j];
+        apn_config_p = &context_p->apn_profile->apn_configuration[j];
         /*
          * Default APN ?
          */
-        OAILOG_DEBUG (LOG_MME_APP, "        - Default APN ...: %s\n", (apn_config_p->context_identifier == context_p->apn_profile.context_identifier)
+        OAILOG_DEBUG (LOG_MME_APP, "        - Default APN ...: %s\n", (apn_config_p->context_identifier == context_p->apn_profile->context_identifier)
                      ? "TRUE" : "FALSE");
         OAILOG_DEBUG (LOG_MME_APP, "        - APN ...........: %s\n", apn_config_p->service_selection);
         OAILOG_DEBUG (LOG_MME_APP, "        - AMBR (bits/s) ( Downlink |  Uplink  )\n");
@@ -904,7 +951,9 @@ mme_app_dump_ue_contexts (
   const mme_ue_context_t * const mme_ue_context_p)
 //------------------------------------------------------------------------------
 {
-  hashtable_ts_apply_callback_on_elements (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, mme_app_dump_ue_context, NULL, NULL);
+  for (int i = 0; i < mme_ue_context_p->nb_shards; i++) {
+    hashtable_ts_apply_callback_on_elements (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl[i], mme_app_dump_ue_context, NULL, NULL);
+  }
 }
 
 
@@ -920,8 +969,15 @@ mme_app_handle_s1ap_ue_context_release_req (
 }
 
 void
-mme_app_handle_enb_deregister_ind(const itti_s1ap_eNB_deregistered_ind_t const * eNB_deregistered_ind) {
+mme_app_handle_enb_deregister_ind(const int worker_index, const itti_s1ap_eNB_deregistered_ind_t const * eNB_deregistered_ind) {
   for (int i = 0; i < eNB_deregistered_ind->nb_ue_to_deregister; i++) {
+    // every MME_APP worker receives the whole batch, release only the UEs owned by this worker
+    // (a UE without MME UE S1AP id was given to a worker by its eNB UE S1AP id)
+    uint32_t owner_key = (INVALID_MME_UE_S1AP_ID != eNB_deregistered_ind->mme_ue_s1ap_id[i]) ?
+        eNB_deregistered_ind->mme_ue_s1ap_id[i] : eNB_deregistered_ind->enb_ue_s1ap_id[i];
+    if (MME_APP_WORKER_INDEX(mme_config.num_app_workers, owner_key) != worker_index) {
+      continue;
+    }
     _mme_app_handle_s1ap_ue_context_release(eNB_deregistered_ind->mme_ue_s1ap_id[i],
                                             eNB_deregistered_ind->enb_ue_s1ap_id[i],
                                             eNB_deregistered_ind->enb_id,
@@ -33,39 +33,13 @@
 #include "mme_app_ue_context.h"
 
 typedef struct {
-  /* UE contexts + some statistics variables */
+  /* UE contexts, the statistics are metrics, see mme_app_statistics.c */
   mme_ue_context_t mme_ue_contexts;
 
   long statistic_timer_id;
   uint32_t statistic_timer_period;
-  
-  /* Reader/writer lock */
-  pthread_rwlock_t rw_lock;
-  
-  /* ***************Statistics*************
-   * number of attached UE,number of connected UE,
-   * number of idle UE,number of default bearers, 
-   * number of S1_U bearers,number of PDN sessions
-   */ 
-  
-  uint32_t               nb_enb_connected;
-  uint32_t               nb_ue_attached;
-  uint32_t               nb_ue_connected;
-  uint32_t               nb_default_eps_bearers;
-  uint32_t               nb_s1u_bearers;
-  
-  /* ***************Changes in Statistics**************/
-
-  uint32_t               nb_ue_attached_since_last_stat;
-  uint32_t               nb_ue_detached_since_last_stat;
-  uint32_t               nb_ue_connected_since_last_stat;
-  uint32_t               nb_ue_disconnected_since_last_stat;
-  uint32_t               nb_eps_bearers_established_since_last_stat;
-  uint32_t               nb_eps_bearers_released_since_last_stat;
-  uint32_t               nb_enb_connected_since_last_stat;
-  uint32_t               nb_enb_released_since_last_stat;
-  uint32_t               nb_s1u_bearers_released_since_last_stat;
-  uint32_t               nb_s1u_bearers_established_since_last_stat;
+
+  long overload_timer_id;
 } mme_app_desc_t;
 
 extern mme_app_desc_t mme_app_desc;
@@ -84,13 +58,17 @@ int mme_app_send_s6a_update_location_req     (struct ue_context_s * const ue_con
 
 int mme_app_handle_s6a_update_location_ans   (const s6a_update_location_ans_t * const ula_pP);
 
+bool mme_app_subscription_is_valid           (const struct ue_context_s * const ue_context_pP);
+
+void mme_app_handle_s6a_subscription_invalidated_ind (const int worker_index, const s6a_subscription_invalidated_ind_t * const ind_pP);
+
 int mme_app_handle_nas_pdn_connectivity_req  ( itti_nas_pdn_connectivity_req_t * const nas_pdn_connectivity_req_p);
 
 void mme_app_handle_detach_req (const itti_nas_detach_req_t * const detach_req_p);
 
 void mme_app_handle_conn_est_cnf             (const itti_nas_conn_est_cnf_t * const nas_conn_est_cnf_pP);
 
-void mme_app_handle_initial_ue_message       (itti_mme_app_initial_ue_message_t * const conn_est_ind_pP);
+void mme_app_handle_initial_ue_message       (const int worker_index, itti_mme_app_initial_ue_message_t * const conn_est_ind_pP);
 
 int mme_app_handle_create_sess_resp          (itti_s11_create_session_response_t * const create_sess_resp_pP); //not const because we need to free internal stucts
 
@@ -119,8 +97,4 @@ void mme_app_handle_mobile_reachability_timer_expiry (struct ue_context_s *ue_co
 
 void mme_app_handle_implicit_detach_timer_expiry (struct ue_context_s *ue_context_p); 
 
-#define mme_stats_read_lock(mMEsTATS)  pthread_rwlock_rdlock(&(mMEsTATS)->rw_lock)
-#define mme_stats_write_lock(mMEsTATS) pthread_rwlock_wrlock(&(mMEsTATS)->rw_lock)
-#define mme_stats_unlock(mMEsTATS)     pthread_rwlock_unlock(&(mMEsTATS)->rw_lock)
-
 #endif /* MME_APP_DEFS_H_ */
@@ -75,7 +75,7 @@ mme_app_send_delete_session_request (
                       S11_DELETE_SESSION_REQUEST  (message_p).teid,
                       S11_DELETE_SESSION_REQUEST  (message_p).lbi);
 
-  itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+  itti_send_msg_to_task (S11_TASK_ID(S11_DELETE_SESSION_REQUEST (message_p).local_teid), INSTANCE_DEFAULT, message_p);
   OAILOG_FUNC_OUT (LOG_MME_APP);
 }
 
@@ -0,0 +1,237 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_idle.c
+  \brief Supervision of ECM-IDLE UEs: mobile reachability and implicit detach timers (TS 23.401 4.3.5.2)
+
+  Each idle UE has one running timer, mobile reachability then implicit detach.
+  Instead of one ITTI timer per UE, every MME_APP worker keeps an expiry wheel of
+  one second buckets for the UEs it owns, the timers are intrusive entries of the
+  UE contexts. A periodic tick of one second scans the buckets of the elapsed
+  seconds and handles the expired timers in a batch. Implicit detach timers are
+  jittered when started and their expiries are paced: over the per second budget,
+  an expired implicit detach is postponed to the next second.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "intertask_interface.h"
+#include "timer.h"
+#include "log.h"
+#include "assertions.h"
+#include "common_defs.h"
+#include "mme_config.h"
+#include "mme_app_ue_context.h"
+#include "mme_app_defs.h"
+#include "mme_app_idle.h"
+
+#define MME_APP_IDLE_WHEEL_SIZE  4096 // seconds, power of 2, timers longer than that stay for several turns
+#define MME_APP_IDLE_WHEEL_MASK  (MME_APP_IDLE_WHEEL_SIZE - 1)
+
+typedef struct mme_app_idle_wheel_s {
+  struct ue_context_s                    *bucket[MME_APP_IDLE_WHEEL_SIZE];
+  uint32_t                                now_sec;      // last second scanned
+  uint32_t                                nb_timers;    // running timers
+  uint32_t                                nb_postponed; // implicit detaches postponed since last report
+  unsigned int                            seed;         // jitter
+  long                                    timer_id;     // periodic tick
+} mme_app_idle_wheel_t;
+
+// one per MME_APP worker, only accessed by the worker
+static mme_app_idle_wheel_t            *mme_app_idle_wheels = NULL;
+static struct timespec                  mme_app_idle_start_time = {0};
+
+//------------------------------------------------------------------------------
+static uint32_t mme_app_idle_get_sec (void)
+{
+  struct timespec                         ts = {0};
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint32_t) (ts.tv_sec - mme_app_idle_start_time.tv_sec);
+}
+
+//------------------------------------------------------------------------------
+static void mme_app_idle_link (mme_app_idle_wheel_t * const wheel_p, struct ue_context_s * const ue_context_p)
+{
+  struct ue_context_s                   **head_p = &wheel_p->bucket[ue_context_p->idle_timer.expiry_sec & MME_APP_IDLE_WHEEL_MASK];
+
+  ue_context_p->idle_timer.prev = NULL;
+  ue_context_p->idle_timer.next = *head_p;
+  if (*head_p) {
+    (*head_p)->idle_timer.prev = ue_context_p;
+  }
+  *head_p = ue_context_p;
+}
+
+//------------------------------------------------------------------------------
+static void mme_app_idle_unlink (mme_app_idle_wheel_t * const wheel_p, struct ue_context_s * const ue_context_p)
+{
+  if (ue_context_p->idle_timer.prev) {
+    ue_context_p->idle_timer.prev->idle_timer.next = ue_context_p->idle_timer.next;
+  } else {
+    wheel_p->bucket[ue_context_p->idle_timer.expiry_sec & MME_APP_IDLE_WHEEL_MASK] = ue_context_p->idle_timer.next;
+  }
+  if (ue_context_p->idle_timer.next) {
+    ue_context_p->idle_timer.next->idle_timer.prev = ue_context_p->idle_timer.prev;
+  }
+  ue_context_p->idle_timer.next = NULL;
+  ue_context_p->idle_timer.prev = NULL;
+}
+
+//------------------------------------------------------------------------------
+int mme_app_idle_init (const mme_config_t * mme_config_p)
+{
+  OAILOG_FUNC_IN (LOG_MME_APP);
+  clock_gettime (CLOCK_MONOTONIC, &mme_app_idle_start_time);
+  mme_app_idle_wheels = calloc (mme_config_p->num_app_workers, sizeof (mme_app_idle_wheel_t));
+  AssertFatal (mme_app_idle_wheels != NULL, "Failed to allocate idle UE wheels\n");
+
+  for (int i = 0; i < mme_config_p->num_app_workers; i++) {
+    mme_app_idle_wheels[i].seed = (unsigned int) (mme_app_idle_start_time.tv_nsec + i);
+    if (timer_setup (1, 0, TASK_MME_APP + i, INSTANCE_DEFAULT, TIMER_PERIODIC, NULL, &mme_app_idle_wheels[i].timer_id) < 0) {
+      OAILOG_ERROR (LOG_MME_APP, "Failed to request idle UE supervision tick for MME_APP worker %d\n", i);
+      mme_app_idle_wheels[i].timer_id = 0;
+      OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+    }
+  }
+  OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+bool mme_app_idle_is_tick (const int worker_index, const long timer_id)
+{
+  return (mme_app_idle_wheels) && (mme_app_idle_wheels[worker_index].timer_id) && (mme_app_idle_wheels[worker_index].timer_id == timer_id);
+}
+
+//------------------------------------------------------------------------------
+void mme_app_idle_tick (const int worker_index)
+{
+  mme_app_idle_wheel_t                   *wheel_p = &mme_app_idle_wheels[worker_index];
+  struct ue_context_s                    *expired_p = NULL;
+  struct ue_context_s                    *ue_context_p = NULL;
+  struct ue_context_s                    *next_p = NULL;
+  const uint32_t                          now_sec = mme_app_idle_get_sec ();
+  uint32_t                                nb_expired = 0;
+  uint32_t                                budget = 0;
+  uint32_t                                nb_seconds = 0;
+
+  OAILOG_FUNC_IN (LOG_MME_APP);
+  /*
+   * Collect the expired timers of the elapsed seconds, a bucket can also hold
+   * timers of next wheel turns. After a long stall the whole wheel is scanned once.
+   */
+  while ((int32_t) (now_sec - wheel_p->now_sec) > 0) {
+    wheel_p->now_sec++;
+    nb_seconds++;
+    ue_context_p = wheel_p->bucket[wheel_p->now_sec & MME_APP_IDLE_WHEEL_MASK];
+    while (ue_context_p) {
+      next_p = ue_context_p->idle_timer.next;
+      if ((int32_t) (ue_context_p->idle_timer.expiry_sec - wheel_p->now_sec) <= 0) {
+        mme_app_idle_unlink (wheel_p, ue_context_p);
+        ue_context_p->idle_timer.next = expired_p;
+        expired_p = ue_context_p;
+      }
+      ue_context_p = next_p;
+    }
+    if (nb_seconds >= MME_APP_IDLE_WHEEL_SIZE) {
+      wheel_p->now_sec = now_sec;
+    }
+  }
+
+  if (!expired_p) {
+    OAILOG_FUNC_OUT (LOG_MME_APP);
+  }
+
+  /*
+   * Per worker share of the implicit detach budget, for the seconds elapsed
+   */
+  if (mme_config.idle_supervision_config.max_implicit_detach_per_sec) {
+    budget = (mme_config.idle_supervision_config.max_implicit_detach_per_sec + mme_config.num_app_workers - 1) / mme_config.num_app_workers;
+    budget *= nb_seconds;
+  }
+
+  while (expired_p) {
+    ue_context_p = expired_p;
+    expired_p = ue_context_p->idle_timer.next;
+    ue_context_p->idle_timer.next = NULL;
+
+    if (MME_APP_IDLE_TIMER_MOBILE_REACHABILITY == ue_context_p->idle_timer.type) {
+      ue_context_p->idle_timer.type = MME_APP_IDLE_TIMER_NONE;
+      wheel_p->nb_timers--;
+      mme_app_handle_mobile_reachability_timer_expiry (ue_context_p);
+    } else if ((mme_config.idle_supervision_config.max_implicit_detach_per_sec) && (0 == budget)) {
+      // paced, retry next second
+      ue_context_p->idle_timer.expiry_sec = wheel_p->now_sec + 1;
+      mme_app_idle_link (wheel_p, ue_context_p);
+      wheel_p->nb_postponed++;
+      continue;
+    } else {
+      ue_context_p->idle_timer.type = MME_APP_IDLE_TIMER_NONE;
+      wheel_p->nb_timers--;
+      budget = (budget) ? budget - 1 : 0;
+      mme_app_handle_implicit_detach_timer_expiry (ue_context_p);
+    }
+    nb_expired++;
+  }
+
+  OAILOG_DEBUG (LOG_MME_APP, "Idle UE supervision worker %d: %u timers expired, %u running, %u implicit detaches postponed\n",
+      worker_index, nb_expired, wheel_p->nb_timers, wheel_p->nb_postponed);
+  wheel_p->nb_postponed = 0;
+  OAILOG_FUNC_OUT (LOG_MME_APP);
+}
+
+//------------------------------------------------------------------------------
+void mme_app_idle_timer_start (struct ue_context_s * const ue_context_p, const mme_app_idle_timer_type_t type, const uint32_t sec)
+{
+  mme_app_idle_wheel_t                   *wheel_p = NULL;
+  uint32_t                                timer_sec = sec;
+
+  DevAssert (ue_context_p != NULL);
+  mme_app_idle_timer_stop (ue_context_p);
+
+  ue_context_p->idle_timer.worker_index = (uint8_t) MME_APP_WORKER_INDEX (mme_config.num_app_workers, ue_context_p->mme_ue_s1ap_id);
+  wheel_p = &mme_app_idle_wheels[ue_context_p->idle_timer.worker_index];
+
+  if ((MME_APP_IDLE_TIMER_IMPLICIT_DETACH == type) && (mme_config.idle_supervision_config.implicit_detach_jitter_sec)) {
+    timer_sec += (uint32_t) rand_r (&wheel_p->seed) % (mme_config.idle_supervision_config.implicit_detach_jitter_sec + 1);
+  }
+  // an expiry in the second being scanned would wait for a full wheel turn
+  ue_context_p->idle_timer.expiry_sec = wheel_p->now_sec + ((timer_sec) ? timer_sec : 1);
+  ue_context_p->idle_timer.type = type;
+  mme_app_idle_link (wheel_p, ue_context_p);
+  wheel_p->nb_timers++;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_idle_timer_stop (struct ue_context_s * const ue_context_p)
+{
+  DevAssert (ue_context_p != NULL);
+  if (MME_APP_IDLE_TIMER_NONE != ue_context_p->idle_timer.type) {
+    mme_app_idle_unlink (&mme_app_idle_wheels[ue_context_p->idle_timer.worker_index], ue_context_p);
+    mme_app_idle_wheels[ue_context_p->idle_timer.worker_index].nb_timers--;
+    ue_context_p->idle_timer.type = MME_APP_IDLE_TIMER_NONE;
+  }
+}
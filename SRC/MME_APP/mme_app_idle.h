@@ -0,0 +1,58 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_idle.h
+  \brief Supervision of ECM-IDLE UEs: mobile reachability and implicit detach timers (TS 23.401 4.3.5.2)
+*/
+
+#ifndef FILE_MME_APP_IDLE_SEEN
+#define FILE_MME_APP_IDLE_SEEN
+
+/** \brief Allocate the expiry wheels (one per MME_APP worker) and start their periodic tick
+ * \param mme_config_p   MME configuration
+ * @returns RETURNerror or RETURNok
+ **/
+int mme_app_idle_init (const mme_config_t * mme_config_p);
+
+/** \brief Tell if a TIMER_HAS_EXPIRED is the tick of the wheel of the worker
+ * \param worker_index   MME_APP worker
+ * \param timer_id       Expired timer
+ **/
+bool mme_app_idle_is_tick (const int worker_index, const long timer_id);
+
+/** \brief Expire the timers of the seconds elapsed since the previous tick, in a batch
+ * \param worker_index   MME_APP worker
+ **/
+void mme_app_idle_tick (const int worker_index);
+
+/** \brief Start (or restart) an idle UE timer, must be called by the MME_APP worker owning the UE
+ * \param ue_context_p   UE context
+ * \param type           MME_APP_IDLE_TIMER_MOBILE_REACHABILITY or MME_APP_IDLE_TIMER_IMPLICIT_DETACH
+ * \param sec            Timer value in seconds, implicit detach timers are jittered
+ **/
+void mme_app_idle_timer_start (struct ue_context_s * const ue_context_p, const mme_app_idle_timer_type_t type, const uint32_t sec);
+
+/** \brief Stop the running idle UE timer, if any
+ * \param ue_context_p   UE context
+ **/
+void mme_app_idle_timer_stop (struct ue_context_s * const ue_context_p);
+
+#endif /* FILE_MME_APP_IDLE_SEEN */
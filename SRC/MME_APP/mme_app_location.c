@@ -41,7 +41,23 @@
 #include "mme_app_ue_context.h"
 #include "mme_app_defs.h"
 #include "mme_config.h"
+#include "mme_app_subscription_profile.h"
 
+//------------------------------------------------------------------------------
+/* 3GPP TS 23.401 5.3.2.1 step 11: the update location is needed if the MME has
+ * changed since the last detach or if there is no valid subscriber context for the
+ * UE in the MME. The subscription data got by an update location of this MME stays
+ * valid until the HSS cancels, changes or resets it.
+ */
+bool
+mme_app_subscription_is_valid (
+  const struct ue_context_s *const ue_context_pP)
+{
+  return (SUBSCRIPTION_KNOWN == ue_context_pP->subscription_known) &&
+         (PLMNS_ARE_EQUAL (ue_context_pP->subscription_visited_plmn, ue_context_pP->guti.gummei.plmn));
+}
+
+//------------------------------------------------------------------------------
 int
 mme_app_send_s6a_update_location_req (
   struct ue_context_s *const ue_context_pP)
@@ -53,8 +69,9 @@ mme_app_send_s6a_update_location_req (
   int                                     rc = RETURNok;
 
   OAILOG_FUNC_IN (LOG_MME_APP);
+  DevAssert (ue_context_pP->pending_pdn_connectivity_req);
   IMSI_STRING_TO_IMSI64 ((char *)
-                          ue_context_pP->pending_pdn_connectivity_req_imsi, &imsi);
+                          ue_context_pP->pending_pdn_connectivity_req->imsi, &imsi);
   OAILOG_DEBUG (LOG_MME_APP, "Handling imsi " IMSI_64_FMT "\n", imsi);
 
   if ((ue_context_p = mme_ue_context_exists_imsi (&mme_app_desc.mme_ue_contexts, imsi)) == NULL) {
@@ -62,7 +79,8 @@ mme_app_send_s6a_update_location_req (
     OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
   }
 
-  message_p = itti_alloc_new_message (TASK_MME_APP, S6A_UPDATE_LOCATION_REQ);
+  // the S6A task answers to the originating task, i.e. the MME_APP worker owning this UE
+  message_p = itti_alloc_new_message (MME_APP_TASK_ID(ue_context_p->mme_ue_s1ap_id), S6A_UPDATE_LOCATION_REQ);
 
   if (message_p == NULL) {
     OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
@@ -125,6 +143,7 @@ mme_app_handle_s6a_update_location_ans (
   }
 
   ue_context_p->subscription_known = SUBSCRIPTION_KNOWN;
+  ue_context_p->subscription_visited_plmn = ue_context_p->guti.gummei.plmn;
   ue_context_p->sub_status = ula_pP->subscription_data.subscriber_status;
   ue_context_p->access_restriction_data = ula_pP->subscription_data.access_restriction;
   /*
@@ -146,17 +165,66 @@ mme_app_handle_s6a_update_location_ans (
   ue_context_p->msisdn[ue_context_p->msisdn_length] = '\0';
   ue_context_p->rau_tau_timer = ula_pP->subscription_data.rau_tau_timer;
   ue_context_p->access_mode = ula_pP->subscription_data.access_mode;
-  memcpy (&ue_context_p->apn_profile, &ula_pP->subscription_data.apn_config_profile, sizeof (apn_config_profile_t));
+  subscription_profile_release (&ue_context_p->apn_profile);
+  ue_context_p->apn_profile = subscription_profile_intern (&ula_pP->subscription_data.apn_config_profile);
   /*
    * Set the value of  Mobile Reachability timer based on value of T3412 (Periodic TAU timer) sent in Attach accept /TAU accept.
    * Set it to MME_APP_DELTA_T3412_REACHABILITY_TIMER minutes greater than T3412.
    * Set the value of Implicit timer. Set it to MME_APP_DELTA_REACHABILITY_IMPLICIT_DETACH_TIMER minutes greater than  Mobile Reachability timer 
   */
-  ue_context_p->mobile_reachability_timer.id = MME_APP_TIMER_INACTIVE_ID;
-  ue_context_p->mobile_reachability_timer.sec = ((mme_config.nas_config.t3412_min) + MME_APP_DELTA_T3412_REACHABILITY_TIMER) * 60;
-  ue_context_p->implicit_detach_timer.id = MME_APP_TIMER_INACTIVE_ID;
-  ue_context_p->implicit_detach_timer.sec = (ue_context_p->mobile_reachability_timer.sec) + MME_APP_DELTA_REACHABILITY_IMPLICIT_DETACH_TIMER * 60; 
+  ue_context_p->mobile_reachability_timer_sec = ((mme_config.nas_config.t3412_min) + MME_APP_DELTA_T3412_REACHABILITY_TIMER) * 60;
+  ue_context_p->implicit_detach_timer_sec = (ue_context_p->mobile_reachability_timer_sec) + MME_APP_DELTA_REACHABILITY_IMPLICIT_DETACH_TIMER * 60; 
   
   rc =  mme_app_send_s11_create_session_req (ue_context_p);
   OAILOG_FUNC_RETURN (LOG_MME_APP, rc);
 }
+
+//------------------------------------------------------------------------------
+static bool
+mme_app_invalidate_subscription (
+  const hash_key_t keyP,
+  void *const ue_context_pP,
+  void *worker_index_pP,
+  void **unused_result_pP)
+{
+  struct ue_context_s                    *ue_context_p = (struct ue_context_s *)ue_context_pP;
+
+  if (MME_APP_WORKER_INDEX (mme_config.num_app_workers, ue_context_p->mme_ue_s1ap_id) == *(int *)worker_index_pP) {
+    ue_context_p->subscription_known = SUBSCRIPTION_UNKNOWN;
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// Every MME_APP worker receives the indication, only the UEs owned by this worker are updated
+void
+mme_app_handle_s6a_subscription_invalidated_ind (
+  const int worker_index,
+  const s6a_subscription_invalidated_ind_t * const ind_pP)
+{
+  uint64_t                                imsi = 0;
+  struct ue_context_s                    *ue_context_p = NULL;
+
+  OAILOG_FUNC_IN (LOG_MME_APP);
+  DevAssert (ind_pP );
+
+  if (0 == ind_pP->imsi_length) {
+    // Reset, the HSS restarted and may have lost the subscription changes, this worker's UEs are in its own shard
+    hashtable_ts_apply_callback_on_elements (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl[worker_index],
+                                             mme_app_invalidate_subscription, (void *)&worker_index, NULL);
+    OAILOG_FUNC_OUT (LOG_MME_APP);
+  }
+  IMSI_STRING_TO_IMSI64 ((char *)ind_pP->imsi, &imsi);
+
+  if ((ue_context_p = mme_ue_context_exists_imsi (&mme_app_desc.mme_ue_contexts, imsi)) &&
+      (MME_APP_WORKER_INDEX (mme_config.num_app_workers, ue_context_p->mme_ue_s1ap_id) == worker_index)) {
+    OAILOG_DEBUG (LOG_MME_APP, "Subscription data of imsi " IMSI_64_FMT " invalidated (cause %d)\n", imsi, ind_pP->cause);
+    ue_context_p->subscription_known = SUBSCRIPTION_UNKNOWN;
+
+    if ((S6A_INVALIDATION_INSERT_SUBSCRIBER_DATA == ind_pP->cause) && (ind_pP->apn_config_profile.nb_apns) && (ue_context_p->apn_profile)) {
+      // the new APN configurations apply at once, to this UE only
+      subscription_profile_update (&ue_context_p->apn_profile, &ind_pP->apn_config_profile);
+    }
+  }
+  OAILOG_FUNC_OUT (LOG_MME_APP);
+}
@@ -31,10 +31,14 @@
 #include "mme_app_ue_context.h"
 #include "mme_app_defs.h"
 #include "mme_app_statistics.h"
+#include "mme_app_overload.h"
+#include "mme_app_idle.h"
+#include "mme_app_subscription_profile.h"
+#include "mme_config.h"
 #include "assertions.h"
 #include "msc.h"
 
-mme_app_desc_t                          mme_app_desc = {.rw_lock = PTHREAD_RWLOCK_INITIALIZER, 0} ;
+mme_app_desc_t                          mme_app_desc = {0};
 
 void     *mme_app_thread (void *args);
 
@@ -43,7 +47,10 @@ void *mme_app_thread (
   void *args)
 {
   struct ue_context_s                    *ue_context_p = NULL;
-  itti_mark_task_ready (TASK_MME_APP);
+  const int                               worker_index = (int)(intptr_t)args;
+  const task_id_t                         task_id = TASK_MME_APP + worker_index;
+
+  itti_mark_task_ready (task_id);
   MSC_START_USE ();
 
   while (1) {
@@ -54,7 +61,7 @@ void *mme_app_thread (
      * If the queue is empty, this function will block till a
      * message is sent to the task.
      */
-    itti_receive_msg (TASK_MME_APP, &received_message_p);
+    itti_receive_msg (task_id, &received_message_p);
     DevAssert (received_message_p );
 
     switch (ITTI_MSG_ID (received_message_p)) {
@@ -67,6 +74,11 @@ void *mme_app_thread (
       }
       break;
 
+    case S6A_SUBSCRIPTION_INVALIDATED_IND:{
+        mme_app_handle_s6a_subscription_invalidated_ind (worker_index, &S6A_SUBSCRIPTION_INVALIDATED_IND (received_message_p));
+      }
+      break;
+
     case S11_CREATE_SESSION_RESPONSE:{
         mme_app_handle_create_sess_resp (&received_message_p->ittiMsg.s11_create_session_response);
       }
@@ -117,7 +129,7 @@ void *mme_app_thread (
 
       // From S1AP Initiating Message/EMM Attach Request
     case MME_APP_INITIAL_UE_MESSAGE:{
-        mme_app_handle_initial_ue_message (&MME_APP_INITIAL_UE_MESSAGE (received_message_p));
+        mme_app_handle_initial_ue_message (worker_index, &MME_APP_INITIAL_UE_MESSAGE (received_message_p));
       }
       break;
 
@@ -130,22 +142,14 @@ void *mme_app_thread (
         /*
          * Check statistic timer
          */
-        if (received_message_p->ittiMsg.timer_has_expired.timer_id == mme_app_desc.statistic_timer_id) {
+        if ((0 == worker_index) && (received_message_p->ittiMsg.timer_has_expired.timer_id == mme_app_desc.statistic_timer_id)) {
           mme_app_statistics_display ();
-        } else if (received_message_p->ittiMsg.timer_has_expired.arg != NULL) { 
-          mme_ue_s1ap_id_t mme_ue_s1ap_id = *((mme_ue_s1ap_id_t *)(received_message_p->ittiMsg.timer_has_expired.arg));
-          ue_context_p = mme_ue_context_exists_mme_ue_s1ap_id (&mme_app_desc.mme_ue_contexts, mme_ue_s1ap_id);
-          if (ue_context_p == NULL) {
-            OAILOG_WARNING (LOG_MME_APP, "Timer expired but no assoicated UE context for UE id %d\n",mme_ue_s1ap_id);
-            break;
-          }
-          if (received_message_p->ittiMsg.timer_has_expired.timer_id == ue_context_p->mobile_reachability_timer.id) {
-            // Mobile Reachability Timer expiry handler 
-            mme_app_handle_mobile_reachability_timer_expiry (ue_context_p);
-          } else if (received_message_p->ittiMsg.timer_has_expired.timer_id == ue_context_p->implicit_detach_timer.id) {
-            // Implicit Detach Timer expiry handler 
-            mme_app_handle_implicit_detach_timer_expiry (ue_context_p);
-          }
+        } else if ((0 == worker_index) && (mme_app_desc.overload_timer_id) &&
+                   (received_message_p->ittiMsg.timer_has_expired.timer_id == mme_app_desc.overload_timer_id)) {
+          mme_app_overload_check ();
+        } else if (mme_app_idle_is_tick (worker_index, received_message_p->ittiMsg.timer_has_expired.timer_id)) {
+          // Mobile Reachability and Implicit Detach Timers expiry
+          mme_app_idle_tick (worker_index);
         }
       }
       break;
@@ -153,12 +157,12 @@ void *mme_app_thread (
     case TERMINATE_MESSAGE:{
         /*
          * Termination message received TODO -> release any data allocated
+         * UE context collections are shared by all workers, worker 0 releases them.
          */
-        hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.imsi_ue_context_htbl);
-        hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.tun11_ue_context_htbl);
-        hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl);
-        hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl);
-        obj_hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.guti_ue_context_htbl);
+        if (0 == worker_index) {
+          mme_ue_context_exit (&mme_app_desc.mme_ue_contexts);
+          subscription_profile_exit ();
+        }
         itti_exit_task ();
       }
       break;
@@ -184,7 +188,7 @@ void *mme_app_thread (
       break;
 
     case S1AP_ENB_DEREGISTERED_IND: {
-        mme_app_handle_enb_deregister_ind(&received_message_p->ittiMsg.s1ap_eNB_deregistered_ind);
+        mme_app_handle_enb_deregister_ind(worker_index, &received_message_p->ittiMsg.s1ap_eNB_deregistered_ind);
     }
     break;
 
@@ -208,30 +212,25 @@ mme_app_init (
 {
   OAILOG_FUNC_IN (LOG_MME_APP);
   memset (&mme_app_desc, 0, sizeof (mme_app_desc));
-  pthread_rwlock_init (&mme_app_desc.rw_lock, NULL);
-  bstring b = bfromcstr("mme_app_imsi_ue_context_htbl");
-  mme_app_desc.mme_ue_contexts.imsi_ue_context_htbl = hashtable_ts_create (mme_config.max_ues, NULL, hash_free_int_func, b);
-  btrunc(b, 0);
-  bassigncstr(b, "mme_app_tun11_ue_context_htbl");
-  mme_app_desc.mme_ue_contexts.tun11_ue_context_htbl = hashtable_ts_create (mme_config.max_ues, NULL, hash_free_int_func, b);
-  AssertFatal(sizeof(uintptr_t) >= sizeof(uint64_t), "Problem with mme_ue_s1ap_id_ue_context_htbl in MME_APP");
-  btrunc(b, 0);
-  bassigncstr(b, "mme_app_mme_ue_s1ap_id_ue_context_htbl");
-  mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl = hashtable_ts_create (mme_config.max_ues, NULL, NULL, b);
-  btrunc(b, 0);
-  bassigncstr(b, "mme_app_enb_ue_s1ap_id_ue_context_htbl");
-  mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl = hashtable_ts_create (mme_config.max_ues, NULL, hash_free_int_func, b);
-  btrunc(b, 0);
-  bassigncstr(b, "mme_app_guti_ue_context_htbl");
-  mme_app_desc.mme_ue_contexts.guti_ue_context_htbl = obj_hashtable_ts_create (mme_config.max_ues, NULL, hash_free_int_func, hash_free_int_func, b);
-  bdestroy(b);
+  mme_app_statistics_init ();
+  AssertFatal(MME_APP_WORKERS_MAX <= MME_UE_CONTEXT_SHARDS_MAX, "Not enough UE context shards for the MME_APP workers");
+  // one shard per worker
+  mme_ue_context_init (&mme_app_desc.mme_ue_contexts, mme_config.num_app_workers, mme_config.max_ues);
+
+  if (subscription_profile_init (SUBSCRIPTION_PROFILE_HTBL_SIZE) != RETURNok) {
+    OAILOG_ERROR (LOG_MME_APP, "Initializing subscription profiles: ERROR\n");
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+  }
 
   /*
-   * Create the thread associated with MME applicative layer
+   * Create the threads associated with MME applicative layer, one per worker.
+   * A UE is always handled by the same worker, see MME_APP_WORKER_INDEX().
    */
-  if (itti_create_task (TASK_MME_APP, &mme_app_thread, NULL) < 0) {
-    OAILOG_ERROR (LOG_MME_APP, "MME APP create task failed\n");
-    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+  for (int i = 0; i < mme_config_p->num_app_workers; i++) {
+    if (itti_create_task (TASK_MME_APP + i, &mme_app_thread, (void *)(intptr_t)i) < 0) {
+      OAILOG_ERROR (LOG_MME_APP, "MME APP create task %d failed\n", i);
+      OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+    }
   }
 
   mme_app_desc.statistic_timer_period = mme_config_p->mme_statistic_timer;
@@ -244,6 +243,15 @@ mme_app_init (
     mme_app_desc.statistic_timer_id = 0;
   }
 
+  if (mme_app_idle_init (mme_config_p) != RETURNok) {
+    OAILOG_ERROR (LOG_MME_APP, "Initializing idle UE supervision: ERROR\n");
+    return RETURNerror;
+  }
+
+  if (mme_app_overload_init (mme_config_p) != RETURNok) {
+    OAILOG_ERROR (LOG_MME_APP, "Overload control disabled\n");
+  }
+
   OAILOG_DEBUG (LOG_MME_APP, "Initializing MME applicative layer: DONE\n");
   OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNok);
 }
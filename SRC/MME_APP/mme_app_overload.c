@@ -0,0 +1,204 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_overload.c
+  \brief MME overload control (TS 23.401 4.3.7.4.1, TS 36.413 8.7.6/8.7.7)
+
+  The load of the MME is measured on the ITTI queues of the tasks handling the
+  signalling (S1AP, S1AP codecs, MME_APP and NAS workers, S6A): depth and
+  queueing delay. When one of them goes over a high threshold, S1AP is asked to
+  send OVERLOAD START to a share of the eNBs and new initial UE messages are
+  shed in MME_APP before any context is created. Overload ends, and OVERLOAD
+  STOP is sent, when all queues are back under the low thresholds.
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "intertask_interface.h"
+#include "timer.h"
+#include "log.h"
+#include "msc.h"
+#include "common_defs.h"
+#include "mme_config.h"
+#include "mme_app_ue_context.h"
+#include "mme_app_defs.h"
+#include "mme_app_overload.h"
+
+typedef struct mme_app_overload_s {
+  // written by MME_APP worker 0 only, read by all workers
+  volatile bool                           in_overload;
+  s1ap_overload_action_t                  action;
+  // initial UE messages shed, all workers
+  volatile uint32_t                       nb_shed;
+} mme_app_overload_t;
+
+static mme_app_overload_t               mme_app_overload = {0};
+
+//------------------------------------------------------------------------------
+static void mme_app_overload_task_load (const task_id_t task_id, uint32_t * const depth, uint32_t * const delay_us, task_id_t * const worst_task_id)
+{
+  const uint32_t                          task_depth = itti_get_task_queue_depth (task_id);
+  const uint32_t                          task_delay_us = itti_get_task_queue_delay (task_id);
+
+  if (task_depth > *depth) {
+    *depth = task_depth;
+    *worst_task_id = task_id;
+  }
+
+  if (task_delay_us > *delay_us) {
+    *delay_us = task_delay_us;
+    *worst_task_id = task_id;
+  }
+}
+
+//------------------------------------------------------------------------------
+int mme_app_overload_init (const mme_config_t * mme_config_p)
+{
+  OAILOG_FUNC_IN (LOG_MME_APP);
+  mme_app_desc.overload_timer_id = 0;
+
+  if (!mme_config_p->overload_config.enabled) {
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNok);
+  }
+
+  mme_app_overload.action = (s1ap_overload_action_t) mme_config_p->overload_config.action;
+
+  if (timer_setup (mme_config_p->overload_config.check_period_ms / 1000, (mme_config_p->overload_config.check_period_ms % 1000) * 1000,
+                   TASK_MME_APP, INSTANCE_DEFAULT, TIMER_PERIODIC, NULL, &mme_app_desc.overload_timer_id) < 0) {
+    OAILOG_ERROR (LOG_MME_APP, "Failed to request new timer for overload control with %ums of periodicity\n", mme_config_p->overload_config.check_period_ms);
+    mme_app_desc.overload_timer_id = 0;
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+  }
+
+  OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+void mme_app_overload_check (void)
+{
+  uint32_t                                depth = 0;
+  uint32_t                                delay_us = 0;
+  task_id_t                               worst_task_id = TASK_MME_APP;
+  MessageDef                             *message_p = NULL;
+
+  mme_config_read_lock (&mme_config);
+  const uint32_t                          depth_high = mme_config.overload_config.queue_depth_high;
+  const uint32_t                          depth_low = mme_config.overload_config.queue_depth_low;
+  const uint32_t                          delay_high_us = mme_config.overload_config.queue_delay_high_ms * 1000;
+  const uint32_t                          delay_low_us = mme_config.overload_config.queue_delay_low_ms * 1000;
+  const uint8_t                           enb_percent = mme_config.overload_config.enb_percent;
+  mme_config_unlock (&mme_config);
+
+  mme_app_overload_task_load (TASK_S1AP, &depth, &delay_us, &worst_task_id);
+  mme_app_overload_task_load (TASK_S6A, &depth, &delay_us, &worst_task_id);
+  for (int i = 0; i < mme_config.num_s1ap_codec_workers; i++) {
+    mme_app_overload_task_load (TASK_S1AP_CODEC + i, &depth, &delay_us, &worst_task_id);
+  }
+  for (int i = 0; i < mme_config.num_s11_workers; i++) {
+    mme_app_overload_task_load (TASK_S11 + i, &depth, &delay_us, &worst_task_id);
+  }
+  for (int i = 0; i < mme_config.num_app_workers; i++) {
+    mme_app_overload_task_load (TASK_MME_APP + i, &depth, &delay_us, &worst_task_id);
+    mme_app_overload_task_load (TASK_NAS_MME + i, &depth, &delay_us, &worst_task_id);
+  }
+
+  if (!mme_app_overload.in_overload) {
+    if ((depth >= depth_high) || (delay_us >= delay_high_us)) {
+      OAILOG_WARNING (LOG_MME_APP, "Entering overload: %s queue depth %u delay %u us\n", itti_get_task_name (worst_task_id), depth, delay_us);
+      mme_app_overload.in_overload = true;
+      message_p = itti_alloc_new_message (TASK_MME_APP, S1AP_OVERLOAD_START);
+      S1AP_OVERLOAD_START (message_p).action = mme_app_overload.action;
+      S1AP_OVERLOAD_START (message_p).enb_percent = enb_percent;
+      MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_S1AP_MME, NULL, 0, "0 S1AP_OVERLOAD_START action %u enb %u%%", mme_app_overload.action, enb_percent);
+      itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+    }
+  } else if ((depth <= depth_low) && (delay_us <= delay_low_us)) {
+    OAILOG_WARNING (LOG_MME_APP, "Leaving overload: max queue depth %u delay %u us, %u initial UE messages shed\n",
+        depth, delay_us, __sync_fetch_and_and (&mme_app_overload.nb_shed, 0));
+    mme_app_overload.in_overload = false;
+    message_p = itti_alloc_new_message (TASK_MME_APP, S1AP_OVERLOAD_STOP);
+    MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_S1AP_MME, NULL, 0, "0 S1AP_OVERLOAD_STOP");
+    itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+  }
+}
+
+//------------------------------------------------------------------------------
+bool mme_app_overload_admit_initial_ue (const itti_mme_app_initial_ue_message_t * const initial_pP)
+{
+  if (!mme_app_overload.in_overload) {
+    return true;
+  }
+
+  switch (initial_pP->as_cause) {
+  case AS_CAUSE_EMERGENCY:
+  case AS_CAUSE_HIGH_PRIO:
+  case AS_CAUSE_MT_ACCESS:
+    // paging responses complete a procedure the network started, they are admitted under any action
+    return true;
+
+  case AS_CAUSE_MO_SIGNAL:
+    // signalling of registered UEs (TAU, detach), new attaches are shed
+    return (mme_app_overload.action == S1AP_OVERLOAD_REJECT_NON_EMERGENCY_MO_DT) && (initial_pP->is_s_tmsi_valid);
+
+  default:
+    return false;
+  }
+}
+
+//------------------------------------------------------------------------------
+void mme_app_overload_reject_initial_ue (const int worker_index, itti_mme_app_initial_ue_message_t * const initial_pP)
+{
+  MessageDef                             *message_p = NULL;
+  mme_ue_s1ap_id_t                        mme_ue_s1ap_id = INVALID_MME_UE_S1AP_ID;
+
+  OAILOG_FUNC_IN (LOG_MME_APP);
+  __sync_fetch_and_add (&mme_app_overload.nb_shed, 1);
+  bdestroy (initial_pP->nas);
+  initial_pP->nas = NULL;
+
+  /*
+   * UE context release command needs the pair of S1AP ids, allocate a
+   * mme_ue_s1ap_id for S1AP only, MME_APP does not keep any context for it.
+   */
+  mme_ue_s1ap_id = mme_app_ctx_get_new_ue_id (worker_index, mme_config.num_app_workers);
+  if (mme_ue_s1ap_id == INVALID_MME_UE_S1AP_ID) {
+    OAILOG_FUNC_OUT (LOG_MME_APP);
+  }
+
+  message_p = itti_alloc_new_message (TASK_MME_APP, MME_APP_S1AP_MME_UE_ID_NOTIFICATION);
+  memset (&message_p->ittiMsg.mme_app_s1ap_mme_ue_id_notification, 0, sizeof (itti_mme_app_s1ap_mme_ue_id_notification_t));
+  message_p->ittiMsg.mme_app_s1ap_mme_ue_id_notification.enb_ue_s1ap_id = initial_pP->enb_ue_s1ap_id;
+  message_p->ittiMsg.mme_app_s1ap_mme_ue_id_notification.mme_ue_s1ap_id = mme_ue_s1ap_id;
+  message_p->ittiMsg.mme_app_s1ap_mme_ue_id_notification.sctp_assoc_id = initial_pP->sctp_assoc_id;
+  itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+
+  message_p = itti_alloc_new_message (TASK_MME_APP, S1AP_UE_CONTEXT_RELEASE_COMMAND);
+  memset (&message_p->ittiMsg.s1ap_ue_context_release_command, 0, sizeof (itti_s1ap_ue_context_release_command_t));
+  S1AP_UE_CONTEXT_RELEASE_COMMAND (message_p).mme_ue_s1ap_id = mme_ue_s1ap_id;
+  S1AP_UE_CONTEXT_RELEASE_COMMAND (message_p).enb_ue_s1ap_id = initial_pP->enb_ue_s1ap_id;
+  S1AP_UE_CONTEXT_RELEASE_COMMAND (message_p).cause = S1AP_CONTROL_PROCESSING_OVERLOAD;
+  MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_S1AP_MME, NULL, 0, "0 S1AP_UE_CONTEXT_RELEASE_COMMAND overload mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " ", mme_ue_s1ap_id);
+  itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+  OAILOG_FUNC_OUT (LOG_MME_APP);
+}
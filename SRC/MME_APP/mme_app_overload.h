@@ -0,0 +1,53 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_overload.h
+  \brief MME overload control (TS 23.401 4.3.7.4.1, TS 36.413 8.7.6/8.7.7)
+*/
+
+#ifndef FILE_MME_APP_OVERLOAD_SEEN
+#define FILE_MME_APP_OVERLOAD_SEEN
+
+/** \brief Start the periodic check of the MME task queues, if overload control is enabled
+ * \param mme_config_p   MME configuration
+ * @returns RETURNerror or RETURNok
+ **/
+int mme_app_overload_init (const mme_config_t * mme_config_p);
+
+/** \brief Periodic check: enter or leave overload depending on the ITTI queues
+ * of the MME tasks, S1AP OVERLOAD START/STOP are sent on transitions
+ **/
+void mme_app_overload_check (void);
+
+/** \brief Admission control of an initial UE message while in overload
+ * \param initial_pP     The initial UE message received from S1AP
+ * @returns false if the message has to be shed
+ **/
+bool mme_app_overload_admit_initial_ue (const itti_mme_app_initial_ue_message_t * const initial_pP);
+
+/** \brief Shed an initial UE message: the eNB is asked to release the UE
+ * connection, no UE context is created
+ * \param worker_index   MME_APP worker handling the message
+ * \param initial_pP     The initial UE message received from S1AP
+ **/
+void mme_app_overload_reject_initial_ue (const int worker_index, itti_mme_app_initial_ue_message_t * const initial_pP);
+
+#endif /* FILE_MME_APP_OVERLOAD_SEEN */
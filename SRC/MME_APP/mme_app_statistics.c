@@ -21,146 +21,233 @@
 
 
 #include <stdio.h>
+#include <inttypes.h>
+#include <malloc.h>
 
 #include "intertask_interface.h"
 #include "mme_app_ue_context.h"
 #include "mme_app_defs.h"
 #include "mme_app_statistics.h"
+#include "emmData.h"
+#include "s1ap_mme.h"
+#include "s6a_defs.h"
+#include "mme_app_subscription_profile.h"
+#include "metrics.h"
 
+typedef struct mme_app_stats_gauge_s {
+  const char                             *name;
+  const char                             *help;
+  const char                             *display;
+  metric_id_t                             current;
+  metric_id_t                             added;
+  metric_id_t                             removed;
+  int64_t                                 added_displayed;     // at the last display, only used by the statistics timer
+  int64_t                                 removed_displayed;
+} mme_app_stats_gauge_t;
+
+static mme_app_stats_gauge_t            mme_app_stats_gauges[MME_APP_STATS_MAX] = {
+  [MME_APP_STATS_ENB_CONNECTED]  = {.name = "mme_connected_enbs",  .help = "eNBs with an S1 association", .display = "Connected eNBs"},
+  [MME_APP_STATS_UE_ATTACHED]    = {.name = "mme_attached_ues",    .help = "UEs attached",                .display = "Attached UEs"},
+  [MME_APP_STATS_UE_CONNECTED]   = {.name = "mme_connected_ues",   .help = "UEs in ECM-CONNECTED",        .display = "Connected UEs"},
+  [MME_APP_STATS_DEFAULT_BEARER] = {.name = "mme_default_bearers", .help = "Default EPS bearers",         .display = "Default Bearers"},
+  [MME_APP_STATS_S1U_BEARER]     = {.name = "mme_s1u_bearers",     .help = "S1-U bearers",                .display = "S1-U Bearers"},
+};
+
+static metric_id_t                      mme_app_stats_ulr_skipped = 0;
+static int64_t                          mme_app_stats_ulr_skipped_displayed = 0;
+
+//------------------------------------------------------------------------------
+static void mme_app_statistics_display_htbl (hash_table_ts_t * const htbl)
+{
+  hashtable_stats_t                       stats = {0};
+  bstring                                 b = NULL;
+
+  if (HASH_TABLE_OK == hashtable_ts_get_stats (htbl, &stats)) {
+    b = bfromcstr ("");
+    hashtable_stats_display (&stats, htbl->name, b);
+    OAILOG_DEBUG (LOG_MME_APP, "%s", bdata(b));
+    bdestroy (b);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Heap in use by the process, measured by the allocator
+static size_t mme_app_statistics_heap_in_use (void)
+{
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 33)))
+  const struct mallinfo2                  mi = mallinfo2 ();
+
+  return mi.uordblks + mi.hblkhd;
+#else
+  // int fields, wrap above 2 GiB
+  const struct mallinfo                   mi = mallinfo ();
+
+  return (size_t)(unsigned int)mi.uordblks + (size_t)(unsigned int)mi.hblkhd;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Estimated bytes kept per UE by each layer: the sizeof of the context structure
+// plus its nodes in the layer collections, not what the allocator hands out for
+// them. Data only allocated during a procedure is shown apart. The heap in use is
+// measured, it also holds everything that is not per UE.
+static void mme_app_statistics_display_memory (void)
+{
+  size_t                                  nb_ue = 0;
+  // ue_description_t in its eNB ue_coll
+  const size_t                            s1ap = sizeof (ue_description_t) + sizeof (hash_node_t);
+  // ue_context_t in the 5 MME_APP collections
+  const size_t                            mme_app = sizeof (ue_context_t) + 5 * sizeof (hash_node_t);
+  // emm_data_context_t (without its ESM part) in ctx_coll_ue_id, ctx_coll_imsi and ctx_coll_guti (data is a malloc'ed ue id)
+  const size_t                            emm = sizeof (emm_data_context_t) - sizeof (esm_data_context_t) + 3 * sizeof (hash_node_t) + 2 * sizeof (unsigned int);
+  const size_t                            esm = sizeof (esm_data_context_t);
+  const size_t                            total = s1ap + mme_app + emm + esm;
+  subscription_profile_stats_t            profiles = {0};
+
+  for (int i = 0; i < mme_app_desc.mme_ue_contexts.nb_shards; i++) {
+    nb_ue += mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl[i]->num_elements;
+  }
+  subscription_profile_get_stats (&profiles);
+
+  OAILOG_DEBUG (LOG_MME_APP, "Memory per UE  | estimate from sizeof: S1AP %zu | MME_APP %zu | EMM %zu | ESM %zu | total %zu bytes\n", s1ap, mme_app, emm, esm, total);
+  OAILOG_DEBUG (LOG_MME_APP, "Memory per UE  | estimate: + %zu bytes during PDN connectivity, + radio capabilities if reported\n", sizeof (pending_pdn_connectivity_req_t));
+  OAILOG_DEBUG (LOG_MME_APP, "Memory UEs     | %zu UEs, estimate %zu KiB\n", nb_ue, (nb_ue * total) >> 10);
+  OAILOG_DEBUG (LOG_MME_APP, "Memory heap    | measured %zu KiB in use by the process\n", mme_app_statistics_heap_in_use () >> 10);
+  OAILOG_DEBUG (LOG_MME_APP, "APN profiles   | %" PRIu64 " shared by %" PRIu64 " UEs, estimate %" PRIu64 " KiB (%" PRIu64 " KiB if copied per UE)\n\n",
+                profiles.nb_profiles, profiles.nb_references, profiles.bytes >> 10, (profiles.nb_references * sizeof (apn_config_profile_t)) >> 10);
+}
+
+//------------------------------------------------------------------------------
+void mme_app_statistics_init (void)
+{
+  for (int i = 0; i < MME_APP_STATS_MAX; i++) {
+    mme_app_stats_gauge_t                *gauge = &mme_app_stats_gauges[i];
+    char                                  name[64];
+
+    gauge->current = metrics_register (gauge->name, METRIC_GAUGE, gauge->help, NULL);
+    snprintf (name, sizeof (name), "%s_changes_total", gauge->name);
+    gauge->added = metrics_register (name, METRIC_COUNTER, gauge->help, "change=\"added\"");
+    gauge->removed = metrics_register (name, METRIC_COUNTER, gauge->help, "change=\"removed\"");
+  }
+  mme_app_stats_ulr_skipped = metrics_register ("mme_s6a_ulr_skipped_total", METRIC_COUNTER,
+      "Re-attaches served from the subscription data held, without Update-Location-Request", NULL);
+}
+
+//------------------------------------------------------------------------------
 int mme_app_statistics_display (
   void)
 {
+  int64_t                                 value = 0;
+
   OAILOG_DEBUG (LOG_MME_APP, "======================================= STATISTICS ============================================\n\n");
   OAILOG_DEBUG (LOG_MME_APP, "               |   Current Status| Added since last display|  Removed since last display |\n");
-  OAILOG_DEBUG (LOG_MME_APP, "Connected eNBs | %10u      |     %10u              |    %10u               |\n",mme_app_desc.nb_enb_connected,
-                                          mme_app_desc.nb_enb_connected_since_last_stat,mme_app_desc.nb_enb_released_since_last_stat);
-  OAILOG_DEBUG (LOG_MME_APP, "Attached UEs   | %10u      |     %10u              |    %10u               |\n",mme_app_desc.nb_ue_attached,
-                                          mme_app_desc.nb_ue_attached_since_last_stat,mme_app_desc.nb_ue_detached_since_last_stat);
-  OAILOG_DEBUG (LOG_MME_APP, "Connected UEs  | %10u      |     %10u              |    %10u               |\n",mme_app_desc.nb_ue_connected,
-                                          mme_app_desc.nb_ue_connected_since_last_stat,mme_app_desc.nb_ue_disconnected_since_last_stat);
-  OAILOG_DEBUG (LOG_MME_APP, "Default Bearers| %10u      |     %10u              |    %10u               |\n",mme_app_desc.nb_default_eps_bearers,
-                                          mme_app_desc.nb_eps_bearers_established_since_last_stat,mme_app_desc.nb_eps_bearers_released_since_last_stat);
-  OAILOG_DEBUG (LOG_MME_APP, "S1-U Bearers   | %10u      |     %10u              |    %10u               |\n\n",mme_app_desc.nb_s1u_bearers,
-                                          mme_app_desc.nb_s1u_bearers_established_since_last_stat,mme_app_desc.nb_s1u_bearers_released_since_last_stat);
-  OAILOG_DEBUG (LOG_MME_APP, "======================================= STATISTICS ============================================\n\n");
-  
-  mme_stats_write_lock (&mme_app_desc);
-  
-  // resetting stats for next display
-  mme_app_desc.nb_enb_connected_since_last_stat = 0;
-  mme_app_desc.nb_enb_released_since_last_stat  = 0;
-  mme_app_desc.nb_ue_connected_since_last_stat  = 0;
-  mme_app_desc.nb_ue_disconnected_since_last_stat  = 0;
-  mme_app_desc.nb_s1u_bearers_established_since_last_stat = 0;
-  mme_app_desc.nb_s1u_bearers_released_since_last_stat = 0;
-  mme_app_desc.nb_eps_bearers_established_since_last_stat = 0;
-  mme_app_desc.nb_eps_bearers_released_since_last_stat = 0;
-  mme_app_desc.nb_ue_attached_since_last_stat = 0;
-  mme_app_desc.nb_ue_detached_since_last_stat = 0;
-  
-  mme_stats_unlock(&mme_app_desc);
+  for (int i = 0; i < MME_APP_STATS_MAX; i++) {
+    mme_app_stats_gauge_t                *gauge = &mme_app_stats_gauges[i];
+    const int64_t                         added = metrics_get (gauge->added);
+    const int64_t                         removed = metrics_get (gauge->removed);
 
+    OAILOG_DEBUG (LOG_MME_APP, "%-15s| %10" PRId64 "      |     %10" PRId64 "              |    %10" PRId64 "               |\n%s", gauge->display,
+        metrics_get (gauge->current), added - gauge->added_displayed, removed - gauge->removed_displayed, (MME_APP_STATS_MAX - 1 == i) ? "\n" : "");
+    gauge->added_displayed = added;
+    gauge->removed_displayed = removed;
+  }
+  // S6a messages since startup, the ULRs skipped are re-attaches served from the subscription data held
+  OAILOG_DEBUG (LOG_MME_APP, "S6a messages   | AIR %" PRId64 " AIA %" PRId64 " (%" PRId64 " failed) | ULR %" PRId64 " ULA %" PRId64 " (%" PRId64 " failed) | CLR %" PRId64 " IDR %" PRId64 " RSR %" PRId64 " |\n",
+                metrics_get (s6a_metrics[S6A_METRIC_AIR_SENT]),
+                metrics_get (s6a_metrics[S6A_METRIC_AIA_SUCCESS]) + metrics_get (s6a_metrics[S6A_METRIC_AIA_FAILURE]), metrics_get (s6a_metrics[S6A_METRIC_AIA_FAILURE]),
+                metrics_get (s6a_metrics[S6A_METRIC_ULR_SENT]),
+                metrics_get (s6a_metrics[S6A_METRIC_ULA_SUCCESS]) + metrics_get (s6a_metrics[S6A_METRIC_ULA_FAILURE]), metrics_get (s6a_metrics[S6A_METRIC_ULA_FAILURE]),
+                metrics_get (s6a_metrics[S6A_METRIC_CLR_RECEIVED]), metrics_get (s6a_metrics[S6A_METRIC_IDR_RECEIVED]), metrics_get (s6a_metrics[S6A_METRIC_RSR_RECEIVED]));
+  value = metrics_get (mme_app_stats_ulr_skipped);
+  OAILOG_DEBUG (LOG_MME_APP, "ULR skipped    | %10" PRId64 " since last display, subscription data still valid\n\n", value - mme_app_stats_ulr_skipped_displayed);
+  mme_app_stats_ulr_skipped_displayed = value;
+  // chain lengths of the UE context collections, long chains mean a bad hash or an undersized table
+  for (int i = 0; i < mme_app_desc.mme_ue_contexts.nb_shards; i++) {
+    mme_app_statistics_display_htbl (mme_app_desc.mme_ue_contexts.imsi_ue_context_htbl[i]);
+    mme_app_statistics_display_htbl (mme_app_desc.mme_ue_contexts.tun11_ue_context_htbl[i]);
+    mme_app_statistics_display_htbl (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl[i]);
+    mme_app_statistics_display_htbl (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl[i]);
+    mme_app_statistics_display_htbl (mme_app_desc.mme_ue_contexts.guti_ue_context_htbl[i]);
+  }
+  mme_app_statistics_display_memory ();
+  OAILOG_DEBUG (LOG_MME_APP, "======================================= STATISTICS ============================================\n\n");
   return 0;
 }
 
 /*********************************** Utility Functions to update Statistics**************************************/
 
+//------------------------------------------------------------------------------
+static inline void mme_app_stats_add (const mme_app_stats_t stat)
+{
+  metrics_inc (mme_app_stats_gauges[stat].current);
+  metrics_inc (mme_app_stats_gauges[stat].added);
+}
+
+//------------------------------------------------------------------------------
+static inline void mme_app_stats_sub (const mme_app_stats_t stat)
+{
+  metrics_dec (mme_app_stats_gauges[stat].current);
+  metrics_inc (mme_app_stats_gauges[stat].removed);
+}
+
 // Number of Connected eNBs 
 void update_mme_app_stats_connected_enb_add(void)
 {
-  mme_stats_write_lock (&mme_app_desc);
-  (mme_app_desc.nb_enb_connected)++;
-  (mme_app_desc.nb_enb_connected_since_last_stat)++;
-  mme_stats_unlock(&mme_app_desc);
-  return;
+  mme_app_stats_add (MME_APP_STATS_ENB_CONNECTED);
 }
 void update_mme_app_stats_connected_enb_sub(void)
 {
-  mme_stats_write_lock (&mme_app_desc);
-  if (mme_app_desc.nb_enb_connected !=0)
-    (mme_app_desc.nb_enb_connected)--;
-  (mme_app_desc.nb_enb_released_since_last_stat)--;
-  mme_stats_unlock(&mme_app_desc);
-  return;
+  mme_app_stats_sub (MME_APP_STATS_ENB_CONNECTED);
 }
 
 /*****************************************************/
 // Number of Connected UEs
 void update_mme_app_stats_connected_ue_add(void)
 {
-  mme_stats_write_lock (&mme_app_desc);
-  (mme_app_desc.nb_ue_connected)++;
-  (mme_app_desc.nb_ue_connected_since_last_stat)++;
-  mme_stats_unlock(&mme_app_desc);
-  return;
+  mme_app_stats_add (MME_APP_STATS_UE_CONNECTED);
 }
 void update_mme_app_stats_connected_ue_sub(void)
 {
-  mme_stats_write_lock (&mme_app_desc);
-  if (mme_app_desc.nb_ue_connected !=0)
-    (mme_app_desc.nb_ue_connected)--;
-  (mme_app_desc.nb_ue_disconnected_since_last_stat)++;
-  mme_stats_unlock(&mme_app_desc);
-  return;
+  mme_app_stats_sub (MME_APP_STATS_UE_CONNECTED);
 }
 
 /*****************************************************/
 // Number of S1U Bearers 
 void update_mme_app_stats_s1u_bearer_add(void)
 {
-  mme_stats_write_lock (&mme_app_desc);
-  (mme_app_desc.nb_s1u_bearers)++;
-  (mme_app_desc.nb_s1u_bearers_established_since_last_stat)++;
-  mme_stats_unlock(&mme_app_desc);
-  return;
+  mme_app_stats_add (MME_APP_STATS_S1U_BEARER);
 }
 void update_mme_app_stats_s1u_bearer_sub(void)
 {
-  mme_stats_write_lock (&mme_app_desc);
-  if (mme_app_desc.nb_s1u_bearers !=0)
-    (mme_app_desc.nb_s1u_bearers)--;
-  (mme_app_desc.nb_s1u_bearers_released_since_last_stat)++;
-  mme_stats_unlock(&mme_app_desc);
-  return;
+  mme_app_stats_sub (MME_APP_STATS_S1U_BEARER);
 }
 
 /*****************************************************/
 // Number of Default EPS Bearers 
 void update_mme_app_stats_default_bearer_add(void)
 {
-  mme_stats_write_lock (&mme_app_desc);
-  (mme_app_desc.nb_default_eps_bearers)++;
-  (mme_app_desc.nb_eps_bearers_established_since_last_stat)++;
-  mme_stats_unlock(&mme_app_desc);
-  return;
+  mme_app_stats_add (MME_APP_STATS_DEFAULT_BEARER);
 }
 void update_mme_app_stats_default_bearer_sub(void)
 {
-  mme_stats_write_lock (&mme_app_desc);
-  if (mme_app_desc.nb_default_eps_bearers !=0)
-    (mme_app_desc.nb_default_eps_bearers)--;
-  (mme_app_desc.nb_eps_bearers_released_since_last_stat)++;
-  mme_stats_unlock(&mme_app_desc);
-  return;
+  mme_app_stats_sub (MME_APP_STATS_DEFAULT_BEARER);
 }
 
 /*****************************************************/
 // Number of Attached UEs 
 void update_mme_app_stats_attached_ue_add(void)
 {
-  mme_stats_write_lock (&mme_app_desc);
-  (mme_app_desc.nb_ue_attached)++;
-  (mme_app_desc.nb_ue_attached_since_last_stat)++;
-  mme_stats_unlock(&mme_app_desc);
-  return;
+  mme_app_stats_add (MME_APP_STATS_UE_ATTACHED);
 }
 void update_mme_app_stats_attached_ue_sub(void)
 {
-  mme_stats_write_lock (&mme_app_desc);
-  if (mme_app_desc.nb_ue_attached !=0)
-    (mme_app_desc.nb_ue_attached)--;
-  (mme_app_desc.nb_ue_detached_since_last_stat)++;
-  mme_stats_unlock(&mme_app_desc);
-  return;
+  mme_app_stats_sub (MME_APP_STATS_UE_ATTACHED);
+}
+
+/*****************************************************/
+// Number of S6a ULR not sent on (re-)attach
+void update_mme_app_stats_ulr_skipped_add(void)
+{
+  metrics_inc (mme_app_stats_ulr_skipped);
 }
 /*****************************************************/
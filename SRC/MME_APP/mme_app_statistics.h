@@ -23,9 +23,22 @@
 #ifndef FILE_MME_APP_STATISTICS_SEEN
 #define FILE_MME_APP_STATISTICS_SEEN
 
+/* Gauges of MME_APP, each one with the counters of its additions and removals */
+typedef enum mme_app_stats_e {
+  MME_APP_STATS_ENB_CONNECTED = 0,
+  MME_APP_STATS_UE_ATTACHED,
+  MME_APP_STATS_UE_CONNECTED,
+  MME_APP_STATS_DEFAULT_BEARER,
+  MME_APP_STATS_S1U_BEARER,
+  MME_APP_STATS_MAX
+} mme_app_stats_t;
+
+void mme_app_statistics_init(void);
+
 int mme_app_statistics_display(void);
 
 /*********************************** Utility Functions to update Statistics**************************************/
+// No lock: each thread updates its own metrics, see metrics.h
 void update_mme_app_stats_connected_enb_add(void);
 void update_mme_app_stats_connected_enb_sub(void);
 void update_mme_app_stats_connected_ue_add(void);
@@ -36,5 +49,6 @@ void update_mme_app_stats_default_bearer_add(void);
 void update_mme_app_stats_default_bearer_sub(void);
 void update_mme_app_stats_attached_ue_add(void);
 void update_mme_app_stats_attached_ue_sub(void);
+void update_mme_app_stats_ulr_skipped_add(void);
 
 #endif /* FILE_MME_APP_STATISTICS_SEEN */
@@ -0,0 +1,270 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_subscription_profile.c
+  \brief Interned APN configuration profiles, shared by the UE contexts having the same subscription
+
+  Most subscribers share a handful of APN configuration profiles. Instead of one
+  full apn_config_profile_t per UE context, a profile is hash-consed: it is put
+  in a canonical form (unused bytes zeroed), hashed, and looked up in the store.
+  The UE contexts hold a reference counted pointer to the immutable shared copy.
+  A change of the profile of one UE builds a new profile and interns it, the
+  profile shared with the other UEs is never written (copy on write).
+  In the unlikely case of a hash collision between two different profiles, the
+  second one is not interned, it only lives with its references.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "log.h"
+#include "assertions.h"
+#include "common_defs.h"
+#include "hashtable.h"
+#include "mme_app_subscription_profile.h"
+
+typedef struct subscription_profile_s {
+  hash_key_t                              key;         // hash of the canonical profile
+  uint32_t                                ref_count;
+  bool                                    interned;    // false if the key was taken by another profile
+  apn_config_profile_t                    apn_profile; // immutable once created
+} subscription_profile_t;
+
+#define SUBSCRIPTION_PROFILE(aPNpROFILE) \
+  ((subscription_profile_t *)((uintptr_t)(aPNpROFILE) - offsetof (subscription_profile_t, apn_profile)))
+
+// Interning is done when a ULA or an IDR is handled, not on a hot path: one mutex for all the MME_APP workers
+static struct {
+  pthread_mutex_t                         mutex;
+  hash_table_t                           *htbl;
+  uint64_t                                nb_profiles;
+  uint64_t                                nb_references;
+} subscription_profile_store = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+//------------------------------------------------------------------------------
+static void subscription_profile_copy_apn (
+  apn_configuration_t * const dst,
+  const apn_configuration_t * const src)
+{
+  dst->context_identifier = src->context_identifier;
+  dst->nb_ip_address = (src->nb_ip_address <= 2) ? src->nb_ip_address : 2;
+  memcpy (dst->ip_address, src->ip_address, dst->nb_ip_address * sizeof (ip_address_t));
+  dst->pdn_type = src->pdn_type;
+  dst->service_selection_length = ((src->service_selection_length >= 0) && (src->service_selection_length <= APN_MAX_LENGTH)) ?
+                                  src->service_selection_length : 0;
+  memcpy (dst->service_selection, src->service_selection, dst->service_selection_length);
+  dst->subscribed_qos.qci = src->subscribed_qos.qci;
+  dst->subscribed_qos.allocation_retention_priority.priority_level = src->subscribed_qos.allocation_retention_priority.priority_level;
+  dst->subscribed_qos.allocation_retention_priority.pre_emp_vulnerability = src->subscribed_qos.allocation_retention_priority.pre_emp_vulnerability;
+  dst->subscribed_qos.allocation_retention_priority.pre_emp_capability = src->subscribed_qos.allocation_retention_priority.pre_emp_capability;
+  dst->ambr.br_ul = src->ambr.br_ul;
+  dst->ambr.br_dl = src->ambr.br_dl;
+}
+
+//------------------------------------------------------------------------------
+// Two equal profiles must have the same bytes: start from zeroes and copy only the meaningful fields
+static void subscription_profile_canonicalize (
+  apn_config_profile_t * const dst,
+  const apn_config_profile_t * const src)
+{
+  memset (dst, 0, sizeof (*dst));
+  dst->context_identifier = src->context_identifier;
+  // the store only holds complete profiles
+  dst->all_apn_conf_ind = ALL_APN_CONFIGURATIONS_INCLUDED;
+  dst->nb_apns = (src->nb_apns <= MAX_APN_PER_UE) ? src->nb_apns : MAX_APN_PER_UE;
+
+  for (int i = 0; i < dst->nb_apns; i++) {
+    subscription_profile_copy_apn (&dst->apn_configuration[i], &src->apn_configuration[i]);
+  }
+}
+
+//------------------------------------------------------------------------------
+int subscription_profile_init (const hash_size_t size)
+{
+  bstring                                 b = bfromcstr ("subscription_profile_htbl");
+
+  // the references own the profiles, not the index: the last release frees a profile
+  subscription_profile_store.htbl = hashtable_create (size, NULL, hash_free_int_func, b);
+  bdestroy (b);
+  // no counter reset: profiles detached by a previous exit are still alive
+  return (subscription_profile_store.htbl) ? RETURNok : RETURNerror;
+}
+
+//------------------------------------------------------------------------------
+static bool subscription_profile_detach (
+  __attribute__ ((unused)) const hash_key_t key,
+  void * const element,
+  __attribute__ ((unused)) void * const parameter,
+  __attribute__ ((unused)) void ** const result)
+{
+  // its key may be reused by a later store, the last release must not remove it there
+  ((subscription_profile_t *)element)->interned = false;
+  return false;
+}
+
+//------------------------------------------------------------------------------
+void subscription_profile_exit (void)
+{
+  pthread_mutex_lock (&subscription_profile_store.mutex);
+  if (subscription_profile_store.htbl) {
+    if (subscription_profile_store.nb_references) {
+      // UE contexts still referencing profiles keep them, their last release frees them
+      OAILOG_WARNING (LOG_MME_APP, "Subscription profile store exits with %" PRIu64 " profiles still referenced %" PRIu64 " times\n",
+                      subscription_profile_store.nb_profiles, subscription_profile_store.nb_references);
+      hashtable_apply_callback_on_elements (subscription_profile_store.htbl, subscription_profile_detach, NULL, NULL);
+    }
+    hashtable_destroy (subscription_profile_store.htbl);
+    subscription_profile_store.htbl = NULL;
+  }
+  pthread_mutex_unlock (&subscription_profile_store.mutex);
+}
+
+//------------------------------------------------------------------------------
+const apn_config_profile_t *subscription_profile_intern (const apn_config_profile_t * const apn_profile)
+{
+  apn_config_profile_t                    canonical;
+  subscription_profile_t                 *profile_p = NULL;
+  hash_key_t                              key = 0;
+
+  DevAssert (apn_profile);
+  subscription_profile_canonicalize (&canonical, apn_profile);
+  key = (hash_key_t)hash_bytes (&canonical, sizeof (canonical));
+
+  pthread_mutex_lock (&subscription_profile_store.mutex);
+  if ((HASH_TABLE_OK == hashtable_get (subscription_profile_store.htbl, key, (void **)&profile_p)) &&
+      (0 == memcmp (&profile_p->apn_profile, &canonical, sizeof (canonical)))) {
+    profile_p->ref_count++;
+    subscription_profile_store.nb_references++;
+    pthread_mutex_unlock (&subscription_profile_store.mutex);
+    return &profile_p->apn_profile;
+  }
+
+  bool                                    collision = (NULL != profile_p);
+
+  profile_p = calloc (1, sizeof (*profile_p));
+  AssertFatal (profile_p, "Cannot allocate a subscription profile\n");
+  profile_p->key = key;
+  profile_p->ref_count = 1;
+  profile_p->apn_profile = canonical;
+  if (!collision) {
+    profile_p->interned = (HASH_TABLE_OK == hashtable_insert (subscription_profile_store.htbl, key, profile_p));
+  }
+  subscription_profile_store.nb_profiles++;
+  subscription_profile_store.nb_references++;
+  pthread_mutex_unlock (&subscription_profile_store.mutex);
+  if (collision) {
+    OAILOG_WARNING (LOG_MME_APP, "Subscription profile hash collision on key 0x%" PRIx64 ", profile not shared\n", key);
+  }
+  return &profile_p->apn_profile;
+}
+
+//------------------------------------------------------------------------------
+const apn_config_profile_t *subscription_profile_ref (const apn_config_profile_t * const apn_profile)
+{
+  if (apn_profile) {
+    pthread_mutex_lock (&subscription_profile_store.mutex);
+    SUBSCRIPTION_PROFILE (apn_profile)->ref_count++;
+    subscription_profile_store.nb_references++;
+    pthread_mutex_unlock (&subscription_profile_store.mutex);
+  }
+  return apn_profile;
+}
+
+//------------------------------------------------------------------------------
+void subscription_profile_release (const apn_config_profile_t ** const apn_profile)
+{
+  subscription_profile_t                 *profile_p = NULL;
+  void                                   *unused = NULL;
+
+  if ((NULL == apn_profile) || (NULL == *apn_profile)) {
+    return;
+  }
+  profile_p = SUBSCRIPTION_PROFILE (*apn_profile);
+  *apn_profile = NULL;
+
+  pthread_mutex_lock (&subscription_profile_store.mutex);
+  subscription_profile_store.nb_references--;
+  if (0 == --profile_p->ref_count) {
+    if ((profile_p->interned) && (subscription_profile_store.htbl)) {
+      hashtable_remove (subscription_profile_store.htbl, profile_p->key, &unused);
+    }
+    subscription_profile_store.nb_profiles--;
+    free (profile_p);
+  }
+  pthread_mutex_unlock (&subscription_profile_store.mutex);
+}
+
+//------------------------------------------------------------------------------
+void subscription_profile_update (
+  const apn_config_profile_t ** const apn_profile,
+  const apn_config_profile_t * const changes)
+{
+  apn_config_profile_t                    merged;
+  const apn_config_profile_t             *new_profile = NULL;
+
+  DevAssert ((apn_profile) && (changes));
+
+  if ((NULL == *apn_profile) || (ALL_APN_CONFIGURATIONS_INCLUDED == changes->all_apn_conf_ind)) {
+    merged = *changes;
+  } else {
+    // TS 29.272 7.3.34: the APN configurations of the IDR replace those with the same context identifier, the others are added
+    merged = **apn_profile;
+    merged.context_identifier = changes->context_identifier;
+
+    for (int i = 0; (i < changes->nb_apns) && (i < MAX_APN_PER_UE); i++) {
+      int                                     j = 0;
+
+      while ((j < merged.nb_apns) && (merged.apn_configuration[j].context_identifier != changes->apn_configuration[i].context_identifier)) {
+        j++;
+      }
+      if (j == MAX_APN_PER_UE) {
+        OAILOG_WARNING (LOG_MME_APP, "No room for APN configuration %u in subscription profile\n", changes->apn_configuration[i].context_identifier);
+        continue;
+      }
+      merged.apn_configuration[j] = changes->apn_configuration[i];
+      if (j == merged.nb_apns) {
+        merged.nb_apns++;
+      }
+    }
+  }
+  new_profile = subscription_profile_intern (&merged);
+  subscription_profile_release (apn_profile);
+  *apn_profile = new_profile;
+}
+
+//------------------------------------------------------------------------------
+void subscription_profile_get_stats (subscription_profile_stats_t * const stats)
+{
+  pthread_mutex_lock (&subscription_profile_store.mutex);
+  stats->nb_profiles = subscription_profile_store.nb_profiles;
+  stats->nb_references = subscription_profile_store.nb_references;
+  stats->bytes = stats->nb_profiles * (sizeof (subscription_profile_t) + sizeof (hash_node_t));
+  if (subscription_profile_store.htbl) {
+    stats->bytes += subscription_profile_store.htbl->size * sizeof (hash_node_t *);
+  }
+  pthread_mutex_unlock (&subscription_profile_store.mutex);
+}
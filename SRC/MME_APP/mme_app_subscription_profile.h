@@ -0,0 +1,78 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_subscription_profile.h
+  \brief Interned APN configuration profiles, shared by the UE contexts having the same subscription
+*/
+
+#ifndef FILE_MME_APP_SUBSCRIPTION_PROFILE_SEEN
+#define FILE_MME_APP_SUBSCRIPTION_PROFILE_SEEN
+
+#include "hashtable.h"
+#include "common_types.h"
+
+// Distinct profiles expected, a few per operator
+#define SUBSCRIPTION_PROFILE_HTBL_SIZE  1024
+
+typedef struct subscription_profile_stats_s {
+  uint64_t nb_profiles;    // distinct profiles in the store
+  uint64_t nb_references;  // UE contexts referencing them
+  uint64_t bytes;          // memory of the store (profiles and collection nodes)
+} subscription_profile_stats_t;
+
+/** \brief Create the store of interned profiles
+ * \param size           Size of the collection, expected number of distinct profiles
+ * @returns RETURNerror or RETURNok
+ **/
+int subscription_profile_init (const hash_size_t size);
+
+/** \brief Release the store, the profiles still referenced are freed
+ **/
+void subscription_profile_exit (void);
+
+/** \brief Get the shared, immutable copy of a profile, the profile is interned if it was not yet
+ * \param apn_profile    Profile as decoded from a ULA
+ * @returns a reference to release with subscription_profile_release()
+ **/
+const apn_config_profile_t *subscription_profile_intern (const apn_config_profile_t * const apn_profile);
+
+/** \brief Get one more reference on an interned profile
+ * \param apn_profile    Reference got from the store
+ **/
+const apn_config_profile_t *subscription_profile_ref (const apn_config_profile_t * const apn_profile);
+
+/** \brief Drop a reference, the profile is freed with its last reference
+ * \param apn_profile    Reference got from the store, set to NULL
+ **/
+void subscription_profile_release (const apn_config_profile_t ** const apn_profile);
+
+/** \brief Copy on write: apply the APN configurations of an Insert Subscriber Data to the profile of one UE
+ * \param apn_profile    Reference of the UE, released and replaced by the reference of the modified profile
+ * \param changes        All the APN configurations, or the modified and added ones (all_apn_conf_ind)
+ **/
+void subscription_profile_update (const apn_config_profile_t ** const apn_profile, const apn_config_profile_t * const changes);
+
+/** \brief Get the number of profiles, references and bytes of the store
+ * \param stats          Filled
+ **/
+void subscription_profile_get_stats (subscription_profile_stats_t * const stats);
+
+#endif /* FILE_MME_APP_SUBSCRIPTION_PROFILE_SEEN */
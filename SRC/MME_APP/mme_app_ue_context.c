@@ -22,9 +22,12 @@
 
 #include "common_types.h"
 #include "mme_app_ue_context.h"
+#include "mme_config.h"
 #include "conversions.h"
 
-static mme_ue_s1ap_id_t mme_app_ue_s1ap_id_generator = 1;
+// One generator per MME_APP worker, see mme_app_ctx_get_new_ue_id()
+static mme_ue_s1ap_id_t mme_app_ue_s1ap_id_generator[MME_APP_WORKERS_MAX] = {0};
+static teid_t           mme_app_s11_teid_generator[MME_APP_WORKERS_MAX] = {0};
 
 /**
  * @brief mme_app_convert_imsi_to_imsi_mme: converts the imsi_t struct to the imsi mme struct
@@ -128,9 +131,28 @@ mme_app_imsi_to_u64 (mme_app_imsi_t imsi_src)
   return uint_imsi;
 }
 
-mme_ue_s1ap_id_t mme_app_ctx_get_new_ue_id(void)
+/**
+ * @brief mme_app_ctx_get_new_ue_id: allocates a mme_ue_s1ap_id owned by a MME_APP worker,
+ * ids are n * num_workers + worker_index so that MME_APP_WORKER_INDEX(num_workers, id) == worker_index.
+ * @param worker_index
+ * @param num_workers
+ */
+mme_ue_s1ap_id_t mme_app_ctx_get_new_ue_id(const int worker_index, const int num_workers)
 {
   mme_ue_s1ap_id_t tmp = 0;
-  tmp = __sync_fetch_and_add (&mme_app_ue_s1ap_id_generator, 1);
-  return tmp;
+  tmp = __sync_add_and_fetch (&mme_app_ue_s1ap_id_generator[worker_index], 1);
+  return tmp * num_workers + worker_index;
+}
+
+/**
+ * @brief mme_app_ctx_get_new_s11_teid: allocates a local S11 TEID owned by a MME_APP worker, same scheme as
+ * mme_app_ctx_get_new_ue_id(), never 0.
+ * @param worker_index
+ * @param num_workers
+ */
+teid_t mme_app_ctx_get_new_s11_teid(const int worker_index, const int num_workers)
+{
+  teid_t tmp = 0;
+  tmp = __sync_add_and_fetch (&mme_app_s11_teid_generator[worker_index], 1);
+  return tmp * num_workers + worker_index;
 }
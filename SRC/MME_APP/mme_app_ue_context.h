@@ -79,20 +79,25 @@ void mme_app_imsi_to_string(char * const imsi_dst, mme_app_imsi_t const * const
 uint64_t mme_app_imsi_to_u64 (mme_app_imsi_t imsi_src);
 void mme_app_ue_context_uint_to_imsi(uint64_t imsi_src, mme_app_imsi_t *imsi_dst);
 void mme_app_convert_imsi_to_imsi_mme (mme_app_imsi_t * imsi_dst, const imsi_t *imsi_src);
-mme_ue_s1ap_id_t mme_app_ctx_get_new_ue_id(void);
-/*
- * Timer identifier returned when in inactive state (timer is stopped or has
- * failed to be started)
- */
-#define MME_APP_TIMER_INACTIVE_ID   (-1)
+mme_ue_s1ap_id_t mme_app_ctx_get_new_ue_id(const int worker_index, const int num_workers);
+teid_t mme_app_ctx_get_new_s11_teid(const int worker_index, const int num_workers);
 #define MME_APP_DELTA_T3412_REACHABILITY_TIMER 4 // in minutes 
 #define MME_APP_DELTA_REACHABILITY_IMPLICIT_DETACH_TIMER 0 // in minutes 
 
-/* Timer structure */
-struct mme_app_timer_t {
-  long id;         /* The timer identifier                 */
-  long sec;       /* The timer interval value in seconds  */
-};
+typedef enum {
+  MME_APP_IDLE_TIMER_NONE = 0,
+  MME_APP_IDLE_TIMER_MOBILE_REACHABILITY,
+  MME_APP_IDLE_TIMER_IMPLICIT_DETACH,
+} mme_app_idle_timer_type_t;
+
+/* Idle UE timer, entry of the expiry wheel of the MME_APP worker owning the UE (mme_app_idle.c) */
+typedef struct mme_app_idle_timer_s {
+  struct ue_context_s *next;
+  struct ue_context_s *prev;
+  uint32_t             expiry_sec;   /* Expiry, in seconds on the wheel clock      */
+  uint8_t              type;         /* mme_app_idle_timer_type_t, NONE if stopped */
+  uint8_t              worker_index; /* Wheel the timer is linked in               */
+} mme_app_idle_timer_t;
 
 /** @struct bearer_context_t
  *  @brief Parameters that should be kept for an eps bearer.
@@ -120,6 +125,26 @@ typedef struct bearer_context_s {
 } bearer_context_t;
 
 
+/** @struct pending_pdn_connectivity_req_t
+ *  @brief Parameters of a NAS PDN connectivity request saved until the
+ * S11 create session response is received. Allocated on the request and
+ * freed with mme_app_free_pending_pdn_connectivity_req(), so that idle UEs
+ * do not carry them.
+ */
+typedef struct pending_pdn_connectivity_req_s {
+  char                   imsi[16];
+  uint8_t                imsi_length;
+  bstring                apn;
+  bstring                pdn_addr;
+  int                    pti;
+  unsigned               ue_id;
+  network_qos_t          qos;
+  protocol_configuration_options_t   pco;
+  // DO NOT FREE THE FOLLOWING POINTER, IT IS esm_proc_data_t*
+  void                  *proc_data;
+  int                    request_type;
+} pending_pdn_connectivity_req_t;
+
 /** @struct ue_context_t
  *  @brief Useful parameters to know in MME application layer. They are set
  * according to 3GPP TS.23.401 #5.7.2
@@ -144,7 +169,8 @@ typedef struct ue_context_s {
 
 #define SUBSCRIPTION_UNKNOWN    0x0
 #define SUBSCRIPTION_KNOWN      0x1
-  unsigned               subscription_known:1;        // set by S6A UPDATE LOCATION ANSWER
+  unsigned               subscription_known:1;        // set by S6A UPDATE LOCATION ANSWER, reset when the HSS cancels or changes it
+  plmn_t                 subscription_visited_plmn;   // visited PLMN of the update location that got the subscription data
   uint8_t                msisdn[MSISDN_LENGTH+1];     // set by S6A UPDATE LOCATION ANSWER
   uint8_t                msisdn_length;               // set by S6A UPDATE LOCATION ANSWER
 
@@ -176,7 +202,7 @@ typedef struct ue_context_s {
 
   /* TODO: add DRX parameter */
 
-  apn_config_profile_t   apn_profile;                  // set by S6A UPDATE LOCATION ANSWER
+  const apn_config_profile_t *apn_profile;            // set by S6A UPDATE LOCATION ANSWER, interned, shared with other UEs
   ard_t                  access_restriction_data;      // set by S6A UPDATE LOCATION ANSWER
   subscriber_status_t    sub_status;                   // set by S6A UPDATE LOCATION ANSWER
   ambr_t                 subscribed_ambr;              // set by S6A UPDATE LOCATION ANSWER
@@ -194,36 +220,57 @@ typedef struct ue_context_s {
   teid_t                 sgw_s11_teid;                // set by S11 CREATE_SESSION_RESPONSE
   PAA_t                  paa;                         // set by S11 CREATE_SESSION_RESPONSE
 
-  // temp
-  char                   pending_pdn_connectivity_req_imsi[16];
-  uint8_t                pending_pdn_connectivity_req_imsi_length;
-  bstring                pending_pdn_connectivity_req_apn;
-  bstring                pending_pdn_connectivity_req_pdn_addr;
-  int                    pending_pdn_connectivity_req_pti;
-  unsigned               pending_pdn_connectivity_req_ue_id;
-  network_qos_t          pending_pdn_connectivity_req_qos;
-  protocol_configuration_options_t   pending_pdn_connectivity_req_pco;
-  void                  *pending_pdn_connectivity_req_proc_data;
-  int                    pending_pdn_connectivity_req_request_type;
+  // Transient, only allocated while a NAS PDN CONNECTIVITY REQ is processed (S6A ULR then S11 CSR)
+  struct pending_pdn_connectivity_req_s *pending_pdn_connectivity_req;
   ebi_t                  default_bearer_id;
   bearer_context_t       eps_bearers[BEARERS_PER_UE];
   
   // Mobile Reachability Timer-Start when UE moves to idle state. Stop when UE moves to connected state
-  struct mme_app_timer_t       mobile_reachability_timer; 
+  uint32_t               mobile_reachability_timer_sec;
   // Implicit Detach Timer-Start at the expiry of Mobile Reachability timer. Stop when UE moves to connected state
-  struct mme_app_timer_t       implicit_detach_timer; 
+  uint32_t               implicit_detach_timer_sec;
+  // The running one of the two timers above
+  mme_app_idle_timer_t   idle_timer;
 
 } ue_context_t;
 
 
+// At least MME_APP_WORKERS_MAX
+#define MME_UE_CONTEXT_SHARDS_MAX 8
+
+/*
+ * Each collection is split in one shard per MME_APP worker, a key lives in shard (key % nb_shards).
+ * The mme_ue_s1ap_id, the MME S11 TEID and the M-TMSI are allocated by the worker owning the UE
+ * (see mme_app_ctx_get_new_ue_id()), so that worker only touches its own shards for them.
+ */
 typedef struct mme_ue_context_s {
-  hash_table_ts_t       *imsi_ue_context_htbl;
-  hash_table_ts_t       *tun11_ue_context_htbl;
-  hash_table_ts_t       *mme_ue_s1ap_id_ue_context_htbl;
-  hash_table_ts_t       *enb_ue_s1ap_id_ue_context_htbl;
-  obj_hash_table_t      *guti_ue_context_htbl;
+  int                    nb_shards;
+  hash_table_ts_t       *imsi_ue_context_htbl[MME_UE_CONTEXT_SHARDS_MAX];
+  hash_table_ts_t       *tun11_ue_context_htbl[MME_UE_CONTEXT_SHARDS_MAX];
+  hash_table_ts_t       *mme_ue_s1ap_id_ue_context_htbl[MME_UE_CONTEXT_SHARDS_MAX];
+  hash_table_ts_t       *enb_ue_s1ap_id_ue_context_htbl[MME_UE_CONTEXT_SHARDS_MAX];
+  hash_table_ts_t       *guti_ue_context_htbl[MME_UE_CONTEXT_SHARDS_MAX];  // key is guti_key(), shard by M-TMSI
 } mme_ue_context_t;
 
+#define MME_UE_CONTEXT_SHARD(mME_uE_cONTEXT_p, kEY)         ((uint64_t)(kEY) % (uint64_t)(mME_uE_cONTEXT_p)->nb_shards)
+#define IMSI_UE_CONTEXT_HTBL(mME_uE_cONTEXT_p, iMSI)        ((mME_uE_cONTEXT_p)->imsi_ue_context_htbl[MME_UE_CONTEXT_SHARD(mME_uE_cONTEXT_p, iMSI)])
+#define TUN11_UE_CONTEXT_HTBL(mME_uE_cONTEXT_p, tEID)       ((mME_uE_cONTEXT_p)->tun11_ue_context_htbl[MME_UE_CONTEXT_SHARD(mME_uE_cONTEXT_p, tEID)])
+#define MME_UE_S1AP_ID_UE_CONTEXT_HTBL(mME_uE_cONTEXT_p, iD) ((mME_uE_cONTEXT_p)->mme_ue_s1ap_id_ue_context_htbl[MME_UE_CONTEXT_SHARD(mME_uE_cONTEXT_p, iD)])
+#define ENB_UE_S1AP_ID_UE_CONTEXT_HTBL(mME_uE_cONTEXT_p, kEY) ((mME_uE_cONTEXT_p)->enb_ue_s1ap_id_ue_context_htbl[MME_UE_CONTEXT_SHARD(mME_uE_cONTEXT_p, kEY)])
+#define GUTI_UE_CONTEXT_HTBL(mME_uE_cONTEXT_p, gUTI_p)      ((mME_uE_cONTEXT_p)->guti_ue_context_htbl[MME_UE_CONTEXT_SHARD(mME_uE_cONTEXT_p, (gUTI_p)->m_tmsi)])
+
+
+/** \brief Create the UE context collections
+ * \param mme_ue_context_p The collections
+ * \param nb_shards        Number of shards of each collection, one per MME_APP worker
+ * \param max_ues          Number of UEs the collections are sized for
+ **/
+void mme_ue_context_init(mme_ue_context_t * const mme_ue_context_p, const int nb_shards, const hash_size_t max_ues);
+
+/** \brief Destroy the UE context collections, not the UE contexts
+ * \param mme_ue_context_p The collections
+ **/
+void mme_ue_context_exit(mme_ue_context_t * const mme_ue_context_p);
 
 /** \brief Retrieve an UE context by selecting the provided IMSI
  * \param imsi Imsi to find in UE map
@@ -267,6 +314,17 @@ ue_context_t *mme_ue_context_exists_guti(mme_ue_context_t * const mme_ue_context
  **/
 void mme_app_move_context (ue_context_t *dst, ue_context_t *src);
 
+/** \brief Get the pending PDN connectivity request of a context, allocating it if needed
+ * \param ue_context_p   The UE context
+ * @returns The pending PDN connectivity request, never NULL
+ **/
+pending_pdn_connectivity_req_t *mme_app_get_pending_pdn_connectivity_req (ue_context_t * const ue_context_p);
+
+/** \brief Release the pending PDN connectivity request of a context once the procedure is over
+ * \param ue_context_p   The UE context
+ **/
+void mme_app_free_pending_pdn_connectivity_req (ue_context_t * const ue_context_p);
+
 /** \brief Notify the MME_APP that a duplicated ue_context_t exist (both share the same mme_ue_s1ap_id)
  * \param enb_key        The UE id identifier used in S1AP and MME_APP (agregated with a enb_id)
  * \param mme_ue_s1ap_id The UE id identifier used in MME_APP and NAS
@@ -348,7 +406,7 @@ void mme_app_dump_ue_contexts(const mme_ue_context_t * const mme_ue_context);
 
 void mme_app_handle_s1ap_ue_context_release_req(const itti_s1ap_ue_context_release_req_t const *s1ap_ue_context_release_req);
 
-void mme_app_handle_enb_deregister_ind(const itti_s1ap_eNB_deregistered_ind_t const* eNB_deregistered_ind);
+void mme_app_handle_enb_deregister_ind(const int worker_index, const itti_s1ap_eNB_deregistered_ind_t const* eNB_deregistered_ind);
 
 void mme_app_send_delete_session_request (struct ue_context_s *ue_context_p);
 
@@ -62,7 +62,8 @@ int mme_config_find_mnc_length (
   uint16_t                                mcc = 100 * mcc_digit1P + 10 * mcc_digit2P + mcc_digit3P;
   uint16_t                                mnc3 = 100 * mnc_digit1P + 10 * mnc_digit2P + mnc_digit3P;
   uint16_t                                mnc2 = 10 * mnc_digit1P + mnc_digit2P;
-  int                                     plmn_index = 0;
+  mme_config_served_t                    *served = NULL;
+  int                                     mnc_length = 0;
 
   AssertFatal ((mcc_digit1P >= 0) && (mcc_digit1P <= 9)
                && (mcc_digit2P >= 0) && (mcc_digit2P <= 9)
@@ -70,22 +71,16 @@ int mme_config_find_mnc_length (
   AssertFatal ((mnc_digit2P >= 0) && (mnc_digit2P <= 9)
                && (mnc_digit1P >= 0) && (mnc_digit1P <= 9), "BAD MNC PARAMETER (%d.%d.%d)!\n", mnc_digit1P, mnc_digit2P, mnc_digit3P);
 
-  while (plmn_index < mme_config.served_tai.nb_tai) {
-    if (mme_config.served_tai.plmn_mcc[plmn_index] == mcc) {
-      if ((mme_config.served_tai.plmn_mnc[plmn_index] == mnc2) && (mme_config.served_tai.plmn_mnc_len[plmn_index] == 2)) {
-        return 2;
-      } else if ((mme_config.served_tai.plmn_mnc[plmn_index] == mnc3) && (mme_config.served_tai.plmn_mnc_len[plmn_index] == 3)) {
-        return 3;
-      }
-    }
-
-    plmn_index += 1;
+  served = mme_config_served_acquire ();
+  if (mme_config_served_has_plmn (served, mcc, mnc2, 2)) {
+    mnc_length = 2;
+  } else if (mme_config_served_has_plmn (served, mcc, mnc3, 3)) {
+    mnc_length = 3;
   }
-
-  return 0;
+  mme_config_served_release (served);
+  return mnc_length;
 }
 
-
 //------------------------------------------------------------------------------
 static void mme_config_init (mme_config_t * config_pP)
 {
@@ -134,8 +129,12 @@ static void mme_config_init (mme_config_t * config_pP)
   config_pP->s6a_config.conf_file = bfromcstr(S6A_CONF_FILE);
   config_pP->itti_config.queue_size = ITTI_QUEUE_MAX_ELEMENTS;
   config_pP->itti_config.log_file = NULL;
+  config_pP->num_app_workers = 1;
+  config_pP->num_s1ap_codec_workers = 0;
+  config_pP->num_s11_workers = 1;
   config_pP->sctp_config.in_streams = SCTP_IN_STREAMS;
   config_pP->sctp_config.out_streams = SCTP_OUT_STREAMS;
+  config_pP->sctp_config.send_queue_size = SCTP_SEND_QUEUE_SIZE;
   config_pP->relative_capacity = RELATIVE_CAPACITY;
   config_pP->mme_statistic_timer = MME_STATISTIC_TIMER_S;
   config_pP->gummei.nb = 1;
@@ -161,8 +160,205 @@ static void mme_config_init (mme_config_t * config_pP)
   config_pP->served_tai.plmn_mnc_len[0] = PLMN_MNC_LEN;
   config_pP->served_tai.tac[0] = PLMN_TAC;
   config_pP->s1ap_config.outcome_drop_timer_sec = S1AP_OUTCOME_TIMER_DEFAULT;
+  config_pP->s1ap_config.paging_timer_ms = S1AP_PAGING_TIMER_MS_DEFAULT;
+  config_pP->s1ap_config.paging_max_attempts = S1AP_PAGING_MAX_ATTEMPTS_DEFAULT;
+  config_pP->s1ap_config.max_paging_per_enb_per_sec = S1AP_MAX_PAGING_PER_ENB_PER_SEC_DEFAULT;
+  config_pP->overload_config.enabled = false;
+  config_pP->overload_config.check_period_ms = OVERLOAD_CHECK_PERIOD_MS_DEFAULT;
+  config_pP->overload_config.queue_depth_high = OVERLOAD_QUEUE_DEPTH_HIGH_DEFAULT;
+  config_pP->overload_config.queue_depth_low = OVERLOAD_QUEUE_DEPTH_LOW_DEFAULT;
+  config_pP->overload_config.queue_delay_high_ms = OVERLOAD_QUEUE_DELAY_HIGH_MS_DEFAULT;
+  config_pP->overload_config.queue_delay_low_ms = OVERLOAD_QUEUE_DELAY_LOW_MS_DEFAULT;
+  config_pP->overload_config.enb_percent = OVERLOAD_ENB_PERCENT_DEFAULT;
+  config_pP->overload_config.action = S1AP_OVERLOAD_REJECT_NON_EMERGENCY_MO_DT;
+  config_pP->idle_supervision_config.implicit_detach_jitter_sec = IMPLICIT_DETACH_JITTER_SEC_DEFAULT;
+  config_pP->idle_supervision_config.max_implicit_detach_per_sec = MAX_IMPLICIT_DETACH_PER_SEC_DEFAULT;
+}
+
+
+//------------------------------------------------------------------------------
+static int mme_config_parse_tai_list (config_setting_t * setting, mme_config_t * config_pP)
+{
+  config_setting_t                       *sub2setting = NULL;
+  int                                     i = 0,n = 0,
+                                          stop_index = 0,
+                                          num = 0;
+  const char                             *tac = NULL;
+  const char                             *mcc = NULL;
+  const char                             *mnc = NULL;
+  bool                                    swap = false;
+
+  num = config_setting_length (setting);
+  if ((1 > num) || (TAI_LIST_MAX_SIZE < num)) {
+    OAILOG_ERROR (LOG_CONFIG, "Bad number of TAIs configured %d, must be in [1..%d]\n", num, TAI_LIST_MAX_SIZE);
+    return RETURNerror;
+  }
+
+  if (config_pP->served_tai.nb_tai != num) {
+    if (config_pP->served_tai.plmn_mcc != NULL)
+      free_wrapper ((void**) &config_pP->served_tai.plmn_mcc);
+
+    if (config_pP->served_tai.plmn_mnc != NULL)
+      free_wrapper ((void**) &config_pP->served_tai.plmn_mnc);
+
+    if (config_pP->served_tai.plmn_mnc_len != NULL)
+      free_wrapper ((void**) &config_pP->served_tai.plmn_mnc_len);
+
+    if (config_pP->served_tai.tac != NULL)
+      free_wrapper ((void**) &config_pP->served_tai.tac);
+
+    config_pP->served_tai.plmn_mcc = calloc (num, sizeof (*config_pP->served_tai.plmn_mcc));
+    config_pP->served_tai.plmn_mnc = calloc (num, sizeof (*config_pP->served_tai.plmn_mnc));
+    config_pP->served_tai.plmn_mnc_len = calloc (num, sizeof (*config_pP->served_tai.plmn_mnc_len));
+    config_pP->served_tai.tac = calloc (num, sizeof (*config_pP->served_tai.tac));
+  }
+
+  config_pP->served_tai.nb_tai = num;
+
+  for (i = 0; i < num; i++) {
+    sub2setting = config_setting_get_elem (setting, i);
+
+    if (sub2setting != NULL) {
+      if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_MCC, &mcc))) {
+        config_pP->served_tai.plmn_mcc[i] = (uint16_t) atoi (mcc);
+      }
+
+      if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_MNC, &mnc))) {
+        config_pP->served_tai.plmn_mnc[i] = (uint16_t) atoi (mnc);
+        config_pP->served_tai.plmn_mnc_len[i] = strlen (mnc);
+        if ((config_pP->served_tai.plmn_mnc_len[i] != 2) && (config_pP->served_tai.plmn_mnc_len[i] != 3)) {
+          OAILOG_ERROR (LOG_CONFIG, "Bad MNC length %u, must be 2 or 3\n", config_pP->served_tai.plmn_mnc_len[i]);
+          return RETURNerror;
+        }
+      }
+
+      if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_TAC, &tac))) {
+        config_pP->served_tai.tac[i] = (uint16_t) atoi (tac);
+        if (!TAC_IS_VALID(config_pP->served_tai.tac[i])) {
+          OAILOG_ERROR (LOG_CONFIG, "Invalid TAC value "TAC_FMT"\n", config_pP->served_tai.tac[i]);
+          return RETURNerror;
+        }
+      }
+    }
+  }
+  // sort TAI list
+  n = config_pP->served_tai.nb_tai;
+  do {
+    stop_index = 0;
+    for (i = 1; i < n; i++) {
+      swap = false;
+      if (config_pP->served_tai.plmn_mcc[i-1] > config_pP->served_tai.plmn_mcc[i]) {
+        swap = true;
+      } else if (config_pP->served_tai.plmn_mcc[i-1] == config_pP->served_tai.plmn_mcc[i]) {
+        if (config_pP->served_tai.plmn_mnc[i-1] > config_pP->served_tai.plmn_mnc[i]) {
+          swap = true;
+        } else  if (config_pP->served_tai.plmn_mnc[i-1] == config_pP->served_tai.plmn_mnc[i]) {
+          if (config_pP->served_tai.tac[i-1] > config_pP->served_tai.tac[i]) {
+            swap = true;
+          }
+        }
+      }
+      if (true == swap) {
+        uint16_t swap16;
+        swap16 = config_pP->served_tai.plmn_mcc[i-1];
+        config_pP->served_tai.plmn_mcc[i-1] = config_pP->served_tai.plmn_mcc[i];
+        config_pP->served_tai.plmn_mcc[i]   = swap16;
+
+        swap16 = config_pP->served_tai.plmn_mnc[i-1];
+        config_pP->served_tai.plmn_mnc[i-1] = config_pP->served_tai.plmn_mnc[i];
+        config_pP->served_tai.plmn_mnc[i]   = swap16;
+
+        swap16 = config_pP->served_tai.plmn_mnc_len[i-1];
+        config_pP->served_tai.plmn_mnc_len[i-1] = config_pP->served_tai.plmn_mnc_len[i];
+        config_pP->served_tai.plmn_mnc_len[i]   = swap16;
+
+        swap16 = config_pP->served_tai.tac[i-1];
+        config_pP->served_tai.tac[i-1] = config_pP->served_tai.tac[i];
+        config_pP->served_tai.tac[i]   = swap16;
+
+        stop_index = i;
+      }
+    }
+    n = stop_index;
+  } while (0 != n);
+  // helper for determination of list type (global view), we could make sublists with different types, but keep things simple for now
+  config_pP->served_tai.list_type = TRACKING_AREA_IDENTITY_LIST_TYPE_ONE_PLMN_CONSECUTIVE_TACS;
+  for (i = 1; i < config_pP->served_tai.nb_tai; i++) {
+    if ((config_pP->served_tai.plmn_mcc[i] != config_pP->served_tai.plmn_mcc[0]) ||
+        (config_pP->served_tai.plmn_mnc[i] != config_pP->served_tai.plmn_mnc[0])){
+      config_pP->served_tai.list_type = TRACKING_AREA_IDENTITY_LIST_TYPE_MANY_PLMNS;
+      break;
+    } else if ((config_pP->served_tai.plmn_mcc[i] != config_pP->served_tai.plmn_mcc[i-1]) ||
+               (config_pP->served_tai.plmn_mnc[i] != config_pP->served_tai.plmn_mnc[i-1])) {
+      config_pP->served_tai.list_type = TRACKING_AREA_IDENTITY_LIST_TYPE_MANY_PLMNS;
+      break;
+    }
+    if (config_pP->served_tai.tac[i] != (config_pP->served_tai.tac[i-1] + 1)) {
+      config_pP->served_tai.list_type = TRACKING_AREA_IDENTITY_LIST_TYPE_ONE_PLMN_NON_CONSECUTIVE_TACS;
+    }
+  }
+  return RETURNok;
 }
 
+//------------------------------------------------------------------------------
+static int mme_config_parse_gummei_list (config_setting_t * setting, mme_config_t * config_pP)
+{
+  config_setting_t                       *sub2setting = NULL;
+  int                                     i = 0,
+                                          num = 0;
+  const char                             *mcc = NULL;
+  const char                             *mnc = NULL;
+
+  num = config_setting_length (setting);
+  if (1 != num) {
+    OAILOG_ERROR (LOG_CONFIG, "Only one GUMMEI supported for this version of MME\n");
+    return RETURNerror;
+  }
+  for (i = 0; i < num; i++) {
+    sub2setting = config_setting_get_elem (setting, i);
+
+    if (sub2setting != NULL) {
+      if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_MCC, &mcc))) {
+        if (3 != strlen(mcc)) {
+          OAILOG_ERROR (LOG_CONFIG, "Bad MCC length, it must be 3 digit ex: 001\n");
+          return RETURNerror;
+        }
+        char c[2] = { mcc[0], 0};
+        config_pP->gummei.gummei[i].plmn.mcc_digit1 = (uint8_t) atoi (c);
+        c[0] = mcc[1];
+        config_pP->gummei.gummei[i].plmn.mcc_digit2 = (uint8_t) atoi (c);
+        c[0] = mcc[2];
+        config_pP->gummei.gummei[i].plmn.mcc_digit3 = (uint8_t) atoi (c);
+      }
+
+      if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_MNC, &mnc))) {
+        if ((3 != strlen(mnc)) && (2 != strlen(mnc))) {
+          OAILOG_ERROR (LOG_CONFIG, "Bad MNC length, it must be 2 or 3 digit ex: 01\n");
+          return RETURNerror;
+        }
+        char c[2] = { mnc[0], 0};
+        config_pP->gummei.gummei[i].plmn.mnc_digit1 = (uint8_t) atoi (c);
+        c[0] = mnc[1];
+        config_pP->gummei.gummei[i].plmn.mnc_digit2 = (uint8_t) atoi (c);
+        if (3 == strlen(mnc)) {
+          c[0] = mnc[2];
+          config_pP->gummei.gummei[i].plmn.mnc_digit3 = (uint8_t) atoi (c);
+        } else {
+          config_pP->gummei.gummei[i].plmn.mnc_digit3 = 0x0F;
+        }
+      }
+
+      if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_MME_GID, &mnc))) {
+        config_pP->gummei.gummei[i].mme_gid = (uint16_t) atoi (mnc);
+      }
+      if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_MME_CODE, &mnc))) {
+        config_pP->gummei.gummei[i].mme_code = (uint8_t) atoi (mnc);
+      }
+      config_pP->gummei.nb += 1;
+    }
+  }
+  return RETURNok;
+}
 
 //------------------------------------------------------------------------------
 static int mme_config_parse_file (mme_config_t * config_pP)
@@ -171,21 +367,15 @@ static int mme_config_parse_file (mme_config_t * config_pP)
   config_setting_t                       *setting_mme = NULL;
   config_setting_t                       *setting = NULL;
   config_setting_t                       *subsetting = NULL;
-  config_setting_t                       *sub2setting = NULL;
   int                                     aint = 0;
-  int                                     i = 0,n = 0,
-                                          stop_index = 0,
+  int                                     i = 0,
                                           num = 0;
   const char                             *astring = NULL;
-  const char                             *tac = NULL;
-  const char                             *mcc = NULL;
-  const char                             *mnc = NULL;
   char                                   *if_name_s1_mme = NULL;
   char                                   *s1_mme = NULL;
   char                                   *if_name_s11 = NULL;
   char                                   *s11 = NULL;
   char                                   *sgw_ip_address_for_s11 = NULL;
-  bool                                    swap = false;
   bstring                                 address = NULL;
   bstring                                 cidr = NULL;
   bstring                                 mask = NULL;
@@ -320,6 +510,11 @@ static int mme_config_parse_file (mme_config_t * config_pP)
       config_pP->mme_statistic_timer = (uint32_t) aint;
     }
 
+    if ((config_setting_lookup_int (setting_mme, MME_CONFIG_STRING_METRICS_PORT, &aint))) {
+      AssertFatal ((0 <= aint) && (UINT16_MAX >= aint), "Bad %s value %d\n", MME_CONFIG_STRING_METRICS_PORT, aint);
+      config_pP->metrics_port = (uint16_t) aint;
+    }
+
     if ((config_setting_lookup_string (setting_mme, EPS_NETWORK_FEATURE_SUPPORT_EMERGENCY_BEARER_SERVICES_IN_S1_MODE, (const char **)&astring))) {
       if (strcasecmp (astring, "yes") == 0)
         config_pP->eps_network_feature_support.emergency_bearer_services_in_s1_mode = 1;
@@ -359,6 +554,22 @@ static int mme_config_parse_file (mme_config_t * config_pP)
       if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_QUEUE_SIZE, &aint))) {
         config_pP->itti_config.queue_size = (uint32_t) aint;
       }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_MME_APP_WORKERS, &aint))) {
+        AssertFatal ((0 < aint) && (MME_APP_WORKERS_MAX >= aint),
+            "Bad %s value %d, must be in [1..%d]\n", MME_CONFIG_STRING_INTERTASK_INTERFACE_MME_APP_WORKERS, aint, MME_APP_WORKERS_MAX);
+        config_pP->num_app_workers = (uint8_t) aint;
+      }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_S1AP_CODEC_WORKERS, &aint))) {
+        AssertFatal ((0 <= aint) && (S1AP_CODEC_WORKERS_MAX >= aint),
+            "Bad %s value %d, must be in [0..%d]\n", MME_CONFIG_STRING_INTERTASK_INTERFACE_S1AP_CODEC_WORKERS, aint, S1AP_CODEC_WORKERS_MAX);
+        config_pP->num_s1ap_codec_workers = (uint8_t) aint;
+      }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_S11_WORKERS, &aint))) {
+        AssertFatal ((0 < aint) && (S11_WORKERS_MAX >= aint),
+            "Bad %s value %d, must be in [1..%d]\n", MME_CONFIG_STRING_INTERTASK_INTERFACE_S11_WORKERS, aint, S11_WORKERS_MAX);
+        config_pP->num_s11_workers = (uint8_t) aint;
+      }
+      itti_task_placements_config_parse (setting, &config_pP->itti_config.task_placements);
     }
     // S6A SETTING
     setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_S6A_CONFIG);
@@ -396,6 +607,11 @@ static int mme_config_parse_file (mme_config_t * config_pP)
       if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_SCTP_OUTSTREAMS, &aint))) {
         config_pP->sctp_config.out_streams = (uint16_t) aint;
       }
+
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_SCTP_SEND_QUEUE_SIZE, &aint))) {
+        AssertFatal (aint >= 4, "%s must be at least 4\n", MME_CONFIG_STRING_SCTP_SEND_QUEUE_SIZE);
+        config_pP->sctp_config.send_queue_size = (uint32_t) aint;
+      }
     }
     // S1AP SETTING
     setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_S1AP_CONFIG);
@@ -408,152 +624,96 @@ static int mme_config_parse_file (mme_config_t * config_pP)
       if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_S1AP_PORT, &aint))) {
         config_pP->s1ap_config.port_number = (uint16_t) aint;
       }
-    }
-    // TAI list setting
-    setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_TAI_LIST);
-    if (setting != NULL) {
-      num = config_setting_length (setting);
 
-      if (config_pP->served_tai.nb_tai != num) {
-        if (config_pP->served_tai.plmn_mcc != NULL)
-          free_wrapper ((void**) &config_pP->served_tai.plmn_mcc);
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_S1AP_PAGING_TIMER_MS, &aint))) {
+        AssertFatal (aint > 0, "Bad %s value %d\n", MME_CONFIG_STRING_S1AP_PAGING_TIMER_MS, aint);
+        config_pP->s1ap_config.paging_timer_ms = (uint32_t) aint;
+      }
+
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_S1AP_PAGING_MAX_ATTEMPTS, &aint))) {
+        AssertFatal ((0 < aint) && (UINT8_MAX >= aint), "Bad %s value %d, must be in [1..%d]\n", MME_CONFIG_STRING_S1AP_PAGING_MAX_ATTEMPTS, aint, UINT8_MAX);
+        config_pP->s1ap_config.paging_max_attempts = (uint8_t) aint;
+      }
 
-        if (config_pP->served_tai.plmn_mnc != NULL)
-          free_wrapper ((void**) &config_pP->served_tai.plmn_mnc);
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_S1AP_MAX_PAGING_PER_ENB_PER_SEC, &aint))) {
+        AssertFatal (aint >= 0, "Bad %s value %d\n", MME_CONFIG_STRING_S1AP_MAX_PAGING_PER_ENB_PER_SEC, aint);
+        config_pP->s1ap_config.max_paging_per_enb_per_sec = (uint32_t) aint;
+      }
+    }
+    // OVERLOAD CONTROL SETTING
+    setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_OVERLOAD_CONFIG);
 
-        if (config_pP->served_tai.plmn_mnc_len != NULL)
-          free_wrapper ((void**) &config_pP->served_tai.plmn_mnc_len);
+    if (setting != NULL) {
+      if ((config_setting_lookup_string (setting, MME_CONFIG_STRING_OVERLOAD_ENABLED, (const char **)&astring))) {
+        config_pP->overload_config.enabled = (strcasecmp (astring, "yes") == 0);
+      }
 
-        if (config_pP->served_tai.tac != NULL)
-          free_wrapper ((void**) &config_pP->served_tai.tac);
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_OVERLOAD_CHECK_PERIOD_MS, &aint))) {
+        AssertFatal (aint > 0, "Bad %s value %d\n", MME_CONFIG_STRING_OVERLOAD_CHECK_PERIOD_MS, aint);
+        config_pP->overload_config.check_period_ms = (uint32_t) aint;
+      }
 
-        config_pP->served_tai.plmn_mcc = calloc (num, sizeof (*config_pP->served_tai.plmn_mcc));
-        config_pP->served_tai.plmn_mnc = calloc (num, sizeof (*config_pP->served_tai.plmn_mnc));
-        config_pP->served_tai.plmn_mnc_len = calloc (num, sizeof (*config_pP->served_tai.plmn_mnc_len));
-        config_pP->served_tai.tac = calloc (num, sizeof (*config_pP->served_tai.tac));
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_OVERLOAD_QUEUE_DEPTH_HIGH, &aint))) {
+        config_pP->overload_config.queue_depth_high = (uint32_t) aint;
       }
 
-      config_pP->served_tai.nb_tai = num;
-      AssertFatal(16 >= num , "Too many TAIs configured %d", num);
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_OVERLOAD_QUEUE_DEPTH_LOW, &aint))) {
+        config_pP->overload_config.queue_depth_low = (uint32_t) aint;
+      }
 
-      for (i = 0; i < num; i++) {
-        sub2setting = config_setting_get_elem (setting, i);
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_OVERLOAD_QUEUE_DELAY_HIGH_MS, &aint))) {
+        config_pP->overload_config.queue_delay_high_ms = (uint32_t) aint;
+      }
 
-        if (sub2setting != NULL) {
-          if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_MCC, &mcc))) {
-            config_pP->served_tai.plmn_mcc[i] = (uint16_t) atoi (mcc);
-          }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_OVERLOAD_QUEUE_DELAY_LOW_MS, &aint))) {
+        config_pP->overload_config.queue_delay_low_ms = (uint32_t) aint;
+      }
 
-          if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_MNC, &mnc))) {
-            config_pP->served_tai.plmn_mnc[i] = (uint16_t) atoi (mnc);
-            config_pP->served_tai.plmn_mnc_len[i] = strlen (mnc);
-            AssertFatal ((config_pP->served_tai.plmn_mnc_len[i] == 2) || (config_pP->served_tai.plmn_mnc_len[i] == 3),
-                "Bad MNC length %u, must be 2 or 3", config_pP->served_tai.plmn_mnc_len[i]);
-          }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_OVERLOAD_ENB_PERCENT, &aint))) {
+        AssertFatal ((0 < aint) && (100 >= aint), "Bad %s value %d, must be in [1..100]\n", MME_CONFIG_STRING_OVERLOAD_ENB_PERCENT, aint);
+        config_pP->overload_config.enb_percent = (uint8_t) aint;
+      }
 
-          if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_TAC, &tac))) {
-            config_pP->served_tai.tac[i] = (uint16_t) atoi (tac);
-            AssertFatal(TAC_IS_VALID(config_pP->served_tai.tac[i]), "Invalid TAC value "TAC_FMT, config_pP->served_tai.tac[i]);
-          }
-        }
+      if ((config_setting_lookup_string (setting, MME_CONFIG_STRING_OVERLOAD_ACTION, (const char **)&astring))) {
+        if (strcasecmp (astring, MME_CONFIG_STRING_OVERLOAD_ACTION_REJECT_NON_EMERGENCY_MO_DT) == 0)
+          config_pP->overload_config.action = S1AP_OVERLOAD_REJECT_NON_EMERGENCY_MO_DT;
+        else if (strcasecmp (astring, MME_CONFIG_STRING_OVERLOAD_ACTION_REJECT_ALL_RRC_CR_SIGNALLING) == 0)
+          config_pP->overload_config.action = S1AP_OVERLOAD_REJECT_ALL_RRC_CR_SIGNALLING;
+        else if (strcasecmp (astring, MME_CONFIG_STRING_OVERLOAD_ACTION_PERMIT_EMERGENCY_SESSIONS_ONLY) == 0)
+          config_pP->overload_config.action = S1AP_OVERLOAD_PERMIT_EMERGENCY_SESSIONS_ONLY;
+        else
+          AssertFatal (0, "Bad %s value %s\n", MME_CONFIG_STRING_OVERLOAD_ACTION, astring);
       }
-      // sort TAI list
-      n = config_pP->served_tai.nb_tai;
-      do {
-        stop_index = 0;
-        for (i = 1; i < n; i++) {
-          swap = false;
-          if (config_pP->served_tai.plmn_mcc[i-1] > config_pP->served_tai.plmn_mcc[i]) {
-            swap = true;
-          } else if (config_pP->served_tai.plmn_mcc[i-1] == config_pP->served_tai.plmn_mcc[i]) {
-            if (config_pP->served_tai.plmn_mnc[i-1] > config_pP->served_tai.plmn_mnc[i]) {
-              swap = true;
-            } else  if (config_pP->served_tai.plmn_mnc[i-1] == config_pP->served_tai.plmn_mnc[i]) {
-              if (config_pP->served_tai.tac[i-1] > config_pP->served_tai.tac[i]) {
-                swap = true;
-              }
-            }
-          }
-          if (true == swap) {
-            uint16_t swap16;
-            swap16 = config_pP->served_tai.plmn_mcc[i-1];
-            config_pP->served_tai.plmn_mcc[i-1] = config_pP->served_tai.plmn_mcc[i];
-            config_pP->served_tai.plmn_mcc[i]   = swap16;
 
-            swap16 = config_pP->served_tai.plmn_mnc[i-1];
-            config_pP->served_tai.plmn_mnc[i-1] = config_pP->served_tai.plmn_mnc[i];
-            config_pP->served_tai.plmn_mnc[i]   = swap16;
+      AssertFatal ((config_pP->overload_config.queue_depth_low < config_pP->overload_config.queue_depth_high) &&
+                   (config_pP->overload_config.queue_delay_low_ms < config_pP->overload_config.queue_delay_high_ms),
+                   "Overload control low thresholds must be lower than high thresholds\n");
+    }
+    // IDLE UE SUPERVISION SETTING
+    setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_IDLE_SUPERVISION_CONFIG);
 
-            swap16 = config_pP->served_tai.tac[i-1];
-            config_pP->served_tai.tac[i-1] = config_pP->served_tai.tac[i];
-            config_pP->served_tai.tac[i]   = swap16;
+    if (setting != NULL) {
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_IMPLICIT_DETACH_JITTER_SEC, &aint))) {
+        AssertFatal (aint >= 0, "Bad %s value %d\n", MME_CONFIG_STRING_IMPLICIT_DETACH_JITTER_SEC, aint);
+        config_pP->idle_supervision_config.implicit_detach_jitter_sec = (uint32_t) aint;
+      }
 
-            stop_index = i;
-          }
-        }
-        n = stop_index;
-      } while (0 != n);
-      // helper for determination of list type (global view), we could make sublists with different types, but keep things simple for now
-      config_pP->served_tai.list_type = TRACKING_AREA_IDENTITY_LIST_TYPE_ONE_PLMN_CONSECUTIVE_TACS;
-      for (i = 1; i < config_pP->served_tai.nb_tai; i++) {
-        if ((config_pP->served_tai.plmn_mcc[i] != config_pP->served_tai.plmn_mcc[0]) ||
-            (config_pP->served_tai.plmn_mnc[i] != config_pP->served_tai.plmn_mnc[0])){
-          config_pP->served_tai.list_type = TRACKING_AREA_IDENTITY_LIST_TYPE_MANY_PLMNS;
-          break;
-        } else if ((config_pP->served_tai.plmn_mcc[i] != config_pP->served_tai.plmn_mcc[i-1]) ||
-                   (config_pP->served_tai.plmn_mnc[i] != config_pP->served_tai.plmn_mnc[i-1])) {
-          config_pP->served_tai.list_type = TRACKING_AREA_IDENTITY_LIST_TYPE_MANY_PLMNS;
-          break;
-        }
-        if (config_pP->served_tai.tac[i] != (config_pP->served_tai.tac[i-1] + 1)) {
-          config_pP->served_tai.list_type = TRACKING_AREA_IDENTITY_LIST_TYPE_ONE_PLMN_NON_CONSECUTIVE_TACS;
-        }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_MAX_IMPLICIT_DETACH_PER_SEC, &aint))) {
+        AssertFatal (aint >= 0, "Bad %s value %d\n", MME_CONFIG_STRING_MAX_IMPLICIT_DETACH_PER_SEC, aint);
+        config_pP->idle_supervision_config.max_implicit_detach_per_sec = (uint32_t) aint;
       }
     }
+    // TAI list setting
+    setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_TAI_LIST);
+    if (setting != NULL) {
+      AssertFatal (RETURNok == mme_config_parse_tai_list (setting, config_pP), "Bad %s\n", MME_CONFIG_STRING_TAI_LIST);
+    }
 
     // GUMMEI SETTING
     setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_GUMMEI_LIST);
     config_pP->gummei.nb = 0;
     if (setting != NULL) {
-      num = config_setting_length (setting);
-      AssertFatal(num == 1, "Only one GUMMEI supported for this version of MME");
-      for (i = 0; i < num; i++) {
-        sub2setting = config_setting_get_elem (setting, i);
-
-        if (sub2setting != NULL) {
-          if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_MCC, &mcc))) {
-            AssertFatal( 3 == strlen(mcc), "Bad MCC length, it must be 3 digit ex: 001");
-            char c[2] = { mcc[0], 0};
-            config_pP->gummei.gummei[i].plmn.mcc_digit1 = (uint8_t) atoi (c);
-            c[0] = mcc[1];
-            config_pP->gummei.gummei[i].plmn.mcc_digit2 = (uint8_t) atoi (c);
-            c[0] = mcc[2];
-            config_pP->gummei.gummei[i].plmn.mcc_digit3 = (uint8_t) atoi (c);
-          }
-
-          if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_MNC, &mnc))) {
-            AssertFatal( (3 == strlen(mnc)) || (2 == strlen(mnc)) , "Bad MCC length, it must be 3 digit ex: 001");
-            char c[2] = { mnc[0], 0};
-            config_pP->gummei.gummei[i].plmn.mnc_digit1 = (uint8_t) atoi (c);
-            c[0] = mnc[1];
-            config_pP->gummei.gummei[i].plmn.mnc_digit2 = (uint8_t) atoi (c);
-            if (3 == strlen(mnc)) {
-              c[0] = mnc[2];
-              config_pP->gummei.gummei[i].plmn.mnc_digit3 = (uint8_t) atoi (c);
-            } else {
-              config_pP->gummei.gummei[i].plmn.mnc_digit3 = 0x0F;
-            }
-          }
-
-          if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_MME_GID, &mnc))) {
-            config_pP->gummei.gummei[i].mme_gid = (uint16_t) atoi (mnc);
-          }
-          if ((config_setting_lookup_string (sub2setting, MME_CONFIG_STRING_MME_CODE, &mnc))) {
-            config_pP->gummei.gummei[i].mme_code = (uint8_t) atoi (mnc);
-          }
-          config_pP->gummei.nb += 1;
-        }
-      }
+      AssertFatal (RETURNok == mme_config_parse_gummei_list (setting, config_pP), "Bad %s\n", MME_CONFIG_STRING_GUMMEI_LIST);
     }
     // NETWORK INTERFACE SETTING
     setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_NETWORK_INTERFACES_CONFIG);
@@ -666,6 +826,22 @@ static int mme_config_parse_file (mme_config_t * config_pP)
       if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_NAS_T3495_TIMER, &aint))) {
         config_pP->nas_config.t3495_sec = (uint8_t) aint;
       }
+      if ((config_setting_lookup_string (setting, MME_CONFIG_STRING_NAS_TRACE, (const char **)&astring))) {
+        config_pP->nas_config.trace_enabled = (strcasecmp (astring, "yes") == 0);
+      }
+      subsetting = config_setting_get_member (setting, MME_CONFIG_STRING_NAS_TRACE_MESSAGE_TYPES);
+
+      if (subsetting != NULL) {
+        num = config_setting_length (subsetting);
+        AssertFatal (num <= NAS_TRACE_MESSAGE_TYPES_MAX, "Too many NAS message types to trace %d (max %d)\n", num, NAS_TRACE_MESSAGE_TYPES_MAX);
+
+        for (i = 0; i < num; i++) {
+          aint = config_setting_get_int_elem (subsetting, i);
+          AssertFatal ((aint >= 0) && (aint <= UINT8_MAX), "Bad NAS message type to trace %d\n", aint);
+          config_pP->nas_config.trace_message_types[i] = (uint8_t) aint;
+        }
+        config_pP->nas_config.num_trace_message_types = (uint8_t) num;
+      }
     }
   }
 
@@ -711,9 +887,24 @@ static void mme_config_display (mme_config_t * config_pP)
   OAILOG_INFO (LOG_CONFIG, "- Extended service request .............: %s\n", config_pP->eps_network_feature_support.extended_service_request == 0 ? "false" : "true");
   OAILOG_INFO (LOG_CONFIG, "- Unauth IMSI support ..................: %s\n", config_pP->unauthenticated_imsi_supported == 0 ? "false" : "true");
   OAILOG_INFO (LOG_CONFIG, "- Relative capa ........................: %u\n", config_pP->relative_capacity);
-  OAILOG_INFO (LOG_CONFIG, "- Statistics timer .....................: %u (seconds)\n\n", config_pP->mme_statistic_timer);
+  OAILOG_INFO (LOG_CONFIG, "- Statistics timer .....................: %u (seconds)\n", config_pP->mme_statistic_timer);
+  OAILOG_INFO (LOG_CONFIG, "- Metrics port .........................: %u%s\n\n", config_pP->metrics_port, config_pP->metrics_port ? "" : " (disabled)");
   OAILOG_INFO (LOG_CONFIG, "- S1-MME:\n");
   OAILOG_INFO (LOG_CONFIG, "    port number ......: %d\n", config_pP->s1ap_config.port_number);
+  OAILOG_INFO (LOG_CONFIG, "    paging timer .....: %u (ms)\n", config_pP->s1ap_config.paging_timer_ms);
+  OAILOG_INFO (LOG_CONFIG, "    paging attempts ..: %u\n", config_pP->s1ap_config.paging_max_attempts);
+  OAILOG_INFO (LOG_CONFIG, "    paging per eNB/s .: %u\n", config_pP->s1ap_config.max_paging_per_enb_per_sec);
+  OAILOG_INFO (LOG_CONFIG, "- Overload control .....................: %s\n", config_pP->overload_config.enabled ? "true" : "false");
+  if (config_pP->overload_config.enabled) {
+    OAILOG_INFO (LOG_CONFIG, "    check period .....: %u (ms)\n", config_pP->overload_config.check_period_ms);
+    OAILOG_INFO (LOG_CONFIG, "    queue depth ......: %u / %u (high / low)\n", config_pP->overload_config.queue_depth_high, config_pP->overload_config.queue_depth_low);
+    OAILOG_INFO (LOG_CONFIG, "    queue delay ......: %u / %u (ms, high / low)\n", config_pP->overload_config.queue_delay_high_ms, config_pP->overload_config.queue_delay_low_ms);
+    OAILOG_INFO (LOG_CONFIG, "    eNBs .............: %u %%\n", config_pP->overload_config.enb_percent);
+    OAILOG_INFO (LOG_CONFIG, "    action ...........: %u\n", config_pP->overload_config.action);
+  }
+  OAILOG_INFO (LOG_CONFIG, "- Idle UE supervision\n");
+  OAILOG_INFO (LOG_CONFIG, "    implicit detach jitter .....: %u (sec)\n", config_pP->idle_supervision_config.implicit_detach_jitter_sec);
+  OAILOG_INFO (LOG_CONFIG, "    max implicit detach per sec : %u\n", config_pP->idle_supervision_config.max_implicit_detach_per_sec);
   OAILOG_INFO (LOG_CONFIG, "- IP:\n");
   OAILOG_INFO (LOG_CONFIG, "    s1-MME iface .....: %s\n", bdata(config_pP->ipv4.if_name_s1_mme));
   OAILOG_INFO (LOG_CONFIG, "    s1-MME ip ........: %s\n", inet_ntoa (*((struct in_addr *)&config_pP->ipv4.s1_mme)));
@@ -723,9 +914,14 @@ static void mme_config_display (mme_config_t * config_pP)
   OAILOG_INFO (LOG_CONFIG, "- ITTI:\n");
   OAILOG_INFO (LOG_CONFIG, "    queue size .......: %u (bytes)\n", config_pP->itti_config.queue_size);
   OAILOG_INFO (LOG_CONFIG, "    log file .........: %s\n", bdata(config_pP->itti_config.log_file));
+  OAILOG_INFO (LOG_CONFIG, "    MME_APP workers ..: %u\n", config_pP->num_app_workers);
+  OAILOG_INFO (LOG_CONFIG, "    S1AP codec workers: %u\n", config_pP->num_s1ap_codec_workers);
+  OAILOG_INFO (LOG_CONFIG, "    S11 workers ......: %u\n", config_pP->num_s11_workers);
+  itti_task_placements_config_display (LOG_CONFIG, &config_pP->itti_config.task_placements);
   OAILOG_INFO (LOG_CONFIG, "- SCTP:\n");
   OAILOG_INFO (LOG_CONFIG, "    in streams .......: %u\n", config_pP->sctp_config.in_streams);
   OAILOG_INFO (LOG_CONFIG, "    out streams ......: %u\n", config_pP->sctp_config.out_streams);
+  OAILOG_INFO (LOG_CONFIG, "    send queue size ..: %u\n", config_pP->sctp_config.send_queue_size);
   OAILOG_INFO (LOG_CONFIG, "- GUMMEIs (PLMN|MMEGI|MMEC):\n");
   for (j = 0; j < config_pP->gummei.nb; j++) {
     OAILOG_INFO (LOG_CONFIG, "            " PLMN_FMT "|%u|%u \n",
@@ -850,6 +1046,9 @@ mme_config_parse_opt_line (
   if (mme_config_parse_file (config_pP) != 0) {
     return -1;
   }
+  if (mme_config_served_publish (config_pP) != RETURNok) {
+    return -1;
+  }
 
   /*
    * Display the configuration
@@ -857,3 +1056,56 @@ mme_config_parse_opt_line (
   mme_config_display (config_pP);
   return 0;
 }
+
+//------------------------------------------------------------------------------
+int
+mme_config_reload_served_areas (
+  mme_config_t * config_pP)
+{
+  config_t                                cfg = {0};
+  config_setting_t                       *setting_mme = NULL;
+  config_setting_t                       *setting = NULL;
+  mme_config_t                           *staging = NULL;
+  int                                     rc = RETURNerror;
+
+  staging = calloc (1, sizeof (*staging));
+  if (!staging) {
+    return RETURNerror;
+  }
+  config_init (&cfg);
+
+  if (!config_read_file (&cfg, bdata(config_pP->config_file))) {
+    OAILOG_ERROR (LOG_CONFIG, "Reload of served areas failed: %s:%d - %s\n", bdata(config_pP->config_file), config_error_line (&cfg), config_error_text (&cfg));
+  } else if ((setting_mme = config_lookup (&cfg, MME_CONFIG_STRING_MME_CONFIG)) == NULL) {
+    OAILOG_ERROR (LOG_CONFIG, "Reload of served areas failed: no %s section\n", MME_CONFIG_STRING_MME_CONFIG);
+  } else if ((setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_TAI_LIST)) == NULL) {
+    OAILOG_ERROR (LOG_CONFIG, "Reload of served areas failed: no %s\n", MME_CONFIG_STRING_TAI_LIST);
+  } else if (mme_config_parse_tai_list (setting, staging) != RETURNok) {
+    OAILOG_ERROR (LOG_CONFIG, "Reload of served areas failed: bad %s\n", MME_CONFIG_STRING_TAI_LIST);
+  } else {
+    /*
+     * Only the TAI list is reloaded, the GUMMEI is in the GUTIs already
+     * allocated and stays as configured at startup.
+     */
+    mme_config_write_lock (config_pP);
+    staging->gummei = config_pP->gummei;
+    rc = mme_config_served_publish (staging);
+    if (RETURNok == rc) {
+      free_wrapper ((void**) &config_pP->served_tai.plmn_mcc);
+      free_wrapper ((void**) &config_pP->served_tai.plmn_mnc);
+      free_wrapper ((void**) &config_pP->served_tai.plmn_mnc_len);
+      free_wrapper ((void**) &config_pP->served_tai.tac);
+      config_pP->served_tai = staging->served_tai;
+      memset (&staging->served_tai, 0, sizeof (staging->served_tai));
+    }
+    mme_config_unlock (config_pP);
+  }
+
+  free_wrapper ((void**) &staging->served_tai.plmn_mcc);
+  free_wrapper ((void**) &staging->served_tai.plmn_mnc);
+  free_wrapper ((void**) &staging->served_tai.plmn_mnc_len);
+  free_wrapper ((void**) &staging->served_tai.tac);
+  free_wrapper ((void**) &staging);
+  config_destroy (&cfg);
+  return rc;
+}
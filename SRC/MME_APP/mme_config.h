@@ -32,6 +32,7 @@
 #define FILE_MME_CONFIG_SEEN
 #include <pthread.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "mme_default_values.h"
 #include "3gpp_23.003.h"
@@ -39,6 +40,8 @@
 #include "common_types.h"
 #include "log.h"
 #include "bstrlib.h"
+#include "intertask_interface_conf.h"
+#include "itti_task_placement_config.h"
 
 #define MME_CONFIG_STRING_MME_CONFIG                     "MME"
 #define MME_CONFIG_STRING_PID_DIRECTORY                  "PID_DIRECTORY"
@@ -49,6 +52,7 @@
 #define MME_CONFIG_STRING_MAXUE                          "MAXUE"
 #define MME_CONFIG_STRING_RELATIVE_CAPACITY              "RELATIVE_CAPACITY"
 #define MME_CONFIG_STRING_STATISTIC_TIMER                "MME_STATISTIC_TIMER"
+#define MME_CONFIG_STRING_METRICS_PORT                   "METRICS_PORT"
 
 #define MME_CONFIG_STRING_EMERGENCY_ATTACH_SUPPORTED     "EMERGENCY_ATTACH_SUPPORTED"
 #define MME_CONFIG_STRING_UNAUTHENTICATED_IMSI_SUPPORTED "UNAUTHENTICATED_IMSI_SUPPORTED"
@@ -61,6 +65,28 @@
 
 #define MME_CONFIG_STRING_INTERTASK_INTERFACE_CONFIG     "INTERTASK_INTERFACE"
 #define MME_CONFIG_STRING_INTERTASK_INTERFACE_QUEUE_SIZE "ITTI_QUEUE_SIZE"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_MME_APP_WORKERS "MME_APP_WORKERS"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_S1AP_CODEC_WORKERS "S1AP_CODEC_WORKERS"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_S11_WORKERS "S11_WORKERS"
+
+// Number of MME_APP/NAS worker task pairs, TASK_MME_APP, TASK_MME_APP_1, ... and TASK_NAS_MME, TASK_NAS_MME_1, ... must be contiguous
+#define MME_APP_WORKERS_MAX  8
+
+// mme_ue_s1ap_id, M-TMSI and MME S11 TEID of a UE are allocated so that its owning worker is id % number of workers.
+#define MME_APP_WORKER_INDEX(nUMwORKERS, iD) ((iD) % (nUMwORKERS))
+#define MME_APP_TASK_ID(iD)                  (TASK_MME_APP + MME_APP_WORKER_INDEX(mme_config.num_app_workers, (iD)))
+#define NAS_MME_TASK_ID(iD)                  (TASK_NAS_MME + MME_APP_WORKER_INDEX(mme_config.num_app_workers, (iD)))
+
+// Number of S1AP codec tasks TASK_S1AP_CODEC, TASK_S1AP_CODEC_1, ... (must be contiguous), 0: TASK_S1AP decodes/encodes itself
+#define S1AP_CODEC_WORKERS_MAX  4
+// All PDUs of a SCTP association go through the same codec task so that their order is preserved
+#define S1AP_CODEC_TASK_ID(aSSOCiD)          ((mme_config.num_s1ap_codec_workers) ? \
+                                              (TASK_S1AP_CODEC + ((aSSOCiD) % mme_config.num_s1ap_codec_workers)) : TASK_S1AP)
+
+// Number of S11 tasks TASK_S11, TASK_S11_1, ... (must be contiguous), each one with its own GTPv2-C stack instance
+#define S11_WORKERS_MAX  8
+// The GTPv2-C tunnel and transactions of a UE are in the stack instance of the task owning its MME S11 TEID
+#define S11_TASK_ID(tEID)                    (TASK_S11 + ((tEID) % mme_config.num_s11_workers))
 
 #define MME_CONFIG_STRING_S6A_CONFIG                     "S6A"
 #define MME_CONFIG_STRING_S6A_CONF_FILE_PATH             "S6A_CONF"
@@ -69,11 +95,32 @@
 #define MME_CONFIG_STRING_SCTP_CONFIG                    "SCTP"
 #define MME_CONFIG_STRING_SCTP_INSTREAMS                 "SCTP_INSTREAMS"
 #define MME_CONFIG_STRING_SCTP_OUTSTREAMS                "SCTP_OUTSTREAMS"
+#define MME_CONFIG_STRING_SCTP_SEND_QUEUE_SIZE           "SCTP_SEND_QUEUE_SIZE"
 
 
 #define MME_CONFIG_STRING_S1AP_CONFIG                    "S1AP"
 #define MME_CONFIG_STRING_S1AP_OUTCOME_TIMER             "S1AP_OUTCOME_TIMER"
 #define MME_CONFIG_STRING_S1AP_PORT                      "S1AP_PORT"
+#define MME_CONFIG_STRING_S1AP_PAGING_TIMER_MS           "PAGING_TIMER_MS"
+#define MME_CONFIG_STRING_S1AP_PAGING_MAX_ATTEMPTS       "PAGING_MAX_ATTEMPTS"
+#define MME_CONFIG_STRING_S1AP_MAX_PAGING_PER_ENB_PER_SEC "MAX_PAGING_PER_ENB_PER_SEC"
+
+#define MME_CONFIG_STRING_OVERLOAD_CONFIG                "OVERLOAD_CONTROL"
+#define MME_CONFIG_STRING_OVERLOAD_ENABLED               "OVERLOAD_CONTROL_ENABLED"
+#define MME_CONFIG_STRING_OVERLOAD_CHECK_PERIOD_MS       "CHECK_PERIOD_MS"
+#define MME_CONFIG_STRING_OVERLOAD_QUEUE_DEPTH_HIGH      "QUEUE_DEPTH_HIGH"
+#define MME_CONFIG_STRING_OVERLOAD_QUEUE_DEPTH_LOW       "QUEUE_DEPTH_LOW"
+#define MME_CONFIG_STRING_OVERLOAD_QUEUE_DELAY_HIGH_MS   "QUEUE_DELAY_HIGH_MS"
+#define MME_CONFIG_STRING_OVERLOAD_QUEUE_DELAY_LOW_MS    "QUEUE_DELAY_LOW_MS"
+#define MME_CONFIG_STRING_OVERLOAD_ENB_PERCENT           "ENB_PERCENT"
+#define MME_CONFIG_STRING_OVERLOAD_ACTION                "OVERLOAD_ACTION"
+#define MME_CONFIG_STRING_OVERLOAD_ACTION_REJECT_NON_EMERGENCY_MO_DT     "REJECT_NON_EMERGENCY_MO_DT"
+#define MME_CONFIG_STRING_OVERLOAD_ACTION_REJECT_ALL_RRC_CR_SIGNALLING   "REJECT_ALL_RRC_CR_SIGNALLING"
+#define MME_CONFIG_STRING_OVERLOAD_ACTION_PERMIT_EMERGENCY_SESSIONS_ONLY "PERMIT_EMERGENCY_SESSIONS_ONLY"
+
+#define MME_CONFIG_STRING_IDLE_SUPERVISION_CONFIG        "IDLE_SUPERVISION"
+#define MME_CONFIG_STRING_IMPLICIT_DETACH_JITTER_SEC     "IMPLICIT_DETACH_JITTER_SEC"
+#define MME_CONFIG_STRING_MAX_IMPLICIT_DETACH_PER_SEC    "MAX_IMPLICIT_DETACH_PER_SEC"
 
 #define MME_CONFIG_STRING_GUMMEI_LIST                    "GUMMEI_LIST"
 #define MME_CONFIG_STRING_MME_CODE                       "MME_CODE"
@@ -101,6 +148,9 @@
 #define MME_CONFIG_STRING_NAS_T3486_TIMER                "T3486"
 #define MME_CONFIG_STRING_NAS_T3489_TIMER                "T3489"
 #define MME_CONFIG_STRING_NAS_T3495_TIMER                "T3495"
+#define MME_CONFIG_STRING_NAS_TRACE                      "NAS_TRACE"
+#define MME_CONFIG_STRING_NAS_TRACE_MESSAGE_TYPES        "NAS_TRACE_MESSAGE_TYPES"
+#define NAS_TRACE_MESSAGE_TYPES_MAX                      32
 
 #define MME_CONFIG_STRING_ASN1_VERBOSITY                 "ASN1_VERBOSITY"
 #define MME_CONFIG_STRING_ASN1_VERBOSITY_NONE            "none"
@@ -129,9 +179,14 @@ typedef struct mme_config_s {
   uint8_t relative_capacity;
 
   uint32_t mme_statistic_timer;
+  uint16_t metrics_port;        ///< metrics served on 127.0.0.1:metrics_port, 0: no metrics endpoint
 
   uint8_t unauthenticated_imsi_supported;
 
+  uint8_t num_app_workers;
+  uint8_t num_s1ap_codec_workers;
+  uint8_t num_s11_workers;
+
   struct {
     uint8_t ims_voice_over_ps_session_in_s1;
     uint8_t emergency_bearer_services_in_s1_mode;
@@ -159,13 +214,33 @@ typedef struct mme_config_s {
   struct {
     uint16_t in_streams;
     uint16_t out_streams;
+    uint32_t send_queue_size;  // S1AP PDUs waiting for the send window of an eNB association
   } sctp_config;
 
   struct {
     uint16_t port_number;
     uint8_t  outcome_drop_timer_sec;
+    uint32_t paging_timer_ms;            // paging retransmission timer (T3413)
+    uint8_t  paging_max_attempts;        // first attempt in the last visited TAI, the next ones in the whole TAI list
+    uint32_t max_paging_per_enb_per_sec; // 0: no limit
   } s1ap_config;
 
+  struct {
+    bool     enabled;
+    uint32_t check_period_ms;
+    uint32_t queue_depth_high;
+    uint32_t queue_depth_low;
+    uint32_t queue_delay_high_ms;
+    uint32_t queue_delay_low_ms;
+    uint8_t  enb_percent;
+    uint8_t  action;             // s1ap_overload_action_t
+  } overload_config;
+
+  struct {
+    uint32_t implicit_detach_jitter_sec;
+    uint32_t max_implicit_detach_per_sec; // 0: no pacing
+  } idle_supervision_config;
+
   struct {
     bstring    if_name_s1_mme;
     ipv4_nbo_t s1_mme;
@@ -186,6 +261,7 @@ typedef struct mme_config_s {
   struct {
     uint32_t  queue_size;
     bstring   log_file;
+    itti_task_placements_config_t task_placements;
   } itti_config;
 
   struct {
@@ -197,6 +273,9 @@ typedef struct mme_config_s {
     uint32_t t3486_sec;
     uint32_t t3489_sec;
     uint32_t t3495_sec;
+    bool     trace_enabled;
+    uint8_t  trace_message_types[NAS_TRACE_MESSAGE_TYPES_MAX];
+    uint8_t  num_trace_message_types;   // 0: all message types are traced
   } nas_config;
 
   log_config_t log_config;
@@ -211,9 +290,48 @@ int mme_config_find_mnc_length(const char mcc_digit1P,
                                const char mnc_digit2P,
                                const char mnc_digit3P);
 int mme_config_parse_opt_line(int argc, char *argv[], mme_config_t *mme_config);
+int mme_config_reload_served_areas(mme_config_t *mme_config);
 
 #define mme_config_read_lock(mMEcONFIG)  pthread_rwlock_rdlock(&(mMEcONFIG)->rw_lock)
 #define mme_config_write_lock(mMEcONFIG) pthread_rwlock_wrlock(&(mMEcONFIG)->rw_lock)
 #define mme_config_unlock(mMEcONFIG)     pthread_rwlock_unlock(&(mMEcONFIG)->rw_lock)
 
+/* Served areas (TAIs, PLMNs, GUMMEIs) of the configuration, published as an
+ * immutable snapshot with precompiled lookup indexes. Readers acquire the
+ * current snapshot without taking the configuration lock and release it when
+ * done, a reload publishes a new snapshot and the old one is freed once its
+ * last reader released it.
+ */
+#define MME_CONFIG_SERVED_INDEX_SIZE     64 // power of 2, at least twice TAI_LIST_MAX_SIZE
+
+typedef struct mme_config_served_s {
+  uint32_t    ref_count;
+  uint32_t    generation;
+  struct mme_config_served_s *retired_next;
+
+  tai_list_t  tai_list;                                    // sorted as in the configuration
+  uint8_t     nb_plmn;
+  struct {
+    uint16_t  mcc;
+    uint16_t  mnc;
+    uint16_t  mnc_len;
+  }           plmn[TAI_LIST_MAX_SIZE];                     // distinct PLMNs of tai_list, same order
+  uint8_t     nb_gummei;
+  gummei_t    gummei[MAX_GUMMEI];
+
+  uint32_t    tac_bitmap[(UINT16_MAX + 1) / 32];           // TACs of tai_list, any PLMN
+  uint64_t    plmn_index[MME_CONFIG_SERVED_INDEX_SIZE];    // open addressing, 0 is a free slot
+  uint64_t    tai_index[MME_CONFIG_SERVED_INDEX_SIZE];
+  uint64_t    gummei_index[MME_CONFIG_SERVED_INDEX_SIZE];  // PLMN + MME code -> gummei[]
+} mme_config_served_t;
+
+int  mme_config_served_publish(const mme_config_t *mme_config);
+mme_config_served_t *mme_config_served_acquire(void);
+void mme_config_served_release(mme_config_served_t *served);
+
+bool mme_config_served_has_tac(const mme_config_served_t *served, const tac_t tac);
+bool mme_config_served_has_plmn(const mme_config_served_t *served, const uint16_t mcc, const uint16_t mnc, const uint16_t mnc_len);
+bool mme_config_served_has_tai(const mme_config_served_t *served, const uint16_t mcc, const uint16_t mnc, const uint16_t mnc_len, const tac_t tac);
+const gummei_t *mme_config_served_find_gummei(const mme_config_served_t *served, const plmn_t *plmn, const mme_code_t mme_code);
+
 #endif /* FILE_MME_CONFIG_SEEN */
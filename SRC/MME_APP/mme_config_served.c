@@ -0,0 +1,280 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_config_served.c
+  \brief Immutable snapshots of the served TAIs, PLMNs and GUMMEIs with their lookup indexes
+
+  The S1AP, MME_APP, NAS and S6A tasks check TAIs, PLMNs and GUMMEIs on every
+  S1 setup and on many UE procedures. They read an immutable snapshot built
+  from the configuration instead of scanning mme_config under its lock: a TAC
+  bitmap and small open addressing hash sets of PLMNs, TAIs and GUMMEIs.
+
+  A snapshot is published with an atomic pointer swap. Readers take a
+  reference on the current snapshot, a publisher waits for the readers that
+  may have loaded the old pointer without having referenced it yet, then frees
+  the retired snapshots nobody references any more.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "assertions.h"
+#include "dynamic_memory_check.h"
+#include "log.h"
+#include "common_defs.h"
+#include "mme_config.h"
+
+#define MME_CONFIG_SERVED_INDEX_MASK  (MME_CONFIG_SERVED_INDEX_SIZE - 1)
+
+static mme_config_served_t             *served_current = NULL;
+static mme_config_served_t             *served_retired = NULL;  // publisher only
+static uint32_t                         served_readers = 0;     // readers between loading served_current and referencing it
+static uint32_t                         served_generation = 0;
+static pthread_mutex_t                  served_publish_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//------------------------------------------------------------------------------
+static inline uint64_t mme_config_served_plmn_key (const uint16_t mcc, const uint16_t mnc, const uint16_t mnc_len)
+{
+  return ((uint64_t)mcc << 12) | ((uint64_t)(mnc_len & 0x3) << 10) | (mnc & 0x3FF);
+}
+
+//------------------------------------------------------------------------------
+static uint64_t mme_config_served_plmn_t_key (const plmn_t * const plmn)
+{
+  uint16_t                                mcc = 100 * plmn->mcc_digit1 + 10 * plmn->mcc_digit2 + plmn->mcc_digit3;
+
+  if (0x0F == plmn->mnc_digit3) {
+    return mme_config_served_plmn_key (mcc, 10 * plmn->mnc_digit1 + plmn->mnc_digit2, 2);
+  }
+  return mme_config_served_plmn_key (mcc, 100 * plmn->mnc_digit1 + 10 * plmn->mnc_digit2 + plmn->mnc_digit3, 3);
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t mme_config_served_hash (const uint64_t key)
+{
+  return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & MME_CONFIG_SERVED_INDEX_MASK;
+}
+
+//------------------------------------------------------------------------------
+static int mme_config_served_index_insert (uint64_t * const index, const uint64_t key, const uint8_t value)
+{
+  const uint64_t                          entry = ((key + 1) << 8) | value;
+  uint32_t                                slot = mme_config_served_hash (key);
+  int                                     i = 0;
+
+  for (i = 0; i < MME_CONFIG_SERVED_INDEX_SIZE; i++) {
+    if ((0 == index[slot]) || ((index[slot] >> 8) == (key + 1))) {
+      index[slot] = entry;
+      return RETURNok;
+    }
+    slot = (slot + 1) & MME_CONFIG_SERVED_INDEX_MASK;
+  }
+  return RETURNerror;
+}
+
+//------------------------------------------------------------------------------
+static bool mme_config_served_index_find (const uint64_t * const index, const uint64_t key, uint8_t * const value)
+{
+  uint32_t                                slot = mme_config_served_hash (key);
+  int                                     i = 0;
+
+  for (i = 0; i < MME_CONFIG_SERVED_INDEX_SIZE; i++) {
+    if (0 == index[slot]) {
+      return false;
+    }
+    if ((index[slot] >> 8) == (key + 1)) {
+      if (value) {
+        *value = (uint8_t)(index[slot] & 0xFF);
+      }
+      return true;
+    }
+    slot = (slot + 1) & MME_CONFIG_SERVED_INDEX_MASK;
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+static void mme_config_served_plmn_from_mcc_mnc (const uint16_t mcc, const uint16_t mnc, const uint16_t mnc_len, plmn_t * const plmn)
+{
+  plmn->mcc_digit1 = (mcc / 100) % 10;
+  plmn->mcc_digit2 = (mcc / 10) % 10;
+  plmn->mcc_digit3 = mcc % 10;
+  if (2 == mnc_len) {
+    plmn->mnc_digit1 = (mnc / 10) % 10;
+    plmn->mnc_digit2 = mnc % 10;
+    plmn->mnc_digit3 = 0x0F;
+  } else {
+    plmn->mnc_digit1 = (mnc / 100) % 10;
+    plmn->mnc_digit2 = (mnc / 10) % 10;
+    plmn->mnc_digit3 = mnc % 10;
+  }
+}
+
+//------------------------------------------------------------------------------
+static int mme_config_served_build (const mme_config_t * const config_pP, mme_config_served_t * const served)
+{
+  int                                     i = 0;
+  uint64_t                                plmn_key = 0;
+
+  if ((config_pP->served_tai.nb_tai > TAI_LIST_MAX_SIZE) || (config_pP->gummei.nb > MAX_GUMMEI)) {
+    OAILOG_ERROR (LOG_CONFIG, "Too many served TAIs (%u) or GUMMEIs (%d)\n", config_pP->served_tai.nb_tai, config_pP->gummei.nb);
+    return RETURNerror;
+  }
+
+  served->tai_list.list_type = config_pP->served_tai.list_type;
+  for (i = 0; i < config_pP->served_tai.nb_tai; i++) {
+    tai_t                                  *tai = &served->tai_list.tai[served->tai_list.n_tais];
+
+    mme_config_served_plmn_from_mcc_mnc (config_pP->served_tai.plmn_mcc[i], config_pP->served_tai.plmn_mnc[i],
+                                         config_pP->served_tai.plmn_mnc_len[i], &tai->plmn);
+    tai->tac = config_pP->served_tai.tac[i];
+    served->tai_list.n_tais += 1;
+
+    plmn_key = mme_config_served_plmn_key (config_pP->served_tai.plmn_mcc[i], config_pP->served_tai.plmn_mnc[i],
+                                           config_pP->served_tai.plmn_mnc_len[i]);
+    if (!mme_config_served_index_find (served->plmn_index, plmn_key, NULL)) {
+      served->plmn[served->nb_plmn].mcc = config_pP->served_tai.plmn_mcc[i];
+      served->plmn[served->nb_plmn].mnc = config_pP->served_tai.plmn_mnc[i];
+      served->plmn[served->nb_plmn].mnc_len = config_pP->served_tai.plmn_mnc_len[i];
+      if (RETURNok != mme_config_served_index_insert (served->plmn_index, plmn_key, served->nb_plmn)) {
+        return RETURNerror;
+      }
+      served->nb_plmn += 1;
+    }
+    if (RETURNok != mme_config_served_index_insert (served->tai_index, (plmn_key << 16) | tai->tac, i)) {
+      return RETURNerror;
+    }
+    served->tac_bitmap[tai->tac >> 5] |= (uint32_t)1 << (tai->tac & 0x1F);
+  }
+
+  for (i = 0; i < config_pP->gummei.nb; i++) {
+    served->gummei[i] = config_pP->gummei.gummei[i];
+    plmn_key = mme_config_served_plmn_t_key (&served->gummei[i].plmn);
+    if (RETURNok != mme_config_served_index_insert (served->gummei_index, (plmn_key << 8) | served->gummei[i].mme_code, i)) {
+      return RETURNerror;
+    }
+    served->nb_gummei += 1;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int mme_config_served_publish (const mme_config_t * const config_pP)
+{
+  mme_config_served_t                    *served = NULL;
+  mme_config_served_t                    *old = NULL;
+  mme_config_served_t                   **retired = NULL;
+
+  served = calloc (1, sizeof (*served));
+  if (!served) {
+    OAILOG_ERROR (LOG_CONFIG, "Failed to allocate served areas snapshot\n");
+    return RETURNerror;
+  }
+  if (RETURNok != mme_config_served_build (config_pP, served)) {
+    free_wrapper ((void**) &served);
+    return RETURNerror;
+  }
+
+  pthread_mutex_lock (&served_publish_mutex);
+  served->generation = ++served_generation;
+  old = __atomic_exchange_n (&served_current, served, __ATOMIC_SEQ_CST);
+  if (old) {
+    old->retired_next = served_retired;
+    served_retired = old;
+  }
+  /*
+   * Grace period: a reader that loaded the old pointer has referenced it
+   * before leaving, new readers only see the new snapshot.
+   */
+  while (__atomic_load_n (&served_readers, __ATOMIC_SEQ_CST)) {
+    sched_yield ();
+  }
+  retired = &served_retired;
+  while (*retired) {
+    if (0 == __atomic_load_n (&(*retired)->ref_count, __ATOMIC_ACQUIRE)) {
+      old = *retired;
+      *retired = old->retired_next;
+      free_wrapper ((void**) &old);
+    } else {
+      retired = &(*retired)->retired_next;
+    }
+  }
+  pthread_mutex_unlock (&served_publish_mutex);
+
+  OAILOG_INFO (LOG_CONFIG, "Served areas generation %u: %u TAIs, %u PLMNs, %u GUMMEIs\n",
+               served->generation, served->tai_list.n_tais, served->nb_plmn, served->nb_gummei);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+mme_config_served_t *mme_config_served_acquire (void)
+{
+  mme_config_served_t                    *served = NULL;
+
+  __atomic_add_fetch (&served_readers, 1, __ATOMIC_SEQ_CST);
+  served = __atomic_load_n (&served_current, __ATOMIC_SEQ_CST);
+  __atomic_add_fetch (&served->ref_count, 1, __ATOMIC_RELAXED);
+  __atomic_sub_fetch (&served_readers, 1, __ATOMIC_RELEASE);
+  return served;
+}
+
+//------------------------------------------------------------------------------
+void mme_config_served_release (mme_config_served_t * const served)
+{
+  __atomic_sub_fetch (&served->ref_count, 1, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+bool mme_config_served_has_tac (const mme_config_served_t * const served, const tac_t tac)
+{
+  return (served->tac_bitmap[tac >> 5] >> (tac & 0x1F)) & 1;
+}
+
+//------------------------------------------------------------------------------
+bool mme_config_served_has_plmn (const mme_config_served_t * const served, const uint16_t mcc, const uint16_t mnc, const uint16_t mnc_len)
+{
+  return mme_config_served_index_find (served->plmn_index, mme_config_served_plmn_key (mcc, mnc, mnc_len), NULL);
+}
+
+//------------------------------------------------------------------------------
+bool mme_config_served_has_tai (const mme_config_served_t * const served, const uint16_t mcc, const uint16_t mnc, const uint16_t mnc_len, const tac_t tac)
+{
+  if (!mme_config_served_has_tac (served, tac)) {
+    return false;
+  }
+  return mme_config_served_index_find (served->tai_index, (mme_config_served_plmn_key (mcc, mnc, mnc_len) << 16) | tac, NULL);
+}
+
+//------------------------------------------------------------------------------
+const gummei_t *mme_config_served_find_gummei (const mme_config_served_t * const served, const plmn_t * const plmn, const mme_code_t mme_code)
+{
+  uint8_t                                 i = 0;
+
+  if (mme_config_served_index_find (served->gummei_index, (mme_config_served_plmn_t_key (plmn) << 8) | mme_code, &i)) {
+    return &served->gummei[i];
+  }
+  return NULL;
+}
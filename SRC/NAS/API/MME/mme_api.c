@@ -48,6 +48,9 @@
 #include "mme_app_defs.h"
 #include "mme_config.h"
 #include <string.h>             // memcpy
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
 
 /****************************************************************************/
 /****************  E X T E R N A L    D E F I N I T I O N S  ****************/
@@ -76,7 +79,8 @@ static mme_api_ip_version_t             _mme_api_ip_capability = MME_API_IPV4V6_
 /* Total number of PDN connections (should not exceed MME_API_PDN_MAX) */
 static int                              _mme_api_pdn_id = 0;
 
-static tmsi_t                           mme_m_tmsi_generator = 0x00000001;
+/* One M-TMSI sequence per MME_APP worker, see mme_api_new_guti() */
+static tmsi_t                           mme_m_tmsi_generator[MME_APP_WORKERS_MAX] = {0};
 
 /****************************************************************************/
 /******************  E X P O R T E D    F U N C T I O N S  ******************/
@@ -159,6 +163,25 @@ mme_api_get_emm_config (
     config->prefered_integrity_algorithm[i] = mme_config_p->nas_config.prefered_integrity_algorithm[i];
     config->prefered_ciphering_algorithm[i] = mme_config_p->nas_config.prefered_ciphering_algorithm[i];
   }
+
+  /*
+   * M-TMSI sequences start at 1 in test mode, elsewhere at a random point so that
+   * the M-TMSIs of a restarted MME do not replay the previous ones
+   */
+  if (RUN_MODE_TEST == mme_config_p->run_mode) {
+    for (i = 0; i < MME_APP_WORKERS_MAX; i++) {
+      mme_m_tmsi_generator[i] = 0x00000001;
+    }
+  } else {
+    struct timespec                         ts = {0};
+    unsigned int                            seed = 0;
+
+    clock_gettime (CLOCK_REALTIME, &ts);
+    seed = (unsigned int)(ts.tv_sec ^ ts.tv_nsec ^ getpid ());
+    for (i = 0; i < MME_APP_WORKERS_MAX; i++) {
+      mme_m_tmsi_generator[i] = ((tmsi_t)rand_r (&seed) << 16) ^ (tmsi_t)rand_r (&seed);
+    }
+  }
   OAILOG_FUNC_RETURN (LOG_NAS, RETURNok);
 }
 
@@ -353,14 +376,16 @@ mme_api_new_guti (
     guti->gummei.plmn.mnc_digit1 = _emm_data.conf.gummei.plmn.mnc_digit1;
     guti->gummei.plmn.mnc_digit2 = _emm_data.conf.gummei.plmn.mnc_digit2;
     guti->gummei.plmn.mnc_digit3 = _emm_data.conf.gummei.plmn.mnc_digit3;
-    if (RUN_MODE_TEST == mme_config.run_mode) {
-      guti->m_tmsi = __sync_fetch_and_add (&mme_m_tmsi_generator, 0x00000001);
-    } else {
-      guti->m_tmsi                 = (tmsi_t)(uintptr_t)ue_context;
-    }
-    if (guti->m_tmsi == INVALID_M_TMSI) {
-      OAILOG_FUNC_RETURN (LOG_NAS, RETURNerror);
-    }
+    /*
+     * The M-TMSI is aligned on the MME_APP worker owning the UE (M-TMSI % number of workers), so that
+     * S1AP dispatches a later Initial UE Message carrying this S-TMSI to the same worker.
+     * The sequence wraps before the multiplication would, M-TMSIs still held by a UE are skipped.
+     */
+    const int    worker_index = MME_APP_WORKER_INDEX(mme_config.num_app_workers, ue_context->mme_ue_s1ap_id);
+    const tmsi_t nb_m_tmsis = INVALID_M_TMSI / mme_config.num_app_workers;
+    do {
+      guti->m_tmsi = (__sync_fetch_and_add (&mme_m_tmsi_generator[worker_index], 0x00000001) % nb_m_tmsis) * mme_config.num_app_workers + worker_index;
+    } while ((INVALID_M_TMSI == guti->m_tmsi) || (mme_ue_context_exists_guti (&mme_app_desc.mme_ue_contexts, guti)));
     mme_api_notify_new_guti(ue_context->mme_ue_s1ap_id, guti);
   } else {
     OAILOG_FUNC_RETURN (LOG_NAS, RETURNerror);
@@ -369,22 +394,25 @@ mme_api_new_guti (
   int            i,j;
   tac_t   tac  = INVALID_TAC_FFFE;
   bool    consecutive_tacs = true;
+  mme_config_served_t *served = NULL;
+
+  served = mme_config_served_acquire ();
   j = 0;
-  for (i=0; i < _emm_data.conf.tai_list.n_tais; i++) {
-    if ((_emm_data.conf.tai_list.tai[i].plmn.mcc_digit1 == guti->gummei.plmn.mcc_digit1) &&
-        (_emm_data.conf.tai_list.tai[i].plmn.mcc_digit2 == guti->gummei.plmn.mcc_digit2) &&
-        (_emm_data.conf.tai_list.tai[i].plmn.mcc_digit3 == guti->gummei.plmn.mcc_digit3) &&
-        (_emm_data.conf.tai_list.tai[i].plmn.mnc_digit1 == guti->gummei.plmn.mnc_digit1) &&
-        (_emm_data.conf.tai_list.tai[i].plmn.mnc_digit2 == guti->gummei.plmn.mnc_digit2) &&
-        (_emm_data.conf.tai_list.tai[i].plmn.mnc_digit3 == guti->gummei.plmn.mnc_digit3) ) {
+  for (i=0; i < served->tai_list.n_tais; i++) {
+    if ((served->tai_list.tai[i].plmn.mcc_digit1 == guti->gummei.plmn.mcc_digit1) &&
+        (served->tai_list.tai[i].plmn.mcc_digit2 == guti->gummei.plmn.mcc_digit2) &&
+        (served->tai_list.tai[i].plmn.mcc_digit3 == guti->gummei.plmn.mcc_digit3) &&
+        (served->tai_list.tai[i].plmn.mnc_digit1 == guti->gummei.plmn.mnc_digit1) &&
+        (served->tai_list.tai[i].plmn.mnc_digit2 == guti->gummei.plmn.mnc_digit2) &&
+        (served->tai_list.tai[i].plmn.mnc_digit3 == guti->gummei.plmn.mnc_digit3) ) {
 
       tai_list->tai[j].plmn = guti->gummei.plmn;
-      // _emm_data.conf.tai_list is sorted
-      tai_list->tai[j].tac            = _emm_data.conf.tai_list.tai[i].tac;
+      // served->tai_list is sorted
+      tai_list->tai[j].tac            = served->tai_list.tai[i].tac;
       if (INVALID_TAC_FFFE == tac)  {
-        tac = _emm_data.conf.tai_list.tai[i].tac;
+        tac = served->tai_list.tai[i].tac;
       } else {
-        if ((tac+1) == _emm_data.conf.tai_list.tai[i].tac) {
+        if ((tac+1) == served->tai_list.tai[i].tac) {
           tac = tac + 1;
         } else {
           consecutive_tacs = false;
@@ -395,6 +423,7 @@ mme_api_new_guti (
     }
   }
   tai_list->n_tais = j;
+  mme_config_served_release (served);
 
   if (consecutive_tacs) {
     tai_list->list_type = TRACKING_AREA_IDENTITY_LIST_ONE_PLMN_CONSECUTIVE_TACS;
@@ -471,6 +500,6 @@ mme_api_unsubscribe ( bstring apn)
   /*
    * Decrement the total number of PDN connections
    */
-  _mme_api_pdn_id -= 1;
+  __sync_fetch_and_sub (&_mme_api_pdn_id, 1);
   OAILOG_FUNC_RETURN (LOG_NAS, rc);
 }
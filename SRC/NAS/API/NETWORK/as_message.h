@@ -266,8 +266,13 @@ typedef enum paging_cause_s {
  * to be sent.
  */
 typedef struct paging_req_s {
+  mme_ue_s1ap_id_t ue_id;  /* UE lower layer identifier        */
   as_stmsi_t s_tmsi;  /* UE identity                  */
+  bool       is_imsi_paging; /* Page with the IMSI instead of the S-TMSI */
+  imsi64_t   imsi64;     /* IMSI, gives the UE identity index value */
   uint8_t    cn_domain;  /* Core network domain              */
+  tai_t      last_visited_tai; /* Paged first, if valid        */
+  tai_list_t tai_list;   /* TAIs the UE is registered to     */
 } paging_req_t;
 
 /*
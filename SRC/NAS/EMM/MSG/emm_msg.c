@@ -43,7 +43,7 @@
 #include "TLVDecoder.h"
 #include "TLVEncoder.h"
 #include "log.h"
-#include "nas_itti_messaging.h"
+#include "nas_trace.h"
 
 /****************************************************************************/
 /****************  E X T E R N A L    D E F I N I T I O N S  ****************/
@@ -239,7 +239,7 @@ emm_msg_decode (
     /*
      * Message has been decoded and security header removed, handle it has a plain message
      */
-    nas_itti_plain_msg ((char *)buffer_log, (nas_message_t *) msg, len_log, is_down_link);
+    NAS_TRACE (msg->header.protocol_discriminator, msg->header.message_type, is_down_link, buffer_log, len_log);
   }
 
   OAILOG_FUNC_RETURN (LOG_NAS_EMM, header_result + decode_result);
@@ -414,7 +414,7 @@ emm_msg_encode (
   if (encode_result < 0) {
     OAILOG_ERROR (LOG_NAS_EMM, "EMM-MSG   - Failed to encode L3 EMM message 0x%x " "(%d)\n", msg->header.message_type, encode_result);
   } else {
-    nas_itti_plain_msg ((char *)buffer_log, (nas_message_t *) msg, header_result + encode_result, is_down_link);
+    NAS_TRACE (msg->header.protocol_discriminator, msg->header.message_type, is_down_link, buffer_log, header_result + encode_result);
   }
 
   OAILOG_FUNC_RETURN (LOG_NAS_EMM, header_result + encode_result);
@@ -58,6 +58,7 @@
 #include "nas_itti_messaging.h"
 #include "emm_proc.h"
 #include "nas_proc.h"
+#include "metrics.h"
 
 /****************************************************************************/
 /****************  E X T E R N A L    D E F I N I T I O N S  ****************/
@@ -91,6 +92,38 @@ static const char                      *_emm_as_primitive_str[] = {
   "EMMAS_STATUS_IND",
 };
 
+/*
+   Metrics of the EMM messages received, per message type and result
+*/
+#define EMM_AS_METRIC_NO_MESSAGE   (-1)    /* not an EMM message */
+#define EMM_AS_METRIC_UNDECODED    (-2)    /* EMM message that failed to decode */
+
+static const struct {
+  uint8_t                                 message_type;
+  const char                             *name;
+} _emm_as_metric_messages[] = {
+  {ATTACH_REQUEST,                "AttachRequest"},
+  {ATTACH_COMPLETE,               "AttachComplete"},
+  {DETACH_REQUEST,                "DetachRequest"},
+  {DETACH_ACCEPT,                 "DetachAccept"},
+  {TRACKING_AREA_UPDATE_REQUEST,  "TrackingAreaUpdateRequest"},
+  {TRACKING_AREA_UPDATE_COMPLETE, "TrackingAreaUpdateComplete"},
+  {SERVICE_REQUEST,               "ServiceRequest"},
+  {EXTENDED_SERVICE_REQUEST,      "ExtendedServiceRequest"},
+  {GUTI_REALLOCATION_COMPLETE,    "GutiReallocationComplete"},
+  {AUTHENTICATION_RESPONSE,       "AuthenticationResponse"},
+  {AUTHENTICATION_FAILURE,        "AuthenticationFailure"},
+  {IDENTITY_RESPONSE,             "IdentityResponse"},
+  {SECURITY_MODE_COMPLETE,        "SecurityModeComplete"},
+  {SECURITY_MODE_REJECT,          "SecurityModeReject"},
+  {EMM_STATUS,                    "EmmStatus"},
+  {UPLINK_NAS_TRANSPORT,          "UplinkNasTransport"},
+};
+
+/* [message type][ok, error], the types not listed above share the "other" series */
+static metric_id_t                      _emm_as_metrics[256][2];
+static metric_id_t                      _emm_as_metric_undecoded = 0;
+
 /*
    Functions executed to process EMM procedures upon receiving
    data from the network
@@ -102,11 +135,12 @@ static int _emm_as_recv (
     bstring msg,
     size_t len,
     int *emm_cause,
-    nas_message_decode_status_t   * decode_status);
+    nas_message_decode_status_t   * decode_status,
+    int *message_type);
 
 
-static int _emm_as_establish_req (const emm_as_establish_t * msg, int *emm_cause);
-static int _emm_as_data_ind (const emm_as_data_t * msg, int *emm_cause);
+static int _emm_as_establish_req (const emm_as_establish_t * msg, int *emm_cause, int *message_type);
+static int _emm_as_data_ind (const emm_as_data_t * msg, int *emm_cause, int *message_type);
 
 /*
    Functions executed to send data to the network when requested
@@ -150,9 +184,23 @@ static int _emm_as_release_req (const emm_as_release_t *, nas_release_req_t *);
 void emm_as_initialize (void)
 {
   OAILOG_FUNC_IN (LOG_NAS_EMM);
-  /*
-   * TODO: Initialize the EMMAS-SAP
-   */
+  const metric_id_t                       other_ok = metrics_register ("mme_nas_emm_messages_received_total", METRIC_COUNTER,
+      "EMM messages received from the UEs", "message=\"other\",result=\"ok\"");
+  const metric_id_t                       other_error = metrics_register ("mme_nas_emm_messages_received_total", METRIC_COUNTER,
+      "EMM messages received from the UEs", "message=\"other\",result=\"error\"");
+
+  for (int i = 0; i < 256; i++) {
+    _emm_as_metrics[i][0] = other_ok;
+    _emm_as_metrics[i][1] = other_error;
+  }
+  for (int i = 0; i < sizeof (_emm_as_metric_messages) / sizeof (_emm_as_metric_messages[0]); i++) {
+    _emm_as_metrics[_emm_as_metric_messages[i].message_type][0] = metrics_register ("mme_nas_emm_messages_received_total", METRIC_COUNTER,
+        "EMM messages received from the UEs", "message=\"%s\",result=\"ok\"", _emm_as_metric_messages[i].name);
+    _emm_as_metrics[_emm_as_metric_messages[i].message_type][1] = metrics_register ("mme_nas_emm_messages_received_total", METRIC_COUNTER,
+        "EMM messages received from the UEs", "message=\"%s\",result=\"error\"", _emm_as_metric_messages[i].name);
+  }
+  _emm_as_metric_undecoded = metrics_register ("mme_nas_emm_messages_received_total", METRIC_COUNTER,
+      "EMM messages received from the UEs", "message=\"undecoded\",result=\"error\"");
   OAILOG_FUNC_OUT (LOG_NAS_EMM);
 }
 
@@ -175,6 +223,7 @@ int emm_as_send (const emm_as_t * msg)
   OAILOG_FUNC_IN (LOG_NAS_EMM);
   int                                     rc = RETURNok;
   int                                     emm_cause = EMM_CAUSE_SUCCESS;
+  int                                     message_type = EMM_AS_METRIC_NO_MESSAGE;
   emm_as_primitive_t                      primitive = msg->primitive;
   uint32_t                                ue_id = 0;
 
@@ -182,12 +231,12 @@ int emm_as_send (const emm_as_t * msg)
 
   switch (primitive) {
   case _EMMAS_DATA_IND:
-    rc = _emm_as_data_ind (&msg->u.data, &emm_cause);
+    rc = _emm_as_data_ind (&msg->u.data, &emm_cause, &message_type);
     ue_id = msg->u.data.ue_id;
     break;
 
   case _EMMAS_ESTABLISH_REQ:
-    rc = _emm_as_establish_req (&msg->u.establish, &emm_cause);
+    rc = _emm_as_establish_req (&msg->u.establish, &emm_cause, &message_type);
     ue_id = msg->u.establish.ue_id;
     break;
 
@@ -205,6 +254,12 @@ int emm_as_send (const emm_as_t * msg)
     break;
   }
 
+  if (EMM_AS_METRIC_UNDECODED == message_type) {
+    metrics_inc (_emm_as_metric_undecoded);
+  } else if (0 <= message_type) {
+    metrics_inc (_emm_as_metrics[message_type][(RETURNok == rc) ? 0 : 1]);
+  }
+
   /*
    * Handle decoding errors
    */
@@ -278,7 +333,8 @@ static int _emm_as_recv (
   bstring msg,
   size_t len,
   int *emm_cause,
-  nas_message_decode_status_t   * decode_status)
+  nas_message_decode_status_t   * decode_status,
+  int *message_type)
 {
   OAILOG_FUNC_IN (LOG_NAS_EMM);
   nas_message_decode_status_t             local_decode_status = {0};
@@ -318,6 +374,7 @@ static int _emm_as_recv (
   if (decoder_rc < 0) {
     OAILOG_WARNING (LOG_NAS_EMM, "EMMAS-SAP - Failed to decode NAS message " "(err=%d)\n", decoder_rc);
     *emm_cause = EMM_CAUSE_PROTOCOL_ERROR;
+    *message_type = EMM_AS_METRIC_UNDECODED;
     OAILOG_FUNC_RETURN (LOG_NAS_EMM, decoder_rc);
   }
 
@@ -326,6 +383,8 @@ static int _emm_as_recv (
    */
   EMM_msg                                *emm_msg = &nas_msg.plain.emm;
 
+  *message_type = emm_msg->header.message_type;
+
   switch (emm_msg->header.message_type) {
   case EMM_STATUS:
     REQUIREMENT_3GPP_24_301(R10_4_4_4_3__1);
@@ -451,7 +510,7 @@ static int _emm_as_recv (
  **      Others:    None                                       **
  **                                                                        **
  ***************************************************************************/
-static int _emm_as_data_ind (const emm_as_data_t * msg, int *emm_cause)
+static int _emm_as_data_ind (const emm_as_data_t * msg, int *emm_cause, int *message_type)
 {
   OAILOG_FUNC_IN (LOG_NAS_EMM);
   int                                     rc = RETURNerror;
@@ -512,7 +571,7 @@ static int _emm_as_data_ind (const emm_as_data_t * msg, int *emm_cause)
           originating_tai.plmn.mnc_digit2 = msg->plmn_id->mnc_digit2;
           originating_tai.plmn.mnc_digit3 = msg->plmn_id->mnc_digit3;
 
-          rc = _emm_as_recv (msg->ue_id, &originating_tai, &msg->ecgi, plain_msg, bytes, emm_cause, &decode_status);
+          rc = _emm_as_recv (msg->ue_id, &originating_tai, &msg->ecgi, plain_msg, bytes, emm_cause, &decode_status, message_type);
         } else if (header.protocol_discriminator == EPS_SESSION_MANAGEMENT_MESSAGE) {
           /*
            * Foward ESM data to EPS session management
@@ -561,7 +620,7 @@ static int _emm_as_data_ind (const emm_as_data_t * msg, int *emm_cause)
  **      Others:    None                                       **
  **                                                                        **
  ***************************************************************************/
-static int _emm_as_establish_req (const emm_as_establish_t * msg, int *emm_cause)
+static int _emm_as_establish_req (const emm_as_establish_t * msg, int *emm_cause, int *message_type)
 {
   struct emm_data_context_s              *emm_ctx = NULL;
   emm_security_context_t                 *emm_security_context = NULL;
@@ -593,6 +652,7 @@ static int _emm_as_establish_req (const emm_as_establish_t * msg, int *emm_cause
 
   if (decoder_rc < TLV_FATAL_ERROR) {
     *emm_cause = EMM_CAUSE_PROTOCOL_ERROR;
+    *message_type = EMM_AS_METRIC_UNDECODED;
     OAILOG_FUNC_RETURN (LOG_NAS_EMM, decoder_rc);
   } else if (decoder_rc == TLV_UNEXPECTED_IEI) {
     *emm_cause = EMM_CAUSE_IE_NOT_IMPLEMENTED;
@@ -605,6 +665,8 @@ static int _emm_as_establish_req (const emm_as_establish_t * msg, int *emm_cause
    */
   EMM_msg                                *emm_msg = &nas_msg.plain.emm;
 
+  *message_type = emm_msg->header.message_type;
+
   switch (emm_msg->header.message_type) {
   case ATTACH_REQUEST:
     originating_tai.tac = msg->tac;
@@ -998,6 +1060,12 @@ static int _emm_as_send (const emm_as_t * msg)
       }
       break;
 
+    case AS_PAGING_REQ:{
+        nas_itti_paging_req (&as_msg.msg.paging_req);
+        OAILOG_FUNC_RETURN (LOG_NAS_EMM, RETURNok);
+      }
+      break;
+
     case AS_NAS_RELEASE_REQ:
       break;
 
@@ -1693,18 +1761,33 @@ static int _emm_as_establish_rej (const emm_as_establish_t * msg, nas_establish_
 static int _emm_as_page_ind (const emm_as_page_t * msg, paging_req_t * as_msg)
 {
   OAILOG_FUNC_IN (LOG_NAS_EMM);
-  int                                     bytes = 0;
 
   OAILOG_INFO (LOG_NAS_EMM, "EMMAS-SAP - Send AS data paging indication\n");
 
+  if (!msg->tai_list || !msg->tai_list->n_tais) {
+    OAILOG_WARNING (LOG_NAS_EMM, "EMMAS-SAP - No TAI list to page UE " MME_UE_S1AP_ID_FMT "\n", msg->ue_id);
+    OAILOG_FUNC_RETURN (LOG_NAS_EMM, 0);
+  }
+
   /*
-   * TODO
+   * Setup the AS message
    */
-
-  if (bytes > 0) {
-    OAILOG_FUNC_RETURN (LOG_NAS_EMM, AS_PAGING_IND);
+  as_msg->ue_id = msg->ue_id;
+  if (msg->guti) {
+    as_msg->s_tmsi.mme_code = msg->guti->gummei.mme_code;
+    as_msg->s_tmsi.m_tmsi = msg->guti->m_tmsi;
+    as_msg->is_imsi_paging = false;
+  } else {
+    as_msg->is_imsi_paging = true;
   }
-
-  OAILOG_FUNC_RETURN (LOG_NAS_EMM, 0);
+  as_msg->imsi64 = msg->imsi64;
+  as_msg->cn_domain = msg->cn_domain;
+  if (msg->lvr_tai) {
+    as_msg->last_visited_tai = *msg->lvr_tai;
+  } else {
+    as_msg->last_visited_tai.tac = INVALID_TAC_0000;
+  }
+  as_msg->tai_list = *msg->tai_list;
+  OAILOG_FUNC_RETURN (LOG_NAS_EMM, AS_PAGING_REQ);
 }
 
@@ -241,7 +241,14 @@ typedef struct emm_as_data_s {
  * EMMAS primitive for paging
  * --------------------------
  */
-typedef struct emm_as_page_s {} emm_as_page_t;
+typedef struct emm_as_page_s {
+  mme_ue_s1ap_id_t       ue_id;         /* UE lower layer identifier        */
+  const guti_t          *guti;          /* GUTI temporary mobile identity, IMSI paging if NULL */
+  imsi64_t               imsi64;        /* IMSI, gives the UE identity index value */
+  const tai_t           *lvr_tai;       /* Last visited registered TAI, paged first */
+  const tai_list_t      *tai_list;      /* TAIs the UE is registered to     */
+  uint8_t                cn_domain;     /* Core network domain, AS_PS or AS_CS */
+} emm_as_page_t;
 
 /*
  * EMMAS primitive for status indication
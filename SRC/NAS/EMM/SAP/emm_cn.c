@@ -70,6 +70,13 @@ typedef struct {
                                                          * the Attach Accept message    */
 } attach_data_t;
 
+/*
+   Per thread buffer used to encode the ESM messages piggybacked in EMM
+   messages, copied into a bstring as soon as it is encoded
+*/
+#define EMM_CN_SAP_BUFFER_SIZE 4096
+static __thread uint8_t                 _emm_cn_sap_buffer[EMM_CN_SAP_BUFFER_SIZE];
+
 /*
    String representation of EMMCN-SAP primitives
 */
@@ -320,13 +327,13 @@ static int _emm_cn_pdn_connectivity_res (emm_cn_pdn_res_t * msg_pP)
     /*
      * Encode the returned ESM response message
      */
-    int                                     size = esm_msg_encode (&esm_msg, (uint8_t *) emm_ctx_p->emm_cn_sap_buffer,
+    int                                     size = esm_msg_encode (&esm_msg, _emm_cn_sap_buffer,
                                                                    EMM_CN_SAP_BUFFER_SIZE);
 
     OAILOG_INFO (LOG_NAS_EMM, "ESM encoded MSG size %d\n", size);
 
     if (size > 0) {
-      rsp = blk2bstr(emm_ctx_p->emm_cn_sap_buffer, size);
+      rsp = blk2bstr(_emm_cn_sap_buffer, size);
     }
 
     /*
@@ -427,7 +434,7 @@ static int _emm_cn_pdn_connectivity_fail (const emm_cn_pdn_fail_t * msg)
   /*
    * Encode the returned ESM response message
    */
-  int size = esm_msg_encode (&esm_msg, (uint8_t *) emm_ctx_p->emm_cn_sap_buffer,
+  int size = esm_msg_encode (&esm_msg, _emm_cn_sap_buffer,
                                                                    EMM_CN_SAP_BUFFER_SIZE);
   OAILOG_INFO (LOG_NAS_EMM, "ESM encoded MSG size %d\n", size);
 
@@ -436,7 +443,7 @@ static int _emm_cn_pdn_connectivity_fail (const emm_cn_pdn_fail_t * msg)
     /*
      * Setup the ESM message container
      */
-    data_p->esm_msg = blk2bstr(emm_ctx_p->emm_cn_sap_buffer, size);
+    data_p->esm_msg = blk2bstr(_emm_cn_sap_buffer, size);
     rc = emm_proc_attach_reject (msg->ue_id, EMM_CAUSE_ESM_FAILURE);
   }
   OAILOG_FUNC_RETURN (LOG_NAS_EMM, rc);
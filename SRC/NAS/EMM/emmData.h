@@ -259,8 +259,6 @@ typedef struct emm_data_context_s {
 
   // TODO: DO BETTER  WITH BELOW
   bstring         esm_msg;      /* ESM message contained within the initial request*/
-#  define EMM_CN_SAP_BUFFER_SIZE 4096
-  char                             emm_cn_sap_buffer[EMM_CN_SAP_BUFFER_SIZE];
 
 
 #define           IS_EMM_CTXT_PRESENT_IMSI( eMmCtXtPtR )                  (!!((eMmCtXtPtR)->member_present_mask & EMM_CTXT_MEMBER_IMSI))
@@ -314,7 +312,7 @@ typedef struct emm_data_s {
    */
   hash_table_ts_t    *ctx_coll_ue_id; // key is emm ue id, data is struct emm_data_context_s
   hash_table_ts_t    *ctx_coll_imsi;  // key is imsi_t, data is emm ue id (unsigned int)
-  obj_hash_table_t   *ctx_coll_guti;  // key is guti, data is emm ue id (unsigned int)
+  hash_table_ts_t    *ctx_coll_guti;  // key is guti_key(guti), data is emm ue id (unsigned int)
 } emm_data_t;
 
 mme_ue_s1ap_id_t emm_ctx_get_new_ue_id(emm_data_context_t *ctxt) __attribute__((nonnull));
@@ -33,6 +33,7 @@
 #include "common_types.h"
 #include "NasSecurityAlgorithms.h"
 #include "conversions.h"
+#include "guti_key.h"
 #include "emmData.h"
 #include "EmmCommon.h"
 
@@ -575,10 +576,15 @@ emm_data_context_get_by_guti (
 
   if ( guti) {
 
-    h_rc = obj_hashtable_ts_get (emm_data->ctx_coll_guti, (const void *)guti, sizeof (*guti), (void **) &emm_ue_id_p);
+    h_rc = hashtable_ts_get (emm_data->ctx_coll_guti, (const hash_key_t)guti_key (guti), (void **) &emm_ue_id_p);
 
     if (HASH_TABLE_OK == h_rc) {
       struct emm_data_context_s * tmp = emm_data_context_get (emm_data, *emm_ue_id_p);
+
+      // the entry of an old GUTI stays until the context is removed, the UE may have dropped it
+      if ((tmp) && !(GUTIS_ARE_EQUAL(tmp->_guti, *guti)) && !(GUTIS_ARE_EQUAL(tmp->_old_guti, *guti))) {
+        return NULL;
+      }
 #if DEBUG_IS_ON
       if ((tmp)) {
         OAILOG_DEBUG (LOG_NAS_EMM, "EMM-CTX - get UE id " MME_UE_S1AP_ID_FMT " context %p by guti " GUTI_FMT "\n", tmp->ue_id, tmp, GUTI_ARG(guti));
@@ -603,12 +609,11 @@ emm_data_context_remove (
   OAILOG_DEBUG (LOG_NAS_EMM, "EMM-CTX - Remove in context %p UE id " MME_UE_S1AP_ID_FMT "\n", elm, elm->ue_id);
 
   if ( IS_EMM_CTXT_PRESENT_GUTI(elm)) {
-    obj_hashtable_ts_remove(emm_data->ctx_coll_guti, (const void *) &elm->_guti, sizeof(elm->_guti),
-                            (void **) &emm_ue_id);
-    if (emm_ue_id) {
-      // The GUTI is only inserted as part of attach complete, so it might be NULL.
+    // The GUTI is only inserted as part of attach complete, another UE may have been given it since.
+    if (HASH_TABLE_OK == hashtable_ts_remove_if_element(emm_data->ctx_coll_guti, (const hash_key_t)guti_key (&elm->_guti),
+                            &elm->ue_id)) {
       OAILOG_DEBUG (LOG_NAS_EMM, "EMM-CTX - Remove in ctx_coll_guti context %p UE id "
-          MME_UE_S1AP_ID_FMT " guti " " " GUTI_FMT "\n", elm, (mme_ue_s1ap_id_t) (*emm_ue_id), GUTI_ARG(&elm->_guti));
+          MME_UE_S1AP_ID_FMT " guti " " " GUTI_FMT "\n", elm, elm->ue_id, GUTI_ARG(&elm->_guti));
     }
     emm_ctx_clear_guti(elm);
   }
@@ -636,11 +641,12 @@ emm_data_context_remove_mobile_ids (
   OAILOG_DEBUG (LOG_NAS_EMM, "EMM-CTX - Remove in context %p UE id " MME_UE_S1AP_ID_FMT "\n", elm, elm->ue_id);
 
   if ( IS_EMM_CTXT_PRESENT_GUTI(elm)) {
-    obj_hashtable_ts_remove(emm_data->ctx_coll_guti, (const void *) &elm->_guti, sizeof(elm->_guti),
-                            (void **) &emm_ue_id);
-
-    OAILOG_DEBUG (LOG_NAS_EMM, "EMM-CTX - Remove in ctx_coll_guti context %p UE id " MME_UE_S1AP_ID_FMT " guti " " "
-        GUTI_FMT "\n", elm, (mme_ue_s1ap_id_t) (*emm_ue_id), GUTI_ARG(&elm->_guti));
+    // only drop our own entry, another UE may have been given this GUTI since
+    if (HASH_TABLE_OK == hashtable_ts_remove_if_element(emm_data->ctx_coll_guti, (const hash_key_t)guti_key (&elm->_guti),
+                            &elm->ue_id)) {
+      OAILOG_DEBUG (LOG_NAS_EMM, "EMM-CTX - Remove in ctx_coll_guti context %p UE id " MME_UE_S1AP_ID_FMT " guti " " "
+          GUTI_FMT "\n", elm, elm->ue_id, GUTI_ARG(&elm->_guti));
+    }
   }
   
   emm_ctx_clear_guti(elm);
@@ -658,6 +664,24 @@ emm_data_context_remove_mobile_ids (
 }
 
 
+//------------------------------------------------------------------------------
+// HASH_TABLE_INSERT_OVERWRITTEN_DATA when the same GUTI was still registered for another UE
+static hashtable_rc_t
+emm_data_context_insert_guti (
+  emm_data_t * emm_data,
+  const guti_t * const guti,
+  struct emm_data_context_s *elm)
+{
+  guti_key_t                              key = INVALID_GUTI_KEY;
+
+  if (RETURNok != guti_key_new (guti, &key)) {
+    OAILOG_WARNING (LOG_NAS_EMM, "EMM-CTX - Too many PLMNs in GUTIs, UE id " MME_UE_S1AP_ID_FMT " cannot be found by GUTI "GUTI_FMT"\n",
+        elm->ue_id, GUTI_ARG(guti));
+    return HASH_TABLE_BAD_PARAMETER_KEY;
+  }
+  return hashtable_ts_insert (emm_data->ctx_coll_guti, (const hash_key_t)key, &elm->ue_id);
+}
+
 //------------------------------------------------------------------------------
 int
 emm_data_context_add (
@@ -672,10 +696,9 @@ emm_data_context_add (
     OAILOG_DEBUG (LOG_NAS_EMM, "EMM-CTX - Add in context %p UE id " MME_UE_S1AP_ID_FMT "\n", elm, elm->ue_id);
 
     if ( IS_EMM_CTXT_PRESENT_GUTI(elm)) {
-      h_rc = obj_hashtable_ts_insert (emm_data->ctx_coll_guti, (const void *const)(&elm->_guti), sizeof (elm->_guti),
-                                      &elm->ue_id);
+      h_rc = emm_data_context_insert_guti (emm_data, &elm->_guti, elm);
 
-      if (HASH_TABLE_OK == h_rc) {
+      if ((HASH_TABLE_OK == h_rc) || (HASH_TABLE_INSERT_OVERWRITTEN_DATA == h_rc)) {
         OAILOG_DEBUG (LOG_NAS_EMM, "EMM-CTX - Add in context UE id " MME_UE_S1AP_ID_FMT " with GUTI "GUTI_FMT"\n", elm->ue_id, GUTI_ARG(&elm->_guti));
       } else {
         OAILOG_ERROR (LOG_NAS_EMM, "EMM-CTX - Add in context UE id " MME_UE_S1AP_ID_FMT " with GUTI "GUTI_FMT" Failed %s\n", elm->ue_id, GUTI_ARG(&elm->_guti), hashtable_rc_code2string (h_rc));
@@ -709,10 +732,9 @@ emm_data_context_add_guti (
   hashtable_rc_t                          h_rc = HASH_TABLE_OK;
 
   if ( IS_EMM_CTXT_PRESENT_GUTI(elm)) {
-    h_rc = obj_hashtable_ts_insert (emm_data->ctx_coll_guti, (const void *const)(&elm->_guti), sizeof (elm->_guti),
-                                    &elm->ue_id);
+    h_rc = emm_data_context_insert_guti (emm_data, &elm->_guti, elm);
 
-    if (HASH_TABLE_OK == h_rc) {
+    if ((HASH_TABLE_OK == h_rc) || (HASH_TABLE_INSERT_OVERWRITTEN_DATA == h_rc)) {
       OAILOG_DEBUG (LOG_NAS_EMM, "EMM-CTX - Add in context UE id " MME_UE_S1AP_ID_FMT " with GUTI "GUTI_FMT"\n", elm->ue_id, GUTI_ARG(&elm->_guti));
     } else {
       OAILOG_ERROR (LOG_NAS_EMM, "EMM-CTX - Add in context UE id " MME_UE_S1AP_ID_FMT " with GUTI "GUTI_FMT" Failed %s\n", elm->ue_id, GUTI_ARG(&elm->_guti), hashtable_rc_code2string (h_rc));
@@ -730,10 +752,9 @@ emm_data_context_add_old_guti (
   hashtable_rc_t                          h_rc = HASH_TABLE_OK;
 
   if ( IS_EMM_CTXT_PRESENT_OLD_GUTI(elm)) {
-    h_rc = obj_hashtable_ts_insert (emm_data->ctx_coll_guti, (const void *const)(&elm->_old_guti),
-                                    sizeof(elm->_old_guti), &elm->ue_id);
+    h_rc = emm_data_context_insert_guti (emm_data, &elm->_old_guti, elm);
 
-    if (HASH_TABLE_OK == h_rc) {
+    if ((HASH_TABLE_OK == h_rc) || (HASH_TABLE_INSERT_OVERWRITTEN_DATA == h_rc)) {
       OAILOG_DEBUG (LOG_NAS_EMM, "EMM-CTX - Add in context UE id " MME_UE_S1AP_ID_FMT " with old GUTI "GUTI_FMT"\n", elm->ue_id, GUTI_ARG(&elm->_old_guti));
     } else {
       OAILOG_ERROR (LOG_NAS_EMM, "EMM-CTX - Add in context UE id " MME_UE_S1AP_ID_FMT " with old GUTI "GUTI_FMT" Failed %s\n", elm->ue_id, GUTI_ARG(&elm->_old_guti), hashtable_rc_code2string (h_rc));
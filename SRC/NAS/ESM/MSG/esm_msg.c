@@ -41,7 +41,7 @@
 #include "log.h"
 #include "TLVDecoder.h"
 #include "TLVEncoder.h"
-#include "nas_itti_messaging.h"
+#include "nas_trace.h"
 
 
 /****************************************************************************/
@@ -210,7 +210,7 @@ esm_msg_decode (
     /*
      * Message has been decoded and security header removed, handle it has a plain message
      */
-    nas_itti_plain_msg ((char *)buffer_log, (nas_message_t *) msg, len_log, down_link);
+    NAS_TRACE (msg->header.protocol_discriminator, msg->header.message_type, down_link, buffer_log, len_log);
   }
 
   OAILOG_FUNC_RETURN (LOG_NAS_ESM, header_result + decode_result);
@@ -356,7 +356,7 @@ esm_msg_encode (
   if (encode_result < 0) {
     OAILOG_ERROR (LOG_NAS_ESM, "ESM-MSG   - Failed to encode L3 ESM message 0x%x " "(%d)\n", msg->header.message_type, encode_result);
   } else {
-    nas_itti_plain_msg ((char *)buffer_log, (nas_message_t *) msg, header_result + encode_result, down_link);
+    NAS_TRACE (msg->header.protocol_discriminator, msg->header.message_type, down_link, buffer_log, header_result + encode_result);
   }
 
   OAILOG_FUNC_RETURN (LOG_NAS_ESM, header_result + encode_result);
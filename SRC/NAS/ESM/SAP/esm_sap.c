@@ -62,6 +62,15 @@ extern int _pdn_connectivity_delete (emm_data_context_t * ctx, int pid);
 /*******************  L O C A L    D E F I N I T I O N S  *******************/
 /****************************************************************************/
 
+/*
+   Buffer used to encode ESM messages before being returned to the EPS
+   Mobility Management sublayer in order to be sent onto the network.
+   Used in _esm_sap_send(), _esm_sap_recv(). The encoded message is copied
+   into a bstring right away, so one buffer per NAS thread is enough and the
+   UE context does not have to carry it.
+*/
+#define ESM_SAP_BUFFER_SIZE 4096
+static __thread uint8_t                 _esm_sap_buffer[ESM_SAP_BUFFER_SIZE];
 
 static int _esm_sap_recv (
   int msg_type,
@@ -710,11 +719,11 @@ _esm_sap_recv (
     /*
      * Encode the returned ESM response message
      */
-    int                                     size = esm_msg_encode (&esm_msg, (uint8_t *) ctx->esm_data_ctx.esm_sap_buffer,
+    int                                     size = esm_msg_encode (&esm_msg, _esm_sap_buffer,
                                                                    ESM_SAP_BUFFER_SIZE);
 
     if (size > 0) {
-      rsp = blk2bstr(ctx->esm_data_ctx.esm_sap_buffer, size);
+      rsp = blk2bstr(_esm_sap_buffer, size);
     }
 
     /*
@@ -826,10 +835,10 @@ _esm_sap_send (
     /*
      * Encode the returned ESM response message
      */
-    int size = esm_msg_encode (&esm_msg, (uint8_t *) ctx->esm_data_ctx.esm_sap_buffer, ESM_SAP_BUFFER_SIZE);
+    int size = esm_msg_encode (&esm_msg, _esm_sap_buffer, ESM_SAP_BUFFER_SIZE);
 
     if (size > 0) {
-      rsp = blk2bstr(ctx->esm_data_ctx.esm_sap_buffer, size);
+      rsp = blk2bstr(_esm_sap_buffer, size);
     }
 
     /*
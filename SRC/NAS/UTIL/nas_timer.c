@@ -108,9 +108,7 @@ typedef struct {
   timer_queue_t                           tq[TIMER_DATABASE_SIZE];
   timer_queue_t                          *head; /* Pointer to the first timer entry to be fired  */
 
-#if ENABLE_ITTI == 0
   pthread_mutex_t                         mutex;
-#endif
 } nas_timer_database_t;
 
 /*
@@ -119,18 +117,24 @@ typedef struct {
 static nas_timer_database_t             _nas_timer_db = {
   0,
   {},
-  NULL
-#if ENABLE_ITTI == 0
-    , PTHREAD_MUTEX_INITIALIZER
-#endif
+  NULL,
+  PTHREAD_MUTEX_INITIALIZER
 };
 
 #if ENABLE_ITTI
+/*
+   The timer database is shared by all NAS worker tasks: exported functions
+   hold the lock for the whole operation (identifier allocation included).
+*/
 #  define nas_timer_lock_db()
 #  define nas_timer_unlock_db()
+#  define nas_timer_lock_api()    pthread_mutex_lock(&_nas_timer_db.mutex)
+#  define nas_timer_unlock_api()  pthread_mutex_unlock(&_nas_timer_db.mutex)
 #else
 #  define nas_timer_lock_db()     pthread_mutex_lock(&_nas_timer_db.mutex)
 #  define nas_timer_unlock_db()   pthread_mutex_unlock(&_nas_timer_db.mutex)
+#  define nas_timer_lock_api()
+#  define nas_timer_unlock_api()
 #endif
 
 /*
@@ -139,6 +143,12 @@ static nas_timer_database_t             _nas_timer_db = {
 #if ENABLE_ITTI == 0
 static void                             _nas_timer_handler (
   int signal);
+#else
+/*
+   The NAS worker task to be notified upon timer expiration
+*/
+static task_id_t                        _nas_timer_task_id (
+  void);
 #endif
 
 /*
@@ -296,6 +306,7 @@ nas_timer_start (
     return (NAS_TIMER_INACTIVE_ID);
   }
 
+  nas_timer_lock_api ();
   /*
    * Get an identifier for the new timer entry
    */
@@ -305,6 +316,7 @@ nas_timer_start (
     /*
      * No available timer entry found
      */
+    nas_timer_unlock_api ();
     return (NAS_TIMER_INACTIVE_ID);
   }
 
@@ -314,6 +326,7 @@ nas_timer_start (
   te = _nas_timer_db_create_entry (sec, cb, args);
 
   if (te == NULL) {
+    nas_timer_unlock_api ();
     return (NAS_TIMER_INACTIVE_ID);
   }
 
@@ -322,14 +335,21 @@ nas_timer_start (
    */
   _nas_timer_db_insert_entry (id, te);
 #if ENABLE_ITTI
-  ret = timer_setup (sec, 0, TASK_NAS_MME, INSTANCE_DEFAULT, TIMER_ONE_SHOT, args, &timer_id);
+  /*
+   * The ITTI timer carries the entry identifier, the callback arguments stay in the entry
+   */
+  ret = timer_setup (sec, 0, _nas_timer_task_id (), INSTANCE_DEFAULT, TIMER_ONE_SHOT, (void *)(intptr_t)id, &timer_id);
 
   if (ret == -1) {
+    _nas_timer_db_remove_entry (id);
+    _nas_timer_db_delete_entry (id);
+    nas_timer_unlock_api ();
     return NAS_TIMER_INACTIVE_ID;
   }
 
   te->timer_id = timer_id;
 #endif
+  nas_timer_unlock_api ();
   return (id);
 }
 
@@ -352,6 +372,8 @@ int
 nas_timer_stop (
   int id)
 {
+  nas_timer_lock_api ();
+
   /*
    * Check if the timer entry is active
    */
@@ -371,9 +393,11 @@ nas_timer_stop (
      * Delete the timer entry
      */
     _nas_timer_db_delete_entry (id);
+    nas_timer_unlock_api ();
     return (NAS_TIMER_INACTIVE_ID);
   }
 
+  nas_timer_unlock_api ();
   return (id);
 }
 
@@ -401,7 +425,9 @@ nas_timer_restart (
   int id)
 {
   int ret;
-  
+
+  nas_timer_lock_api ();
+
   /*
    * Check if the timer entry is active
    */
@@ -420,16 +446,19 @@ nas_timer_restart (
      */
     _nas_timer_db_insert_entry (id, te);
   #if ENABLE_ITTI
-    ret = timer_setup (te->itv.tv_sec, 0, TASK_NAS_MME, INSTANCE_DEFAULT, TIMER_ONE_SHOT, te->args, &(te->timer_id));
+    ret = timer_setup (te->itv.tv_sec, 0, _nas_timer_task_id (), INSTANCE_DEFAULT, TIMER_ONE_SHOT, (void *)(intptr_t)id, &(te->timer_id));
 
     if (ret == -1) {
+      nas_timer_unlock_api ();
       return NAS_TIMER_INACTIVE_ID;
     }
   #endif
-    
+
+    nas_timer_unlock_api ();
     return (id);
   }
 
+  nas_timer_unlock_api ();
   return (NAS_TIMER_INACTIVE_ID);
 }
 
@@ -462,12 +491,47 @@ nas_timer_handle_signal_expiry (
   long timer_id,
   void *arg_p)
 {
+  nas_timer_callback_t                    cb = NULL;
+  void                                   *args = NULL;
+  const intptr_t                          id = (intptr_t)arg_p;
+
   /*
-   * Get the timer entry for which the system timer expired
+   * Get the timer entry for which the system timer expired: each entry has
+   * its own ITTI timer, the head of the queue is not necessarily the one.
+   * The ITTI timer argument is the entry identifier.
    */
-  nas_timer_entry_t                      *te = _nas_timer_db.head->entry;
+  nas_timer_lock_api ();
+
+  if ((id >= 0) && (id < TIMER_DATABASE_SIZE) && (_nas_timer_db.tq[id].id == id) &&
+      (_nas_timer_db.tq[id].entry->timer_id == timer_id)) {
+    cb = _nas_timer_db.tq[id].entry->cb;
+    args = _nas_timer_db.tq[id].entry->args;
+  }
+
+  nas_timer_unlock_api ();
+
+  /*
+   * The timer may have been stopped, or its entry reused, while its expiry was queued
+   */
+  if (cb) {
+    cb (args);
+  }
+}
 
-  te->cb (te->args);
+static task_id_t
+_nas_timer_task_id (
+  void)
+{
+  task_id_t                               task_id = itti_get_current_task_id ();
+
+  /*
+   * Expiry is notified to the NAS worker owning the UE, i.e. the caller
+   */
+  if ((TASK_NAS_MME > task_id) || (TASK_NAS_MME_7 < task_id)) {
+    task_id = TASK_NAS_MME;
+  }
+
+  return task_id;
 }
 #else
 static void
@@ -865,7 +929,9 @@ _nas_timer_db_remove_entry (
      */
     rc = _nas_timer_sub (&_nas_timer_db.head->entry->tv, &tv, &it.it_value);
 #if ENABLE_ITTI
-    timer_remove (_nas_timer_db.head->entry->timer_id);
+    /*
+     * Each entry runs its own ITTI timer, nothing to re-arm
+     */
     (void)(rc);
 #else
 
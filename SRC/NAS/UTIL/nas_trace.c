@@ -0,0 +1,287 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*****************************************************************************
+  Source      nas_trace.c
+
+  Version     0.1
+
+  Product     NAS stack
+
+  Subsystem   Utilities
+
+  Description Capture of NAS messages in a trace ring. Records are written
+              lock-free by the NAS tasks, the capture is switched on and off
+              by configuration or by SIGUSR2, the ring is logged when the
+              capture stops.
+
+*****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "log.h"
+#include "common_defs.h"
+#include "3gpp_24.007.h"
+#include "mme_config.h"
+#include "signals.h"
+#include "nas_trace.h"
+
+/****************************************************************************/
+/****************  E X T E R N A L    D E F I N I T I O N S  ****************/
+/****************************************************************************/
+
+volatile uint32_t                       nas_trace_enabled = 0;
+
+/****************************************************************************/
+/*******************  L O C A L    D E F I N I T I O N S  *******************/
+/****************************************************************************/
+
+/* Trace ring shared by all NAS tasks */
+static struct {
+  volatile uint64_t                       head;         /* Next sequence number */
+  nas_trace_record_t                      records[NAS_TRACE_RING_SIZE];
+} _nas_trace_ring;
+
+/* Message types to capture, all of them when the filter is empty */
+static uint32_t                         _nas_trace_filter[256 / 32];
+static volatile bool                    _nas_trace_filter_all = true;
+
+/****************************************************************************/
+/******************  E X P O R T E D    F U N C T I O N S  ******************/
+/****************************************************************************/
+
+/****************************************************************************
+ **                                                                        **
+ ** Name:    nas_trace_init()                                          **
+ **                                                                        **
+ ** Description: Sets the capture filter from the configuration, starts    **
+ **      the capture if configured, SIGUSR2 switches it later on.  **
+ **                                                                        **
+ ** Inputs:  mme_config_p:  The MME configuration                      **
+ **      Others:    None                                       **
+ **                                                                        **
+ ** Outputs:     None                                                      **
+ **      Return:    RETURNok, RETURNerror                      **
+ **      Others:    _nas_trace_filter                          **
+ **                                                                        **
+ ***************************************************************************/
+int
+nas_trace_init (
+  const struct mme_config_s * const mme_config_p)
+{
+  memset (&_nas_trace_ring, 0, sizeof (_nas_trace_ring));
+  nas_trace_filter_clear ();
+  for (int i = 0; i < mme_config_p->nas_config.num_trace_message_types; i++) {
+    nas_trace_filter_set (mme_config_p->nas_config.trace_message_types[i], true);
+  }
+  signal_set_usr2_handler (nas_trace_toggle);
+  if (mme_config_p->nas_config.trace_enabled) {
+    nas_trace_start ();
+  }
+  return (RETURNok);
+}
+
+/****************************************************************************
+ **                                                                        **
+ ** Name:    nas_trace_start()                                         **
+ **                                                                        **
+ ** Description: Starts the capture, the ring keeps previous records   **
+ **                                                                        **
+ ***************************************************************************/
+void
+nas_trace_start (
+  void)
+{
+  OAILOG_INFO (LOG_NAS, "NAS trace started, %s message types\n", (_nas_trace_filter_all) ? "all" : "filtered");
+  __sync_synchronize ();
+  nas_trace_enabled = 1;
+}
+
+/****************************************************************************
+ **                                                                        **
+ ** Name:    nas_trace_stop()                                          **
+ **                                                                        **
+ ** Description: Stops the capture and logs the content of the ring    **
+ **                                                                        **
+ ***************************************************************************/
+void
+nas_trace_stop (
+  void)
+{
+  bstring                                 b = bfromcstr ("");
+
+  nas_trace_enabled = 0;
+  __sync_synchronize ();
+  nas_trace_dump (b);
+  OAILOG_INFO (LOG_NAS, "NAS trace stopped:\n%s", bdata(b));
+  bdestroy (b);
+}
+
+/****************************************************************************
+ **                                                                        **
+ ** Name:    nas_trace_toggle()                                        **
+ **                                                                        **
+ ** Description: Starts or stops the capture, SIGUSR2 handler          **
+ **                                                                        **
+ ***************************************************************************/
+void
+nas_trace_toggle (
+  void)
+{
+  if (nas_trace_enabled) {
+    nas_trace_stop ();
+  } else {
+    nas_trace_start ();
+  }
+}
+
+/****************************************************************************
+ **                                                                        **
+ ** Name:    nas_trace_filter_set()                                    **
+ **                                                                        **
+ ** Description: Adds or removes a message type from the capture      **
+ **      filter. EMM and ESM message types do not overlap.         **
+ **                                                                        **
+ ***************************************************************************/
+void
+nas_trace_filter_set (
+  const uint8_t message_type,
+  const bool capture)
+{
+  if (capture) {
+    __sync_fetch_and_or (&_nas_trace_filter[message_type >> 5], (uint32_t)1 << (message_type & 0x1F));
+    _nas_trace_filter_all = false;
+  } else {
+    __sync_fetch_and_and (&_nas_trace_filter[message_type >> 5], ~((uint32_t)1 << (message_type & 0x1F)));
+  }
+}
+
+/****************************************************************************
+ **                                                                        **
+ ** Name:    nas_trace_filter_clear()                                  **
+ **                                                                        **
+ ** Description: Empties the capture filter, all messages are captured **
+ **                                                                        **
+ ***************************************************************************/
+void
+nas_trace_filter_clear (
+  void)
+{
+  _nas_trace_filter_all = true;
+  for (int i = 0; i < sizeof (_nas_trace_filter) / sizeof (_nas_trace_filter[0]); i++) {
+    _nas_trace_filter[i] = 0;
+  }
+}
+
+/****************************************************************************
+ **                                                                        **
+ ** Name:    nas_trace_record()                                        **
+ **                                                                        **
+ ** Description: Writes a record of a NAS message in the trace ring,   **
+ **      called through NAS_TRACE() only while capturing.          **
+ **                                                                        **
+ ** Inputs:  protocol_discriminator: EMM or ESM                        **
+ **      message_type:  The NAS message type                       **
+ **      is_down_link:  Direction of the message                   **
+ **      buffer:    The encoded NAS message                        **
+ **      length:    Length of the encoded NAS message              **
+ **                                                                        **
+ ***************************************************************************/
+void
+nas_trace_record (
+  const uint8_t protocol_discriminator,
+  const uint8_t message_type,
+  const bool is_down_link,
+  const uint8_t * const buffer,
+  const uint32_t length)
+{
+  struct timespec                         ts = {0};
+  nas_trace_record_t                     *record = NULL;
+  uint64_t                                seq = 0;
+
+  if ((!_nas_trace_filter_all) && !(_nas_trace_filter[message_type >> 5] & ((uint32_t)1 << (message_type & 0x1F)))) {
+    return;
+  }
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  seq = __sync_fetch_and_add (&_nas_trace_ring.head, 1);
+  record = &_nas_trace_ring.records[seq & (NAS_TRACE_RING_SIZE - 1)];
+  // a reader skips the record while it is written
+  record->seq = 0;
+  __sync_synchronize ();
+  record->time_us = (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+  record->length = (length > UINT16_MAX) ? UINT16_MAX : (uint16_t)length;
+  record->protocol_discriminator = protocol_discriminator;
+  record->message_type = message_type;
+  record->is_down_link = is_down_link;
+  memcpy (record->data, buffer, (length < NAS_TRACE_DATA_MAX) ? length : NAS_TRACE_DATA_MAX);
+  __sync_synchronize ();
+  record->seq = seq + 1;
+}
+
+/****************************************************************************
+ **                                                                        **
+ ** Name:    nas_trace_dump()                                          **
+ **                                                                        **
+ ** Description: Appends the records of the trace ring to a string,    **
+ **      oldest first.                                             **
+ **                                                                        **
+ ** Outputs:     str:       One line per record                        **
+ **      Return:    The number of records                      **
+ **                                                                        **
+ ***************************************************************************/
+int
+nas_trace_dump (
+  bstring str)
+{
+  uint64_t                                head = _nas_trace_ring.head;
+  uint64_t                                seq = (head > NAS_TRACE_RING_SIZE) ? head - NAS_TRACE_RING_SIZE : 0;
+  int                                     num_records = 0;
+
+  for (; seq < head; seq++) {
+    volatile nas_trace_record_t          *slot = &_nas_trace_ring.records[seq & (NAS_TRACE_RING_SIZE - 1)];
+    nas_trace_record_t                    record = {0};
+    uint64_t                              slot_seq = slot->seq;
+
+    __sync_synchronize ();
+    memcpy (&record, (const void *)slot, sizeof (record));
+    __sync_synchronize ();
+    // overwritten or being written
+    if ((slot_seq != seq + 1) || (slot->seq != seq + 1)) {
+      continue;
+    }
+    bformata (str, "%"PRIu64".%06"PRIu64" %s %s type 0x%02x length %u:",
+        record.time_us / 1000000, record.time_us % 1000000,
+        (record.is_down_link) ? "DL" : "UL",
+        (record.protocol_discriminator == EPS_MOBILITY_MANAGEMENT_MESSAGE) ? "EMM" : "ESM",
+        record.message_type, record.length);
+    for (int i = 0; (i < record.length) && (i < NAS_TRACE_DATA_MAX); i++) {
+      bformata (str, " %02x", record.data[i]);
+    }
+    bcatcstr (str, (record.length > NAS_TRACE_DATA_MAX) ? " ...\n" : "\n");
+    num_records += 1;
+  }
+  return num_records;
+}
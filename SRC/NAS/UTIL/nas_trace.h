@@ -0,0 +1,101 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*****************************************************************************
+Source      nas_trace.h
+
+Version     0.1
+
+Product     NAS stack
+
+Subsystem   Utilities
+
+Description Capture of NAS messages in a trace ring
+
+*****************************************************************************/
+#ifndef FILE_NAS_TRACE_SEEN
+#define FILE_NAS_TRACE_SEEN
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bstrlib.h"
+
+/****************************************************************************/
+/*********************  G L O B A L    C O N S T A N T S  *******************/
+/****************************************************************************/
+
+/* Number of records kept in the trace ring, oldest ones are overwritten */
+#define NAS_TRACE_RING_SIZE           (4096)
+/* Number of leading octets of a NAS message kept in a record */
+#define NAS_TRACE_DATA_MAX            (48)
+
+/****************************************************************************/
+/************************  G L O B A L    T Y P E S  ************************/
+/****************************************************************************/
+
+/* A captured NAS message */
+typedef struct nas_trace_record_s {
+  uint64_t  seq;                        /* Sequence number + 1, 0 while written */
+  uint64_t  time_us;                    /* Monotonic time of the capture       */
+  uint16_t  length;                     /* Length of the NAS message           */
+  uint8_t   protocol_discriminator;
+  uint8_t   message_type;
+  bool      is_down_link;
+  uint8_t   data[NAS_TRACE_DATA_MAX];   /* First octets of the NAS message     */
+} nas_trace_record_t;
+
+/****************************************************************************/
+/********************  G L O B A L    V A R I A B L E S  ********************/
+/****************************************************************************/
+
+/* Not 0 while capturing, only tested by NAS_TRACE() */
+extern volatile uint32_t nas_trace_enabled;
+
+/****************************************************************************/
+/******************  E X P O R T E D    F U N C T I O N S  ******************/
+/****************************************************************************/
+
+struct mme_config_s;
+
+int  nas_trace_init(const struct mme_config_s * const mme_config_p);
+void nas_trace_start(void);
+void nas_trace_stop(void);
+void nas_trace_toggle(void);
+void nas_trace_filter_set(const uint8_t message_type, const bool capture);
+void nas_trace_filter_clear(void);
+void nas_trace_record(const uint8_t protocol_discriminator, const uint8_t message_type, const bool is_down_link,
+                      const uint8_t * const buffer, const uint32_t length);
+int  nas_trace_dump(bstring str);
+
+/*
+ * Called by the EMM/ESM codecs after each message, the disabled path is a
+ * single test of nas_trace_enabled.
+ */
+#define NAS_TRACE(pRoToCoL_dIsCrImInAtOr, mEsSaGe_TyPe, iS_dOwN_lInK, bUfFeR, lEnGtH) \
+  do {                                                                                  \
+    if (nas_trace_enabled) {                                                            \
+      nas_trace_record((pRoToCoL_dIsCrImInAtOr), (mEsSaGe_TyPe), (iS_dOwN_lInK),        \
+                       (bUfFeR), (lEnGtH));                                             \
+    }                                                                                   \
+  } while (0)
+
+#endif /* FILE_NAS_TRACE_SEEN */
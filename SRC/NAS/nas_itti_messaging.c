@@ -26,176 +26,11 @@
 #include "intertask_interface.h"
 #include "msc.h"
 #include "mme_app_ue_context.h"
+#include "mme_config.h"
 #include "nas_itti_messaging.h"
 #include "secu_defs.h"
 
 
-#define TASK_ORIGIN  TASK_NAS_MME
-
-
-static const uint8_t                    emm_message_ids[] = {
-  ATTACH_REQUEST,
-  ATTACH_ACCEPT,
-  ATTACH_COMPLETE,
-  ATTACH_REJECT,
-  DETACH_REQUEST,
-  DETACH_ACCEPT,
-  TRACKING_AREA_UPDATE_REQUEST,
-  TRACKING_AREA_UPDATE_ACCEPT,
-  TRACKING_AREA_UPDATE_COMPLETE,
-  TRACKING_AREA_UPDATE_REJECT,
-  EXTENDED_SERVICE_REQUEST,
-  SERVICE_REQUEST,
-  SERVICE_REJECT,
-  GUTI_REALLOCATION_COMMAND,
-  GUTI_REALLOCATION_COMPLETE,
-  AUTHENTICATION_REQUEST,
-  AUTHENTICATION_RESPONSE,
-  AUTHENTICATION_REJECT,
-  AUTHENTICATION_FAILURE,
-  IDENTITY_REQUEST,
-  IDENTITY_RESPONSE,
-  SECURITY_MODE_COMMAND,
-  SECURITY_MODE_COMPLETE,
-  SECURITY_MODE_REJECT,
-  EMM_STATUS,
-  EMM_INFORMATION,
-  DOWNLINK_NAS_TRANSPORT,
-  UPLINK_NAS_TRANSPORT,
-  CS_SERVICE_NOTIFICATION,
-};
-
-static const uint8_t                    esm_message_ids[] = {
-  ACTIVATE_DEFAULT_EPS_BEARER_CONTEXT_REQUEST,
-  ACTIVATE_DEFAULT_EPS_BEARER_CONTEXT_ACCEPT,
-  ACTIVATE_DEFAULT_EPS_BEARER_CONTEXT_REJECT,
-  ACTIVATE_DEDICATED_EPS_BEARER_CONTEXT_REQUEST,
-  ACTIVATE_DEDICATED_EPS_BEARER_CONTEXT_ACCEPT,
-  ACTIVATE_DEDICATED_EPS_BEARER_CONTEXT_REJECT,
-  MODIFY_EPS_BEARER_CONTEXT_REQUEST,
-  MODIFY_EPS_BEARER_CONTEXT_ACCEPT,
-  MODIFY_EPS_BEARER_CONTEXT_REJECT,
-  DEACTIVATE_EPS_BEARER_CONTEXT_REQUEST,
-  DEACTIVATE_EPS_BEARER_CONTEXT_ACCEPT,
-  PDN_CONNECTIVITY_REQUEST,
-  PDN_CONNECTIVITY_REJECT,
-  PDN_DISCONNECT_REQUEST,
-  PDN_DISCONNECT_REJECT,
-  BEARER_RESOURCE_ALLOCATION_REQUEST,
-  BEARER_RESOURCE_ALLOCATION_REJECT,
-  BEARER_RESOURCE_MODIFICATION_REQUEST,
-  BEARER_RESOURCE_MODIFICATION_REJECT,
-  ESM_INFORMATION_REQUEST,
-  ESM_INFORMATION_RESPONSE,
-  ESM_STATUS,
-};
-
-//------------------------------------------------------------------------------
-static int
-_nas_find_message_index (
-  const uint8_t message_id,
-  const uint8_t * message_ids,
-  const int ids_number)
-{
-  int                                     i;
-
-  for (i = 0; i < ids_number; i++) {
-    if (message_id == message_ids[i]) {
-      return (2 + i);
-    }
-  }
-
-  return (1);
-}
-
-int
-nas_itti_plain_msg (
-  const char *buffer,
-  const nas_message_t * msg,
-  const size_t          length,
-  const bool            is_down_link)
-{
-  MessageDef                             *message_p = NULL;
-  int                                     data_length = length < NAS_DATA_LENGHT_MAX ? length : NAS_DATA_LENGHT_MAX;
-  int                                     message_type = -1;
-  MessagesIds                             messageId_raw = -1;
-  MessagesIds                             messageId_plain = -1;
-
-  /*
-   * Define message ids
-   */
-  if (msg->header.protocol_discriminator == EPS_MOBILITY_MANAGEMENT_MESSAGE) {
-    message_type = 0;
-    messageId_raw = is_down_link ? NAS_DL_EMM_RAW_MSG : NAS_UL_EMM_RAW_MSG;
-    messageId_plain = is_down_link ? NAS_DL_EMM_PLAIN_MSG : NAS_UL_EMM_PLAIN_MSG;
-  } else {
-    if (msg->header.protocol_discriminator == EPS_SESSION_MANAGEMENT_MESSAGE) {
-      message_type = 1;
-      messageId_raw = is_down_link ? NAS_DL_ESM_RAW_MSG : NAS_UL_ESM_RAW_MSG;
-      messageId_plain = is_down_link ? NAS_DL_ESM_PLAIN_MSG : NAS_UL_ESM_PLAIN_MSG;
-    }
-  }
-
-  if (message_type >= 0) {
-    /*
-     * Create and send the RAW message
-     */
-    message_p = itti_alloc_new_message (TASK_ORIGIN, messageId_raw);
-    NAS_DL_EMM_RAW_MSG (message_p).length = length;
-    memset ((void *)&(NAS_DL_EMM_RAW_MSG (message_p).data), 0, NAS_DATA_LENGHT_MAX);
-    memcpy ((void *)&(NAS_DL_EMM_RAW_MSG (message_p).data), buffer, data_length);
-    itti_send_msg_to_task (TASK_UNKNOWN, INSTANCE_DEFAULT, message_p);
-
-    /*
-     * Create and send the plain message
-     */
-    if (message_type == 0) {
-      message_p = itti_alloc_new_message (TASK_ORIGIN, messageId_plain);
-      NAS_DL_EMM_PLAIN_MSG (message_p).present = _nas_find_message_index (msg->plain.emm.header.message_type, emm_message_ids, sizeof (emm_message_ids) / sizeof (emm_message_ids[0]));
-      memcpy ((void *)&(NAS_DL_EMM_PLAIN_MSG (message_p).choice), &msg->plain.emm, sizeof (EMM_msg));
-    } else {
-      message_p = itti_alloc_new_message (TASK_ORIGIN, messageId_plain);
-      NAS_DL_ESM_PLAIN_MSG (message_p).present = _nas_find_message_index (msg->plain.esm.header.message_type, esm_message_ids, sizeof (esm_message_ids) / sizeof (esm_message_ids[0]));
-      memcpy ((void *)&(NAS_DL_ESM_PLAIN_MSG (message_p).choice), &msg->plain.esm, sizeof (ESM_msg));
-    }
-
-    return itti_send_msg_to_task (TASK_UNKNOWN, INSTANCE_DEFAULT, message_p);
-  }
-
-  return EXIT_FAILURE;
-}
-
-//------------------------------------------------------------------------------
-int
-nas_itti_protected_msg (
-  const char          *buffer,
-  const nas_message_t *msg,
-  const size_t         length,
-  const bool           is_down_link)
-{
-  MessageDef                             *message_p = NULL;
-
-  if (msg->header.protocol_discriminator == EPS_MOBILITY_MANAGEMENT_MESSAGE) {
-    message_p = itti_alloc_new_message (TASK_ORIGIN, is_down_link ? NAS_DL_EMM_PROTECTED_MSG : NAS_UL_EMM_PROTECTED_MSG);
-    memcpy ((void *)&(NAS_DL_EMM_PROTECTED_MSG (message_p).header), &msg->header, sizeof (nas_message_security_header_t));
-    NAS_DL_EMM_PROTECTED_MSG (message_p).present = _nas_find_message_index (msg->security_protected.plain.emm.header.message_type, emm_message_ids, sizeof (emm_message_ids) / sizeof (emm_message_ids[0]));
-    memcpy ((void *)&(NAS_DL_EMM_PROTECTED_MSG (message_p).choice), &msg->security_protected.plain.emm, sizeof (EMM_msg));
-  } else {
-    if (msg->header.protocol_discriminator == EPS_SESSION_MANAGEMENT_MESSAGE) {
-      message_p = itti_alloc_new_message (TASK_ORIGIN, is_down_link ? NAS_DL_ESM_PROTECTED_MSG : NAS_UL_ESM_PROTECTED_MSG);
-      memcpy ((void *)&(NAS_DL_ESM_PROTECTED_MSG (message_p).header), &msg->header, sizeof (nas_message_security_header_t));
-      NAS_DL_ESM_PROTECTED_MSG (message_p).present = _nas_find_message_index (msg->security_protected.plain.esm.header.message_type, esm_message_ids, sizeof (esm_message_ids) / sizeof (esm_message_ids[0]));
-      memcpy ((void *)&(NAS_DL_ESM_PROTECTED_MSG (message_p).choice), &msg->security_protected.plain.esm, sizeof (ESM_msg));
-    }
-  }
-
-  if (message_p ) {
-    return itti_send_msg_to_task (TASK_UNKNOWN, INSTANCE_DEFAULT, message_p);
-  }
-
-  return EXIT_FAILURE;
-}
-
 //------------------------------------------------------------------------------
 int
 nas_itti_dl_data_req (
@@ -211,7 +46,7 @@ nas_itti_dl_data_req (
   NAS_DL_DATA_REQ (message_p).transaction_status = transaction_status;
   MSC_LOG_TX_MESSAGE (MSC_NAS_MME, MSC_S1AP_MME, NULL, 0, "0 NAS_DOWNLINK_DATA_REQ ue id " MME_UE_S1AP_ID_FMT " len %u", ue_id, blength(nas_msg));
   // make a long way by MME_APP instead of S1AP to retrieve the sctp_association_id key.
-  return itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  return itti_send_msg_to_task (MME_APP_TASK_ID(ue_id), INSTANCE_DEFAULT, message_p);
 }
 
 //------------------------------------------------------------------------------
@@ -290,7 +125,7 @@ void nas_itti_pdn_connectivity_req(
         "NAS_PDN_CONNECTIVITY_REQ ue id %06"PRIX32" IMSI %X",
         ue_idP, NAS_PDN_CONNECTIVITY_REQ(message_p).imsi);
 
-  itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  itti_send_msg_to_task(MME_APP_TASK_ID(ue_idP), INSTANCE_DEFAULT, message_p);
 
   OAILOG_FUNC_OUT(LOG_NAS);
 }
@@ -309,7 +144,8 @@ void nas_itti_auth_info_req(
   s6a_auth_info_req_t                    *auth_info_req = NULL;
 
 
-  message_p = itti_alloc_new_message (TASK_NAS_MME, S6A_AUTH_INFO_REQ);
+  // the S6A task answers to the originating task, i.e. the NAS worker owning this UE
+  message_p = itti_alloc_new_message (NAS_MME_TASK_ID(ue_idP), S6A_AUTH_INFO_REQ);
   auth_info_req = &message_p->ittiMsg.s6a_auth_info_req;
   memset(auth_info_req, 0, sizeof(s6a_auth_info_req_t));
 
@@ -374,7 +210,7 @@ void nas_itti_establish_rej(
         "NAS_AUTHENTICATION_PARAM_REQ ue id %06"PRIX32" IMSI %s (establish reject)",
         ue_idP, NAS_AUTHENTICATION_PARAM_REQ(message_p).imsi);
 
-  itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  itti_send_msg_to_task(MME_APP_TASK_ID(ue_idP), INSTANCE_DEFAULT, message_p);
   OAILOG_FUNC_OUT(LOG_NAS);
 }
 
@@ -429,7 +265,7 @@ void nas_itti_establish_cnf(
         "NAS_CONNECTION_ESTABLISHMENT_CNF ue id %06"PRIX32" len %u sea %x sia %x ",
         ue_idP, blength(msgP), selected_encryption_algorithmP, selected_integrity_algorithmP);
 
-    itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+    itti_send_msg_to_task(MME_APP_TASK_ID(ue_idP), INSTANCE_DEFAULT, message_p);
   }
 
   OAILOG_FUNC_OUT(LOG_NAS);
@@ -456,6 +292,38 @@ void nas_itti_detach_req(
                 "0 NAS_DETACH_REQ ue id %06"PRIX32" ",
           ue_idP);
 
-  itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  itti_send_msg_to_task(MME_APP_TASK_ID(ue_idP), INSTANCE_DEFAULT, message_p);
+  OAILOG_FUNC_OUT(LOG_NAS);
+}
+
+//------------------------------------------------------------------------------
+void nas_itti_paging_req(
+  const paging_req_t * const paging_reqP)
+{
+  OAILOG_FUNC_IN(LOG_NAS);
+  MessageDef *message_p;
+
+  message_p = itti_alloc_new_message(TASK_NAS_MME, S1AP_PAGING_REQUEST);
+  memset(&message_p->ittiMsg.s1ap_paging_request,
+         0,
+         sizeof(itti_s1ap_paging_request_t));
+
+  S1AP_PAGING_REQUEST(message_p).mme_ue_s1ap_id   = paging_reqP->ue_id;
+  S1AP_PAGING_REQUEST(message_p).imsi64           = paging_reqP->imsi64;
+  S1AP_PAGING_REQUEST(message_p).is_imsi_paging   = paging_reqP->is_imsi_paging;
+  S1AP_PAGING_REQUEST(message_p).mme_code         = paging_reqP->s_tmsi.mme_code;
+  S1AP_PAGING_REQUEST(message_p).m_tmsi           = paging_reqP->s_tmsi.m_tmsi;
+  S1AP_PAGING_REQUEST(message_p).cn_domain        = (AS_CS == paging_reqP->cn_domain) ? S1AP_CN_DOMAIN_CS : S1AP_CN_DOMAIN_PS;
+  S1AP_PAGING_REQUEST(message_p).last_visited_tai = paging_reqP->last_visited_tai;
+  S1AP_PAGING_REQUEST(message_p).tai_list         = paging_reqP->tai_list;
+
+  MSC_LOG_TX_MESSAGE(
+                MSC_NAS_MME,
+                MSC_S1AP_MME,
+                NULL,0,
+                "0 S1AP_PAGING_REQUEST ue id %06"PRIX32" ",
+          paging_reqP->ue_id);
+
+  itti_send_msg_to_task(TASK_S1AP, INSTANCE_DEFAULT, message_p);
   OAILOG_FUNC_OUT(LOG_NAS);
 }
@@ -32,19 +32,6 @@
 #include "3gpp_24.301.h"
 #include "esm_proc.h"
 
-int nas_itti_plain_msg(
-  const char          *buffer,
-  const nas_message_t *msg,
-  const size_t         lengthP,
-  const bool           is_down_link);
-
-int nas_itti_protected_msg(
-  const char          *buffer,
-  const nas_message_t *msg,
-  const size_t         lengthP,
-  const bool           is_down_link);
-
-
 int nas_itti_dl_data_req(
   const mme_ue_s1ap_id_t ue_idP,
   bstring                nas_msgP,
@@ -80,5 +67,8 @@ void nas_itti_establish_cnf(
 void nas_itti_detach_req(
   const uint32_t      ue_idP);
 
+void nas_itti_paging_req(
+  const paging_req_t * const paging_reqP);
+
 
 #endif /* FILE_NAS_ITTI_MESSAGING_SEEN */
@@ -34,20 +34,24 @@
 #include "nas_proc.h"
 #include "emm_main.h"
 #include "nas_timer.h"
+#include "nas_trace.h"
 
 static void nas_exit(void);
 
 //------------------------------------------------------------------------------
 static void *nas_intertask_interface (void *args_p)
 {
-  itti_mark_task_ready (TASK_NAS_MME);
+  const int                               worker_index = (int)(intptr_t)args_p;
+  const task_id_t                         task_id = TASK_NAS_MME + worker_index;
+
+  itti_mark_task_ready (task_id);
   OAILOG_START_USE ();
   MSC_START_USE ();
 
   while (1) {
     MessageDef                             *received_message_p = NULL;
 
-    itti_receive_msg (TASK_NAS_MME, &received_message_p);
+    itti_receive_msg (task_id, &received_message_p);
 
     switch (ITTI_MSG_ID (received_message_p)) {
     case NAS_INITIAL_UE_MESSAGE:{
@@ -118,7 +122,10 @@ static void *nas_intertask_interface (void *args_p)
       break;
 
     case TERMINATE_MESSAGE:{
-        nas_exit();
+        // NAS data is shared by all workers, worker 0 releases it.
+        if (0 == worker_index) {
+          nas_exit();
+        }
         itti_exit_task ();
       }
       break;
@@ -146,11 +153,15 @@ int nas_init (mme_config_t * mme_config_p)
 {
   OAILOG_DEBUG (LOG_NAS, "Initializing NAS task interface\n");
   nas_network_initialize (mme_config_p);
-
-  if (itti_create_task (TASK_NAS_MME, &nas_intertask_interface, NULL) < 0) {
-    OAILOG_ERROR (LOG_NAS, "Create task failed");
-    OAILOG_DEBUG (LOG_NAS, "Initializing NAS task interface: FAILED\n");
-    return -1;
+  nas_trace_init (mme_config_p);
+
+  // One NAS task per MME_APP worker, a UE is handled by the pair sharing its worker index.
+  for (int i = 0; i < mme_config_p->num_app_workers; i++) {
+    if (itti_create_task (TASK_NAS_MME + i, &nas_intertask_interface, (void *)(intptr_t)i) < 0) {
+      OAILOG_ERROR (LOG_NAS, "Create task %d failed", i);
+      OAILOG_DEBUG (LOG_NAS, "Initializing NAS task interface: FAILED\n");
+      return -1;
+    }
   }
 
   OAILOG_DEBUG (LOG_NAS, "Initializing NAS task interface: DONE\n");
@@ -0,0 +1,1187 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file db_cache.c
+   \brief In-memory subscriber cache in front of the MySQL database.
+   Subscriber static data (K, OPc, AMBR, MSISDN, access restriction, APN
+   configuration) is loaded in bulk at startup and kept for a configurable
+   time to live, so that AIR/ULR procedures do not hit the database.
+   SQN/RAND updates are applied to the cache and written behind to the
+   database in batches by a flusher thread.
+*/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include <mysql/mysql.h>
+
+#include "hss_config.h"
+#include "db_proto.h"
+#include "log.h"
+
+/* Must be powers of 2 */
+#define HSS_CACHE_BUCKETS           (1 << 16)
+#define HSS_CACHE_LOCK_STRIPES      (64)
+
+/* Maximum number of UPDATE statements sent in one multi-statement query */
+#define HSS_CACHE_FLUSH_BATCH       (64)
+#define HSS_CACHE_FLUSH_STMT_MAX    (192)
+
+/* Same limit as hss_mysql_query_pdns() */
+#define HSS_CACHE_PDN_MAX           (10)
+
+typedef struct hss_cache_entry_s {
+  struct hss_cache_entry_s *next;
+
+  uint64_t       imsi_key;
+  time_t         load_time;
+
+  /* Authentication data, SQN/RAND are authoritative while dirty is set,
+   * dirty is only cleared once the database has committed the last update */
+  uint8_t        key[KEY_LENGTH];
+  uint8_t        opc[KEY_LENGTH];
+  uint8_t        rand[RAND_LENGTH];
+  uint64_t       sqn;
+  int            dirty;
+  uint32_t       generation;    /* bumped on each SQN/RAND update */
+
+  /* Location data, imsi field is the key in string form */
+  mysql_ul_ans_t ul;
+  char           imei[IMEI_LENGTH_MAX + 1];
+  char           software_version[2 + 1];
+  int            purged;
+
+  mysql_pdn_t   *pdns;
+  uint8_t        nb_pdns;
+} hss_cache_entry_t;
+
+typedef struct hss_cache_dirty_s {
+  struct hss_cache_dirty_s *next;
+  char                      imsi[IMSI_LENGTH_MAX + 1];
+} hss_cache_dirty_t;
+
+/* A statement of a flush batch, with the generation of SQN/RAND it writes */
+typedef struct hss_cache_flushed_s {
+  char                      imsi[IMSI_LENGTH_MAX + 1];
+  uint32_t                  generation;
+} hss_cache_flushed_t;
+
+typedef struct hss_cache_s {
+  int                 enabled;
+  int                 ttl;
+  int                 flush_interval_ms;
+
+  hss_cache_entry_t **buckets;
+  pthread_mutex_t     locks[HSS_CACHE_LOCK_STRIPES];
+
+  /* Write-behind queue of IMSIs whose SQN/RAND must be flushed */
+  pthread_mutex_t     dirty_mutex;
+  hss_cache_dirty_t  *dirty_head;
+
+  /* Serializes the batches and the synchronous write-backs, so that a batch
+   * never overwrites a newer SQN written back by an invalidation */
+  pthread_mutex_t     flush_mutex;
+
+  pthread_t           flusher;
+  volatile int        running;
+
+  /* Statistics */
+  uint64_t            hits;
+  uint64_t            misses;
+  uint64_t            flushed;
+} hss_cache_t;
+
+static hss_cache_t hss_cache = {0};
+
+static int hss_cache_execute (const char *query);
+static int hss_cache_flush_locked (void);
+
+/*
+ * IMSI strings are turned into a 64 bit key, the number of digits is kept in
+ * the upper byte so that IMSIs with leading zeros do not collide.
+ */
+int
+hss_imsi_to_key (
+  const char *imsi,
+  uint64_t * key_p)
+{
+  uint64_t                                value = 0;
+  int                                     length = 0;
+
+  if (imsi == NULL) {
+    return EINVAL;
+  }
+
+  for (length = 0; imsi[length] != '\0'; length++) {
+    if ((imsi[length] < '0') || (imsi[length] > '9') || (length >= IMSI_LENGTH_MAX)) {
+      return EINVAL;
+    }
+
+    value = value * 10 + (imsi[length] - '0');
+  }
+
+  if (length == 0) {
+    return EINVAL;
+  }
+
+  *key_p = ((uint64_t) length << 56) | value;
+  return 0;
+}
+
+static inline unsigned int
+hss_cache_bucket (
+  uint64_t key)
+{
+  return (unsigned int)((key * 0x9E3779B97F4A7C15ULL) >> 48) & (HSS_CACHE_BUCKETS - 1);
+}
+
+static inline pthread_mutex_t *
+hss_cache_lock (
+  unsigned int bucket)
+{
+  return &hss_cache.locks[bucket & (HSS_CACHE_LOCK_STRIPES - 1)];
+}
+
+static inline int
+hss_cache_expired (
+  const hss_cache_entry_t * entry,
+  time_t now)
+{
+  /*
+   * A dirty entry holds the only valid copy of SQN, it expires after flush.
+   */
+  return (!entry->dirty) && ((now - entry->load_time) >= hss_cache.ttl);
+}
+
+/* Called with the bucket lock held */
+static hss_cache_entry_t *
+hss_cache_find (
+  unsigned int bucket,
+  uint64_t key)
+{
+  hss_cache_entry_t                      *entry = hss_cache.buckets[bucket];
+
+  while ((entry != NULL) && (entry->imsi_key != key)) {
+    entry = entry->next;
+  }
+
+  return entry;
+}
+
+static void
+hss_cache_free_entry (
+  hss_cache_entry_t * entry)
+{
+  if (entry->pdns) {
+    free (entry->pdns);
+  }
+
+  free (entry);
+}
+
+static void
+hss_cache_sqn_to_buffer (
+  uint64_t sqn,
+  uint8_t * sqn_p)
+{
+  sqn_p[0] = (sqn & (255UL << 40)) >> 40;
+  sqn_p[1] = (sqn & (255UL << 32)) >> 32;
+  sqn_p[2] = (sqn & (255UL << 24)) >> 24;
+  sqn_p[3] = (sqn & (255UL << 16)) >> 16;
+  sqn_p[4] = (sqn & (255UL << 8)) >> 8;
+  sqn_p[5] = (sqn & 0xFF);
+}
+
+static uint64_t
+hss_cache_buffer_to_sqn (
+  const uint8_t * sqn_p)
+{
+  return ((uint64_t) sqn_p[0] << 40) | ((uint64_t) sqn_p[1] << 32) | ((uint64_t) sqn_p[2] << 24) |
+    ((uint64_t) sqn_p[3] << 16) | ((uint64_t) sqn_p[4] << 8) | sqn_p[5];
+}
+
+/*
+ * Queue the IMSI for write-behind, called with the bucket lock held.
+ */
+static int
+hss_cache_queue_dirty (
+  const hss_cache_entry_t * entry)
+{
+  hss_cache_dirty_t                      *dirty = malloc (sizeof (hss_cache_dirty_t));
+
+  if (dirty == NULL) {
+    FPRINTF_ERROR ("Failed to queue SQN write-behind for IMSI %s\n", entry->ul.imsi);
+    return ENOMEM;
+  }
+
+  strcpy (dirty->imsi, entry->ul.imsi);
+  pthread_mutex_lock (&hss_cache.dirty_mutex);
+  dirty->next = hss_cache.dirty_head;
+  hss_cache.dirty_head = dirty;
+  pthread_mutex_unlock (&hss_cache.dirty_mutex);
+  return 0;
+}
+
+/*
+ * Record an SQN/RAND update, called with the bucket lock held. An entry
+ * already dirty is queued already, or in a batch being flushed that will
+ * requeue it when it sees the newer generation.
+ */
+static void
+hss_cache_mark_dirty (
+  hss_cache_entry_t * entry)
+{
+  entry->generation++;
+
+  if (entry->dirty) {
+    return;
+  }
+
+  /*
+   * SQN will be resynchronized by the UE (AUTS) if this update is lost
+   */
+  if (hss_cache_queue_dirty (entry) == 0) {
+    entry->dirty = 1;
+  }
+}
+
+/*
+ * Insert a freshly loaded entry. An entry already present is replaced except
+ * when keep_existing is set (bulk load, first row wins), SQN/RAND of a dirty
+ * entry are carried over since the database copy is stale.
+ */
+static void
+hss_cache_insert (
+  hss_cache_entry_t * entry,
+  int keep_existing)
+{
+  unsigned int                            bucket = hss_cache_bucket (entry->imsi_key);
+  hss_cache_entry_t                     **prev_p = NULL;
+  hss_cache_entry_t                      *old = NULL;
+
+  pthread_mutex_lock (hss_cache_lock (bucket));
+
+  for (prev_p = &hss_cache.buckets[bucket]; *prev_p != NULL; prev_p = &(*prev_p)->next) {
+    if ((*prev_p)->imsi_key == entry->imsi_key) {
+      old = *prev_p;
+      break;
+    }
+  }
+
+  if (old == NULL) {
+    entry->next = hss_cache.buckets[bucket];
+    hss_cache.buckets[bucket] = entry;
+  } else if (keep_existing) {
+    pthread_mutex_unlock (hss_cache_lock (bucket));
+    hss_cache_free_entry (entry);
+    return;
+  } else {
+    if (old->dirty) {
+      memcpy (entry->rand, old->rand, RAND_LENGTH);
+      entry->sqn = old->sqn;
+      entry->dirty = 1;
+      entry->generation = old->generation;
+    }
+
+    entry->next = old->next;
+    *prev_p = entry;
+    hss_cache_free_entry (old);
+  }
+
+  pthread_mutex_unlock (hss_cache_lock (bucket));
+}
+
+#define HSS_CACHE_USERS_QUERY                                                          \
+  "SELECT `users`.`imsi`,`users`.`key`,`users`.`sqn`,`users`.`rand`,`users`.`OPc`,"    \
+  "`users`.`access_restriction`,`users`.`msisdn`,`users`.`ue_ambr_ul`,"                \
+  "`users`.`ue_ambr_dl`,`users`.`rau_tau_timer`,`users`.`ms_ps_status`,"               \
+  "`users`.`imei`,`mmeidentity`.`mmehost`,`mmeidentity`.`mmerealm` "                  \
+  "FROM `users` LEFT JOIN `mmeidentity` ON "                                           \
+  "`users`.`mmeidentity_idmmeidentity`=`mmeidentity`.`idmmeidentity` "
+
+static hss_cache_entry_t *
+hss_cache_entry_from_row (
+  MYSQL_ROW row,
+  unsigned long *lengths,
+  time_t now)
+{
+  hss_cache_entry_t                      *entry = NULL;
+
+  if ((row[0] == NULL) || (row[1] == NULL) || (row[2] == NULL) || (row[3] == NULL) || (row[4] == NULL)) {
+    return NULL;
+  }
+
+  /*
+   * Binary columns are copied as is, a short one would be read past its end
+   */
+  if ((lengths[1] != KEY_LENGTH) || (lengths[3] != RAND_LENGTH) || (lengths[4] != KEY_LENGTH)) {
+    FPRINTF_ERROR ("IMSI %s: bad key/rand/OPc length %lu/%lu/%lu, not cached\n", row[0], lengths[1], lengths[3], lengths[4]);
+    return NULL;
+  }
+
+  entry = calloc (1, sizeof (hss_cache_entry_t));
+
+  if (entry == NULL) {
+    return NULL;
+  }
+
+  if ((lengths[0] > IMSI_LENGTH_MAX) || (hss_imsi_to_key (row[0], &entry->imsi_key) != 0)) {
+    free (entry);
+    return NULL;
+  }
+
+  entry->load_time = now;
+  memcpy (entry->ul.imsi, row[0], lengths[0]);
+  memcpy (entry->key, row[1], KEY_LENGTH);
+  entry->sqn = strtoull (row[2], NULL, 10);
+  memcpy (entry->rand, row[3], RAND_LENGTH);
+  memcpy (entry->opc, row[4], KEY_LENGTH);
+  entry->ul.access_restriction = (row[5] != NULL) ? atoi (row[5]) : 0;
+
+  if ((row[6] != NULL) && (lengths[6] < sizeof (entry->ul.msisdn))) {
+    memcpy (entry->ul.msisdn, row[6], lengths[6]);
+  }
+
+  entry->ul.aggr_ul = (row[7] != NULL) ? atoi (row[7]) : 0;
+  entry->ul.aggr_dl = (row[8] != NULL) ? atoi (row[8]) : 0;
+  entry->ul.rau_tau = (row[9] != NULL) ? atoi (row[9]) : 0;
+  entry->purged = (row[10] == NULL) || (strcmp (row[10], "PURGED") == 0);
+
+  if ((row[11] != NULL) && (lengths[11] <= IMEI_LENGTH_MAX)) {
+    memcpy (entry->imei, row[11], lengths[11]);
+  }
+
+  if ((row[12] != NULL) && (lengths[12] < sizeof (entry->ul.mme_identity.mme_host))) {
+    memcpy (entry->ul.mme_identity.mme_host, row[12], lengths[12]);
+  }
+
+  if ((row[13] != NULL) && (lengths[13] < sizeof (entry->ul.mme_identity.mme_realm))) {
+    memcpy (entry->ul.mme_identity.mme_realm, row[13], lengths[13]);
+  }
+
+  return entry;
+}
+
+/*
+ * Load one subscriber from the database and insert it in the cache.
+ */
+static int
+hss_cache_fetch (
+  const char *imsi)
+{
+  MYSQL_RES                              *res = NULL;
+  MYSQL_ROW                               row;
+  char                                    query[1000];
+  hss_cache_entry_t                      *entry = NULL;
+
+  if (db_desc->db_conn == NULL) {
+    return EINVAL;
+  }
+
+  sprintf (query, HSS_CACHE_USERS_QUERY "WHERE `users`.`imsi`='%s' LIMIT 1", imsi);
+  FPRINTF_DEBUG ("Query: %s\n", query);
+  pthread_mutex_lock (&db_desc->db_cs_mutex);
+
+  if (mysql_query (db_desc->db_conn, query)) {
+    pthread_mutex_unlock (&db_desc->db_cs_mutex);
+    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+    return EINVAL;
+  }
+
+  res = mysql_store_result (db_desc->db_conn);
+  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+
+  if (res == NULL)
+    return EINVAL;
+
+  if ((row = mysql_fetch_row (res)) != NULL) {
+    entry = hss_cache_entry_from_row (row, mysql_fetch_lengths (res), time (NULL));
+  }
+
+  mysql_free_result (res);
+
+  if (entry == NULL) {
+    return EINVAL;
+  }
+
+  /*
+   * A subscriber without APN is still known, ULR will answer accordingly
+   */
+  if (hss_mysql_query_pdns (imsi, &entry->pdns, &entry->nb_pdns) != 0) {
+    entry->pdns = NULL;
+    entry->nb_pdns = 0;
+  }
+
+  __sync_fetch_and_add (&hss_cache.misses, 1);
+  hss_cache_insert (entry, 0);
+  return 0;
+}
+
+/*
+ * Returns the cached entry for the IMSI, loading it if needed, with the bucket
+ * lock held. The caller releases the lock returned in lock_pp.
+ */
+static hss_cache_entry_t *
+hss_cache_acquire (
+  const char *imsi,
+  pthread_mutex_t ** lock_pp)
+{
+  uint64_t                                key = 0;
+  unsigned int                            bucket = 0;
+  hss_cache_entry_t                      *entry = NULL;
+
+  if (hss_imsi_to_key (imsi, &key) != 0) {
+    return NULL;
+  }
+
+  bucket = hss_cache_bucket (key);
+  *lock_pp = hss_cache_lock (bucket);
+  pthread_mutex_lock (*lock_pp);
+  entry = hss_cache_find (bucket, key);
+
+  if ((entry != NULL) && !hss_cache_expired (entry, time (NULL))) {
+    __sync_fetch_and_add (&hss_cache.hits, 1);
+    return entry;
+  }
+
+  pthread_mutex_unlock (*lock_pp);
+
+  if (hss_cache_fetch (imsi) != 0) {
+    return NULL;
+  }
+
+  pthread_mutex_lock (*lock_pp);
+  entry = hss_cache_find (bucket, key);
+
+  if (entry == NULL) {
+    pthread_mutex_unlock (*lock_pp);
+  }
+
+  return entry;
+}
+
+/*
+ * Bulk load of the users and pdn tables.
+ */
+int
+hss_cache_prewarm (
+  void)
+{
+  MYSQL_RES                              *res = NULL;
+  MYSQL_ROW                               row;
+  time_t                                  now = time (NULL);
+  int                                     nb_users = 0;
+  int                                     nb_pdns = 0;
+
+  if (!hss_cache.enabled) {
+    return 0;
+  }
+
+  if (db_desc->db_conn == NULL) {
+    return EINVAL;
+  }
+
+  FPRINTF_DEBUG ("Query: %s\n", HSS_CACHE_USERS_QUERY);
+  pthread_mutex_lock (&db_desc->db_cs_mutex);
+
+  if (mysql_query (db_desc->db_conn, HSS_CACHE_USERS_QUERY)) {
+    pthread_mutex_unlock (&db_desc->db_cs_mutex);
+    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+    return EINVAL;
+  }
+
+  /*
+   * Rows are streamed, the database lock is held until the whole result is read
+   */
+  res = mysql_use_result (db_desc->db_conn);
+
+  if (res == NULL) {
+    pthread_mutex_unlock (&db_desc->db_cs_mutex);
+    return EINVAL;
+  }
+
+  while ((row = mysql_fetch_row (res)) != NULL) {
+    hss_cache_entry_t                      *entry = hss_cache_entry_from_row (row, mysql_fetch_lengths (res), now);
+
+    if (entry != NULL) {
+      hss_cache_insert (entry, 1);
+      nb_users++;
+    }
+  }
+
+  mysql_free_result (res);
+
+  FPRINTF_DEBUG ("Query: SELECT * FROM `pdn`\n");
+
+  if (mysql_query (db_desc->db_conn, "SELECT * FROM `pdn`")) {
+    pthread_mutex_unlock (&db_desc->db_cs_mutex);
+    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+    return EINVAL;
+  }
+
+  res = mysql_use_result (db_desc->db_conn);
+
+  if (res == NULL) {
+    pthread_mutex_unlock (&db_desc->db_cs_mutex);
+    return EINVAL;
+  }
+
+  while ((row = mysql_fetch_row (res)) != NULL) {
+    unsigned long                          *lengths = mysql_fetch_lengths (res);
+    hss_cache_entry_t                      *entry = NULL;
+    mysql_pdn_t                            *pdns = NULL;
+    uint64_t                                key = 0;
+    unsigned int                            bucket = 0;
+
+    if ((row[8] == NULL) || (hss_imsi_to_key (row[8], &key) != 0)) {
+      continue;
+    }
+
+    bucket = hss_cache_bucket (key);
+    pthread_mutex_lock (hss_cache_lock (bucket));
+    entry = hss_cache_find (bucket, key);
+
+    if ((entry != NULL) && (entry->nb_pdns < HSS_CACHE_PDN_MAX)) {
+      pdns = realloc (entry->pdns, (entry->nb_pdns + 1) * sizeof (mysql_pdn_t));
+
+      if (pdns != NULL) {
+        hss_mysql_pdn_from_row (row, lengths, &pdns[entry->nb_pdns]);
+        entry->pdns = pdns;
+        entry->nb_pdns += 1;
+        nb_pdns++;
+      }
+    }
+
+    pthread_mutex_unlock (hss_cache_lock (bucket));
+  }
+
+  mysql_free_result (res);
+  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+  FPRINTF_NOTICE ("Subscriber cache prewarmed with %d users, %d PDNs\n", nb_users, nb_pdns);
+  return 0;
+}
+
+/*
+ * Once a batch is committed, clear the entries it wrote unless they were
+ * updated meanwhile. Those, and all of a failed batch, are queued again and
+ * their current SQN/RAND go in a later batch. Entries stay dirty until then,
+ * so they are never reloaded from the stale database copy.
+ */
+static void
+hss_cache_flush_done (
+  const hss_cache_flushed_t * batch,
+  int nb_stmt,
+  int committed)
+{
+  int                                     i;
+
+  for (i = 0; i < nb_stmt; i++) {
+    hss_cache_entry_t                      *entry = NULL;
+    uint64_t                                key = 0;
+    unsigned int                            bucket = 0;
+
+    if (hss_imsi_to_key (batch[i].imsi, &key) != 0) {
+      continue;
+    }
+
+    bucket = hss_cache_bucket (key);
+    pthread_mutex_lock (hss_cache_lock (bucket));
+    entry = hss_cache_find (bucket, key);
+
+    if ((entry != NULL) && entry->dirty) {
+      if (committed && (entry->generation == batch[i].generation)) {
+        entry->dirty = 0;
+      } else {
+        /*
+         * Left dirty if it cannot be queued, written back on invalidation
+         */
+        hss_cache_queue_dirty (entry);
+      }
+    }
+
+    pthread_mutex_unlock (hss_cache_lock (bucket));
+  }
+}
+
+/*
+ * Take the IMSIs of the write-behind queue and send their SQN/RAND to the
+ * database, HSS_CACHE_FLUSH_BATCH UPDATE statements per query.
+ */
+int
+hss_cache_flush (
+  void)
+{
+  int                                     ret = 0;
+
+  pthread_mutex_lock (&hss_cache.flush_mutex);
+  ret = hss_cache_flush_locked ();
+  pthread_mutex_unlock (&hss_cache.flush_mutex);
+  return ret;
+}
+
+/* Called with the flush mutex held */
+static int
+hss_cache_flush_locked (
+  void)
+{
+  hss_cache_dirty_t                      *dirty = NULL;
+  hss_cache_flushed_t                     batch[HSS_CACHE_FLUSH_BATCH];
+  char                                   *query = NULL;
+  int                                     query_length = 0;
+  int                                     nb_stmt = 0;
+  int                                     ret = 0;
+  int                                     i;
+
+  pthread_mutex_lock (&hss_cache.dirty_mutex);
+  dirty = hss_cache.dirty_head;
+  hss_cache.dirty_head = NULL;
+  pthread_mutex_unlock (&hss_cache.dirty_mutex);
+
+  if (dirty == NULL) {
+    return 0;
+  }
+
+  query = malloc (HSS_CACHE_FLUSH_BATCH * HSS_CACHE_FLUSH_STMT_MAX);
+
+  if (query == NULL) {
+    /*
+     * Put the queue back, retried on next flush
+     */
+    hss_cache_dirty_t                      *last = dirty;
+
+    while (last->next != NULL) {
+      last = last->next;
+    }
+
+    pthread_mutex_lock (&hss_cache.dirty_mutex);
+    last->next = hss_cache.dirty_head;
+    hss_cache.dirty_head = dirty;
+    pthread_mutex_unlock (&hss_cache.dirty_mutex);
+    return ENOMEM;
+  }
+
+  while (dirty != NULL) {
+    hss_cache_dirty_t                      *next = dirty->next;
+    hss_cache_entry_t                      *entry = NULL;
+    uint64_t                                key = 0;
+    unsigned int                            bucket = 0;
+
+    if (hss_imsi_to_key (dirty->imsi, &key) == 0) {
+      bucket = hss_cache_bucket (key);
+      pthread_mutex_lock (hss_cache_lock (bucket));
+      entry = hss_cache_find (bucket, key);
+
+      /*
+       * Invalidated entries have been written back synchronously
+       */
+      if ((entry != NULL) && entry->dirty) {
+        query_length += sprintf (&query[query_length], "UPDATE `users` SET `rand`=UNHEX('");
+
+        for (i = 0; i < RAND_LENGTH; i++) {
+          query_length += sprintf (&query[query_length], "%02x", entry->rand[i]);
+        }
+
+        query_length += sprintf (&query[query_length], "'),`sqn`=%" PRIu64 " WHERE `users`.`imsi`='%s';", entry->sqn, entry->ul.imsi);
+        strcpy (batch[nb_stmt].imsi, entry->ul.imsi);
+        batch[nb_stmt++].generation = entry->generation;
+      }
+
+      pthread_mutex_unlock (hss_cache_lock (bucket));
+    }
+
+    free (dirty);
+    dirty = next;
+
+    if ((nb_stmt == HSS_CACHE_FLUSH_BATCH) || ((dirty == NULL) && (nb_stmt > 0))) {
+      if (hss_cache_execute (query) != 0) {
+        /*
+         * Requeue the batch, the database may come back
+         */
+        hss_cache_flush_done (batch, nb_stmt, 0);
+        ret = EINVAL;
+      } else {
+        hss_cache_flush_done (batch, nb_stmt, 1);
+        __sync_fetch_and_add (&hss_cache.flushed, nb_stmt);
+      }
+
+      nb_stmt = 0;
+      query_length = 0;
+    }
+  }
+
+  free (query);
+  return ret;
+}
+
+static int
+hss_cache_execute (
+  const char *query)
+{
+  MYSQL_RES                              *res = NULL;
+  int                                     status = 0;
+  int                                     ret = 0;
+
+  if (db_desc->db_conn == NULL) {
+    return EINVAL;
+  }
+
+  FPRINTF_DEBUG ("Query: %s\n", query);
+  pthread_mutex_lock (&db_desc->db_cs_mutex);
+
+  if (mysql_query (db_desc->db_conn, query)) {
+    pthread_mutex_unlock (&db_desc->db_cs_mutex);
+    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+    return EINVAL;
+  }
+
+  /*
+   * process each statement result, the statements after a failed one are not
+   * executed and the whole batch is reported failed
+   */
+  do {
+    res = mysql_store_result (db_desc->db_conn);
+
+    if (res) {
+      mysql_free_result (res);
+    } else if (mysql_field_count (db_desc->db_conn) != 0) {
+      FPRINTF_ERROR ("Could not retrieve result set: %s\n", mysql_error (db_desc->db_conn));
+      ret = EINVAL;
+    }
+
+    /*
+     * more results? -1 = no, >0 = error, 0 = yes (keep looping)
+     */
+    if ((status = mysql_next_result (db_desc->db_conn)) > 0) {
+      FPRINTF_ERROR ("Could not execute statement: %s\n", mysql_error (db_desc->db_conn));
+      ret = EINVAL;
+    }
+  } while (status == 0);
+
+  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+  return ret;
+}
+
+static void *
+hss_cache_flusher (
+  void *arg)
+{
+  mysql_thread_init ();
+
+  while (hss_cache.running) {
+    usleep (hss_cache.flush_interval_ms * 1000);
+    hss_cache_flush ();
+  }
+
+  mysql_thread_end ();
+  return NULL;
+}
+
+int
+hss_cache_init (
+  const hss_config_t * hss_config_p)
+{
+  int                                     i;
+
+  memset (&hss_cache, 0, sizeof (hss_cache));
+
+  if (hss_config_p->subscriber_cache_ttl <= 0) {
+    FPRINTF_NOTICE ("Subscriber cache disabled\n");
+    return 0;
+  }
+
+  hss_cache.ttl = hss_config_p->subscriber_cache_ttl;
+  hss_cache.flush_interval_ms = hss_config_p->subscriber_cache_flush_ms;
+  hss_cache.buckets = calloc (HSS_CACHE_BUCKETS, sizeof (hss_cache_entry_t *));
+
+  if (hss_cache.buckets == NULL) {
+    FPRINTF_ERROR ("Failed to allocate subscriber cache\n");
+    return ENOMEM;
+  }
+
+  for (i = 0; i < HSS_CACHE_LOCK_STRIPES; i++) {
+    pthread_mutex_init (&hss_cache.locks[i], NULL);
+  }
+
+  pthread_mutex_init (&hss_cache.dirty_mutex, NULL);
+  pthread_mutex_init (&hss_cache.flush_mutex, NULL);
+  hss_cache.running = 1;
+
+  if (pthread_create (&hss_cache.flusher, NULL, hss_cache_flusher, NULL) != 0) {
+    FPRINTF_ERROR ("Failed to create subscriber cache flusher thread\n");
+    hss_cache.running = 0;
+    free (hss_cache.buckets);
+    hss_cache.buckets = NULL;
+    return EINVAL;
+  }
+
+  hss_cache.enabled = 1;
+  FPRINTF_NOTICE ("Subscriber cache enabled, TTL %d s, SQN flush every %d ms\n", hss_cache.ttl, hss_cache.flush_interval_ms);
+  return 0;
+}
+
+void
+hss_cache_exit (
+  void)
+{
+  if (!hss_cache.enabled) {
+    return;
+  }
+
+  hss_cache.running = 0;
+  pthread_join (hss_cache.flusher, NULL);
+  hss_cache_invalidate_all ();
+  FPRINTF_NOTICE ("Subscriber cache hits %" PRIu64 " misses %" PRIu64 " SQN flushed %" PRIu64 "\n", hss_cache.hits, hss_cache.misses, hss_cache.flushed);
+  free (hss_cache.buckets);
+  hss_cache.buckets = NULL;
+  hss_cache.enabled = 0;
+}
+
+/*
+ * Drop a subscriber from the cache, its SQN/RAND are written back first if
+ * they were not flushed yet.
+ */
+void
+hss_cache_invalidate (
+  const char *imsi)
+{
+  uint64_t                                key = 0;
+  unsigned int                            bucket = 0;
+  hss_cache_entry_t                     **prev_p = NULL;
+  hss_cache_entry_t                      *entry = NULL;
+
+  if (!hss_cache.enabled || (hss_imsi_to_key (imsi, &key) != 0)) {
+    return;
+  }
+
+  bucket = hss_cache_bucket (key);
+  pthread_mutex_lock (&hss_cache.flush_mutex);
+  pthread_mutex_lock (hss_cache_lock (bucket));
+
+  for (prev_p = &hss_cache.buckets[bucket]; *prev_p != NULL; prev_p = &(*prev_p)->next) {
+    if ((*prev_p)->imsi_key == key) {
+      entry = *prev_p;
+      *prev_p = entry->next;
+      break;
+    }
+  }
+
+  pthread_mutex_unlock (hss_cache_lock (bucket));
+
+  if (entry != NULL) {
+    if (entry->dirty) {
+      uint8_t                                 sqn[SQN_LENGTH];
+
+      hss_cache_sqn_to_buffer (entry->sqn, sqn);
+      hss_mysql_push_rand_sqn (entry->ul.imsi, entry->rand, sqn);
+    }
+
+    hss_cache_free_entry (entry);
+  }
+
+  pthread_mutex_unlock (&hss_cache.flush_mutex);
+}
+
+void
+hss_cache_invalidate_all (
+  void)
+{
+  unsigned int                            bucket;
+
+  if (!hss_cache.enabled) {
+    return;
+  }
+
+  /*
+   * Write back everything pending in one pass, then drop the entries
+   */
+  pthread_mutex_lock (&hss_cache.flush_mutex);
+  hss_cache_flush_locked ();
+
+  for (bucket = 0; bucket < HSS_CACHE_BUCKETS; bucket++) {
+    hss_cache_entry_t                      *entry = NULL;
+
+    pthread_mutex_lock (hss_cache_lock (bucket));
+    entry = hss_cache.buckets[bucket];
+    hss_cache.buckets[bucket] = NULL;
+    pthread_mutex_unlock (hss_cache_lock (bucket));
+
+    while (entry != NULL) {
+      hss_cache_entry_t                      *next = entry->next;
+
+      if (entry->dirty) {
+        uint8_t                                 sqn[SQN_LENGTH];
+
+        hss_cache_sqn_to_buffer (entry->sqn, sqn);
+        hss_mysql_push_rand_sqn (entry->ul.imsi, entry->rand, sqn);
+      }
+
+      hss_cache_free_entry (entry);
+      entry = next;
+    }
+  }
+
+  pthread_mutex_unlock (&hss_cache.flush_mutex);
+}
+
+int
+hss_cache_auth_info (
+  mysql_auth_info_req_t * auth_info_req,
+  mysql_auth_info_resp_t * auth_info_resp)
+{
+  hss_cache_entry_t                      *entry = NULL;
+  pthread_mutex_t                        *lock = NULL;
+
+  if (!hss_cache.enabled) {
+    return hss_mysql_auth_info (auth_info_req, auth_info_resp);
+  }
+
+  if ((auth_info_req == NULL) || (auth_info_resp == NULL)) {
+    return EINVAL;
+  }
+
+  if ((entry = hss_cache_acquire (auth_info_req->imsi, &lock)) == NULL) {
+    return EINVAL;
+  }
+
+  memcpy (auth_info_resp->key, entry->key, KEY_LENGTH);
+  memcpy (auth_info_resp->opc, entry->opc, KEY_LENGTH);
+  memcpy (auth_info_resp->rand, entry->rand, RAND_LENGTH);
+  hss_cache_sqn_to_buffer (entry->sqn, auth_info_resp->sqn);
+  pthread_mutex_unlock (lock);
+  return 0;
+}
+
+int
+hss_cache_push_rand_sqn (
+  const char *imsi,
+  uint8_t * rand_p,
+  uint8_t * sqn)
+{
+  hss_cache_entry_t                      *entry = NULL;
+  pthread_mutex_t                        *lock = NULL;
+
+  if (!hss_cache.enabled) {
+    return hss_mysql_push_rand_sqn (imsi, rand_p, sqn);
+  }
+
+  if (rand_p == NULL || sqn == NULL) {
+    return EINVAL;
+  }
+
+  if ((entry = hss_cache_acquire (imsi, &lock)) == NULL) {
+    return hss_mysql_push_rand_sqn (imsi, rand_p, sqn);
+  }
+
+  memcpy (entry->rand, rand_p, RAND_LENGTH);
+  entry->sqn = hss_cache_buffer_to_sqn (sqn);
+  hss_cache_mark_dirty (entry);
+  pthread_mutex_unlock (lock);
+  return 0;
+}
+
+int
+hss_cache_increment_sqn (
+  const char *imsi)
+{
+  hss_cache_entry_t                      *entry = NULL;
+  pthread_mutex_t                        *lock = NULL;
+
+  if (!hss_cache.enabled) {
+    return hss_mysql_increment_sqn (imsi);
+  }
+
+  if ((entry = hss_cache_acquire (imsi, &lock)) == NULL) {
+    return hss_mysql_increment_sqn (imsi);
+  }
+
+  /*
+   * + 32 = 2 ^ sizeof(IND) (see 3GPP TS. 33.102)
+   */
+  entry->sqn += 32;
+  hss_cache_mark_dirty (entry);
+  pthread_mutex_unlock (lock);
+  return 0;
+}
+
+int
+hss_cache_update_loc (
+  const char *imsi,
+  mysql_ul_ans_t * mysql_ul_ans)
+{
+  hss_cache_entry_t                      *entry = NULL;
+  pthread_mutex_t                        *lock = NULL;
+
+  if (!hss_cache.enabled) {
+    return hss_mysql_update_loc (imsi, mysql_ul_ans);
+  }
+
+  if ((mysql_ul_ans == NULL) || (imsi == NULL) || (strlen (imsi) > IMSI_LENGTH_MAX)) {
+    return EINVAL;
+  }
+
+  if ((entry = hss_cache_acquire (imsi, &lock)) == NULL) {
+    return EINVAL;
+  }
+
+  memcpy (mysql_ul_ans, &entry->ul, sizeof (mysql_ul_ans_t));
+  pthread_mutex_unlock (lock);
+  return 0;
+}
+
+/*
+ * The database is only updated when the serving MME or the terminal changed,
+ * or when the subscriber has been purged since the last location update.
+ */
+int
+hss_cache_push_up_loc (
+  mysql_ul_push_t * ul_push_p)
+{
+  hss_cache_entry_t                      *entry = NULL;
+  pthread_mutex_t                        *lock = NULL;
+  int                                     changed = 0;
+  int                                     ret = 0;
+
+  if (!hss_cache.enabled) {
+    return mysql_push_up_loc (ul_push_p);
+  }
+
+  if (ul_push_p == NULL) {
+    return EINVAL;
+  }
+
+  if ((entry = hss_cache_acquire (ul_push_p->imsi, &lock)) == NULL) {
+    return mysql_push_up_loc (ul_push_p);
+  }
+
+  if (ul_push_p->mme_identity_present == MME_IDENTITY_PRESENT) {
+    if (entry->purged ||
+        strcmp (entry->ul.mme_identity.mme_host, ul_push_p->mme_identity.mme_host) ||
+        strcmp (entry->ul.mme_identity.mme_realm, ul_push_p->mme_identity.mme_realm)) {
+      memcpy (&entry->ul.mme_identity, &ul_push_p->mme_identity, sizeof (mysql_mme_identity_t));
+      entry->purged = 0;
+      changed = 1;
+    }
+  }
+
+  if ((ul_push_p->imei_present == IMEI_PRESENT) && strcmp (entry->imei, ul_push_p->imei)) {
+    strcpy (entry->imei, ul_push_p->imei);
+    changed = 1;
+  }
+
+  if ((ul_push_p->sv_present == SV_PRESENT) && strncmp (entry->software_version, ul_push_p->software_version, 2)) {
+    memcpy (entry->software_version, ul_push_p->software_version, 2);
+    changed = 1;
+  }
+
+  pthread_mutex_unlock (lock);
+
+  if (changed) {
+    if ((ret = mysql_push_up_loc (ul_push_p)) != 0) {
+      /*
+       * Do not keep a view the database does not share
+       */
+      hss_cache_invalidate (ul_push_p->imsi);
+    }
+  }
+
+  return ret;
+}
+
+int
+hss_cache_purge_ue (
+  mysql_pu_req_t * mysql_pu_req,
+  mysql_pu_ans_t * mysql_pu_ans)
+{
+  int                                     ret = 0;
+
+  if ((ret = hss_mysql_purge_ue (mysql_pu_req, mysql_pu_ans)) != 0) {
+    return ret;
+  }
+
+  /*
+   * Reloaded from the database, purged, on the next request
+   */
+  hss_cache_invalidate (mysql_pu_req->imsi);
+  return 0;
+}
+
+/*
+ * Same contract as hss_mysql_query_pdns(), the returned array is owned by the
+ * caller.
+ */
+int
+hss_cache_query_pdns (
+  const char *imsi,
+  mysql_pdn_t ** pdns_p,
+  uint8_t * nb_pdns)
+{
+  hss_cache_entry_t                      *entry = NULL;
+  pthread_mutex_t                        *lock = NULL;
+
+  if (!hss_cache.enabled) {
+    return hss_mysql_query_pdns (imsi, pdns_p, nb_pdns);
+  }
+
+  if (nb_pdns == NULL || pdns_p == NULL) {
+    return EINVAL;
+  }
+
+  if ((entry = hss_cache_acquire (imsi, &lock)) == NULL) {
+    return EINVAL;
+  }
+
+  *pdns_p = NULL;
+  *nb_pdns = entry->nb_pdns;
+
+  if (entry->nb_pdns > 0) {
+    *pdns_p = malloc (entry->nb_pdns * sizeof (mysql_pdn_t));
+
+    if (*pdns_p == NULL) {
+      *nb_pdns = 0;
+      pthread_mutex_unlock (lock);
+      return ENOMEM;
+    }
+
+    memcpy (*pdns_p, entry->pdns, entry->nb_pdns * sizeof (mysql_pdn_t));
+  }
+
+  pthread_mutex_unlock (lock);
+  return (*nb_pdns == 0) ? EINVAL : 0;
+}
+
+const hss_db_backend_t                  hss_db_mysql = {
+  .name = "MySQL",
+  .auth_info = hss_cache_auth_info,
+  .push_rand_sqn = hss_cache_push_rand_sqn,
+  .increment_sqn = hss_cache_increment_sqn,
+  .update_loc = hss_cache_update_loc,
+  .push_up_loc = hss_cache_push_up_loc,
+  .purge_ue = hss_cache_purge_ue,
+  .query_pdns = hss_cache_query_pdns,
+  .check_epc_equipment = hss_mysql_check_epc_equipment,
+};
@@ -44,6 +44,8 @@ extern void                             ComputeOPc (
 
 database_t                             *db_desc;
 
+const hss_db_backend_t                 *hss_db = &hss_db_mysql;
+
 static void
 print_buffer (
   const char *prefix,
@@ -634,6 +636,7 @@ hss_mysql_check_opc_keys (
         if (mysql_query (db_desc->db_conn, update)) {
           FPRINTF_ERROR ( "Query execution failed: %s\n", mysql_error (db_desc->db_conn));
         } else {
+          hss_cache_invalidate (row[0]);
           printf ("IMSI %s Updated OPc ", (uint8_t *) row[0]);
 
           for (i = 0; i < KEY_LENGTH; i++) {
@@ -153,6 +153,7 @@ typedef struct mysql_pdn_s{
   prio_level_t  priority_level;
   pre_emp_cap_t pre_emp_cap;
   pre_emp_vul_t pre_emp_vul;
+  int           pgw_id;
 } mysql_pdn_t;
 
 typedef struct mysql_pu_req_s{
@@ -184,6 +185,10 @@ int hss_mysql_query_pdns(const char   *imsi,
                          mysql_pdn_t **pdns_p,
                          uint8_t      *nb_pdns);
 
+void hss_mysql_pdn_from_row(MYSQL_ROW      row,
+                            unsigned long *lengths,
+                            mysql_pdn_t   *pdn_elm);
+
 int hss_mysql_auth_info(mysql_auth_info_req_t  *auth_info_req,
                         mysql_auth_info_resp_t *auth_info_resp);
 
@@ -193,5 +198,101 @@ int hss_mysql_increment_sqn(const char *imsi);
 
 int hss_mysql_check_opc_keys(const uint8_t const opP[16]);
 
+/* Subscriber cache, same contracts as the hss_mysql_* functions above */
+int hss_cache_init(const hss_config_t *hss_config_p);
+
+void hss_cache_exit(void);
+
+int hss_cache_prewarm(void);
+
+int hss_cache_flush(void);
+
+void hss_cache_invalidate(const char *imsi);
+
+void hss_cache_invalidate_all(void);
+
+int hss_cache_auth_info(mysql_auth_info_req_t  *auth_info_req,
+                        mysql_auth_info_resp_t *auth_info_resp);
+
+int hss_cache_push_rand_sqn(const char *imsi, uint8_t *rand_p, uint8_t *sqn);
+
+int hss_cache_increment_sqn(const char *imsi);
+
+int hss_cache_update_loc(const char *imsi, mysql_ul_ans_t *mysql_ul_ans);
+
+int hss_cache_push_up_loc(mysql_ul_push_t *ul_push_p);
+
+int hss_cache_purge_ue(mysql_pu_req_t *mysql_pu_req,
+                       mysql_pu_ans_t *mysql_pu_ans);
+
+int hss_cache_query_pdns(const char   *imsi,
+                         mysql_pdn_t **pdns_p,
+                         uint8_t      *nb_pdns);
+
+/* IMSI string to 64 bit key, the number of digits is kept in the upper byte */
+int hss_imsi_to_key(const char *imsi, uint64_t *key_p);
+
+/* Embedded subscriber store, memory mapped file, same contracts as the hss_mysql_* functions above */
+int hss_store_init(const hss_config_t *hss_config_p);
+
+void hss_store_exit(void);
+
+int hss_store_import(const hss_config_t *hss_config_p);
+
+int hss_store_export(const hss_config_t *hss_config_p, const char *sql_file);
+
+int hss_store_build_begin(void);
+
+int hss_store_build_add_mme(const int id, const mysql_mme_identity_t *mme_identity_p);
+
+int hss_store_build_add_user(const mysql_auth_info_resp_t *auth_p,
+                             const mysql_ul_ans_t         *ul_p,
+                             const char                   *imei,
+                             const char                   *software_version,
+                             const int                     purged,
+                             const mysql_pdn_t            *pdns,
+                             const uint8_t                 nb_pdns);
+
+int hss_store_build_commit(const char *path);
+
+int hss_store_auth_info(mysql_auth_info_req_t  *auth_info_req,
+                        mysql_auth_info_resp_t *auth_info_resp);
+
+int hss_store_push_rand_sqn(const char *imsi, uint8_t *rand_p, uint8_t *sqn);
+
+int hss_store_increment_sqn(const char *imsi);
+
+int hss_store_update_loc(const char *imsi, mysql_ul_ans_t *mysql_ul_ans);
+
+int hss_store_push_up_loc(mysql_ul_push_t *ul_push_p);
+
+int hss_store_purge_ue(mysql_pu_req_t *mysql_pu_req,
+                       mysql_pu_ans_t *mysql_pu_ans);
+
+int hss_store_query_pdns(const char   *imsi,
+                         mysql_pdn_t **pdns_p,
+                         uint8_t      *nb_pdns);
+
+int hss_store_check_epc_equipment(mysql_mme_identity_t *mme_identity_p);
+
+/* Subscriber data backend of the S6A procedures */
+typedef struct hss_db_backend_s {
+  const char *name;
+  int (*auth_info)(mysql_auth_info_req_t *auth_info_req, mysql_auth_info_resp_t *auth_info_resp);
+  int (*push_rand_sqn)(const char *imsi, uint8_t *rand_p, uint8_t *sqn);
+  int (*increment_sqn)(const char *imsi);
+  int (*update_loc)(const char *imsi, mysql_ul_ans_t *mysql_ul_ans);
+  int (*push_up_loc)(mysql_ul_push_t *ul_push_p);
+  int (*purge_ue)(mysql_pu_req_t *mysql_pu_req, mysql_pu_ans_t *mysql_pu_ans);
+  int (*query_pdns)(const char *imsi, mysql_pdn_t **pdns_p, uint8_t *nb_pdns);
+  int (*check_epc_equipment)(mysql_mme_identity_t *mme_identity_p);
+} hss_db_backend_t;
+
+/* MySQL, through the subscriber cache */
+extern const hss_db_backend_t  hss_db_mysql;
+/* Embedded subscriber store */
+extern const hss_db_backend_t  hss_db_store;
+/* Backend in use, MySQL unless SUBSCRIBER_STORE is configured */
+extern const hss_db_backend_t *hss_db;
 
 #endif /* DB_PROTO_H_ */
@@ -0,0 +1,1657 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file db_store.c
+   \brief Embedded subscriber store, an alternative to MySQL for the HSS.
+   The subscribers live in one memory mapped file: an open addressing index
+   keyed by IMSI, fixed size subscriber records, their PDNs and the MME
+   identities. Lookups are lock free, a record is read under its sequence
+   counter and read again if a writer changed it meanwhile. SQN/RAND and
+   location updates are written in place by the HSS under striped locks and
+   synced to disk by a background thread. The file is built in one go by
+   --import-store from the MySQL database and replaced atomically (rename),
+   --export-store dumps it as SQL for the oai_db schema.
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <inttypes.h>
+#include <arpa/inet.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <mysql/mysql.h>
+
+#include "hss_config.h"
+#include "db_proto.h"
+#include "log.h"
+
+#define HSS_STORE_MAGIC             "OAIHSSDB"
+#define HSS_STORE_VERSION           (1)
+
+/* The header fills the first page, the other sections are cache line aligned */
+#define HSS_STORE_HEADER_SIZE       (4096)
+#define HSS_STORE_ALIGN(sIZE)       (((sIZE) + 63) & ~((uint64_t)63))
+
+/* MME identities: imported ones plus those learnt from ULRs */
+#define HSS_STORE_MME_MAX           (1024)
+#define HSS_STORE_NO_MME            (-1)
+
+/* Same limit as hss_mysql_query_pdns() */
+#define HSS_STORE_PDN_MAX           (10)
+
+/* Must be a power of 2 */
+#define HSS_STORE_LOCK_STRIPES      (256)
+
+/* Rows per INSERT statement of an export */
+#define HSS_STORE_EXPORT_BATCH      (1000)
+
+typedef struct hss_store_header_s {
+  char                                    magic[8];
+  uint32_t                                version;
+  /* 0 while an HSS has the store open, records may be torn if it crashed */
+  uint32_t                                clean;
+  uint32_t                                nb_subscribers;
+  /* Power of 2, slots hold a subscriber number + 1, 0 if free */
+  uint32_t                                index_size;
+  uint32_t                                nb_pdns;
+  /* Grows when a ULR comes from an MME not known yet */
+  uint32_t                                nb_mmes;
+  uint64_t                                index_offset;
+  uint64_t                                subscribers_offset;
+  uint64_t                                pdns_offset;
+  uint64_t                                mmes_offset;
+  uint64_t                                file_size;
+} hss_store_header_t;
+
+typedef struct hss_store_subscriber_s {
+  /* 0 for a duplicate IMSI dropped by the import */
+  uint64_t                                imsi_key;
+  /* Odd while the record is written */
+  uint32_t                                seq;
+  /* PDNs are set by the import, they are never modified */
+  uint32_t                                pdn_index;
+  uint64_t                                sqn;
+  uint8_t                                 key[KEY_LENGTH];
+  uint8_t                                 opc[KEY_LENGTH];
+  uint8_t                                 rand[RAND_LENGTH];
+  char                                    imsi[IMSI_LENGTH_MAX + 1];
+  char                                    msisdn[16];
+  char                                    imei[IMEI_LENGTH_MAX + 1];
+  char                                    software_version[2 + 1];
+  uint8_t                                 access_restriction;
+  uint8_t                                 nb_pdns;
+  uint8_t                                 purged;
+  int32_t                                 mme_index;
+  uint32_t                                aggr_ul;
+  uint32_t                                aggr_dl;
+  uint32_t                                rau_tau;
+} hss_store_subscriber_t;
+
+typedef struct hss_store_pdn_s {
+  char                                    apn[61];
+  uint8_t                                 pdn_type;
+  uint8_t                                 qci;
+  uint8_t                                 priority_level;
+  uint8_t                                 pre_emp_cap;
+  uint8_t                                 pre_emp_vul;
+  uint8_t                                 ipv4_address[4];
+  uint8_t                                 ipv6_address[16];
+  uint32_t                                aggr_ul;
+  uint32_t                                aggr_dl;
+  int32_t                                 pgw_id;
+} hss_store_pdn_t;
+
+/* Written once, before nb_mmes publishes it */
+typedef struct hss_store_mme_s {
+  int32_t                                 id;
+  mysql_mme_identity_t                    identity;
+} hss_store_mme_t;
+
+typedef struct hss_store_s {
+  int                                     enabled;
+  int                                     fd;
+  uint8_t                                *base;
+  size_t                                  size;
+
+  hss_store_header_t                     *header;
+  uint32_t                               *index;
+  hss_store_subscriber_t                 *subscribers;
+  hss_store_pdn_t                        *pdns;
+  hss_store_mme_t                        *mmes;
+
+  /* Writers of the records, readers do not lock */
+  pthread_mutex_t                         locks[HSS_STORE_LOCK_STRIPES];
+  pthread_mutex_t                         mme_mutex;
+
+  pthread_t                               syncer;
+  volatile int                            running;
+  int                                     sync_interval_ms;
+  uint64_t                                updates;
+  uint64_t                                synced_updates;
+} hss_store_t;
+
+/* Store being built by an import, before it is written */
+typedef struct hss_store_build_s {
+  hss_store_subscriber_t                 *subscribers;
+  uint32_t                                nb_subscribers;
+  uint32_t                                max_subscribers;
+  hss_store_pdn_t                        *pdns;
+  uint32_t                                nb_pdns;
+  uint32_t                                max_pdns;
+  hss_store_mme_t                        *mmes;
+  uint32_t                                nb_mmes;
+} hss_store_build_t;
+
+static hss_store_t hss_store = {.fd = -1};
+static hss_store_build_t hss_store_build = {0};
+
+static inline uint32_t
+hss_store_slot (
+  uint64_t key,
+  uint32_t mask)
+{
+  return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+static uint64_t
+hss_store_buffer_to_sqn (
+  const uint8_t * sqn_p)
+{
+  return ((uint64_t) sqn_p[0] << 40) | ((uint64_t) sqn_p[1] << 32) | ((uint64_t) sqn_p[2] << 24) |
+    ((uint64_t) sqn_p[3] << 16) | ((uint64_t) sqn_p[4] << 8) | sqn_p[5];
+}
+
+static void
+hss_store_sqn_to_buffer (
+  uint64_t sqn,
+  uint8_t * sqn_p)
+{
+  int                                     i;
+
+  for (i = SQN_LENGTH - 1; i >= 0; i--, sqn >>= 8) {
+    sqn_p[i] = sqn & 0xFF;
+  }
+}
+
+/*
+ * Sequence counter of a record: readers copy the fields between
+ * hss_store_read_begin() and hss_store_read_retry() and start again when a
+ * writer was there. Writers are serialized by the stripe lock of the record.
+ */
+static inline uint32_t
+hss_store_read_begin (
+  const hss_store_subscriber_t * subscriber)
+{
+  uint32_t                                seq;
+
+  while ((seq = __atomic_load_n (&subscriber->seq, __ATOMIC_ACQUIRE)) & 1) {
+    sched_yield ();
+  }
+
+  return seq;
+}
+
+static inline int
+hss_store_read_retry (
+  const hss_store_subscriber_t * subscriber,
+  uint32_t seq)
+{
+  __atomic_thread_fence (__ATOMIC_ACQUIRE);
+  return __atomic_load_n (&subscriber->seq, __ATOMIC_RELAXED) != seq;
+}
+
+static pthread_mutex_t *
+hss_store_write_begin (
+  hss_store_subscriber_t * subscriber)
+{
+  pthread_mutex_t                        *lock = &hss_store.locks[(subscriber - hss_store.subscribers) & (HSS_STORE_LOCK_STRIPES - 1)];
+
+  pthread_mutex_lock (lock);
+  __atomic_store_n (&subscriber->seq, subscriber->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+  return lock;
+}
+
+static void
+hss_store_write_end (
+  hss_store_subscriber_t * subscriber,
+  pthread_mutex_t * lock)
+{
+  __atomic_store_n (&subscriber->seq, subscriber->seq + 1, __ATOMIC_RELEASE);
+  pthread_mutex_unlock (lock);
+  __atomic_fetch_add (&hss_store.updates, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * O(1) lookup, linear probing in an index at most half full.
+ */
+static hss_store_subscriber_t *
+hss_store_find_key (
+  uint64_t key)
+{
+  uint32_t                                mask = hss_store.header->index_size - 1;
+  uint32_t                                slot = 0;
+
+  for (slot = hss_store_slot (key, mask); hss_store.index[slot] != 0; slot = (slot + 1) & mask) {
+    hss_store_subscriber_t                 *subscriber = &hss_store.subscribers[hss_store.index[slot] - 1];
+
+    if (subscriber->imsi_key == key) {
+      return subscriber;
+    }
+  }
+
+  return NULL;
+}
+
+static hss_store_subscriber_t *
+hss_store_find (
+  const char *imsi)
+{
+  uint64_t                                key = 0;
+
+  if (!hss_store.enabled || (hss_imsi_to_key (imsi, &key) != 0)) {
+    return NULL;
+  }
+
+  return hss_store_find_key (key);
+}
+
+/*
+ * MME identities are published by nb_mmes, an entry below it never changes.
+ */
+static int
+hss_store_find_mme (
+  const mysql_mme_identity_t * mme_identity_p,
+  int match_realm)
+{
+  uint32_t                                nb_mmes = __atomic_load_n (&hss_store.header->nb_mmes, __ATOMIC_ACQUIRE);
+  uint32_t                                i;
+
+  for (i = 0; i < nb_mmes; i++) {
+    if ((strcmp (hss_store.mmes[i].identity.mme_host, mme_identity_p->mme_host) == 0) &&
+        (!match_realm || (strcmp (hss_store.mmes[i].identity.mme_realm, mme_identity_p->mme_realm) == 0))) {
+      return i;
+    }
+  }
+
+  return HSS_STORE_NO_MME;
+}
+
+/*
+ * Same as the INSERT of mysql_push_up_loc(): a new MME identity gets the next id.
+ */
+static int
+hss_store_add_mme (
+  const mysql_mme_identity_t * mme_identity_p)
+{
+  int                                     mme_index = HSS_STORE_NO_MME;
+  uint32_t                                nb_mmes = 0;
+  int32_t                                 id = 0;
+  uint32_t                                i;
+
+  pthread_mutex_lock (&hss_store.mme_mutex);
+
+  if ((mme_index = hss_store_find_mme (mme_identity_p, 1)) == HSS_STORE_NO_MME) {
+    nb_mmes = hss_store.header->nb_mmes;
+
+    if (nb_mmes < HSS_STORE_MME_MAX) {
+      for (i = 0; i < nb_mmes; i++) {
+        id = (hss_store.mmes[i].id > id) ? hss_store.mmes[i].id : id;
+      }
+
+      hss_store.mmes[nb_mmes].id = id + 1;
+      hss_store.mmes[nb_mmes].identity = *mme_identity_p;
+      __atomic_store_n (&hss_store.header->nb_mmes, nb_mmes + 1, __ATOMIC_RELEASE);
+      __atomic_fetch_add (&hss_store.updates, 1, __ATOMIC_RELAXED);
+      mme_index = nb_mmes;
+    } else {
+      FPRINTF_ERROR ("Subscriber store: no room for MME %s\n", mme_identity_p->mme_host);
+    }
+  }
+
+  pthread_mutex_unlock (&hss_store.mme_mutex);
+  return mme_index;
+}
+
+static int
+hss_store_sync (
+  int flags)
+{
+  uint64_t                                updates = __atomic_load_n (&hss_store.updates, __ATOMIC_RELAXED);
+
+  if (updates == hss_store.synced_updates) {
+    return 0;
+  }
+
+  if (msync (hss_store.base, hss_store.size, flags) != 0) {
+    FPRINTF_ERROR ("Subscriber store sync failed: %s\n", strerror (errno));
+    return errno;
+  }
+
+  hss_store.synced_updates = updates;
+  return 0;
+}
+
+/*
+ * Bounds the SQN/RAND updates lost by a power failure to one sync period, the
+ * UE then recovers through the normal AUTS resynchronization. A crash of the
+ * HSS alone loses nothing, the pages are in the kernel page cache.
+ */
+static void *
+hss_store_syncer (
+  __attribute__ ((unused)) void *arg)
+{
+  while (hss_store.running) {
+    usleep (hss_store.sync_interval_ms * 1000);
+    hss_store_sync (MS_SYNC);
+  }
+
+  return NULL;
+}
+
+/*
+ * Map the store file and check its layout, the sections are set in hss_store.
+ */
+static int
+hss_store_map (
+  const char *path,
+  int writable)
+{
+  struct stat                             st;
+  hss_store_header_t                     *header = NULL;
+
+  if ((hss_store.fd = open (path, writable ? O_RDWR : O_RDONLY)) < 0) {
+    FPRINTF_ERROR ("Cannot open subscriber store %s: %s\n", path, strerror (errno));
+    return errno;
+  }
+
+  if ((fstat (hss_store.fd, &st) != 0) || (st.st_size < HSS_STORE_HEADER_SIZE)) {
+    FPRINTF_ERROR ("Subscriber store %s is truncated\n", path);
+    close (hss_store.fd);
+    hss_store.fd = -1;
+    return EINVAL;
+  }
+
+  hss_store.size = st.st_size;
+  hss_store.base = mmap (NULL, hss_store.size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, hss_store.fd, 0);
+
+  if (hss_store.base == MAP_FAILED) {
+    FPRINTF_ERROR ("Cannot map subscriber store %s: %s\n", path, strerror (errno));
+    hss_store.base = NULL;
+    close (hss_store.fd);
+    hss_store.fd = -1;
+    return ENOMEM;
+  }
+
+  header = (hss_store_header_t *) hss_store.base;
+
+  if ((memcmp (header->magic, HSS_STORE_MAGIC, sizeof (header->magic)) != 0) ||
+      (header->version != HSS_STORE_VERSION) ||
+      (header->file_size != hss_store.size) ||
+      (header->index_size == 0) || (header->index_size & (header->index_size - 1)) ||
+      (header->index_offset + (uint64_t) header->index_size * sizeof (uint32_t) > header->subscribers_offset) ||
+      (header->subscribers_offset + (uint64_t) header->nb_subscribers * sizeof (hss_store_subscriber_t) > header->pdns_offset) ||
+      (header->pdns_offset + (uint64_t) header->nb_pdns * sizeof (hss_store_pdn_t) > header->mmes_offset) ||
+      (header->mmes_offset + HSS_STORE_MME_MAX * sizeof (hss_store_mme_t) > header->file_size) ||
+      (header->nb_mmes > HSS_STORE_MME_MAX)) {
+    FPRINTF_ERROR ("%s is not a subscriber store of this HSS version\n", path);
+    munmap (hss_store.base, hss_store.size);
+    hss_store.base = NULL;
+    close (hss_store.fd);
+    hss_store.fd = -1;
+    return EINVAL;
+  }
+
+  hss_store.header = header;
+  hss_store.index = (uint32_t *) (hss_store.base + header->index_offset);
+  hss_store.subscribers = (hss_store_subscriber_t *) (hss_store.base + header->subscribers_offset);
+  hss_store.pdns = (hss_store_pdn_t *) (hss_store.base + header->pdns_offset);
+  hss_store.mmes = (hss_store_mme_t *) (hss_store.base + header->mmes_offset);
+  return 0;
+}
+
+static void
+hss_store_unmap (
+  void)
+{
+  if (hss_store.base != NULL) {
+    munmap (hss_store.base, hss_store.size);
+    hss_store.base = NULL;
+    hss_store.header = NULL;
+  }
+
+  if (hss_store.fd >= 0) {
+    close (hss_store.fd);
+    hss_store.fd = -1;
+  }
+}
+
+int
+hss_store_init (
+  const hss_config_t * hss_config_p)
+{
+  uint32_t                                nb_torn = 0;
+  uint32_t                                i;
+  int                                     ret = 0;
+
+  if ((hss_config_p->subscriber_store == NULL) || hss_store.enabled) {
+    return EINVAL;
+  }
+
+  if ((ret = hss_store_map (hss_config_p->subscriber_store, 1)) != 0) {
+    return ret;
+  }
+
+  /*
+   * Writers are serialized by locks of this process only
+   */
+  if (flock (hss_store.fd, LOCK_EX | LOCK_NB) != 0) {
+    FPRINTF_ERROR ("Subscriber store %s is used by another HSS\n", hss_config_p->subscriber_store);
+    hss_store_unmap ();
+    return EBUSY;
+  }
+
+  /*
+   * A record left odd by a crash has a torn RAND at worst, SQN is one aligned
+   * 64 bit store, AUTS resynchronizes the UE if the RAND is wrong.
+   */
+  if (!hss_store.header->clean) {
+    for (i = 0; i < hss_store.header->nb_subscribers; i++) {
+      if (hss_store.subscribers[i].seq & 1) {
+        hss_store.subscribers[i].seq++;
+        nb_torn++;
+      }
+    }
+
+    FPRINTF_NOTICE ("Subscriber store was not closed cleanly, %u records repaired\n", nb_torn);
+  }
+
+  hss_store.header->clean = 0;
+  msync (hss_store.base, HSS_STORE_HEADER_SIZE, MS_SYNC);
+
+  /*
+   * Nothing is loaded, the index is paged in ahead and the records on demand
+   */
+  madvise (hss_store.index, (size_t) hss_store.header->index_size * sizeof (uint32_t), MADV_WILLNEED);
+  madvise (hss_store.subscribers, (size_t) hss_store.header->nb_subscribers * sizeof (hss_store_subscriber_t), MADV_RANDOM);
+
+  for (i = 0; i < HSS_STORE_LOCK_STRIPES; i++) {
+    pthread_mutex_init (&hss_store.locks[i], NULL);
+  }
+
+  pthread_mutex_init (&hss_store.mme_mutex, NULL);
+  hss_store.updates = 0;
+  hss_store.synced_updates = 0;
+  hss_store.sync_interval_ms = hss_config_p->subscriber_cache_flush_ms;
+  hss_store.running = 1;
+
+  if (pthread_create (&hss_store.syncer, NULL, hss_store_syncer, NULL) != 0) {
+    FPRINTF_ERROR ("Failed to create subscriber store sync thread\n");
+    hss_store.running = 0;
+    hss_store_unmap ();
+    return EINVAL;
+  }
+
+  hss_store.enabled = 1;
+  FPRINTF_NOTICE ("Subscriber store %s: %u records, %u PDNs, %u MMEs, synced every %d ms\n",
+                  hss_config_p->subscriber_store, hss_store.header->nb_subscribers, hss_store.header->nb_pdns,
+                  hss_store.header->nb_mmes, hss_store.sync_interval_ms);
+  return 0;
+}
+
+void
+hss_store_exit (
+  void)
+{
+  if (!hss_store.enabled) {
+    return;
+  }
+
+  hss_store.running = 0;
+  pthread_join (hss_store.syncer, NULL);
+  hss_store.enabled = 0;
+
+  /*
+   * Clean only once every record is on disk
+   */
+  if (msync (hss_store.base, hss_store.size, MS_SYNC) == 0) {
+    hss_store.header->clean = 1;
+    msync (hss_store.base, HSS_STORE_HEADER_SIZE, MS_SYNC);
+  }
+
+  hss_store_unmap ();
+}
+
+int
+hss_store_auth_info (
+  mysql_auth_info_req_t * auth_info_req,
+  mysql_auth_info_resp_t * auth_info_resp)
+{
+  hss_store_subscriber_t                 *subscriber = NULL;
+  uint64_t                                sqn = 0;
+  uint32_t                                seq;
+
+  if ((auth_info_req == NULL) || (auth_info_resp == NULL)) {
+    return EINVAL;
+  }
+
+  if ((subscriber = hss_store_find (auth_info_req->imsi)) == NULL) {
+    return EINVAL;
+  }
+
+  do {
+    seq = hss_store_read_begin (subscriber);
+    memcpy (auth_info_resp->key, subscriber->key, KEY_LENGTH);
+    memcpy (auth_info_resp->opc, subscriber->opc, KEY_LENGTH);
+    memcpy (auth_info_resp->rand, subscriber->rand, RAND_LENGTH);
+    sqn = subscriber->sqn;
+  } while (hss_store_read_retry (subscriber, seq));
+
+  hss_store_sqn_to_buffer (sqn, auth_info_resp->sqn);
+  return 0;
+}
+
+int
+hss_store_push_rand_sqn (
+  const char *imsi,
+  uint8_t * rand_p,
+  uint8_t * sqn)
+{
+  hss_store_subscriber_t                 *subscriber = NULL;
+  pthread_mutex_t                        *lock = NULL;
+
+  if ((rand_p == NULL) || (sqn == NULL)) {
+    return EINVAL;
+  }
+
+  if ((subscriber = hss_store_find (imsi)) == NULL) {
+    return EINVAL;
+  }
+
+  lock = hss_store_write_begin (subscriber);
+  memcpy (subscriber->rand, rand_p, RAND_LENGTH);
+  __atomic_store_n (&subscriber->sqn, hss_store_buffer_to_sqn (sqn), __ATOMIC_RELAXED);
+  hss_store_write_end (subscriber, lock);
+  return 0;
+}
+
+int
+hss_store_increment_sqn (
+  const char *imsi)
+{
+  hss_store_subscriber_t                 *subscriber = NULL;
+  pthread_mutex_t                        *lock = NULL;
+
+  if ((subscriber = hss_store_find (imsi)) == NULL) {
+    return EINVAL;
+  }
+
+  /*
+   * + 32 = 2 ^ sizeof(IND) (see 3GPP TS. 33.102)
+   */
+  lock = hss_store_write_begin (subscriber);
+  __atomic_store_n (&subscriber->sqn, subscriber->sqn + 32, __ATOMIC_RELAXED);
+  hss_store_write_end (subscriber, lock);
+  return 0;
+}
+
+int
+hss_store_update_loc (
+  const char *imsi,
+  mysql_ul_ans_t * mysql_ul_ans)
+{
+  hss_store_subscriber_t                 *subscriber = NULL;
+  int32_t                                 mme_index = HSS_STORE_NO_MME;
+  uint32_t                                seq;
+
+  if ((mysql_ul_ans == NULL) || (imsi == NULL) || (strlen (imsi) > IMSI_LENGTH_MAX)) {
+    return EINVAL;
+  }
+
+  if ((subscriber = hss_store_find (imsi)) == NULL) {
+    return EINVAL;
+  }
+
+  memset (mysql_ul_ans, 0, sizeof (mysql_ul_ans_t));
+
+  do {
+    seq = hss_store_read_begin (subscriber);
+    memcpy (mysql_ul_ans->msisdn, subscriber->msisdn, sizeof (mysql_ul_ans->msisdn));
+    mysql_ul_ans->aggr_ul = subscriber->aggr_ul;
+    mysql_ul_ans->aggr_dl = subscriber->aggr_dl;
+    mysql_ul_ans->rau_tau = subscriber->rau_tau;
+    mysql_ul_ans->access_restriction = subscriber->access_restriction;
+    mme_index = subscriber->mme_index;
+  } while (hss_store_read_retry (subscriber, seq));
+
+  strcpy (mysql_ul_ans->imsi, subscriber->imsi);
+
+  if (mme_index != HSS_STORE_NO_MME) {
+    mysql_ul_ans->mme_identity = hss_store.mmes[mme_index].identity;
+  }
+
+  return 0;
+}
+
+int
+hss_store_push_up_loc (
+  mysql_ul_push_t * ul_push_p)
+{
+  hss_store_subscriber_t                 *subscriber = NULL;
+  pthread_mutex_t                        *lock = NULL;
+  int                                     mme_index = HSS_STORE_NO_MME;
+
+  if (ul_push_p == NULL) {
+    return EINVAL;
+  }
+
+  if ((subscriber = hss_store_find (ul_push_p->imsi)) == NULL) {
+    return EINVAL;
+  }
+
+  if (ul_push_p->mme_identity_present == MME_IDENTITY_PRESENT) {
+    if ((mme_index = hss_store_find_mme (&ul_push_p->mme_identity, 1)) == HSS_STORE_NO_MME) {
+      if ((mme_index = hss_store_add_mme (&ul_push_p->mme_identity)) == HSS_STORE_NO_MME) {
+        return ENOMEM;
+      }
+    }
+  }
+
+  lock = hss_store_write_begin (subscriber);
+
+  if (mme_index != HSS_STORE_NO_MME) {
+    subscriber->mme_index = mme_index;
+    subscriber->purged = 0;
+  }
+
+  if (ul_push_p->imei_present == IMEI_PRESENT) {
+    strncpy (subscriber->imei, ul_push_p->imei, IMEI_LENGTH_MAX);
+  }
+
+  if (ul_push_p->sv_present == SV_PRESENT) {
+    memcpy (subscriber->software_version, ul_push_p->software_version, 2);
+  }
+
+  hss_store_write_end (subscriber, lock);
+  return 0;
+}
+
+int
+hss_store_purge_ue (
+  mysql_pu_req_t * mysql_pu_req,
+  mysql_pu_ans_t * mysql_pu_ans)
+{
+  hss_store_subscriber_t                 *subscriber = NULL;
+  pthread_mutex_t                        *lock = NULL;
+  int32_t                                 mme_index = HSS_STORE_NO_MME;
+
+  if ((mysql_pu_req == NULL) || (mysql_pu_ans == NULL)) {
+    return EINVAL;
+  }
+
+  if ((subscriber = hss_store_find (mysql_pu_req->imsi)) == NULL) {
+    return EINVAL;
+  }
+
+  lock = hss_store_write_begin (subscriber);
+  subscriber->purged = 1;
+  mme_index = subscriber->mme_index;
+  hss_store_write_end (subscriber, lock);
+
+  if (mme_index != HSS_STORE_NO_MME) {
+    *mysql_pu_ans = hss_store.mmes[mme_index].identity;
+  } else {
+    mysql_pu_ans->mme_host[0] = '\0';
+    mysql_pu_ans->mme_realm[0] = '\0';
+  }
+
+  return 0;
+}
+
+static void
+hss_store_pdn_to_mysql (
+  const hss_store_pdn_t * pdn,
+  mysql_pdn_t * pdn_elm)
+{
+  memset (pdn_elm, 0, sizeof (mysql_pdn_t));
+  memcpy (pdn_elm->apn, pdn->apn, sizeof (pdn_elm->apn));
+  pdn_elm->pdn_type = pdn->pdn_type;
+  inet_ntop (AF_INET, pdn->ipv4_address, pdn_elm->pdn_address.ipv4_address, INET_ADDRSTRLEN);
+  inet_ntop (AF_INET6, pdn->ipv6_address, pdn_elm->pdn_address.ipv6_address, INET6_ADDRSTRLEN);
+  pdn_elm->aggr_ul = pdn->aggr_ul;
+  pdn_elm->aggr_dl = pdn->aggr_dl;
+  pdn_elm->qci = pdn->qci;
+  pdn_elm->priority_level = pdn->priority_level;
+  pdn_elm->pre_emp_cap = pdn->pre_emp_cap;
+  pdn_elm->pre_emp_vul = pdn->pre_emp_vul;
+  pdn_elm->pgw_id = pdn->pgw_id;
+}
+
+static void
+hss_store_pdn_from_mysql (
+  const mysql_pdn_t * pdn_elm,
+  hss_store_pdn_t * pdn)
+{
+  memset (pdn, 0, sizeof (hss_store_pdn_t));
+  strncpy (pdn->apn, pdn_elm->apn, sizeof (pdn->apn) - 1);
+  pdn->pdn_type = pdn_elm->pdn_type;
+  inet_pton (AF_INET, pdn_elm->pdn_address.ipv4_address, pdn->ipv4_address);
+  inet_pton (AF_INET6, pdn_elm->pdn_address.ipv6_address, pdn->ipv6_address);
+  pdn->aggr_ul = pdn_elm->aggr_ul;
+  pdn->aggr_dl = pdn_elm->aggr_dl;
+  pdn->qci = pdn_elm->qci;
+  pdn->priority_level = pdn_elm->priority_level;
+  pdn->pre_emp_cap = pdn_elm->pre_emp_cap;
+  pdn->pre_emp_vul = pdn_elm->pre_emp_vul;
+  pdn->pgw_id = pdn_elm->pgw_id;
+}
+
+/*
+ * Same contract as hss_mysql_query_pdns(), the returned array is owned by the
+ * caller.
+ */
+int
+hss_store_query_pdns (
+  const char *imsi,
+  mysql_pdn_t ** pdns_p,
+  uint8_t * nb_pdns)
+{
+  hss_store_subscriber_t                 *subscriber = NULL;
+  int                                     i;
+
+  if ((nb_pdns == NULL) || (pdns_p == NULL)) {
+    return EINVAL;
+  }
+
+  *pdns_p = NULL;
+  *nb_pdns = 0;
+
+  if (((subscriber = hss_store_find (imsi)) == NULL) || (subscriber->nb_pdns == 0)) {
+    return EINVAL;
+  }
+
+  if ((*pdns_p = malloc (subscriber->nb_pdns * sizeof (mysql_pdn_t))) == NULL) {
+    return ENOMEM;
+  }
+
+  for (i = 0; i < subscriber->nb_pdns; i++) {
+    hss_store_pdn_to_mysql (&hss_store.pdns[subscriber->pdn_index + i], &(*pdns_p)[i]);
+  }
+
+  *nb_pdns = subscriber->nb_pdns;
+  return 0;
+}
+
+int
+hss_store_check_epc_equipment (
+  mysql_mme_identity_t * mme_identity_p)
+{
+  if (!hss_store.enabled || (mme_identity_p == NULL)) {
+    return EINVAL;
+  }
+
+  return (hss_store_find_mme (mme_identity_p, 0) == HSS_STORE_NO_MME) ? EINVAL : 0;
+}
+
+const hss_db_backend_t                  hss_db_store = {
+  .name = "subscriber store",
+  .auth_info = hss_store_auth_info,
+  .push_rand_sqn = hss_store_push_rand_sqn,
+  .increment_sqn = hss_store_increment_sqn,
+  .update_loc = hss_store_update_loc,
+  .push_up_loc = hss_store_push_up_loc,
+  .purge_ue = hss_store_purge_ue,
+  .query_pdns = hss_store_query_pdns,
+  .check_epc_equipment = hss_store_check_epc_equipment,
+};
+
+/*
+ * Building a store: subscribers and PDNs are accumulated in memory, then
+ * hss_store_build_commit() writes the whole file.
+ */
+static void
+hss_store_build_free (
+  void)
+{
+  free (hss_store_build.subscribers);
+  free (hss_store_build.pdns);
+  free (hss_store_build.mmes);
+  memset (&hss_store_build, 0, sizeof (hss_store_build));
+}
+
+int
+hss_store_build_begin (
+  void)
+{
+  hss_store_build_free ();
+  hss_store_build.mmes = calloc (HSS_STORE_MME_MAX, sizeof (hss_store_mme_t));
+  return (hss_store_build.mmes == NULL) ? ENOMEM : 0;
+}
+
+int
+hss_store_build_add_mme (
+  const int id,
+  const mysql_mme_identity_t * mme_identity_p)
+{
+  if ((hss_store_build.mmes == NULL) || (mme_identity_p == NULL)) {
+    return EINVAL;
+  }
+
+  if (hss_store_build.nb_mmes == HSS_STORE_MME_MAX) {
+    FPRINTF_ERROR ("Subscriber store: more than %d MME identities\n", HSS_STORE_MME_MAX);
+    return ENOMEM;
+  }
+
+  hss_store_build.mmes[hss_store_build.nb_mmes].id = id;
+  hss_store_build.mmes[hss_store_build.nb_mmes].identity = *mme_identity_p;
+  hss_store_build.nb_mmes++;
+  return 0;
+}
+
+static int
+hss_store_build_find_mme (
+  const mysql_mme_identity_t * mme_identity_p)
+{
+  uint32_t                                i;
+
+  for (i = 0; i < hss_store_build.nb_mmes; i++) {
+    if ((strcmp (hss_store_build.mmes[i].identity.mme_host, mme_identity_p->mme_host) == 0) &&
+        (strcmp (hss_store_build.mmes[i].identity.mme_realm, mme_identity_p->mme_realm) == 0)) {
+      return i;
+    }
+  }
+
+  return HSS_STORE_NO_MME;
+}
+
+int
+hss_store_build_add_user (
+  const mysql_auth_info_resp_t * auth_p,
+  const mysql_ul_ans_t * ul_p,
+  const char *imei,
+  const char *software_version,
+  const int purged,
+  const mysql_pdn_t * pdns,
+  const uint8_t nb_pdns)
+{
+  hss_store_subscriber_t                 *subscriber = NULL;
+  uint32_t                                i;
+
+  if ((hss_store_build.mmes == NULL) || (auth_p == NULL) || (ul_p == NULL) || ((nb_pdns > 0) && (pdns == NULL))) {
+    return EINVAL;
+  }
+
+  if (hss_store_build.nb_subscribers == hss_store_build.max_subscribers) {
+    uint32_t                                max = (hss_store_build.max_subscribers) ? 2 * hss_store_build.max_subscribers : 1024;
+    hss_store_subscriber_t                 *subscribers = realloc (hss_store_build.subscribers, max * sizeof (hss_store_subscriber_t));
+
+    if (subscribers == NULL) {
+      return ENOMEM;
+    }
+
+    hss_store_build.subscribers = subscribers;
+    hss_store_build.max_subscribers = max;
+  }
+
+  if (hss_store_build.nb_pdns + nb_pdns > hss_store_build.max_pdns) {
+    uint32_t                                max = (hss_store_build.max_pdns) ? 2 * hss_store_build.max_pdns : 1024;
+    hss_store_pdn_t                        *pdns_array = realloc (hss_store_build.pdns, max * sizeof (hss_store_pdn_t));
+
+    if (pdns_array == NULL) {
+      return ENOMEM;
+    }
+
+    hss_store_build.pdns = pdns_array;
+    hss_store_build.max_pdns = max;
+  }
+
+  subscriber = &hss_store_build.subscribers[hss_store_build.nb_subscribers];
+  memset (subscriber, 0, sizeof (hss_store_subscriber_t));
+
+  if (hss_imsi_to_key (ul_p->imsi, &subscriber->imsi_key) != 0) {
+    return EINVAL;
+  }
+
+  strcpy (subscriber->imsi, ul_p->imsi);
+  memcpy (subscriber->key, auth_p->key, KEY_LENGTH);
+  memcpy (subscriber->opc, auth_p->opc, KEY_LENGTH);
+  memcpy (subscriber->rand, auth_p->rand, RAND_LENGTH);
+  subscriber->sqn = hss_store_buffer_to_sqn (auth_p->sqn);
+  strncpy (subscriber->msisdn, ul_p->msisdn, sizeof (subscriber->msisdn) - 1);
+  subscriber->aggr_ul = ul_p->aggr_ul;
+  subscriber->aggr_dl = ul_p->aggr_dl;
+  subscriber->rau_tau = ul_p->rau_tau;
+  subscriber->access_restriction = ul_p->access_restriction;
+  subscriber->purged = (purged != 0);
+  subscriber->mme_index = HSS_STORE_NO_MME;
+
+  if (imei != NULL) {
+    strncpy (subscriber->imei, imei, IMEI_LENGTH_MAX);
+  }
+
+  if (software_version != NULL) {
+    strncpy (subscriber->software_version, software_version, 2);
+  }
+
+  /*
+   * The serving MME is one of the imported identities
+   */
+  if (ul_p->mme_identity.mme_host[0] != '\0') {
+    subscriber->mme_index = hss_store_build_find_mme (&ul_p->mme_identity);
+  }
+
+  subscriber->pdn_index = hss_store_build.nb_pdns;
+  subscriber->nb_pdns = (nb_pdns > HSS_STORE_PDN_MAX) ? HSS_STORE_PDN_MAX : nb_pdns;
+
+  for (i = 0; i < subscriber->nb_pdns; i++) {
+    hss_store_pdn_from_mysql (&pdns[i], &hss_store_build.pdns[hss_store_build.nb_pdns++]);
+  }
+
+  hss_store_build.nb_subscribers++;
+  return 0;
+}
+
+static int
+hss_store_write_at (
+  int fd,
+  uint64_t offset,
+  const void *buffer,
+  size_t length)
+{
+  const uint8_t                          *p = buffer;
+
+  while (length > 0) {
+    ssize_t                                 written = pwrite (fd, p, length, offset);
+
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      return errno;
+    }
+
+    p += written;
+    offset += written;
+    length -= written;
+  }
+
+  return 0;
+}
+
+/*
+ * The file is written aside and renamed over the previous store: a crash
+ * during an import leaves the previous store untouched.
+ */
+int
+hss_store_build_commit (
+  const char *path)
+{
+  hss_store_header_t                      header;
+  uint8_t                                 header_page[HSS_STORE_HEADER_SIZE];
+  uint32_t                               *index = NULL;
+  char                                   *tmp_path = NULL;
+  char                                   *dir_path = NULL;
+  uint32_t                                nb_duplicates = 0;
+  uint32_t                                i;
+  int                                     fd = -1;
+  int                                     ret = 0;
+
+  if ((path == NULL) || (hss_store_build.mmes == NULL)) {
+    return EINVAL;
+  }
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, HSS_STORE_MAGIC, sizeof (header.magic));
+  header.version = HSS_STORE_VERSION;
+  header.clean = 1;
+  header.nb_subscribers = hss_store_build.nb_subscribers;
+  header.nb_pdns = hss_store_build.nb_pdns;
+  header.nb_mmes = hss_store_build.nb_mmes;
+
+  for (header.index_size = 16; header.index_size < 2 * (uint64_t) header.nb_subscribers; header.index_size <<= 1);
+
+  header.index_offset = HSS_STORE_HEADER_SIZE;
+  header.subscribers_offset = HSS_STORE_ALIGN (header.index_offset + (uint64_t) header.index_size * sizeof (uint32_t));
+  header.pdns_offset = HSS_STORE_ALIGN (header.subscribers_offset + (uint64_t) header.nb_subscribers * sizeof (hss_store_subscriber_t));
+  header.mmes_offset = HSS_STORE_ALIGN (header.pdns_offset + (uint64_t) header.nb_pdns * sizeof (hss_store_pdn_t));
+  header.file_size = header.mmes_offset + HSS_STORE_MME_MAX * sizeof (hss_store_mme_t);
+
+  if ((index = calloc (header.index_size, sizeof (uint32_t))) == NULL) {
+    ret = ENOMEM;
+    goto out;
+  }
+
+  /*
+   * First row wins, as in the subscriber cache
+   */
+  for (i = 0; i < header.nb_subscribers; i++) {
+    hss_store_subscriber_t                 *subscriber = &hss_store_build.subscribers[i];
+    uint32_t                                mask = header.index_size - 1;
+    uint32_t                                slot = hss_store_slot (subscriber->imsi_key, mask);
+
+    while ((index[slot] != 0) && (hss_store_build.subscribers[index[slot] - 1].imsi_key != subscriber->imsi_key)) {
+      slot = (slot + 1) & mask;
+    }
+
+    if (index[slot] != 0) {
+      subscriber->imsi_key = 0;
+      nb_duplicates++;
+    } else {
+      index[slot] = i + 1;
+    }
+  }
+
+  if ((tmp_path = malloc (strlen (path) + 5)) == NULL) {
+    ret = ENOMEM;
+    goto out;
+  }
+
+  sprintf (tmp_path, "%s.tmp", path);
+
+  if ((fd = open (tmp_path, O_CREAT | O_TRUNC | O_WRONLY, 0600)) < 0) {
+    ret = errno;
+    FPRINTF_ERROR ("Cannot create %s: %s\n", tmp_path, strerror (ret));
+    goto out;
+  }
+
+  memset (header_page, 0, sizeof (header_page));
+  memcpy (header_page, &header, sizeof (header));
+
+  if ((ftruncate (fd, header.file_size) != 0) ||
+      ((ret = hss_store_write_at (fd, 0, header_page, sizeof (header_page))) != 0) ||
+      ((ret = hss_store_write_at (fd, header.index_offset, index, header.index_size * sizeof (uint32_t))) != 0) ||
+      ((ret = hss_store_write_at (fd, header.subscribers_offset, hss_store_build.subscribers, header.nb_subscribers * sizeof (hss_store_subscriber_t))) != 0) ||
+      ((ret = hss_store_write_at (fd, header.pdns_offset, hss_store_build.pdns, header.nb_pdns * sizeof (hss_store_pdn_t))) != 0) ||
+      ((ret = hss_store_write_at (fd, header.mmes_offset, hss_store_build.mmes, HSS_STORE_MME_MAX * sizeof (hss_store_mme_t))) != 0) ||
+      (fsync (fd) != 0)) {
+    ret = (ret != 0) ? ret : errno;
+    FPRINTF_ERROR ("Cannot write %s: %s\n", tmp_path, strerror (ret));
+    close (fd);
+    unlink (tmp_path);
+    goto out;
+  }
+
+  close (fd);
+
+  if (rename (tmp_path, path) != 0) {
+    ret = errno;
+    FPRINTF_ERROR ("Cannot rename %s to %s: %s\n", tmp_path, path, strerror (ret));
+    unlink (tmp_path);
+    goto out;
+  }
+
+  /*
+   * The rename itself must reach the disk
+   */
+  if ((dir_path = strdup (path)) != NULL) {
+    if ((fd = open (dirname (dir_path), O_RDONLY | O_DIRECTORY)) >= 0) {
+      fsync (fd);
+      close (fd);
+    }
+  }
+
+  FPRINTF_NOTICE ("Subscriber store %s written: %u subscribers (%u duplicates dropped), %u PDNs, %u MMEs, %" PRIu64 " bytes\n",
+                  path, header.nb_subscribers - nb_duplicates, nb_duplicates, header.nb_pdns, header.nb_mmes, header.file_size);
+
+out:
+  free (dir_path);
+  free (tmp_path);
+  free (index);
+  hss_store_build_free ();
+  return ret;
+}
+
+/*
+ * One row per subscriber and PDN, the PDN columns start at
+ * HSS_STORE_IMPORT_PDN_COLUMN in the layout hss_mysql_pdn_from_row() expects.
+ */
+#define HSS_STORE_IMPORT_USERS_QUERY                                                   \
+  "SELECT `users`.`imsi`,`users`.`key`,`users`.`sqn`,`users`.`rand`,`users`.`OPc`,"    \
+  "`users`.`access_restriction`,`users`.`msisdn`,`users`.`ue_ambr_ul`,"                \
+  "`users`.`ue_ambr_dl`,`users`.`rau_tau_timer`,`users`.`ms_ps_status`,"               \
+  "`users`.`imei`,`users`.`imei_sv`,`users`.`mmeidentity_idmmeidentity`,"              \
+  "`mmeidentity`.`mmehost`,`mmeidentity`.`mmerealm`,`pdn`.* "                          \
+  "FROM `users` LEFT JOIN `mmeidentity` ON "                                           \
+  "`users`.`mmeidentity_idmmeidentity`=`mmeidentity`.`idmmeidentity` "                \
+  "LEFT JOIN `pdn` ON `pdn`.`users_imsi`=`users`.`imsi` "                              \
+  "ORDER BY `users`.`imsi`,`users`.`mmeidentity_idmmeidentity`,`pdn`.`id`"
+#define HSS_STORE_IMPORT_PDN_COLUMN (16)
+
+typedef struct hss_store_import_user_s {
+  mysql_auth_info_resp_t                  auth;
+  mysql_ul_ans_t                          ul;
+  char                                    imei[IMEI_LENGTH_MAX + 1];
+  char                                    software_version[2 + 1];
+  int                                     purged;
+  char                                    mme_id[12];
+  mysql_pdn_t                             pdns[HSS_STORE_PDN_MAX];
+  uint8_t                                 nb_pdns;
+} hss_store_import_user_t;
+
+/*
+ * The IMSI and the MME id are set even for a row that is rejected, the other
+ * rows of the same user are then recognized and skipped with it.
+ */
+static int
+hss_store_import_user_from_row (
+  MYSQL_ROW row,
+  unsigned long *lengths,
+  hss_store_import_user_t * user)
+{
+  const char                             *error = NULL;
+
+  memset (user, 0, sizeof (hss_store_import_user_t));
+
+  if ((row[0] != NULL) && (lengths[0] <= IMSI_LENGTH_MAX)) {
+    memcpy (user->ul.imsi, row[0], lengths[0]);
+  }
+
+  if ((row[13] != NULL) && (lengths[13] < sizeof (user->mme_id))) {
+    memcpy (user->mme_id, row[13], lengths[13]);
+  }
+
+  if ((row[0] == NULL) || (lengths[0] > IMSI_LENGTH_MAX)) {
+    error = "no IMSI or IMSI too long";
+  } else if ((row[1] == NULL) || (lengths[1] != KEY_LENGTH)) {
+    error = "NULL or wrong length key";
+  } else if (row[2] == NULL) {
+    error = "NULL SQN";
+  } else if ((row[3] == NULL) || (lengths[3] != RAND_LENGTH)) {
+    error = "NULL or wrong length RAND";
+  } else if ((row[4] == NULL) || (lengths[4] != KEY_LENGTH)) {
+    error = "NULL or wrong length OPc";
+  }
+
+  if (error != NULL) {
+    FPRINTF_ERROR ("Subscriber store import: IMSI %s skipped, %s\n", (row[0] != NULL) ? row[0] : "NULL", error);
+    return EINVAL;
+  }
+
+  memcpy (user->auth.key, row[1], KEY_LENGTH);
+  hss_store_sqn_to_buffer (strtoull (row[2], NULL, 10), user->auth.sqn);
+  memcpy (user->auth.rand, row[3], RAND_LENGTH);
+  memcpy (user->auth.opc, row[4], KEY_LENGTH);
+  user->ul.access_restriction = (row[5] != NULL) ? atoi (row[5]) : 0;
+
+  if ((row[6] != NULL) && (lengths[6] < sizeof (user->ul.msisdn))) {
+    memcpy (user->ul.msisdn, row[6], lengths[6]);
+  }
+
+  user->ul.aggr_ul = (row[7] != NULL) ? atoi (row[7]) : 0;
+  user->ul.aggr_dl = (row[8] != NULL) ? atoi (row[8]) : 0;
+  user->ul.rau_tau = (row[9] != NULL) ? atoi (row[9]) : 0;
+  user->purged = (row[10] == NULL) || (strcmp (row[10], "PURGED") == 0);
+
+  if ((row[11] != NULL) && (lengths[11] <= IMEI_LENGTH_MAX)) {
+    memcpy (user->imei, row[11], lengths[11]);
+  }
+
+  if ((row[12] != NULL) && (lengths[12] <= 2)) {
+    memcpy (user->software_version, row[12], lengths[12]);
+  }
+
+  if ((row[14] != NULL) && (lengths[14] < sizeof (user->ul.mme_identity.mme_host))) {
+    memcpy (user->ul.mme_identity.mme_host, row[14], lengths[14]);
+  }
+
+  if ((row[15] != NULL) && (lengths[15] < sizeof (user->ul.mme_identity.mme_realm))) {
+    memcpy (user->ul.mme_identity.mme_realm, row[15], lengths[15]);
+  }
+
+  return 0;
+}
+
+/*
+ * A subscriber already in the previous store keeps the state the HSS wrote
+ * there and never in MySQL: SQN, RAND, purged flag and registered MME.
+ */
+static int
+hss_store_import_carry_over (
+  hss_store_subscriber_t * subscriber)
+{
+  const hss_store_subscriber_t           *previous = NULL;
+  hss_store_subscriber_t                  record;
+  uint32_t                                seq;
+  int                                     mme_index = HSS_STORE_NO_MME;
+
+  if ((hss_store.header == NULL) || ((previous = hss_store_find_key (subscriber->imsi_key)) == NULL)) {
+    return 0;
+  }
+
+  do {
+    seq = hss_store_read_begin (previous);
+    memcpy (&record, previous, sizeof (record));
+  } while (hss_store_read_retry (previous, seq));
+
+  subscriber->sqn = record.sqn;
+  memcpy (subscriber->rand, record.rand, RAND_LENGTH);
+  subscriber->purged = record.purged;
+  subscriber->mme_index = HSS_STORE_NO_MME;
+
+  if ((record.mme_index != HSS_STORE_NO_MME) && (record.mme_index < (int32_t) hss_store.header->nb_mmes)) {
+    const hss_store_mme_t                  *mme = &hss_store.mmes[record.mme_index];
+
+    /*
+     * An MME learnt from a ULR is not in the mmeidentity table, it gets the next id
+     */
+    if ((mme_index = hss_store_build_find_mme (&mme->identity)) == HSS_STORE_NO_MME) {
+      int32_t                                 id = 0;
+      uint32_t                                i;
+
+      for (i = 0; i < hss_store_build.nb_mmes; i++) {
+        id = (hss_store_build.mmes[i].id > id) ? hss_store_build.mmes[i].id : id;
+      }
+
+      if (hss_store_build_add_mme (id + 1, &mme->identity) != 0) {
+        return ENOMEM;
+      }
+
+      mme_index = hss_store_build.nb_mmes - 1;
+    }
+
+    subscriber->mme_index = mme_index;
+  }
+
+  return 0;
+}
+
+static int
+hss_store_import_add_user (
+  hss_store_import_user_t * user)
+{
+  int                                     ret = 0;
+
+  if ((ret = hss_store_build_add_user (&user->auth, &user->ul, user->imei, user->software_version, user->purged, user->pdns, user->nb_pdns)) != 0) {
+    return ret;
+  }
+
+  return hss_store_import_carry_over (&hss_store_build.subscribers[hss_store_build.nb_subscribers - 1]);
+}
+
+/*
+ * Map the store being replaced, if any, to carry the state of its
+ * subscribers over. The shared lock keeps an HSS from opening it meanwhile.
+ */
+static int
+hss_store_import_map_previous (
+  const char *path)
+{
+  int                                     ret = 0;
+
+  if ((access (path, F_OK) != 0) && (errno == ENOENT)) {
+    return 0;
+  }
+
+  if ((ret = hss_store_map (path, 0)) != 0) {
+    return ret;
+  }
+
+  if (flock (hss_store.fd, LOCK_SH | LOCK_NB) != 0) {
+    FPRINTF_ERROR ("Subscriber store %s is used by a running HSS, stop it before importing\n", path);
+    ret = EBUSY;
+  } else if (!hss_store.header->clean) {
+    FPRINTF_ERROR ("Subscriber store %s was not closed cleanly, start the HSS once to repair it\n", path);
+    ret = EINVAL;
+  }
+
+  if (ret != 0) {
+    hss_store_unmap ();
+  }
+
+  return ret;
+}
+
+/*
+ * Read the users, pdn and mmeidentity tables of the oai_db schema and write
+ * the store. The database lock is held while the rows are streamed.
+ */
+int
+hss_store_import (
+  const hss_config_t * hss_config_p)
+{
+  MYSQL_RES                              *res = NULL;
+  MYSQL_ROW                               row;
+  hss_store_import_user_t                *user = NULL;
+  int                                     have_user = 0;
+  int                                     valid_user = 0;
+  uint32_t                                nb_skipped = 0;
+  int                                     ret = 0;
+
+  if ((hss_config_p->subscriber_store == NULL) || (db_desc == NULL) || (db_desc->db_conn == NULL)) {
+    FPRINTF_ERROR ("Importing the subscriber store needs SUBSCRIBER_STORE and the MySQL database\n");
+    return EINVAL;
+  }
+
+  if ((ret = hss_store_import_map_previous (hss_config_p->subscriber_store)) != 0) {
+    return ret;
+  }
+
+  if (((user = malloc (sizeof (hss_store_import_user_t))) == NULL) || (hss_store_build_begin () != 0)) {
+    free (user);
+    hss_store_unmap ();
+    return ENOMEM;
+  }
+
+  pthread_mutex_lock (&db_desc->db_cs_mutex);
+  FPRINTF_DEBUG ("Query: SELECT `idmmeidentity`,`mmehost`,`mmerealm` FROM `mmeidentity`\n");
+
+  if (mysql_query (db_desc->db_conn, "SELECT `idmmeidentity`,`mmehost`,`mmerealm` FROM `mmeidentity`") ||
+      ((res = mysql_use_result (db_desc->db_conn)) == NULL)) {
+    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+    ret = EINVAL;
+    goto out;
+  }
+
+  while ((row = mysql_fetch_row (res)) != NULL) {
+    unsigned long                          *lengths = mysql_fetch_lengths (res);
+    mysql_mme_identity_t                    mme_identity;
+
+    memset (&mme_identity, 0, sizeof (mme_identity));
+
+    if ((row[1] != NULL) && (lengths[1] < sizeof (mme_identity.mme_host))) {
+      memcpy (mme_identity.mme_host, row[1], lengths[1]);
+    }
+
+    if ((row[2] != NULL) && (lengths[2] < sizeof (mme_identity.mme_realm))) {
+      memcpy (mme_identity.mme_realm, row[2], lengths[2]);
+    }
+
+    if (hss_store_build_add_mme (atoi (row[0]), &mme_identity) != 0) {
+      break;
+    }
+  }
+
+  mysql_free_result (res);
+  FPRINTF_DEBUG ("Query: %s\n", HSS_STORE_IMPORT_USERS_QUERY);
+
+  if (mysql_query (db_desc->db_conn, HSS_STORE_IMPORT_USERS_QUERY) ||
+      ((res = mysql_use_result (db_desc->db_conn)) == NULL)) {
+    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+    ret = EINVAL;
+    goto out;
+  }
+
+  while ((row = mysql_fetch_row (res)) != NULL) {
+    unsigned long                          *lengths = mysql_fetch_lengths (res);
+
+    /*
+     * Rows of one user are consecutive, one per PDN
+     */
+    if (!have_user || (row[0] == NULL) || strcmp (user->ul.imsi, row[0]) ||
+        strcmp (user->mme_id, (row[13] != NULL) ? row[13] : "")) {
+      if (valid_user && ((ret = hss_store_import_add_user (user)) != 0)) {
+        break;
+      }
+
+      have_user = 1;
+      valid_user = (hss_store_import_user_from_row (row, lengths, user) == 0);
+      nb_skipped += !valid_user;
+    }
+
+    if (valid_user && (row[HSS_STORE_IMPORT_PDN_COLUMN] != NULL) && (user->nb_pdns < HSS_STORE_PDN_MAX)) {
+      hss_mysql_pdn_from_row (&row[HSS_STORE_IMPORT_PDN_COLUMN], &lengths[HSS_STORE_IMPORT_PDN_COLUMN], &user->pdns[user->nb_pdns++]);
+    }
+  }
+
+  if ((ret == 0) && valid_user) {
+    ret = hss_store_import_add_user (user);
+  }
+
+  mysql_free_result (res);
+
+out:
+  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+  free (user);
+
+  if (nb_skipped > 0) {
+    FPRINTF_ERROR ("Subscriber store import: %u subscribers skipped\n", nb_skipped);
+  }
+
+  if (ret == 0) {
+    ret = hss_store_build_commit (hss_config_p->subscriber_store);
+  } else {
+    hss_store_build_free ();
+  }
+
+  /*
+   * Unmapped after the commit: the shared lock is held until the new store replaced it
+   */
+  hss_store_unmap ();
+  return ret;
+}
+
+static void
+hss_store_export_string (
+  FILE * file,
+  const char *string)
+{
+  if (string[0] == '\0') {
+    fputs ("NULL", file);
+    return;
+  }
+
+  fputc ('\'', file);
+
+  for (; *string != '\0'; string++) {
+    if ((*string == '\'') || (*string == '\\')) {
+      fputc ('\\', file);
+    }
+
+    fputc (*string, file);
+  }
+
+  fputc ('\'', file);
+}
+
+static void
+hss_store_export_hex (
+  FILE * file,
+  const uint8_t * buffer,
+  int length)
+{
+  int                                     i;
+
+  fputs ("UNHEX('", file);
+
+  for (i = 0; i < length; i++) {
+    fprintf (file, "%02x", buffer[i]);
+  }
+
+  fputs ("')", file);
+}
+
+static const char                      *
+hss_store_export_pdn_type (
+  uint8_t pdn_type)
+{
+  switch (pdn_type) {
+  case IPV6:
+    return "IPv6";
+
+  case IPV4V6:
+    return "IPv4v6";
+
+  case IPV4_OR_IPV6:
+    return "IPv4_or_IPv6";
+
+  default:
+    return "IPv4";
+  }
+}
+
+/*
+ * INSERT statements for an oai_db created from oai_db.sql, a running HSS may
+ * keep updating the store meanwhile.
+ */
+int
+hss_store_export (
+  const hss_config_t * hss_config_p,
+  const char *sql_file)
+{
+  FILE                                   *file = NULL;
+  uint32_t                                nb_rows = 0;
+  uint32_t                                nb_users = 0;
+  uint32_t                                i;
+  int                                     j;
+  int                                     ret = 0;
+
+  if ((hss_config_p->subscriber_store == NULL) || (sql_file == NULL)) {
+    FPRINTF_ERROR ("Exporting the subscriber store needs SUBSCRIBER_STORE\n");
+    return EINVAL;
+  }
+
+  if ((ret = hss_store_map (hss_config_p->subscriber_store, 0)) != 0) {
+    return ret;
+  }
+
+  /*
+   * Torn records of a crashed HSS are repaired by the next start only
+   */
+  if (!hss_store.header->clean && (flock (hss_store.fd, LOCK_SH | LOCK_NB) == 0)) {
+    FPRINTF_ERROR ("Subscriber store %s was not closed cleanly, start the HSS once to repair it\n", hss_config_p->subscriber_store);
+    hss_store_unmap ();
+    return EINVAL;
+  }
+
+  file = (strcmp (sql_file, "-") == 0) ? fdopen (hss_config_p->store_export_fd, "w") : fopen (sql_file, "w");
+
+  if (file == NULL) {
+    ret = errno;
+    FPRINTF_ERROR ("Cannot create %s: %s\n", sql_file, strerror (ret));
+    hss_store_unmap ();
+    return ret;
+  }
+
+  fprintf (file, "-- Subscriber store %s, load it in an oai_db created from oai_db.sql\n", hss_config_p->subscriber_store);
+
+  for (i = 0; i < __atomic_load_n (&hss_store.header->nb_mmes, __ATOMIC_ACQUIRE); i++) {
+    fprintf (file, "%s(%d,", (i == 0) ? "INSERT INTO `mmeidentity` (`idmmeidentity`,`mmehost`,`mmerealm`,`UE-Reachability`) VALUES " : ",", hss_store.mmes[i].id);
+    hss_store_export_string (file, hss_store.mmes[i].identity.mme_host);
+    fputc (',', file);
+    hss_store_export_string (file, hss_store.mmes[i].identity.mme_realm);
+    fputs (",0)", file);
+  }
+
+  if (i > 0) {
+    fputs (";\n", file);
+  }
+
+  for (i = 0; i < hss_store.header->nb_subscribers; i++) {
+    hss_store_subscriber_t                  subscriber;
+    uint32_t                                seq;
+
+    if (hss_store.subscribers[i].imsi_key == 0) {
+      continue;
+    }
+
+    do {
+      seq = hss_store_read_begin (&hss_store.subscribers[i]);
+      memcpy (&subscriber, &hss_store.subscribers[i], sizeof (subscriber));
+    } while (hss_store_read_retry (&hss_store.subscribers[i], seq));
+
+    fputs ((nb_rows == 0) ? "INSERT INTO `users` (`imsi`,`msisdn`,`imei`,`imei_sv`,`ms_ps_status`,`rau_tau_timer`,"
+           "`ue_ambr_ul`,`ue_ambr_dl`,`access_restriction`,`mmeidentity_idmmeidentity`,`key`,`sqn`,`rand`,`OPc`) VALUES\n(" : ",\n(", file);
+    hss_store_export_string (file, subscriber.imsi);
+    fputc (',', file);
+    hss_store_export_string (file, subscriber.msisdn);
+    fputc (',', file);
+    hss_store_export_string (file, subscriber.imei);
+    fputc (',', file);
+    hss_store_export_string (file, subscriber.software_version);
+    fprintf (file, ",'%s',%u,%u,%u,%u,%d,", subscriber.purged ? "PURGED" : "NOT_PURGED", subscriber.rau_tau, subscriber.aggr_ul, subscriber.aggr_dl,
+             subscriber.access_restriction, (subscriber.mme_index != HSS_STORE_NO_MME) ? hss_store.mmes[subscriber.mme_index].id : 0);
+    hss_store_export_hex (file, subscriber.key, KEY_LENGTH);
+    fprintf (file, ",%" PRIu64 ",", subscriber.sqn);
+    hss_store_export_hex (file, subscriber.rand, RAND_LENGTH);
+    fputc (',', file);
+    hss_store_export_hex (file, subscriber.opc, KEY_LENGTH);
+    fputc (')', file);
+    nb_users++;
+
+    if (++nb_rows == HSS_STORE_EXPORT_BATCH) {
+      fputs (";\n", file);
+      nb_rows = 0;
+    }
+  }
+
+  if (nb_rows > 0) {
+    fputs (";\n", file);
+    nb_rows = 0;
+  }
+
+  for (i = 0; i < hss_store.header->nb_subscribers; i++) {
+    const hss_store_subscriber_t           *subscriber = &hss_store.subscribers[i];
+
+    if (subscriber->imsi_key == 0) {
+      continue;
+    }
+
+    for (j = 0; j < subscriber->nb_pdns; j++) {
+      mysql_pdn_t                             pdn;
+
+      hss_store_pdn_to_mysql (&hss_store.pdns[subscriber->pdn_index + j], &pdn);
+      fputs ((nb_rows == 0) ? "INSERT INTO `pdn` (`apn`,`pdn_type`,`pdn_ipv4`,`pdn_ipv6`,`aggregate_ambr_ul`,`aggregate_ambr_dl`,"
+             "`pgw_id`,`users_imsi`,`qci`,`priority_level`,`pre_emp_cap`,`pre_emp_vul`) VALUES\n(" : ",\n(", file);
+      hss_store_export_string (file, pdn.apn);
+      fprintf (file, ",'%s','%s','%s',%u,%u,%d,'%s',%u,%u,'%s','%s')", hss_store_export_pdn_type (pdn.pdn_type),
+               pdn.pdn_address.ipv4_address, pdn.pdn_address.ipv6_address, pdn.aggr_ul, pdn.aggr_dl, pdn.pgw_id, subscriber->imsi,
+               pdn.qci, pdn.priority_level, (pdn.pre_emp_cap == 0) ? "ENABLED" : "DISABLED", (pdn.pre_emp_vul == 1) ? "DISABLED" : "ENABLED");
+
+      if (++nb_rows == HSS_STORE_EXPORT_BATCH) {
+        fputs (";\n", file);
+        nb_rows = 0;
+      }
+    }
+  }
+
+  if (nb_rows > 0) {
+    fputs (";\n", file);
+  }
+
+  if ((fflush (file) != 0) || ferror (file)) {
+    ret = EIO;
+    FPRINTF_ERROR ("Cannot write %s\n", sql_file);
+  }
+
+  if ((fclose (file) != 0) && (ret == 0)) {
+    ret = EIO;
+    FPRINTF_ERROR ("Cannot write %s\n", sql_file);
+  }
+
+  hss_store_unmap ();
+
+  if (ret == 0) {
+    FPRINTF_NOTICE ("Subscriber store exported: %u subscribers\n", nb_users);
+  }
+
+  return ret;
+}
@@ -33,6 +33,62 @@
 #include "db_proto.h"
 #include "log.h"
 
+void
+hss_mysql_pdn_from_row (
+  MYSQL_ROW row,
+  unsigned long *lengths,
+  mysql_pdn_t * pdn_elm)
+{
+  /*
+   * Copying the APN
+   */
+  memset (pdn_elm, 0, sizeof (mysql_pdn_t));
+  memcpy (pdn_elm->apn, row[1], lengths[1]);
+
+  /*
+   * PDN Type + PDN address
+   */
+  if (strcmp (row[2], "IPv6") == 0) {
+    pdn_elm->pdn_type = IPV6;
+    memcpy (pdn_elm->pdn_address.ipv6_address, row[4], lengths[4]);
+    pdn_elm->pdn_address.ipv6_address[lengths[4]] = '\0';
+  } else if (strcmp (row[2], "IPv4v6") == 0) {
+    pdn_elm->pdn_type = IPV4V6;
+    memcpy (pdn_elm->pdn_address.ipv4_address, row[3], lengths[3]);
+    pdn_elm->pdn_address.ipv4_address[lengths[3]] = '\0';
+    memcpy (pdn_elm->pdn_address.ipv6_address, row[4], lengths[4]);
+    pdn_elm->pdn_address.ipv6_address[lengths[4]] = '\0';
+  } else if (strcmp (row[2], "IPv4_or_IPv6") == 0) {
+    pdn_elm->pdn_type = IPV4_OR_IPV6;
+    memcpy (pdn_elm->pdn_address.ipv4_address, row[3], lengths[3]);
+    pdn_elm->pdn_address.ipv4_address[lengths[3]] = '\0';
+    memcpy (pdn_elm->pdn_address.ipv6_address, row[4], lengths[4]);
+    pdn_elm->pdn_address.ipv6_address[lengths[4]] = '\0';
+  } else {
+    pdn_elm->pdn_type = IPV4;
+    memcpy (pdn_elm->pdn_address.ipv4_address, row[3], lengths[3]);
+    pdn_elm->pdn_address.ipv4_address[lengths[3]] = '\0';
+  }
+
+  pdn_elm->aggr_ul = atoi (row[5]);
+  pdn_elm->aggr_dl = atoi (row[6]);
+  pdn_elm->pgw_id = atoi (row[7]);
+  pdn_elm->qci = atoi (row[9]);
+  pdn_elm->priority_level = atoi (row[10]);
+
+  if (strcmp (row[11], "ENABLED") == 0) {
+    pdn_elm->pre_emp_cap = 0;
+  } else {
+    pdn_elm->pre_emp_cap = 1;
+  }
+
+  if (strcmp (row[12], "DISABLED") == 0) {
+    pdn_elm->pre_emp_vul = 1;
+  } else {
+    pdn_elm->pre_emp_vul = 0;
+  }
+}
+
 int
 hss_mysql_query_pdns (
   const char *imsi,
@@ -96,53 +152,7 @@ hss_mysql_query_pdns (
     }
 
     pdn_elm = &pdn_array[*nb_pdns - 1];
-    /*
-     * Copying the APN
-     */
-    memset (pdn_elm, 0, sizeof (mysql_pdn_t));
-    memcpy (pdn_elm->apn, row[1], lengths[1]);
-
-    /*
-     * PDN Type + PDN address
-     */
-    if (strcmp (row[2], "IPv6") == 0) {
-      pdn_elm->pdn_type = IPV6;
-      memcpy (pdn_elm->pdn_address.ipv6_address, row[4], lengths[4]);
-      pdn_elm->pdn_address.ipv6_address[lengths[4]] = '\0';
-    } else if (strcmp (row[2], "IPv4v6") == 0) {
-      pdn_elm->pdn_type = IPV4V6;
-      memcpy (pdn_elm->pdn_address.ipv4_address, row[3], lengths[3]);
-      pdn_elm->pdn_address.ipv4_address[lengths[3]] = '\0';
-      memcpy (pdn_elm->pdn_address.ipv6_address, row[4], lengths[4]);
-      pdn_elm->pdn_address.ipv6_address[lengths[4]] = '\0';
-    } else if (strcmp (row[2], "IPv4_or_IPv6") == 0) {
-      pdn_elm->pdn_type = IPV4_OR_IPV6;
-      memcpy (pdn_elm->pdn_address.ipv4_address, row[3], lengths[3]);
-      pdn_elm->pdn_address.ipv4_address[lengths[3]] = '\0';
-      memcpy (pdn_elm->pdn_address.ipv6_address, row[4], lengths[4]);
-      pdn_elm->pdn_address.ipv6_address[lengths[4]] = '\0';
-    } else {
-      pdn_elm->pdn_type = IPV4;
-      memcpy (pdn_elm->pdn_address.ipv4_address, row[3], lengths[3]);
-      pdn_elm->pdn_address.ipv4_address[lengths[3]] = '\0';
-    }
-
-    pdn_elm->aggr_ul = atoi (row[5]);
-    pdn_elm->aggr_dl = atoi (row[6]);
-    pdn_elm->qci = atoi (row[9]);
-    pdn_elm->priority_level = atoi (row[10]);
-
-    if (strcmp (row[11], "ENABLED") == 0) {
-      pdn_elm->pre_emp_cap = 0;
-    } else {
-      pdn_elm->pre_emp_cap = 1;
-    }
-
-    if (strcmp (row[12], "DISABLED") == 0) {
-      pdn_elm->pre_emp_vul = 1;
-    } else {
-      pdn_elm->pre_emp_vul = 0;
-    }
+    hss_mysql_pdn_from_row (row, lengths, pdn_elm);
   }
 
   mysql_free_result (res);
@@ -36,9 +36,19 @@
 #include "s6a_proto.h"
 #include "auc.h"
 #include "pid_file.h"
+#include "log.h"
 
 hss_config_t                            hss_config;
 
+/* Set by SIGHUP once subscribers were provisioned in the database */
+static volatile sig_atomic_t            hss_reload_subscribers = 0;
+
+static void
+hss_sighup_handler (
+  int signum)
+{
+  hss_reload_subscribers = 1;
+}
 
 int
 main (
@@ -47,6 +57,38 @@ main (
 {
   char   *pid_file_name = NULL;
 
+  memset (&hss_config, 0, sizeof (hss_config_t));
+
+  if (hss_config_init (argc, argv, &hss_config) != 0) {
+    return -1;
+  }
+
+  /*
+   * Maintenance of the subscriber store, the HSS does not start: no daemon
+   * and no pid file lock, the store file has its own lock
+   */
+  if (hss_config.store_import || hss_config.store_export) {
+    int                                     ret = 0;
+
+    if (hss_config.store_import) {
+      if (hss_mysql_connect (&hss_config) != 0) {
+        return -1;
+      }
+
+      if (hss_config.valid_op) {
+        hss_mysql_check_opc_keys ((uint8_t *) hss_config.operator_key_bin);
+      }
+
+      ret = hss_store_import (&hss_config);
+    }
+
+    if ((ret == 0) && hss_config.store_export) {
+      ret = hss_store_export (&hss_config, hss_config.store_export);
+    }
+
+    return (ret == 0) ? 0 : -1;
+  }
+
   pid_file_name = get_exe_basename();
 
 #if DAEMONIZE
@@ -95,32 +137,54 @@ main (
   }
 #endif
 
+  if (hss_config.subscriber_store == NULL) {
+    if (hss_mysql_connect (&hss_config) != 0) {
+      return -1;
+    }
+  }
 
-  memset (&hss_config, 0, sizeof (hss_config_t));
+  random_init ();
 
-  if (hss_config_init (argc, argv, &hss_config) != 0) {
-    return -1;
+  if (hss_config.valid_op && (db_desc != NULL)) {
+    hss_mysql_check_opc_keys ((uint8_t *) hss_config.operator_key_bin);
   }
 
-  if (hss_mysql_connect (&hss_config) != 0) {
-    return -1;
-  }
+  if (hss_config.subscriber_store != NULL) {
+    if (hss_store_init (&hss_config) != 0) {
+      return -1;
+    }
 
-  random_init ();
+    hss_db = &hss_db_store;
+  } else {
+    /*
+     * Load subscribers once OPc keys are up to date
+     */
+    if (hss_cache_init (&hss_config) != 0) {
+      return -1;
+    }
 
-  if (hss_config.valid_op) {
-    hss_mysql_check_opc_keys ((uint8_t *) hss_config.operator_key_bin);
+    hss_cache_prewarm ();
   }
 
   s6a_init (&hss_config);
+  signal (SIGHUP, hss_sighup_handler);
 
   while (1) {
     /*
-     * TODO: handle signals here
+     * TODO: handle other signals here
      */
+    if (hss_reload_subscribers) {
+      hss_reload_subscribers = 0;
+      FPRINTF_NOTICE ("SIGHUP: dropping cached subscribers\n");
+      hss_cache_invalidate_all ();
+    }
+
     sleep (1);
   }
 
+  s6a_subscription_data_cache_exit ();
+  hss_store_exit ();
+  hss_cache_exit ();
   pid_file_unlock();
   free(pid_file_name);
   return 0;
@@ -235,7 +235,7 @@ s6a_auth_info_cb (
   /*
    * Fetch User data
    */
-  if (hss_mysql_auth_info (&auth_info_req, &auth_info_resp) != 0) {
+  if (hss_db->auth_info (&auth_info_req, &auth_info_resp) != 0) {
     /*
      * Database query failed...
      */
@@ -258,15 +258,15 @@ s6a_auth_info_cb (
        * Pick a new RAND and store SQN_MS + RAND in the HSS
        */
       generate_random (vector[0].rand, RAND_LENGTH);
-      hss_mysql_push_rand_sqn (auth_info_req.imsi, vector[0].rand, sqn);
-      hss_mysql_increment_sqn (auth_info_req.imsi);
+      hss_db->push_rand_sqn (auth_info_req.imsi, vector[0].rand, sqn);
+      hss_db->increment_sqn (auth_info_req.imsi);
       free (sqn);
     }
 
     /*
      * Fetch new user data
      */
-    if (hss_mysql_auth_info (&auth_info_req, &auth_info_resp) != 0) {
+    if (hss_db->auth_info (&auth_info_req, &auth_info_resp) != 0) {
       /*
        * Database query failed...
        */
@@ -280,7 +280,7 @@ s6a_auth_info_cb (
       generate_random (vector[i].rand, RAND_LENGTH);
       generate_vector (auth_info_resp.opc, imsi, auth_info_resp.key, hdr->avp_value->os.data, sqn, &vector[i]);
     }
-    hss_mysql_push_rand_sqn (auth_info_req.imsi, vector[num_vectors-1].rand, sqn);
+    hss_db->push_rand_sqn (auth_info_req.imsi, vector[num_vectors-1].rand, sqn);
   } else {
     /*
      * Pick a new RAND and store SQN_MS + RAND in the HSS
@@ -293,10 +293,10 @@ s6a_auth_info_cb (
        */
       generate_vector (auth_info_resp.opc, imsi, auth_info_resp.key, hdr->avp_value->os.data, sqn, &vector[i]);
     }
-    hss_mysql_push_rand_sqn (auth_info_req.imsi, vector[num_vectors-1].rand, sqn);
+    hss_db->push_rand_sqn (auth_info_req.imsi, vector[num_vectors-1].rand, sqn);
   }
 
-  hss_mysql_increment_sqn (auth_info_req.imsi);
+  hss_db->increment_sqn (auth_info_req.imsi);
   /*
    * We add the vector
    */
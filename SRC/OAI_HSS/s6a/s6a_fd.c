@@ -212,6 +212,13 @@ s6a_init (
     goto err;
   }
 
+  ret = s6a_subscription_data_cache_init (hss_config_p->subscription_data_cache_size);
+
+  if (ret != 0) {
+    strcpy (why, "s6a_subscription_data_cache_init");
+    goto err;
+  }
+
   /*
    * Create handler for sessions
    */
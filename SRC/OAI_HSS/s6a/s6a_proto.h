@@ -220,6 +220,13 @@ int s6a_purge_ue_cb(struct msg **msg, struct avp *paramavp,
 
 int s6a_add_subscription_data_avp(struct msg *message, mysql_ul_ans_t *msql_ans);
 
+/** \brief Keep the encoded Subscription-Data of up to size profiles for the
+ * Update-Location-Answers, 0 disables the cache
+ * @returns 0 if the init was successfull, != 0 in case of failure
+ */
+int s6a_subscription_data_cache_init(int size);
+void s6a_subscription_data_cache_exit(void);
+
 int s6a_add_result_code(struct msg *ans, struct avp *failed_avp,
                         int result_code, int experimental);
 
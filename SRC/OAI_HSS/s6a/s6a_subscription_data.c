@@ -20,75 +20,196 @@
  */
 
 
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <time.h>
+
 #include "hss_config.h"
 #include "db_proto.h"
 #include "s6a_proto.h"
+#include "log.h"
 
 /*! \file s6a_subscription_data.c
-   \brief Add the subscription data to a message. Data are retrieved from database
+   \brief Add the subscription data to a message. Data are retrieved from database.
+   The Subscription-Data of a profile (everything but the MSISDN) is encoded once
+   and the bytes are reused by the next answers for the same profile.
    \author Sebastien ROUX <sebastien.roux@eurecom.fr>
    \date 2013
    \version 0.1
 */
 
-int
-s6a_add_subscription_data_avp (
-  struct msg *message,
-  mysql_ul_ans_t * mysql_ans)
-{
-  int                                     ret = -1,
-    i = 0;
-  mysql_pdn_t                            *pdns = NULL;
-  uint8_t                                 nb_pdns = 0;
-  struct avp                             *avp = NULL,
-    *child_avp = NULL;
-  union avp_value                         value;
+#define AVP_CODE_SUBSCRIPTION_DATA              (1400)
+#define AVP_CODE_MSISDN                         (701)
+#define S6A_AVP_HEADER_LENGTH                   (12)
+#define S6A_MSG_HEADER_LENGTH                   (20)
+#define S6A_MSG_CODE_UPDATE_LOCATION            (316)
 
-  if (mysql_ans == NULL) {
-    return -1;
-  }
+/* Same limit as hss_mysql_query_pdns() */
+#define S6A_SUBSCRIPTION_DATA_PDN_MAX           (10)
 
-  ret = hss_mysql_query_pdns (mysql_ans->imsi, &pdns, &nb_pdns);
+/* Answers between two reports of the Subscription-Data build times */
+#define S6A_SUBSCRIPTION_DATA_STATS_PERIOD      (10000)
 
-  if (ret != 0) {
-    /*
-     * mysql query failed:
-     * * * * - maybe no more memory
-     * * * * - maybe user is not known (should have failed before)
-     * * * * - maybe imsi has no EPS subscribed
-     */
-    goto out;
+/*
+ * Everything of the subscription that goes into the cached encoding, the
+ * unused bytes are zeroed so that profiles compare with memcmp.
+ */
+typedef struct s6a_subscription_key_s {
+  uint32_t                                access_restriction;
+  uint32_t                                aggr_ul;
+  uint32_t                                aggr_dl;
+  uint32_t                                rau_tau;
+  uint32_t                                nb_pdns;
+  struct {
+    char                                    apn[61];
+    uint8_t                                 pdn_type;
+    uint8_t                                 qci;
+    uint8_t                                 priority_level;
+    uint8_t                                 pre_emp_cap;
+    uint8_t                                 pre_emp_vul;
+    char                                    ipv4_address[INET_ADDRSTRLEN];
+    char                                    ipv6_address[INET6_ADDRSTRLEN];
+    uint32_t                                aggr_ul;
+    uint32_t                                aggr_dl;
+  } pdns[S6A_SUBSCRIPTION_DATA_PDN_MAX];
+} s6a_subscription_key_t;
+
+#define S6A_SUBSCRIPTION_KEY_LENGTH(nB_pDNS)    (offsetof (s6a_subscription_key_t, pdns) + (nB_pDNS) * sizeof (((s6a_subscription_key_t *) 0)->pdns[0]))
+
+typedef struct s6a_subscription_entry_s {
+  uint32_t                                hash;
+  size_t                                  key_length;
+  s6a_subscription_key_t                  key;
+  /* Children of the Subscription-Data AVP, as freeDiameter encoded them */
+  size_t                                  length;
+  uint8_t                                *encoded;
+} s6a_subscription_entry_t;
+
+typedef struct s6a_subscription_cache_s {
+  /* Direct mapped, a profile replaces the one it collides with. NULL if disabled */
+  s6a_subscription_entry_t              **entries;
+  uint32_t                                mask;
+  pthread_rwlock_t                        lock;
+  /* Knows no AVP: spliced AVPs keep their bytes instead of being decoded */
+  struct dictionary                      *raw_dict;
+
+  pthread_mutex_t                         stats_mutex;
+  uint64_t                                answers;
+  uint64_t                                spliced;
+  uint64_t                                spliced_ns;
+  uint64_t                                encoded_ns;
+  uint64_t                                encoded_avps;
+} s6a_subscription_cache_t;
+
+static s6a_subscription_cache_t s6a_subscription_cache = {
+  .entries = NULL,
+  .lock = PTHREAD_RWLOCK_INITIALIZER,
+  .stats_mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static inline void
+s6a_put_u32 (
+  uint8_t * buffer,
+  uint32_t value)
+{
+  buffer[0] = (value >> 24) & 0xFF;
+  buffer[1] = (value >> 16) & 0xFF;
+  buffer[2] = (value >> 8) & 0xFF;
+  buffer[3] = value & 0xFF;
+}
+
+/*
+ * Returns the length of the TBCD string, 0 if there is no MSISDN
+ */
+static int
+s6a_msisdn_to_tbcd (
+  const char *msisdn,
+  uint8_t * msisdn_tbcd)
+{
+  int                                     msisdn_len = strlen (msisdn);
+  int                                     i;
+
+  if (msisdn_len > 15) {
+    msisdn_len = 15;
   }
 
-  if (nb_pdns == 0) {
-    /*
-     * No PDN for this user -> DIAMETER_ERROR_UNKNOWN_EPS_SUBSCRIPTION
-     */
-    return -1;
+  for (i = 0; i < msisdn_len; i++) {
+    if (i & 0x01) {
+      msisdn_tbcd[i>>1] = msisdn_tbcd[i>>1] & ((msisdn[i] - 0x30) | 0xF0);
+    } else {
+      msisdn_tbcd[i>>1] = ((msisdn[i] - 0x30) << 4) | 0x0F;
+    }
   }
 
+  return (msisdn_len + 1) / 2;
+}
+
+static inline uint64_t
+s6a_elapsed_ns (
+  const struct timespec *start)
+{
+  struct timespec                         now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) * 1000000000ULL + now.tv_nsec - start->tv_nsec;
+}
+
+/*
+ * AVPs of a grouped AVP and of its descendants, one allocation each
+ */
+static uint32_t
+s6a_count_avps (
+  struct avp *avp)
+{
+  struct avp                             *next = avp;
+  uint32_t                                nb_avps = 0;
+  int                                     depth = 0;
+
+  do {
+    nb_avps++;
+
+    if (fd_msg_browse (next, MSG_BRW_WALK, &next, &depth) != 0) {
+      break;
+    }
+  } while ((next != NULL) && (depth > 0));
+
+  return nb_avps;
+}
+
+/*
+ * The Subscription-Data AVP tree, built AVP by AVP
+ */
+static int
+s6a_build_subscription_data_avp (
+  struct avp **avp_p,
+  const mysql_ul_ans_t * mysql_ans,
+  const mysql_pdn_t * pdns,
+  uint8_t nb_pdns,
+  int with_msisdn)
+{
+  int                                     i = 0;
+  struct avp                             *avp = NULL,
+    *child_avp = NULL;
+  union avp_value                         value;
+
   /*
    * Create the Subscription-Data AVP
    */
   CHECK_FCT (fd_msg_avp_new (s6a_cnf.dataobj_s6a_subscription_data, 0, &avp));
   {
-    uint8_t                                 msisdn_len = strlen (mysql_ans->msisdn);
+    uint8_t                                 msisdn_tbcd[8];
+    int                                     msisdn_tbcd_len = with_msisdn ? s6a_msisdn_to_tbcd (mysql_ans->msisdn, msisdn_tbcd) : 0;
 
     /*
      * The MSISDN is known in the HSS, add it to the subscription data
      */
-    if (msisdn_len > 0) {
+    if (msisdn_tbcd_len > 0) {
       CHECK_FCT (fd_msg_avp_new (s6a_cnf.dataobj_s6a_msisdn, 0, &child_avp));
-      uint8_t msisdn_tbcd[16] = {0};
-      for (int i = 0; i < msisdn_len; i++) {
-        if (i & 0x01) {
-          msisdn_tbcd[i>>1] = msisdn_tbcd[i>>1] & ((mysql_ans->msisdn[i] - 0x30) | 0xF0);
-        } else {
-          msisdn_tbcd[i>>1] = ((mysql_ans->msisdn[i] - 0x30) << 4) | 0x0F;
-        }
-      }
-      value.os.data = (uint8_t *) msisdn_tbcd;
-      value.os.len = (msisdn_len + 1) /2;
+      value.os.data = msisdn_tbcd;
+      value.os.len = msisdn_tbcd_len;
       CHECK_FCT (fd_msg_avp_setvalue (child_avp, &value));
       CHECK_FCT (fd_msg_avp_add (avp, MSG_BRW_LAST_CHILD, child_avp));
     }
@@ -179,7 +300,7 @@ s6a_add_subscription_data_avp (
 
     for (i = 0; i < nb_pdns; i++) {
       struct avp                             *apn_configuration;
-      mysql_pdn_t                            *pdn_elm;
+      const mysql_pdn_t                      *pdn_elm;
 
       pdn_elm = &pdns[i];
       /*
@@ -301,10 +422,378 @@ s6a_add_subscription_data_avp (
   value.u32 = (uint32_t) mysql_ans->rau_tau;
   CHECK_FCT (fd_msg_avp_setvalue (child_avp, &value));
   CHECK_FCT (fd_msg_avp_add (avp, MSG_BRW_LAST_CHILD, child_avp));
+  *avp_p = avp;
+  return 0;
+}
+
+static uint32_t
+s6a_subscription_key_fill (
+  s6a_subscription_key_t * key,
+  const mysql_ul_ans_t * mysql_ans,
+  const mysql_pdn_t * pdns,
+  uint8_t nb_pdns)
+{
+  uint32_t                                hash = 2166136261U;
+  const uint8_t                          *p = (const uint8_t *)key;
+  size_t                                  i;
+
+  memset (key, 0, sizeof (s6a_subscription_key_t));
+  key->access_restriction = mysql_ans->access_restriction;
+  key->aggr_ul = mysql_ans->aggr_ul;
+  key->aggr_dl = mysql_ans->aggr_dl;
+  key->rau_tau = mysql_ans->rau_tau;
+  key->nb_pdns = nb_pdns;
+
+  for (i = 0; i < nb_pdns; i++) {
+    strncpy (key->pdns[i].apn, pdns[i].apn, sizeof (key->pdns[i].apn) - 1);
+    key->pdns[i].pdn_type = pdns[i].pdn_type;
+    key->pdns[i].qci = pdns[i].qci;
+    key->pdns[i].priority_level = pdns[i].priority_level;
+    key->pdns[i].pre_emp_cap = pdns[i].pre_emp_cap;
+    key->pdns[i].pre_emp_vul = pdns[i].pre_emp_vul;
+    strncpy (key->pdns[i].ipv4_address, pdns[i].pdn_address.ipv4_address, sizeof (key->pdns[i].ipv4_address) - 1);
+    strncpy (key->pdns[i].ipv6_address, pdns[i].pdn_address.ipv6_address, sizeof (key->pdns[i].ipv6_address) - 1);
+    key->pdns[i].aggr_ul = pdns[i].aggr_ul;
+    key->pdns[i].aggr_dl = pdns[i].aggr_dl;
+  }
+
+  /*
+   * FNV-1a
+   */
+  for (i = 0; i < S6A_SUBSCRIPTION_KEY_LENGTH (nb_pdns); i++) {
+    hash = (hash ^ p[i]) * 16777619U;
+  }
+
+  return hash;
+}
+
+/*
+ * Encode the profile once in a scratch message and keep the bytes of the
+ * children of its Subscription-Data AVP.
+ */
+static int
+s6a_subscription_data_encode (
+  const s6a_subscription_key_t * key,
+  uint32_t hash,
+  const mysql_ul_ans_t * mysql_ans,
+  const mysql_pdn_t * pdns,
+  uint8_t nb_pdns)
+{
+  s6a_subscription_entry_t               *entry = NULL;
+  s6a_subscription_entry_t               *old_entry = NULL;
+  struct msg                             *scratch = NULL;
+  struct avp                             *avp = NULL;
+  uint8_t                                *buffer = NULL;
+  size_t                                  length = 0;
+  uint32_t                                avp_length = 0;
+
+  CHECK_FCT (fd_msg_new (s6a_cnf.dataobj_s6a_loc_up, MSGFL_ALLOC_ETEID, &scratch));
+
+  if ((s6a_build_subscription_data_avp (&avp, mysql_ans, pdns, nb_pdns, 0) != 0) ||
+      (fd_msg_avp_add (scratch, MSG_BRW_LAST_CHILD, avp) != 0) ||
+      (fd_msg_bufferize (scratch, &buffer, &length) != 0)) {
+    fd_msg_free (scratch);
+    return EINVAL;
+  }
+
+  fd_msg_free (scratch);
+
+  /*
+   * The Subscription-Data AVP is the only one of the message
+   */
+  avp_length = (buffer[S6A_MSG_HEADER_LENGTH + 5] << 16) | (buffer[S6A_MSG_HEADER_LENGTH + 6] << 8) | buffer[S6A_MSG_HEADER_LENGTH + 7];
+
+  if ((length < S6A_MSG_HEADER_LENGTH + S6A_AVP_HEADER_LENGTH) || (avp_length < S6A_AVP_HEADER_LENGTH) ||
+      (S6A_MSG_HEADER_LENGTH + avp_length > length) || ((entry = malloc (sizeof (s6a_subscription_entry_t))) == NULL)) {
+    free (buffer);
+    return EINVAL;
+  }
+
+  entry->hash = hash;
+  entry->key_length = S6A_SUBSCRIPTION_KEY_LENGTH (key->nb_pdns);
+  memcpy (&entry->key, key, sizeof (s6a_subscription_key_t));
+  entry->length = avp_length - S6A_AVP_HEADER_LENGTH;
+
+  if ((entry->encoded = malloc (entry->length)) == NULL) {
+    free (entry);
+    free (buffer);
+    return ENOMEM;
+  }
+
+  memcpy (entry->encoded, &buffer[S6A_MSG_HEADER_LENGTH + S6A_AVP_HEADER_LENGTH], entry->length);
+  free (buffer);
+
+  pthread_rwlock_wrlock (&s6a_subscription_cache.lock);
+
+  if (s6a_subscription_cache.entries != NULL) {
+    old_entry = s6a_subscription_cache.entries[hash & s6a_subscription_cache.mask];
+    s6a_subscription_cache.entries[hash & s6a_subscription_cache.mask] = entry;
+    entry = NULL;
+  }
+
+  pthread_rwlock_unlock (&s6a_subscription_cache.lock);
+
+  if (old_entry != NULL) {
+    free (old_entry->encoded);
+    free (old_entry);
+  }
+
+  if (entry != NULL) {
+    free (entry->encoded);
+    free (entry);
+  }
+
+  return 0;
+}
+
+/*
+ * Add a Subscription-Data AVP made of the MSISDN and the cached encoding of
+ * the profile. The bytes are wrapped in a message parsed against a dictionary
+ * that knows no AVP: the AVP keeps its raw data and is written as is in the
+ * answer. One AVP is allocated instead of the tree, plus the buffer, the
+ * scratch message and the copy of the raw data. ENOENT if the profile is not
+ * cached.
+ */
+static int
+s6a_subscription_data_splice (
+  struct msg *message,
+  const s6a_subscription_key_t * key,
+  uint32_t hash,
+  const char *msisdn)
+{
+  s6a_subscription_entry_t               *entry = NULL;
+  struct msg                             *scratch = NULL;
+  struct avp                             *avp = NULL;
+  struct avp_hdr                         *hdr = NULL;
+  uint8_t                                 msisdn_tbcd[8];
+  int                                     msisdn_tbcd_len = s6a_msisdn_to_tbcd (msisdn, msisdn_tbcd);
+  uint32_t                                msisdn_avp_length = (msisdn_tbcd_len > 0) ? S6A_AVP_HEADER_LENGTH + msisdn_tbcd_len : 0;
+  uint32_t                                avp_length = 0;
+  size_t                                  length = 0;
+  uint8_t                                *buffer = NULL;
+  uint8_t                                *p = NULL;
+
+  pthread_rwlock_rdlock (&s6a_subscription_cache.lock);
+  entry = s6a_subscription_cache.entries[hash & s6a_subscription_cache.mask];
+
+  if ((entry == NULL) || (entry->hash != hash) || (entry->key_length != S6A_SUBSCRIPTION_KEY_LENGTH (key->nb_pdns)) ||
+      (memcmp (&entry->key, key, entry->key_length) != 0)) {
+    pthread_rwlock_unlock (&s6a_subscription_cache.lock);
+    return ENOENT;
+  }
+
+  avp_length = S6A_AVP_HEADER_LENGTH + ((msisdn_avp_length + 3) & ~3U) + entry->length;
+  length = S6A_MSG_HEADER_LENGTH + avp_length;
+
+  if ((buffer = calloc (1, length)) == NULL) {
+    pthread_rwlock_unlock (&s6a_subscription_cache.lock);
+    return ENOMEM;
+  }
+
+  memcpy (&buffer[length - entry->length], entry->encoded, entry->length);
+  pthread_rwlock_unlock (&s6a_subscription_cache.lock);
+
+  /*
+   * Diameter header, version 1
+   */
+  s6a_put_u32 (&buffer[0], length);
+  buffer[0] = 1;
+  s6a_put_u32 (&buffer[4], S6A_MSG_CODE_UPDATE_LOCATION);
+  s6a_put_u32 (&buffer[8], APP_S6A);
+  /*
+   * Subscription-Data, the M bit is set once parsed
+   */
+  p = &buffer[S6A_MSG_HEADER_LENGTH];
+  s6a_put_u32 (&p[0], AVP_CODE_SUBSCRIPTION_DATA);
+  s6a_put_u32 (&p[4], avp_length);
+  p[4] = AVP_FLAG_VENDOR;
+  s6a_put_u32 (&p[8], VENDOR_3GPP);
+  p += S6A_AVP_HEADER_LENGTH;
+
+  if (msisdn_avp_length > 0) {
+    s6a_put_u32 (&p[0], AVP_CODE_MSISDN);
+    s6a_put_u32 (&p[4], msisdn_avp_length);
+    p[4] = AVP_FLAG_VENDOR | AVP_FLAG_MANDATORY;
+    s6a_put_u32 (&p[8], VENDOR_3GPP);
+    memcpy (&p[S6A_AVP_HEADER_LENGTH], msisdn_tbcd, msisdn_tbcd_len);
+  }
+
+  /*
+   * The scratch message owns the buffer from now on
+   */
+  if (fd_msg_parse_buffer (&buffer, length, &scratch) != 0) {
+    free (buffer);
+    return EINVAL;
+  }
+
+  if ((fd_msg_browse (scratch, MSG_BRW_FIRST_CHILD, &avp, NULL) != 0) || (avp == NULL) ||
+      (fd_msg_parse_dict (avp, s6a_subscription_cache.raw_dict, NULL) != 0) ||
+      (fd_msg_avp_unhook (avp) != 0)) {
+    fd_msg_free (scratch);
+    return EINVAL;
+  }
+
+  fd_msg_free (scratch);
+  CHECK_FCT (fd_msg_avp_hdr (avp, &hdr));
+  hdr->avp_flags |= AVP_FLAG_MANDATORY;
+  CHECK_FCT (fd_msg_avp_add (message, MSG_BRW_LAST_CHILD, avp));
+  return 0;
+}
+
+static void
+s6a_subscription_data_stats (
+  int spliced,
+  uint64_t ns,
+  uint32_t nb_avps)
+{
+  pthread_mutex_lock (&s6a_subscription_cache.stats_mutex);
+  s6a_subscription_cache.answers++;
+
+  if (spliced) {
+    s6a_subscription_cache.spliced++;
+    s6a_subscription_cache.spliced_ns += ns;
+  } else {
+    s6a_subscription_cache.encoded_ns += ns;
+    s6a_subscription_cache.encoded_avps += nb_avps;
+  }
+
+  if ((s6a_subscription_cache.answers % S6A_SUBSCRIPTION_DATA_STATS_PERIOD) == 0) {
+    uint64_t                                encoded = s6a_subscription_cache.answers - s6a_subscription_cache.spliced;
+
+    FPRINTF_NOTICE ("Subscription-Data of %" PRIu64 " answers: %" PRIu64 " spliced in %" PRIu64 " ns (1 AVP allocated), "
+                    "%" PRIu64 " built in %" PRIu64 " ns (%" PRIu64 " AVPs allocated)\n",
+                    s6a_subscription_cache.answers,
+                    s6a_subscription_cache.spliced,
+                    s6a_subscription_cache.spliced ? s6a_subscription_cache.spliced_ns / s6a_subscription_cache.spliced : 0,
+                    encoded,
+                    encoded ? s6a_subscription_cache.encoded_ns / encoded : 0,
+                    encoded ? s6a_subscription_cache.encoded_avps / encoded : 0);
+  }
+
+  pthread_mutex_unlock (&s6a_subscription_cache.stats_mutex);
+}
+
+int
+s6a_subscription_data_cache_init (
+  int size)
+{
+  uint32_t                                nb_entries = 1;
+
+  if (size <= 0) {
+    FPRINTF_NOTICE ("Subscription-Data cache disabled\n");
+    return 0;
+  }
+
+  while (nb_entries < (uint32_t) size) {
+    nb_entries <<= 1;
+  }
+
+  CHECK_FCT (fd_dict_init (&s6a_subscription_cache.raw_dict));
+
+  if ((s6a_subscription_cache.entries = calloc (nb_entries, sizeof (s6a_subscription_entry_t *))) == NULL) {
+    fd_dict_fini (&s6a_subscription_cache.raw_dict);
+    return ENOMEM;
+  }
+
+  s6a_subscription_cache.mask = nb_entries - 1;
+  FPRINTF_NOTICE ("Subscription-Data cache of %u profiles\n", nb_entries);
+  return 0;
+}
+
+void
+s6a_subscription_data_cache_exit (
+  void)
+{
+  s6a_subscription_entry_t              **entries = NULL;
+  uint32_t                                i;
+
+  pthread_rwlock_wrlock (&s6a_subscription_cache.lock);
+  entries = s6a_subscription_cache.entries;
+  s6a_subscription_cache.entries = NULL;
+  pthread_rwlock_unlock (&s6a_subscription_cache.lock);
+
+  if (entries == NULL) {
+    return;
+  }
+
+  for (i = 0; i <= s6a_subscription_cache.mask; i++) {
+    if (entries[i] != NULL) {
+      free (entries[i]->encoded);
+      free (entries[i]);
+    }
+  }
+
+  free (entries);
+  fd_dict_fini (&s6a_subscription_cache.raw_dict);
+}
+
+int
+s6a_add_subscription_data_avp (
+  struct msg *message,
+  mysql_ul_ans_t * mysql_ans)
+{
+  int                                     ret = -1;
+  mysql_pdn_t                            *pdns = NULL;
+  uint8_t                                 nb_pdns = 0;
+  struct avp                             *avp = NULL;
+  s6a_subscription_key_t                  key;
+  uint32_t                                hash = 0;
+  struct timespec                         start;
+
+  if (mysql_ans == NULL) {
+    return -1;
+  }
+
+  ret = hss_db->query_pdns (mysql_ans->imsi, &pdns, &nb_pdns);
+
+  if (ret != 0) {
+    /*
+     * mysql query failed:
+     * * * * - maybe no more memory
+     * * * * - maybe user is not known (should have failed before)
+     * * * * - maybe imsi has no EPS subscribed
+     */
+    goto out;
+  }
+
+  if (nb_pdns == 0) {
+    /*
+     * No PDN for this user -> DIAMETER_ERROR_UNKNOWN_EPS_SUBSCRIPTION
+     */
+    free (pdns);
+    return -1;
+  }
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+
+  /*
+   * The profile is its own version: a change of the subscriber or PDN data
+   * gives another key, the previous encoding is never served again.
+   */
+  if ((s6a_subscription_cache.entries != NULL) && (nb_pdns <= S6A_SUBSCRIPTION_DATA_PDN_MAX)) {
+    hash = s6a_subscription_key_fill (&key, mysql_ans, pdns, nb_pdns);
+
+    if ((s6a_subscription_data_splice (message, &key, hash, mysql_ans->msisdn) == 0) ||
+        ((s6a_subscription_data_encode (&key, hash, mysql_ans, pdns, nb_pdns) == 0) &&
+         (s6a_subscription_data_splice (message, &key, hash, mysql_ans->msisdn) == 0))) {
+      s6a_subscription_data_stats (1, s6a_elapsed_ns (&start), 1);
+      goto out;
+    }
+  }
+
+  /*
+   * Cache disabled or profile not cacheable
+   */
+  CHECK_FCT (s6a_build_subscription_data_avp (&avp, mysql_ans, pdns, nb_pdns, 1));
   /*
    * Add the AVP to the message
    */
   CHECK_FCT (fd_msg_avp_add (message, MSG_BRW_LAST_CHILD, avp));
+  {
+    uint64_t                                ns = s6a_elapsed_ns (&start);
+
+    s6a_subscription_data_stats (0, ns, s6a_count_avps (avp));
+  }
 out:
 
   if (pdns) {
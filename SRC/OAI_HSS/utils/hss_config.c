@@ -62,6 +62,14 @@
 #define HSS_CONFIG_STRING_OPERATOR_KEY             "OPERATOR_key"
 #define HSS_CONFIG_STRING_RANDOM                   "RANDOM"
 #define HSS_CONFIG_STRING_FREEDIAMETER_CONF_FILE   "FD_conf"
+#define HSS_CONFIG_STRING_SUBSCRIBER_CACHE_TTL     "SUBSCRIBER_CACHE_TTL"
+#define HSS_CONFIG_STRING_SUBSCRIBER_CACHE_FLUSH   "SUBSCRIBER_CACHE_FLUSH_MS"
+#define HSS_CONFIG_STRING_SUBSCRIPTION_DATA_CACHE  "SUBSCRIPTION_DATA_CACHE_SIZE"
+#define HSS_CONFIG_STRING_SUBSCRIBER_STORE         "SUBSCRIBER_STORE"
+
+#define HSS_SUBSCRIBER_CACHE_TTL_DEFAULT           (300)
+#define HSS_SUBSCRIBER_CACHE_FLUSH_MS_DEFAULT      (100)
+#define HSS_SUBSCRIPTION_DATA_CACHE_SIZE_DEFAULT   (4096)
 
 
 // LG TODO fd_g_debug_lvl
@@ -82,10 +90,12 @@ static struct option                    long_options[] = {
   {"config", 1, 0, 'c'},
   {"help", 0, 0, 'h'},
   {"version", 0, 0, 'v'},
+  {"import-store", 0, 0, 'i'},
+  {"export-store", 1, 0, 'e'},
   {0, 0, 0, 0},
 };
 
-static const char                       option_string[] = "c:vh";
+static const char                       option_string[] = "c:vhie:";
 
 int
 hss_config_init (
@@ -176,7 +186,13 @@ usage (
   FPRINTF_NOTICE ( "\t\tSet the configuration file for hss\n");
   FPRINTF_NOTICE ( "\t\tSee template in conf dir\n\n");
   FPRINTF_NOTICE ( "\t--version\n\t-v\n");
-  FPRINTF_NOTICE ( "\t\tPrint %s version and return\n", PACKAGE_NAME);
+  FPRINTF_NOTICE ( "\t\tPrint %s version and return\n\n", PACKAGE_NAME);
+  FPRINTF_NOTICE ( "\t--import-store\n\t-i\n");
+  FPRINTF_NOTICE ( "\t\tBuild the SUBSCRIBER_STORE file from the MySQL database and return\n");
+  FPRINTF_NOTICE ( "\t\tSubscribers already in the store keep their SQN, RAND, MME and purged state\n\n");
+  FPRINTF_NOTICE ( "\t--export-store=<path>\n\t-e<path>\n");
+  FPRINTF_NOTICE ( "\t\tWrite the SUBSCRIBER_STORE content as SQL for the oai_db schema and return\n");
+  FPRINTF_NOTICE ( "\t\tA path of - writes it to the standard output, the messages then go to the standard error\n");
 }
 
 static void
@@ -186,6 +202,8 @@ hss_config_display (
   FPRINTF_NOTICE ( "Configuration\n");
   FPRINTF_NOTICE ( "* Global:\n");
   FPRINTF_NOTICE ( "\t- File .............: %s\n", hss_config_p->config);
+  FPRINTF_NOTICE ( "* Subscriber store:\n");
+  FPRINTF_NOTICE ( "\t- File .............: %s\n", (hss_config_p->subscriber_store == NULL) ? "None, MySQL" : hss_config_p->subscriber_store);
   FPRINTF_NOTICE ( "* MYSQL:\n");
   FPRINTF_NOTICE ( "\t- Server ...........: %s\n", hss_config_p->mysql_server);
   FPRINTF_NOTICE ( "\t- Database .........: %s\n", hss_config_p->mysql_database);
@@ -214,6 +232,30 @@ hss_config_parse_command_line (
       }
       break;
 
+    case 'i':{
+        hss_config_p->store_import = 1;
+      }
+      break;
+
+    case 'e':{
+        hss_config_p->store_export = strdup (optarg);
+
+        if (strcmp (optarg, "-") == 0) {
+          /*
+           * The SQL is written to the standard output, keep it aside and
+           * send the banner, the configuration and the notices to stderr
+           */
+          fflush (stdout);
+          hss_config_p->store_export_fd = dup (STDOUT_FILENO);
+
+          if ((hss_config_p->store_export_fd < 0) || (dup2 (STDERR_FILENO, STDOUT_FILENO) < 0)) {
+            FPRINTF_ERROR ("Cannot redirect the standard output: %s\n", strerror (errno));
+            return errno;
+          }
+        }
+      }
+      break;
+
     case 'v':{
         /*
          * We display version and return immediately
@@ -265,31 +307,40 @@ hss_config_parse_file (
   }
   setting = config_lookup(&cfg, HSS_CONFIG_STRING_MAIN_SECTION);
   if (setting != NULL) {
+    int                                     mysql_required = 1;
+
+    /*
+     * MySQL is optional with the embedded subscriber store, except to import it
+     */
+    if (  (config_setting_lookup_string( setting, HSS_CONFIG_STRING_SUBSCRIBER_STORE, (const char **)&astring) ) && (astring[0] != '\0')) {
+      hss_config_p->subscriber_store = strdup(astring);
+      mysql_required = hss_config_p->store_import;
+    }
 
     if (  (config_setting_lookup_string( setting, HSS_CONFIG_STRING_MYSQL_SERVER, (const char **)&astring) )) {
       hss_config_p->mysql_server = strdup(astring);
-    } else {
+    } else if (mysql_required) {
       FPRINTF_ERROR( "Failed to parse HSS configuration file token %s astring %s!\n", HSS_CONFIG_STRING_MYSQL_SERVER, astring);
       return ret;
     }
 
     if (  (config_setting_lookup_string( setting, HSS_CONFIG_STRING_MYSQL_USER, (const char **)&astring) )) {
       hss_config_p->mysql_user = strdup(astring);
-    } else {
+    } else if (mysql_required) {
       FPRINTF_ERROR( "Failed to parse HSS configuration file token %s!\n", HSS_CONFIG_STRING_MYSQL_USER);
       return ret;
     }
 
     if (  (config_setting_lookup_string( setting, HSS_CONFIG_STRING_MYSQL_PASS, (const char **)&astring) )) {
       hss_config_p->mysql_password = strdup(astring);
-    } else {
+    } else if (mysql_required) {
       FPRINTF_ERROR( "Failed to parse HSS configuration file token %s!\n", HSS_CONFIG_STRING_MYSQL_PASS);
       return ret;
     }
 
     if (  (config_setting_lookup_string( setting, HSS_CONFIG_STRING_MYSQL_DB, (const char **)&astring) )) {
       hss_config_p->mysql_database = strdup(astring);
-    } else {
+    } else if (mysql_required) {
       FPRINTF_ERROR( "Failed to parse HSS configuration file token %s!\n", HSS_CONFIG_STRING_MYSQL_DB);
       return ret;
     }
@@ -314,6 +365,23 @@ hss_config_parse_file (
       FPRINTF_ERROR( "Failed to parse HSS configuration file token %s!\n", HSS_CONFIG_STRING_FREEDIAMETER_CONF_FILE);
       return ret;
     }
+
+    /*
+     * Optional subscriber cache tuning
+     */
+    if (! config_setting_lookup_int( setting, HSS_CONFIG_STRING_SUBSCRIBER_CACHE_TTL, &hss_config_p->subscriber_cache_ttl)) {
+      hss_config_p->subscriber_cache_ttl = HSS_SUBSCRIBER_CACHE_TTL_DEFAULT;
+    }
+
+    if ((! config_setting_lookup_int( setting, HSS_CONFIG_STRING_SUBSCRIBER_CACHE_FLUSH, &hss_config_p->subscriber_cache_flush_ms)) ||
+        (hss_config_p->subscriber_cache_flush_ms <= 0)) {
+      hss_config_p->subscriber_cache_flush_ms = HSS_SUBSCRIBER_CACHE_FLUSH_MS_DEFAULT;
+    }
+
+    if ((! config_setting_lookup_int( setting, HSS_CONFIG_STRING_SUBSCRIPTION_DATA_CACHE, &hss_config_p->subscription_data_cache_size)) ||
+        (hss_config_p->subscription_data_cache_size < 0)) {
+      hss_config_p->subscription_data_cache_size = HSS_SUBSCRIPTION_DATA_CACHE_SIZE_DEFAULT;
+    }
   } else {
     FPRINTF_ERROR( "Failed to parse HSS configuration file main HSS section not found!\n");
     return ret;
@@ -41,6 +41,21 @@ typedef struct hss_config_s {
 
   char *random;
   char  random_bool;
+
+  /* Subscriber cache time to live in seconds, 0 disables the cache */
+  int   subscriber_cache_ttl;
+  /* Period of the SQN/RAND write-behind to the database, or of the store sync to disk */
+  int   subscriber_cache_flush_ms;
+  /* Encoded Subscription-Data profiles reused by the Update-Location-Answers, 0 disables the cache */
+  int   subscription_data_cache_size;
+
+  /* Embedded subscriber store file used instead of MySQL, NULL if not configured */
+  char *subscriber_store;
+  /* Command line: build the store from the MySQL database, or dump it as SQL, then exit */
+  int   store_import;
+  char *store_export;
+  /* Standard output kept for the SQL of --export-store=-, stdout then goes to stderr */
+  int   store_export_fd;
 } hss_config_t;
 
 int hss_config_init(int argc, char *argv[], hss_config_t *hss_config_p);
@@ -46,6 +46,7 @@
 #include "udp_primitives_server.h"
 #include "s1ap_mme.h"
 #include "timer.h"
+#include "signals.h"
 #include "mme_app_extern.h"
 #include "nas_defs.h"
 #include "s11_mme.h"
@@ -57,6 +58,15 @@
 
 #include "oai_mme.h"
 #include "pid_file.h"
+#include "metrics.h"
+
+//------------------------------------------------------------------------------
+static void oai_mme_reload_config (void)
+{
+  if (RETURNok == mme_config_reload_served_areas (&mme_config)) {
+    OAILOG_NOTICE (LOG_CONFIG, "Served TAIs reloaded from %s\n", bdata(mme_config.config_file));
+  }
+}
 
 int
 main (
@@ -134,6 +144,7 @@ main (
           NULL,
 #endif
           NULL));
+  CHECK_INIT_RETURN (itti_task_placements_config_apply (&mme_config.itti_config.task_placements));
   MSC_INIT (MSC_MME, THREAD_MAX + TASK_MAX);
   CHECK_INIT_RETURN (nas_init (&mme_config));
   CHECK_INIT_RETURN (sctp_init (&mme_config));
@@ -142,8 +153,12 @@ main (
   CHECK_INIT_RETURN (s1ap_mme_init());
   CHECK_INIT_RETURN (mme_app_init (&mme_config));
   CHECK_INIT_RETURN (s6a_init (&mme_config));
+  if (mme_config.metrics_port) {
+    CHECK_INIT_RETURN (metrics_server_start (mme_config.metrics_port));
+  }
 
   OAILOG_DEBUG(LOG_MME_APP, "MME app initialization complete\n");
+  signal_set_hup_handler (oai_mme_reload_config);
   /*
    * Handle signals here
    */
@@ -54,7 +54,7 @@
 #include "oai_sgw.h"
 #include "pid_file.h"
 #include "timer.h"
-
+#include "metrics.h"
 
 int
 main (
@@ -128,11 +128,15 @@ main (
           NULL,
 #endif
           NULL));
+  CHECK_INIT_RETURN (itti_task_placements_config_apply (&spgw_config.sgw_config.itti_config.task_placements));
   MSC_INIT (MSC_SP_GW, THREAD_MAX + TASK_MAX);
   CHECK_INIT_RETURN (udp_init ());
   CHECK_INIT_RETURN (s11_sgw_init (&spgw_config.sgw_config));
   //CHECK_INIT_RETURN (gtpv1u_init (&spgw_config));
   CHECK_INIT_RETURN (sgw_init (&spgw_config));
+  if (spgw_config.sgw_config.metrics_port) {
+    CHECK_INIT_RETURN (metrics_server_start (spgw_config.sgw_config.metrics_port));
+  }
   /*
    * Handle signals here
    */
@@ -32,6 +32,7 @@
 #include "NwGtpv2cMsg.h"
 #include "NwGtpv2cMsgParser.h"
 
+#include "mme_config.h"
 #include "s11_common.h"
 #include "s11_mme_bearer_manager.h"
 #include "s11_ie_formatter.h"
@@ -146,7 +147,7 @@ s11_mme_handle_release_access_bearer_response (
   DevAssert (NW_OK == rc);
   rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
   DevAssert (NW_OK == rc);
-  return itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  return itti_send_msg_to_task (MME_APP_TASK_ID(resp_p->teid), INSTANCE_DEFAULT, message_p);
 }
 
 //------------------------------------------------------------------------------
@@ -268,5 +269,5 @@ s11_mme_handle_modify_bearer_response (
   DevAssert (NW_OK == rc);
   rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
   DevAssert (NW_OK == rc);
-  return itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  return itti_send_msg_to_task (MME_APP_TASK_ID(resp_p->teid), INSTANCE_DEFAULT, message_p);
 }
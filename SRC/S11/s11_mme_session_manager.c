@@ -33,6 +33,7 @@
 #include "NwGtpv2cMsg.h"
 #include "NwGtpv2cMsgParser.h"
 
+#include "mme_config.h"
 #include "s11_common.h"
 #include "s11_mme_session_manager.h"
 #include "s11_ie_formatter.h"
@@ -199,7 +200,7 @@ s11_mme_handle_create_session_response (
 
   MSC_LOG_RX_MESSAGE (MSC_S11_MME, MSC_SGW, NULL, 0, "0 CREATE_SESSION_RESPONSE local S11 teid " TEID_FMT " num bearer ctxt %u", resp_p->teid,
     resp_p->bearer_contexts_created.num_bearer_context);
-  return itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  return itti_send_msg_to_task (MME_APP_TASK_ID(resp_p->teid), INSTANCE_DEFAULT, message_p);
 }
 
 //------------------------------------------------------------------------------
@@ -346,5 +347,5 @@ s11_mme_handle_delete_session_response (
 
   DevAssert (HASH_TABLE_OK == hash_rc);
 
-  return itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  return itti_send_msg_to_task (MME_APP_TASK_ID(resp_p->teid), INSTANCE_DEFAULT, message_p);
 }
@@ -24,6 +24,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <assert.h>
+#include <stdint.h>
 
 #include "assertions.h"
 #include "hashtable.h"
@@ -38,10 +39,43 @@
 #include "s11_mme.h"
 #include "s11_mme_session_manager.h"
 #include "s11_mme_bearer_manager.h"
-
-static NwGtpv2cStackHandleT             s11_mme_stack_handle = 0;
+#include "udp_mmsg.h"
+#include "metrics.h"
+
+// One GTPv2-C stack instance per S11 task: a stack and everything it allocates are only used by the thread of its task
+typedef struct s11_mme_worker_s {
+  task_id_t                               task_id;
+  NwGtpv2cStackHandleT                    stack_handle;
+  // TASK_S11 owns the S11 socket, the other S11 tasks send on it through their own queue
+  udp_mmsg_endpoint_t                    *udp_endpoint;
+} s11_mme_worker_t;
+
+static s11_mme_worker_t                 s11_mme_workers[S11_WORKERS_MAX];
+static int                              s11_mme_num_workers = 1;
 // Store the GTPv2-C teid handle
 hash_table_ts_t                        *s11_mme_teid_2_gtv2c_teid_handle = NULL;
+
+typedef enum {
+  S11_MME_METRIC_CREATE_SESSION = 0,
+  S11_MME_METRIC_MODIFY_BEARER,
+  S11_MME_METRIC_DELETE_SESSION,
+  S11_MME_METRIC_RELEASE_ACCESS_BEARERS,
+  S11_MME_METRIC_MAX
+} s11_mme_metric_t;
+
+static const char                      *s11_mme_metric_names[S11_MME_METRIC_MAX] = {
+  "CreateSession",
+  "ModifyBearer",
+  "DeleteSession",
+  "ReleaseAccessBearers",
+};
+
+// [procedure][sent, error] for the requests, [procedure][ok, error] for the responses
+static metric_id_t                      s11_mme_request_metrics[S11_MME_METRIC_MAX][2];
+static metric_id_t                      s11_mme_response_metrics[S11_MME_METRIC_MAX][2];
+static metric_id_t                      s11_mme_unhandled_metric = 0;
+
+#define S11_MME_METRICS_COUNT(mETRICS, pROCEDURE, rET)  metrics_inc ((mETRICS)[(pROCEDURE)][(0 == (rET)) ? 0 : 1])
 //------------------------------------------------------------------------------
 static NwRcT
 s11_mme_log_wrapper (
@@ -55,6 +89,25 @@ s11_mme_log_wrapper (
   return NW_OK;
 }
 
+//------------------------------------------------------------------------------
+static void
+s11_mme_metrics_init (
+  void)
+{
+  for (int i = 0; i < S11_MME_METRIC_MAX; i++) {
+    s11_mme_request_metrics[i][0] = metrics_register ("mme_s11_messages_total", METRIC_COUNTER, "GTPv2-C messages on S11",
+        "message=\"%sRequest\",result=\"sent\"", s11_mme_metric_names[i]);
+    s11_mme_request_metrics[i][1] = metrics_register ("mme_s11_messages_total", METRIC_COUNTER, "GTPv2-C messages on S11",
+        "message=\"%sRequest\",result=\"error\"", s11_mme_metric_names[i]);
+    s11_mme_response_metrics[i][0] = metrics_register ("mme_s11_messages_total", METRIC_COUNTER, "GTPv2-C messages on S11",
+        "message=\"%sResponse\",result=\"ok\"", s11_mme_metric_names[i]);
+    s11_mme_response_metrics[i][1] = metrics_register ("mme_s11_messages_total", METRIC_COUNTER, "GTPv2-C messages on S11",
+        "message=\"%sResponse\",result=\"error\"", s11_mme_metric_names[i]);
+  }
+  s11_mme_unhandled_metric = metrics_register ("mme_s11_messages_total", METRIC_COUNTER, "GTPv2-C messages on S11",
+      "message=\"unhandled\",result=\"error\"");
+}
+
 //------------------------------------------------------------------------------
 static NwRcT
 s11_mme_ulp_process_stack_req_cb (
@@ -62,6 +115,7 @@ s11_mme_ulp_process_stack_req_cb (
   NwGtpv2cUlpApiT * pUlpApi)
 {
   //     NwRcT rc = NW_OK;
+  s11_mme_worker_t                       *worker = (s11_mme_worker_t *) hUlp;
   int                                     ret = 0;
 
   DevAssert (pUlpApi );
@@ -72,23 +126,28 @@ s11_mme_ulp_process_stack_req_cb (
 
     switch (pUlpApi->apiInfo.triggeredRspIndInfo.msgType) {
     case NW_GTP_CREATE_SESSION_RSP:
-      ret = s11_mme_handle_create_session_response (&s11_mme_stack_handle, pUlpApi);
+      ret = s11_mme_handle_create_session_response (&worker->stack_handle, pUlpApi);
+      S11_MME_METRICS_COUNT (s11_mme_response_metrics, S11_MME_METRIC_CREATE_SESSION, ret);
       break;
 
     case NW_GTP_DELETE_SESSION_RSP:
-      ret = s11_mme_handle_delete_session_response (&s11_mme_stack_handle, pUlpApi);
+      ret = s11_mme_handle_delete_session_response (&worker->stack_handle, pUlpApi);
+      S11_MME_METRICS_COUNT (s11_mme_response_metrics, S11_MME_METRIC_DELETE_SESSION, ret);
       break;
 
     case NW_GTP_MODIFY_BEARER_RSP:
-      ret = s11_mme_handle_modify_bearer_response (&s11_mme_stack_handle, pUlpApi);
+      ret = s11_mme_handle_modify_bearer_response (&worker->stack_handle, pUlpApi);
+      S11_MME_METRICS_COUNT (s11_mme_response_metrics, S11_MME_METRIC_MODIFY_BEARER, ret);
       break;
 
     case NW_GTP_RELEASE_ACCESS_BEARERS_RSP:
-      ret = s11_mme_handle_release_access_bearer_response (&s11_mme_stack_handle, pUlpApi);
+      ret = s11_mme_handle_release_access_bearer_response (&worker->stack_handle, pUlpApi);
+      S11_MME_METRICS_COUNT (s11_mme_response_metrics, S11_MME_METRIC_RELEASE_ACCESS_BEARERS, ret);
       break;
 
     default:
       OAILOG_WARNING (LOG_S11, "Received unhandled message type %d\n", pUlpApi->apiInfo.triggeredRspIndInfo.msgType);
+      metrics_inc (s11_mme_unhandled_metric);
       break;
     }
 
@@ -110,19 +169,44 @@ s11_mme_send_udp_msg (
   uint32_t peerIpAddr,
   uint32_t peerPort)
 {
-  // Create and alloc new message
-  MessageDef                             *message_p;
-  udp_data_req_t                         *udp_data_req_p;
-  int                                     ret = 0;
+  s11_mme_worker_t                       *worker = (s11_mme_worker_t *) udpHandle;
+  // Copied in the send queue of the task, flushed at the end of its event loop iteration
+  int                                     ret = udp_mmsg_send (worker->udp_endpoint, buffer, buffer_len, peerIpAddr, (uint16_t) peerPort);
 
-  message_p = itti_alloc_new_message (TASK_S11, UDP_DATA_REQ);
-  udp_data_req_p = &message_p->ittiMsg.udp_data_req;
-  udp_data_req_p->peer_address = peerIpAddr;
-  udp_data_req_p->peer_port = peerPort;
-  udp_data_req_p->buffer = buffer;
-  udp_data_req_p->buffer_length = buffer_len;
-  ret = itti_send_msg_to_task (TASK_UDP, INSTANCE_DEFAULT, message_p);
-  return ((ret == 0) ? NW_OK : NW_FAILURE);
+  return ((ret == RETURNok) ? NW_OK : NW_FAILURE);
+}
+
+//------------------------------------------------------------------------------
+static void
+s11_mme_udp_data_ind (
+  void *arg,
+  uint8_t * buffer,
+  uint32_t length,
+  uint32_t peer_address,
+  uint16_t peer_port)
+{
+  s11_mme_worker_t                       *worker = (s11_mme_worker_t *) arg;
+  uint32_t                                instance = 0;
+  NwRcT                                   rc;
+
+  /*
+   * Received by TASK_S11, processed in place if it is for its own stack instance
+   */
+  if ((s11_mme_num_workers > 1) && (nwGtpv2cGetUdpReqInstance (buffer, length, s11_mme_num_workers, &instance) == NW_OK) && (instance != 0)) {
+    MessageDef                           *message_p = itti_alloc_new_message (TASK_S11, UDP_DATA_IND);
+
+    UDP_DATA_IND (message_p).buffer = itti_malloc (TASK_S11, s11_mme_workers[instance].task_id, length);
+    DevAssert (UDP_DATA_IND (message_p).buffer != NULL);
+    memcpy (UDP_DATA_IND (message_p).buffer, buffer, length);
+    UDP_DATA_IND (message_p).buffer_length = length;
+    UDP_DATA_IND (message_p).peer_address = peer_address;
+    UDP_DATA_IND (message_p).peer_port = peer_port;
+    itti_send_msg_to_task (s11_mme_workers[instance].task_id, INSTANCE_DEFAULT, message_p);
+    return;
+  }
+
+  rc = nwGtpv2cProcessUdpReq (worker->stack_handle, buffer, length, peer_port, peer_address);
+  DevAssert (rc == NW_OK);
 }
 
 //------------------------------------------------------------------------------
@@ -135,13 +219,15 @@ s11_mme_start_timer_wrapper (
   void *timeoutArg,
   NwGtpv2cTimerHandleT * hTmr)
 {
+  s11_mme_worker_t                       *worker = (s11_mme_worker_t *) tmrMgrHandle;
   long                                    timer_id;
   int                                     ret = 0;
 
+  // the expiry is processed by the task of the stack instance
   if (tmrType == NW_GTPV2C_TMR_TYPE_REPETITIVE) {
-    ret = timer_setup (timeoutSec, timeoutUsec, TASK_S11, INSTANCE_DEFAULT, TIMER_PERIODIC, timeoutArg, &timer_id);
+    ret = timer_setup (timeoutSec, timeoutUsec, worker->task_id, INSTANCE_DEFAULT, TIMER_PERIODIC, timeoutArg, &timer_id);
   } else {
-    ret = timer_setup (timeoutSec, timeoutUsec, TASK_S11, INSTANCE_DEFAULT, TIMER_ONE_SHOT, timeoutArg, &timer_id);
+    ret = timer_setup (timeoutSec, timeoutUsec, worker->task_id, INSTANCE_DEFAULT, TIMER_ONE_SHOT, timeoutArg, &timer_id);
   }
 
   *hTmr = (NwGtpv2cTimerHandleT) timer_id;
@@ -164,65 +250,94 @@ static void                            *
 s11_mme_thread (
   void *args)
 {
-  itti_mark_task_ready (TASK_S11);
+  const int                               worker_index = (int)(intptr_t)args;
+  s11_mme_worker_t                       *worker = &s11_mme_workers[worker_index];
+  int                                     nb_events = 0;
+  struct epoll_event                     *events = NULL;
+
+  itti_mark_task_ready (worker->task_id);
   OAILOG_START_USE ();
   MSC_START_USE ();
 
+  if (0 == worker_index) {
+    itti_subscribe_event_fd (worker->task_id, udp_mmsg_endpoint_get_fd (worker->udp_endpoint));
+  }
+
   while (1) {
     MessageDef                             *received_message_p = NULL;
 
-    itti_receive_msg (TASK_S11, &received_message_p);
-    assert (received_message_p );
-
-    switch (ITTI_MSG_ID (received_message_p)) {
-    case S11_CREATE_SESSION_REQUEST:{
-        s11_mme_create_session_request (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_create_session_request);
-      }
-      break;
-
-    case S11_MODIFY_BEARER_REQUEST:{
-        s11_mme_modify_bearer_request (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_modify_bearer_request);
+    itti_receive_msg (worker->task_id, &received_message_p);
+
+    if (received_message_p != NULL) {
+      switch (ITTI_MSG_ID (received_message_p)) {
+      case S11_CREATE_SESSION_REQUEST:{
+          S11_MME_METRICS_COUNT (s11_mme_request_metrics, S11_MME_METRIC_CREATE_SESSION,
+              s11_mme_create_session_request (&worker->stack_handle, &received_message_p->ittiMsg.s11_create_session_request));
+        }
+        break;
+
+      case S11_MODIFY_BEARER_REQUEST:{
+          S11_MME_METRICS_COUNT (s11_mme_request_metrics, S11_MME_METRIC_MODIFY_BEARER,
+              s11_mme_modify_bearer_request (&worker->stack_handle, &received_message_p->ittiMsg.s11_modify_bearer_request));
+        }
+        break;
+
+
+      case S11_DELETE_SESSION_REQUEST:{
+          S11_MME_METRICS_COUNT (s11_mme_request_metrics, S11_MME_METRIC_DELETE_SESSION,
+              s11_mme_delete_session_request (&worker->stack_handle, &received_message_p->ittiMsg.s11_delete_session_request));
+        }
+        break;
+
+      case S11_RELEASE_ACCESS_BEARERS_REQUEST:{
+          S11_MME_METRICS_COUNT (s11_mme_request_metrics, S11_MME_METRIC_RELEASE_ACCESS_BEARERS,
+              s11_mme_release_access_bearers_request (&worker->stack_handle, &received_message_p->ittiMsg.s11_release_access_bearers_request));
+        }
+        break;
+
+      case UDP_DATA_IND:{
+          // datagram for this stack instance, forwarded by TASK_S11
+          DevAssert (nwGtpv2cProcessUdpReq (worker->stack_handle, UDP_DATA_IND (received_message_p).buffer, UDP_DATA_IND (received_message_p).buffer_length,
+                (uint16_t) UDP_DATA_IND (received_message_p).peer_port, UDP_DATA_IND (received_message_p).peer_address) == NW_OK);
+          itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), UDP_DATA_IND (received_message_p).buffer);
+        }
+        break;
+
+      case TIMER_HAS_EXPIRED:{
+          OAILOG_DEBUG (LOG_S11, "Processing timeout for timer_id 0x%lx and arg %p\n", received_message_p->ittiMsg.timer_has_expired.timer_id, received_message_p->ittiMsg.timer_has_expired.arg);
+          DevAssert (nwGtpv2cProcessTimeout (received_message_p->ittiMsg.timer_has_expired.arg) == NW_OK);
+        }
+        break;
+
+      case TERMINATE_MESSAGE:{
+          udp_mmsg_endpoint_destroy (worker->udp_endpoint);
+          itti_exit_task ();
+        }
+        break;
+
+      default:{
+          OAILOG_ERROR (LOG_S11, "Unkwnon message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
+        }
+        break;
       }
-      break;
-
-
-    case S11_DELETE_SESSION_REQUEST:{
-        s11_mme_delete_session_request (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_delete_session_request);
-      }
-      break;
-
-    case S11_RELEASE_ACCESS_BEARERS_REQUEST:{
-        s11_mme_release_access_bearers_request (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_release_access_bearers_request);
-      }
-      break;
-
-    case UDP_DATA_IND:{
-        /*
-         * We received new data to handle from the UDP layer
-         */
-        NwRcT                                   rc;
-        udp_data_ind_t                         *udp_data_ind;
-
-        udp_data_ind = &received_message_p->ittiMsg.udp_data_ind;
-        rc = nwGtpv2cProcessUdpReq (s11_mme_stack_handle, udp_data_ind->buffer, udp_data_ind->buffer_length, udp_data_ind->peer_port, udp_data_ind->peer_address);
-        DevAssert (rc == NW_OK);
-      }
-      break;
 
-    case TIMER_HAS_EXPIRED:{
-        OAILOG_DEBUG (LOG_S11, "Processing timeout for timer_id 0x%lx and arg %p\n", received_message_p->ittiMsg.timer_has_expired.timer_id, received_message_p->ittiMsg.timer_has_expired.arg);
-        DevAssert (nwGtpv2cProcessTimeout (received_message_p->ittiMsg.timer_has_expired.arg) == NW_OK);
-      }
-      break;
+      itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+      received_message_p = NULL;
+    }
 
-    default:{
-        OAILOG_ERROR (LOG_S11, "Unkwnon message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
+    /*
+     * Datagrams received on the S11 socket, processed in place or forwarded to the task of their stack instance
+     */
+    if (0 == worker_index) {
+      nb_events = itti_get_events (worker->task_id, &events);
+      for (int i = 0; (i < nb_events) && (events != NULL); i++) {
+        if ((events[i].events != 0) && (events[i].data.fd == udp_mmsg_endpoint_get_fd (worker->udp_endpoint))) {
+          udp_mmsg_receive (worker->udp_endpoint, s11_mme_udp_data_ind, worker);
+        }
       }
-      break;
     }
 
-    itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
-    received_message_p = NULL;
+    udp_mmsg_flush (worker->udp_endpoint);
   }
 
   return NULL;
@@ -230,80 +345,93 @@ s11_mme_thread (
 
 //------------------------------------------------------------------------------
 static int
-s11_send_init_udp (
-  char *address,
-  uint16_t port_number)
+s11_mme_worker_init (
+  s11_mme_worker_t * const worker,
+  const int worker_index)
 {
-  MessageDef                             *message_p = itti_alloc_new_message (TASK_S11, UDP_INIT);
-  if (message_p == NULL) {
-    return RETURNerror;
-  }
-  message_p->ittiMsg.udp_init.port = port_number;
-  message_p->ittiMsg.udp_init.address = address;
-  OAILOG_DEBUG (LOG_S11, "Tx UDP_INIT IP addr %s:%d\n", message_p->ittiMsg.udp_init.address, message_p->ittiMsg.udp_init.port);
-  return itti_send_msg_to_task (TASK_UDP, INSTANCE_DEFAULT, message_p);
-}
-
-//------------------------------------------------------------------------------
-int
-s11_mme_init (
-  const mme_config_t * mme_config_p)
-{
-  int                                     ret = 0;
   NwGtpv2cUlpEntityT                      ulp;
   NwGtpv2cUdpEntityT                      udp;
   NwGtpv2cTimerMgrEntityT                 tmrMgr;
   NwGtpv2cLogMgrEntityT                   logMgr;
-  struct in_addr                          addr;
-  char                                   *s11_address_str = NULL;
 
-  OAILOG_DEBUG (LOG_S11, "Initializing S11 interface\n");
+  worker->task_id = TASK_S11 + worker_index;
 
-  if (nwGtpv2cInitialize (&s11_mme_stack_handle) != NW_OK) {
-    OAILOG_ERROR (LOG_S11, "Failed to initialize gtpv2-c stack\n");
-    goto fail;
+  if (nwGtpv2cInitialize (&worker->stack_handle) != NW_OK) {
+    OAILOG_ERROR (LOG_S11, "Failed to initialize gtpv2-c stack %d\n", worker_index);
+    return RETURNerror;
   }
 
   /*
    * Set ULP entity
    */
-  ulp.hUlp = (NwGtpv2cUlpHandleT) NULL;
+  ulp.hUlp = (NwGtpv2cUlpHandleT) worker;
   ulp.ulpReqCallback = s11_mme_ulp_process_stack_req_cb;
-  DevAssert (NW_OK == nwGtpv2cSetUlpEntity (s11_mme_stack_handle, &ulp));
+  DevAssert (NW_OK == nwGtpv2cSetUlpEntity (worker->stack_handle, &ulp));
   /*
    * Set UDP entity
    */
-  udp.hUdp = (NwGtpv2cUdpHandleT) NULL;
+  udp.hUdp = (NwGtpv2cUdpHandleT) worker;
   udp.udpDataReqCallback = s11_mme_send_udp_msg;
-  DevAssert (NW_OK == nwGtpv2cSetUdpEntity (s11_mme_stack_handle, &udp));
+  DevAssert (NW_OK == nwGtpv2cSetUdpEntity (worker->stack_handle, &udp));
   /*
    * Set Timer entity
    */
-  tmrMgr.tmrMgrHandle = (NwGtpv2cTimerMgrHandleT) NULL;
+  tmrMgr.tmrMgrHandle = (NwGtpv2cTimerMgrHandleT) worker;
   tmrMgr.tmrStartCallback = s11_mme_start_timer_wrapper;
   tmrMgr.tmrStopCallback = s11_mme_stop_timer_wrapper;
-  DevAssert (NW_OK == nwGtpv2cSetTimerMgrEntity (s11_mme_stack_handle, &tmrMgr));
+  DevAssert (NW_OK == nwGtpv2cSetTimerMgrEntity (worker->stack_handle, &tmrMgr));
   logMgr.logMgrHandle = 0;
   logMgr.logReqCallback = s11_mme_log_wrapper;
-  DevAssert (NW_OK == nwGtpv2cSetLogMgrEntity (s11_mme_stack_handle, &logMgr));
+  DevAssert (NW_OK == nwGtpv2cSetLogMgrEntity (worker->stack_handle, &logMgr));
+  /*
+   * The responses to the requests of this instance are dispatched to it by their sequence number
+   */
+  DevAssert (NW_OK == nwGtpv2cSetSeqNumRange (worker->stack_handle, worker_index, s11_mme_num_workers));
+  DevAssert (NW_OK == nwGtpv2cSetLogLevel (worker->stack_handle, NW_LOG_LEVEL_DEBG));
 
-  if (itti_create_task (TASK_S11, &s11_mme_thread, NULL) < 0) {
-    OAILOG_ERROR (LOG_S11, "gtpv1u phtread_create: %s\n", strerror (errno));
-    goto fail;
+  if (0 == worker_index) {
+    mme_config_read_lock (&mme_config);
+    worker->udp_endpoint = udp_mmsg_endpoint_create (mme_config.ipv4.s11, mme_config.ipv4.port_s11, UDP_MMSG_BATCH_SIZE);
+    mme_config_unlock (&mme_config);
+  } else {
+    worker->udp_endpoint = udp_mmsg_endpoint_share (s11_mme_workers[0].udp_endpoint, UDP_MMSG_BATCH_SIZE);
   }
+  if (!worker->udp_endpoint) {
+    OAILOG_ERROR (LOG_S11, "Failed to create S11 socket for task %d\n", worker_index);
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int
+s11_mme_init (
+  const mme_config_t * mme_config_p)
+{
+  int                                     ret = 0;
 
-  DevAssert (NW_OK == nwGtpv2cSetLogLevel (s11_mme_stack_handle, NW_LOG_LEVEL_DEBG));
-  mme_config_read_lock (&mme_config);
-  addr.s_addr = mme_config.ipv4.s11;
-  s11_address_str = inet_ntoa (addr);
-  DevAssert (s11_address_str );
-  s11_send_init_udp (s11_address_str, mme_config.ipv4.port_s11);
-  mme_config_unlock (&mme_config);
+  OAILOG_DEBUG (LOG_S11, "Initializing S11 interface\n");
 
   bstring b = bfromcstr("s11_mme_teid_2_gtv2c_teid_handle");
   s11_mme_teid_2_gtv2c_teid_handle = hashtable_ts_create(mme_config_p->max_ues, HASH_TABLE_DEFAULT_HASH_FUNC, hash_free_int_func, b);
   bdestroy(b);
 
+  s11_mme_metrics_init ();
+
+  s11_mme_num_workers = mme_config_p->num_s11_workers;
+  for (int i = 0; i < s11_mme_num_workers; i++) {
+    if (s11_mme_worker_init (&s11_mme_workers[i], i) != RETURNok) {
+      goto fail;
+    }
+  }
+
+  for (int i = 0; i < s11_mme_num_workers; i++) {
+    if (itti_create_task (TASK_S11 + i, &s11_mme_thread, (void *)(intptr_t)i) < 0) {
+      OAILOG_ERROR (LOG_S11, "S11 task %d phtread_create: %s\n", i, strerror (errno));
+      goto fail;
+    }
+  }
+
   OAILOG_DEBUG (LOG_S11, "Initializing S11 interface: DONE\n");
   return ret;
 fail:
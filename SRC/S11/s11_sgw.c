@@ -40,10 +40,19 @@
 #include "s11_sgw.h"
 #include "s11_sgw_bearer_manager.h"
 #include "s11_sgw_session_manager.h"
+#include "udp_mmsg.h"
 
+#define S11_SGW_GTPV2C_PORT                     (2123)
 
 static NwGtpv2cStackHandleT             s11_sgw_stack_handle = 0;
 
+// S11 socket, owned by TASK_S11
+static udp_mmsg_endpoint_t             *s11_sgw_udp_endpoint = NULL;
+static ipv4_nbo_t                       s11_sgw_address = 0;
+
+// Number of SPGW_APP worker tasks, S11 messages are dispatched on them by TEID
+static int                              s11_sgw_num_app_workers = 1;
+
 /* ULP callback for the GTPv2-C stack */
 //------------------------------------------------------------------------------
 static NwRcT s11_sgw_ulp_process_stack_req_cb (NwGtpv2cUlpHandleT hUlp, NwGtpv2cUlpApiT * pUlpApi)
@@ -96,19 +105,24 @@ static NwRcT s11_sgw_send_udp_msg (
   uint32_t peerIpAddr,
   uint32_t peerPort)
 {
-  // Create and alloc new message
-  MessageDef                             *message_p;
-  udp_data_req_t                         *udp_data_req_p;
-  int                                     ret = 0;
+  // Copied in the send queue of the socket, flushed at the end of the event loop iteration
+  int                                     ret = udp_mmsg_send (s11_sgw_udp_endpoint, buffer, buffer_len, peerIpAddr, (uint16_t) peerPort);
 
-  message_p = itti_alloc_new_message (TASK_S11, UDP_DATA_REQ);
-  udp_data_req_p = &message_p->ittiMsg.udp_data_req;
-  udp_data_req_p->peer_address = peerIpAddr;
-  udp_data_req_p->peer_port = peerPort;
-  udp_data_req_p->buffer = buffer;
-  udp_data_req_p->buffer_length = buffer_len;
-  ret = itti_send_msg_to_task (TASK_UDP, INSTANCE_DEFAULT, message_p);
-  return ret == 0 ? NW_OK : NW_FAILURE;
+  return ret == RETURNok ? NW_OK : NW_FAILURE;
+}
+
+//------------------------------------------------------------------------------
+static void s11_sgw_udp_data_ind (
+  void *arg,
+  uint8_t * buffer,
+  uint32_t length,
+  uint32_t peer_address,
+  uint16_t peer_port)
+{
+  NwRcT                                   rc;
+
+  rc = nwGtpv2cProcessUdpReq (s11_sgw_stack_handle, buffer, length, peer_port, peer_address);
+  DevAssert (rc == NW_OK);
 }
 
 //------------------------------------------------------------------------------
@@ -160,89 +174,90 @@ static NwRcT s11_sgw_stop_timer_wrapper (
 //------------------------------------------------------------------------------
 static void *s11_sgw_thread (void *args)
 {
+  int                                     nb_events = 0;
+  struct epoll_event                     *events = NULL;
+
   itti_mark_task_ready (TASK_S11);
   OAILOG_START_USE ();
 
+  s11_sgw_udp_endpoint = udp_mmsg_endpoint_create (s11_sgw_address, S11_SGW_GTPV2C_PORT, UDP_MMSG_BATCH_SIZE);
+  AssertFatal (s11_sgw_udp_endpoint != NULL, "Failed to create S11 socket\n");
+  itti_subscribe_event_fd (TASK_S11, udp_mmsg_endpoint_get_fd (s11_sgw_udp_endpoint));
+
   while (1) {
     MessageDef                             *received_message_p = NULL;
 
     itti_receive_msg (TASK_S11, &received_message_p);
 
-    switch (ITTI_MSG_ID (received_message_p)) {
-    case UDP_DATA_IND:{
-        /*
-         * We received new data to handle from the UDP layer
-         */
-        NwRcT                                   rc;
-        udp_data_ind_t                         *udp_data_ind;
-
-        udp_data_ind = &received_message_p->ittiMsg.udp_data_ind;
-        OAILOG_DEBUG (LOG_S11, "Processing new data indication from UDP\n");
-        rc = nwGtpv2cProcessUdpReq (s11_sgw_stack_handle, udp_data_ind->buffer, udp_data_ind->buffer_length, udp_data_ind->peer_port, udp_data_ind->peer_address);
-        DevAssert (rc == NW_OK);
-      }
-      break;
-
-    case S11_CREATE_SESSION_RESPONSE:{
-        OAILOG_DEBUG (LOG_S11, "Received S11_CREATE_SESSION_RESPONSE from S-PGW APP\n");
-        s11_sgw_handle_create_session_response (&s11_sgw_stack_handle, &received_message_p->ittiMsg.s11_create_session_response);
-      }
-      break;
-
-    case S11_MODIFY_BEARER_RESPONSE:{
-        OAILOG_DEBUG (LOG_S11, "Received S11_MODIFY_BEARER_RESPONSE from S-PGW APP\n");
-        s11_sgw_handle_modify_bearer_response (&s11_sgw_stack_handle, &received_message_p->ittiMsg.s11_modify_bearer_response);
-      }
-      break;
-
-    case S11_DELETE_SESSION_RESPONSE:{
-        OAILOG_DEBUG (LOG_S11, "Received S11_DELETE_SESSION_RESPONSE from S-PGW APP\n");
-        s11_sgw_handle_delete_session_response (&s11_sgw_stack_handle, &received_message_p->ittiMsg.s11_delete_session_response);
+    if (received_message_p != NULL) {
+      switch (ITTI_MSG_ID (received_message_p)) {
+      case S11_CREATE_SESSION_RESPONSE:{
+          OAILOG_DEBUG (LOG_S11, "Received S11_CREATE_SESSION_RESPONSE from S-PGW APP\n");
+          s11_sgw_handle_create_session_response (&s11_sgw_stack_handle, &received_message_p->ittiMsg.s11_create_session_response);
+        }
+        break;
+
+      case S11_MODIFY_BEARER_RESPONSE:{
+          OAILOG_DEBUG (LOG_S11, "Received S11_MODIFY_BEARER_RESPONSE from S-PGW APP\n");
+          s11_sgw_handle_modify_bearer_response (&s11_sgw_stack_handle, &received_message_p->ittiMsg.s11_modify_bearer_response);
+        }
+        break;
+
+      case S11_DELETE_SESSION_RESPONSE:{
+          OAILOG_DEBUG (LOG_S11, "Received S11_DELETE_SESSION_RESPONSE from S-PGW APP\n");
+          s11_sgw_handle_delete_session_response (&s11_sgw_stack_handle, &received_message_p->ittiMsg.s11_delete_session_response);
+        }
+        break;
+
+      case S11_RELEASE_ACCESS_BEARERS_RESPONSE:{
+          OAILOG_DEBUG (LOG_S11, "Received S11_RELEASE_ACCESS_BEARERS_RESPONSE from S-PGW APP\n");
+          s11_sgw_handle_release_access_bearers_response (&s11_sgw_stack_handle, &received_message_p->ittiMsg.s11_release_access_bearers_response);
+        }
+        break;
+
+      case TIMER_HAS_EXPIRED:{
+          OAILOG_DEBUG (LOG_S11, "Received event TIMER_HAS_EXPIRED for timer_id 0x%lx and arg %p\n",
+              received_message_p->ittiMsg.timer_has_expired.timer_id, received_message_p->ittiMsg.timer_has_expired.arg);
+          DevAssert (nwGtpv2cProcessTimeout (received_message_p->ittiMsg.timer_has_expired.arg) == NW_OK);
+        }
+        break;
+
+      case TERMINATE_MESSAGE:{
+          udp_mmsg_endpoint_destroy (s11_sgw_udp_endpoint);
+          itti_exit_task ();
+        }
+        break;
+
+      default:{
+          OAILOG_ERROR (LOG_S11, "Unkwnon message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
+        }
+        break;
       }
-      break;
-
-    case S11_RELEASE_ACCESS_BEARERS_RESPONSE:{
-        OAILOG_DEBUG (LOG_S11, "Received S11_RELEASE_ACCESS_BEARERS_RESPONSE from S-PGW APP\n");
-        s11_sgw_handle_release_access_bearers_response (&s11_sgw_stack_handle, &received_message_p->ittiMsg.s11_release_access_bearers_response);
-      }
-      break;
 
-    case TIMER_HAS_EXPIRED:{
-        OAILOG_DEBUG (LOG_S11, "Received event TIMER_HAS_EXPIRED for timer_id 0x%lx and arg %p\n",
-            received_message_p->ittiMsg.timer_has_expired.timer_id, received_message_p->ittiMsg.timer_has_expired.arg);
-        DevAssert (nwGtpv2cProcessTimeout (received_message_p->ittiMsg.timer_has_expired.arg) == NW_OK);
-      }
-      break;
+      itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+      received_message_p = NULL;
+    }
 
-    default:{
-        OAILOG_ERROR (LOG_S11, "Unkwnon message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
+    /*
+     * Datagrams received on the S11 socket, processed in place
+     */
+    nb_events = itti_get_events (TASK_S11, &events);
+    for (int i = 0; (i < nb_events) && (events != NULL); i++) {
+      if ((events[i].events != 0) && (events[i].data.fd == udp_mmsg_endpoint_get_fd (s11_sgw_udp_endpoint))) {
+        udp_mmsg_receive (s11_sgw_udp_endpoint, s11_sgw_udp_data_ind, NULL);
       }
-      break;
     }
 
-    itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
-    received_message_p = NULL;
+    udp_mmsg_flush (s11_sgw_udp_endpoint);
   }
 
   return NULL;
 }
 
 //------------------------------------------------------------------------------
-static int s11_send_init_udp (char *address, uint16_t port_number)
+task_id_t s11_sgw_app_task (const teid_t teid)
 {
-  MessageDef                             *message_p;
-
-  message_p = itti_alloc_new_message (TASK_S11, UDP_INIT);
-
-  if (message_p == NULL) {
-    return RETURNerror;
-  }
-
-  message_p->ittiMsg.udp_init.port = port_number;
-  //LG message_p->ittiMsg.udpInit.address = "0.0.0.0"; //ANY address
-  message_p->ittiMsg.udp_init.address = address;
-  OAILOG_DEBUG (LOG_S11, "Tx UDP_INIT IP addr %s\n", message_p->ittiMsg.udp_init.address);
-  return itti_send_msg_to_task (TASK_UDP, INSTANCE_DEFAULT, message_p);
+  return (task_id_t)(TASK_SPGW_APP + SGW_APP_WORKER_INDEX(s11_sgw_num_app_workers, teid));
 }
 
 //------------------------------------------------------------------------------
@@ -253,8 +268,6 @@ int s11_sgw_init (sgw_config_t * config_p)
   NwGtpv2cUdpEntityT                      udp;
   NwGtpv2cTimerMgrEntityT                 tmrMgr;
   NwGtpv2cLogMgrEntityT                   logMgr;
-  struct in_addr                          addr;
-  char                                   *s11_address_str = NULL;
 
   OAILOG_DEBUG (LOG_S11, "Initializing S11 interface\n");
 
@@ -286,18 +299,17 @@ int s11_sgw_init (sgw_config_t * config_p)
   logMgr.logReqCallback = s11_sgw_log_wrapper;
   DevAssert (NW_OK == nwGtpv2cSetLogMgrEntity (s11_sgw_stack_handle, &logMgr));
 
+  DevAssert (NW_OK == nwGtpv2cSetLogLevel (s11_sgw_stack_handle, NW_LOG_LEVEL_DEBG));
+  sgw_config_read_lock (config_p);
+  s11_sgw_address = config_p->ipv4.S11;
+  s11_sgw_num_app_workers = config_p->num_app_workers;
+  sgw_config_unlock (config_p);
+
   if (itti_create_task (TASK_S11, &s11_sgw_thread, NULL) < 0) {
     OAILOG_ERROR (LOG_S11, "S11 pthread_create: %s\n", strerror (errno));
     goto fail;
   }
 
-  DevAssert (NW_OK == nwGtpv2cSetLogLevel (s11_sgw_stack_handle, NW_LOG_LEVEL_DEBG));
-  sgw_config_read_lock (config_p);
-  addr.s_addr = config_p->ipv4.S11;
-  sgw_config_unlock (config_p);
-  s11_address_str = inet_ntoa (addr);
-  DevAssert (s11_address_str );
-  s11_send_init_udp (s11_address_str, 2123);
   OAILOG_DEBUG (LOG_S11, "Initializing S11 interface: DONE\n");
   return ret;
 fail:
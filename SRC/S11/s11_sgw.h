@@ -24,4 +24,7 @@
 
 int s11_sgw_init(sgw_config_t *mme_config);
 
+// SPGW_APP worker task owning the S11 S-GW teid (MME teid for a Create Session Request)
+task_id_t s11_sgw_app_task(const teid_t teid);
+
 #endif /* FILE_S11_SGW_SEEN */
@@ -32,7 +32,9 @@
 #include "NwGtpv2cMsg.h"
 #include "NwGtpv2cMsgParser.h"
 #include "sgw_ie_defs.h"
+#include "sgw_config.h"
 #include "s11_common.h"
+#include "s11_sgw.h"
 #include "s11_sgw_bearer_manager.h"
 #include "s11_ie_formatter.h"
 #include "log.h"
@@ -139,7 +141,7 @@ s11_sgw_handle_modify_bearer_request (
   DevAssert (NW_OK == rc);
   rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
   DevAssert (NW_OK == rc);
-  return itti_send_msg_to_task (TASK_SPGW_APP, INSTANCE_DEFAULT, message_p);
+  return itti_send_msg_to_task (s11_sgw_app_task (request_p->teid), INSTANCE_DEFAULT, message_p);
 }
 
 //------------------------------------------------------------------------------
@@ -260,7 +262,7 @@ s11_sgw_handle_release_access_bearers_request (
   rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
   DevAssert (NW_OK == rc);
 
-  return itti_send_msg_to_task (TASK_SPGW_APP, INSTANCE_DEFAULT, message_p);
+  return itti_send_msg_to_task (s11_sgw_app_task (request_p->teid), INSTANCE_DEFAULT, message_p);
 }
 
 //------------------------------------------------------------------------------
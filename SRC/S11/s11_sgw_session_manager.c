@@ -32,7 +32,9 @@
 #include "NwGtpv2cMsg.h"
 #include "NwGtpv2cMsgParser.h"
 #include "sgw_ie_defs.h"
+#include "sgw_config.h"
 #include "s11_common.h"
+#include "s11_sgw.h"
 #include "s11_sgw_session_manager.h"
 #include "s11_ie_formatter.h"
 #include "log.h"
@@ -225,7 +227,7 @@ s11_sgw_handle_create_session_request (
   DevAssert (NW_OK == rc);
   rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
   DevAssert (NW_OK == rc);
-  return itti_send_msg_to_task (TASK_SPGW_APP, INSTANCE_DEFAULT, message_p);
+  return itti_send_msg_to_task (s11_sgw_app_task (create_session_request_p->sender_fteid_for_cp.teid), INSTANCE_DEFAULT, message_p);
 }
 
 //------------------------------------------------------------------------------
@@ -392,7 +394,7 @@ s11_sgw_handle_delete_session_request (
   DevAssert (NW_OK == rc);
   rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
   DevAssert (NW_OK == rc);
-  return itti_send_msg_to_task (TASK_SPGW_APP, INSTANCE_DEFAULT, message_p);
+  return itti_send_msg_to_task (s11_sgw_app_task (delete_session_request_p->teid), INSTANCE_DEFAULT, message_p);
 }
 
 //------------------------------------------------------------------------------
@@ -346,7 +346,7 @@ for key in iesDefs:
 
 f.write("int %s_xer__print2sp(const void *buffer, size_t size, void *app_key);\n\n" % (fileprefix.lower()))
 f.write("int %s_xer__print2fp(const void *buffer, size_t size, void *app_key);\n\n" % (fileprefix.lower()))
-f.write("extern size_t %s_string_total_size;\n\n" % (fileprefix.lower()))
+f.write("extern __thread size_t %s_string_total_size;\n\n" % (fileprefix.lower()))
 f.write("#endif /* %s_IES_DEFS_H_ */\n\n" % (fileprefix.upper()))
 
 #Generate Decode functions
@@ -607,7 +607,8 @@ f.write("#include <stdio.h>\n\n")
 f.write("#include <asn_application.h>\n#include <asn_internal.h>\n\n")
 f.write("#include \"%s_common.h\"\n#include \"%s_ies_defs.h\"\n\n" % (fileprefix, fileprefix))
 
-f.write("size_t %s_string_total_size = 0;\n\n" % (fileprefix.lower()))
+# per thread: PDUs may be decoded by several S1AP codec tasks
+f.write("__thread size_t %s_string_total_size = 0;\n\n" % (fileprefix.lower()))
 f.write("""int
 %s_xer__print2fp(const void *buffer, size_t size, void *app_key) {
     FILE *stream = (FILE *)app_key;
@@ -29,14 +29,17 @@
 #include <stdbool.h>
 
 #include "dynamic_memory_check.h"
+#include "mem_arena.h"
 #include "intertask_interface.h"
 #include "assertions.h"
 #include "mme_app_statistics.h"
 #include "s1ap_mme.h"
+#include "s1ap_mme_codec.h"
 #include "s1ap_mme_decoder.h"
 #include "s1ap_mme_handlers.h"
 #include "s1ap_mme_nas_procedures.h"
 #include "s1ap_mme_itti_messaging.h"
+#include "s1ap_mme_paging.h"
 #include "timer.h"
 
 #if S1AP_DEBUG_LIST
@@ -53,6 +56,7 @@ uint32_t                                nb_enb_associated = 0;
 
 hash_table_ts_t g_s1ap_enb_coll = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0}; // contains eNB_description_s, key is eNB_description_s.enb_id (uint32_t);
 hash_table_ts_t g_s1ap_mme_id2assoc_id_coll = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0}; // contains sctp association id, key is mme_ue_s1ap_id;
+hash_table_ts_t g_s1ap_enb_id2assoc_id_coll = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0}; // contains sctp association id, key is enb_id;
 
 static int                              indent = 0;
  void *s1ap_mme_thread (void *args);
@@ -84,6 +88,10 @@ void                                   *
 s1ap_mme_thread (
   __attribute__((unused)) void *args)
 {
+  // PDUs not sent to a S1AP codec task are decoded in this arena, reset after each of them
+  mem_arena_t                            *decode_arena = mem_arena_create (S1AP_DECODE_ARENA_SIZE);
+
+  AssertFatal (decode_arena != NULL, "Failed to create S1AP decode arena\n");
   itti_mark_task_ready (TASK_S1AP);
   OAILOG_START_USE ();
   MSC_START_USE ();
@@ -110,16 +118,23 @@ s1ap_mme_thread (
          * * * * Decode and handle it.
          */
         s1ap_message                            message = {0};
+        mem_arena_t                            *previous = NULL;
+        int                                     rc = RETURNerror;
 
         /*
-         * Invoke S1AP message decoder
+         * Invoke S1AP message decoder, the decoded PDU lives in the task arena
+         * until the message is handled
          */
-        if (s1ap_mme_decode_pdu (&message, SCTP_DATA_IND (received_message_p).payload) < 0) {
+        previous = mem_arena_enter (decode_arena);
+        rc = s1ap_mme_decode_pdu (&message, SCTP_DATA_IND (received_message_p).payload);
+        mem_arena_leave (previous);
+        if (rc < 0) {
           // TODO: Notify eNB of failure with right cause
           OAILOG_ERROR (LOG_S1AP, "Failed to decode new buffer\n");
         } else {
           s1ap_mme_handle_message (SCTP_DATA_IND (received_message_p).assoc_id, SCTP_DATA_IND (received_message_p).stream, &message);
         }
+        mem_arena_reset (decode_arena);
 
         /*
          * Free received PDU array
@@ -128,6 +143,16 @@ s1ap_mme_thread (
       }
       break;
 
+    case S1AP_DECODED_PDU_IND:{
+        /*
+         * PDU already decoded by a S1AP codec task.
+         */
+        s1ap_mme_handle_message (S1AP_DECODED_PDU_IND (received_message_p).assoc_id, S1AP_DECODED_PDU_IND (received_message_p).stream,
+            S1AP_DECODED_PDU_IND (received_message_p).message);
+        mem_arena_destroy (&S1AP_DECODED_PDU_IND (received_message_p).arena);
+      }
+      break;
+
     case SCTP_DATA_CNF:
       s1ap_mme_itti_nas_downlink_cnf(SCTP_DATA_CNF (received_message_p).mme_ue_s1ap_id, SCTP_DATA_CNF (received_message_p).is_success);
       break;
@@ -145,6 +170,14 @@ s1ap_mme_thread (
       }
       break;
 
+      /*
+       * SCTP send queue of an eNB crossed its high or low watermark.
+       */
+    case SCTP_CONGESTION_IND:{
+        s1ap_handle_sctp_congestion (&SCTP_CONGESTION_IND (received_message_p));
+      }
+      break;
+
     case S1AP_NAS_DL_DATA_REQ:{
         /*
          * New message received from NAS task.
@@ -171,9 +204,26 @@ s1ap_mme_thread (
       }
       break;
 
+    case S1AP_OVERLOAD_START:{
+        s1ap_handle_overload_start (&S1AP_OVERLOAD_START (received_message_p));
+      }
+      break;
+
+    case S1AP_OVERLOAD_STOP:{
+        s1ap_handle_overload_stop ();
+      }
+      break;
+
+    case S1AP_PAGING_REQUEST:{
+        s1ap_handle_paging_request (&S1AP_PAGING_REQUEST (received_message_p));
+      }
+      break;
+
     case TIMER_HAS_EXPIRED:{
         ue_description_t                       *ue_ref_p = NULL;
-        if (received_message_p->ittiMsg.timer_has_expired.arg != NULL) { 
+        if (s1ap_paging_is_tick (received_message_p->ittiMsg.timer_has_expired.timer_id)) {
+          s1ap_paging_tick ();
+        } else if (received_message_p->ittiMsg.timer_has_expired.arg != NULL) { 
           mme_ue_s1ap_id_t mme_ue_s1ap_id = *((mme_ue_s1ap_id_t *)(received_message_p->ittiMsg.timer_has_expired.arg));
           if ((ue_ref_p = s1ap_is_ue_mme_id_in_list (mme_ue_s1ap_id)) == NULL) {
             OAILOG_WARNING (LOG_S1AP, "Timer expired but no assoicated UE context for UE id %d\n",mme_ue_s1ap_id);
@@ -194,6 +244,7 @@ s1ap_mme_thread (
       break;
 
     case TERMINATE_MESSAGE:{
+        mem_arena_destroy (&decode_arena);
         itti_exit_task ();
       }
       break;
@@ -240,11 +291,27 @@ s1ap_mme_init(void)
   bdestroy(bs2);
   if (!h) return RETURNerror;
 
+  bstring bs3 = bfromcstr("s1ap_enb_id2assoc_id_coll");
+  h = hashtable_ts_init (&g_s1ap_enb_id2assoc_id_coll, mme_config.max_enbs, NULL, hash_free_int_func, bs3);
+  bdestroy(bs3);
+  if (!h) return RETURNerror;
+
+  s1ap_mme_handlers_metrics_init ();
+
   if (itti_create_task (TASK_S1AP, &s1ap_mme_thread, NULL) < 0) {
     OAILOG_ERROR (LOG_S1AP, "Error while creating S1AP task\n");
     return RETURNerror;
   }
 
+  if (s1ap_paging_init (&mme_config) < 0) {
+    OAILOG_ERROR (LOG_S1AP, "Error while initializing S1AP paging\n");
+    return RETURNerror;
+  }
+
+  if (s1ap_mme_codec_init () < 0) {
+    return RETURNerror;
+  }
+
   if (s1ap_send_init_sctp () < 0) {
     OAILOG_ERROR (LOG_S1AP, "Error while sendind SCTP_INIT_MSG to SCTP \n");
     return RETURNerror;
@@ -336,30 +403,52 @@ s1ap_dump_ue (const ue_description_t * const ue_ref)
 #  endif
 }
 
-//------------------------------------------------------------------------------
-bool s1ap_enb_compare_by_enb_id_cb (__attribute__((unused)) const hash_key_t keyP,
-                                    void * const elementP,
-                                    void * parameterP, void **resultP)
-{
-  const uint32_t                  * const enb_id_p = (const uint32_t*const)parameterP;
-  enb_description_t                      *enb_ref  = (enb_description_t*)elementP;
-  if ( *enb_id_p == enb_ref->enb_id ) {
-    *resultP = elementP;
-    return true;
-  }
-  return false;
-}
 //------------------------------------------------------------------------------
 enb_description_t                      *
 s1ap_is_enb_id_in_list (
   const uint32_t enb_id)
 {
   enb_description_t                      *enb_ref = NULL;
-  uint32_t                               *enb_id_p  = (uint32_t*)&enb_id;
-  hashtable_ts_apply_callback_on_elements((hash_table_ts_t * const)&g_s1ap_enb_coll, s1ap_enb_compare_by_enb_id_cb, (void *)enb_id_p, (void**)&enb_ref);
+  void                                   *id = NULL;
+
+  if (HASH_TABLE_OK == hashtable_ts_get (&g_s1ap_enb_id2assoc_id_coll, (const hash_key_t)enb_id, &id)) {
+    hashtable_ts_get (&g_s1ap_enb_coll, (const hash_key_t)(sctp_assoc_id_t)(uintptr_t)id, (void**)&enb_ref);
+  }
   return enb_ref;
 }
 
+//------------------------------------------------------------------------------
+static void
+s1ap_unset_enb_id (
+  const enb_description_t * const enb_ref)
+{
+  void                                   *id = NULL;
+
+  // the eNB id may have been taken over by another association of the eNB
+  if ((HASH_TABLE_OK == hashtable_ts_get (&g_s1ap_enb_id2assoc_id_coll, (const hash_key_t)enb_ref->enb_id, &id)) &&
+      ((sctp_assoc_id_t)(uintptr_t)id == enb_ref->sctp_assoc_id)) {
+    hashtable_ts_free (&g_s1ap_enb_id2assoc_id_coll, (const hash_key_t)enb_ref->enb_id);
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+s1ap_set_enb_id (
+  enb_description_t * const enb_ref,
+  const uint32_t enb_id)
+{
+  enb_description_t                      *other_enb_ref = NULL;
+
+  DevAssert (enb_ref != NULL);
+  s1ap_unset_enb_id (enb_ref);
+  other_enb_ref = s1ap_is_enb_id_in_list (enb_id);
+  if ((other_enb_ref) && (other_enb_ref != enb_ref)) {
+    OAILOG_WARNING (LOG_S1AP, "eNB id %u moves from assoc id %u to assoc id %u\n", enb_id, other_enb_ref->sctp_assoc_id, enb_ref->sctp_assoc_id);
+  }
+  enb_ref->enb_id = enb_id;
+  hashtable_ts_insert (&g_s1ap_enb_id2assoc_id_coll, (const hash_key_t)enb_id, (void *)(uintptr_t)enb_ref->sctp_assoc_id);
+}
+
 //------------------------------------------------------------------------------
 enb_description_t                      *
 s1ap_is_enb_assoc_id_in_list (
@@ -496,6 +585,31 @@ void s1ap_notified_new_ue_mme_s1ap_id_association (
   OAILOG_DEBUG(LOG_S1AP, "Could not find  eNB with sctp_assoc_id %d \n", sctp_assoc_id);
 }
 
+//------------------------------------------------------------------------------
+/*
+ * The UE collection of an eNB starts at S1AP_ENB_UE_HTBL_SIZE_MIN buckets, doubles when it
+ * holds more UEs than buckets and halves under a quarter, so that a small cell does not pay
+ * the buckets and bucket mutexes of the whole MME capacity. Only the S1AP task touches it.
+ */
+static void
+s1ap_enb_ue_coll_fit (
+  enb_description_t * const enb_ref)
+{
+  hash_table_ts_t                        *ue_coll = &enb_ref->ue_coll;
+  hash_size_t                             size = ue_coll->size;
+
+  if (ue_coll->num_elements > size) {
+    size = size << 1;
+  } else if ((size > S1AP_ENB_UE_HTBL_SIZE_MIN) && (ue_coll->num_elements < (size >> 2))) {
+    size = size >> 1;
+  } else {
+    return;
+  }
+  if (HASH_TABLE_OK != hashtable_ts_resize (ue_coll, size)) {
+    OAILOG_WARNING (LOG_S1AP, "Could not resize UE collection of eNB %u to %zu buckets\n", enb_ref->enb_id, size);
+  }
+}
+
 //------------------------------------------------------------------------------
 enb_description_t                      *
 s1ap_new_enb (
@@ -513,7 +627,7 @@ s1ap_new_enb (
   // Update number of eNB associated
   nb_enb_associated++;
   bstring bs = bfromcstr("s1ap_ue_coll");
-  hashtable_ts_init(&enb_ref->ue_coll, mme_config.max_ues, NULL, free_wrapper, bs);
+  hashtable_ts_init(&enb_ref->ue_coll, S1AP_ENB_UE_HTBL_SIZE_MIN, NULL, free_wrapper, bs);
   bdestroy(bs);
   enb_ref->nb_ue_associated = 0;
   return enb_ref;
@@ -547,6 +661,7 @@ s1ap_new_ue (
   }
   // Increment number of UE
   enb_ref->nb_ue_associated++;
+  s1ap_enb_ue_coll_fit (enb_ref);
   return ue_ref;
 }
 
@@ -584,6 +699,7 @@ s1ap_remove_ue (
   OAILOG_TRACE(LOG_S1AP, "Removing UE enb_ue_s1ap_id: " ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id:" MME_UE_S1AP_ID_FMT " in eNB id : %d\n",
       ue_ref->enb_ue_s1ap_id, ue_ref->mme_ue_s1ap_id, enb_ref->enb_id);
   hashtable_ts_free (&enb_ref->ue_coll, ue_ref->enb_ue_s1ap_id);
+  s1ap_enb_ue_coll_fit (enb_ref);
 
   if (!enb_ref->nb_ue_associated) {
     if (enb_ref->s1_state == S1AP_RESETING) {
@@ -604,6 +720,8 @@ s1ap_remove_enb (
 {
   if (enb_ref == NULL)
     return;
+  s1ap_paging_remove_enb(enb_ref);
+  s1ap_unset_enb_id(enb_ref);
   hashtable_ts_destroy(&enb_ref->ue_coll);
   hashtable_ts_free (&g_s1ap_enb_coll, enb_ref->sctp_assoc_id);
   nb_enb_associated--;
@@ -34,6 +34,7 @@
 struct enb_description_s;
 
 #define S1AP_TIMER_INACTIVE_ID   (-1)
+#define S1AP_ENB_UE_HTBL_SIZE_MIN  16 // initial buckets of the UE collection of an eNB, it grows and shrinks with the UEs of the eNB
 #define S1AP_UE_CONTEXT_REL_COMP_TIMER 2 // in seconds 
 
 /* Timer structure */
@@ -102,12 +103,22 @@ typedef struct enb_description_s {
   char     enb_name[150];      ///< Printable eNB Name
   uint32_t enb_id;             ///< Unique eNB ID
   uint8_t  default_paging_drx; ///< Default paging DRX interval for eNB
+  bool     overload_started;   ///< OVERLOAD START sent, OVERLOAD STOP pending
   /*@}*/
 
   /** UE list for this eNB **/
   /*@{*/
   uint32_t nb_ue_associated; ///< Number of NAS associated UE on this eNB
-  hash_table_ts_t  ue_coll; // contains ue_description_s, key is ue_description_s.?;
+  hash_table_ts_t  ue_coll; // contains ue_description_s, key is ue_description_s.enb_ue_s1ap_id, sized by s1ap_new_ue()/s1ap_remove_ue()
+  /*@}*/
+
+  /** Paging **/
+  /*@{*/
+  tai_t   *supported_tai;       ///< TAIs advertised in S1 Setup/eNB Configuration Update, indexed by s1ap_mme_paging
+  uint16_t nb_supported_tai;
+  uint32_t paging_generation;   ///< Last paging sent to this eNB, to send it once when the eNB serves several TAIs of the UE
+  uint32_t paging_budget;       ///< Paging messages that can still be sent to this eNB in the current second
+  uint32_t paging_budget_sec;   ///< Second of the paging budget
   /*@}*/
 
   /** SCTP stuff **/
@@ -116,6 +127,7 @@ typedef struct enb_description_s {
   sctp_stream_id_t next_sctp_stream; ///< Next SCTP stream
   sctp_stream_id_t instreams;        ///< Number of streams avalaible on eNB -> MME
   sctp_stream_id_t outstreams;       ///< Number of streams avalaible on MME -> eNB
+  bool             sctp_congested;   ///< Send queue of the association above its high watermark
   /*@}*/
 } enb_description_t;
 
@@ -134,6 +146,12 @@ int s1ap_mme_init(void);
  **/
 enb_description_t* s1ap_is_enb_id_in_list(const uint32_t enb_id);
 
+/** \brief Index the eNB by its eNB id, after S1 SETUP REQUEST
+ * \param enb_ref The eNB
+ * \param enb_id The eNB id received in the Global eNB ID
+ **/
+void s1ap_set_enb_id(enb_description_t * const enb_ref, const uint32_t enb_id);
+
 /** \brief Look for given eNB SCTP assoc id in the list
  * \param enb_id The unique sctp assoc id to search in list
  * @returns NULL if no eNB matchs the sctp assoc id, or reference to the eNB element in list if matches
@@ -209,9 +227,6 @@ bool s1ap_dump_ue_hash_cb (const hash_key_t keyP,
  **/
 void s1ap_dump_ue(const ue_description_t * const ue_ref);
 
-bool s1ap_enb_compare_by_enb_id_cb (const hash_key_t keyP,
-                                    void * const elementP, void * parameterP, void __attribute__((unused)) **unused_resultP);
-
 /** \brief Remove target UE from the list
  * \param ue_ref UE structure reference to remove
  **/
@@ -0,0 +1,195 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_codec.c
+   \brief S1AP ASN.1 codec tasks
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "log.h"
+#include "msc.h"
+#include "assertions.h"
+#include "intertask_interface.h"
+#include "mme_config.h"
+#include "mem_arena.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme_decoder.h"
+#include "s1ap_mme_encoder.h"
+#include "s1ap_mme_codec.h"
+
+//------------------------------------------------------------------------------
+static int s1ap_mme_codec_send_sctp_request (
+  STOLEN_REF bstring *payload,
+  const sctp_assoc_id_t assoc_id,
+  const sctp_stream_id_t stream,
+  const mme_ue_s1ap_id_t ue_id)
+{
+  // origin is TASK_S1AP: a SCTP failure (SCTP_DATA_CNF) is reported to the S1AP task
+  MessageDef                             *message_p = itti_alloc_new_message (TASK_S1AP, SCTP_DATA_REQ);
+
+  SCTP_DATA_REQ (message_p).payload = *payload;
+  *payload = NULL;
+  SCTP_DATA_REQ (message_p).assoc_id = assoc_id;
+  SCTP_DATA_REQ (message_p).stream = stream;
+  SCTP_DATA_REQ (message_p).mme_ue_s1ap_id = ue_id;
+  return itti_send_msg_to_task (TASK_SCTP, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_mme_codec_decode (
+  const task_id_t task_id,
+  sctp_data_ind_t * const sctp_data_ind)
+{
+  // everything asn1c allocates for this PDU goes to its arena, released in one call by the S1AP task
+  mem_arena_t                            *arena = mem_arena_create (S1AP_DECODE_ARENA_SIZE);
+  mem_arena_t                            *previous = NULL;
+  s1ap_message                           *message = NULL;
+  int                                     rc = RETURNerror;
+
+  AssertFatal (arena != NULL, "Failed to create S1AP decode arena\n");
+  previous = mem_arena_enter (arena);
+  message = mem_arena_calloc (arena, 1, sizeof (s1ap_message));
+  if (message) {
+    rc = s1ap_mme_decode_pdu (message, sctp_data_ind->payload);
+  }
+  mem_arena_leave (previous);
+
+  if (rc < 0) {
+    // TODO: Notify eNB of failure with right cause
+    OAILOG_ERROR (LOG_S1AP, "Failed to decode new buffer\n");
+    mem_arena_destroy (&arena);
+  } else {
+    MessageDef                           *message_p = itti_alloc_new_message (task_id, S1AP_DECODED_PDU_IND);
+
+    S1AP_DECODED_PDU_IND (message_p).assoc_id = sctp_data_ind->assoc_id;
+    S1AP_DECODED_PDU_IND (message_p).stream   = sctp_data_ind->stream;
+    S1AP_DECODED_PDU_IND (message_p).message  = message;
+    S1AP_DECODED_PDU_IND (message_p).arena    = arena;
+    itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+  }
+  bdestroy (sctp_data_ind->payload);
+  sctp_data_ind->payload = NULL;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_mme_codec_encode (
+  itti_s1ap_encode_pdu_req_t * const encode_req)
+{
+  uint8_t                                *buffer_p = NULL;
+  uint32_t                                length = 0;
+
+  if (s1ap_mme_encode_pdu (encode_req->message, &buffer_p, &length) < 0) {
+    OAILOG_ERROR (LOG_S1AP, "Failed to encode procedure %d for ue_id " MME_UE_S1AP_ID_FMT "\n",
+        (int)encode_req->message->procedureCode, encode_req->mme_ue_s1ap_id);
+  } else {
+    bstring b = blk2bstr (buffer_p, length);
+
+    free_wrapper ((void**) &buffer_p);
+    s1ap_mme_codec_send_sctp_request (&b, encode_req->assoc_id, encode_req->stream, encode_req->mme_ue_s1ap_id);
+  }
+  free_wrapper ((void**) &encode_req->message);
+}
+
+//------------------------------------------------------------------------------
+static void *s1ap_mme_codec_thread (void *args)
+{
+  const int                               worker_index = (int)(intptr_t)args;
+  const task_id_t                         task_id = TASK_S1AP_CODEC + worker_index;
+
+  itti_mark_task_ready (task_id);
+  OAILOG_START_USE ();
+  MSC_START_USE ();
+
+  while (1) {
+    MessageDef                             *received_message_p = NULL;
+    MessageDef                             *message_p = NULL;
+
+    itti_receive_msg (task_id, &received_message_p);
+    DevAssert (received_message_p != NULL);
+
+    switch (ITTI_MSG_ID (received_message_p)) {
+    case SCTP_DATA_IND:{
+        s1ap_mme_codec_decode (task_id, &SCTP_DATA_IND (received_message_p));
+      }
+      break;
+
+    case S1AP_ENCODE_PDU_REQ:{
+        s1ap_mme_codec_encode (&S1AP_ENCODE_PDU_REQ (received_message_p));
+      }
+      break;
+
+    case SCTP_DATA_REQ:{
+        // already encoded by the S1AP task, queued here only to keep the association order
+        s1ap_mme_codec_send_sctp_request (&SCTP_DATA_REQ (received_message_p).payload, SCTP_DATA_REQ (received_message_p).assoc_id,
+            SCTP_DATA_REQ (received_message_p).stream, SCTP_DATA_REQ (received_message_p).mme_ue_s1ap_id);
+      }
+      break;
+
+    case SCTP_NEW_ASSOCIATION:{
+        message_p = itti_alloc_new_message (ITTI_MSG_ORIGIN_ID (received_message_p), SCTP_NEW_ASSOCIATION);
+        message_p->ittiMsg.sctp_new_peer = received_message_p->ittiMsg.sctp_new_peer;
+        itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+      }
+      break;
+
+    case SCTP_CLOSE_ASSOCIATION:{
+        message_p = itti_alloc_new_message (ITTI_MSG_ORIGIN_ID (received_message_p), SCTP_CLOSE_ASSOCIATION);
+        SCTP_CLOSE_ASSOCIATION (message_p) = SCTP_CLOSE_ASSOCIATION (received_message_p);
+        itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+      }
+      break;
+
+    case TERMINATE_MESSAGE:{
+        itti_exit_task ();
+      }
+      break;
+
+    default:{
+        OAILOG_ERROR (LOG_S1AP, "Unknown message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
+      }
+      break;
+    }
+
+    itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+    received_message_p = NULL;
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+int s1ap_mme_codec_init (void)
+{
+  for (int i = 0; i < mme_config.num_s1ap_codec_workers; i++) {
+    if (itti_create_task (TASK_S1AP_CODEC + i, &s1ap_mme_codec_thread, (void *)(intptr_t)i) < 0) {
+      OAILOG_ERROR (LOG_S1AP, "Error while creating S1AP codec task %d\n", i);
+      return RETURNerror;
+    }
+  }
+  return RETURNok;
+}
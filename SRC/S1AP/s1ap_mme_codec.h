@@ -0,0 +1,35 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_codec.h
+   \brief S1AP ASN.1 codec tasks: PDUs of an eNB association are decoded/encoded
+          out of the S1AP task by the codec task selected by S1AP_CODEC_TASK_ID().
+*/
+
+#ifndef FILE_S1AP_MME_CODEC_SEEN
+#define FILE_S1AP_MME_CODEC_SEEN
+
+// Initial size of the arena holding a decoded PDU, fits the XER log text and the IEs of usual PDUs
+#define S1AP_DECODE_ARENA_SIZE (16 * 1024)
+
+int s1ap_mme_codec_init(void);
+
+#endif /* FILE_S1AP_MME_CODEC_SEEN */
@@ -36,6 +36,34 @@
 #include "s1ap_ies_defs.h"
 #include "s1ap_mme_handlers.h"
 #include "dynamic_memory_check.h"
+#include "mem_arena.h"
+
+#define S1AP_DECODER_STRING_SIZE 10000
+
+//------------------------------------------------------------------------------
+// Buffer for the XER text of a PDU, in the arena of the decoding scope if any
+static char *
+s1ap_mme_decoder_string_new (
+  void) {
+  mem_arena_t                            *arena = mem_arena_current ();
+
+  s1ap_string_total_size = 0;
+  if (arena) {
+    return mem_arena_alloc (arena, S1AP_DECODER_STRING_SIZE);
+  }
+  return calloc (S1AP_DECODER_STRING_SIZE, sizeof (char));
+}
+
+//------------------------------------------------------------------------------
+static void
+s1ap_mme_decoder_string_free (
+  char **string) {
+  if (mem_arena_owns (mem_arena_current (), *string)) {
+    *string = NULL;
+  } else {
+    free_wrapper ((void**) string);
+  }
+}
 
 static int
 s1ap_mme_decode_initiating (
@@ -50,8 +78,7 @@ s1ap_mme_decode_initiating (
   OAILOG_FUNC_IN (LOG_S1AP);
  
   DevAssert (initiating_p != NULL);
-  message_string = calloc (10000, sizeof (char));
-  s1ap_string_total_size = 0;
+  message_string = s1ap_mme_decoder_string_new ();
   message->procedureCode = initiating_p->procedureCode;
   message->criticality = initiating_p->criticality;
 
@@ -116,12 +143,9 @@ s1ap_mme_decode_initiating (
       break;
     
     case S1ap_ProcedureCode_id_ENBConfigurationUpdate: {
-        OAILOG_ERROR (LOG_S1AP, "eNB Configuration update is received. Ignoring it. Procedure code = %d\n", (int)initiating_p->procedureCode);
-        OAILOG_FUNC_RETURN (LOG_S1AP, ret);
-        /*
-         * TODO- Add handling for eNB Configuration Update
-         */
-        // ret = s1ap_decode_s1ap_enbconfigurationupdate_ies (&message->msg.s1ap_ENBConfigurationUpdate_IEs, &initiating_p->value);
+        ret = s1ap_decode_s1ap_enbconfigurationupdateies (&message->msg.s1ap_ENBConfigurationUpdateIEs, &initiating_p->value);
+        s1ap_xer_print_s1ap_enbconfigurationupdate (s1ap_xer__print2sp, message_string, message);
+        message_id = S1AP_ENB_CONFIGURATION_UPDATE_LOG;
       }
       break;
 
@@ -132,12 +156,12 @@ s1ap_mme_decode_initiating (
       break;
   }
 
-  message_string_size = strlen (message_string);
+  message_string_size = s1ap_string_total_size;
   message_p = itti_alloc_new_message_sized (TASK_S1AP, message_id, message_string_size + sizeof (IttiMsgText));
   message_p->ittiMsg.s1ap_uplink_nas_log.size = message_string_size;
   memcpy (&message_p->ittiMsg.s1ap_uplink_nas_log.text, message_string, message_string_size);
   itti_send_msg_to_task (TASK_UNKNOWN, INSTANCE_DEFAULT, message_p);
-  free_wrapper ((void**) &message_string);
+  s1ap_mme_decoder_string_free (&message_string);
   OAILOG_FUNC_RETURN (LOG_S1AP, ret);
 }
 
@@ -151,8 +175,7 @@ s1ap_mme_decode_successfull_outcome (
   size_t                                  message_string_size = 0;
   MessagesIds                             message_id = MESSAGES_ID_MAX;
   DevAssert (successfullOutcome_p != NULL);
-  message_string = calloc (10000, sizeof (char));
-  s1ap_string_total_size = 0;
+  message_string = s1ap_mme_decoder_string_new ();
   message->procedureCode = successfullOutcome_p->procedureCode;
   message->criticality = successfullOutcome_p->criticality;
 
@@ -177,12 +200,12 @@ s1ap_mme_decode_successfull_outcome (
       break;
   }
 
-  message_string_size = strlen (message_string);
+  message_string_size = s1ap_string_total_size;
   message_p = itti_alloc_new_message_sized (TASK_S1AP, message_id, message_string_size + sizeof (IttiMsgText));
   message_p->ittiMsg.s1ap_initial_context_setup_log.size = message_string_size;
   memcpy (&message_p->ittiMsg.s1ap_initial_context_setup_log.text, message_string, message_string_size);
   itti_send_msg_to_task (TASK_UNKNOWN, INSTANCE_DEFAULT, message_p);
-  free_wrapper ((void**) &message_string);
+  s1ap_mme_decoder_string_free (&message_string);
   return ret;
 }
 
@@ -196,8 +219,7 @@ s1ap_mme_decode_unsuccessfull_outcome (
   size_t                                  message_string_size = 0;
   MessagesIds                             message_id = MESSAGES_ID_MAX;
   DevAssert (unSuccessfulOutcome_p != NULL);
-  message_string = calloc (10000, sizeof (char));
-  s1ap_string_total_size = 0;
+  message_string = s1ap_mme_decoder_string_new ();
   message->procedureCode = unSuccessfulOutcome_p->procedureCode;
   message->criticality = unSuccessfulOutcome_p->criticality;
 
@@ -215,12 +237,12 @@ s1ap_mme_decode_unsuccessfull_outcome (
       break;
   }
 
-  message_string_size = strlen (message_string);
+  message_string_size = s1ap_string_total_size;
   message_p = itti_alloc_new_message_sized (TASK_S1AP, message_id, message_string_size + sizeof (IttiMsgText));
   message_p->ittiMsg.s1ap_initial_context_setup_log.size = message_string_size;
   memcpy (&message_p->ittiMsg.s1ap_initial_context_setup_log.text, message_string, message_string_size);
   itti_send_msg_to_task (TASK_UNKNOWN, INSTANCE_DEFAULT, message_p);
-  free_wrapper ((void**) &message_string);
+  s1ap_mme_decoder_string_free (&message_string);
   return ret;
 }
 
@@ -27,6 +27,9 @@
 #include "s1ap_common.h"
 #include "s1ap_ies_defs.h"
 
+/* Inside a mem_arena scope, everything the decoded message points to is allocated
+ * in the arena: the message must be handled before the arena is reset or destroyed.
+ */
 int s1ap_mme_decode_pdu(s1ap_message *message, const_bstring const raw) __attribute__ ((warn_unused_result));
 
 #endif /* FILE_S1AP_MME_DECODER_SEEN */
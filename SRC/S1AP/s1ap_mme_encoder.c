@@ -54,6 +54,26 @@ static inline int                       s1ap_mme_encode_downlink_nas_transport (
   s1ap_message * message_p,
   uint8_t ** buffer,
   uint32_t * length);
+static inline int                       s1ap_mme_encode_overload_start (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length);
+static inline int                       s1ap_mme_encode_overload_stop (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length);
+static inline int                       s1ap_mme_encode_paging (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length);
+static inline int                       s1ap_mme_encode_enb_configuration_update_acknowledge (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length);
+static inline int                       s1ap_mme_encode_enb_configuration_update_failure (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length);
 
 static inline int                       s1ap_mme_encode_initiating (
   s1ap_message * message_p,
@@ -130,6 +150,15 @@ s1ap_mme_encode_initiating (
   case S1ap_ProcedureCode_id_UEContextRelease:
     return s1ap_mme_encode_ue_context_release_command (message_p, buffer, length);
 
+  case S1ap_ProcedureCode_id_OverloadStart:
+    return s1ap_mme_encode_overload_start (message_p, buffer, length);
+
+  case S1ap_ProcedureCode_id_OverloadStop:
+    return s1ap_mme_encode_overload_stop (message_p, buffer, length);
+
+  case S1ap_ProcedureCode_id_Paging:
+    return s1ap_mme_encode_paging (message_p, buffer, length);
+
   default:
     OAILOG_DEBUG (LOG_S1AP, "Unknown procedure ID (%d) for initiating message_p\n", (int)message_p->procedureCode);
     break;
@@ -148,6 +177,9 @@ s1ap_mme_encode_successfull_outcome (
   case S1ap_ProcedureCode_id_S1Setup:
     return s1ap_mme_encode_s1setupresponse (message_p, buffer, length);
 
+  case S1ap_ProcedureCode_id_ENBConfigurationUpdate:
+    return s1ap_mme_encode_enb_configuration_update_acknowledge (message_p, buffer, length);
+
   default:
     OAILOG_DEBUG (LOG_S1AP, "Unknown procedure ID (%d) for successfull outcome message\n", (int)message_p->procedureCode);
     break;
@@ -166,6 +198,9 @@ s1ap_mme_encode_unsuccessfull_outcome (
   case S1ap_ProcedureCode_id_S1Setup:
     return s1ap_mme_encode_s1setupfailure (message_p, buffer, length);
 
+  case S1ap_ProcedureCode_id_ENBConfigurationUpdate:
+    return s1ap_mme_encode_enb_configuration_update_failure (message_p, buffer, length);
+
   default:
     OAILOG_DEBUG (LOG_S1AP, "Unknown procedure ID (%d) for unsuccessfull outcome message\n", (int)message_p->procedureCode);
     break;
@@ -254,3 +289,92 @@ s1ap_mme_encode_ue_context_release_command (
 
   return s1ap_generate_initiating_message (buffer, length, S1ap_ProcedureCode_id_UEContextRelease, message_p->criticality, &asn_DEF_S1ap_UEContextReleaseCommand, ueContextReleaseCommand_p);
 }
+
+static inline int
+s1ap_mme_encode_overload_start (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length)
+{
+  S1ap_OverloadStart_t                    overloadStart;
+  S1ap_OverloadStart_t                   *overloadStart_p = &overloadStart;
+
+  memset (overloadStart_p, 0, sizeof (S1ap_OverloadStart_t));
+
+  if (s1ap_encode_s1ap_overloadstarties (overloadStart_p, &message_p->msg.s1ap_OverloadStartIEs) < 0) {
+    return -1;
+  }
+
+  return s1ap_generate_initiating_message (buffer, length, S1ap_ProcedureCode_id_OverloadStart, message_p->criticality, &asn_DEF_S1ap_OverloadStart, overloadStart_p);
+}
+
+static inline int
+s1ap_mme_encode_overload_stop (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length)
+{
+  S1ap_OverloadStop_t                     overloadStop;
+
+  /*
+   * OVERLOAD STOP has no IE (only the extension container), nothing generated for it
+   */
+  memset (&overloadStop, 0, sizeof (S1ap_OverloadStop_t));
+  return s1ap_generate_initiating_message (buffer, length, S1ap_ProcedureCode_id_OverloadStop, message_p->criticality, &asn_DEF_S1ap_OverloadStop, &overloadStop);
+}
+
+static inline int
+s1ap_mme_encode_paging (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length)
+{
+  S1ap_Paging_t                           paging;
+  S1ap_Paging_t                          *paging_p = &paging;
+
+  memset (paging_p, 0, sizeof (S1ap_Paging_t));
+
+  if (s1ap_encode_s1ap_pagingies (paging_p, &message_p->msg.s1ap_PagingIEs) < 0) {
+    return -1;
+  }
+
+  return s1ap_generate_initiating_message (buffer, length, S1ap_ProcedureCode_id_Paging, message_p->criticality, &asn_DEF_S1ap_Paging, paging_p);
+}
+
+static inline int
+s1ap_mme_encode_enb_configuration_update_acknowledge (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length)
+{
+  S1ap_ENBConfigurationUpdateAcknowledge_t enbConfigurationUpdateAcknowledge;
+  S1ap_ENBConfigurationUpdateAcknowledge_t *enbConfigurationUpdateAcknowledge_p = &enbConfigurationUpdateAcknowledge;
+
+  memset (enbConfigurationUpdateAcknowledge_p, 0, sizeof (S1ap_ENBConfigurationUpdateAcknowledge_t));
+
+  if (s1ap_encode_s1ap_enbconfigurationupdateacknowledgeies (enbConfigurationUpdateAcknowledge_p, &message_p->msg.s1ap_ENBConfigurationUpdateAcknowledgeIEs) < 0) {
+    return -1;
+  }
+
+  return s1ap_generate_successfull_outcome (buffer, length, S1ap_ProcedureCode_id_ENBConfigurationUpdate, message_p->criticality,
+                                            &asn_DEF_S1ap_ENBConfigurationUpdateAcknowledge, enbConfigurationUpdateAcknowledge_p);
+}
+
+static inline int
+s1ap_mme_encode_enb_configuration_update_failure (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length)
+{
+  S1ap_ENBConfigurationUpdateFailure_t    enbConfigurationUpdateFailure;
+  S1ap_ENBConfigurationUpdateFailure_t   *enbConfigurationUpdateFailure_p = &enbConfigurationUpdateFailure;
+
+  memset (enbConfigurationUpdateFailure_p, 0, sizeof (S1ap_ENBConfigurationUpdateFailure_t));
+
+  if (s1ap_encode_s1ap_enbconfigurationupdatefailureies (enbConfigurationUpdateFailure_p, &message_p->msg.s1ap_ENBConfigurationUpdateFailureIEs) < 0) {
+    return -1;
+  }
+
+  return s1ap_generate_unsuccessfull_outcome (buffer, length, S1ap_ProcedureCode_id_ENBConfigurationUpdate, message_p->criticality,
+                                              &asn_DEF_S1ap_ENBConfigurationUpdateFailure, enbConfigurationUpdateFailure_p);
+}
@@ -39,8 +39,10 @@
 #include "s1ap_mme_itti_messaging.h"
 #include "s1ap_mme.h"
 #include "s1ap_mme_ta.h"
+#include "s1ap_mme_paging.h"
 #include "mme_app_statistics.h"
 #include "timer.h"
+#include "metrics.h"
 
 
 extern hash_table_ts_t g_s1ap_enb_coll; // contains eNB_description_s, key is eNB_description_s.assoc_id
@@ -53,6 +55,19 @@ static int                              s1ap_generate_s1_setup_response (
 static int                              s1ap_mme_generate_ue_context_release_command (
     ue_description_t * ue_ref_p, enum s1cause);
 
+static int                              s1ap_mme_generate_overload_start (
+    enb_description_t * enb_association, const s1ap_overload_action_t action);
+
+/* Overload state requested by MME_APP, applied to eNBs that complete S1 setup while in overload */
+typedef struct s1ap_overload_s {
+  bool                    active;
+  s1ap_overload_action_t  action;
+  uint8_t                 enb_percent;
+  uint32_t                enb_credit;     // share of eNBs selected, Bresenham style
+} s1ap_overload_t;
+
+static s1ap_overload_t                  s1ap_overload = {0};
+
 //Forward declaration
 struct s1ap_message_s;
 
@@ -92,7 +107,7 @@ s1ap_message_decoded_callback           messages_callback[][3] = {
   {0, 0, 0},                    /* DeactivateTrace */
   {0, 0, 0},                    /* TraceStart */
   {0, 0, 0},                    /* TraceFailureIndication */
-  {0, 0, 0},                    /* ENBConfigurationUpdate */
+  {s1ap_mme_handle_enb_configuration_update, 0, 0},    /* ENBConfigurationUpdate */
   {0, 0, 0},                    /* MMEConfigurationUpdate */
   {0, 0, 0},                    /* LocationReportingControl */
   {0, 0, 0},                    /* LocationReportingFailureIndication */
@@ -114,6 +129,64 @@ s1ap_message_decoded_callback           messages_callback[][3] = {
   {0, 0, 0},                    /* UplinkNonUEAssociatedLPPaTransport */
 };
 
+#define S1AP_NB_PROCEDURES  (sizeof (messages_callback) / (3 * sizeof (s1ap_message_decoded_callback)))
+
+// Names of the procedures of messages_callback, labels of their metrics
+static const char                      *s1ap_procedure2String[] = {
+  "HandoverPreparation",
+  "HandoverResourceAllocation",
+  "HandoverNotification",
+  "PathSwitchRequest",
+  "HandoverCancel",
+  "E-RABSetup",
+  "E-RABModify",
+  "E-RABRelease",
+  "E-RABReleaseIndication",
+  "InitialContextSetup",
+  "Paging",
+  "DownlinkNASTransport",
+  "InitialUEMessage",
+  "UplinkNASTransport",
+  "Reset",
+  "ErrorIndication",
+  "NASNonDeliveryIndication",
+  "S1Setup",
+  "UEContextReleaseRequest",
+  "DownlinkS1cdma2000tunneling",
+  "UplinkS1cdma2000tunneling",
+  "UEContextModification",
+  "UECapabilityInfoIndication",
+  "UEContextRelease",
+  "eNBStatusTransfer",
+  "MMEStatusTransfer",
+  "DeactivateTrace",
+  "TraceStart",
+  "TraceFailureIndication",
+  "ENBConfigurationUpdate",
+  "MMEConfigurationUpdate",
+  "LocationReportingControl",
+  "LocationReportingFailureIndication",
+  "LocationReport",
+  "OverloadStart",
+  "OverloadStop",
+  "WriteReplaceWarning",
+  "eNBDirectInformationTransfer",
+  "MMEDirectInformationTransfer",
+  "PrivateMessage",
+  "eNBConfigurationTransfer",
+  "MMEConfigurationTransfer",
+  "CellTrafficTrace",
+  "Kill",
+  "DownlinkUEAssociatedLPPaTransport",
+  "UplinkUEAssociatedLPPaTransport",
+  "DownlinkNonUEAssociatedLPPaTransport",
+  "UplinkNonUEAssociatedLPPaTransport",
+};
+
+// Metric series of each handler, per result: ok, error
+static metric_id_t                      s1ap_messages_metrics[S1AP_NB_PROCEDURES][3][2];
+static metric_id_t                      s1ap_messages_unhandled_metric = 0;
+
 const char                             *s1ap_direction2String[] = {
   "",                           /* Nothing */
   "Originating message",        /* originating message */
@@ -128,11 +201,14 @@ s1ap_mme_handle_message (
     const sctp_stream_id_t stream,
     struct s1ap_message_s *message)
 {
+  int                                     rc = RETURNok;
+
   /*
    * Checking procedure Code and direction of message
    */
-  if ((message->procedureCode > (sizeof (messages_callback) / (3 * sizeof (s1ap_message_decoded_callback)))) || (message->direction > S1AP_PDU_PR_unsuccessfulOutcome)) {
+  if ((message->procedureCode >= S1AP_NB_PROCEDURES) || (message->direction > S1AP_PDU_PR_unsuccessfulOutcome)) {
     OAILOG_DEBUG (LOG_S1AP, "[SCTP %d] Either procedureCode %d or direction %d exceed expected\n", assoc_id, (int)message->procedureCode, (int)message->direction);
+    metrics_inc (s1ap_messages_unhandled_metric);
     return -1;
   }
 
@@ -142,13 +218,37 @@ s1ap_mme_handle_message (
    */
   if (messages_callback[message->procedureCode][message->direction - 1] == NULL) {
     OAILOG_DEBUG (LOG_S1AP, "[SCTP %d] No handler for procedureCode %d in %s\n", assoc_id, (int)message->procedureCode, s1ap_direction2String[(int)message->direction]);
+    metrics_inc (s1ap_messages_unhandled_metric);
     return -2;
   }
 
   /*
    * Calling the right handler
    */
-  return (*messages_callback[message->procedureCode][message->direction - 1]) (assoc_id, stream, message);
+  rc = (*messages_callback[message->procedureCode][message->direction - 1]) (assoc_id, stream, message);
+  metrics_inc (s1ap_messages_metrics[message->procedureCode][message->direction - 1][(RETURNok == rc) ? 0 : 1]);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+void
+s1ap_mme_handlers_metrics_init (void)
+{
+  static const char                      *direction_str[] = {"initiating", "successful_outcome", "unsuccessful_outcome"};
+
+  for (int procedure = 0; procedure < S1AP_NB_PROCEDURES; procedure++) {
+    for (int direction = 0; direction < 3; direction++) {
+      if (messages_callback[procedure][direction] == NULL) {
+        continue;
+      }
+      s1ap_messages_metrics[procedure][direction][0] = metrics_register ("mme_s1ap_messages_received_total", METRIC_COUNTER, "S1AP PDUs received from the eNBs",
+          "procedure=\"%s\",direction=\"%s\",result=\"ok\"", s1ap_procedure2String[procedure], direction_str[direction]);
+      s1ap_messages_metrics[procedure][direction][1] = metrics_register ("mme_s1ap_messages_received_total", METRIC_COUNTER, "S1AP PDUs received from the eNBs",
+          "procedure=\"%s\",direction=\"%s\",result=\"error\"", s1ap_procedure2String[procedure], direction_str[direction]);
+    }
+  }
+  s1ap_messages_unhandled_metric = metrics_register ("mme_s1ap_messages_received_total", METRIC_COUNTER, "S1AP PDUs received from the eNBs",
+      "procedure=\"other\",direction=\"\",result=\"unhandled\"");
 }
 
 //------------------------------------------------------------------------------
@@ -382,8 +482,9 @@ s1ap_mme_handle_s1_setup_request (
 
   OAILOG_DEBUG (LOG_S1AP, "Adding eNB to the list of served eNBs\n");
 
-  enb_association->enb_id = enb_id;
+  s1ap_set_enb_id (enb_association, enb_id);
   enb_association->default_paging_drx = s1SetupRequest_p->defaultPagingDRX;
+  s1ap_paging_update_enb_tais (enb_association, &s1SetupRequest_p->supportedTAs);
 
   if (enb_name != NULL) {
     memcpy(enb_association->enb_name, s1SetupRequest_p->eNBname.buf, s1SetupRequest_p->eNBname.size);
@@ -404,9 +505,10 @@ static
 s1ap_generate_s1_setup_response (
   enb_description_t * enb_association)
 {
-  int                                     i,j;
+  int                                     i;
   int                                     enc_rval = 0;
   S1ap_S1SetupResponseIEs_t              *s1_setup_response_p = NULL;
+  mme_config_served_t                    *served = NULL;
   S1ap_ServedGUMMEIsItem_t                servedGUMMEI;
   s1ap_message                            message = { 0 };
   uint8_t                                *buffer = NULL;
@@ -421,34 +523,24 @@ s1ap_generate_s1_setup_response (
   s1_setup_response_p = &message.msg.s1ap_S1SetupResponseIEs;
   mme_config_read_lock (&mme_config);
   s1_setup_response_p->relativeMMECapacity = mme_config.relative_capacity;
+  mme_config_unlock (&mme_config);
+  served = mme_config_served_acquire ();
 
   /*
    * Use the gummei parameters provided by configuration
    * that should be sorted
    */
-  for (i = 0; i < mme_config.served_tai.nb_tai; i++) {
-    bool plmn_added = false;
-    for (j=0; j < i; j++) {
-      if ((mme_config.served_tai.plmn_mcc[j] == mme_config.served_tai.plmn_mcc[i]) &&
-        (mme_config.served_tai.plmn_mnc[j] == mme_config.served_tai.plmn_mnc[i]) &&
-        (mme_config.served_tai.plmn_mnc_len[j] == mme_config.served_tai.plmn_mnc_len[i])
-        ) {
-        plmn_added = true;
-        break;
-      }
-    }
-    if (false == plmn_added) {
-      S1ap_PLMNidentity_t                    *plmn = NULL;
-      /*
-       * FIXME: free object from list once encoded
-       */
-      plmn = calloc (1, sizeof (*plmn));
-      MCC_MNC_TO_PLMNID (mme_config.served_tai.plmn_mcc[i], mme_config.served_tai.plmn_mnc[i], mme_config.served_tai.plmn_mnc_len[i], plmn);
-      ASN_SEQUENCE_ADD (&servedGUMMEI.servedPLMNs.list, plmn);
-    }
+  for (i = 0; i < served->nb_plmn; i++) {
+    S1ap_PLMNidentity_t                    *plmn = NULL;
+    /*
+     * FIXME: free object from list once encoded
+     */
+    plmn = calloc (1, sizeof (*plmn));
+    MCC_MNC_TO_PLMNID (served->plmn[i].mcc, served->plmn[i].mnc, served->plmn[i].mnc_len, plmn);
+    ASN_SEQUENCE_ADD (&servedGUMMEI.servedPLMNs.list, plmn);
   }
 
-  for (i = 0; i < mme_config.gummei.nb; i++) {
+  for (i = 0; i < served->nb_gummei; i++) {
     S1ap_MME_Group_ID_t                    *mme_gid = NULL;
     S1ap_MME_Code_t                        *mmec = NULL;
 
@@ -456,20 +548,19 @@ s1ap_generate_s1_setup_response (
      * FIXME: free object from list once encoded
      */
     mme_gid = calloc (1, sizeof (*mme_gid));
-    INT16_TO_OCTET_STRING (mme_config.gummei.gummei[i].mme_gid, mme_gid);
+    INT16_TO_OCTET_STRING (served->gummei[i].mme_gid, mme_gid);
     ASN_SEQUENCE_ADD (&servedGUMMEI.servedGroupIDs.list, mme_gid);
 
     /*
      * FIXME: free object from list once encoded
      */
     mmec = calloc (1, sizeof (*mmec));
-    INT8_TO_OCTET_STRING (mme_config.gummei.gummei[i].mme_code, mmec);
+    INT8_TO_OCTET_STRING (served->gummei[i].mme_code, mmec);
     ASN_SEQUENCE_ADD (&servedGUMMEI.servedMMECs.list, mmec);
 
   }
 
-
-  mme_config_unlock (&mme_config);
+  mme_config_served_release (served);
   /*
    * The MME is only serving E-UTRAN RAT, so the list contains only one element
    */
@@ -498,10 +589,152 @@ s1ap_generate_s1_setup_response (
   bstring b = blk2bstr(buffer, length);
   rc = s1ap_mme_itti_send_sctp_request (&b, enb_association->sctp_assoc_id, 0, INVALID_MME_UE_S1AP_ID);
 
+  if ((enc_rval >= 0) && (s1ap_overload.active)) {
+    s1ap_overload.enb_credit += s1ap_overload.enb_percent;
+    if (s1ap_overload.enb_credit >= 100) {
+      s1ap_overload.enb_credit -= 100;
+      s1ap_mme_generate_overload_start (enb_association, s1ap_overload.action);
+    }
+  }
+
 
   OAILOG_FUNC_RETURN (LOG_S1AP, rc);
 }
 
+//------------------------------------------------------------------------------
+static int
+s1ap_mme_generate_enb_configuration_update_failure (
+    const sctp_assoc_id_t assoc_id,
+    const S1ap_Cause_PR cause_type,
+    const long cause_value,
+    const long time_to_wait)
+{
+  uint8_t                                *buffer_p = NULL;
+  uint32_t                                length = 0;
+  s1ap_message                            message = { 0 };
+  S1ap_ENBConfigurationUpdateFailureIEs_t *enb_configuration_update_failure_p = NULL;
+  int                                     rc = RETURNok;
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  enb_configuration_update_failure_p = &message.msg.s1ap_ENBConfigurationUpdateFailureIEs;
+  message.procedureCode = S1ap_ProcedureCode_id_ENBConfigurationUpdate;
+  message.direction = S1AP_PDU_PR_unsuccessfulOutcome;
+  message.criticality = S1ap_Criticality_reject;
+  s1ap_mme_set_cause (&enb_configuration_update_failure_p->cause, cause_type, cause_value);
+
+  if (time_to_wait > -1) {
+    enb_configuration_update_failure_p->presenceMask |= S1AP_ENBCONFIGURATIONUPDATEFAILUREIES_TIMETOWAIT_PRESENT;
+    enb_configuration_update_failure_p->timeToWait = time_to_wait;
+  }
+
+  if (s1ap_mme_encode_pdu (&message, &buffer_p, &length) < 0) {
+    OAILOG_ERROR (LOG_S1AP, "Failed to encode eNB configuration update failure\n");
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+
+  MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_S1AP_ENB, NULL, 0, "0 ENBConfigurationUpdate/unsuccessfulOutcome assoc_id %u cause %u value %u", assoc_id, cause_type, cause_value);
+  bstring b = blk2bstr(buffer_p, length);
+  free (buffer_p);
+  rc = s1ap_mme_itti_send_sctp_request (&b, assoc_id, 0, INVALID_MME_UE_S1AP_ID);
+  OAILOG_FUNC_RETURN (LOG_S1AP, rc);
+}
+
+//------------------------------------------------------------------------------
+static int
+s1ap_mme_generate_enb_configuration_update_acknowledge (
+    const sctp_assoc_id_t assoc_id)
+{
+  uint8_t                                *buffer_p = NULL;
+  uint32_t                                length = 0;
+  s1ap_message                            message = { 0 };
+  int                                     rc = RETURNok;
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  message.procedureCode = S1ap_ProcedureCode_id_ENBConfigurationUpdate;
+  message.direction = S1AP_PDU_PR_successfulOutcome;
+  message.criticality = S1ap_Criticality_reject;
+
+  if (s1ap_mme_encode_pdu (&message, &buffer_p, &length) < 0) {
+    OAILOG_ERROR (LOG_S1AP, "Failed to encode eNB configuration update acknowledge\n");
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+
+  MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_S1AP_ENB, NULL, 0, "0 ENBConfigurationUpdate/successfulOutcome assoc_id %u", assoc_id);
+  /*
+   * Non-UE signalling -> stream 0
+   */
+  bstring b = blk2bstr(buffer_p, length);
+  free (buffer_p);
+  rc = s1ap_mme_itti_send_sctp_request (&b, assoc_id, 0, INVALID_MME_UE_S1AP_ID);
+  OAILOG_FUNC_RETURN (LOG_S1AP, rc);
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_handle_enb_configuration_update (
+    const sctp_assoc_id_t assoc_id,
+    const sctp_stream_id_t stream,
+    struct s1ap_message_s *message)
+{
+  S1ap_ENBConfigurationUpdateIEs_t       *enbConfigurationUpdate_p = NULL;
+  enb_description_t                      *enb_association = NULL;
+  int                                     rc = RETURNok;
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  DevAssert (message != NULL);
+  enbConfigurationUpdate_p = &message->msg.s1ap_ENBConfigurationUpdateIEs;
+  MSC_LOG_RX_MESSAGE (MSC_S1AP_MME, MSC_S1AP_ENB, NULL, 0, "0 ENBConfigurationUpdate/%s assoc_id %u stream %u",
+                      s1ap_direction2String[message->direction], assoc_id, stream);
+
+  if (stream != 0) {
+    OAILOG_ERROR (LOG_S1AP, "Received eNB configuration update on stream != 0\n");
+    rc = s1ap_mme_generate_enb_configuration_update_failure (assoc_id, S1ap_Cause_PR_protocol, S1ap_CauseProtocol_unspecified, -1);
+    OAILOG_FUNC_RETURN (LOG_S1AP, rc);
+  }
+
+  if ((enb_association = s1ap_is_enb_assoc_id_in_list (assoc_id)) == NULL) {
+    OAILOG_ERROR (LOG_S1AP, "Ignoring eNB configuration update from unknown assoc %u\n", assoc_id);
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+
+  if (enb_association->s1_state != S1AP_READY) {
+    OAILOG_WARNING (LOG_S1AP, "Ignoring eNB configuration update from eNB in state %s on assoc id %u\n",
+                    s1_enb_state_str[enb_association->s1_state], assoc_id);
+    rc = s1ap_mme_generate_enb_configuration_update_failure (assoc_id, S1ap_Cause_PR_transport,
+                                                             S1ap_CauseTransport_transport_resource_unavailable,
+                                                             S1ap_TimeToWait_v20s);
+    OAILOG_FUNC_RETURN (LOG_S1AP, rc);
+  }
+
+  /*
+   * 36.413 8.7.4.2: the supported TAs received overwrite the whole list of the eNB
+   */
+  if (enbConfigurationUpdate_p->presenceMask & S1AP_ENBCONFIGURATIONUPDATEIES_SUPPORTEDTAS_PRESENT) {
+    if (s1ap_mme_compare_ta_lists (&enbConfigurationUpdate_p->supportedTAs) != TA_LIST_RET_OK) {
+      OAILOG_ERROR (LOG_S1AP, "No Common PLMN with eNB %u, generate eNB configuration update failure\n", enb_association->enb_id);
+      rc = s1ap_mme_generate_enb_configuration_update_failure (assoc_id, S1ap_Cause_PR_misc, S1ap_CauseMisc_unknown_PLMN, S1ap_TimeToWait_v20s);
+      OAILOG_FUNC_RETURN (LOG_S1AP, rc);
+    }
+    s1ap_paging_update_enb_tais (enb_association, &enbConfigurationUpdate_p->supportedTAs);
+  }
+
+  if (enbConfigurationUpdate_p->presenceMask & S1AP_ENBCONFIGURATIONUPDATEIES_ENBNAME_PRESENT) {
+    const int                               size = (enbConfigurationUpdate_p->eNBname.size < (int) sizeof (enb_association->enb_name)) ?
+                                                   enbConfigurationUpdate_p->eNBname.size : (int) sizeof (enb_association->enb_name) - 1;
+
+    memcpy (enb_association->enb_name, enbConfigurationUpdate_p->eNBname.buf, size);
+    enb_association->enb_name[size] = '\0';
+  }
+
+  if (enbConfigurationUpdate_p->presenceMask & S1AP_ENBCONFIGURATIONUPDATEIES_DEFAULTPAGINGDRX_PRESENT) {
+    enb_association->default_paging_drx = enbConfigurationUpdate_p->defaultPagingDRX;
+  }
+
+  OAILOG_DEBUG (LOG_S1AP, "eNB %u configuration updated\n", enb_association->enb_id);
+  rc = s1ap_mme_generate_enb_configuration_update_acknowledge (assoc_id);
+  OAILOG_FUNC_RETURN (LOG_S1AP, rc);
+}
+
 //------------------------------------------------------------------------------
 int
 s1ap_mme_handle_ue_cap_indication (
@@ -560,7 +793,7 @@ s1ap_mme_handle_ue_cap_indication (
                         MSC_MMEAPP_MME,
                         NULL, 0, "0 S1AP_UE_CAPABILITIES_IND enb_ue_s1ap_id " ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " len %u",
                         ue_cap_ind_p->enb_ue_s1ap_id, ue_cap_ind_p->mme_ue_s1ap_id, ue_cap_ind_p->radio_capabilities_length);
-    rc = itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+    rc = itti_send_msg_to_task (MME_APP_TASK_ID(ue_cap_ind_p->mme_ue_s1ap_id), INSTANCE_DEFAULT, message_p);
     OAILOG_FUNC_RETURN (LOG_S1AP, rc);
   }
   OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
@@ -631,7 +864,7 @@ s1ap_mme_handle_initial_context_setup_response (
                       MME_APP_INITIAL_CONTEXT_SETUP_RSP (message_p).mme_ue_s1ap_id,
                       MME_APP_INITIAL_CONTEXT_SETUP_RSP (message_p).eps_bearer_id,
                       MME_APP_INITIAL_CONTEXT_SETUP_RSP (message_p).bearer_s1u_enb_fteid.teid);
-  rc =  itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  rc =  itti_send_msg_to_task (MME_APP_TASK_ID(ue_ref_p->mme_ue_s1ap_id), INSTANCE_DEFAULT, message_p);
   OAILOG_FUNC_RETURN (LOG_S1AP, rc);
 }
 
@@ -720,7 +953,7 @@ s1ap_mme_handle_ue_context_release_request (
       S1AP_UE_CONTEXT_RELEASE_REQ (message_p).enb_id         = ue_ref_p->enb->enb_id;
       MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_MMEAPP_MME, NULL, 0, "0 S1AP_UE_CONTEXT_RELEASE_REQ mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " ",
               S1AP_UE_CONTEXT_RELEASE_REQ (message_p).mme_ue_s1ap_id);
-      rc =  itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+      rc =  itti_send_msg_to_task (MME_APP_TASK_ID(ue_ref_p->mme_ue_s1ap_id), INSTANCE_DEFAULT, message_p);
       OAILOG_FUNC_RETURN (LOG_S1AP, rc);
     } else {
       // abnormal case. No need to do anything. Ignore the message   
@@ -773,6 +1006,9 @@ s1ap_mme_generate_ue_context_release_command (
   case S1AP_RADIO_EUTRAN_GENERATED_REASON:cause_type = S1ap_Cause_PR_radioNetwork;
     cause_value = S1ap_CauseRadioNetwork_release_due_to_eutran_generated_reason;
     break;
+  case S1AP_CONTROL_PROCESSING_OVERLOAD:cause_type = S1ap_Cause_PR_misc;
+    cause_value = S1ap_CauseMisc_control_processing_overload;
+    break;
   default:
     AssertFatal(false, "Unknown cause for context release");
     break;
@@ -875,7 +1111,7 @@ s1ap_mme_handle_ue_context_release_complete (
   memset ((void *)&message_p->ittiMsg.s1ap_ue_context_release_complete, 0, sizeof (itti_s1ap_ue_context_release_complete_t));
   S1AP_UE_CONTEXT_RELEASE_COMPLETE (message_p).mme_ue_s1ap_id = ue_ref_p->mme_ue_s1ap_id;
   MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_MMEAPP_MME, NULL, 0, "0 S1AP_UE_CONTEXT_RELEASE_COMPLETE mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " ", S1AP_UE_CONTEXT_RELEASE_COMPLETE (message_p).mme_ue_s1ap_id);
-  itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  itti_send_msg_to_task (MME_APP_TASK_ID(ue_ref_p->mme_ue_s1ap_id), INSTANCE_DEFAULT, message_p);
   DevAssert(ue_ref_p->s1_ue_state == S1AP_UE_WAITING_CRR);
   s1ap_remove_ue (ue_ref_p);
   OAILOG_DEBUG (LOG_S1AP, "Removed UE " MME_UE_S1AP_ID_FMT "\n", (uint32_t) ueContextReleaseComplete_p->mme_ue_s1ap_id);
@@ -961,6 +1197,20 @@ s1ap_mme_handle_path_switch_request (
   OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
 }
 
+//------------------------------------------------------------------------------
+// The UEs of a batch may be owned by any MME_APP worker, each worker gets its own copy
+// and releases only its UEs.
+static void s1ap_mme_itti_send_enb_deregistered_ind (MessageDef * const message_p)
+{
+  for (int i = 1; i < mme_config.num_app_workers; i++) {
+    MessageDef *copy_p = itti_alloc_new_message (TASK_S1AP, S1AP_ENB_DEREGISTERED_IND);
+
+    S1AP_ENB_DEREGISTERED_IND (copy_p) = S1AP_ENB_DEREGISTERED_IND (message_p);
+    itti_send_msg_to_task (TASK_MME_APP + i, INSTANCE_DEFAULT, copy_p);
+  }
+  itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+}
+
 //------------------------------------------------------------------------------
 typedef struct arg_s1ap_send_enb_dereg_ind_s {
   uint8_t      current_ue_index;
@@ -997,7 +1247,7 @@ static bool s1ap_send_enb_deregistered_ind (
     // max ues reached
     if (arg->current_ue_index == 0 && arg->handled_ues > 0) {
       S1AP_ENB_DEREGISTERED_IND (arg->message_p).nb_ue_to_deregister = S1AP_ITTI_UE_PER_DEREGISTER_MESSAGE;
-      itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, arg->message_p);
+      s1ap_mme_itti_send_enb_deregistered_ind (arg->message_p);
       MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_NAS_MME, NULL, 0, "0 S1AP_ENB_DEREGISTERED_IND num ue to deregister %u",
           S1AP_ENB_DEREGISTERED_IND (arg->message_p).nb_ue_to_deregister);
       arg->message_p = NULL;
@@ -1060,7 +1310,7 @@ s1ap_handle_sctp_disconnection(
   S1AP_ENB_DEREGISTERED_IND (message_p).enb_id = enb_association->enb_id;
   MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_NAS_MME, NULL, 0, "0 S1AP_ENB_DEREGISTERED_IND num ue to deregister %u",
                       S1AP_ENB_DEREGISTERED_IND (message_p).nb_ue_to_deregister);
-  itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  s1ap_mme_itti_send_enb_deregistered_ind (message_p);
   message_p = NULL;
 
 
@@ -1126,11 +1376,42 @@ s1ap_handle_new_association (
    * * * * ue associated signalling.
    */
   enb_association->next_sctp_stream = 1;
+  enb_association->sctp_congested = false;
   enb_association->s1_state = S1AP_INIT;
   MSC_LOG_EVENT (MSC_S1AP_MME, "0 Event SCTP_NEW_ASSOCIATION assoc_id: %d", enb_association->sctp_assoc_id);
   OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
 }
 
+//------------------------------------------------------------------------------
+int
+s1ap_handle_sctp_congestion (
+  const sctp_congestion_ind_t * const sctp_congestion_ind_p)
+{
+  enb_description_t                      *enb_association = NULL;
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  DevAssert (sctp_congestion_ind_p != NULL);
+
+  if ((enb_association = s1ap_is_enb_assoc_id_in_list (sctp_congestion_ind_p->assoc_id)) == NULL) {
+    OAILOG_WARNING (LOG_S1AP, "No eNB attached to this assoc_id: %d\n", sctp_congestion_ind_p->assoc_id);
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+
+  /*
+   * While congested, no new UE procedure is started and no paging is sent towards this eNB,
+   * procedures already running keep their PDUs in the SCTP send queue.
+   */
+  enb_association->sctp_congested = sctp_congestion_ind_p->is_congested;
+  if (enb_association->sctp_congested) {
+    OAILOG_WARNING (LOG_S1AP, "eNB %s (id %u) assoc_id %d congested, %u PDUs queued\n",
+        enb_association->enb_name, enb_association->enb_id, sctp_congestion_ind_p->assoc_id, sctp_congestion_ind_p->queue_depth);
+  } else {
+    OAILOG_NOTICE (LOG_S1AP, "eNB %s (id %u) assoc_id %d no longer congested, %u PDUs queued\n",
+        enb_association->enb_name, enb_association->enb_id, sctp_congestion_ind_p->assoc_id, sctp_congestion_ind_p->queue_depth);
+  }
+  OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+}
+
 //------------------------------------------------------------------------------
 void
 s1ap_mme_handle_ue_context_rel_comp_timer_expiry (ue_description_t *ue_ref_p)
@@ -1148,7 +1429,7 @@ s1ap_mme_handle_ue_context_rel_comp_timer_expiry (ue_description_t *ue_ref_p)
   memset ((void *)&message_p->ittiMsg.s1ap_ue_context_release_complete, 0, sizeof (itti_s1ap_ue_context_release_complete_t));
   S1AP_UE_CONTEXT_RELEASE_COMPLETE (message_p).mme_ue_s1ap_id = ue_ref_p->mme_ue_s1ap_id;
   MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_MMEAPP_MME, NULL, 0, "0 S1AP_UE_CONTEXT_RELEASE_COMPLETE mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " ", S1AP_UE_CONTEXT_RELEASE_COMPLETE (message_p).mme_ue_s1ap_id);
-  itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  itti_send_msg_to_task (MME_APP_TASK_ID(ue_ref_p->mme_ue_s1ap_id), INSTANCE_DEFAULT, message_p);
   DevAssert(ue_ref_p->s1_ue_state == S1AP_UE_WAITING_CRR);
   OAILOG_DEBUG (LOG_S1AP, "Removed S1AP UE " MME_UE_S1AP_ID_FMT "\n", (uint32_t) ue_ref_p->mme_ue_s1ap_id);
   s1ap_remove_ue (ue_ref_p);
@@ -1164,3 +1445,146 @@ s1ap_mme_handle_error_ind_message (const sctp_assoc_id_t assoc_id, const sctp_st
 }
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+static int
+s1ap_mme_generate_overload_start (
+  enb_description_t * enb_association,
+  const s1ap_overload_action_t action)
+{
+  uint8_t                                *buffer = NULL;
+  uint32_t                                length = 0;
+  s1ap_message                            message = {0};
+  S1ap_OverloadStartIEs_t                *overloadStartIEs_p = NULL;
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  message.procedureCode = S1ap_ProcedureCode_id_OverloadStart;
+  message.direction = S1AP_PDU_PR_initiatingMessage;
+  message.criticality = S1ap_Criticality_ignore;
+  overloadStartIEs_p = &message.msg.s1ap_OverloadStartIEs;
+  overloadStartIEs_p->overloadResponse.present = S1ap_OverloadResponse_PR_overloadAction;
+  switch (action) {
+  case S1AP_OVERLOAD_REJECT_ALL_RRC_CR_SIGNALLING:
+    overloadStartIEs_p->overloadResponse.choice.overloadAction = S1ap_OverloadAction_reject_rrc_cr_signalling;
+    break;
+  case S1AP_OVERLOAD_PERMIT_EMERGENCY_SESSIONS_ONLY:
+    overloadStartIEs_p->overloadResponse.choice.overloadAction = S1ap_OverloadAction_permit_emergency_sessions_and_mobile_terminated_services_only;
+    break;
+  default:
+    overloadStartIEs_p->overloadResponse.choice.overloadAction = S1ap_OverloadAction_reject_non_emergency_mo_dt;
+    break;
+  }
+
+  if (s1ap_mme_encode_pdu (&message, &buffer, &length) < 0) {
+    OAILOG_ERROR (LOG_S1AP, "Failed to encode OVERLOAD START for eNB %u\n", enb_association->enb_id);
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+
+  MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_S1AP_ENB, NULL, 0, "0 OverloadStart/initiatingMessage assoc_id %u action %u", enb_association->sctp_assoc_id, action);
+  enb_association->overload_started = true;
+  /*
+   * Non-UE signalling -> stream 0
+   */
+  bstring b = blk2bstr(buffer, length);
+  free (buffer);
+  OAILOG_FUNC_RETURN (LOG_S1AP, s1ap_mme_itti_send_sctp_request (&b, enb_association->sctp_assoc_id, 0, INVALID_MME_UE_S1AP_ID));
+}
+
+//------------------------------------------------------------------------------
+static int
+s1ap_mme_generate_overload_stop (
+  enb_description_t * enb_association)
+{
+  uint8_t                                *buffer = NULL;
+  uint32_t                                length = 0;
+  s1ap_message                            message = {0};
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  message.procedureCode = S1ap_ProcedureCode_id_OverloadStop;
+  message.direction = S1AP_PDU_PR_initiatingMessage;
+  message.criticality = S1ap_Criticality_reject;
+
+  if (s1ap_mme_encode_pdu (&message, &buffer, &length) < 0) {
+    OAILOG_ERROR (LOG_S1AP, "Failed to encode OVERLOAD STOP for eNB %u\n", enb_association->enb_id);
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+
+  MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_S1AP_ENB, NULL, 0, "0 OverloadStop/initiatingMessage assoc_id %u", enb_association->sctp_assoc_id);
+  enb_association->overload_started = false;
+  bstring b = blk2bstr(buffer, length);
+  free (buffer);
+  OAILOG_FUNC_RETURN (LOG_S1AP, s1ap_mme_itti_send_sctp_request (&b, enb_association->sctp_assoc_id, 0, INVALID_MME_UE_S1AP_ID));
+}
+
+//------------------------------------------------------------------------------
+static bool
+s1ap_send_overload_start_cb (
+  __attribute__((unused)) const hash_key_t keyP,
+  void * const elementP,
+  __attribute__((unused)) void *argP,
+  void **resultP)
+{
+  enb_description_t                      *enb_ref_p = (enb_description_t *) elementP;
+  uint32_t                               *nb_enb_p = (uint32_t *) resultP;
+
+  if ((enb_ref_p->s1_state != S1AP_READY) || (enb_ref_p->overload_started)) {
+    return false;
+  }
+
+  s1ap_overload.enb_credit += s1ap_overload.enb_percent;
+  if (s1ap_overload.enb_credit >= 100) {
+    s1ap_overload.enb_credit -= 100;
+    if (RETURNok == s1ap_mme_generate_overload_start (enb_ref_p, s1ap_overload.action)) {
+      *nb_enb_p += 1;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+static bool
+s1ap_send_overload_stop_cb (
+  __attribute__((unused)) const hash_key_t keyP,
+  void * const elementP,
+  __attribute__((unused)) void *argP,
+  void **resultP)
+{
+  enb_description_t                      *enb_ref_p = (enb_description_t *) elementP;
+  uint32_t                               *nb_enb_p = (uint32_t *) resultP;
+
+  if (enb_ref_p->overload_started) {
+    if (RETURNok == s1ap_mme_generate_overload_stop (enb_ref_p)) {
+      *nb_enb_p += 1;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_handle_overload_start (
+  const itti_s1ap_overload_start_t * const overload_start_pP)
+{
+  uint32_t                                nb_enb = 0;
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  s1ap_overload.active = true;
+  s1ap_overload.action = overload_start_pP->action;
+  s1ap_overload.enb_percent = (overload_start_pP->enb_percent > 100) ? 100:overload_start_pP->enb_percent;
+  s1ap_overload.enb_credit = 0;
+  hashtable_ts_apply_callback_on_elements (&g_s1ap_enb_coll, s1ap_send_overload_start_cb, NULL, (void**)&nb_enb);
+  OAILOG_WARNING (LOG_S1AP, "OVERLOAD START (action %u) sent to %u/%u eNBs\n", s1ap_overload.action, nb_enb, nb_enb_associated);
+  OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_handle_overload_stop (void)
+{
+  uint32_t                                nb_enb = 0;
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  s1ap_overload.active = false;
+  hashtable_ts_apply_callback_on_elements (&g_s1ap_enb_coll, s1ap_send_overload_stop_cb, NULL, (void**)&nb_enb);
+  OAILOG_WARNING (LOG_S1AP, "OVERLOAD STOP sent to %u eNBs\n", nb_enb);
+  OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+}
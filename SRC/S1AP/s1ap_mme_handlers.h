@@ -54,6 +54,18 @@ int s1ap_mme_handle_ue_cap_indication(const sctp_assoc_id_t assoc_id, const sctp
 int s1ap_mme_handle_s1_setup_request(const sctp_assoc_id_t assoc_id, const sctp_stream_id_t stream,
                                      struct s1ap_message_s *message_p);
 
+/** \brief Handle an eNB Configuration Update message.
+ * Update the name, default paging DRX and supported TAs of the eNB, the supported
+ * TAs replace the ones of the eNB in the paging TAI index. ENBConfigurationUpdateAcknowledge
+ * is sent in case of success or ENBConfigurationUpdateFailure if no PLMN is served by the MME.
+ * \param assoc_id SCTP association ID
+ * \param stream Stream number
+ * \param message_p The message decoded by the ASN1C decoder
+ * @returns int
+ **/
+int s1ap_mme_handle_enb_configuration_update(const sctp_assoc_id_t assoc_id, const sctp_stream_id_t stream,
+                                             struct s1ap_message_s *message_p);
+
 int s1ap_mme_handle_path_switch_request(const sctp_assoc_id_t assoc_id, const sctp_stream_id_t stream,
                                         struct s1ap_message_s *message_p);
 
@@ -74,10 +86,14 @@ int s1ap_mme_handle_initial_context_setup_response(
     const sctp_stream_id_t stream,
     struct s1ap_message_s *message_p);
 
+void s1ap_mme_handlers_metrics_init(void);
+
 int s1ap_handle_sctp_disconnection(const sctp_assoc_id_t assoc_id, bool reset);
 
 int s1ap_handle_new_association(sctp_new_peer_t *sctp_new_peer_p);
 
+int s1ap_handle_sctp_congestion(const sctp_congestion_ind_t * const sctp_congestion_ind_p);
+
 int s1ap_mme_set_cause(S1ap_Cause_t *cause_p, const S1ap_Cause_PR cause_type, const long cause_value);
 
 int s1ap_mme_generate_s1_setup_failure(
@@ -88,4 +104,15 @@ void s1ap_mme_handle_ue_context_rel_comp_timer_expiry (ue_description_t *ue_ref_
 
 int s1ap_mme_handle_error_ind_message (const sctp_assoc_id_t assoc_id, 
                                        const sctp_stream_id_t stream, struct s1ap_message_s *message);
+
+/** \brief Send OVERLOAD START to a share of the S1 ready eNBs
+ * \param overload_start_pP Overload action and share of eNBs requested by MME_APP
+ * @returns int
+ **/
+int s1ap_handle_overload_start(const itti_s1ap_overload_start_t * const overload_start_pP);
+
+/** \brief Send OVERLOAD STOP to all eNBs that received OVERLOAD START
+ * @returns int
+ **/
+int s1ap_handle_overload_stop(void);
 #endif /* FILE_S1AP_MME_HANDLERS_SEEN */
@@ -38,6 +38,10 @@ s1ap_mme_itti_send_sctp_request (
   SCTP_DATA_REQ (message_p).assoc_id = assoc_id;
   SCTP_DATA_REQ (message_p).stream = stream;
   SCTP_DATA_REQ (message_p).mme_ue_s1ap_id = ue_id;
+  if (mme_config.num_s1ap_codec_workers) {
+    // keep the order with the PDUs of this association being encoded by its codec task
+    return itti_send_msg_to_task (S1AP_CODEC_TASK_ID(assoc_id), INSTANCE_DEFAULT, message_p);
+  }
   return itti_send_msg_to_task (TASK_SCTP, INSTANCE_DEFAULT, message_p);
 }
 
@@ -60,7 +64,7 @@ s1ap_mme_itti_nas_uplink_ind (
 
   MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_NAS_MME, NULL, 0, "0 NAS_UPLINK_DATA_IND ue_id " MME_UE_S1AP_ID_FMT " len %u",
       NAS_UL_DATA_IND (message_p).ue_id, blength(NAS_UL_DATA_IND (message_p).nas_msg));
-  return itti_send_msg_to_task (TASK_NAS_MME, INSTANCE_DEFAULT, message_p);
+  return itti_send_msg_to_task (NAS_MME_TASK_ID(ue_id), INSTANCE_DEFAULT, message_p);
 }
 
 //------------------------------------------------------------------------------
@@ -80,5 +84,5 @@ s1ap_mme_itti_nas_downlink_cnf (
   }
   MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_NAS_MME, NULL, 0, "0 NAS_DOWNLINK_DATA_CNF ue_id " MME_UE_S1AP_ID_FMT " err_code %u",
       NAS_DL_DATA_CNF (message_p).ue_id, NAS_DL_DATA_CNF (message_p).err_code);
-  return itti_send_msg_to_task (TASK_NAS_MME, INSTANCE_DEFAULT, message_p);
+  return itti_send_msg_to_task (NAS_MME_TASK_ID(ue_id), INSTANCE_DEFAULT, message_p);
 }
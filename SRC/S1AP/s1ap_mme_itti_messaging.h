@@ -31,6 +31,7 @@
 #include "intertask_interface.h"
 #include "common_types.h"
 #include "s1ap_common.h"
+#include "mme_config.h"
 
 #ifndef FILE_S1AP_MME_ITTI_MESSAGING_SEEN
 #define FILE_S1AP_MME_ITTI_MESSAGING_SEEN
@@ -121,7 +122,15 @@ static inline void s1ap_mme_itti_mme_app_initial_ue_message(
         (9 < MME_APP_INITIAL_UE_MESSAGE(message_p).tai.plmn.mnc_digit3) ? ' ': (char)(MME_APP_INITIAL_UE_MESSAGE(message_p).tai.plmn.mnc_digit3 + 0x30),
         MME_APP_INITIAL_UE_MESSAGE(message_p).tai.tac,
         MME_APP_INITIAL_UE_MESSAGE(message_p).nas->slen);
-  itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  // UE ids are allocated so that the owning MME_APP worker can be derived from them,
+  // a new UE is given to the worker selected by its eNB UE S1AP id
+  if (INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id) {
+    itti_send_msg_to_task(MME_APP_TASK_ID(mme_ue_s1ap_id), INSTANCE_DEFAULT, message_p);
+  } else if (opt_s_tmsi) {
+    itti_send_msg_to_task(MME_APP_TASK_ID(opt_s_tmsi->m_tmsi), INSTANCE_DEFAULT, message_p);
+  } else {
+    itti_send_msg_to_task(MME_APP_TASK_ID(enb_ue_s1ap_id), INSTANCE_DEFAULT, message_p);
+  }
   OAILOG_FUNC_OUT (LOG_S1AP);
 }
 
@@ -191,7 +200,7 @@ static inline void s1ap_mme_itti_nas_non_delivery_ind(
 
   // should be sent to MME_APP, but this one would forward it to NAS_MME, so send it directly to NAS_MME
   // but let's see
-  itti_send_msg_to_task(TASK_NAS_MME, INSTANCE_DEFAULT, message_p);
+  itti_send_msg_to_task(NAS_MME_TASK_ID(ue_id), INSTANCE_DEFAULT, message_p);
   OAILOG_FUNC_OUT (LOG_S1AP);
 }
 
@@ -36,6 +36,7 @@
 #include "s1ap_mme_encoder.h"
 #include "s1ap_mme_itti_messaging.h"
 #include "s1ap_mme.h"
+#include "s1ap_mme_paging.h"
 
 /* Every time a new UE is associated, increment this variable.
    But care if it wraps to increment also the mme_ue_s1ap_id_has_wrapped
@@ -84,6 +85,15 @@ s1ap_mme_handle_initial_ue_message (
     ecgi_t                                  ecgi = {.plmn = {0}, .cell_identity = {0}};
     csg_id_t                                csg_id = 0;
 
+    if (eNB_ref->sctp_congested) {
+      /*
+       * Any reject would wait in the same full SCTP send queue: the eNB times out the RRC connection instead.
+       */
+      OAILOG_WARNING (LOG_S1AP, "S1AP:Initial UE Message- eNB %u congested, no new procedure, eNBUeS1APId:" ENB_UE_S1AP_ID_FMT "\n",
+          eNB_ref->enb_id, enb_ue_s1ap_id);
+      OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+    }
+
     /*
      * This UE eNB Id has currently no known s1 association.
      * * * * Create new UE context by associating new mme_ue_s1ap_id.
@@ -137,6 +147,8 @@ s1ap_mme_handle_initial_ue_message (
     if (initialUEMessage_p->presenceMask & S1AP_INITIALUEMESSAGEIES_S_TMSI_PRESENT) {
       OCTET_STRING_TO_MME_CODE(&initialUEMessage_p->s_tmsi.mMEC, s_tmsi.mme_code);
       OCTET_STRING_TO_M_TMSI(&initialUEMessage_p->s_tmsi.m_TMSI, s_tmsi.m_tmsi);
+      // The UE may answer a paging
+      s1ap_paging_stop (s_tmsi.mme_code, s_tmsi.m_tmsi);
     }
 
     if (initialUEMessage_p->presenceMask & S1AP_INITIALUEMESSAGEIES_CSG_ID_PRESENT) {
@@ -389,6 +401,23 @@ s1ap_generate_downlink_nas_transport (
     bdestroy(*payload);
     *payload = NULL;
 
+    if (mme_config.num_s1ap_codec_workers) {
+      /*
+       * Let the codec task of the association encode it.
+       */
+      MessageDef                         *message_p = itti_alloc_new_message (TASK_S1AP, S1AP_ENCODE_PDU_REQ);
+
+      S1AP_ENCODE_PDU_REQ (message_p).assoc_id       = ue_ref->enb->sctp_assoc_id;
+      S1AP_ENCODE_PDU_REQ (message_p).stream         = ue_ref->sctp_stream_send;
+      S1AP_ENCODE_PDU_REQ (message_p).mme_ue_s1ap_id = ue_ref->mme_ue_s1ap_id;
+      S1AP_ENCODE_PDU_REQ (message_p).message        = malloc (sizeof (s1ap_message));
+      *S1AP_ENCODE_PDU_REQ (message_p).message       = message;
+      OAILOG_NOTICE (LOG_S1AP, "Send S1AP DOWNLINK_NAS_TRANSPORT message ue_id = " MME_UE_S1AP_ID_FMT " MME_UE_S1AP_ID = " MME_UE_S1AP_ID_FMT " eNB_UE_S1AP_ID = " ENB_UE_S1AP_ID_FMT " to codec\n",
+                  ue_id, (mme_ue_s1ap_id_t)downlinkNasTransport->mme_ue_s1ap_id, (enb_ue_s1ap_id_t)downlinkNasTransport->eNB_UE_S1AP_ID);
+      itti_send_msg_to_task (S1AP_CODEC_TASK_ID(ue_ref->enb->sctp_assoc_id), INSTANCE_DEFAULT, message_p);
+      OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+    }
+
     if (s1ap_mme_encode_pdu (&message, &buffer_p, &length) < 0) {
       // TODO: handle something
       OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
@@ -0,0 +1,559 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_paging.c
+  \brief Network triggered paging of ECM-IDLE UEs over S1 (TS 23.401 5.3.4.3, TS 36.413 8.5)
+
+  The TAIs advertised by the eNBs in S1 SETUP REQUEST and ENB CONFIGURATION UPDATE
+  are kept in a TAI to eNBs index, so the eNBs of a TAI list are found without
+  scanning all the eNBs. The S1AP PAGING of a UE is encoded once, the same PDU is
+  then sent to every S1 ready eNB of its TAIs, once per eNB even if it serves
+  several of them. The first attempt only goes to the last visited TAI, the next
+  ones to the whole TAI list. Each eNB has a per second paging budget, an eNB over
+  its budget is skipped and only gets the next attempt.
+  The paging contexts are in a FIFO: the paging timer value is the same for all of
+  them, so the FIFO is in expiry order and a periodic tick only pops its head.
+  Only used by the S1AP task.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "hashtable.h"
+#include "log.h"
+#include "assertions.h"
+#include "conversions.h"
+#include "intertask_interface.h"
+#include "timer.h"
+#include "mme_config.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme_encoder.h"
+#include "s1ap_mme_itti_messaging.h"
+#include "s1ap_mme.h"
+#include "s1ap_mme_paging.h"
+
+#define S1AP_PAGING_TICK_MS        100
+#define S1AP_PAGING_TA_HTBL_SIZE   1024
+#define S1AP_PAGING_UE_HTBL_SIZE   4096
+#define S1AP_PAGING_UE_INDEX_MOD   1024  // UE identity index value, IMSI mod 1024 (TS 36.304 7.1)
+
+// eNBs serving a TAI
+typedef struct s1ap_paging_ta_s {
+  tai_t                                   tai;
+  uint32_t                                nb_enbs;
+  uint32_t                                max_enbs;
+  enb_description_t                     **enbs;
+} s1ap_paging_ta_t;
+
+// UE being paged
+typedef struct s1ap_paging_ue_s {
+  hash_key_t                              key;          // S-TMSI
+  mme_ue_s1ap_id_t                        mme_ue_s1ap_id;
+  bstring                                 pdu;          // S1AP PAGING, encoded once
+  tai_t                                   last_visited_tai;
+  tai_list_t                              tai_list;
+  uint8_t                                 nb_attempts;
+  uint64_t                                expiry_ms;
+  struct s1ap_paging_ue_s                *next;         // FIFO, in expiry order
+  struct s1ap_paging_ue_s                *prev;
+} s1ap_paging_ue_t;
+
+typedef struct s1ap_paging_s {
+  hash_table_t                           *ta_coll;      // s1ap_paging_ta_t, key is the TAI
+  hash_table_t                           *ue_coll;      // s1ap_paging_ue_t, key is the S-TMSI
+  s1ap_paging_ue_t                       *head;
+  s1ap_paging_ue_t                       *tail;
+  uint32_t                                generation;   // incremented for each paging sent
+  long                                    timer_id;     // periodic tick
+  struct timespec                         start_time;
+  // since last report
+  uint32_t                                nb_pagings;
+  uint32_t                                nb_sent;
+  uint32_t                                nb_rate_limited;
+  uint32_t                                nb_congested;
+  uint32_t                                nb_answered;
+  uint32_t                                nb_failed;
+} s1ap_paging_t;
+
+static s1ap_paging_t                    s1ap_paging = {0};
+
+//------------------------------------------------------------------------------
+static uint64_t s1ap_paging_get_ms (void)
+{
+  struct timespec                         ts = {0};
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ((ts.tv_sec - s1ap_paging.start_time.tv_sec) * 1000 + (ts.tv_nsec - s1ap_paging.start_time.tv_nsec) / 1000000);
+}
+
+//------------------------------------------------------------------------------
+static hash_key_t s1ap_paging_tai_key (const tai_t * const tai)
+{
+  return ((hash_key_t) tai->plmn.mcc_digit1 << 36) | ((hash_key_t) tai->plmn.mcc_digit2 << 32) | ((hash_key_t) tai->plmn.mcc_digit3 << 28) |
+         ((hash_key_t) tai->plmn.mnc_digit1 << 24) | ((hash_key_t) tai->plmn.mnc_digit2 << 20) | ((hash_key_t) tai->plmn.mnc_digit3 << 16) |
+         (hash_key_t) tai->tac;
+}
+
+//------------------------------------------------------------------------------
+static hash_key_t s1ap_paging_ue_key (const uint8_t mme_code, const uint32_t m_tmsi)
+{
+  return ((hash_key_t) mme_code << 32) | (hash_key_t) m_tmsi;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_paging_free_ta (void **ta_pp)
+{
+  s1ap_paging_ta_t                       *ta_p = (s1ap_paging_ta_t *) *ta_pp;
+
+  if (ta_p) {
+    free_wrapper ((void **)&ta_p->enbs);
+    free_wrapper (ta_pp);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_paging_free_ue (void **ue_pp)
+{
+  s1ap_paging_ue_t                       *ue_p = (s1ap_paging_ue_t *) *ue_pp;
+
+  if (ue_p) {
+    bdestroy (ue_p->pdu);
+    free_wrapper (ue_pp);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_paging_ta_add_enb (const tai_t * const tai, enb_description_t * const enb_ref)
+{
+  s1ap_paging_ta_t                       *ta_p = NULL;
+  const hash_key_t                        key = s1ap_paging_tai_key (tai);
+
+  if (HASH_TABLE_OK != hashtable_get (s1ap_paging.ta_coll, key, (void **)&ta_p)) {
+    ta_p = calloc (1, sizeof (*ta_p));
+    DevAssert (ta_p != NULL);
+    ta_p->tai = *tai;
+    hashtable_insert (s1ap_paging.ta_coll, key, ta_p);
+  }
+  for (uint32_t i = 0; i < ta_p->nb_enbs; i++) {
+    if (ta_p->enbs[i] == enb_ref) {
+      return;
+    }
+  }
+  if (ta_p->nb_enbs == ta_p->max_enbs) {
+    ta_p->max_enbs = (ta_p->max_enbs) ? ta_p->max_enbs * 2 : 8;
+    ta_p->enbs = realloc (ta_p->enbs, ta_p->max_enbs * sizeof (enb_description_t *));
+    DevAssert (ta_p->enbs != NULL);
+  }
+  ta_p->enbs[ta_p->nb_enbs++] = enb_ref;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_paging_ta_remove_enb (const tai_t * const tai, const enb_description_t * const enb_ref)
+{
+  s1ap_paging_ta_t                       *ta_p = NULL;
+  const hash_key_t                        key = s1ap_paging_tai_key (tai);
+
+  if (HASH_TABLE_OK != hashtable_get (s1ap_paging.ta_coll, key, (void **)&ta_p)) {
+    return;
+  }
+  for (uint32_t i = 0; i < ta_p->nb_enbs; i++) {
+    if (ta_p->enbs[i] == enb_ref) {
+      ta_p->enbs[i] = ta_p->enbs[--ta_p->nb_enbs];
+      break;
+    }
+  }
+  if (!ta_p->nb_enbs) {
+    hashtable_free (s1ap_paging.ta_coll, key);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_paging_link (s1ap_paging_ue_t * const ue_p)
+{
+  ue_p->next = NULL;
+  ue_p->prev = s1ap_paging.tail;
+  if (s1ap_paging.tail) {
+    s1ap_paging.tail->next = ue_p;
+  } else {
+    s1ap_paging.head = ue_p;
+  }
+  s1ap_paging.tail = ue_p;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_paging_unlink (s1ap_paging_ue_t * const ue_p)
+{
+  if (ue_p->prev) {
+    ue_p->prev->next = ue_p->next;
+  } else {
+    s1ap_paging.head = ue_p->next;
+  }
+  if (ue_p->next) {
+    ue_p->next->prev = ue_p->prev;
+  } else {
+    s1ap_paging.tail = ue_p->prev;
+  }
+  ue_p->next = NULL;
+  ue_p->prev = NULL;
+}
+
+//------------------------------------------------------------------------------
+static int s1ap_paging_encode (const itti_s1ap_paging_request_t * const paging_request_p, bstring * const pdu)
+{
+  s1ap_message                            message = {0};
+  S1ap_PagingIEs_t                       *paging_p = &message.msg.s1ap_PagingIEs;
+  S1ap_TAIItem_t                          tai_item[TAI_LIST_MAX_SIZE];
+  uint8_t                                 plmn[TAI_LIST_MAX_SIZE][3];
+  uint8_t                                 tac[TAI_LIST_MAX_SIZE][2];
+  uint8_t                                 ue_identity_index[2];
+  uint8_t                                 mme_code = paging_request_p->mme_code;
+  uint8_t                                 m_tmsi[4];
+  uint8_t                                 imsi[(IMSI_BCD_DIGITS_MAX + 1) / 2] = {0};
+  char                                    imsi_digits[IMSI_BCD_DIGITS_MAX + 1] = {0};
+  const uint16_t                          ue_identity_index_value = (uint16_t) (paging_request_p->imsi64 % S1AP_PAGING_UE_INDEX_MOD);
+  uint8_t                                *buffer = NULL;
+  uint32_t                                length = 0;
+  int                                     rc = RETURNok;
+
+  message.procedureCode = S1ap_ProcedureCode_id_Paging;
+  message.direction = S1AP_PDU_PR_initiatingMessage;
+  message.criticality = S1ap_Criticality_ignore;
+  memset (tai_item, 0, sizeof (tai_item));
+
+  /*
+   * 10 bits BIT STRING, the encoded PDU does not reference these stack buffers
+   */
+  ue_identity_index[0] = (uint8_t) (ue_identity_index_value >> 2);
+  ue_identity_index[1] = (uint8_t) ((ue_identity_index_value & 0x03) << 6);
+  paging_p->ueIdentityIndexValue.buf = ue_identity_index;
+  paging_p->ueIdentityIndexValue.size = 2;
+  paging_p->ueIdentityIndexValue.bits_unused = 6;
+
+  if (paging_request_p->is_imsi_paging) {
+    const int                               nb_digits = IMSI64_TO_STRING (paging_request_p->imsi64, imsi_digits);
+
+    // TBCD, filler 0xF in the last octet for an odd number of digits
+    for (int i = 0; i < nb_digits; i++) {
+      imsi[i / 2] |= (uint8_t) ((imsi_digits[i] - '0') << ((i & 1) * 4));
+    }
+    if (nb_digits & 1) {
+      imsi[nb_digits / 2] |= 0xF0;
+    }
+    paging_p->uePagingID.present = S1ap_UEPagingID_PR_iMSI;
+    paging_p->uePagingID.choice.iMSI.buf = imsi;
+    paging_p->uePagingID.choice.iMSI.size = (nb_digits + 1) / 2;
+  } else {
+    INT32_TO_BUFFER (paging_request_p->m_tmsi, m_tmsi);
+    paging_p->uePagingID.present = S1ap_UEPagingID_PR_s_TMSI;
+    paging_p->uePagingID.choice.s_TMSI.mMEC.buf = &mme_code;
+    paging_p->uePagingID.choice.s_TMSI.mMEC.size = 1;
+    paging_p->uePagingID.choice.s_TMSI.m_TMSI.buf = m_tmsi;
+    paging_p->uePagingID.choice.s_TMSI.m_TMSI.size = 4;
+  }
+  paging_p->cnDomain = (S1AP_CN_DOMAIN_CS == paging_request_p->cn_domain) ? S1ap_CNDomain_cs : S1ap_CNDomain_ps;
+
+  for (int i = 0; i < paging_request_p->tai_list.n_tais; i++) {
+    const tai_t                            *tai = &paging_request_p->tai_list.tai[i];
+    const int                               mnc_length = (tai->plmn.mnc_digit3 == 0xF) ? 2 : 3;
+
+    PLMN_T_TO_TBCD (tai->plmn, plmn[i], mnc_length);
+    INT16_TO_BUFFER (tai->tac, tac[i]);
+    tai_item[i].tAI.pLMNidentity.buf = plmn[i];
+    tai_item[i].tAI.pLMNidentity.size = 3;
+    tai_item[i].tAI.tAC.buf = tac[i];
+    tai_item[i].tAI.tAC.size = 2;
+    ASN_SEQUENCE_ADD (&paging_p->taiList.s1ap_TAIItem, &tai_item[i]);
+  }
+
+  if (s1ap_mme_encode_pdu (&message, &buffer, &length) < 0) {
+    rc = RETURNerror;
+  } else {
+    *pdu = blk2bstr (buffer, length);
+    free (buffer);
+  }
+  free (paging_p->taiList.s1ap_TAIItem.array);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+static bool s1ap_paging_enb_has_budget (enb_description_t * const enb_ref, const uint32_t now_sec)
+{
+  if (!mme_config.s1ap_config.max_paging_per_enb_per_sec) {
+    return true;
+  }
+  if (enb_ref->paging_budget_sec != now_sec) {
+    enb_ref->paging_budget_sec = now_sec;
+    enb_ref->paging_budget = mme_config.s1ap_config.max_paging_per_enb_per_sec;
+  }
+  if (!enb_ref->paging_budget) {
+    return false;
+  }
+  enb_ref->paging_budget--;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t s1ap_paging_send_ta (const tai_t * const tai, const_bstring pdu, const uint32_t now_sec)
+{
+  s1ap_paging_ta_t                       *ta_p = NULL;
+  uint32_t                                nb_sent = 0;
+
+  if (HASH_TABLE_OK != hashtable_get (s1ap_paging.ta_coll, s1ap_paging_tai_key (tai), (void **)&ta_p)) {
+    OAILOG_DEBUG (LOG_S1AP, "No eNB serving TAI " TAI_FMT "\n", TAI_ARG (tai));
+    return 0;
+  }
+  for (uint32_t i = 0; i < ta_p->nb_enbs; i++) {
+    enb_description_t                      *enb_ref = ta_p->enbs[i];
+
+    if ((S1AP_READY != enb_ref->s1_state) || (enb_ref->paging_generation == s1ap_paging.generation)) {
+      continue;
+    }
+    enb_ref->paging_generation = s1ap_paging.generation;
+    if (!s1ap_paging_enb_has_budget (enb_ref, now_sec)) {
+      s1ap_paging.nb_rate_limited++;
+      continue;
+    }
+    if (enb_ref->sctp_congested) {
+      // Paging is the first PDU to go when the association is congested, the UE may be reached via another eNB
+      s1ap_paging.nb_congested++;
+      continue;
+    }
+    // Non-UE signalling -> stream 0, SCTP frees its copy of the PDU once sent
+    bstring                                 b = bstrcpy (pdu);
+    s1ap_mme_itti_send_sctp_request (&b, enb_ref->sctp_assoc_id, 0, INVALID_MME_UE_S1AP_ID);
+    nb_sent++;
+  }
+  return nb_sent;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t s1ap_paging_send (const_bstring pdu, const tai_t * const last_visited_tai, const tai_list_t * const tai_list, const uint64_t now_ms)
+{
+  const uint32_t                          now_sec = (uint32_t) (now_ms / 1000);
+  uint32_t                                nb_sent = 0;
+
+  s1ap_paging.generation++;
+  if (last_visited_tai) {
+    nb_sent = s1ap_paging_send_ta (last_visited_tai, pdu, now_sec);
+  } else {
+    for (int i = 0; i < tai_list->n_tais; i++) {
+      nb_sent += s1ap_paging_send_ta (&tai_list->tai[i], pdu, now_sec);
+    }
+  }
+  s1ap_paging.nb_sent += nb_sent;
+  return nb_sent;
+}
+
+//------------------------------------------------------------------------------
+int s1ap_paging_init (const mme_config_t * mme_config_p)
+{
+  bstring                                 bs = NULL;
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  clock_gettime (CLOCK_MONOTONIC, &s1ap_paging.start_time);
+  bs = bfromcstr ("s1ap_paging_ta_coll");
+  s1ap_paging.ta_coll = hashtable_create (S1AP_PAGING_TA_HTBL_SIZE, NULL, s1ap_paging_free_ta, bs);
+  bdestroy (bs);
+  bs = bfromcstr ("s1ap_paging_ue_coll");
+  s1ap_paging.ue_coll = hashtable_create (S1AP_PAGING_UE_HTBL_SIZE, NULL, s1ap_paging_free_ue, bs);
+  bdestroy (bs);
+  if ((!s1ap_paging.ta_coll) || (!s1ap_paging.ue_coll)) {
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+
+  if (timer_setup (0, S1AP_PAGING_TICK_MS * 1000, TASK_S1AP, INSTANCE_DEFAULT, TIMER_PERIODIC, NULL, &s1ap_paging.timer_id) < 0) {
+    OAILOG_ERROR (LOG_S1AP, "Failed to request paging tick\n");
+    s1ap_paging.timer_id = 0;
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+  OAILOG_DEBUG (LOG_S1AP, "Paging timer %u ms, %u attempts, %u pagings per eNB per second\n",
+      mme_config_p->s1ap_config.paging_timer_ms, mme_config_p->s1ap_config.paging_max_attempts, mme_config_p->s1ap_config.max_paging_per_enb_per_sec);
+  OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+int s1ap_paging_update_enb_tais (enb_description_t * const enb_ref, const S1ap_SupportedTAs_t * const supported_tas)
+{
+  int                                     nb_tais = 0;
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  DevAssert (enb_ref != NULL);
+  DevAssert (supported_tas != NULL);
+  s1ap_paging_remove_enb (enb_ref);
+
+  for (int i = 0; i < supported_tas->list.count; i++) {
+    nb_tais += supported_tas->list.array[i]->broadcastPLMNs.list.count;
+  }
+  if (!nb_tais) {
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+  }
+  enb_ref->supported_tai = calloc (nb_tais, sizeof (tai_t));
+  DevAssert (enb_ref->supported_tai != NULL);
+
+  for (int i = 0; i < supported_tas->list.count; i++) {
+    const S1ap_SupportedTAs_Item_t         *ta = supported_tas->list.array[i];
+    tai_t                                   tai = {.plmn = {0}, .tac = INVALID_TAC_0000};
+
+    OCTET_STRING_TO_TAC (&ta->tAC, tai.tac);
+    for (int j = 0; j < ta->broadcastPLMNs.list.count; j++) {
+      TBCD_TO_PLMN_T (ta->broadcastPLMNs.list.array[j], &tai.plmn);
+      enb_ref->supported_tai[enb_ref->nb_supported_tai++] = tai;
+      s1ap_paging_ta_add_enb (&tai, enb_ref);
+    }
+  }
+  OAILOG_DEBUG (LOG_S1AP, "eNB %u serves %u TAIs\n", enb_ref->enb_id, enb_ref->nb_supported_tai);
+  OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+void s1ap_paging_remove_enb (enb_description_t * const enb_ref)
+{
+  if ((!enb_ref) || (!enb_ref->supported_tai)) {
+    return;
+  }
+  for (int i = 0; i < enb_ref->nb_supported_tai; i++) {
+    s1ap_paging_ta_remove_enb (&enb_ref->supported_tai[i], enb_ref);
+  }
+  free_wrapper ((void **)&enb_ref->supported_tai);
+  enb_ref->nb_supported_tai = 0;
+}
+
+//------------------------------------------------------------------------------
+int s1ap_handle_paging_request (const itti_s1ap_paging_request_t * const paging_request_p)
+{
+  s1ap_paging_ue_t                       *ue_p = NULL;
+  bstring                                 pdu = NULL;
+  const uint64_t                          now_ms = s1ap_paging_get_ms ();
+  hash_key_t                              key = 0;
+  bool                                    last_tai_first = false;
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  DevAssert (paging_request_p != NULL);
+  if (!paging_request_p->tai_list.n_tais) {
+    OAILOG_WARNING (LOG_S1AP, "Paging of UE " MME_UE_S1AP_ID_FMT " without TAI list\n", paging_request_p->mme_ue_s1ap_id);
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+  if (!paging_request_p->is_imsi_paging) {
+    key = s1ap_paging_ue_key (paging_request_p->mme_code, paging_request_p->m_tmsi);
+    if (HASH_TABLE_OK == hashtable_is_key_exists (s1ap_paging.ue_coll, key)) {
+      OAILOG_DEBUG (LOG_S1AP, "UE " MME_UE_S1AP_ID_FMT " already being paged\n", paging_request_p->mme_ue_s1ap_id);
+      OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+    }
+  }
+
+  if (s1ap_paging_encode (paging_request_p, &pdu) != RETURNok) {
+    OAILOG_ERROR (LOG_S1AP, "Failed to encode PAGING for UE " MME_UE_S1AP_ID_FMT "\n", paging_request_p->mme_ue_s1ap_id);
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+  s1ap_paging.nb_pagings++;
+
+  /*
+   * IMSI paging is an error recovery (TS 23.401 5.3.4.3), the UE answers with an
+   * attach that does not stop the paging here: the TAI list is paged only once.
+   */
+  if (paging_request_p->is_imsi_paging) {
+    s1ap_paging_send (pdu, NULL, &paging_request_p->tai_list, now_ms);
+    bdestroy (pdu);
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+  }
+
+  ue_p = calloc (1, sizeof (*ue_p));
+  DevAssert (ue_p != NULL);
+  ue_p->key = key;
+  ue_p->mme_ue_s1ap_id = paging_request_p->mme_ue_s1ap_id;
+  ue_p->pdu = pdu;
+  ue_p->last_visited_tai = paging_request_p->last_visited_tai;
+  ue_p->tai_list = paging_request_p->tai_list;
+  hashtable_insert (s1ap_paging.ue_coll, key, ue_p);
+
+  last_tai_first = (mme_config.s1ap_config.paging_max_attempts > 1) && TAI_IS_VALID (ue_p->last_visited_tai);
+  s1ap_paging_send (ue_p->pdu, last_tai_first ? &ue_p->last_visited_tai : NULL, &ue_p->tai_list, now_ms);
+  ue_p->nb_attempts = 1;
+  ue_p->expiry_ms = now_ms + mme_config.s1ap_config.paging_timer_ms;
+  s1ap_paging_link (ue_p);
+  OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+void s1ap_paging_stop (const uint8_t mme_code, const uint32_t m_tmsi)
+{
+  s1ap_paging_ue_t                       *ue_p = NULL;
+  const hash_key_t                        key = s1ap_paging_ue_key (mme_code, m_tmsi);
+
+  if ((!s1ap_paging.ue_coll) || (HASH_TABLE_OK != hashtable_get (s1ap_paging.ue_coll, key, (void **)&ue_p))) {
+    return;
+  }
+  OAILOG_DEBUG (LOG_S1AP, "UE " MME_UE_S1AP_ID_FMT " answered paging attempt %u\n", ue_p->mme_ue_s1ap_id, ue_p->nb_attempts);
+  s1ap_paging_unlink (ue_p);
+  hashtable_free (s1ap_paging.ue_coll, key);
+  s1ap_paging.nb_answered++;
+}
+
+//------------------------------------------------------------------------------
+bool s1ap_paging_is_tick (const long timer_id)
+{
+  return (s1ap_paging.timer_id) && (s1ap_paging.timer_id == timer_id);
+}
+
+//------------------------------------------------------------------------------
+void s1ap_paging_tick (void)
+{
+  const uint64_t                          now_ms = s1ap_paging_get_ms ();
+  s1ap_paging_ue_t                       *ue_p = NULL;
+
+  /*
+   * UEs paged again go back at the tail with a later expiry, the loop stops before them
+   */
+  while ((ue_p = s1ap_paging.head) && (ue_p->expiry_ms <= now_ms)) {
+    s1ap_paging_unlink (ue_p);
+    if (ue_p->nb_attempts >= mme_config.s1ap_config.paging_max_attempts) {
+      OAILOG_WARNING (LOG_S1AP, "UE " MME_UE_S1AP_ID_FMT " did not answer %u paging attempts\n", ue_p->mme_ue_s1ap_id, ue_p->nb_attempts);
+      s1ap_paging.nb_failed++;
+      hashtable_free (s1ap_paging.ue_coll, ue_p->key);
+    } else {
+      s1ap_paging_send (ue_p->pdu, NULL, &ue_p->tai_list, now_ms);
+      ue_p->nb_attempts++;
+      ue_p->expiry_ms = now_ms + mme_config.s1ap_config.paging_timer_ms;
+      s1ap_paging_link (ue_p);
+    }
+  }
+
+  if ((now_ms / 1000) != ((now_ms - S1AP_PAGING_TICK_MS) / 1000)) {
+    if (s1ap_paging.nb_pagings || s1ap_paging.nb_answered || s1ap_paging.nb_failed) {
+      OAILOG_DEBUG (LOG_S1AP, "Paging: %u new UEs, %u PAGING sent, %u skipped over eNB budget, %u skipped on congested eNB, %u answered, %u failed, %u UEs being paged\n",
+          s1ap_paging.nb_pagings, s1ap_paging.nb_sent, s1ap_paging.nb_rate_limited, s1ap_paging.nb_congested, s1ap_paging.nb_answered, s1ap_paging.nb_failed,
+          (uint32_t) s1ap_paging.ue_coll->num_elements);
+    }
+    s1ap_paging.nb_pagings = 0;
+    s1ap_paging.nb_sent = 0;
+    s1ap_paging.nb_rate_limited = 0;
+    s1ap_paging.nb_congested = 0;
+    s1ap_paging.nb_answered = 0;
+    s1ap_paging.nb_failed = 0;
+  }
+}
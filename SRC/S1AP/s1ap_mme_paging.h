@@ -0,0 +1,70 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_paging.h
+  \brief Network triggered paging of ECM-IDLE UEs over S1 (TS 23.401 5.3.4.3, TS 36.413 8.5)
+*/
+
+#ifndef FILE_S1AP_MME_PAGING_SEEN
+#define FILE_S1AP_MME_PAGING_SEEN
+
+#include "s1ap_mme.h"
+
+/** \brief Allocate the TAI to eNB index and the paging contexts, start the paging tick
+ * \param mme_config_p   MME configuration
+ * @returns RETURNerror or RETURNok
+ **/
+int s1ap_paging_init (const mme_config_t * mme_config_p);
+
+/** \brief Replace the TAIs of an eNB in the TAI to eNB index
+ * \param enb_ref        eNB
+ * \param supported_tas  Supported TAs of S1 SETUP REQUEST or ENB CONFIGURATION UPDATE, every TAC x broadcast PLMN
+ * @returns RETURNerror or RETURNok
+ **/
+int s1ap_paging_update_enb_tais (enb_description_t * const enb_ref, const S1ap_SupportedTAs_t * const supported_tas);
+
+/** \brief Remove an eNB from the TAI to eNB index, must be called before it is freed
+ * \param enb_ref        eNB
+ **/
+void s1ap_paging_remove_enb (enb_description_t * const enb_ref);
+
+/** \brief Encode the S1AP PAGING of a UE once and send it to the eNBs of its last visited TAI or of its TAI list
+ * \param paging_request_p  Paging requested by NAS
+ * @returns RETURNerror or RETURNok
+ **/
+int s1ap_handle_paging_request (const itti_s1ap_paging_request_t * const paging_request_p);
+
+/** \brief The UE answered: stop paging it
+ * \param mme_code       S-TMSI of the UE, as received in the INITIAL UE MESSAGE
+ * \param m_tmsi
+ **/
+void s1ap_paging_stop (const uint8_t mme_code, const uint32_t m_tmsi);
+
+/** \brief Tell if a TIMER_HAS_EXPIRED is the paging tick
+ * \param timer_id       Expired timer
+ **/
+bool s1ap_paging_is_tick (const long timer_id);
+
+/** \brief Repeat or give up the pagings whose timer expired since the previous tick
+ **/
+void s1ap_paging_tick (void);
+
+#endif /* FILE_S1AP_MME_PAGING_SEEN */
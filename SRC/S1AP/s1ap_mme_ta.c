@@ -33,31 +33,23 @@
 static
   int
 s1ap_mme_compare_plmn (
+  const mme_config_served_t * const served,
   const S1ap_PLMNidentity_t * const plmn)
 {
-  int                                     i = 0;
   uint16_t                                mcc = 0;
   uint16_t                                mnc = 0;
   uint16_t                                mnc_len = 0;
 
   DevAssert (plmn != NULL);
   TBCD_TO_MCC_MNC (plmn, mcc, mnc, mnc_len);
-  mme_config_read_lock (&mme_config);
-
-  for (i = 0; i < mme_config.served_tai.nb_tai; i++) {
-    OAILOG_TRACE (LOG_S1AP, "Comparing plmn_mcc %d/%d, plmn_mnc %d/%d plmn_mnc_len %d/%d\n",
-        mme_config.served_tai.plmn_mcc[i], mcc, mme_config.served_tai.plmn_mnc[i], mnc, mme_config.served_tai.plmn_mnc_len[i], mnc_len);
-
-    if ((mme_config.served_tai.plmn_mcc[i] == mcc) &&
-        (mme_config.served_tai.plmn_mnc[i] == mnc) &&
-        (mme_config.served_tai.plmn_mnc_len[i] == mnc_len))
-      /*
-       * There is a matching plmn
-       */
-      return TA_LIST_AT_LEAST_ONE_MATCH;
-  }
+  OAILOG_TRACE (LOG_S1AP, "Looking up plmn_mcc %d, plmn_mnc %d plmn_mnc_len %d\n", mcc, mnc, mnc_len);
 
-  mme_config_unlock (&mme_config);
+  if (mme_config_served_has_plmn (served, mcc, mnc, mnc_len)) {
+    /*
+     * There is a matching plmn
+     */
+    return TA_LIST_AT_LEAST_ONE_MATCH;
+  }
   return TA_LIST_NO_MATCH;
 }
 
@@ -66,6 +58,7 @@ s1ap_mme_compare_plmn (
 static
   int
 s1ap_mme_compare_plmns (
+  const mme_config_served_t * const served,
   S1ap_BPLMNs_t * b_plmns)
 {
   int                                     i =0;
@@ -74,14 +67,14 @@ s1ap_mme_compare_plmns (
   DevAssert (b_plmns != NULL);
 
   for (i = 0; i < b_plmns->list.count; i++) {
-    if (s1ap_mme_compare_plmn (b_plmns->list.array[i])
+    if (s1ap_mme_compare_plmn (served, b_plmns->list.array[i])
         == TA_LIST_AT_LEAST_ONE_MATCH)
       matching_occurence++;
   }
 
   if (matching_occurence == 0)
     return TA_LIST_NO_MATCH;
-  else if (matching_occurence == b_plmns->list.count - 1)
+  else if (matching_occurence == b_plmns->list.count)
     return TA_LIST_COMPLETE_MATCH;
   else
     return TA_LIST_AT_LEAST_ONE_MATCH;
@@ -92,23 +85,17 @@ s1ap_mme_compare_plmns (
 static
   int
 s1ap_mme_compare_tac (
+  const mme_config_served_t * const served,
   const S1ap_TAC_t * const tac)
 {
-  int                                     i = 0;
   uint16_t                                tac_value = 0;
 
   DevAssert (tac != NULL);
   OCTET_STRING_TO_TAC (tac, tac_value);
-  mme_config_read_lock (&mme_config);
-
-  for (i = 0; i < mme_config.served_tai.nb_tai; i++) {
-    OAILOG_TRACE (LOG_S1AP, "Comparing config tac %d, received tac = %d\n", mme_config.served_tai.tac[i], tac_value);
+  OAILOG_TRACE (LOG_S1AP, "Looking up received tac = %d\n", tac_value);
 
-    if (mme_config.served_tai.tac[i] == tac_value)
-      return TA_LIST_AT_LEAST_ONE_MATCH;
-  }
-
-  mme_config_unlock (&mme_config);
+  if (mme_config_served_has_tac (served, tac_value))
+    return TA_LIST_AT_LEAST_ONE_MATCH;
   return TA_LIST_NO_MATCH;
 }
 
@@ -125,8 +112,11 @@ s1ap_mme_compare_ta_lists (
   int                                     i;
   int                                     tac_ret,
                                           bplmn_ret;
+  int                                     rc = TA_LIST_RET_OK;
+  mme_config_served_t                    *served = NULL;
 
   DevAssert (ta_list != NULL);
+  served = mme_config_served_acquire ();
 
   /*
    * Parse every item in the list and try to find matching parameters
@@ -136,19 +126,23 @@ s1ap_mme_compare_ta_lists (
 
     ta = ta_list->list.array[i];
     DevAssert (ta != NULL);
-    tac_ret = s1ap_mme_compare_tac (&ta->tAC);
-    bplmn_ret = s1ap_mme_compare_plmns (&ta->broadcastPLMNs);
+    tac_ret = s1ap_mme_compare_tac (served, &ta->tAC);
+    bplmn_ret = s1ap_mme_compare_plmns (served, &ta->broadcastPLMNs);
 
     if (tac_ret == TA_LIST_NO_MATCH && bplmn_ret == TA_LIST_NO_MATCH) {
-      return TA_LIST_UNKNOWN_PLMN + TA_LIST_UNKNOWN_TAC;
+      rc = TA_LIST_UNKNOWN_PLMN + TA_LIST_UNKNOWN_TAC;
+      break;
     } else {
       if (tac_ret > TA_LIST_NO_MATCH && bplmn_ret == TA_LIST_NO_MATCH) {
-        return TA_LIST_UNKNOWN_PLMN;
+        rc = TA_LIST_UNKNOWN_PLMN;
+        break;
       } else if (tac_ret == TA_LIST_NO_MATCH && bplmn_ret > TA_LIST_NO_MATCH) {
-        return TA_LIST_UNKNOWN_TAC;
+        rc = TA_LIST_UNKNOWN_TAC;
+        break;
       }
     }
   }
 
-  return TA_LIST_RET_OK;
+  mme_config_served_release (served);
+  return rc;
 }
@@ -266,6 +266,7 @@ s6a_aia_cb (
        */
       MSC_LOG_TX_MESSAGE_FAILED (MSC_S6A_MME, MSC_NAS_MME, NULL, 0, "0 S6A_AUTH_INFO_ANS imsi %s", s6a_auth_info_ans_p->imsi);
       OAILOG_ERROR (LOG_S6A, "Experimental-Result and Result-Code are absent: " "This is not a correct behaviour\n");
+      S6A_METRICS_INC (S6A_METRIC_AIA_FAILURE);
       goto err;
     }
   }
@@ -281,7 +282,8 @@ s6a_aia_cb (
     }
   }
 
-  itti_send_msg_to_task (TASK_NAS_MME, INSTANCE_DEFAULT, message_p);
+  S6A_METRICS_INC (S6A_RESULT_IS_SUCCESS (s6a_auth_info_ans_p->result) ? S6A_METRIC_AIA_SUCCESS : S6A_METRIC_AIA_FAILURE);
+  itti_send_msg_to_task (s6a_pop_origin_task (s6a_auth_info_ans_p->imsi, false, TASK_NAS_MME), INSTANCE_DEFAULT, message_p);
 err:
   return RETURNok;
 }
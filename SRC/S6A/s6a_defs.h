@@ -32,6 +32,8 @@
 
 #include "mme_config.h"
 #include "queue.h"
+#include "intertask_interface.h"
+#include "metrics.h"
 
 
 #define VENDOR_3GPP (10415)
@@ -83,6 +85,8 @@ typedef struct {
   struct dict_object *dataobj_s6a_pua; /* s6a purge ue answer */
   struct dict_object *dataobj_s6a_clr; /* s6a Cancel Location req */
   struct dict_object *dataobj_s6a_cla; /* s6a Cancel Location ans */
+  struct dict_object *dataobj_s6a_idr; /* s6a Insert Subscriber Data req */
+  struct dict_object *dataobj_s6a_rsr; /* s6a Reset req */
 
   /* Some standard basic AVPs */
   struct dict_object *dataobj_s6a_destination_host;
@@ -106,16 +110,41 @@ typedef struct {
   struct dict_object *dataobj_s6a_re_synchronization_info;
   struct dict_object *dataobj_s6a_service_selection;
   struct dict_object *dataobj_s6a_ue_srvcc_cap;
+  struct dict_object *dataobj_s6a_cancellation_type;
 
   /* Handlers */
   struct disp_hdl *aia_hdl;   /* Authentication Information Answer Handle */
   struct disp_hdl *ula_hdl;   /* Update Location Answer Handle */
   struct disp_hdl *pua_hdl;   /* Purge UE Answer Handle */
   struct disp_hdl *clr_hdl;   /* Cancel Location Request Handle */
+  struct disp_hdl *idr_hdl;   /* Insert Subscriber Data Request Handle */
+  struct disp_hdl *rsr_hdl;   /* Reset Request Handle */
 } s6a_fd_cnf_t;
 
 extern s6a_fd_cnf_t s6a_fd_cnf;
 
+/* Messages exchanged with the HSS per message and result since startup, updated
+ * by the S6A task and the freeDiameter threads, read by the MME_APP statistics.
+ */
+typedef enum s6a_metric_e {
+  S6A_METRIC_AIR_SENT = 0,
+  S6A_METRIC_AIA_SUCCESS,
+  S6A_METRIC_AIA_FAILURE,
+  S6A_METRIC_ULR_SENT,
+  S6A_METRIC_ULA_SUCCESS,
+  S6A_METRIC_ULA_FAILURE,
+  S6A_METRIC_CLR_RECEIVED,
+  S6A_METRIC_IDR_RECEIVED,
+  S6A_METRIC_RSR_RECEIVED,
+  S6A_METRIC_MAX
+} s6a_metric_t;
+
+extern metric_id_t s6a_metrics[S6A_METRIC_MAX];
+
+#define S6A_METRICS_INC(mETRIC)  metrics_inc (s6a_metrics[mETRIC])
+
+#define S6A_RESULT_IS_SUCCESS(rESULT) ((S6A_RESULT_BASE == (rESULT).present) && (ER_DIAMETER_SUCCESS == (rESULT).choice.base))
+
 #define ULR_SINGLE_REGISTRATION_IND      (1U)
 #define ULR_S6A_S6D_INDICATOR            (1U << 1)
 #define ULR_SKIP_SUBSCRIBER_DATA         (1U << 2)
@@ -186,5 +215,11 @@ int s6a_parse_experimental_result(struct avp *avp, s6a_experimental_result_t *pt
 char *experimental_retcode_2_string(uint32_t ret_code);
 char *retcode_2_string(uint32_t ret_code);
 
+/* Answers are routed back to the task that sent the request (the MME_APP or
+ * NAS worker owning the UE), keyed by IMSI and request type.
+ */
+void s6a_set_origin_task(const char * const imsi, const bool is_ulr, const task_id_t task_id);
+task_id_t s6a_pop_origin_task(const char * const imsi, const bool is_ulr, const task_id_t default_task_id);
+
 
 #endif /* S6A_DEFS_H_ */
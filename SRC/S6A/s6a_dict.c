@@ -66,6 +66,8 @@ s6a_fd_init_dict_objs (
   CHECK_FD_FCT (fd_dict_search (fd_g_config->cnf_dict, DICT_COMMAND, CMD_BY_NAME, "Purge-UE-Answer", &s6a_fd_cnf.dataobj_s6a_pua, ENOENT));
   CHECK_FD_FCT (fd_dict_search (fd_g_config->cnf_dict, DICT_COMMAND, CMD_BY_NAME, "Cancel-Location-Request", &s6a_fd_cnf.dataobj_s6a_clr, ENOENT));
   CHECK_FD_FCT (fd_dict_search (fd_g_config->cnf_dict, DICT_COMMAND, CMD_BY_NAME, "Cancel-Location-Answer", &s6a_fd_cnf.dataobj_s6a_cla, ENOENT));
+  CHECK_FD_FCT (fd_dict_search (fd_g_config->cnf_dict, DICT_COMMAND, CMD_BY_NAME, "Insert-Subscriber-Data-Request", &s6a_fd_cnf.dataobj_s6a_idr, ENOENT));
+  CHECK_FD_FCT (fd_dict_search (fd_g_config->cnf_dict, DICT_COMMAND, CMD_BY_NAME, "Reset-Request", &s6a_fd_cnf.dataobj_s6a_rsr, ENOENT));
   /*
    * Pre-loading base avps
    */
@@ -91,6 +93,7 @@ s6a_fd_init_dict_objs (
   CHECK_FD_FCT (fd_dict_search (fd_g_config->cnf_dict, DICT_AVP, AVP_BY_NAME_ALL_VENDORS, "Re-Synchronization-Info", &s6a_fd_cnf.dataobj_s6a_re_synchronization_info, ENOENT));
   CHECK_FD_FCT (fd_dict_search (fd_g_config->cnf_dict, DICT_AVP, AVP_BY_NAME_ALL_VENDORS, "Service-Selection", &s6a_fd_cnf.dataobj_s6a_service_selection, ENOENT));
   CHECK_FD_FCT (fd_dict_search (fd_g_config->cnf_dict, DICT_AVP, AVP_BY_NAME_ALL_VENDORS, "UE-SRVCC-Capability", &s6a_fd_cnf.dataobj_s6a_ue_srvcc_cap, ENOENT));
+  CHECK_FD_FCT (fd_dict_search (fd_g_config->cnf_dict, DICT_AVP, AVP_BY_NAME_ALL_VENDORS, "Cancellation-Type", &s6a_fd_cnf.dataobj_s6a_cancellation_type, ENOENT));
   /*
    * Register callbacks
    */
@@ -109,6 +112,19 @@ s6a_fd_init_dict_objs (
    */
   CHECK_FD_FCT (fd_disp_register (s6a_aia_cb, DISP_HOW_CC, &when, NULL, &s6a_fd_cnf.aia_hdl));
   DevAssert (s6a_fd_cnf.aia_hdl );
+  /*
+   * Register the callbacks for the requests initiated by the HSS, they invalidate
+   * the subscription data the MME holds for the UE(s)
+   */
+  when.command = s6a_fd_cnf.dataobj_s6a_clr;
+  CHECK_FD_FCT (fd_disp_register (s6a_clr_cb, DISP_HOW_CC, &when, NULL, &s6a_fd_cnf.clr_hdl));
+  DevAssert (s6a_fd_cnf.clr_hdl );
+  when.command = s6a_fd_cnf.dataobj_s6a_idr;
+  CHECK_FD_FCT (fd_disp_register (s6a_idr_cb, DISP_HOW_CC, &when, NULL, &s6a_fd_cnf.idr_hdl));
+  DevAssert (s6a_fd_cnf.idr_hdl );
+  when.command = s6a_fd_cnf.dataobj_s6a_rsr;
+  CHECK_FD_FCT (fd_disp_register (s6a_rsr_cb, DISP_HOW_CC, &when, NULL, &s6a_fd_cnf.rsr_hdl));
+  DevAssert (s6a_fd_cnf.rsr_hdl );
   /*
    * Advertise the support for the test application in the peer
    */
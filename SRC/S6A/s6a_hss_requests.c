@@ -0,0 +1,202 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s6a_hss_requests.c
+   \brief Requests initiated by the HSS: Cancel Location, Insert Subscriber Data and Reset.
+   The MME answers them and tells the MME_APP workers that the subscription data
+   they hold is no longer valid, the next attach of the UE will update the location again.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "mme_config.h"
+#include "assertions.h"
+#include "intertask_interface.h"
+#include "s6a_defs.h"
+#include "s6a_messages.h"
+#include "msc.h"
+#include "log.h"
+
+//------------------------------------------------------------------------------
+// The UE(s) may be owned by any MME_APP worker, each worker gets its own copy.
+static void s6a_send_subscription_invalidated_ind (MessageDef * const message_p)
+{
+  for (int i = 1; i < mme_config.num_app_workers; i++) {
+    MessageDef *copy_p = itti_alloc_new_message (TASK_S6A, S6A_SUBSCRIPTION_INVALIDATED_IND);
+
+    S6A_SUBSCRIPTION_INVALIDATED_IND (copy_p) = S6A_SUBSCRIPTION_INVALIDATED_IND (message_p);
+    itti_send_msg_to_task (TASK_MME_APP + i, INSTANCE_DEFAULT, copy_p);
+  }
+  itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+static MessageDef *s6a_alloc_subscription_invalidated_ind (const s6a_invalidation_cause_t cause)
+{
+  MessageDef *message_p = itti_alloc_new_message (TASK_S6A, S6A_SUBSCRIPTION_INVALIDATED_IND);
+
+  memset (&S6A_SUBSCRIPTION_INVALIDATED_IND (message_p), 0, sizeof (s6a_subscription_invalidated_ind_t));
+  S6A_SUBSCRIPTION_INVALIDATED_IND (message_p).cause = cause;
+  return message_p;
+}
+
+//------------------------------------------------------------------------------
+static int s6a_get_user_name (
+  struct msg *qry_p,
+  s6a_subscription_invalidated_ind_t * const ind_p)
+{
+  struct avp                             *avp_p = NULL;
+  struct avp_hdr                         *hdr_p = NULL;
+
+  CHECK_FCT (fd_msg_search_avp (qry_p, s6a_fd_cnf.dataobj_s6a_user_name, &avp_p));
+
+  if (!avp_p) {
+    return RETURNerror;
+  }
+  CHECK_FCT (fd_msg_avp_hdr (avp_p, &hdr_p));
+
+  if ((0 == hdr_p->avp_value->os.len) || (IMSI_BCD_DIGITS_MAX < hdr_p->avp_value->os.len)) {
+    return RETURNerror;
+  }
+  memcpy (ind_p->imsi, hdr_p->avp_value->os.data, hdr_p->avp_value->os.len);
+  ind_p->imsi[hdr_p->avp_value->os.len] = '\0';
+  ind_p->imsi_length = hdr_p->avp_value->os.len;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+// Answer the request, the query is freed by fd_msg_send
+static int s6a_send_answer (
+  struct msg **msg_pP,
+  const char * const result_code)
+{
+  struct avp                             *avp_p = NULL;
+  union avp_value                         value;
+
+  CHECK_FCT (fd_msg_new_answer_from_req (fd_g_config->cnf_dict, msg_pP, 0));
+  CHECK_FCT (fd_msg_avp_new (s6a_fd_cnf.dataobj_s6a_auth_session_state, 0, &avp_p));
+  /*
+   * No State maintained
+   */
+  value.i32 = 1;
+  CHECK_FCT (fd_msg_avp_setvalue (avp_p, &value));
+  CHECK_FCT (fd_msg_avp_add (*msg_pP, MSG_BRW_LAST_CHILD, avp_p));
+  CHECK_FCT (fd_msg_rescode_set (*msg_pP, (char *)result_code, NULL, NULL, 1));
+  CHECK_FCT (fd_msg_send (msg_pP, NULL, NULL));
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int
+s6a_clr_cb (
+  struct msg **msg_pP,
+  struct avp *paramavp_pP,
+  struct session *sess_pP,
+  void *opaque_pP,
+  enum disp_action *act_pP)
+{
+  struct avp                             *avp_p = NULL;
+  struct avp_hdr                         *hdr_p = NULL;
+  MessageDef                             *message_p = NULL;
+  s6a_subscription_invalidated_ind_t     *ind_p = NULL;
+
+  DevAssert (msg_pP );
+  S6A_METRICS_INC (S6A_METRIC_CLR_RECEIVED);
+  message_p = s6a_alloc_subscription_invalidated_ind (S6A_INVALIDATION_CANCEL_LOCATION);
+  ind_p = &message_p->ittiMsg.s6a_subscription_invalidated_ind;
+
+  if (RETURNok != s6a_get_user_name (*msg_pP, ind_p)) {
+    OAILOG_ERROR (LOG_S6A, "Received s6a clr without a valid User-Name\n");
+    itti_free (TASK_S6A, message_p);
+    return s6a_send_answer (msg_pP, "DIAMETER_MISSING_AVP");
+  }
+  CHECK_FCT (fd_msg_search_avp (*msg_pP, s6a_fd_cnf.dataobj_s6a_cancellation_type, &avp_p));
+
+  if (avp_p) {
+    CHECK_FCT (fd_msg_avp_hdr (avp_p, &hdr_p));
+    ind_p->cancellation_type = hdr_p->avp_value->u32;
+  }
+  OAILOG_DEBUG (LOG_S6A, "Received s6a clr for imsi=%s cancellation type %u\n", ind_p->imsi, ind_p->cancellation_type);
+  MSC_LOG_TX_MESSAGE (MSC_S6A_MME, MSC_MMEAPP_MME, NULL, 0, "0 S6A_SUBSCRIPTION_INVALIDATED_IND CLR imsi %s", ind_p->imsi);
+  s6a_send_subscription_invalidated_ind (message_p);
+  return s6a_send_answer (msg_pP, "DIAMETER_SUCCESS");
+}
+
+//------------------------------------------------------------------------------
+// Only the APN configurations are applied, the rest of the subscription data is fetched by the next Update Location.
+int
+s6a_idr_cb (
+  struct msg **msg_pP,
+  struct avp *paramavp_pP,
+  struct session *sess_pP,
+  void *opaque_pP,
+  enum disp_action *act_pP)
+{
+  struct avp                             *avp_p = NULL;
+  MessageDef                             *message_p = NULL;
+  s6a_subscription_invalidated_ind_t     *ind_p = NULL;
+
+  DevAssert (msg_pP );
+  S6A_METRICS_INC (S6A_METRIC_IDR_RECEIVED);
+  message_p = s6a_alloc_subscription_invalidated_ind (S6A_INVALIDATION_INSERT_SUBSCRIBER_DATA);
+  ind_p = &message_p->ittiMsg.s6a_subscription_invalidated_ind;
+
+  if (RETURNok != s6a_get_user_name (*msg_pP, ind_p)) {
+    OAILOG_ERROR (LOG_S6A, "Received s6a idr without a valid User-Name\n");
+    itti_free (TASK_S6A, message_p);
+    return s6a_send_answer (msg_pP, "DIAMETER_MISSING_AVP");
+  }
+  CHECK_FCT (fd_msg_search_avp (*msg_pP, s6a_fd_cnf.dataobj_s6a_subscription_data, &avp_p));
+
+  if (avp_p) {
+    subscription_data_t                     subscription_data = {0};
+
+    if (RETURNok == s6a_parse_subscription_data (avp_p, &subscription_data)) {
+      ind_p->apn_config_profile = subscription_data.apn_config_profile;
+    }
+  }
+  OAILOG_DEBUG (LOG_S6A, "Received s6a idr for imsi=%s %u APN configuration(s)\n", ind_p->imsi, ind_p->apn_config_profile.nb_apns);
+  MSC_LOG_TX_MESSAGE (MSC_S6A_MME, MSC_MMEAPP_MME, NULL, 0, "0 S6A_SUBSCRIPTION_INVALIDATED_IND IDR imsi %s", ind_p->imsi);
+  s6a_send_subscription_invalidated_ind (message_p);
+  return s6a_send_answer (msg_pP, "DIAMETER_SUCCESS");
+}
+
+//------------------------------------------------------------------------------
+// The User-Id AVPs (leading IMSI digits) are ignored, the subscription data of all UEs is invalidated.
+int
+s6a_rsr_cb (
+  struct msg **msg_pP,
+  struct avp *paramavp_pP,
+  struct session *sess_pP,
+  void *opaque_pP,
+  enum disp_action *act_pP)
+{
+  MessageDef                             *message_p = NULL;
+
+  DevAssert (msg_pP );
+  S6A_METRICS_INC (S6A_METRIC_RSR_RECEIVED);
+  message_p = s6a_alloc_subscription_invalidated_ind (S6A_INVALIDATION_RESET);
+  OAILOG_DEBUG (LOG_S6A, "Received s6a rsr\n");
+  MSC_LOG_TX_MESSAGE (MSC_S6A_MME, MSC_MMEAPP_MME, NULL, 0, "0 S6A_SUBSCRIPTION_INVALIDATED_IND RSR");
+  s6a_send_subscription_invalidated_ind (message_p);
+  return s6a_send_answer (msg_pP, "DIAMETER_SUCCESS");
+}
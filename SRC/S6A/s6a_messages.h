@@ -33,6 +33,16 @@ int s6a_aia_cb(struct msg **msg, struct avp *paramavp,
                struct session *sess, void *opaque,
                enum disp_action *act);
 
+int s6a_clr_cb(struct msg **msg, struct avp *paramavp,
+               struct session *sess, void *opaque,
+               enum disp_action *act);
+int s6a_idr_cb(struct msg **msg, struct avp *paramavp,
+               struct session *sess, void *opaque,
+               enum disp_action *act);
+int s6a_rsr_cb(struct msg **msg, struct avp *paramavp,
+               struct session *sess, void *opaque,
+               enum disp_action *act);
+
 int s6a_parse_subscription_data(struct avp *avp_subscription_data,
                                 subscription_data_t *subscription_data);
 
@@ -39,6 +39,7 @@
 #include "msc.h"
 #include "log.h"
 #include "timer.h"
+#include "hashtable.h"
 
 #define S6A_PEER_CONNECT_TIMEOUT_MICRO_SEC  (0)
 #define S6A_PEER_CONNECT_TIMEOUT_SEC        (1)
@@ -48,6 +49,10 @@ static long                             timer_id = 0;
 struct session_handler                 *ts_sess_hdl;
 
 s6a_fd_cnf_t                            s6a_fd_cnf;
+metric_id_t                             s6a_metrics[S6A_METRIC_MAX] = {0};
+
+// (IMSI, request type) -> task that issued the request
+static hash_table_ts_t                 *s6a_origin_task_htbl = NULL;
 
 void                                   *s6a_thread (void *args);
 static void                             fd_gnutls_debug (
@@ -99,11 +104,15 @@ void *s6a_thread (void *args)
 
     switch (ITTI_MSG_ID (received_message_p)) {
     case S6A_UPDATE_LOCATION_REQ:{
+        s6a_set_origin_task (received_message_p->ittiMsg.s6a_update_location_req.imsi, true, ITTI_MSG_ORIGIN_ID (received_message_p));
         s6a_generate_update_location (&received_message_p->ittiMsg.s6a_update_location_req);
+        S6A_METRICS_INC (S6A_METRIC_ULR_SENT);
       }
       break;
     case S6A_AUTH_INFO_REQ:{
+        s6a_set_origin_task (received_message_p->ittiMsg.s6a_auth_info_req.imsi, false, ITTI_MSG_ORIGIN_ID (received_message_p));
         s6a_generate_authentication_info_req (&received_message_p->ittiMsg.s6a_auth_info_req);
+        S6A_METRICS_INC (S6A_METRIC_AIR_SENT);
       }
       break;
     case TIMER_HAS_EXPIRED:{
@@ -141,6 +150,63 @@ void *s6a_thread (void *args)
   return NULL;
 }
 
+//------------------------------------------------------------------------------
+static hash_key_t s6a_origin_task_key (
+  const char * const imsi,
+  const bool is_ulr)
+{
+  // an IMSI has at most 15 digits, room is left for the request type bit
+  return (hash_key_t)((strtoull (imsi, NULL, 10) << 1) | (is_ulr ? 1 : 0));
+}
+
+//------------------------------------------------------------------------------
+void s6a_set_origin_task (
+  const char * const imsi,
+  const bool is_ulr,
+  const task_id_t task_id)
+{
+  hashtable_ts_insert (s6a_origin_task_htbl, s6a_origin_task_key (imsi, is_ulr), (void *)(uintptr_t)task_id);
+}
+
+//------------------------------------------------------------------------------
+task_id_t s6a_pop_origin_task (
+  const char * const imsi,
+  const bool is_ulr,
+  const task_id_t default_task_id)
+{
+  void                                   *task_id = NULL;
+
+  if (HASH_TABLE_OK == hashtable_ts_remove (s6a_origin_task_htbl, s6a_origin_task_key (imsi, is_ulr), &task_id)) {
+    return (task_id_t)(uintptr_t)task_id;
+  }
+  OAILOG_WARNING (LOG_S6A, "No originating task found for imsi %s, answer sent to default task\n", imsi);
+  return default_task_id;
+}
+
+//------------------------------------------------------------------------------
+static void s6a_metrics_init (void)
+{
+  static const struct {
+    const char                           *message;
+    const char                           *result;
+  } s6a_metric_labels[S6A_METRIC_MAX] = {
+    [S6A_METRIC_AIR_SENT]     = {"AIR", "sent"},
+    [S6A_METRIC_AIA_SUCCESS]  = {"AIA", "success"},
+    [S6A_METRIC_AIA_FAILURE]  = {"AIA", "failure"},
+    [S6A_METRIC_ULR_SENT]     = {"ULR", "sent"},
+    [S6A_METRIC_ULA_SUCCESS]  = {"ULA", "success"},
+    [S6A_METRIC_ULA_FAILURE]  = {"ULA", "failure"},
+    [S6A_METRIC_CLR_RECEIVED] = {"CLR", "received"},
+    [S6A_METRIC_IDR_RECEIVED] = {"IDR", "received"},
+    [S6A_METRIC_RSR_RECEIVED] = {"RSR", "received"},
+  };
+
+  for (int i = 0; i < S6A_METRIC_MAX; i++) {
+    s6a_metrics[i] = metrics_register ("mme_s6a_messages_total", METRIC_COUNTER, "S6a messages exchanged with the HSS",
+        "message=\"%s\",result=\"%s\"", s6a_metric_labels[i].message, s6a_metric_labels[i].result);
+  }
+}
+
 //------------------------------------------------------------------------------
 int s6a_init (
   const mme_config_t * mme_config_p)
@@ -150,6 +216,11 @@ int s6a_init (
   OAILOG_DEBUG (LOG_S6A, "Initializing S6a interface\n");
 
   memset (&s6a_fd_cnf, 0, sizeof (s6a_fd_cnf_t));
+  s6a_metrics_init ();
+
+  bstring b = bfromcstr ("s6a_origin_task_htbl");
+  s6a_origin_task_htbl = hashtable_ts_create (mme_config_p->max_ues, NULL, hash_free_int_func, b);
+  bdestroy (b);
 
   /*
    * if (strcmp(fd_core_version(), free_wrapper_DIAMETER_MINIMUM_VERSION) ) {
@@ -262,4 +333,6 @@ static void s6a_exit(void)
   if (rv) {
     OAI_FPRINTF_ERR ("An error occurred during fd_core_wait_shutdown_complete().\n");
   }
+  hashtable_ts_destroy (s6a_origin_task_htbl);
+  s6a_origin_task_htbl = NULL;
 }
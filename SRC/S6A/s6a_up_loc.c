@@ -146,7 +146,8 @@ s6a_ula_cb (
 
 err:
   ans_p = NULL;
-  itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  S6A_METRICS_INC (S6A_RESULT_IS_SUCCESS (s6a_update_location_ans_p->result) ? S6A_METRIC_ULA_SUCCESS : S6A_METRIC_ULA_FAILURE);
+  itti_send_msg_to_task (s6a_pop_origin_task (s6a_update_location_ans_p->imsi, true, TASK_MME_APP), INSTANCE_DEFAULT, message_p);
   OAILOG_DEBUG (LOG_S6A, "Sending S6A_UPDATE_LOCATION_ANS to task MME_APP\n");
   return RETURNok;
 }
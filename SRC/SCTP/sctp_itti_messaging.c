@@ -23,6 +23,7 @@
 #include <stdbool.h>
 
 #include "intertask_interface.h"
+#include "mme_config.h"
 #include "sctp_itti_messaging.h"
 
 //------------------------------------------------------------------------------
@@ -62,7 +63,8 @@ sctp_itti_send_new_association (
   sctp_new_peer_p->assoc_id = assoc_id;
   sctp_new_peer_p->instreams = instreams;
   sctp_new_peer_p->outstreams = outstreams;
-  return itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+  // association events follow the same path as the association PDUs (codec task if any) to keep them ordered
+  return itti_send_msg_to_task (S1AP_CODEC_TASK_ID(assoc_id), INSTANCE_DEFAULT, message_p);
 }
 
 //------------------------------------------------------------------------------
@@ -81,7 +83,7 @@ int sctp_itti_send_new_message_ind(
     SCTP_DATA_IND (message_p).assoc_id   = assoc_id;
     SCTP_DATA_IND (message_p).instreams  = instreams;
     SCTP_DATA_IND (message_p).outstreams = outstreams;
-    return itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+    return itti_send_msg_to_task (S1AP_CODEC_TASK_ID(assoc_id), INSTANCE_DEFAULT, message_p);
   }
   return RETURNerror;
 }
@@ -97,5 +99,19 @@ sctp_itti_send_com_down_ind (const sctp_assoc_id_t assoc_id, bool reset)
   sctp_close_association_p = &message_p->ittiMsg.sctp_close_association;
   sctp_close_association_p->assoc_id = assoc_id;
   sctp_close_association_p->reset = reset;
+  return itti_send_msg_to_task (S1AP_CODEC_TASK_ID(assoc_id), INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+int
+sctp_itti_send_congestion_ind (const sctp_assoc_id_t assoc_id, const bool is_congested, const uint32_t queue_depth)
+{
+  MessageDef                             *message_p = NULL;
+
+  message_p = itti_alloc_new_message (TASK_SCTP, SCTP_CONGESTION_IND);
+  SCTP_CONGESTION_IND (message_p).assoc_id = assoc_id;
+  SCTP_CONGESTION_IND (message_p).is_congested = is_congested;
+  SCTP_CONGESTION_IND (message_p).queue_depth = queue_depth;
+  // the eNB state is in the S1AP task, not in the codec tasks
   return itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
 }
@@ -43,4 +43,6 @@ int sctp_itti_send_new_message_ind(
 
 int sctp_itti_send_com_down_ind(const sctp_assoc_id_t assoc_id, bool reset);
 
+int sctp_itti_send_congestion_ind(const sctp_assoc_id_t assoc_id, const bool is_congested, const uint32_t queue_depth);
+
 #endif /* FILE_SCTP_ITTI_MESSAGING_SEEN */
@@ -35,6 +35,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netinet/sctp.h>
@@ -45,10 +46,12 @@
 #include "log.h"
 #include "msc.h"
 #include "intertask_interface.h"
+#include "timer.h"
 #include "sctp_primitives_server.h"
 #include "conversions.h"
 #include "sctp_common.h"
 #include "sctp_itti_messaging.h"
+#include "sctp_send_queue.h"
 
 
 #define SCTP_RC_ERROR       -1
@@ -64,7 +67,6 @@ typedef struct sctp_association_s {
   uint16_t                                outstreams;   ///< Number of output strams negotiated for this connection
   sctp_assoc_id_t                         assoc_id;     ///< SCTP association id for the connection
   uint32_t                                messages_recv;        ///< Number of messages received on this connection
-  uint32_t                                messages_sent;        ///< Number of messages sent on this connection
 
   struct sockaddr                        *peer_addresses;       ///< A list of peer addresses
   int                                     nb_peer_addresses;
@@ -87,15 +89,14 @@ typedef struct sctp_arg_s {
 
 static sctp_descriptor_t                  sctp_desc;
 
+// Periodic display of the send queues
+static long                             sctp_statistic_timer_id = 0;
+
 // Thread used to handle sctp messages
 static pthread_t                        assoc_thread;
 
 // LOCAL FUNCTIONS prototypes
 void                                   *sctp_receiver_thread (void *args_p);
-static int sctp_send_msg (
-    sctp_assoc_id_t sctp_assoc_id,
-    uint16_t stream,
-    STOLEN_REF bstring *payload);
 
 // Association list related local functions prototypes
 static sctp_association_t              *sctp_is_assoc_in_list (sctp_assoc_id_t assoc_id);
@@ -250,48 +251,6 @@ static void sctp_dump_list (void)
 #endif
 }
 
-//------------------------------------------------------------------------------
-static int sctp_send_msg (
-    sctp_assoc_id_t sctp_assoc_id,
-    uint16_t stream,
-    STOLEN_REF bstring *payload)
-{
-  sctp_association_t              *assoc_desc = NULL;
-
-  DevAssert (*payload);
-
-  if ((assoc_desc = sctp_is_assoc_in_list (sctp_assoc_id)) == NULL) {
-    OAILOG_DEBUG (LOG_SCTP, "This assoc id has not been fount in list (%d)\n", sctp_assoc_id);
-    return -1;
-  }
-
-  if (assoc_desc->sd == -1) {
-    /*
-     * The socket is invalid may be closed.
-     */
-    OAILOG_DEBUG (LOG_SCTP, "The socket is invalid may be closed (assoc id %d)\n", sctp_assoc_id);
-    return -1;
-  }
-
-  OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Sending buffer %p of %d bytes on stream %d with ppid %d\n",
-      assoc_desc->sd, sctp_assoc_id, bdata(*payload), blength(*payload), stream, assoc_desc->ppid);
-
-  /*
-   * Send message_p on specified stream of the sd association
-   */
-  if (sctp_sendmsg (assoc_desc->sd, (const void *)bdata(*payload), (size_t) blength(*payload), NULL, 0, htonl
-      (assoc_desc->ppid), 0, stream, 0, 0) < 0) {
-    *payload = NULL;
-    OAILOG_ERROR (LOG_SCTP, "send: %s:%d\n", strerror (errno), errno);
-    return -1;
-  }
-  OAILOG_DEBUG (LOG_SCTP, "Successfully sent %d bytes on stream %d\n", blength(*payload), stream);
-  *payload = NULL;
-
-  assoc_desc->messages_sent++;
-  return 0;
-}
-
 //------------------------------------------------------------------------------
 static int sctp_create_new_listener (SctpInit * init_p)
 {
@@ -424,6 +383,10 @@ static inline int sctp_read_from_socket (int sd, uint32_t ppid)
   n = sctp_recvmsg (sd, (void *)buffer, SCTP_RECV_BUFFER_SIZE, (struct sockaddr *)&addr, &from_len, &sinfo, &flags);
 
   if (n < 0) {
+    if ((EAGAIN == errno) || (EWOULDBLOCK == errno)) {
+      // non blocking association socket, nothing left to read
+      return SCTP_RC_NORMAL_READ;
+    }
     OAILOG_DEBUG (LOG_SCTP, "An error occured during read\n");
     OAILOG_ERROR (LOG_SCTP, "sctp_recvmsg: %s:%d\n", strerror (errno), errno);
     return SCTP_RC_ERROR;
@@ -479,12 +442,20 @@ static inline int sctp_read_from_socket (int sd, uint32_t ppid)
 
 //------------------------------------------------------------------------------
 static int sctp_handle_com_down (sctp_assoc_id_t assoc_id) {
+  MessageDef                             *message_p = NULL;
+
   OAILOG_DEBUG (LOG_SCTP, "Sending close connection for assoc_id %u\n", assoc_id);
 
   if (sctp_itti_send_com_down_ind(assoc_id, false) < 0) {
     OAILOG_ERROR (LOG_SCTP, "Failed to send message to TASK_S1AP\n");
   }
 
+  // TASK_SCTP drops the send queue of the association
+  message_p = itti_alloc_new_message (TASK_SCTP, SCTP_CLOSE_ASSOCIATION);
+  SCTP_CLOSE_ASSOCIATION (message_p).assoc_id = assoc_id;
+  SCTP_CLOSE_ASSOCIATION (message_p).reset = false;
+  itti_send_msg_to_task (TASK_SCTP, INSTANCE_DEFAULT, message_p);
+
   if (sctp_remove_assoc_from_list(assoc_id) < 0) {
     OAILOG_ERROR (LOG_SCTP, "Failed to find client in list\n");
   }
@@ -564,6 +535,12 @@ void *sctp_receiver_thread (void *args_p)
             args_p = NULL;
             pthread_exit (NULL);
           } else {
+            /*
+             * TASK_SCTP must never block on the send window of an association
+             */
+            if (fcntl (clientsock, F_SETFL, fcntl (clientsock, F_GETFL, 0) | O_NONBLOCK) < 0) {
+              OAILOG_ERROR (LOG_SCTP, "[%d] fcntl O_NONBLOCK: %s:%d\n", clientsock, strerror (errno), errno);
+            }
             FD_SET (clientsock, &master);       /* add to master set */
 
             if (clientsock > fdmax) {
@@ -616,9 +593,21 @@ static void * sctp_intertask_interface (
 
   while (1) {
     MessageDef                             *received_message_p = NULL;
+    struct epoll_event                     *events = NULL;
+    int                                     nb_events = 0;
 
     itti_receive_msg (TASK_SCTP, &received_message_p);
 
+    /*
+     * Association sockets polled for EPOLLOUT: their send window takes PDUs again
+     */
+    nb_events = itti_get_events (TASK_SCTP, &events);
+    sctp_send_queue_handle_events (events, nb_events);
+
+    if (received_message_p == NULL) {
+      continue;
+    }
+
     switch (ITTI_MSG_ID (received_message_p)) {
     case SCTP_INIT_MSG:{
         OAILOG_DEBUG (LOG_SCTP, "Received SCTP_INIT_MSG\n");
@@ -636,13 +625,25 @@ static void * sctp_intertask_interface (
       }
       break;
 
+    case SCTP_NEW_ASSOCIATION:{
+        /*
+         * From the receiver thread, before S1AP knows the association
+         */
+        sctp_send_queue_add_assoc (received_message_p->ittiMsg.sctp_new_peer.assoc_id,
+            received_message_p->ittiMsg.sctp_new_peer.sd, received_message_p->ittiMsg.sctp_new_peer.ppid);
+      }
+      break;
+
     case SCTP_CLOSE_ASSOCIATION:{
+        sctp_send_queue_remove_assoc (SCTP_CLOSE_ASSOCIATION (received_message_p).assoc_id);
       }
       break;
 
     case SCTP_DATA_REQ:{
-        if (sctp_send_msg (SCTP_DATA_REQ (received_message_p).assoc_id,
+        if (sctp_send_queue_send (received_message_p->ittiMsgHeader.originTaskId,
+            SCTP_DATA_REQ (received_message_p).assoc_id,
             SCTP_DATA_REQ (received_message_p).stream,
+            SCTP_DATA_REQ (received_message_p).mme_ue_s1ap_id,
             &SCTP_DATA_REQ (received_message_p).payload) < 0) {
 
           sctp_itti_send_lower_layer_conf(received_message_p->ittiMsgHeader.originTaskId,
@@ -662,6 +663,13 @@ static void * sctp_intertask_interface (
       }
       break;
 
+    case TIMER_HAS_EXPIRED:{
+        if (received_message_p->ittiMsg.timer_has_expired.timer_id == sctp_statistic_timer_id) {
+          sctp_send_queue_display_stats ();
+        }
+      }
+      break;
+
     case MESSAGE_TEST:{
         //                 int i = 10000;
         //                 while(i--);
@@ -691,6 +699,7 @@ static void * sctp_intertask_interface (
 // Function adds a new association and sends a new association notification message.
 sctp_association_t* add_new_association(int sd, uint32_t ppid, struct sctp_assoc_change *sctp_assoc_changed) {
   sctp_association_t *new_association = NULL;
+  MessageDef         *message_p = NULL;
   if ((new_association = sctp_add_new_peer()) == NULL) {
     OAILOG_ERROR (LOG_SCTP, "Failed to allocate new sctp peer \n");
     return NULL;
@@ -704,6 +713,15 @@ sctp_association_t* add_new_association(int sd, uint32_t ppid, struct sctp_assoc
   sctp_get_localaddresses(sd, NULL, NULL);
   sctp_get_peeraddresses(sd, &new_association->peer_addresses, &new_association->nb_peer_addresses);
 
+  // TASK_SCTP creates the send queue before any S1AP PDU can be sent on the association
+  message_p = itti_alloc_new_message (TASK_SCTP, SCTP_NEW_ASSOCIATION);
+  message_p->ittiMsg.sctp_new_peer.assoc_id = new_association->assoc_id;
+  message_p->ittiMsg.sctp_new_peer.instreams = new_association->instreams;
+  message_p->ittiMsg.sctp_new_peer.outstreams = new_association->outstreams;
+  message_p->ittiMsg.sctp_new_peer.sd = sd;
+  message_p->ittiMsg.sctp_new_peer.ppid = ppid;
+  itti_send_msg_to_task (TASK_SCTP, INSTANCE_DEFAULT, message_p);
+
   if (sctp_itti_send_new_association(new_association->assoc_id,
                                      new_association->instreams,
                                      new_association->outstreams) < 0) {
@@ -757,6 +775,16 @@ int sctp_init (const mme_config_t * mme_config_p)
   sctp_desc.nb_instreams = mme_config_p->sctp_config.in_streams;
   sctp_desc.nb_outstreams = mme_config_p->sctp_config.out_streams;
 
+  if (sctp_send_queue_init (mme_config_p->sctp_config.send_queue_size, mme_config_p->max_enbs) != RETURNok) {
+    OAILOG_DEBUG (LOG_SCTP, "Initializing SCTP task interface: FAILED\n");
+    return -1;
+  }
+
+  if (timer_setup (mme_config_p->mme_statistic_timer, 0, TASK_SCTP, INSTANCE_DEFAULT, TIMER_PERIODIC, NULL, &sctp_statistic_timer_id) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "Failed to request new timer for statistics with %ds of periocidity\n", mme_config_p->mme_statistic_timer);
+    sctp_statistic_timer_id = 0;
+  }
+
   if (itti_create_task (TASK_SCTP, &sctp_intertask_interface, NULL) < 0) {
     OAILOG_ERROR (LOG_SCTP, "create task failed\n");
     OAILOG_DEBUG (LOG_SCTP, "Initializing SCTP task interface: FAILED\n");
@@ -786,4 +814,5 @@ static void sctp_exit (void)
     free_wrapper ((void**) &sctp_assoc_p);
     sctp_desc.number_of_connections--;
   }
+  sctp_send_queue_exit ();
 }
@@ -0,0 +1,418 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sctp_send_queue.c
+ *  \brief Bounded send queues of the eNB associations, owned by TASK_SCTP
+ *  @ingroup _sctp
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/sctp.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "hashtable.h"
+#include "log.h"
+#include "assertions.h"
+#include "common_defs.h"
+#include "common_types.h"
+#include "intertask_interface.h"
+#include "sctp_itti_messaging.h"
+#include "sctp_send_queue.h"
+#include "metrics.h"
+
+#define SCTP_SEND_SENT           0
+#define SCTP_SEND_WOULD_BLOCK    1
+#define SCTP_SEND_ERROR         -1
+
+typedef struct sctp_send_queue_msg_s {
+  bstring                                 payload;
+  uint64_t                                req_time_us;  ///< when TASK_SCTP got the SCTP_DATA_REQ
+  task_id_t                               origin_task_id;
+  sctp_stream_id_t                        stream;
+  uint32_t                                mme_ue_s1ap_id;
+} sctp_send_queue_msg_t;
+
+typedef struct sctp_send_queue_s {
+  sctp_assoc_id_t                         assoc_id;
+  int                                     sd;
+  uint32_t                                ppid;
+  bool                                    is_polled;    ///< EPOLLOUT subscribed, while the queue is not empty
+  uint32_t                                head;
+  sctp_send_queue_stats_t                 stats;
+  sctp_send_queue_msg_t                   msgs[];       ///< ring of queue_size PDUs
+} sctp_send_queue_t;
+
+static struct {
+  uint32_t                                queue_size;
+  hash_table_t                           *assoc_htbl;   ///< sctp_send_queue_t, key is assoc_id
+  hash_table_t                           *sd_htbl;      ///< same sctp_send_queue_t, key is sd, for the epoll events
+  metric_id_t                             metric_sent;
+  metric_id_t                             metric_queued;     ///< could not be sent at once
+  metric_id_t                             metric_dropped;
+  metric_id_t                             metric_depth;      ///< PDUs waiting in all the queues
+  metric_id_t                             metric_congested;  ///< congested associations
+  metric_id_t                             metric_latency_sum;    ///< send latency of the PDUs sent, in us
+  metric_id_t                             metric_latency_count;  ///< PDUs sent, latency accounted
+  int                                    *ready_fds;         ///< sockets of the epoll events being handled
+  int                                     ready_fds_size;
+} sctp_send_queues = {0};
+
+//------------------------------------------------------------------------------
+static uint64_t sctp_send_queue_now_us (void)
+{
+  struct timespec                         ts = {0};
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000 + (uint64_t) ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+static void sctp_send_queue_free (void **queue_pp)
+{
+  sctp_send_queue_t                      *queue = (sctp_send_queue_t *) *queue_pp;
+
+  for (uint32_t i = 0; i < queue->stats.queue_depth; i++) {
+    bdestroy (queue->msgs[(queue->head + i) % sctp_send_queues.queue_size].payload);
+  }
+  free_wrapper (queue_pp);
+}
+
+//------------------------------------------------------------------------------
+static int sctp_send_queue_sendmsg (sctp_send_queue_t * const queue, const_bstring payload, const sctp_stream_id_t stream)
+{
+  if (sctp_sendmsg (queue->sd, (const void *)bdata (payload), (size_t) blength (payload), NULL, 0, htonl (queue->ppid), 0, stream, 0, 0) < 0) {
+    if ((EAGAIN == errno) || (EWOULDBLOCK == errno)) {
+      return SCTP_SEND_WOULD_BLOCK;
+    }
+    OAILOG_ERROR (LOG_SCTP, "[%d][%d] send: %s:%d\n", queue->sd, queue->assoc_id, strerror (errno), errno);
+    return SCTP_SEND_ERROR;
+  }
+  OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Successfully sent %d bytes on stream %d\n", queue->sd, queue->assoc_id, blength (payload), stream);
+  return SCTP_SEND_SENT;
+}
+
+//------------------------------------------------------------------------------
+static void sctp_send_queue_account_sent (sctp_send_queue_t * const queue, const uint64_t req_time_us)
+{
+  const uint64_t                          latency_us = sctp_send_queue_now_us () - req_time_us;
+
+  queue->stats.nb_sent++;
+  metrics_inc (sctp_send_queues.metric_sent);
+  metrics_add (sctp_send_queues.metric_latency_sum, (int64_t) latency_us);
+  metrics_inc (sctp_send_queues.metric_latency_count);
+  queue->stats.send_latency_sum_us += latency_us;
+  if (latency_us > queue->stats.send_latency_max_us) {
+    queue->stats.send_latency_max_us = latency_us;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Tell S1AP when the queue crosses a watermark, the band between both avoids a flood of indications
+static void sctp_send_queue_update_congestion (sctp_send_queue_t * const queue)
+{
+  if ((!queue->stats.is_congested) && (queue->stats.queue_depth >= SCTP_SEND_QUEUE_HIGH_WATERMARK (sctp_send_queues.queue_size))) {
+    queue->stats.is_congested = true;
+    metrics_inc (sctp_send_queues.metric_congested);
+    OAILOG_WARNING (LOG_SCTP, "[%d][%d] Send queue congested, %u PDUs waiting\n", queue->sd, queue->assoc_id, queue->stats.queue_depth);
+    sctp_itti_send_congestion_ind (queue->assoc_id, true, queue->stats.queue_depth);
+  } else if ((queue->stats.is_congested) && (queue->stats.queue_depth <= SCTP_SEND_QUEUE_LOW_WATERMARK (sctp_send_queues.queue_size))) {
+    queue->stats.is_congested = false;
+    metrics_dec (sctp_send_queues.metric_congested);
+    OAILOG_NOTICE (LOG_SCTP, "[%d][%d] Send queue no longer congested, %u PDUs waiting\n", queue->sd, queue->assoc_id, queue->stats.queue_depth);
+    sctp_itti_send_congestion_ind (queue->assoc_id, false, queue->stats.queue_depth);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Sends the queued PDUs until the send window is full again
+static void sctp_send_queue_flush (sctp_send_queue_t * const queue)
+{
+  while (queue->stats.queue_depth > 0) {
+    sctp_send_queue_msg_t                *msg = &queue->msgs[queue->head];
+    const int                             rc = sctp_send_queue_sendmsg (queue, msg->payload, msg->stream);
+
+    if (SCTP_SEND_WOULD_BLOCK == rc) {
+      break;
+    }
+    if (SCTP_SEND_SENT == rc) {
+      sctp_send_queue_account_sent (queue, msg->req_time_us);
+      queue->stats.nb_queued++;
+    } else {
+      queue->stats.nb_dropped++;
+      metrics_inc (sctp_send_queues.metric_dropped);
+      sctp_itti_send_lower_layer_conf (msg->origin_task_id, queue->assoc_id, msg->stream, msg->mme_ue_s1ap_id, false);
+    }
+    bdestroy (msg->payload);
+    msg->payload = NULL;
+    queue->head = (queue->head + 1) % sctp_send_queues.queue_size;
+    queue->stats.queue_depth--;
+    metrics_dec (sctp_send_queues.metric_depth);
+  }
+
+  if ((0 == queue->stats.queue_depth) && (queue->is_polled)) {
+    itti_unsubscribe_event_fd (TASK_SCTP, queue->sd);
+    queue->is_polled = false;
+  }
+  sctp_send_queue_update_congestion (queue);
+}
+
+//------------------------------------------------------------------------------
+int sctp_send_queue_init (const uint32_t queue_size, const uint32_t nb_assocs)
+{
+  bstring                                 b = NULL;
+
+  DevAssert (queue_size > 0);
+  sctp_send_queues.queue_size = queue_size;
+  b = bfromcstr ("sctp_send_queue_assoc_htbl");
+  sctp_send_queues.assoc_htbl = hashtable_create (nb_assocs, HASH_TABLE_DEFAULT_HASH_FUNC, sctp_send_queue_free, b);
+  btrunc (b, 0);
+  bcatcstr (b, "sctp_send_queue_sd_htbl");
+  sctp_send_queues.sd_htbl = hashtable_create (nb_assocs, HASH_TABLE_DEFAULT_HASH_FUNC, hash_free_int_func, b);
+  bdestroy (b);
+  if ((!sctp_send_queues.assoc_htbl) || (!sctp_send_queues.sd_htbl)) {
+    OAILOG_ERROR (LOG_SCTP, "Failed to create the SCTP send queues\n");
+    return RETURNerror;
+  }
+  sctp_send_queues.metric_sent = metrics_register ("mme_sctp_pdus_total", METRIC_COUNTER, "S1AP PDUs handed to SCTP", "result=\"sent\"");
+  sctp_send_queues.metric_queued = metrics_register ("mme_sctp_pdus_queued_total", METRIC_COUNTER, "S1AP PDUs queued, the send window being full", NULL);
+  sctp_send_queues.metric_dropped = metrics_register ("mme_sctp_pdus_total", METRIC_COUNTER, "S1AP PDUs handed to SCTP", "result=\"dropped\"");
+  sctp_send_queues.metric_depth = metrics_register ("mme_sctp_queued_pdus", METRIC_GAUGE, "S1AP PDUs waiting in the SCTP send queues", NULL);
+  sctp_send_queues.metric_congested = metrics_register ("mme_sctp_congested_associations", METRIC_GAUGE, "SCTP associations above the high watermark", NULL);
+  // over all the associations, a series per association would not scale with the eNBs: per association, see the periodic display
+  sctp_send_queues.metric_latency_sum = metrics_register ("mme_sctp_send_latency_microseconds_sum", METRIC_COUNTER,
+      "Time from SCTP_DATA_REQ to sctp_sendmsg() of the S1AP PDUs sent", NULL);
+  sctp_send_queues.metric_latency_count = metrics_register ("mme_sctp_send_latency_microseconds_count", METRIC_COUNTER,
+      "S1AP PDUs sent, with their send latency accounted", NULL);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void sctp_send_queue_exit (void)
+{
+  free_wrapper ((void **)&sctp_send_queues.ready_fds);
+  sctp_send_queues.ready_fds_size = 0;
+  if (sctp_send_queues.sd_htbl) {
+    hashtable_destroy (sctp_send_queues.sd_htbl);
+    sctp_send_queues.sd_htbl = NULL;
+  }
+  if (sctp_send_queues.assoc_htbl) {
+    hashtable_destroy (sctp_send_queues.assoc_htbl);
+    sctp_send_queues.assoc_htbl = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+int sctp_send_queue_add_assoc (const sctp_assoc_id_t assoc_id, const int sd, const uint32_t ppid)
+{
+  sctp_send_queue_t                      *queue = NULL;
+
+  if (HASH_TABLE_OK == hashtable_get (sctp_send_queues.assoc_htbl, (hash_key_t) assoc_id, (void **)&queue)) {
+    OAILOG_WARNING (LOG_SCTP, "[%d][%d] Send queue already exists\n", sd, assoc_id);
+    return RETURNerror;
+  }
+  queue = calloc (1, sizeof (sctp_send_queue_t) + sctp_send_queues.queue_size * sizeof (sctp_send_queue_msg_t));
+  if (!queue) {
+    OAILOG_ERROR (LOG_SCTP, "[%d][%d] Failed to allocate the send queue\n", sd, assoc_id);
+    return RETURNerror;
+  }
+  queue->assoc_id = assoc_id;
+  queue->sd = sd;
+  queue->ppid = ppid;
+  hashtable_insert (sctp_send_queues.assoc_htbl, (hash_key_t) assoc_id, queue);
+  hashtable_insert (sctp_send_queues.sd_htbl, (hash_key_t) sd, queue);
+  OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Send queue of %u PDUs created\n", sd, assoc_id, sctp_send_queues.queue_size);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void sctp_send_queue_remove_assoc (const sctp_assoc_id_t assoc_id)
+{
+  sctp_send_queue_t                      *queue = NULL;
+
+  if (HASH_TABLE_OK != hashtable_get (sctp_send_queues.assoc_htbl, (hash_key_t) assoc_id, (void **)&queue)) {
+    return;
+  }
+  if (queue->is_polled) {
+    itti_unsubscribe_event_fd (TASK_SCTP, queue->sd);
+  }
+  if (queue->stats.queue_depth) {
+    OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Association down, %u PDUs not sent\n", queue->sd, assoc_id, queue->stats.queue_depth);
+    metrics_add (sctp_send_queues.metric_dropped, queue->stats.queue_depth);
+    metrics_add (sctp_send_queues.metric_depth, -(int64_t) queue->stats.queue_depth);
+  }
+  if (queue->stats.is_congested) {
+    metrics_dec (sctp_send_queues.metric_congested);
+  }
+  hashtable_free (sctp_send_queues.sd_htbl, (hash_key_t) queue->sd);
+  hashtable_free (sctp_send_queues.assoc_htbl, (hash_key_t) assoc_id);
+}
+
+//------------------------------------------------------------------------------
+int sctp_send_queue_send (
+    const task_id_t origin_task_id,
+    const sctp_assoc_id_t assoc_id,
+    const sctp_stream_id_t stream,
+    const uint32_t mme_ue_s1ap_id,
+    STOLEN_REF bstring *payload)
+{
+  sctp_send_queue_t                      *queue = NULL;
+  const uint64_t                          req_time_us = sctp_send_queue_now_us ();
+  sctp_send_queue_msg_t                  *msg = NULL;
+
+  DevAssert (*payload);
+
+  if (HASH_TABLE_OK != hashtable_get (sctp_send_queues.assoc_htbl, (hash_key_t) assoc_id, (void **)&queue)) {
+    OAILOG_DEBUG (LOG_SCTP, "This assoc id has not been fount in list (%d)\n", assoc_id);
+    bdestroy (*payload);
+    *payload = NULL;
+    return RETURNerror;
+  }
+
+  OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Sending buffer %p of %d bytes on stream %d with ppid %d\n",
+      queue->sd, assoc_id, bdata (*payload), blength (*payload), stream, queue->ppid);
+
+  /*
+   * Nothing queued before it: send it now if the send window takes it
+   */
+  if (0 == queue->stats.queue_depth) {
+    const int                             rc = sctp_send_queue_sendmsg (queue, *payload, stream);
+
+    if (SCTP_SEND_WOULD_BLOCK != rc) {
+      bdestroy (*payload);
+      *payload = NULL;
+      if (SCTP_SEND_ERROR == rc) {
+        queue->stats.nb_dropped++;
+        metrics_inc (sctp_send_queues.metric_dropped);
+        return RETURNerror;
+      }
+      sctp_send_queue_account_sent (queue, req_time_us);
+      return RETURNok;
+    }
+  }
+
+  /*
+   * Queue it, the non UE-associated PDUs (paging, configuration transfers...) only while the association is not congested
+   */
+  if ((queue->stats.queue_depth == sctp_send_queues.queue_size) ||
+      ((INVALID_MME_UE_S1AP_ID == mme_ue_s1ap_id) && (queue->stats.queue_depth >= SCTP_SEND_QUEUE_HIGH_WATERMARK (sctp_send_queues.queue_size)))) {
+    OAILOG_WARNING (LOG_SCTP, "[%d][%d] Send queue full (%u PDUs), PDU dropped for ue_id " MME_UE_S1AP_ID_FMT "\n",
+        queue->sd, assoc_id, queue->stats.queue_depth, mme_ue_s1ap_id);
+    queue->stats.nb_dropped++;
+    metrics_inc (sctp_send_queues.metric_dropped);
+    bdestroy (*payload);
+    *payload = NULL;
+    return RETURNerror;
+  }
+  msg = &queue->msgs[(queue->head + queue->stats.queue_depth) % sctp_send_queues.queue_size];
+  msg->payload = *payload;
+  *payload = NULL;
+  msg->req_time_us = req_time_us;
+  msg->origin_task_id = origin_task_id;
+  msg->stream = stream;
+  msg->mme_ue_s1ap_id = mme_ue_s1ap_id;
+  queue->stats.queue_depth++;
+  metrics_inc (sctp_send_queues.metric_queued);
+  metrics_inc (sctp_send_queues.metric_depth);
+  if (queue->stats.queue_depth > queue->stats.max_queue_depth) {
+    queue->stats.max_queue_depth = queue->stats.queue_depth;
+  }
+  if (!queue->is_polled) {
+    itti_subscribe_event_fd_events (TASK_SCTP, queue->sd, EPOLLOUT | EPOLLERR);
+    queue->is_polled = true;
+  }
+  sctp_send_queue_update_congestion (queue);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void sctp_send_queue_handle_events (const struct epoll_event * const events, const int nb_events)
+{
+  int                                     nb_ready = 0;
+
+  if ((!events) || (nb_events <= 0)) {
+    return;
+  }
+  // a flush emptying a queue unsubscribes its socket, which reallocates the events array of ITTI:
+  // copy the sockets to flush before the first one
+  if (nb_events > sctp_send_queues.ready_fds_size) {
+    int                                  *ready_fds = realloc (sctp_send_queues.ready_fds, nb_events * sizeof (int));
+
+    AssertFatal (ready_fds, "Failed to allocate %d SCTP ready sockets\n", nb_events);
+    sctp_send_queues.ready_fds = ready_fds;
+    sctp_send_queues.ready_fds_size = nb_events;
+  }
+  for (int i = 0; i < nb_events; i++) {
+    if (events[i].events & (EPOLLOUT | EPOLLERR)) {
+      sctp_send_queues.ready_fds[nb_ready++] = events[i].data.fd;
+    }
+  }
+
+  for (int i = 0; i < nb_ready; i++) {
+    sctp_send_queue_t                    *queue = NULL;
+
+    if (HASH_TABLE_OK == hashtable_get (sctp_send_queues.sd_htbl, (hash_key_t) sctp_send_queues.ready_fds[i], (void **)&queue)) {
+      // on EPOLLERR the sends fail and the queued PDUs are dropped
+      sctp_send_queue_flush (queue);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static bool sctp_send_queue_display_stats_cb (hash_key_t key, void *element, void *parameter, void **result)
+{
+  sctp_send_queue_t                      *queue = (sctp_send_queue_t *) element;
+  sctp_send_queue_stats_t                *stats = &queue->stats;
+
+  OAILOG_DEBUG (LOG_SCTP, "Assoc %6d    | %6u %6u | %10" PRIu64 " %10" PRIu64 " %8" PRIu64 " | %8" PRIu64 " %8" PRIu64 " | %s\n",
+      queue->assoc_id, stats->queue_depth, stats->max_queue_depth, stats->nb_sent, stats->nb_queued, stats->nb_dropped,
+      (stats->nb_sent) ? stats->send_latency_sum_us / stats->nb_sent : 0, stats->send_latency_max_us,
+      (stats->is_congested) ? "congested" : "");
+  // the maximum and the counters are since the last display
+  stats->max_queue_depth = stats->queue_depth;
+  stats->nb_sent = 0;
+  stats->nb_queued = 0;
+  stats->nb_dropped = 0;
+  stats->send_latency_sum_us = 0;
+  stats->send_latency_max_us = 0;
+  return false;
+}
+
+//------------------------------------------------------------------------------
+void sctp_send_queue_display_stats (void)
+{
+  if ((!sctp_send_queues.assoc_htbl) || (0 == sctp_send_queues.assoc_htbl->num_elements)) {
+    return;
+  }
+  OAILOG_DEBUG (LOG_SCTP, "================================ SCTP SEND QUEUES ================================\n");
+  OAILOG_DEBUG (LOG_SCTP, "               |  depth    max |       sent     queued  dropped | avg(us)  max(us)  |\n");
+  hashtable_apply_callback_on_elements (sctp_send_queues.assoc_htbl, sctp_send_queue_display_stats_cb, NULL, NULL);
+}
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sctp_send_queue.h
+ *  \brief Bounded send queues of the eNB associations, owned by TASK_SCTP
+ *  @ingroup _sctp
+ *  @{
+ */
+
+#ifndef FILE_SCTP_SEND_QUEUE_SEEN
+#define FILE_SCTP_SEND_QUEUE_SEEN
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bstrlib.h"
+#include "common_defs.h"
+#include "intertask_interface.h"
+
+/*
+ * The association sockets are non blocking: a PDU the send window of its association cannot take
+ * is queued and the socket is polled for EPOLLOUT by TASK_SCTP until the queue is empty, so a slow
+ * eNB no longer stalls the downlink of the other ones.
+ * Past the high watermark the association is congested: S1AP is told (SCTP_CONGESTION_IND) and the
+ * non UE-associated PDUs are dropped. It is no longer congested under the low watermark.
+ */
+#define SCTP_SEND_QUEUE_HIGH_WATERMARK(sIZE)   (((sIZE) * 3) / 4)
+#define SCTP_SEND_QUEUE_LOW_WATERMARK(sIZE)    ((sIZE) / 4)
+
+typedef struct sctp_send_queue_stats_s {
+  uint32_t    queue_depth;           ///< PDUs in the queue
+  uint32_t    max_queue_depth;       ///< since the last display
+  uint64_t    nb_sent;               ///< since the last display
+  uint64_t    nb_queued;             ///< sent after waiting in the queue, since the last display
+  uint64_t    nb_dropped;            ///< queue full or send error, since the last display
+  uint64_t    send_latency_sum_us;   ///< from SCTP_DATA_REQ to sctp_sendmsg(), since the last display
+  uint64_t    send_latency_max_us;   ///< since the last display
+  bool        is_congested;
+} sctp_send_queue_stats_t;
+
+/** \brief Create the collection of send queues
+ \param queue_size Maximum number of PDUs queued per association
+ \param nb_assocs Initial size of the collection
+ @returns RETURNok or RETURNerror
+ **/
+int sctp_send_queue_init (const uint32_t queue_size, const uint32_t nb_assocs);
+
+void sctp_send_queue_exit (void);
+
+/** \brief Create the send queue of a new association
+ \param assoc_id SCTP association id
+ \param sd Socket of the association, set non blocking
+ \param ppid Payload protocol identifier of the association
+ @returns RETURNok or RETURNerror
+ **/
+int sctp_send_queue_add_assoc (const sctp_assoc_id_t assoc_id, const int sd, const uint32_t ppid);
+
+/** \brief Drop the send queue of an association and the PDUs it still holds
+ \param assoc_id SCTP association id
+ **/
+void sctp_send_queue_remove_assoc (const sctp_assoc_id_t assoc_id);
+
+/** \brief Send a PDU now, or queue it if the send window of the association is full
+ \param origin_task_id Task to report a PDU dropped later to (SCTP_DATA_CNF)
+ \param assoc_id SCTP association id
+ \param stream SCTP stream
+ \param mme_ue_s1ap_id UE of the PDU, INVALID_MME_UE_S1AP_ID if the PDU is not UE-associated
+ \param payload PDU, stolen
+ @returns RETURNok if the PDU was sent or queued, RETURNerror if it was dropped
+ **/
+int sctp_send_queue_send (
+    const task_id_t origin_task_id,
+    const sctp_assoc_id_t assoc_id,
+    const sctp_stream_id_t stream,
+    const uint32_t mme_ue_s1ap_id,
+    STOLEN_REF bstring *payload);
+
+/** \brief Flush the queues of the sockets TASK_SCTP got EPOLLOUT for
+ \param events Events returned by itti_get_events()
+ \param nb_events Number of events
+ **/
+void sctp_send_queue_handle_events (const struct epoll_event * const events, const int nb_events);
+
+/** \brief Log the statistics of every send queue and reset the ones since the last display
+ **/
+void sctp_send_queue_display_stats (void);
+
+#endif /* FILE_SCTP_SEND_QUEUE_SEEN */
+
+/* @} */
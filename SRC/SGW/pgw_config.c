@@ -92,7 +92,6 @@ void pgw_config_init (pgw_config_t * config_pP)
 {
   memset ((char *)config_pP, 0, sizeof (*config_pP));
   pthread_rwlock_init (&config_pP->rw_lock, NULL);
-  STAILQ_INIT (&config_pP->ipv4_pool_list);
 }
 
 //------------------------------------------------------------------------------
@@ -100,8 +99,6 @@ int pgw_config_process (pgw_config_t * config_pP)
 {
   bstring                                 system_cmd = NULL;
   struct in_addr                          addr_start, addr_mask;
-  uint64_t                                counter64 = 0;
-  conf_ipv4_list_elm_t                   *ip4_ref = NULL;
 
   system_cmd = bformat ("iptables -t mangle -F FORWARD");
   pgw_system (system_cmd, PGW_ABORT_ON_ERROR, __FILE__, __LINE__);
@@ -179,16 +176,13 @@ int pgw_config_process (pgw_config_t * config_pP)
           inet_ntoa(config_pP->ue_pool_addr[i]), config_pP->ue_pool_mask[i], addr_start.s_addr, addr_mask.s_addr);
     }
 
-    counter64 = 0x00000000FFFFFFFF >> config_pP->ue_pool_mask[i];  // address Prefix_mask/0..0 not valid
-    counter64 = counter64 - 2;
+    for (int j = 0; j < i; j++) {
+      uint8_t  mask = (config_pP->ue_pool_mask[i] < config_pP->ue_pool_mask[j]) ? config_pP->ue_pool_mask[i]:config_pP->ue_pool_mask[j];
+      uint32_t net_mask = htonl (0xFFFFFFFF << (32 - mask));
 
-    do {
-      addr_start.s_addr = addr_start.s_addr + htonl (2);
-      ip4_ref = calloc (1, sizeof (conf_ipv4_list_elm_t));
-      ip4_ref->addr = addr_start;
-      STAILQ_INSERT_TAIL (&config_pP->ipv4_pool_list, ip4_ref, ipv4_entries);
-      counter64 = counter64 - 1;
-    } while (counter64 > 0);
+      AssertFatal ((config_pP->ue_pool_addr[i].s_addr & net_mask) != (config_pP->ue_pool_addr[j].s_addr & net_mask),
+          "UE IPv4 pools %d and %d overlap\n", i, j);
+    }
 
     //---------------
     if (config_pP->masquerade_SGI) {
@@ -219,6 +213,48 @@ int pgw_config_process (pgw_config_t * config_pP)
   return 0;
 }
 
+//------------------------------------------------------------------------------
+static void pgw_config_parse_ipv4_list (pgw_config_t * config_pP, config_setting_t * ipv4_list_setting_pP, const char * const apn_pP)
+{
+  const char                             *astring = NULL;
+  bstring                                 address = NULL;
+  bstring                                 cidr = NULL;
+  bstring                                 mask = NULL;
+  unsigned char                           buf_in_addr[sizeof (struct in_addr)];
+  int                                     prefix_mask = 0;
+  int                                     num = config_setting_length (ipv4_list_setting_pP);
+
+  for (int i = 0; i < num; i++) {
+    astring = config_setting_get_string_elem (ipv4_list_setting_pP, i);
+
+    if (astring) {
+      cidr = bfromcstr (astring);
+      AssertFatal(BSTR_OK == btrimws(cidr), "Error in PGW_CONFIG_STRING_IPV4_ADDRESS_LIST %s", astring);
+      struct bstrList *list = bsplit (cidr, PGW_CONFIG_STRING_IPV4_PREFIX_DELIMITER);
+      AssertFatal(2 == list->qty, "Bad CIDR address %s", bdata(cidr));
+
+      address = list->entry[0];
+      mask    = list->entry[1];
+
+      if (inet_pton (AF_INET, bdata(address), buf_in_addr) == 1) {
+        // valid address
+        prefix_mask = atoi ((const char *)mask->data);
+
+        if ((prefix_mask >= 2) && (prefix_mask < 31) && (config_pP->num_ue_pool < PGW_NUM_UE_POOL_MAX)) {
+          memcpy (&config_pP->ue_pool_addr[config_pP->num_ue_pool], buf_in_addr, sizeof (struct in_addr));
+          config_pP->ue_pool_mask[config_pP->num_ue_pool] = prefix_mask;
+          config_pP->ue_pool_apn[config_pP->num_ue_pool] = (apn_pP) ? bfromcstr (apn_pP) : NULL;
+          config_pP->num_ue_pool += 1;
+        } else {
+          OAILOG_ERROR (LOG_SPGW_APP, "CONFIG POOL ADDR IPV4: BAD MASQ: %d\n", prefix_mask);
+        }
+      }
+      bstrListDestroy(list);
+      bdestroy(cidr);
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 int pgw_config_parse_file (pgw_config_t * config_pP)
 {
@@ -233,16 +269,10 @@ int pgw_config_parse_file (pgw_config_t * config_pP)
   char                                   *default_dns = NULL;
   char                                   *default_dns_sec = NULL;
   const char                             *astring = NULL;
-  bstring                                 address = NULL;
-  bstring                                 cidr = NULL;
-  bstring                                 mask = NULL;
   int                                     num = 0;
   int                                     i = 0;
-  unsigned char                           buf_in_addr[sizeof (struct in_addr)];
-  struct in_addr                          addr_start;
   bstring                                 system_cmd = NULL;
   libconfig_int                           mtu = 0;
-  int                                     prefix_mask = 0;
 
 
   config_init (&cfg);
@@ -309,39 +339,30 @@ int pgw_config_parse_file (pgw_config_t * config_pP)
     if (subsetting) {
       sub2setting = config_setting_get_member (subsetting, PGW_CONFIG_STRING_IPV4_ADDRESS_LIST);
 
+      if (sub2setting) {
+        pgw_config_parse_ipv4_list (config_pP, sub2setting, NULL);
+      } else {
+        OAILOG_WARNING (LOG_SPGW_APP, "CONFIG POOL ADDR IPV4: NO IPV4 ADDRESS FOUND\n");
+      }
+
+      // Pools dedicated to an APN (IMS, internet, M2M, ...)
+      sub2setting = config_setting_get_member (subsetting, PGW_CONFIG_STRING_APN_IPV4_ADDRESS_LIST);
+
       if (sub2setting) {
         num = config_setting_length (sub2setting);
 
         for (i = 0; i < num; i++) {
-          astring = config_setting_get_string_elem (sub2setting, i);
-
-          if (astring) {
-            cidr = bfromcstr (astring);
-            AssertFatal(BSTR_OK == btrimws(cidr), "Error in PGW_CONFIG_STRING_IPV4_ADDRESS_LIST %s", astring);
-            struct bstrList *list = bsplit (cidr, PGW_CONFIG_STRING_IPV4_PREFIX_DELIMITER);
-            AssertFatal(2 == list->qty, "Bad CIDR address %s", bdata(cidr));
-
-            address = list->entry[0];
-            mask    = list->entry[1];
-
-            if (inet_pton (AF_INET, bdata(address), buf_in_addr) == 1) {
-              memcpy (&addr_start, buf_in_addr, sizeof (struct in_addr));
-              // valid address
-              prefix_mask = atoi ((const char *)mask->data);
-
-              if ((prefix_mask >= 2) && (prefix_mask < 32) && (config_pP->num_ue_pool < PGW_NUM_UE_POOL_MAX)) {
-                memcpy (&config_pP->ue_pool_addr[config_pP->num_ue_pool], buf_in_addr, sizeof (struct in_addr));
-                config_pP->ue_pool_mask[config_pP->num_ue_pool] = prefix_mask;
-                config_pP->num_ue_pool += 1;
-              } else {
-                OAILOG_ERROR (LOG_SPGW_APP, "CONFIG POOL ADDR IPV4: BAD MASQ: %d\n", prefix_mask);
-              }
-            }
-            bstrListDestroy(list);
+          config_setting_t *apn_pool_setting = config_setting_get_elem (sub2setting, i);
+          config_setting_t *apn_ipv4_list    = NULL;
+
+          if ((apn_pool_setting)
+              && (config_setting_lookup_string (apn_pool_setting, PGW_CONFIG_STRING_APN, &astring))
+              && (apn_ipv4_list = config_setting_get_member (apn_pool_setting, PGW_CONFIG_STRING_IPV4_ADDRESS_LIST))) {
+            pgw_config_parse_ipv4_list (config_pP, apn_ipv4_list, astring);
+          } else {
+            OAILOG_ERROR (LOG_SPGW_APP, "CONFIG POOL ADDR IPV4: BAD APN POOL ENTRY %d\n", i);
           }
         }
-      } else {
-        OAILOG_WARNING (LOG_SPGW_APP, "CONFIG POOL ADDR IPV4: NO IPV4 ADDRESS FOUND\n");
       }
 
       if (config_setting_lookup_string (setting_pgw, PGW_CONFIG_STRING_DEFAULT_DNS_IPV4_ADDRESS, (const char **)&default_dns)
@@ -396,4 +417,9 @@ void pgw_config_display (pgw_config_t * config_p)
   OAILOG_INFO (LOG_SPGW_APP, "- MSS clamping: ..........: %d\n", config_p->ue_tcp_mss_clamp);
   OAILOG_INFO (LOG_SPGW_APP, "- Masquerading: ..........: %d\n", config_p->masquerade_SGI);
   OAILOG_INFO (LOG_SPGW_APP, "- Push PCO: ..............: %d\n", config_p->force_push_pco);
+  OAILOG_INFO (LOG_SPGW_APP, "- UE IPv4 pools:\n");
+  for (int i = 0; i < config_p->num_ue_pool; i++) {
+    OAILOG_INFO (LOG_SPGW_APP, "    %s/%u APN %s\n", inet_ntoa (config_p->ue_pool_addr[i]), config_p->ue_pool_mask[i],
+        (config_p->ue_pool_apn[i]) ? bdata(config_p->ue_pool_apn[i]) : "*");
+  }
 }
@@ -45,6 +45,8 @@
 
 #define PGW_CONFIG_STRING_IP_ADDRESS_POOL                       "IP_ADDRESS_POOL"
 #define PGW_CONFIG_STRING_IPV4_ADDRESS_LIST                     "IPV4_LIST"
+#define PGW_CONFIG_STRING_APN_IPV4_ADDRESS_LIST                 "APN_IPV4_LIST"
+#define PGW_CONFIG_STRING_APN                                   "APN"
 #define PGW_CONFIG_STRING_IPV4_PREFIX_DELIMITER                 '/'
 #define PGW_CONFIG_STRING_DEFAULT_DNS_IPV4_ADDRESS              "DEFAULT_DNS_IPV4_ADDRESS"
 #define PGW_CONFIG_STRING_DEFAULT_DNS_SEC_IPV4_ADDRESS          "DEFAULT_DNS_SEC_IPV4_ADDRESS"
@@ -60,14 +62,6 @@
 #define PGW_MAX_ALLOCATED_PDN_ADDRESSES 1024
 
 
-typedef struct conf_ipv4_list_elm_s {
-  STAILQ_ENTRY(conf_ipv4_list_elm_s) ipv4_entries;
-  struct in_addr  addr;
-} conf_ipv4_list_elm_t;
-
-
-
-
 typedef struct pgw_config_s {
   /* Reader/writer lock for this configuration */
   pthread_rwlock_t rw_lock;
@@ -97,11 +91,10 @@ typedef struct pgw_config_s {
 #define PGW_NUM_UE_POOL_MAX 16
   uint8_t          ue_pool_mask[PGW_NUM_UE_POOL_MAX];
   struct in_addr   ue_pool_addr[PGW_NUM_UE_POOL_MAX];
+  bstring          ue_pool_apn[PGW_NUM_UE_POOL_MAX]; // NULL: pool serves any APN
 
   bool      force_push_pco;
   uint16_t  ue_mtu;
-
-  STAILQ_HEAD(ipv4_pool_head_s, conf_ipv4_list_elm_s) ipv4_pool_list;
 } pgw_config_t;
 
 
@@ -26,8 +26,12 @@
   \email: lionel.gauthier@eurecom.fr
 */
 #include <stdint.h>
+#include <stdlib.h>
+#include <inttypes.h>
 #include <errno.h>
 #include <string.h>
+#include <strings.h>
+#include <pthread.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -49,91 +53,171 @@
 #include "pgw_lite_paa.h"
 
 
-//#define PGW_LITE_FREE_ADDR_POOL_CONFIG 1
-
 extern pgw_app_t                        pgw_app;
 
+//------------------------------------------------------------------------------
+static int pgw_ue_ipv4_pool_init (pgw_ue_ipv4_pool_t * const pool_pP, const struct in_addr net, const uint8_t mask, const_bstring apn)
+{
+  memset (pool_pP, 0, sizeof (*pool_pP));
+  pthread_mutex_init (&pool_pP->mutex, NULL);
+  pool_pP->net  = net;
+  pool_pP->mask = mask;
+  pool_pP->apn  = (apn) ? bstrcpy (apn) : NULL;
+  // X.Y.Z.0 is the network address, X.Y.Z.1 is reserved for the GTP network device, skip also broadcast address
+  pool_pP->first_addr = ntohl (net.s_addr) + 2;
+  pool_pP->size       = (uint32_t)((UINT64_C(1) << (32 - mask)) - 3);
+  pool_pP->num_words  = (pool_pP->size + 63) / 64;
+  pool_pP->bitmap     = calloc (pool_pP->num_words, sizeof (uint64_t));
+  if (!pool_pP->bitmap) {
+    OAILOG_ERROR (LOG_SPGW_APP, "Could not allocate bitmap for UE IPv4 pool %s/%u\n", inet_ntoa (net), mask);
+    return RETURNerror;
+  }
+  // mark padding bits of the last word as allocated so that they are never returned
+  if (pool_pP->size % 64) {
+    pool_pP->bitmap[pool_pP->num_words - 1] = ~((UINT64_C(1) << (pool_pP->size % 64)) - 1);
+  }
+  return RETURNok;
+}
 
-// Load in PGW pool, configured PAA address pool
+//------------------------------------------------------------------------------
+// Load in PGW pools, configured PAA address pools
 void
 pgw_load_pool_ip_addresses (
   void)
 {
-  struct conf_ipv4_list_elm_s   *conf_ipv4_p = NULL;
-  struct ipv4_list_elm_s        *ipv4_p = NULL;
-  //struct conf_ipv6_list_elm_s   *conf_ipv6_p = NULL;
-  //struct ipv6_list_elm_s        *ipv6_p = NULL;
-  //char                           print_buffer[INET6_ADDRSTRLEN];
-
-  STAILQ_INIT (&pgw_app.ipv4_list_free);
-  STAILQ_INIT (&pgw_app.ipv4_list_allocated);
-  STAILQ_FOREACH (conf_ipv4_p, &spgw_config.pgw_config.ipv4_pool_list, ipv4_entries) {
-    ipv4_p = calloc (1, sizeof (struct ipv4_list_elm_s));
-    ipv4_p->addr.s_addr = ntohl (conf_ipv4_p->addr.s_addr);
-    STAILQ_INSERT_TAIL (&pgw_app.ipv4_list_free, ipv4_p, ipv4_entries);
-    //SPGW_APP_DEBUG("Loaded IPv4 PAA address in pool: %s\n",
-    //        inet_ntoa(conf_ipv4_p->addr));
+  pgw_config_t                  *pgw_config_p = &spgw_config.pgw_config;
+
+  memset (&pgw_app, 0, sizeof (pgw_app));
+  for (int i = 0; i < pgw_config_p->num_ue_pool; i++) {
+    if (RETURNok == pgw_ue_ipv4_pool_init (&pgw_app.ue_ipv4_pools[pgw_app.num_ue_ipv4_pools], pgw_config_p->ue_pool_addr[i],
+        pgw_config_p->ue_pool_mask[i], pgw_config_p->ue_pool_apn[i])) {
+      OAILOG_DEBUG (LOG_SPGW_APP, "Loaded UE IPv4 pool %s/%u (%u addresses) APN %s\n",
+          inet_ntoa (pgw_config_p->ue_pool_addr[i]), pgw_config_p->ue_pool_mask[i],
+          pgw_app.ue_ipv4_pools[pgw_app.num_ue_ipv4_pools].size,
+          (pgw_config_p->ue_pool_apn[i]) ? bdata(pgw_config_p->ue_pool_apn[i]) : "*");
+      pgw_app.num_ue_ipv4_pools += 1;
+    }
   }
+}
 
-//  STAILQ_FOREACH (conf_ipv6_p, &spgw_config.pgw_config.pgw_lite_ipv6_pool_list, ipv6_entries) {
-//    ipv6_p = calloc (1, sizeof (struct pgw_lite_ipv6_list_elm_s));
-//    ipv6_p->addr = conf_ipv6_p->addr;
-//    ipv6_p->prefix_len = conf_ipv6_p->prefix_len;
-//    ipv6_p->num_allocated = 0;
-//    STAILQ_INSERT_TAIL (&pgw_app.pgw_lite_ipv6_list_free, ipv6_p, ipv6_entries);
-//
-//    if (inet_ntop (AF_INET6, &ipv6_p->addr, print_buffer, INET6_ADDRSTRLEN) == NULL) {
-//      OAILOG_ERROR (LOG_SPGW_APP, "Could not Load IPv6 PAA address in pool: %s\n", strerror (errno));
-//    }                           /*else {
-//                                 *
-//                                 * SPGW_APP_DEBUG("Loaded IPv6 PAA prefix in pool: %s\n",print_buffer);
-//                                 * } */
-//  }
-#if PGW_LITE_FREE_ADDR_POOL_CONFIG
-
-  while ((conf_ipv4_p = STAILQ_FIRST (&spgw_config.pgw_config.ipv4_pool_list))) {
-    STAILQ_REMOVE_HEAD (&spgw_config.pgw_config.ipv4_pool_list, ipv4_entries);
-    free_wrapper ((void **) &conf_ipv4_p);
-  }
+//------------------------------------------------------------------------------
+void
+pgw_free_pool_ip_addresses (
+  void)
+{
+  for (int i = 0; i < pgw_app.num_ue_ipv4_pools; i++) {
+    pgw_ue_ipv4_pool_t *pool_p = &pgw_app.ue_ipv4_pools[i];
 
-#endif
+    free_wrapper ((void**) &pool_p->bitmap);
+    bdestroy (pool_p->apn);
+    pthread_mutex_destroy (&pool_p->mutex);
+  }
+  pgw_app.num_ue_ipv4_pools = 0;
 }
 
+//------------------------------------------------------------------------------
+// A pool dedicated to the APN is preferred, then the first pool not dedicated to any APN.
+int
+pgw_select_ue_ipv4_pool (
+  const char * const apn_pP)
+{
+  int                            default_pool_id = PGW_UE_POOL_ID_NONE;
+
+  for (int i = 0; i < pgw_app.num_ue_ipv4_pools; i++) {
+    if (pgw_app.ue_ipv4_pools[i].apn) {
+      if ((apn_pP) && (0 == strcasecmp ((const char *)pgw_app.ue_ipv4_pools[i].apn->data, apn_pP))) {
+        return i;
+      }
+    } else if (PGW_UE_POOL_ID_NONE == default_pool_id) {
+      default_pool_id = i;
+    }
+  }
+  return default_pool_id;
+}
 
-
+//------------------------------------------------------------------------------
+// addr_pP is in network byte order, as given back to pgw_release_free_ipv4_paa_address()
 int
 pgw_get_free_ipv4_paa_address (
+  const int pool_id,
   struct in_addr *const addr_pP)
 {
-  struct ipv4_list_elm_s        *ipv4_p = NULL;
+  pgw_ue_ipv4_pool_t            *pool_p = NULL;
 
-  if (STAILQ_EMPTY (&pgw_app.ipv4_list_free)) {
-    addr_pP->s_addr = INADDR_ANY;
+  addr_pP->s_addr = INADDR_ANY;
+  if ((0 > pool_id) || (pool_id >= pgw_app.num_ue_ipv4_pools)) {
     return RETURNerror;
   }
-
-  ipv4_p = STAILQ_FIRST (&pgw_app.ipv4_list_free);
-  STAILQ_REMOVE (&pgw_app.ipv4_list_free, ipv4_p, ipv4_list_elm_s, ipv4_entries);
-  STAILQ_INSERT_TAIL (&pgw_app.ipv4_list_allocated, ipv4_p, ipv4_entries);
-  addr_pP->s_addr = ipv4_p->addr.s_addr;
-  return RETURNok;
+  pool_p = &pgw_app.ue_ipv4_pools[pool_id];
+
+  pthread_mutex_lock (&pool_p->mutex);
+  if (pool_p->num_allocated < pool_p->size) {
+    // round robin from the cursor, so that a released address is not immediately reused
+    for (uint32_t n = 0; n < pool_p->num_words; n++) {
+      uint32_t word = pool_p->next_word;
+
+      pool_p->next_word = (pool_p->next_word + 1 == pool_p->num_words) ? 0 : pool_p->next_word + 1;
+      if (~pool_p->bitmap[word]) {
+        int bit = __builtin_ctzll (~pool_p->bitmap[word]);
+
+        pool_p->bitmap[word] |= (UINT64_C(1) << bit);
+        pool_p->num_allocated += 1;
+        if (pool_p->num_allocated > pool_p->high_water_mark) {
+          pool_p->high_water_mark = pool_p->num_allocated;
+        }
+        addr_pP->s_addr = htonl (pool_p->first_addr + (word * 64) + bit);
+        pthread_mutex_unlock (&pool_p->mutex);
+        return RETURNok;
+      }
+    }
+  }
+  pool_p->num_alloc_failures += 1;
+  pthread_mutex_unlock (&pool_p->mutex);
+  return RETURNerror;
 }
 
+//------------------------------------------------------------------------------
+// addr_pP is in network byte order, as returned by pgw_get_free_ipv4_paa_address()
 int
 pgw_release_free_ipv4_paa_address (
   const struct in_addr *const addr_pP)
 {
-  struct ipv4_list_elm_s        *ipv4_p = NULL;
-
-  STAILQ_FOREACH (ipv4_p, &pgw_app.ipv4_list_allocated, ipv4_entries) {
-    if (ipv4_p->addr.s_addr == addr_pP->s_addr) {
-      STAILQ_REMOVE (&pgw_app.ipv4_list_allocated, ipv4_p, ipv4_list_elm_s, ipv4_entries);
-      STAILQ_INSERT_TAIL (&pgw_app.ipv4_list_free, ipv4_p, ipv4_entries);
-      return RETURNok;
+  uint32_t                       addr = ntohl (addr_pP->s_addr);
+
+  for (int i = 0; i < pgw_app.num_ue_ipv4_pools; i++) {
+    pgw_ue_ipv4_pool_t *pool_p = &pgw_app.ue_ipv4_pools[i];
+
+    if ((addr >= pool_p->first_addr) && (addr - pool_p->first_addr < pool_p->size)) {
+      uint32_t offset = addr - pool_p->first_addr;
+      uint64_t bit    = UINT64_C(1) << (offset % 64);
+      int      rc     = RETURNerror;
+
+      pthread_mutex_lock (&pool_p->mutex);
+      if (pool_p->bitmap[offset / 64] & bit) {
+        pool_p->bitmap[offset / 64] &= ~bit;
+        pool_p->num_allocated -= 1;
+        rc = RETURNok;
+      }
+      pthread_mutex_unlock (&pool_p->mutex);
+      return rc;
     }
   }
   return RETURNerror;
 }
 
-
-
+//------------------------------------------------------------------------------
+void
+pgw_ue_ipv4_pools_statistics_display (
+  void)
+{
+  OAILOG_DEBUG (LOG_SPGW_APP, "======================================= UE IPv4 POOLS ==============================================\n");
+  for (int i = 0; i < pgw_app.num_ue_ipv4_pools; i++) {
+    pgw_ue_ipv4_pool_t *pool_p = &pgw_app.ue_ipv4_pools[i];
+
+    OAILOG_DEBUG (LOG_SPGW_APP, "Pool %2d %15s/%-2u APN %-16s allocated %9u/%-9u (%3u%%) high water mark %9u alloc failures %"PRIu64"\n",
+        i, inet_ntoa (pool_p->net), pool_p->mask, (pool_p->apn) ? bdata(pool_p->apn) : "*",
+        pool_p->num_allocated, pool_p->size, (uint32_t)(((uint64_t)pool_p->num_allocated * 100) / pool_p->size),
+        pool_p->high_water_mark, pool_p->num_alloc_failures);
+  }
+  OAILOG_DEBUG (LOG_SPGW_APP, "===================================================================================================\n");
+}
@@ -29,7 +29,10 @@
 #define FILE_PGW_LITE_PAA_SEEN
 
 void pgw_load_pool_ip_addresses       (void);
-int pgw_get_free_ipv4_paa_address     (struct in_addr * const addr_P);
+void pgw_free_pool_ip_addresses       (void);
+int pgw_select_ue_ipv4_pool           (const char * const apn_P);
+int pgw_get_free_ipv4_paa_address     (const int pool_id, struct in_addr * const addr_P);
 int pgw_release_free_ipv4_paa_address (const struct in_addr * const addr_P);
+void pgw_ue_ipv4_pools_statistics_display (void);
 
 #endif
@@ -29,6 +29,7 @@
 #ifndef FILE_SGW_SEEN
 #define FILE_SGW_SEEN
 #include <stdint.h>
+#include <pthread.h>
 #include <netinet/in.h>
 #include "bstrlib.h"
 #include "hashtable.h"
@@ -37,6 +38,24 @@
 #include "common_types.h"
 #include "sgw_context_manager.h"
 #include "gtpv1u_sgw_defs.h"
+#include "pgw_config.h"
+#include "sgw_config.h"
+#include "intertask_interface.h"
+
+// S11 contexts owned by one SPGW_APP worker task, only accessed from that task.
+typedef struct sgw_app_worker_s {
+  int        index;
+  task_id_t  task_id;
+
+  // S11 S-GW local teids of this worker are index + n * num_workers
+  teid_t     last_s11_teid_multiple;
+
+  // key is S11 S-GW local teid
+  hash_table_ts_t *s11teid2mme_hashtable;
+
+  // the key of this hashtable is the S11 s-gw local teid.
+  hash_table_ts_t *s11_bearer_context_information_hashtable;
+} sgw_app_worker_t;
 
 typedef struct sgw_app_s {
 
@@ -48,28 +67,41 @@ typedef struct sgw_app_s {
 
   ipv4_nbo_t sgw_ip_address_S5_S8_up; // unused now
 
-  // key is S11 S-GW local teid
-  hash_table_ts_t *s11teid2mme_hashtable;
-
   // key is S1-U S-GW local teid
   //hash_table_t *s1uteid2enb_hashtable;
 
-  // the key of this hashtable is the S11 s-gw local teid.
-  hash_table_ts_t *s11_bearer_context_information_hashtable;
+  int              num_workers;
+  sgw_app_worker_t workers[SGW_APP_WORKERS_MAX];
 
   gtpv1u_data_t    gtpv1u_data;
 } sgw_app_t;
 
-
-struct ipv4_list_elm_s {
-  STAILQ_ENTRY(ipv4_list_elm_s) ipv4_entries;
-  struct in_addr  addr;
-};
-
+// Worker owning the S11 S-GW local teid
+#define SGW_APP_WORKER(tEiD) (&sgw_app.workers[SGW_APP_WORKER_INDEX(sgw_app.num_workers, (tEiD))])
+
+
+// UE IPv4 address pool, one per configured CIDR, optionally dedicated to an APN.
+// Addresses are tracked in a bitmap (1 bit per address) so that a /8 pool costs 2MB.
+typedef struct pgw_ue_ipv4_pool_s {
+  pthread_mutex_t  mutex;
+  bstring          apn;              // NULL: pool serves any APN
+  struct in_addr   net;              // network byte order
+  uint8_t          mask;
+  uint32_t         first_addr;       // host byte order, first allocatable address
+  uint32_t         size;             // number of allocatable addresses
+  uint32_t         num_allocated;
+  uint32_t         high_water_mark;
+  uint64_t         num_alloc_failures;
+  uint32_t         next_word;        // search cursor in bitmap
+  uint32_t         num_words;
+  uint64_t        *bitmap;           // bit set: address allocated
+} pgw_ue_ipv4_pool_t;
+
+#define PGW_UE_POOL_ID_NONE  (-1)
 
 typedef struct pgw_app_s {
-  STAILQ_HEAD(ipv4_list_free_head_s,     ipv4_list_elm_s) ipv4_list_free;
-  STAILQ_HEAD(pv4_list_allocated_head_s, ipv4_list_elm_s) ipv4_list_allocated;
+  int                num_ue_ipv4_pools;
+  pgw_ue_ipv4_pool_t ue_ipv4_pools[PGW_NUM_UE_POOL_MAX];
 } pgw_app_t;
 
 #endif
@@ -83,6 +83,7 @@ int sgw_config_parse_file (sgw_config_t * config_pP)
   char                                   *sgw_if_name_S11 = NULL;
   char                                   *S11 = NULL;
   libconfig_int                           sgw_udp_port_S1u_S12_S4_up = 2152;
+  libconfig_int                           num_app_workers = 1;
   config_setting_t                       *subsetting = NULL;
   const char                             *astring = NULL;
   bstring                                 address = NULL;
@@ -111,6 +112,12 @@ int sgw_config_parse_file (sgw_config_t * config_pP)
   setting_sgw = config_lookup (&cfg, SGW_CONFIG_STRING_SGW_CONFIG);
 
   if (setting_sgw) {
+    libconfig_int                         metrics_port = 0;
+
+    if (config_setting_lookup_int (setting_sgw, SGW_CONFIG_STRING_METRICS_PORT, &metrics_port)) {
+      AssertFatal ((0 <= metrics_port) && (UINT16_MAX >= metrics_port), "Bad %s value %d\n", SGW_CONFIG_STRING_METRICS_PORT, metrics_port);
+      config_pP->metrics_port = (uint16_t) metrics_port;
+    }
 
     // LOGGING setting
     subsetting = config_setting_get_member (setting_sgw, LOG_CONFIG_STRING_LOGGING);
@@ -245,8 +252,19 @@ int sgw_config_parse_file (sgw_config_t * config_pP)
         config_pP->udp_port_S1u_S12_S4_up = sgw_udp_port_S1u_S12_S4_up;
       }
     }
+
+    subsetting = config_setting_get_member (setting_sgw, SGW_CONFIG_STRING_INTERTASK_INTERFACE_CONFIG);
+
+    if (subsetting) {
+      config_setting_lookup_int (subsetting, SGW_CONFIG_STRING_SPGW_APP_WORKERS, &num_app_workers);
+      itti_task_placements_config_parse (subsetting, &config_pP->itti_config.task_placements);
+    }
   }
 
+  AssertFatal ((0 < num_app_workers) && (SGW_APP_WORKERS_MAX >= num_app_workers),
+      "Bad %s value %d, must be in [1..%d]\n", SGW_CONFIG_STRING_SPGW_APP_WORKERS, num_app_workers, SGW_APP_WORKERS_MAX);
+  config_pP->num_app_workers = num_app_workers;
+
   config_destroy (&cfg);
   OAILOG_SET_CONFIG(&config_pP->log_config);
   return RETURNok;
@@ -259,6 +277,7 @@ void sgw_config_display (sgw_config_t * config_p)
   OAILOG_INFO (LOG_SPGW_APP, "==== EURECOM %s v%s ====\n", PACKAGE_NAME, PACKAGE_VERSION);
   OAILOG_INFO (LOG_SPGW_APP, "Configuration:\n");
   OAILOG_INFO (LOG_SPGW_APP, "- File .................................: %s\n", bdata(config_p->config_file));
+  OAILOG_INFO (LOG_SPGW_APP, "- Metrics port .........................: %u%s\n", config_p->metrics_port, config_p->metrics_port ? "" : " (disabled)");
 
   OAILOG_INFO (LOG_SPGW_APP, "- S1-U:\n");
   OAILOG_INFO (LOG_SPGW_APP, "    port number ......: %d\n", config_p->udp_port_S1u_S12_S4_up);
@@ -273,6 +292,8 @@ void sgw_config_display (sgw_config_t * config_p)
   OAILOG_INFO (LOG_SPGW_APP, "- ITTI:\n");
   OAILOG_INFO (LOG_SPGW_APP, "    queue size .......: %u (bytes)\n", config_p->itti_config.queue_size);
   OAILOG_INFO (LOG_SPGW_APP, "    log file .........: %s\n", bdata(config_p->itti_config.log_file));
+  OAILOG_INFO (LOG_SPGW_APP, "    SPGW_APP workers .: %u\n", config_p->num_app_workers);
+  itti_task_placements_config_display (LOG_SPGW_APP, &config_p->itti_config.task_placements);
 
   OAILOG_INFO (LOG_SPGW_APP, "- Logging:\n");
   OAILOG_INFO (LOG_SPGW_APP, "    Output ..............: %s\n", bdata(config_p->log_config.output));
@@ -32,6 +32,8 @@
 #include <stdbool.h>
 #include "log.h"
 #include "bstrlib.h"
+#include "intertask_interface_conf.h"
+#include "itti_task_placement_config.h"
 #include "common_types.h"
 
 
@@ -44,6 +46,16 @@
 #define SGW_CONFIG_STRING_SGW_IPV4_ADDRESS_FOR_S5_S8_UP         "SGW_IPV4_ADDRESS_FOR_S5_S8_UP"
 #define SGW_CONFIG_STRING_SGW_INTERFACE_NAME_FOR_S11            "SGW_INTERFACE_NAME_FOR_S11"
 #define SGW_CONFIG_STRING_SGW_IPV4_ADDRESS_FOR_S11              "SGW_IPV4_ADDRESS_FOR_S11"
+#define SGW_CONFIG_STRING_INTERTASK_INTERFACE_CONFIG            "INTERTASK_INTERFACE"
+#define SGW_CONFIG_STRING_SPGW_APP_WORKERS                      "SPGW_APP_WORKERS"
+#define SGW_CONFIG_STRING_METRICS_PORT                          "METRICS_PORT"
+
+// Number of SPGW_APP worker tasks, TASK_SPGW_APP, TASK_SPGW_APP_1, ... must be contiguous
+#define SGW_APP_WORKERS_MAX  8
+
+// S11 S-GW local TEIDs are allocated so that their owning SPGW_APP worker is teid % number of workers,
+// a Create Session Request (no S-GW TEID yet) is dispatched on the MME S11 TEID.
+#define SGW_APP_WORKER_INDEX(nUMwORKERS, tEiD) ((tEiD) % (nUMwORKERS))
 
 #define SPGW_ABORT_ON_ERROR true
 #define SPGW_WARN_ON_ERROR false
@@ -55,8 +67,13 @@ typedef struct sgw_config_s {
   struct {
     uint32_t  queue_size;
     bstring   log_file;
+    itti_task_placements_config_t task_placements;
   } itti_config;
 
+  uint8_t      num_app_workers;
+
+  uint16_t     metrics_port;   // metrics served on 127.0.0.1:metrics_port, 0: no metrics endpoint
+
   struct {
     bstring    if_name_S1u_S12_S4_up;
     ipv4_nbo_t S1u_S12_S4_up;
@@ -81,7 +81,9 @@ sgw_display_s11teid2mme_mappings (
   OAILOG_DEBUG (LOG_SPGW_APP, "+--------------------------------------+\n");
   OAILOG_DEBUG (LOG_SPGW_APP, "| MME <--- S11 TE ID MAPPINGS ---> SGW |\n");
   OAILOG_DEBUG (LOG_SPGW_APP, "+--------------------------------------+\n");
-  hashtable_ts_apply_callback_on_elements (sgw_app.s11teid2mme_hashtable, sgw_display_s11teid2mme_mapping, NULL, NULL);
+  for (int i = 0; i < sgw_app.num_workers; i++) {
+    hashtable_ts_apply_callback_on_elements (sgw_app.workers[i].s11teid2mme_hashtable, sgw_display_s11teid2mme_mapping, NULL, NULL);
+  }
   OAILOG_DEBUG (LOG_SPGW_APP, "+--------------------------------------+\n");
 }
 
@@ -157,7 +159,9 @@ sgw_display_s11_bearer_context_information_mapping (
   OAILOG_DEBUG (LOG_SPGW_APP, "+-----------------------------------------+\n");
   OAILOG_DEBUG (LOG_SPGW_APP, "| S11 BEARER CONTEXT INFORMATION MAPPINGS |\n");
   OAILOG_DEBUG (LOG_SPGW_APP, "+-----------------------------------------+\n");
-  hashtable_ts_apply_callback_on_elements (sgw_app.s11_bearer_context_information_hashtable, sgw_display_s11_bearer_context_information, NULL, NULL);
+  for (int i = 0; i < sgw_app.num_workers; i++) {
+    hashtable_ts_apply_callback_on_elements (sgw_app.workers[i].s11_bearer_context_information_hashtable, sgw_display_s11_bearer_context_information, NULL, NULL);
+  }
   OAILOG_DEBUG (LOG_SPGW_APP, "+--------------------------------------+\n");
 }
 
@@ -177,14 +181,13 @@ pgw_lite_cm_free_apn (
 //-----------------------------------------------------------------------------
 teid_t
 sgw_get_new_S11_tunnel_id (
-  void)
+  sgw_app_worker_t * const worker_p)
 //-----------------------------------------------------------------------------
 {
   // TO DO: RANDOM
-  static teid_t                           tunnel_id = 0;
-
-  tunnel_id += 1;
-  return tunnel_id;
+  // Only called from the worker task, teid % num_workers gives back the worker.
+  worker_p->last_s11_teid_multiple += 1;
+  return worker_p->last_s11_teid_multiple * sgw_app.num_workers + worker_p->index;
 }
 
 //-----------------------------------------------------------------------------
@@ -212,7 +215,7 @@ sgw_cm_create_s11_tunnel (
    * Trying to insert the new tunnel into the tree.
    * * * * If collision_p is not NULL (0), it means tunnel is already present.
    */
-  hashtable_ts_insert (sgw_app.s11teid2mme_hashtable, local_teid, new_tunnel);
+  hashtable_ts_insert (SGW_APP_WORKER(local_teid)->s11teid2mme_hashtable, local_teid, new_tunnel);
   return new_tunnel;
 }
 
@@ -224,7 +227,7 @@ sgw_cm_remove_s11_tunnel (
 {
   int                                     temp = 0;
 
-  temp = hashtable_ts_free (sgw_app.s11teid2mme_hashtable, local_teid);
+  temp = hashtable_ts_free (SGW_APP_WORKER(local_teid)->s11teid2mme_hashtable, local_teid);
   return temp;
 }
 
@@ -364,7 +367,7 @@ sgw_cm_create_bearer_context_information_in_collection (
    * Trying to insert the new tunnel into the tree.
    * * * * If collision_p is not NULL (0), it means tunnel is already present.
    */
-  hashtable_ts_insert (sgw_app.s11_bearer_context_information_hashtable, teid, new_bearer_context_information);
+  hashtable_ts_insert (SGW_APP_WORKER(teid)->s11_bearer_context_information_hashtable, teid, new_bearer_context_information);
   OAILOG_DEBUG (LOG_SPGW_APP, "Added new s_plus_p_gw_eps_bearer_context_information_t in s11_bearer_context_information_hashtable key teid %u\n", teid);
   return new_bearer_context_information;
 }
@@ -375,7 +378,7 @@ sgw_cm_remove_bearer_context_information (
 {
   int                                     temp = 0;
 
-  temp = hashtable_ts_free (sgw_app.s11_bearer_context_information_hashtable, teid);
+  temp = hashtable_ts_free (SGW_APP_WORKER(teid)->s11_bearer_context_information_hashtable, teid);
   return temp;
 }
 
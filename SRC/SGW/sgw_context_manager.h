@@ -55,12 +55,14 @@ typedef struct enb_sgw_s1u_tunnel_s {
 } enb_sgw_s1u_tunnel_t;
 
 
+struct sgw_app_worker_s;
+
 void                                   sgw_display_s11teid2mme_mappings(void);
 void                                   sgw_display_s11_bearer_context_information_mapping(void);
 void                                   pgw_lite_cm_free_apn(pgw_apn_t **apnP);
 
 
-teid_t                                 sgw_get_new_S11_tunnel_id(void);
+teid_t                                 sgw_get_new_S11_tunnel_id(struct sgw_app_worker_s * const worker_p);
 mme_sgw_tunnel_t *                     sgw_cm_create_s11_tunnel(teid_t remote_teid, teid_t local_teid);
 int                                    sgw_cm_remove_s11_tunnel(teid_t local_teid);
 sgw_eps_bearer_entry_t *               sgw_cm_create_eps_bearer_entry(void);
@@ -34,6 +34,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include <netinet/in.h>
+#include <arpa/inet.h>
 
 #include "dynamic_memory_check.h"
 #include "assertions.h"
@@ -49,9 +50,9 @@
 #include "mme_config.h"
 
 #include "sgw_defs.h"
-#include "sgw_handlers.h"
 #include "sgw_context_manager.h"
 #include "sgw.h"
+#include "sgw_handlers.h"
 #include "pgw_lite_paa.h"
 #include "pgw_pco.h"
 #include "spgw_config.h"
@@ -62,6 +63,7 @@
 extern sgw_app_t                        sgw_app;
 extern spgw_config_t                    spgw_config;
 
+// Shared by all SPGW_APP workers
 static uint32_t                         g_gtpv1u_teid = 0;
 
 //------------------------------------------------------------------------------
@@ -69,14 +71,14 @@ uint32_t
 sgw_get_new_teid (
   void)
 {
-  g_gtpv1u_teid = g_gtpv1u_teid + 1;
-  return g_gtpv1u_teid;
+  return __sync_add_and_fetch (&g_gtpv1u_teid, 1);
 }
 
 
 //------------------------------------------------------------------------------
 int
 sgw_handle_create_session_request (
+  sgw_app_worker_t * const worker_p,
   const itti_s11_create_session_request_t * const session_req_pP)
 {
   mme_sgw_tunnel_t                       *new_endpoint_p = NULL;
@@ -109,7 +111,7 @@ sgw_handle_create_session_request (
     OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNerror);
   }
 
-  new_endpoint_p = sgw_cm_create_s11_tunnel (session_req_pP->sender_fteid_for_cp.teid, sgw_get_new_S11_tunnel_id ());
+  new_endpoint_p = sgw_cm_create_s11_tunnel (session_req_pP->sender_fteid_for_cp.teid, sgw_get_new_S11_tunnel_id (worker_p));
 
   if (new_endpoint_p == NULL) {
     OAILOG_WARNING (LOG_SPGW_APP, "Could not create new tunnel endpoint between S-GW and MME " "for S11 abstraction\n");
@@ -171,6 +173,11 @@ sgw_handle_create_session_request (
       s_plus_p_gw_eps_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connection.apn_in_use = "NO APN";
     }
 
+    s_plus_p_gw_eps_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connection.ue_ipv4_pool_id = pgw_select_ue_ipv4_pool (session_req_pP->apn);
+    if (PGW_UE_POOL_ID_NONE == s_plus_p_gw_eps_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connection.ue_ipv4_pool_id) {
+      OAILOG_WARNING (LOG_SPGW_APP, "No UE IPv4 pool serving APN %s\n", session_req_pP->apn);
+    }
+
     s_plus_p_gw_eps_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connection.default_bearer = session_req_pP->bearer_contexts_to_be_created.bearer_contexts[0].eps_bearer_id;
     //obj_hashtable_ts_insert(s_plus_p_gw_eps_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connections, pdn_connection->apn_in_use, strlen(pdn_connection->apn_in_use), pdn_connection);
     //--------------------------------------
@@ -241,7 +248,7 @@ sgw_handle_sgi_endpoint_created (
 
   OAILOG_FUNC_IN(LOG_SPGW_APP);
   OAILOG_DEBUG (LOG_SPGW_APP, "Rx SGI_CREATE_ENDPOINT_RESPONSE,Context: S11 teid %u, SGW S1U teid %u EPS bearer id %u\n", resp_pP->context_teid, resp_pP->sgw_S1u_teid, resp_pP->eps_bearer_id);
-  hash_rc = hashtable_ts_get (sgw_app.s11_bearer_context_information_hashtable, resp_pP->context_teid, (void **)&new_bearer_ctxt_info_p);
+  hash_rc = hashtable_ts_get (SGW_APP_WORKER(resp_pP->context_teid)->s11_bearer_context_information_hashtable, resp_pP->context_teid, (void **)&new_bearer_ctxt_info_p);
 
   message_p = itti_alloc_new_message (TASK_SPGW_APP, S11_CREATE_SESSION_RESPONSE);
 
@@ -352,7 +359,7 @@ sgw_handle_gtpv1uCreateTunnelResp (
 
   OAILOG_DEBUG (LOG_SPGW_APP, "Rx GTPV1U_CREATE_TUNNEL_RESP, Context S-GW S11 teid %u, S-GW S1U teid %u EPS bearer id %u status %d\n",
                   endpoint_created_pP->context_teid, endpoint_created_pP->S1u_teid, endpoint_created_pP->eps_bearer_id, endpoint_created_pP->status);
-  hash_rc = hashtable_ts_get (sgw_app.s11_bearer_context_information_hashtable, endpoint_created_pP->context_teid, (void **)&new_bearer_ctxt_info_p);
+  hash_rc = hashtable_ts_get (SGW_APP_WORKER(endpoint_created_pP->context_teid)->s11_bearer_context_information_hashtable, endpoint_created_pP->context_teid, (void **)&new_bearer_ctxt_info_p);
 
   if (HASH_TABLE_OK == hash_rc) {
     hash_rc = hashtable_ts_get (new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connection.sgw_eps_bearers, endpoint_created_pP->eps_bearer_id, (void **)&eps_bearer_entry_p);
@@ -407,8 +414,8 @@ sgw_handle_gtpv1uCreateTunnelResp (
       // and using them here in conditional logic. We will also want to
       // implement different logic between the PDN types.
       if (!pco_ids.ci_ipv4_address_allocation_via_dhcpv4) {
-        if (pgw_get_free_ipv4_paa_address (&inaddr) == 0) {
-          IN_ADDR_TO_BUFFER (inaddr, sgi_create_endpoint_resp.paa.ipv4_address);
+        if (pgw_get_free_ipv4_paa_address (new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connection.ue_ipv4_pool_id, &inaddr) == 0) {
+          memcpy (sgi_create_endpoint_resp.paa.ipv4_address, &inaddr.s_addr, sizeof (inaddr.s_addr));
           sgi_create_endpoint_resp.status = SGI_STATUS_OK;
         } else {
           OAILOG_ERROR (LOG_SPGW_APP, "Failed to allocate IPv4 PAA for PDN type IPv4\n");
@@ -426,8 +433,8 @@ sgw_handle_gtpv1uCreateTunnelResp (
       break;
 
     case IPv4_AND_v6:
-      if (!pgw_get_free_ipv4_paa_address (&inaddr)) {
-        IN_ADDR_TO_BUFFER (inaddr, sgi_create_endpoint_resp.paa.ipv4_address);
+      if (!pgw_get_free_ipv4_paa_address (new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connection.ue_ipv4_pool_id, &inaddr)) {
+        memcpy (sgi_create_endpoint_resp.paa.ipv4_address, &inaddr.s_addr, sizeof (inaddr.s_addr));
         sgi_create_endpoint_resp.status = SGI_STATUS_OK;
       } else {
         OAILOG_ERROR (LOG_SPGW_APP, "Failed to allocate IPv4 PAA for PDN type IPv4_AND_v6\n");
@@ -514,7 +521,7 @@ sgw_handle_gtpv1uUpdateTunnelResp (
   OAILOG_FUNC_IN(LOG_SPGW_APP);
   OAILOG_DEBUG (LOG_SPGW_APP, "Rx GTPV1U_UPDATE_TUNNEL_RESP, Context teid %u, SGW S1U teid %u, eNB S1U teid %u, EPS bearer id %u, status %d\n",
                   endpoint_updated_pP->context_teid, endpoint_updated_pP->sgw_S1u_teid, endpoint_updated_pP->enb_S1u_teid, endpoint_updated_pP->eps_bearer_id, endpoint_updated_pP->status);
-  hash_rc = hashtable_ts_get (sgw_app.s11_bearer_context_information_hashtable, endpoint_updated_pP->context_teid, (void **)&new_bearer_ctxt_info_p);
+  hash_rc = hashtable_ts_get (SGW_APP_WORKER(endpoint_updated_pP->context_teid)->s11_bearer_context_information_hashtable, endpoint_updated_pP->context_teid, (void **)&new_bearer_ctxt_info_p);
 
   if (HASH_TABLE_OK == hash_rc) {
     hash_rc = hashtable_ts_get (new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connection.sgw_eps_bearers, endpoint_updated_pP->eps_bearer_id, (void **)&eps_bearer_entry_p);
@@ -606,8 +613,8 @@ sgw_handle_sgi_endpoint_updated (
 
   modify_response_p = &message_p->ittiMsg.s11_modify_bearer_response;
   memset (modify_response_p, 0, sizeof (itti_s11_modify_bearer_response_t));
-  hash_rc = hashtable_ts_get (sgw_app.s11_bearer_context_information_hashtable, resp_pP->context_teid, (void **)&new_bearer_ctxt_info_p);
-  hash_rc2 = hashtable_ts_get (sgw_app.s11teid2mme_hashtable, resp_pP->context_teid /*local teid*/, (void **)&tun_pair_p);
+  hash_rc = hashtable_ts_get (SGW_APP_WORKER(resp_pP->context_teid)->s11_bearer_context_information_hashtable, resp_pP->context_teid, (void **)&new_bearer_ctxt_info_p);
+  hash_rc2 = hashtable_ts_get (SGW_APP_WORKER(resp_pP->context_teid)->s11teid2mme_hashtable, resp_pP->context_teid /*local teid*/, (void **)&tun_pair_p);
 
   if ((HASH_TABLE_OK == hash_rc) && (HASH_TABLE_OK == hash_rc2)) {
     hash_rc = hashtable_ts_get (new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connection.sgw_eps_bearers, resp_pP->eps_bearer_id, (void **)&eps_bearer_entry_p);
@@ -699,7 +706,7 @@ sgw_handle_sgi_endpoint_deleted (
   OAILOG_DEBUG (LOG_SPGW_APP, "bcom Rx SGI_DELETE_ENDPOINT_REQUEST, Context teid %u, SGW S1U teid %u, EPS bearer id %u\n",
                 resp_pP->context_teid, resp_pP->sgw_S1u_teid, resp_pP->eps_bearer_id);
 
-  hash_rc = hashtable_ts_get (sgw_app.s11_bearer_context_information_hashtable, resp_pP->context_teid, (void **)&new_bearer_ctxt_info_p);
+  hash_rc = hashtable_ts_get (SGW_APP_WORKER(resp_pP->context_teid)->s11_bearer_context_information_hashtable, resp_pP->context_teid, (void **)&new_bearer_ctxt_info_p);
 
   if (HASH_TABLE_OK == hash_rc) {
     hash_rc = hashtable_ts_get (new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connection.sgw_eps_bearers, resp_pP->eps_bearer_id, (void **)&eps_bearer_entry_p);
@@ -716,6 +723,16 @@ sgw_handle_sgi_endpoint_deleted (
       if (rv < 0) {
         OAILOG_ERROR (LOG_SPGW_APP, "ERROR in deleting TUNNEL\n");
       }
+
+      if ((IPv4 == resp_pP->pdn_type) || (IPv4_AND_v6 == resp_pP->pdn_type)) {
+        struct in_addr ue = {.s_addr = 0};
+
+        // both in network byte order
+        memcpy (&ue.s_addr, resp_pP->paa.ipv4_address, sizeof (ue.s_addr));
+        if (RETURNok != pgw_release_free_ipv4_paa_address (&ue)) {
+          OAILOG_WARNING (LOG_SPGW_APP, "Could not release UE IPv4 address %s\n", inet_ntoa (ue));
+        }
+      }
     }
 
 //    MSC_LOG_TX_MESSAGE (MSC_SP_GWAPP_MME, MSC_S11_MME, NULL, 0, "0 S11_MODIFY_BEARER_RESPONSE ebi %u  trxn %u", modify_response_p->bearer_choice.bearer_contexts_modified.eps_bearer_id, modify_response_p->trxn);
@@ -754,7 +771,7 @@ sgw_handle_modify_bearer_request (
   OAILOG_DEBUG (LOG_SPGW_APP, "Rx MODIFY_BEARER_REQUEST, teid %u\n", modify_bearer_pP->teid);
   sgw_display_s11teid2mme_mappings ();
   sgw_display_s11_bearer_context_information_mapping ();
-  hash_rc = hashtable_ts_get (sgw_app.s11_bearer_context_information_hashtable, modify_bearer_pP->teid, (void **)&new_bearer_ctxt_info_p);
+  hash_rc = hashtable_ts_get (SGW_APP_WORKER(modify_bearer_pP->teid)->s11_bearer_context_information_hashtable, modify_bearer_pP->teid, (void **)&new_bearer_ctxt_info_p);
 
   if (HASH_TABLE_OK == hash_rc) {
     new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connection.default_bearer =
@@ -851,7 +868,7 @@ sgw_handle_delete_session_request (
     OAILOG_DEBUG (LOG_SPGW_APP, "OI flag is set for this message indicating the request" "should be forwarded to P-GW entity\n");
   }
 
-  hash_rc = hashtable_ts_get (sgw_app.s11_bearer_context_information_hashtable, delete_session_req_pP->teid, (void **)&ctx_p);
+  hash_rc = hashtable_ts_get (SGW_APP_WORKER(delete_session_req_pP->teid)->s11_bearer_context_information_hashtable, delete_session_req_pP->teid, (void **)&ctx_p);
 
   if (HASH_TABLE_OK == hash_rc) {
     if ((delete_session_req_pP->sender_fteid_for_cp.ipv4 ) && (delete_session_req_pP->sender_fteid_for_cp.ipv6 )) {
@@ -885,7 +902,7 @@ sgw_handle_delete_session_request (
        * Delete S11 bearer context and remove s11 tunnel
        */
 
-      hashtable_ts_free (sgw_app.s11_bearer_context_information_hashtable, delete_session_req_pP->teid);
+      hashtable_ts_free (SGW_APP_WORKER(delete_session_req_pP->teid)->s11_bearer_context_information_hashtable, delete_session_req_pP->teid);
       sgw_cm_remove_s11_tunnel( delete_session_req_pP->teid);
     }
 
@@ -970,7 +987,7 @@ sgw_handle_release_access_bearers_request (
   release_access_bearers_resp_p = &message_p->ittiMsg.s11_release_access_bearers_response;
   memset((void*)release_access_bearers_resp_p, 0, sizeof(*release_access_bearers_resp_p));
 
-  hash_rc = hashtable_ts_get (sgw_app.s11_bearer_context_information_hashtable, release_access_bearers_req_pP->teid, (void **)&ctx_p);
+  hash_rc = hashtable_ts_get (SGW_APP_WORKER(release_access_bearers_req_pP->teid)->s11_bearer_context_information_hashtable, release_access_bearers_req_pP->teid, (void **)&ctx_p);
 
   if (HASH_TABLE_OK == hash_rc) {
     release_access_bearers_resp_p->cause = REQUEST_ACCEPTED;
@@ -29,7 +29,7 @@
 #ifndef FILE_SGW_HANDLERS_SEEN
 #define FILE_SGW_HANDLERS_SEEN
 
-int sgw_handle_create_session_request(const itti_s11_create_session_request_t * const session_req_p);
+int sgw_handle_create_session_request(sgw_app_worker_t * const worker_p, const itti_s11_create_session_request_t * const session_req_p);
 int sgw_handle_sgi_endpoint_created  (itti_sgi_create_end_point_response_t   * const resp_p);
 int sgw_handle_sgi_endpoint_updated  (const itti_sgi_update_end_point_response_t   * const resp_p);
 int sgw_handle_gtpv1uCreateTunnelResp(const Gtpv1uCreateTunnelResp  * const endpoint_created_p);
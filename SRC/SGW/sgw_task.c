@@ -46,10 +46,11 @@
 #include "3gpp_23.401.h"
 #include "mme_config.h"
 #include "sgw_defs.h"
-#include "sgw_handlers.h"
 #include "sgw.h"
+#include "sgw_handlers.h"
 #include "spgw_config.h"
 #include "pgw_lite_paa.h"
+#include "metrics.h"
 
 spgw_config_t                           spgw_config;
 sgw_app_t                               sgw_app;
@@ -57,19 +58,52 @@ pgw_app_t                               pgw_app;
 
 extern __pid_t g_pid;
 
-static void sgw_exit(void);
+static void sgw_exit(sgw_app_worker_t * const worker_p);
+
+typedef enum {
+  SGW_METRIC_CREATE_SESSION = 0,
+  SGW_METRIC_MODIFY_BEARER,
+  SGW_METRIC_RELEASE_ACCESS_BEARERS,
+  SGW_METRIC_DELETE_SESSION,
+  SGW_METRIC_MAX
+} sgw_metric_t;
+
+static const char *sgw_metric_names[SGW_METRIC_MAX] = {
+  "CreateSessionRequest",
+  "ModifyBearerRequest",
+  "ReleaseAccessBearersRequest",
+  "DeleteSessionRequest",
+};
+
+// [request][ok, error]
+static metric_id_t sgw_metrics[SGW_METRIC_MAX][2];
+
+#define SGW_METRICS_COUNT(rEQUEST, rET)  metrics_inc (sgw_metrics[(rEQUEST)][(RETURNok == (rET)) ? 0 : 1])
+
+//------------------------------------------------------------------------------
+static void sgw_metrics_init (void)
+{
+  for (int i = 0; i < SGW_METRIC_MAX; i++) {
+    sgw_metrics[i][0] = metrics_register ("sgw_s11_requests_total", METRIC_COUNTER, "S11 requests handled by the S-GW",
+        "message=\"%s\",result=\"ok\"", sgw_metric_names[i]);
+    sgw_metrics[i][1] = metrics_register ("sgw_s11_requests_total", METRIC_COUNTER, "S11 requests handled by the S-GW",
+        "message=\"%s\",result=\"error\"", sgw_metric_names[i]);
+  }
+}
 
 //------------------------------------------------------------------------------
 static void *sgw_intertask_interface (void *args_p)
 {
-  itti_mark_task_ready (TASK_SPGW_APP);
+  sgw_app_worker_t * const worker_p = (sgw_app_worker_t *)args_p;
+
+  itti_mark_task_ready (worker_p->task_id);
   OAILOG_START_USE ();
   MSC_START_USE ();
 
   while (1) {
     MessageDef                             *received_message_p = NULL;
 
-    itti_receive_msg (TASK_SPGW_APP, &received_message_p);
+    itti_receive_msg (worker_p->task_id, &received_message_p);
 
     switch (ITTI_MSG_ID (received_message_p)) {
     case S11_CREATE_SESSION_REQUEST:{
@@ -79,22 +113,26 @@ static void *sgw_intertask_interface (void *args_p)
          * * * *      E-UTRAN Initial Attach
          * * * *      UE requests PDN connectivity
          */
-        sgw_handle_create_session_request (&received_message_p->ittiMsg.s11_create_session_request);
+        SGW_METRICS_COUNT (SGW_METRIC_CREATE_SESSION,
+            sgw_handle_create_session_request (worker_p, &received_message_p->ittiMsg.s11_create_session_request));
       }
       break;
 
     case S11_MODIFY_BEARER_REQUEST:{
-        sgw_handle_modify_bearer_request (&received_message_p->ittiMsg.s11_modify_bearer_request);
+        SGW_METRICS_COUNT (SGW_METRIC_MODIFY_BEARER,
+            sgw_handle_modify_bearer_request (&received_message_p->ittiMsg.s11_modify_bearer_request));
       }
       break;
 
     case S11_RELEASE_ACCESS_BEARERS_REQUEST:{
-        sgw_handle_release_access_bearers_request (&received_message_p->ittiMsg.s11_release_access_bearers_request);
+        SGW_METRICS_COUNT (SGW_METRIC_RELEASE_ACCESS_BEARERS,
+            sgw_handle_release_access_bearers_request (&received_message_p->ittiMsg.s11_release_access_bearers_request));
       }
       break;
 
     case S11_DELETE_SESSION_REQUEST:{
-        sgw_handle_delete_session_request (&received_message_p->ittiMsg.s11_delete_session_request);
+        SGW_METRICS_COUNT (SGW_METRIC_DELETE_SESSION,
+            sgw_handle_delete_session_request (&received_message_p->ittiMsg.s11_delete_session_request));
       }
       break;
 
@@ -120,7 +158,7 @@ static void *sgw_intertask_interface (void *args_p)
       break;
 
     case TERMINATE_MESSAGE:{
-        sgw_exit();
+        sgw_exit(worker_p);
         itti_exit_task ();
       }
       break;
@@ -154,34 +192,38 @@ int sgw_init (spgw_config_t *spgw_config_pP)
 
   pgw_load_pool_ip_addresses ();
 
-  bstring b = bfromcstr("sgw_s11teid2mme_hashtable");
-  sgw_app.s11teid2mme_hashtable = hashtable_ts_create (512, NULL, NULL, b);
-  btrunc(b, 0);
+  sgw_metrics_init ();
 
-  if (sgw_app.s11teid2mme_hashtable == NULL) {
-    perror ("hashtable_ts_create");
-    bdestroy(b);
-    OAILOG_ALERT (LOG_SPGW_APP, "Initializing SPGW-APP task interface: ERROR\n");
-    return RETURNerror;
-  }
+  sgw_app.num_workers = spgw_config_pP->sgw_config.num_app_workers;
 
-  /*sgw_app.s1uteid2enb_hashtable = hashtable_ts_create (512, NULL, NULL, "sgw_s1uteid2enb_hashtable");
+  for (int i = 0; i < sgw_app.num_workers; i++) {
+    sgw_app_worker_t *worker_p = &sgw_app.workers[i];
 
-  if (sgw_app.s1uteid2enb_hashtable == NULL) {
-    perror ("hashtable_ts_create");
-    OAILOG_ALERT (LOG_SPGW_APP, "Initializing SPGW-APP task interface: ERROR\n");
-    return RETURNerror;
-  }*/
+    worker_p->index   = i;
+    worker_p->task_id = (task_id_t)(TASK_SPGW_APP + i);
+    worker_p->last_s11_teid_multiple = 0;
 
-  bassigncstr(b, "sgw_s11_bearer_context_information_hashtable");
-  sgw_app.s11_bearer_context_information_hashtable = hashtable_ts_create (512, NULL,
-          (void (*)(void**))sgw_cm_free_s_plus_p_gw_eps_bearer_context_information,b);
-  bdestroy(b);
+    bstring b = bformat("sgw_s11teid2mme_hashtable_%d", i);
+    worker_p->s11teid2mme_hashtable = hashtable_ts_create (512, NULL, NULL, b);
 
-  if (sgw_app.s11_bearer_context_information_hashtable == NULL) {
-    perror ("hashtable_ts_create");
-    OAILOG_ALERT (LOG_SPGW_APP, "Initializing SPGW-APP task interface: ERROR\n");
-    return RETURNerror;
+    if (worker_p->s11teid2mme_hashtable == NULL) {
+      perror ("hashtable_ts_create");
+      bdestroy(b);
+      OAILOG_ALERT (LOG_SPGW_APP, "Initializing SPGW-APP task interface: ERROR\n");
+      return RETURNerror;
+    }
+
+    btrunc(b, 0);
+    bformata(b, "sgw_s11_bearer_context_information_hashtable_%d", i);
+    worker_p->s11_bearer_context_information_hashtable = hashtable_ts_create (512, NULL,
+            (void (*)(void**))sgw_cm_free_s_plus_p_gw_eps_bearer_context_information,b);
+    bdestroy(b);
+
+    if (worker_p->s11_bearer_context_information_hashtable == NULL) {
+      perror ("hashtable_ts_create");
+      OAILOG_ALERT (LOG_SPGW_APP, "Initializing SPGW-APP task interface: ERROR\n");
+      return RETURNerror;
+    }
   }
 
   sgw_app.sgw_if_name_S1u_S12_S4_up    = bstrcpy(spgw_config_pP->sgw_config.ipv4.if_name_S1u_S12_S4_up);
@@ -191,10 +233,12 @@ int sgw_init (spgw_config_t *spgw_config_pP)
 
   sgw_app.sgw_ip_address_S5_S8_up      = spgw_config_pP->sgw_config.ipv4.S5_S8_up;
 
-  if (itti_create_task (TASK_SPGW_APP, &sgw_intertask_interface, NULL) < 0) {
-    perror ("pthread_create");
-    OAILOG_ALERT (LOG_SPGW_APP, "Initializing SPGW-APP task interface: ERROR\n");
-    return RETURNerror;
+  for (int i = 0; i < sgw_app.num_workers; i++) {
+    if (itti_create_task (sgw_app.workers[i].task_id, &sgw_intertask_interface, &sgw_app.workers[i]) < 0) {
+      perror ("pthread_create");
+      OAILOG_ALERT (LOG_SPGW_APP, "Initializing SPGW-APP task interface: ERROR\n");
+      return RETURNerror;
+    }
   }
 
   FILE *fp = NULL;
@@ -210,24 +254,24 @@ int sgw_init (spgw_config_t *spgw_config_pP)
 }
 
 //------------------------------------------------------------------------------
-static void sgw_exit(void)
+static void sgw_exit(sgw_app_worker_t * const worker_p)
 {
 
-  if (sgw_app.s11teid2mme_hashtable) {
-    hashtable_ts_destroy (sgw_app.s11teid2mme_hashtable);
+  if (worker_p->s11teid2mme_hashtable) {
+    hashtable_ts_destroy (worker_p->s11teid2mme_hashtable);
+    worker_p->s11teid2mme_hashtable = NULL;
   }
   /*if (sgw_app.s1uteid2enb_hashtable) {
     hashtable_destroy (sgw_app.s1uteid2enb_hashtable);
   }*/
-  if (sgw_app.s11_bearer_context_information_hashtable) {
-    hashtable_ts_destroy (sgw_app.s11_bearer_context_information_hashtable);
+  if (worker_p->s11_bearer_context_information_hashtable) {
+    hashtable_ts_destroy (worker_p->s11_bearer_context_information_hashtable);
+    worker_p->s11_bearer_context_information_hashtable = NULL;
   }
 
-  //P-GW code
-  struct conf_ipv4_list_elm_s   *conf_ipv4_p = NULL;
-
-  while ((conf_ipv4_p = STAILQ_FIRST (&spgw_config.pgw_config.ipv4_pool_list))) {
-    STAILQ_REMOVE_HEAD (&spgw_config.pgw_config.ipv4_pool_list, ipv4_entries);
-    free_wrapper ((void**) &conf_ipv4_p);
+  //P-GW code, shared by all workers
+  if (0 == worker_p->index) {
+    pgw_ue_ipv4_pools_statistics_display ();
+    pgw_free_pool_ip_addresses ();
   }
 }
@@ -0,0 +1,178 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file hashtable_guti_benchmark.c
+   \brief GUTI lookups: obj_hashtable with the former XOR hash, with the default hash, and hashtable_ts with packed keys
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "hashtable.h"
+#include "obj_hashtable.h"
+#include "common_types.h"
+#include "guti_key.h"
+
+static long                             num_ues = 100000;
+static long                             num_lookups = 1000000;
+
+//------------------------------------------------------------------------------
+// hash function of obj_hashtable before the default one was replaced, kept for comparison
+static hash_size_t xor_hashfunc (const void * const keyP, int key_sizeP)
+{
+  hash_size_t                             hash = 0;
+
+  while (key_sizeP)
+    hash ^= ((unsigned char *)keyP)[--key_sizeP];
+
+  return hash;
+}
+
+//------------------------------------------------------------------------------
+static double now_sec (void)
+{
+  struct timespec                         ts = {0};
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+//------------------------------------------------------------------------------
+static void guti_init (guti_t * const guti, const long i)
+{
+  memset (guti, 0, sizeof (*guti));
+  guti->gummei.plmn.mcc_digit1 = 2;
+  guti->gummei.plmn.mcc_digit2 = 0;
+  guti->gummei.plmn.mcc_digit3 = 8;
+  guti->gummei.plmn.mnc_digit1 = 9;
+  guti->gummei.plmn.mnc_digit2 = 3;
+  guti->gummei.plmn.mnc_digit3 = 0xF;
+  guti->gummei.mme_gid = 4;
+  guti->gummei.mme_code = 1;
+  // M-TMSIs allocated the way the MME does, sequential ones
+  guti->m_tmsi = (tmsi_t)i;
+}
+
+//------------------------------------------------------------------------------
+static void display_stats (const char * const title, hashtable_stats_t * const stats, const double seconds)
+{
+  bstring                                 name = bfromcstr (title);
+  bstring                                 b = bfromcstr ("");
+
+  hashtable_stats_display (stats, name, b);
+  printf ("%9.1f ns/lookup  %s", seconds * 1e9 / (double)num_lookups, bdata(b));
+  bdestroy (b);
+  bdestroy (name);
+}
+
+//------------------------------------------------------------------------------
+static void benchmark_obj_hashtable (const char * const title, hash_size_t (*hashfunc)(const void*, int))
+{
+  obj_hash_table_t                       *htbl = obj_hashtable_ts_create (num_ues, hashfunc, NULL, hash_free_int_func, bfromcstr (title));
+  hashtable_stats_t                       stats = {0};
+  guti_t                                  guti = {0};
+  void                                   *id = NULL;
+  double                                  start = 0;
+
+  for (long i = 0; i < num_ues; i++) {
+    guti_t                               *key = calloc (1, sizeof (*key));
+
+    guti_init (key, i);
+    obj_hashtable_ts_insert (htbl, key, sizeof (*key), (void *)(uintptr_t)(i + 1));
+  }
+  start = now_sec ();
+  for (long i = 0; i < num_lookups; i++) {
+    guti_init (&guti, (i * 7919) % num_ues);
+    if (HASH_TABLE_OK != obj_hashtable_ts_get (htbl, &guti, sizeof (guti), &id)) {
+      fprintf (stderr, "%s: GUTI " GUTI_FMT " not found\n", title, GUTI_ARG(&guti));
+      exit (EXIT_FAILURE);
+    }
+  }
+  double                                  seconds = now_sec () - start;
+
+  obj_hashtable_ts_get_stats (htbl, &stats);
+  display_stats (title, &stats, seconds);
+  obj_hashtable_ts_destroy (htbl);
+}
+
+//------------------------------------------------------------------------------
+static void benchmark_guti_key (const char * const title)
+{
+  hash_table_ts_t                        *htbl = hashtable_ts_create (num_ues, NULL, hash_free_int_func, bfromcstr (title));
+  hashtable_stats_t                       stats = {0};
+  guti_t                                  guti = {0};
+  void                                   *id = NULL;
+  double                                  start = 0;
+
+  for (long i = 0; i < num_ues; i++) {
+    guti_key_t                            key = INVALID_GUTI_KEY;
+
+    guti_init (&guti, i);
+    guti_key_new (&guti, &key);
+    hashtable_ts_insert (htbl, (const hash_key_t)key, (void *)(uintptr_t)(i + 1));
+  }
+  start = now_sec ();
+  for (long i = 0; i < num_lookups; i++) {
+    guti_init (&guti, (i * 7919) % num_ues);
+    if (HASH_TABLE_OK != hashtable_ts_get (htbl, (const hash_key_t)guti_key (&guti), &id)) {
+      fprintf (stderr, "%s: GUTI " GUTI_FMT " not found\n", title, GUTI_ARG(&guti));
+      exit (EXIT_FAILURE);
+    }
+  }
+  double                                  seconds = now_sec () - start;
+
+  hashtable_ts_get_stats (htbl, &stats);
+  display_stats (title, &stats, seconds);
+  hashtable_ts_destroy (htbl);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  int                                     c = 0;
+
+  while ((c = getopt (argc, argv, "u:n:h")) != -1) {
+    switch (c) {
+    case 'u':
+      num_ues = atol (optarg);
+      break;
+    case 'n':
+      num_lookups = atol (optarg);
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-u UEs] [-n lookups]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if ((num_ues < 1) || (num_lookups < 1)) {
+    return EXIT_FAILURE;
+  }
+
+  benchmark_obj_hashtable ("obj_hashtable xor hash", xor_hashfunc);
+  benchmark_obj_hashtable ("obj_hashtable default hash", NULL);
+  benchmark_guti_key ("hashtable_ts GUTI key");
+  return EXIT_SUCCESS;
+}
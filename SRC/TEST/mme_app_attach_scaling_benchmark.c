@@ -0,0 +1,222 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_attach_scaling_benchmark.c
+   \brief Measures the attaches per second of 1..N MME_APP workers, one per thread as the MME_APP tasks run them,
+          on the UE context collections: one shard per worker versus the collections shared by all the workers.
+          Each attach does what MME_APP does with the collections for an attach (context creation, IMSI, S11 TEID
+          and GUTI registration, one lookup per message received) and each UE detaches once WINDOW newer UEs
+          attached. The NAS, S1AP, S6A and S11 encoding is not part of it, see oai_loadgen for attaches over S1-MME.
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "log.h"
+#include "common_types.h"
+#include "mme_config.h"
+#include "mme_app_ue_context.h"
+#include "mme_app_defs.h"
+
+// UEs attached at the same time per worker
+#define MME_APP_BENCHMARK_WINDOW           (10000)
+#define MME_APP_BENCHMARK_MAX_ATTACHES     (10000000)
+// messages of an attach received by MME_APP, each one looks the UE up by mme_ue_s1ap_id
+#define MME_APP_BENCHMARK_LOOKUPS          (8)
+
+// not assert(): the MME_APP calls must also run in a release build
+#define MME_APP_BENCHMARK_CHECK(cOND)      do { if (!(cOND)) { fprintf (stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #cOND); exit (EXIT_FAILURE); } } while (0)
+
+typedef struct mme_app_benchmark_thread_s {
+  int                                     index;
+  int                                     num_workers;
+  ue_context_t                           *window[MME_APP_BENCHMARK_WINDOW];
+  long                                    num_attached;
+} mme_app_benchmark_thread_t;
+
+static long                             num_attaches = 200000;
+
+//------------------------------------------------------------------------------
+static double timespec_diff_sec (const struct timespec * const start, const struct timespec * const end)
+{
+  return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+//------------------------------------------------------------------------------
+// UE k of a worker: its ids are owned by the worker as mme_app_ctx_get_new_ue_id() and mme_api_new_guti() allocate them
+static void mme_app_benchmark_attach (mme_app_benchmark_thread_t * const thread, const long k)
+{
+  mme_ue_context_t * const                contexts = &mme_app_desc.mme_ue_contexts;
+  ue_context_t                           *ue_context_p = mme_create_new_ue_context ();
+  const imsi64_t                          imsi = 1010000000000 + (imsi64_t)thread->index * MME_APP_BENCHMARK_MAX_ATTACHES + k;
+  guti_t                                  guti = {0};
+  s11_teid_t                              teid = 0;
+
+  // Initial UE Message
+  ue_context_p->enb_ue_s1ap_id = (enb_ue_s1ap_id_t)(k & ENB_UE_S1AP_ID_MASK);
+  MME_APP_ENB_S1AP_ID_KEY (ue_context_p->enb_s1ap_id_key, thread->index + 1, ue_context_p->enb_ue_s1ap_id);
+  ue_context_p->mme_ue_s1ap_id = mme_app_ctx_get_new_ue_id (thread->index, thread->num_workers);
+  MME_APP_BENCHMARK_CHECK (RETURNok == mme_insert_ue_context (contexts, ue_context_p));
+
+  // Attach Request identified, Authentication Information Answer
+  mme_ue_context_update_coll_keys (contexts, ue_context_p, ue_context_p->enb_s1ap_id_key, ue_context_p->mme_ue_s1ap_id,
+                                   imsi, ue_context_p->mme_s11_teid, &ue_context_p->guti);
+
+  // Create Session Request, the response is found by the local S11 TEID
+  teid = mme_app_ctx_get_new_s11_teid (thread->index, thread->num_workers);
+  mme_ue_context_update_coll_keys (contexts, ue_context_p, ue_context_p->enb_s1ap_id_key, ue_context_p->mme_ue_s1ap_id,
+                                   imsi, teid, &ue_context_p->guti);
+  MME_APP_BENCHMARK_CHECK (ue_context_p == mme_ue_context_exists_s11_teid (contexts, teid));
+
+  // GUTI of the Attach Accept
+  guti.gummei.plmn.mcc_digit2 = 0;
+  guti.gummei.plmn.mcc_digit1 = 0;
+  guti.gummei.plmn.mnc_digit3 = 0xF;
+  guti.gummei.plmn.mcc_digit3 = 1;
+  guti.gummei.plmn.mnc_digit2 = 1;
+  guti.gummei.plmn.mnc_digit1 = 0;
+  guti.gummei.mme_gid = 4;
+  guti.gummei.mme_code = 1;
+  guti.m_tmsi = (tmsi_t)(k * thread->num_workers + thread->index);
+  mme_ue_context_update_coll_keys (contexts, ue_context_p, ue_context_p->enb_s1ap_id_key, ue_context_p->mme_ue_s1ap_id,
+                                   imsi, teid, &guti);
+
+  for (int i = 0; i < MME_APP_BENCHMARK_LOOKUPS; i++) {
+    MME_APP_BENCHMARK_CHECK (ue_context_p == mme_ue_context_exists_mme_ue_s1ap_id (contexts, ue_context_p->mme_ue_s1ap_id));
+  }
+  // Attach Complete
+  MME_APP_BENCHMARK_CHECK (ue_context_p == mme_ue_context_exists_imsi (contexts, imsi));
+  MME_APP_BENCHMARK_CHECK (ue_context_p == mme_ue_context_exists_guti (contexts, &guti));
+
+  // the oldest UE of the window detaches
+  if (thread->window[k % MME_APP_BENCHMARK_WINDOW]) {
+    mme_remove_ue_context (contexts, thread->window[k % MME_APP_BENCHMARK_WINDOW]);
+  }
+  thread->window[k % MME_APP_BENCHMARK_WINDOW] = ue_context_p;
+  thread->num_attached++;
+}
+
+//------------------------------------------------------------------------------
+static void *mme_app_benchmark_thread (void *args)
+{
+  mme_app_benchmark_thread_t             *thread = (mme_app_benchmark_thread_t *) args;
+
+  for (long k = 0; k < num_attaches; k++) {
+    mme_app_benchmark_attach (thread, k);
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void mme_app_benchmark_release (mme_app_benchmark_thread_t * const thread)
+{
+  for (int i = 0; i < MME_APP_BENCHMARK_WINDOW; i++) {
+    if (thread->window[i]) {
+      mme_remove_ue_context (&mme_app_desc.mme_ue_contexts, thread->window[i]);
+      thread->window[i] = NULL;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void usage (const char * const exe)
+{
+  fprintf (stderr, "Usage: %s [-t max_workers (1..%d)] [-n attaches per worker (1..%d)]\n", exe, MME_APP_WORKERS_MAX, MME_APP_BENCHMARK_MAX_ATTACHES);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  int                                     max_threads = MME_APP_WORKERS_MAX;
+  int                                     c = 0;
+
+  while ((c = getopt (argc, argv, "t:n:h")) != -1) {
+    switch (c) {
+    case 't':
+      max_threads = atoi (optarg);
+      break;
+
+    case 'n':
+      num_attaches = atol (optarg);
+      break;
+
+    default:
+      usage (argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if ((max_threads < 1) || (max_threads > MME_APP_WORKERS_MAX) || (num_attaches < 1) || (num_attaches > MME_APP_BENCHMARK_MAX_ATTACHES)) {
+    usage (argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // MME_APP logs its errors through OAILOG
+  if (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) < 0) {
+    return EXIT_FAILURE;
+  }
+
+  printf ("workers shards attaches   seconds   attaches/s\n");
+  for (int n = 1; n <= max_threads; n++) {
+    // collections shared by the workers as before, then one shard per worker
+    const int                             shards[2] = {1, n};
+
+    for (int s = 0; s < ((n > 1) ? 2 : 1); s++) {
+      const int                           nb_shards = shards[s];
+      pthread_t                           threads[MME_APP_WORKERS_MAX];
+      static mme_app_benchmark_thread_t   contexts[MME_APP_WORKERS_MAX];
+      long                                total_attaches = 0;
+      struct timespec                     start = {0};
+      struct timespec                     end = {0};
+
+      memset (contexts, 0, sizeof (contexts));
+      mme_config.num_app_workers = n;
+      mme_ue_context_init (&mme_app_desc.mme_ue_contexts, nb_shards, (hash_size_t)n * MME_APP_BENCHMARK_WINDOW);
+      clock_gettime (CLOCK_MONOTONIC, &start);
+
+      for (int t = 0; t < n; t++) {
+        contexts[t].index = t;
+        contexts[t].num_workers = n;
+        pthread_create (&threads[t], NULL, mme_app_benchmark_thread, &contexts[t]);
+      }
+
+      for (int t = 0; t < n; t++) {
+        pthread_join (threads[t], NULL);
+        total_attaches += contexts[t].num_attached;
+      }
+
+      clock_gettime (CLOCK_MONOTONIC, &end);
+      double                              seconds = timespec_diff_sec (&start, &end);
+
+      printf ("%-7d %-6d %-10ld %-9.3f %.0f\n", n, nb_shards, total_attaches, seconds, (double)total_attaches / seconds);
+      for (int t = 0; t < n; t++) {
+        mme_app_benchmark_release (&contexts[t]);
+      }
+      mme_ue_context_exit (&mme_app_desc.mme_ue_contexts);
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,240 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oai_bench.c
+   \brief Harness shared by the oai_bench executables, see oai_bench.h
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "oai_bench.h"
+
+typedef struct oai_bench_result_s {
+  uint64_t                                ops;
+  double                                  seconds;
+  double                                  p50_ns;
+  double                                  p90_ns;
+  double                                  p99_ns;
+  double                                  p999_ns;
+} oai_bench_result_t;
+
+//------------------------------------------------------------------------------
+static inline uint64_t oai_bench_now_ns (void)
+{
+  struct timespec                         ts = {0};
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static int oai_bench_compare_double (const void *a, const void *b)
+{
+  const double                            da = *(const double *)a;
+  const double                            db = *(const double *)b;
+
+  return (da > db) - (da < db);
+}
+
+//------------------------------------------------------------------------------
+// nearest rank percentile of sorted samples
+static double oai_bench_percentile (const double * const sorted, const uint64_t n, const double p)
+{
+  uint64_t                                rank = (uint64_t)(p * (double)n + 0.999999);
+
+  if (rank < 1) {
+    rank = 1;
+  } else if (rank > n) {
+    rank = n;
+  }
+  return sorted[rank - 1];
+}
+
+//------------------------------------------------------------------------------
+static int oai_bench_run_case (const oai_bench_case_t * const bench_case, const uint64_t iterations, oai_bench_result_t * const result)
+{
+  const uint32_t                          batch = (bench_case->batch) ? bench_case->batch : OAI_BENCH_DEFAULT_BATCH;
+  const uint64_t                          num_samples = (iterations + batch - 1) / batch;
+  const uint64_t                          num_warmup = (iterations / 10 < 10000) ? iterations / 10 : 10000;
+  double                                 *samples = calloc (num_samples, sizeof (double));
+  void                                   *ctx = NULL;
+  uint64_t                                i = 0;
+  uint64_t                                total_ns = 0;
+
+  if (!samples) {
+    return -1;
+  }
+  if ((bench_case->setup) && (bench_case->setup (&ctx) != 0)) {
+    free (samples);
+    return -1;
+  }
+  // warm the caches and the allocators, not reported
+  for (; i < num_warmup; i++) {
+    bench_case->run (ctx, i);
+  }
+  for (uint64_t s = 0; s < num_samples; s++) {
+    const uint64_t                        start_ns = oai_bench_now_ns ();
+
+    for (uint32_t b = 0; b < batch; b++, i++) {
+      bench_case->run (ctx, i);
+    }
+
+    const uint64_t                        elapsed_ns = oai_bench_now_ns () - start_ns;
+
+    samples[s] = (double)elapsed_ns / (double)batch;
+    total_ns += elapsed_ns;
+  }
+  if (bench_case->teardown) {
+    bench_case->teardown (ctx);
+  }
+  qsort (samples, num_samples, sizeof (double), oai_bench_compare_double);
+  result->ops = num_samples * batch;
+  result->seconds = (double)total_ns / 1e9;
+  result->p50_ns = oai_bench_percentile (samples, num_samples, 0.50);
+  result->p90_ns = oai_bench_percentile (samples, num_samples, 0.90);
+  result->p99_ns = oai_bench_percentile (samples, num_samples, 0.99);
+  result->p999_ns = oai_bench_percentile (samples, num_samples, 0.999);
+  free (samples);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static bool oai_bench_selected (const char * const suite_name, const char * const case_name, const char * const filter)
+{
+  char                                    full_name[256];
+
+  if (!filter) {
+    return true;
+  }
+  snprintf (full_name, sizeof (full_name), "%s.%s", suite_name, case_name);
+  return (strstr (full_name, filter) != NULL);
+}
+
+//------------------------------------------------------------------------------
+static void oai_bench_usage (const char * const exe)
+{
+  fprintf (stderr, "Usage: %s [-n iterations] [-f filter] [-o report.json] [-l (list the cases)] [-v (keep the traces of the code under test)]\n", exe);
+}
+
+//------------------------------------------------------------------------------
+int oai_bench_main (int argc, char *argv[], const oai_bench_suite_t * const suites[])
+{
+  uint64_t                                iterations = OAI_BENCH_DEFAULT_ITERATIONS;
+  const char                             *filter = NULL;
+  const char                             *report_file = NULL;
+  bool                                    list_only = false;
+  bool                                    verbose = false;
+  bool                                    first = true;
+  int                                     rc = EXIT_SUCCESS;
+  char                                    hostname[64] = {0};
+  FILE                                   *report = NULL;
+  int                                     c = 0;
+
+  while ((c = getopt (argc, argv, "n:f:o:lvh")) != -1) {
+    switch (c) {
+    case 'n':
+      iterations = strtoull (optarg, NULL, 0);
+      break;
+    case 'f':
+      filter = optarg;
+      break;
+    case 'o':
+      report_file = optarg;
+      break;
+    case 'l':
+      list_only = true;
+      break;
+    case 'v':
+      verbose = true;
+      break;
+    default:
+      oai_bench_usage (argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (iterations < 1) {
+    oai_bench_usage (argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (list_only) {
+    for (int s = 0; suites[s]; s++) {
+      for (const oai_bench_case_t * bench_case = suites[s]->cases; bench_case->name; bench_case++) {
+        if (oai_bench_selected (suites[s]->name, bench_case->name, filter)) {
+          printf ("%s.%s\n", suites[s]->name, bench_case->name);
+        }
+      }
+    }
+    return EXIT_SUCCESS;
+  }
+  if (report_file) {
+    report = fopen (report_file, "w");
+  } else {
+    report = fdopen (dup (STDOUT_FILENO), "w");
+  }
+  if (!report) {
+    perror ("oai_bench report");
+    return EXIT_FAILURE;
+  }
+  // the code under test traces on stdout (HSS AuC, logs), keep it out of the report and of the timings
+  if (!verbose) {
+    fflush (stdout);
+    if (!freopen ("/dev/null", "w", stdout)) {
+      perror ("oai_bench /dev/null");
+    }
+  }
+  gethostname (hostname, sizeof (hostname) - 1);
+  fprintf (report, "{\n  \"executable\": \"%s\",\n  \"host\": \"%s\",\n  \"cpus\": %ld,\n  \"timestamp\": %ld,\n  \"iterations\": %" PRIu64 ",\n  \"results\": [",
+           argv[0], hostname, sysconf (_SC_NPROCESSORS_ONLN), (long)time (NULL), iterations);
+  for (int s = 0; suites[s]; s++) {
+    for (const oai_bench_case_t * bench_case = suites[s]->cases; bench_case->name; bench_case++) {
+      oai_bench_result_t                  result = {0};
+
+      if (!oai_bench_selected (suites[s]->name, bench_case->name, filter)) {
+        continue;
+      }
+      fprintf (stderr, "%s.%s\n", suites[s]->name, bench_case->name);
+      fprintf (report, "%s\n    {\"suite\": \"%s\", \"case\": \"%s\", ", first ? "" : ",", suites[s]->name, bench_case->name);
+      first = false;
+      if (oai_bench_run_case (bench_case, iterations, &result) < 0) {
+        fprintf (stderr, "%s.%s: setup failed\n", suites[s]->name, bench_case->name);
+        fprintf (report, "\"error\": \"setup failed\"}");
+        rc = EXIT_FAILURE;
+        continue;
+      }
+      fprintf (report, "\"ops\": %" PRIu64 ", \"seconds\": %.6f, \"ops_per_sec\": %.1f, \"ns_per_op\": %.2f, "
+               "\"batch\": %u, \"p50_ns\": %.2f, \"p90_ns\": %.2f, \"p99_ns\": %.2f, \"p999_ns\": %.2f}",
+               result.ops, result.seconds, (double)result.ops / result.seconds, result.seconds * 1e9 / (double)result.ops,
+               (bench_case->batch) ? bench_case->batch : OAI_BENCH_DEFAULT_BATCH,
+               result.p50_ns, result.p90_ns, result.p99_ns, result.p999_ns);
+      fflush (report);
+    }
+  }
+  fprintf (report, "\n  ]\n}\n");
+  fclose (report);
+  return rc;
+}
@@ -0,0 +1,64 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oai_bench.h
+   \brief Harness shared by the oai_bench executables: runs benchmark cases, times them by batches
+          of operations and reports ops/s, ns/op and latency percentiles as JSON. libc only, so the
+          HSS build links it too.
+*/
+
+#ifndef FILE_OAI_BENCH_SEEN
+#define FILE_OAI_BENCH_SEEN
+
+#include <stdint.h>
+
+/* Operations timed by one sample when a case does not set its batch */
+#define OAI_BENCH_DEFAULT_BATCH       (64)
+/* Operations run by each case when -n is not given */
+#define OAI_BENCH_DEFAULT_ITERATIONS  (200000)
+
+typedef struct oai_bench_case_s {
+  const char  *name;
+  /* optional, allocates what run() needs, returns 0 on success */
+  int        (*setup)(void **ctx);
+  /* one operation, i counts the operations of the case from 0 */
+  void       (*run)(void *ctx, uint64_t i);
+  /* optional, releases what setup() allocated */
+  void       (*teardown)(void *ctx);
+  /* operations timed by one sample, percentiles are over samples */
+  uint32_t     batch;
+} oai_bench_case_t;
+
+typedef struct oai_bench_suite_s {
+  const char              *name;
+  /* terminated by a case without name */
+  const oai_bench_case_t  *cases;
+} oai_bench_suite_t;
+
+/** \brief Parses the command line, runs the cases it selects and writes the JSON report.
+ *  Options: -n iterations, -f filter (substring of "suite.case"), -o report file (default stdout),
+ *  -l (list the cases), -v (keep what the code under test prints on stdout).
+ *  \param suites the suites of the executable, NULL terminated
+ *  @returns EXIT_SUCCESS or EXIT_FAILURE
+ **/
+int oai_bench_main(int argc, char *argv[], const oai_bench_suite_t * const suites[]);
+
+#endif /* FILE_OAI_BENCH_SEEN */
@@ -0,0 +1,261 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oai_bench_hss.c
+   \brief Not a test: oai_bench suites of the HSS AuC, Milenage and EPS authentication vectors, and of the
+          subscriber store, run it by hand.
+          Built with the HSS, see BUILD/HSS/CMakeLists.txt.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hss_config.h"
+#include "auc.h"
+#include "db_proto.h"
+#include "oai_bench.h"
+
+hss_config_t                            hss_config;
+
+/* 3GPP TS 35.208 test set 1 */
+static const uint8_t                    milenage_k[16] = {
+  0x46, 0x5b, 0x5c, 0xe8, 0xb1, 0x99, 0xb4, 0x9f, 0xaa, 0x5f, 0x0a, 0x2e, 0xe2, 0x38, 0xa6, 0xbc
+};
+static const uint8_t                    milenage_op[16] = {
+  0xcd, 0xc2, 0x02, 0xd5, 0x12, 0x3e, 0x20, 0xf6, 0x2b, 0x6d, 0x67, 0x6a, 0xc7, 0x2c, 0xb3, 0x18
+};
+static const uint8_t                    milenage_rand[16] = {
+  0x23, 0x55, 0x3c, 0xbe, 0x96, 0x37, 0xa8, 0x9d, 0x21, 0x8a, 0xe6, 0x4d, 0xae, 0x47, 0xbf, 0x35
+};
+static const uint8_t                    milenage_sqn[6] = {0xff, 0x9b, 0xb4, 0xd0, 0xb6, 0x07};
+static const uint8_t                    milenage_amf[2] = {0xb9, 0xb9};
+static uint8_t                          milenage_plmn[3] = {0x02, 0xf8, 0x39};
+
+typedef struct milenage_bench_s {
+  uint8_t                                 key[16];
+  uint8_t                                 opc[16];
+  uint8_t                                 sqn[6];
+  auc_vector_t                            vector;
+} milenage_bench_t;
+
+//------------------------------------------------------------------------------
+static int milenage_bench_setup (void **ctx)
+{
+  milenage_bench_t                       *bench = calloc (1, sizeof (milenage_bench_t));
+
+  if (!bench) {
+    return -1;
+  }
+  memcpy (bench->key, milenage_k, sizeof (bench->key));
+  memcpy (bench->sqn, milenage_sqn, sizeof (bench->sqn));
+  memcpy (bench->vector.rand, milenage_rand, sizeof (bench->vector.rand));
+  ComputeOPc (milenage_k, milenage_op, bench->opc);
+  *ctx = bench;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static void milenage_bench_teardown (void *ctx)
+{
+  free (ctx);
+}
+
+//------------------------------------------------------------------------------
+// f1 to f5, what Milenage computes for one vector
+static void milenage_bench_f1_f2345 (void *ctx, uint64_t i)
+{
+  milenage_bench_t                       *bench = ctx;
+  uint8_t                                 mac_a[8];
+  uint8_t                                 ck[16];
+  uint8_t                                 ik[16];
+  uint8_t                                 ak[6];
+
+  bench->vector.rand[0] = (uint8_t)i;
+  f1 (bench->opc, bench->key, bench->vector.rand, bench->sqn, milenage_amf, mac_a);
+  f2345 (bench->opc, bench->key, bench->vector.rand, bench->vector.xres, ck, ik, ak);
+}
+
+//------------------------------------------------------------------------------
+// the E-UTRAN vector of an Authentication-Information-Answer, KASME derivation and AuC traces included
+static void milenage_bench_generate_vector (void *ctx, uint64_t i)
+{
+  milenage_bench_t                       *bench = ctx;
+
+  bench->vector.rand[0] = (uint8_t)i;
+  generate_vector (bench->opc, 208930000000001ULL, bench->key, milenage_plmn, bench->sqn, &bench->vector);
+}
+
+static const oai_bench_case_t           milenage_bench_cases[] = {
+  {.name = "f1_f2345", .setup = milenage_bench_setup, .run = milenage_bench_f1_f2345, .teardown = milenage_bench_teardown},
+  {.name = "generate_vector", .setup = milenage_bench_setup, .run = milenage_bench_generate_vector, .teardown = milenage_bench_teardown},
+  {.name = NULL}
+};
+
+static const oai_bench_suite_t          milenage_bench_suite = {.name = "milenage", .cases = milenage_bench_cases};
+
+/* Store of the size the HSS is sized for, MySQL is timed by hand with the same requests */
+#define STORE_BENCH_SUBSCRIBERS         (1000000)
+#define STORE_BENCH_PATH                "/tmp/oai_bench_hss_subscribers.db"
+
+typedef struct store_bench_s {
+  char                                  (*imsis)[IMSI_LENGTH_MAX + 1];
+  mysql_auth_info_req_t                   auth_info_req;
+  mysql_auth_info_resp_t                  auth_info_resp;
+  mysql_ul_ans_t                          ul_ans;
+  mysql_ul_push_t                         ul_push;
+} store_bench_t;
+
+//------------------------------------------------------------------------------
+static void store_bench_teardown (void *ctx)
+{
+  store_bench_t                          *bench = ctx;
+
+  hss_store_exit ();
+  unlink (STORE_BENCH_PATH);
+  free (bench->imsis);
+  free (bench);
+}
+
+//------------------------------------------------------------------------------
+// a fresh store of STORE_BENCH_SUBSCRIBERS subscribers with one PDN each, opened as the HSS does
+static int store_bench_setup (void **ctx)
+{
+  store_bench_t                          *bench = calloc (1, sizeof (store_bench_t));
+  mysql_auth_info_resp_t                  auth;
+  mysql_ul_ans_t                          ul;
+  mysql_pdn_t                             pdn;
+  int                                     i;
+
+  if (!bench || !(bench->imsis = malloc (STORE_BENCH_SUBSCRIBERS * sizeof (bench->imsis[0])))) {
+    free (bench);
+    return -1;
+  }
+  memset (&auth, 0, sizeof (auth));
+  memset (&ul, 0, sizeof (ul));
+  memset (&pdn, 0, sizeof (pdn));
+  memcpy (auth.key, milenage_k, sizeof (auth.key));
+  memcpy (auth.rand, milenage_rand, sizeof (auth.rand));
+  memcpy (auth.sqn, milenage_sqn, sizeof (auth.sqn));
+  ComputeOPc (milenage_k, milenage_op, auth.opc);
+  ul.aggr_ul = 50000000;
+  ul.aggr_dl = 100000000;
+  ul.rau_tau = 120;
+  strcpy (pdn.apn, "oai.ipv4");
+  strcpy (pdn.pdn_address.ipv4_address, "0.0.0.0");
+  strcpy (pdn.pdn_address.ipv6_address, "0:0:0:0:0:0:0:0");
+  pdn.pdn_type = IPV4;
+  pdn.qci = 9;
+  pdn.priority_level = 15;
+  pdn.aggr_ul = 50000000;
+  pdn.aggr_dl = 100000000;
+
+  hss_store_build_begin ();
+  for (i = 0; i < STORE_BENCH_SUBSCRIBERS; i++) {
+    snprintf (bench->imsis[i], sizeof (bench->imsis[i]), "20893%010d", i);
+    strcpy (ul.imsi, bench->imsis[i]);
+    snprintf (ul.msisdn, sizeof (ul.msisdn), "33638%06d", i);
+    if (hss_store_build_add_user (&auth, &ul, NULL, NULL, 1, &pdn, 1) != 0) {
+      free (bench->imsis);
+      free (bench);
+      return -1;
+    }
+  }
+  if (hss_store_build_commit (STORE_BENCH_PATH) != 0) {
+    free (bench->imsis);
+    free (bench);
+    return -1;
+  }
+
+  hss_config.subscriber_store = STORE_BENCH_PATH;
+  hss_config.subscriber_cache_flush_ms = 1000;
+  if (hss_store_init (&hss_config) != 0) {
+    unlink (STORE_BENCH_PATH);
+    free (bench->imsis);
+    free (bench);
+    return -1;
+  }
+
+  strcpy (bench->ul_push.mme_identity.mme_host, "mme.openair4G.eur");
+  strcpy (bench->ul_push.mme_identity.mme_realm, "openair4G.eur");
+  bench->ul_push.mme_identity_present = MME_IDENTITY_PRESENT;
+  *ctx = bench;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// key, OPc, RAND and SQN of an Authentication-Information-Request, spread over all subscribers
+static void store_bench_auth_info (void *ctx, uint64_t i)
+{
+  store_bench_t                          *bench = ctx;
+
+  strcpy (bench->auth_info_req.imsi, bench->imsis[(i * 7919) % STORE_BENCH_SUBSCRIBERS]);
+  hss_store_auth_info (&bench->auth_info_req, &bench->auth_info_resp);
+}
+
+//------------------------------------------------------------------------------
+// what the AIR handler writes back once the vector is generated
+static void store_bench_push_rand_sqn (void *ctx, uint64_t i)
+{
+  store_bench_t                          *bench = ctx;
+  const char                             *imsi = bench->imsis[(i * 7919) % STORE_BENCH_SUBSCRIBERS];
+
+  hss_store_push_rand_sqn (imsi, bench->auth_info_resp.rand, bench->auth_info_resp.sqn);
+  hss_store_increment_sqn (imsi);
+}
+
+//------------------------------------------------------------------------------
+// the database side of an Update-Location-Request: new serving MME, then the subscription
+static void store_bench_update_location (void *ctx, uint64_t i)
+{
+  store_bench_t                          *bench = ctx;
+  mysql_pdn_t                            *pdns = NULL;
+  uint8_t                                 nb_pdns = 0;
+
+  strcpy (bench->ul_push.imsi, bench->imsis[(i * 7919) % STORE_BENCH_SUBSCRIBERS]);
+  hss_store_push_up_loc (&bench->ul_push);
+  hss_store_update_loc (bench->ul_push.imsi, &bench->ul_ans);
+  hss_store_query_pdns (bench->ul_push.imsi, &pdns, &nb_pdns);
+  free (pdns);
+}
+
+static const oai_bench_case_t           store_bench_cases[] = {
+  {.name = "auth_info", .setup = store_bench_setup, .run = store_bench_auth_info, .teardown = store_bench_teardown},
+  {.name = "push_rand_sqn", .setup = store_bench_setup, .run = store_bench_push_rand_sqn, .teardown = store_bench_teardown},
+  {.name = "update_location", .setup = store_bench_setup, .run = store_bench_update_location, .teardown = store_bench_teardown},
+  {.name = NULL}
+};
+
+static const oai_bench_suite_t          store_bench_suite = {.name = "subscriber_store", .cases = store_bench_cases};
+
+static const oai_bench_suite_t * const  hss_bench_suites[] = {
+  &milenage_bench_suite,
+  &store_bench_suite,
+  NULL
+};
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  return oai_bench_main (argc, argv, hss_bench_suites);
+}
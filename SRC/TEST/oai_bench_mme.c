@@ -0,0 +1,829 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oai_bench_mme.c
+   \brief Not a test: oai_bench suites of the MME hot paths (ITTI, memory pools, hashtables, S1AP, paging, NAS,
+          NAS security, GTPv2-C, timers), run it by hand. Milenage is in oai_bench_hss, built with the HSS.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+#include "log.h"
+#include "intertask_interface_init.h"
+#include "memory_pools.h"
+#include "timer.h"
+#include "hashtable.h"
+#include "obj_hashtable.h"
+#include "common_types.h"
+#include "conversions.h"
+#include "dynamic_memory_check.h"
+#include "mem_arena.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme_decoder.h"
+#include "s1ap_mme_paging.h"
+#include "mme_config.h"
+#include "emm_msg.h"
+#include "secu_defs.h"
+#include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
+#include "NwGtpv2cMsg.h"
+#include "NwGtpv2cMsgParser.h"
+#include "NwGtpv2cPrivate.h"
+#include "s11_common.h"
+#include "s11_ie_formatter.h"
+#include "oai_bench.h"
+
+/* Entries of the hashtables when they are looked up, about the UEs of a loaded MME */
+#define OAI_BENCH_HASHTABLE_KEYS    (1 << 20)
+/* Length of the NAS messages ciphered and integrity protected */
+#define OAI_BENCH_NAS_MESSAGE_SIZE  (64)
+/* S1-MME of a large network: eNBs spread over TACs, the TAI list of a UE covers a few of them */
+#define OAI_BENCH_PAGING_ENBS       (10000)
+#define OAI_BENCH_PAGING_TACS       (200)
+#define OAI_BENCH_PAGING_LIST_TAIS  (3)
+
+/* Plain Attach Request of an IMSI, with a PDN Connectivity Request, a DRX parameter and a last visited TAI */
+static uint8_t                          attach_request_pdu[] = {
+  0x07, 0x41, 0x71, 0x08, 0x09, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x10, 0x02, 0xE0, 0xE0, 0x00,
+  0x04, 0x02, 0x01, 0xD0, 0x11, 0x52, 0x02, 0xF8, 0x39, 0x00, 0x01, 0x5C, 0x0A, 0x00
+};
+
+static volatile uint64_t                oai_bench_sink = 0;
+
+//------------------------------------------------------------------------------
+// ITTI
+//------------------------------------------------------------------------------
+static int itti_bench_setup (void **ctx)
+{
+  static bool                             ready = false;
+
+  // the benchmark receives the messages of TASK_MME_APP in place of its thread
+  if (!ready) {
+    itti_mark_task_ready (TASK_MME_APP);
+    ready = true;
+  }
+  return 0;
+}
+
+static void itti_bench_send_receive (void *ctx, uint64_t i)
+{
+  MessageDef                             *message_p = itti_alloc_new_message (TASK_S1AP, NAS_UPLINK_DATA_IND);
+
+  itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  message_p = NULL;
+  itti_receive_msg (TASK_MME_APP, &message_p);
+  itti_free (ITTI_MSG_ORIGIN_ID (message_p), message_p);
+}
+
+static void itti_bench_malloc_free (void *ctx, uint64_t i)
+{
+  void                                   *ptr = itti_malloc (TASK_S1AP, TASK_MME_APP, 200);
+
+  itti_free (TASK_S1AP, ptr);
+}
+
+static const oai_bench_case_t           itti_bench_cases[] = {
+  {.name = "send_receive", .setup = itti_bench_setup, .run = itti_bench_send_receive},
+  {.name = "malloc_free", .run = itti_bench_malloc_free},
+  {.name = NULL}
+};
+
+//------------------------------------------------------------------------------
+// Memory pools
+//------------------------------------------------------------------------------
+static int memory_pools_bench_setup (void **ctx)
+{
+  memory_pools_handle_t                   pools = memory_pools_create (1);
+
+  if ((!pools) || (memory_pools_add_pool (pools, 1024, 256) != 0)) {
+    return -1;
+  }
+  *ctx = pools;
+  return 0;
+}
+
+static void memory_pools_bench_allocate_free (void *ctx, uint64_t i)
+{
+  memory_pool_item_handle_t               item = memory_pools_allocate (ctx, 200, 0, 0);
+
+  memory_pools_free (ctx, item, 0);
+}
+
+static const oai_bench_case_t           memory_pools_bench_cases[] = {
+  {.name = "allocate_free", .setup = memory_pools_bench_setup, .run = memory_pools_bench_allocate_free},
+  {.name = NULL}
+};
+
+//------------------------------------------------------------------------------
+// Hashtables
+//------------------------------------------------------------------------------
+typedef struct obj_hashtable_bench_s {
+  obj_hash_table_t                       *htbl;
+  guti_t                                 *gutis;  // the obj_hashtable keeps pointers to the keys
+} obj_hashtable_bench_t;
+
+// scatters the lookups over the table, as the ids of the UEs do
+static inline hash_key_t hashtable_bench_key (const uint64_t i)
+{
+  return (hash_key_t)((i * 2654435761ULL) % OAI_BENCH_HASHTABLE_KEYS);
+}
+
+static void hashtable_bench_guti (guti_t * const guti, const uint64_t i)
+{
+  memset (guti, 0, sizeof (*guti));
+  guti->gummei.plmn.mcc_digit1 = 2;
+  guti->gummei.plmn.mcc_digit2 = 0;
+  guti->gummei.plmn.mcc_digit3 = 8;
+  guti->gummei.plmn.mnc_digit1 = 9;
+  guti->gummei.plmn.mnc_digit2 = 3;
+  guti->gummei.plmn.mnc_digit3 = 0xF;
+  guti->gummei.mme_gid = 4;
+  guti->gummei.mme_code = 1;
+  guti->m_tmsi = (tmsi_t)i;
+}
+
+static int hashtable_ts_bench_setup (void **ctx)
+{
+  hash_table_ts_t                        *htbl = hashtable_ts_create (OAI_BENCH_HASHTABLE_KEYS, NULL, hash_free_int_func, bfromcstr ("oai_bench_hashtable_ts"));
+
+  if (!htbl) {
+    return -1;
+  }
+  for (uint64_t k = 0; k < OAI_BENCH_HASHTABLE_KEYS; k++) {
+    hashtable_ts_insert (htbl, (hash_key_t)k, (void *)(uintptr_t)(k + 1));
+  }
+  *ctx = htbl;
+  return 0;
+}
+
+static void hashtable_ts_bench_insert_free (void *ctx, uint64_t i)
+{
+  const hash_key_t                        key = OAI_BENCH_HASHTABLE_KEYS + i;
+
+  hashtable_ts_insert (ctx, key, (void *)(uintptr_t)key);
+  hashtable_ts_free (ctx, key);
+}
+
+static void hashtable_ts_bench_get (void *ctx, uint64_t i)
+{
+  void                                   *data = NULL;
+
+  hashtable_ts_get (ctx, hashtable_bench_key (i), &data);
+  oai_bench_sink += (uintptr_t)data;
+}
+
+static void hashtable_ts_bench_teardown (void *ctx)
+{
+  hashtable_ts_destroy (ctx);
+}
+
+static int obj_hashtable_ts_bench_setup (void **ctx)
+{
+  obj_hashtable_bench_t                  *bench = calloc (1, sizeof (obj_hashtable_bench_t));
+
+  if (!bench) {
+    return -1;
+  }
+  // one more GUTI, inserted and freed by insert_free
+  bench->gutis = calloc (OAI_BENCH_HASHTABLE_KEYS + 1, sizeof (guti_t));
+  bench->htbl = obj_hashtable_ts_create (OAI_BENCH_HASHTABLE_KEYS, NULL, hash_free_int_func, hash_free_int_func, bfromcstr ("oai_bench_obj_hashtable_ts"));
+  if ((!bench->gutis) || (!bench->htbl)) {
+    return -1;
+  }
+  for (uint64_t k = 0; k < OAI_BENCH_HASHTABLE_KEYS; k++) {
+    hashtable_bench_guti (&bench->gutis[k], k);
+    obj_hashtable_ts_insert (bench->htbl, &bench->gutis[k], sizeof (guti_t), (void *)(uintptr_t)(k + 1));
+  }
+  *ctx = bench;
+  return 0;
+}
+
+static void obj_hashtable_ts_bench_insert_free (void *ctx, uint64_t i)
+{
+  obj_hashtable_bench_t                  *bench = ctx;
+  guti_t                                 *guti = &bench->gutis[OAI_BENCH_HASHTABLE_KEYS];
+
+  hashtable_bench_guti (guti, OAI_BENCH_HASHTABLE_KEYS + i);
+  obj_hashtable_ts_insert (bench->htbl, guti, sizeof (guti_t), (void *)(uintptr_t)i);
+  obj_hashtable_ts_free (bench->htbl, guti, sizeof (guti_t));
+}
+
+static void obj_hashtable_ts_bench_get (void *ctx, uint64_t i)
+{
+  obj_hashtable_bench_t                  *bench = ctx;
+  void                                   *data = NULL;
+
+  obj_hashtable_ts_get (bench->htbl, &bench->gutis[hashtable_bench_key (i)], sizeof (guti_t), &data);
+  oai_bench_sink += (uintptr_t)data;
+}
+
+static void obj_hashtable_ts_bench_teardown (void *ctx)
+{
+  obj_hashtable_bench_t                  *bench = ctx;
+
+  obj_hashtable_ts_destroy (bench->htbl);
+  free (bench->gutis);
+  free (bench);
+}
+
+static const oai_bench_case_t           hashtable_ts_bench_cases[] = {
+  {.name = "insert_free", .setup = hashtable_ts_bench_setup, .run = hashtable_ts_bench_insert_free, .teardown = hashtable_ts_bench_teardown},
+  {.name = "get", .setup = hashtable_ts_bench_setup, .run = hashtable_ts_bench_get, .teardown = hashtable_ts_bench_teardown},
+  {.name = NULL}
+};
+
+static const oai_bench_case_t           obj_hashtable_ts_bench_cases[] = {
+  {.name = "insert_free", .setup = obj_hashtable_ts_bench_setup, .run = obj_hashtable_ts_bench_insert_free, .teardown = obj_hashtable_ts_bench_teardown},
+  {.name = "get", .setup = obj_hashtable_ts_bench_setup, .run = obj_hashtable_ts_bench_get, .teardown = obj_hashtable_ts_bench_teardown},
+  {.name = NULL}
+};
+
+//------------------------------------------------------------------------------
+// S1AP
+//------------------------------------------------------------------------------
+typedef struct s1ap_bench_s {
+  bstring                                 pdu;
+  mem_arena_t                            *arena;
+} s1ap_bench_t;
+
+// the eNB side of an attach, the MME has no encoder for what the eNBs send
+static int s1ap_bench_encode_initial_ue_message (const uint64_t i, uint8_t ** buffer, uint32_t * length)
+{
+  S1ap_InitialUEMessageIEs_t              ies = {0};
+  S1ap_InitialUEMessage_t                 initial_ue_message = {0};
+  int                                     rc = 0;
+
+  ies.eNB_UE_S1AP_ID = (S1ap_ENB_UE_S1AP_ID_t)(i & 0x00FFFFFF);
+  OCTET_STRING_fromBuf (&ies.nas_pdu, (char *)attach_request_pdu, sizeof (attach_request_pdu));
+  MCC_MNC_TO_TBCD (208, 93, 2, &ies.tai.pLMNidentity);
+  TAC_TO_ASN1 (1, &ies.tai.tAC);
+  MCC_MNC_TO_TBCD (208, 93, 2, &ies.eutran_cgi.pLMNidentity);
+  MACRO_ENB_ID_TO_CELL_IDENTITY (0xE000, 0, &ies.eutran_cgi.cell_ID);
+  ies.rrC_Establishment_Cause = S1ap_RRC_Establishment_Cause_mo_Signalling;
+  if (s1ap_encode_s1ap_initialuemessageies (&initial_ue_message, &ies) < 0) {
+    rc = -1;
+  } else if (s1ap_generate_initiating_message (buffer, length, S1ap_ProcedureCode_id_initialUEMessage, S1ap_Criticality_ignore,
+                                               &asn_DEF_S1ap_InitialUEMessage, &initial_ue_message) < 0) {
+    rc = -1;
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &ies.nas_pdu);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAI, &ies.tai);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_EUTRAN_CGI, &ies.eutran_cgi);
+  return rc;
+}
+
+static int s1ap_bench_encode_uplink_nas_transport (const uint64_t i, uint8_t ** buffer, uint32_t * length)
+{
+  S1ap_UplinkNASTransportIEs_t            ies = {0};
+  S1ap_UplinkNASTransport_t               uplink_nas_transport = {0};
+  int                                     rc = 0;
+
+  ies.mme_ue_s1ap_id = (S1ap_MME_UE_S1AP_ID_t)(i + 1);
+  ies.eNB_UE_S1AP_ID = (S1ap_ENB_UE_S1AP_ID_t)(i & 0x00FFFFFF);
+  OCTET_STRING_fromBuf (&ies.nas_pdu, (char *)attach_request_pdu, sizeof (attach_request_pdu));
+  MCC_MNC_TO_TBCD (208, 93, 2, &ies.eutran_cgi.pLMNidentity);
+  MACRO_ENB_ID_TO_CELL_IDENTITY (0xE000, 0, &ies.eutran_cgi.cell_ID);
+  MCC_MNC_TO_TBCD (208, 93, 2, &ies.tai.pLMNidentity);
+  TAC_TO_ASN1 (1, &ies.tai.tAC);
+  if (s1ap_encode_s1ap_uplinknastransporties (&uplink_nas_transport, &ies) < 0) {
+    rc = -1;
+  } else if (s1ap_generate_initiating_message (buffer, length, S1ap_ProcedureCode_id_uplinkNASTransport, S1ap_Criticality_ignore,
+                                               &asn_DEF_S1ap_UplinkNASTransport, &uplink_nas_transport) < 0) {
+    rc = -1;
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &ies.nas_pdu);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_EUTRAN_CGI, &ies.eutran_cgi);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAI, &ies.tai);
+  return rc;
+}
+
+static int s1ap_bench_setup (void **ctx, int (*encode) (const uint64_t, uint8_t **, uint32_t *))
+{
+  s1ap_bench_t                           *bench = calloc (1, sizeof (s1ap_bench_t));
+  uint8_t                                *buffer = NULL;
+  uint32_t                                length = 0;
+
+  if ((!bench) || (encode (0, &buffer, &length) < 0)) {
+    free (bench);
+    return -1;
+  }
+  bench->pdu = blk2bstr (buffer, length);
+  bench->arena = mem_arena_create (0);
+  free_wrapper ((void **)&buffer);
+  *ctx = bench;
+  return 0;
+}
+
+static int s1ap_bench_initial_ue_message_setup (void **ctx)
+{
+  return s1ap_bench_setup (ctx, s1ap_bench_encode_initial_ue_message);
+}
+
+static int s1ap_bench_uplink_nas_transport_setup (void **ctx)
+{
+  return s1ap_bench_setup (ctx, s1ap_bench_encode_uplink_nas_transport);
+}
+
+// decoded in a per-PDU arena, as the codec tasks do
+static void s1ap_bench_decode (void *ctx, uint64_t i)
+{
+  s1ap_bench_t                           *bench = ctx;
+  s1ap_message                            message = {0};
+  mem_arena_t                            *previous = mem_arena_enter (bench->arena);
+
+  if (s1ap_mme_decode_pdu (&message, bench->pdu) < 0) {
+    fprintf (stderr, "Failed to decode S1AP PDU\n");
+    exit (EXIT_FAILURE);
+  }
+  mem_arena_leave (previous);
+  mem_arena_reset (bench->arena);
+}
+
+// decoded with the C library, as before the per-PDU arena, the IEs freed as the handlers had to
+static void s1ap_bench_decode_initial_ue_message_libc (void *ctx, uint64_t i)
+{
+  s1ap_bench_t                           *bench = ctx;
+  s1ap_message                            message = {0};
+
+  if (s1ap_mme_decode_pdu (&message, bench->pdu) < 0) {
+    fprintf (stderr, "Failed to decode S1AP PDU\n");
+    exit (EXIT_FAILURE);
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &message.msg.s1ap_InitialUEMessageIEs.nas_pdu);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAI, &message.msg.s1ap_InitialUEMessageIEs.tai);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_EUTRAN_CGI, &message.msg.s1ap_InitialUEMessageIEs.eutran_cgi);
+}
+
+static void s1ap_bench_teardown (void *ctx)
+{
+  s1ap_bench_t                           *bench = ctx;
+
+  bdestroy (bench->pdu);
+  mem_arena_destroy (&bench->arena);
+  free (bench);
+}
+
+static void s1ap_bench_encode (int (*encode) (const uint64_t, uint8_t **, uint32_t *), uint64_t i)
+{
+  uint8_t                                *buffer = NULL;
+  uint32_t                                length = 0;
+
+  if (encode (i, &buffer, &length) < 0) {
+    fprintf (stderr, "Failed to encode S1AP PDU\n");
+    exit (EXIT_FAILURE);
+  }
+  free_wrapper ((void **)&buffer);
+}
+
+static void s1ap_bench_encode_initial_ue_message_run (void *ctx, uint64_t i)
+{
+  s1ap_bench_encode (s1ap_bench_encode_initial_ue_message, i);
+}
+
+static void s1ap_bench_encode_uplink_nas_transport_run (void *ctx, uint64_t i)
+{
+  s1ap_bench_encode (s1ap_bench_encode_uplink_nas_transport, i);
+}
+
+static const oai_bench_case_t           s1ap_bench_cases[] = {
+  {.name = "decode_initial_ue_message", .setup = s1ap_bench_initial_ue_message_setup, .run = s1ap_bench_decode, .teardown = s1ap_bench_teardown},
+  {.name = "decode_initial_ue_message_libc", .setup = s1ap_bench_initial_ue_message_setup, .run = s1ap_bench_decode_initial_ue_message_libc, .teardown = s1ap_bench_teardown},
+  {.name = "decode_uplink_nas_transport", .setup = s1ap_bench_uplink_nas_transport_setup, .run = s1ap_bench_decode, .teardown = s1ap_bench_teardown},
+  {.name = "encode_initial_ue_message", .run = s1ap_bench_encode_initial_ue_message_run},
+  {.name = "encode_uplink_nas_transport", .run = s1ap_bench_encode_uplink_nas_transport_run},
+  {.name = NULL}
+};
+
+//------------------------------------------------------------------------------
+// S1AP paging
+//------------------------------------------------------------------------------
+static enb_description_t               *paging_bench_enbs = NULL;
+
+static int paging_bench_setup (void **ctx)
+{
+  S1ap_SupportedTAs_t                     supported_tas = {0};
+  S1ap_SupportedTAs_Item_t                ta = {0};
+  S1ap_PLMNidentity_t                     plmn = {0};
+
+  if (paging_bench_enbs) {
+    return 0;
+  }
+  // every eNB is paged on each attempt, the PAGING are drained from the SCTP task queue
+  mme_config.s1ap_config.paging_timer_ms = 4000;
+  mme_config.s1ap_config.paging_max_attempts = 1;
+  mme_config.s1ap_config.max_paging_per_enb_per_sec = 0;
+  itti_mark_task_ready (TASK_SCTP);
+  if (s1ap_paging_init (&mme_config) != RETURNok) {
+    return -1;
+  }
+  paging_bench_enbs = calloc (OAI_BENCH_PAGING_ENBS, sizeof (enb_description_t));
+  if (!paging_bench_enbs) {
+    return -1;
+  }
+  MCC_MNC_TO_TBCD (208, 93, 2, &plmn);
+  ASN_SEQUENCE_ADD (&ta.broadcastPLMNs, &plmn);
+  ASN_SEQUENCE_ADD (&supported_tas, &ta);
+  for (int i = 0; i < OAI_BENCH_PAGING_ENBS; i++) {
+    paging_bench_enbs[i].enb_id = i + 1;
+    paging_bench_enbs[i].sctp_assoc_id = i + 1;
+    paging_bench_enbs[i].s1_state = S1AP_READY;
+    TAC_TO_ASN1 (1 + (i % OAI_BENCH_PAGING_TACS), &ta.tAC);
+    s1ap_paging_update_enb_tais (&paging_bench_enbs[i], &supported_tas);
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAC, &ta.tAC);
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_PLMNidentity, &plmn);
+  free (ta.broadcastPLMNs.list.array);
+  free (supported_tas.list.array);
+  return 0;
+}
+
+// one UE paged in its TAI list then answering, ~150 eNBs paged
+static void paging_bench_page_stop (void *ctx, uint64_t i)
+{
+  itti_s1ap_paging_request_t              paging_request = {0};
+  MessageDef                             *message_p = NULL;
+
+  paging_request.mme_ue_s1ap_id = (mme_ue_s1ap_id_t)(i + 1);
+  paging_request.imsi64 = 208930000000001ULL + i;
+  paging_request.mme_code = 1;
+  paging_request.m_tmsi = (uint32_t) i;
+  paging_request.cn_domain = S1AP_CN_DOMAIN_PS;
+  paging_request.last_visited_tai.tac = INVALID_TAC_0000;
+  paging_request.tai_list.n_tais = OAI_BENCH_PAGING_LIST_TAIS;
+  for (int t = 0; t < OAI_BENCH_PAGING_LIST_TAIS; t++) {
+    paging_request.tai_list.tai[t].plmn.mcc_digit1 = 2;
+    paging_request.tai_list.tai[t].plmn.mcc_digit2 = 0;
+    paging_request.tai_list.tai[t].plmn.mcc_digit3 = 8;
+    paging_request.tai_list.tai[t].plmn.mnc_digit1 = 9;
+    paging_request.tai_list.tai[t].plmn.mnc_digit2 = 3;
+    paging_request.tai_list.tai[t].plmn.mnc_digit3 = 0x0F;
+    paging_request.tai_list.tai[t].tac = 1 + ((i + t) % OAI_BENCH_PAGING_TACS);
+  }
+  if (s1ap_handle_paging_request (&paging_request) != RETURNok) {
+    fprintf (stderr, "Failed to page UE\n");
+    exit (EXIT_FAILURE);
+  }
+  for (itti_poll_msg (TASK_SCTP, &message_p); message_p; itti_poll_msg (TASK_SCTP, &message_p)) {
+    bdestroy (SCTP_DATA_REQ (message_p).payload);
+    itti_free (ITTI_MSG_ORIGIN_ID (message_p), message_p);
+    message_p = NULL;
+  }
+  s1ap_paging_stop (paging_request.mme_code, paging_request.m_tmsi);
+}
+
+static const oai_bench_case_t           paging_bench_cases[] = {
+  {.name = "page_tai_list_stop", .setup = paging_bench_setup, .run = paging_bench_page_stop},
+  {.name = NULL}
+};
+
+//------------------------------------------------------------------------------
+// NAS
+//------------------------------------------------------------------------------
+typedef struct nas_bench_s {
+  EMM_msg                                 msg;
+  uint8_t                                 buffer[256];
+} nas_bench_t;
+
+static int nas_bench_setup (void **ctx)
+{
+  nas_bench_t                            *bench = calloc (1, sizeof (nas_bench_t));
+
+  if ((!bench) || (emm_msg_decode (&bench->msg, attach_request_pdu, sizeof (attach_request_pdu)) < 0)) {
+    free (bench);
+    return -1;
+  }
+  *ctx = bench;
+  return 0;
+}
+
+static void nas_bench_decode_attach_request (void *ctx, uint64_t i)
+{
+  EMM_msg                                 msg = {{0}};
+
+  if (emm_msg_decode (&msg, attach_request_pdu, sizeof (attach_request_pdu)) < 0) {
+    fprintf (stderr, "Failed to decode Attach Request\n");
+    exit (EXIT_FAILURE);
+  }
+  bdestroy (msg.attach_request.esmmessagecontainer);
+}
+
+static void nas_bench_encode_attach_request (void *ctx, uint64_t i)
+{
+  nas_bench_t                            *bench = ctx;
+
+  if (emm_msg_encode (&bench->msg, bench->buffer, sizeof (bench->buffer)) < 0) {
+    fprintf (stderr, "Failed to encode Attach Request\n");
+    exit (EXIT_FAILURE);
+  }
+}
+
+static void nas_bench_teardown (void *ctx)
+{
+  nas_bench_t                            *bench = ctx;
+
+  bdestroy (bench->msg.attach_request.esmmessagecontainer);
+  free (bench);
+}
+
+static const oai_bench_case_t           nas_bench_cases[] = {
+  {.name = "decode_attach_request", .run = nas_bench_decode_attach_request},
+  {.name = "encode_attach_request", .setup = nas_bench_setup, .run = nas_bench_encode_attach_request, .teardown = nas_bench_teardown},
+  {.name = NULL}
+};
+
+//------------------------------------------------------------------------------
+// NAS security
+//------------------------------------------------------------------------------
+typedef struct secu_bench_s {
+  uint8_t                                 key[16];
+  uint8_t                                 message[OAI_BENCH_NAS_MESSAGE_SIZE];
+  uint8_t                                 out[OAI_BENCH_NAS_MESSAGE_SIZE];
+  nas_stream_cipher_t                     cipher;
+} secu_bench_t;
+
+static int secu_bench_setup (void **ctx)
+{
+  secu_bench_t                           *bench = calloc (1, sizeof (secu_bench_t));
+
+  if (!bench) {
+    return -1;
+  }
+  for (int k = 0; k < sizeof (bench->key); k++) {
+    bench->key[k] = (uint8_t)(0x2B + k);
+  }
+  for (int k = 0; k < sizeof (bench->message); k++) {
+    bench->message[k] = (uint8_t)k;
+  }
+  bench->cipher.key = bench->key;
+  bench->cipher.key_length = sizeof (bench->key);
+  bench->cipher.bearer = 0;
+  bench->cipher.direction = 0;
+  bench->cipher.message = bench->message;
+  bench->cipher.blength = sizeof (bench->message) * 8;
+  *ctx = bench;
+  return 0;
+}
+
+static void secu_bench_teardown (void *ctx)
+{
+  free (ctx);
+}
+
+static void secu_bench_eea1 (void *ctx, uint64_t i)
+{
+  secu_bench_t                           *bench = ctx;
+
+  bench->cipher.count = (uint32_t)i;
+  nas_stream_encrypt_eea1 (&bench->cipher, bench->out);
+}
+
+static void secu_bench_eea2 (void *ctx, uint64_t i)
+{
+  secu_bench_t                           *bench = ctx;
+
+  bench->cipher.count = (uint32_t)i;
+  nas_stream_encrypt_eea2 (&bench->cipher, bench->out);
+}
+
+static void secu_bench_eia1 (void *ctx, uint64_t i)
+{
+  secu_bench_t                           *bench = ctx;
+
+  bench->cipher.count = (uint32_t)i;
+  nas_stream_encrypt_eia1 (&bench->cipher, bench->out);
+}
+
+static void secu_bench_eia2 (void *ctx, uint64_t i)
+{
+  secu_bench_t                           *bench = ctx;
+
+  bench->cipher.count = (uint32_t)i;
+  nas_stream_encrypt_eia2 (&bench->cipher, bench->out);
+}
+
+static const oai_bench_case_t           secu_bench_cases[] = {
+  {.name = "eea1", .setup = secu_bench_setup, .run = secu_bench_eea1, .teardown = secu_bench_teardown},
+  {.name = "eea2", .setup = secu_bench_setup, .run = secu_bench_eea2, .teardown = secu_bench_teardown},
+  {.name = "eia1", .setup = secu_bench_setup, .run = secu_bench_eia1, .teardown = secu_bench_teardown},
+  {.name = "eia2", .setup = secu_bench_setup, .run = secu_bench_eia2, .teardown = secu_bench_teardown},
+  {.name = NULL}
+};
+
+//------------------------------------------------------------------------------
+// GTPv2-C
+//------------------------------------------------------------------------------
+typedef struct gtpv2c_bench_s {
+  NwGtpv2cStackHandleT                    stack;
+  itti_s11_create_session_request_t       req;
+  uint8_t                                 wire[NW_GTPV2C_MAX_MSG_LEN];
+  uint32_t                                wire_length;
+} gtpv2c_bench_t;
+
+// the Create Session Request of an initial attach, as s11_mme_create_session_request builds it
+static NwGtpv2cMsgHandleT gtpv2c_bench_build_create_session_request (gtpv2c_bench_t * const bench, const uint64_t i)
+{
+  itti_s11_create_session_request_t      *req_p = &bench->req;
+  NwGtpv2cMsgHandleT                      hMsg = 0;
+  uint8_t                                 restart_counter = 0;
+
+  nwGtpv2cMsgNew (bench->stack, NW_TRUE, NW_GTP_CREATE_SESSION_REQ, 0, (uint32_t)(i & 0x00FFFFFF), &hMsg);
+  nwGtpv2cMsgAddIe (hMsg, NW_GTPV2C_IE_RECOVERY, 1, 0, &restart_counter);
+  s11_imsi_ie_set (&hMsg, &req_p->imsi);
+  s11_rat_type_ie_set (&hMsg, &req_p->rat_type);
+  s11_pdn_type_ie_set (&hMsg, &req_p->pdn_type);
+  nwGtpv2cMsgAddIeFteid (hMsg, NW_GTPV2C_IE_INSTANCE_ZERO, S11_MME_GTP_C, (teid_t)(i + 1), ntohl (req_p->sender_fteid_for_cp.ipv4_address), NULL);
+  nwGtpv2cMsgAddIeFteid (hMsg, NW_GTPV2C_IE_INSTANCE_ONE, S5_S8_PGW_GTP_C, 0, 0, NULL);
+  s11_apn_ie_set (&hMsg, req_p->apn);
+  s11_serving_network_ie_set (&hMsg, &req_p->serving_network);
+  s11_pco_ie_set (&hMsg, &req_p->pco);
+  s11_bearer_context_to_be_created_ie_set (&hMsg, &req_p->bearer_contexts_to_be_created.bearer_contexts[0]);
+  return hMsg;
+}
+
+static int gtpv2c_bench_setup (void **ctx)
+{
+  gtpv2c_bench_t                         *bench = calloc (1, sizeof (gtpv2c_bench_t));
+  itti_s11_create_session_request_t      *req_p = NULL;
+  NwGtpv2cMsgT                           *msg = NULL;
+  uint8_t                                *header = NULL;
+
+  if ((!bench) || (nwGtpv2cInitialize (&bench->stack) != NW_OK)) {
+    free (bench);
+    return -1;
+  }
+  req_p = &bench->req;
+  memcpy (req_p->imsi.digit, "208930000000001", 15);
+  req_p->imsi.length = 15;
+  req_p->rat_type = RAT_EUTRAN;
+  req_p->pdn_type = IPv4;
+  req_p->sender_fteid_for_cp.ipv4 = 1;
+  req_p->sender_fteid_for_cp.interface_type = S11_MME_GTP_C;
+  req_p->sender_fteid_for_cp.ipv4_address = htonl (0xC0A80A01);
+  strcpy (req_p->apn, "oai.ipv4");
+  req_p->serving_network.mcc[0] = 2;
+  req_p->serving_network.mcc[1] = 0;
+  req_p->serving_network.mcc[2] = 8;
+  req_p->serving_network.mnc[0] = 9;
+  req_p->serving_network.mnc[1] = 3;
+  req_p->serving_network.mnc[2] = 0xF;
+  req_p->bearer_contexts_to_be_created.num_bearer_context = 1;
+  req_p->bearer_contexts_to_be_created.bearer_contexts[0].eps_bearer_id = 5;
+  req_p->bearer_contexts_to_be_created.bearer_contexts[0].bearer_level_qos.qci = 9;
+  req_p->bearer_contexts_to_be_created.bearer_contexts[0].bearer_level_qos.pl = 15;
+  /*
+   * What the SGW receives: the header is only written when the stack sends the message
+   */
+  msg = (NwGtpv2cMsgT *) gtpv2c_bench_build_create_session_request (bench, 0);
+  memcpy (bench->wire, msg->msgBuf, msg->msgLen);
+  bench->wire_length = msg->msgLen;
+  header = bench->wire;
+  *(header++) = (msg->version << 5) | (msg->teidPresent << 3);
+  *(header++) = msg->msgType;
+  *((uint16_t *) header) = htons (msg->msgLen - 4);
+  header += 2;
+  *((uint32_t *) header) = htonl (msg->teid);
+  header += 4;
+  *((uint32_t *) header) = htonl (msg->seqNum << 8);
+  nwGtpv2cMsgDelete (bench->stack, (NwGtpv2cMsgHandleT) msg);
+  *ctx = bench;
+  return 0;
+}
+
+static void gtpv2c_bench_build (void *ctx, uint64_t i)
+{
+  gtpv2c_bench_t                         *bench = ctx;
+
+  nwGtpv2cMsgDelete (bench->stack, gtpv2c_bench_build_create_session_request (bench, i));
+}
+
+// the IEs of an initial attach, as s11_sgw_handle_create_session_request parses them
+static void gtpv2c_bench_parse (void *ctx, uint64_t i)
+{
+  gtpv2c_bench_t                         *bench = ctx;
+  itti_s11_create_session_request_t       req = {0};
+  NwGtpv2cMsgHandleT                      hMsg = 0;
+  NwGtpv2cMsgParserT                     *pMsgParser = NULL;
+  uint8_t                                 offendingIeType = 0;
+  uint8_t                                 offendingIeInstance = 0;
+  uint16_t                                offendingIeLength = 0;
+
+  nwGtpv2cMsgFromBufferNew (bench->stack, bench->wire, bench->wire_length, &hMsg);
+  nwGtpv2cMsgParserNew (bench->stack, NW_GTP_CREATE_SESSION_REQ, s11_ie_indication_generic, NULL, &pMsgParser);
+  nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_IMSI, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, s11_imsi_ie_get, &req.imsi);
+  nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_SERVING_NETWORK, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, s11_serving_network_ie_get, &req.serving_network);
+  nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_RAT_TYPE, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY, s11_rat_type_ie_get, &req.rat_type);
+  nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_APN, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY, s11_apn_ie_get, &req.apn);
+  nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_PDN_TYPE, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, s11_pdn_type_ie_get, &req.pdn_type);
+  nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_FTEID, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY, s11_fteid_ie_get, &req.sender_fteid_for_cp);
+  nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_FTEID, NW_GTPV2C_IE_INSTANCE_ONE, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, s11_fteid_ie_get, &req.pgw_address_for_cp);
+  nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_BEARER_CONTEXT, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY,
+                          s11_bearer_context_to_be_created_ie_get, &req.bearer_contexts_to_be_created);
+  nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_PCO, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, s11_pco_ie_get, &req.pco);
+  nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_RECOVERY, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY, s11_ie_indication_generic, NULL);
+  if (nwGtpv2cMsgParserRun (pMsgParser, hMsg, &offendingIeType, &offendingIeInstance, &offendingIeLength) != NW_OK) {
+    fprintf (stderr, "Failed to parse Create Session Request, IE type %u instance %u\n", offendingIeType, offendingIeInstance);
+    exit (EXIT_FAILURE);
+  }
+  nwGtpv2cMsgParserDelete (bench->stack, pMsgParser);
+  nwGtpv2cMsgDelete (bench->stack, hMsg);
+}
+
+static void gtpv2c_bench_teardown (void *ctx)
+{
+  gtpv2c_bench_t                         *bench = ctx;
+
+  nwGtpv2cFinalize (bench->stack);
+  free (bench);
+}
+
+static const oai_bench_case_t           gtpv2c_bench_cases[] = {
+  {.name = "build_create_session_request", .setup = gtpv2c_bench_setup, .run = gtpv2c_bench_build, .teardown = gtpv2c_bench_teardown},
+  {.name = "parse_create_session_request", .setup = gtpv2c_bench_setup, .run = gtpv2c_bench_parse, .teardown = gtpv2c_bench_teardown},
+  {.name = NULL}
+};
+
+//------------------------------------------------------------------------------
+// Timers
+//------------------------------------------------------------------------------
+static void timer_bench_setup_remove (void *ctx, uint64_t i)
+{
+  long                                    timer_id = 0;
+
+  // never expires while it is armed
+  if (timer_setup (3600, 0, TASK_MME_APP, INSTANCE_DEFAULT, TIMER_ONE_SHOT, NULL, &timer_id) < 0) {
+    fprintf (stderr, "Failed to setup timer\n");
+    exit (EXIT_FAILURE);
+  }
+  timer_remove (timer_id);
+}
+
+static const oai_bench_case_t           timer_bench_cases[] = {
+  {.name = "setup_remove", .run = timer_bench_setup_remove},
+  {.name = NULL}
+};
+
+//------------------------------------------------------------------------------
+static const oai_bench_suite_t          itti_bench_suite = {.name = "itti", .cases = itti_bench_cases};
+static const oai_bench_suite_t          memory_pools_bench_suite = {.name = "memory_pools", .cases = memory_pools_bench_cases};
+static const oai_bench_suite_t          hashtable_ts_bench_suite = {.name = "hashtable_ts", .cases = hashtable_ts_bench_cases};
+static const oai_bench_suite_t          obj_hashtable_ts_bench_suite = {.name = "obj_hashtable_ts", .cases = obj_hashtable_ts_bench_cases};
+static const oai_bench_suite_t          s1ap_bench_suite = {.name = "s1ap", .cases = s1ap_bench_cases};
+static const oai_bench_suite_t          paging_bench_suite = {.name = "paging", .cases = paging_bench_cases};
+static const oai_bench_suite_t          nas_bench_suite = {.name = "nas", .cases = nas_bench_cases};
+static const oai_bench_suite_t          secu_bench_suite = {.name = "secu", .cases = secu_bench_cases};
+static const oai_bench_suite_t          gtpv2c_bench_suite = {.name = "gtpv2c", .cases = gtpv2c_bench_cases};
+static const oai_bench_suite_t          timer_bench_suite = {.name = "timer", .cases = timer_bench_cases};
+
+static const oai_bench_suite_t * const  mme_bench_suites[] = {
+  &itti_bench_suite,
+  &memory_pools_bench_suite,
+  &hashtable_ts_bench_suite,
+  &obj_hashtable_ts_bench_suite,
+  &s1ap_bench_suite,
+  &paging_bench_suite,
+  &nas_bench_suite,
+  &secu_bench_suite,
+  &gtpv2c_bench_suite,
+  &timer_bench_suite,
+  NULL
+};
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  if (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) < 0) {
+    return EXIT_FAILURE;
+  }
+  if (itti_init (TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info, NULL, NULL) < 0) {
+    return EXIT_FAILURE;
+  }
+  if (timer_init () < 0) {
+    return EXIT_FAILURE;
+  }
+  return oai_bench_main (argc, argv, mme_bench_suites);
+}
@@ -0,0 +1,794 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oai_loadgen.c
+   \brief Not a test: S1-MME signalling load generator, run it by hand against a MME, a HSS and a
+          S/P-GW, on loopback is enough. Options, worker threads, call model scheduler, timeouts and
+          the per procedure latency histograms and failure counts of the JSON report.
+          The eNBs are shared between the workers (eNB i in worker i % workers), the UEs between the
+          eNBs (UE u in eNB u % eNBs), a worker only touches its own eNBs and UEs.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+#include "log.h"
+#include "intertask_interface_init.h"
+#include "conversions.h"
+#include "oai_loadgen.h"
+#include "oai_loadgen_usim.h"
+
+/* UEs looked at for one procedure slot before counting a scheduling miss */
+#define LOADGEN_SCHEDULE_SCAN       (64)
+/* UEs checked for a timeout at each loop of a worker */
+#define LOADGEN_TIMEOUT_SCAN        (256)
+/* procedure slots a worker may owe after a stall, in seconds of rate */
+#define LOADGEN_MAX_BURST_SEC       (0.1)
+
+loadgen_config_t                        loadgen_config = {
+  .nb_enbs = 10,
+  .nb_ues = 1000,
+  .nb_workers = 1,
+  .rate = 100.0,
+  .duration_sec = 60.0,
+  .timeout_sec = 5.0,
+  .weights = {
+    [LOADGEN_PROC_ATTACH] = 1,
+    [LOADGEN_PROC_DETACH] = 1,
+    [LOADGEN_PROC_TAU] = 2,
+    [LOADGEN_PROC_SERVICE_REQUEST] = 4,
+    [LOADGEN_PROC_IDLE] = 4,
+  },
+  .first_imsi = 208930000000001ULL,
+  .first_enb_id = 1,
+  .mcc = 208,
+  .mnc = 93,
+  .mnc_digit_length = 2,
+  .tac = 1,
+  .sctp_outstreams = 8,
+};
+loadgen_ue_t                           *loadgen_ues = NULL;
+loadgen_enb_t                          *loadgen_enbs = NULL;
+
+static volatile sig_atomic_t            loadgen_stop = 0;
+
+static const char * const               loadgen_proc_names[LOADGEN_PROC_MAX] = {
+  [LOADGEN_PROC_ATTACH] = "attach",
+  [LOADGEN_PROC_DETACH] = "detach",
+  [LOADGEN_PROC_TAU] = "tau",
+  [LOADGEN_PROC_SERVICE_REQUEST] = "service",
+  [LOADGEN_PROC_IDLE] = "idle",
+  [LOADGEN_PROC_S1_SETUP] = "s1_setup",
+};
+
+static const char * const               loadgen_failure_names[LOADGEN_FAILURE_MAX] = {
+  [LOADGEN_FAILURE_TIMEOUT] = "timeout",
+  [LOADGEN_FAILURE_REJECT] = "reject",
+  [LOADGEN_FAILURE_AUTHENTICATION] = "authentication",
+  [LOADGEN_FAILURE_INTEGRITY] = "integrity",
+  [LOADGEN_FAILURE_PROTOCOL] = "protocol",
+  [LOADGEN_FAILURE_SEND] = "send",
+};
+
+//------------------------------------------------------------------------------
+uint64_t loadgen_now_ns (void)
+{
+  struct timespec                         ts = {0};
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+loadgen_enb_t *loadgen_ue_enb (const uint32_t ue_index)
+{
+  return &loadgen_enbs[ue_index % loadgen_config.nb_enbs];
+}
+
+//------------------------------------------------------------------------------
+uint32_t loadgen_ue_enb_ue_s1ap_id (const uint32_t ue_index)
+{
+  return ((uint32_t)loadgen_ues[ue_index].generation << LOADGEN_ENB_UE_S1AP_ID_INDEX_BITS) | (ue_index / loadgen_config.nb_enbs);
+}
+
+//------------------------------------------------------------------------------
+// NULL if the ID is not one of the eNB or belongs to a previous S1 connection of the UE
+loadgen_ue_t *loadgen_enb_find_ue (const loadgen_enb_t * const enb, const uint32_t enb_ue_s1ap_id)
+{
+  const uint32_t                          ue_index = (enb_ue_s1ap_id & (LOADGEN_MAX_UES_PER_ENB - 1)) * loadgen_config.nb_enbs + enb->index;
+
+  if ((ue_index >= loadgen_config.nb_ues) || (loadgen_ue_enb_ue_s1ap_id (ue_index) != (enb_ue_s1ap_id & 0x00FFFFFF))) {
+    return NULL;
+  }
+  return &loadgen_ues[ue_index];
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_histogram_add (loadgen_histogram_t * const histogram, const uint64_t us)
+{
+  uint32_t                                index = (uint32_t)us;
+
+  if (us >= 2 * LOADGEN_HISTOGRAM_SUB_BUCKETS) {
+    const uint32_t                        msb = 63 - __builtin_clzll (us);
+
+    // msb >= 6, the 5 bits under it select the sub bucket
+    index = 2 * LOADGEN_HISTOGRAM_SUB_BUCKETS + (msb - 6) * LOADGEN_HISTOGRAM_SUB_BUCKETS + (uint32_t)((us >> (msb - 5)) - LOADGEN_HISTOGRAM_SUB_BUCKETS);
+    if (index >= LOADGEN_HISTOGRAM_BUCKETS) {
+      index = LOADGEN_HISTOGRAM_BUCKETS - 1;
+    }
+  }
+  histogram->buckets[index]++;
+  histogram->count++;
+  if (us > histogram->max_us) {
+    histogram->max_us = us;
+  }
+}
+
+//------------------------------------------------------------------------------
+// highest latency counted in the bucket
+static uint64_t loadgen_histogram_bucket_us (const uint32_t index)
+{
+  if (index < 2 * LOADGEN_HISTOGRAM_SUB_BUCKETS) {
+    return index;
+  }
+
+  const uint32_t                          msb = 6 + (index - 2 * LOADGEN_HISTOGRAM_SUB_BUCKETS) / LOADGEN_HISTOGRAM_SUB_BUCKETS;
+  const uint64_t                          sub = (index - 2 * LOADGEN_HISTOGRAM_SUB_BUCKETS) % LOADGEN_HISTOGRAM_SUB_BUCKETS;
+
+  return ((LOADGEN_HISTOGRAM_SUB_BUCKETS + sub + 1) << (msb - 5)) - 1;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t loadgen_histogram_percentile_us (const loadgen_histogram_t * const histogram, const double p)
+{
+  uint64_t                                rank = (uint64_t)(p * (double)histogram->count + 0.999999);
+  uint64_t                                seen = 0;
+
+  if (histogram->count == 0) {
+    return 0;
+  }
+  if (rank < 1) {
+    rank = 1;
+  }
+  for (uint32_t i = 0; i < LOADGEN_HISTOGRAM_BUCKETS; i++) {
+    seen += histogram->buckets[i];
+    if (seen >= rank) {
+      const uint64_t                      us = loadgen_histogram_bucket_us (i);
+
+      return (us < histogram->max_us) ? us : histogram->max_us;
+    }
+  }
+  return histogram->max_us;
+}
+
+//------------------------------------------------------------------------------
+void loadgen_proc_start (loadgen_worker_t * const worker, loadgen_ue_t * const ue, const loadgen_proc_t proc)
+{
+  ue->proc = proc;
+  ue->step = LOADGEN_STEP_NONE;
+  ue->started_ns = loadgen_now_ns ();
+  __atomic_fetch_add (&worker->stats[proc].started, 1, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+void loadgen_proc_complete (loadgen_worker_t * const worker, loadgen_ue_t * const ue, const loadgen_ue_state_t state)
+{
+  loadgen_proc_stats_t                   *stats = &worker->stats[ue->proc];
+
+  loadgen_histogram_add (&stats->latency, (loadgen_now_ns () - ue->started_ns) / 1000);
+  __atomic_fetch_add (&stats->completed, 1, __ATOMIC_RELAXED);
+  ue->state = state;
+  ue->proc = LOADGEN_PROC_MAX;
+  ue->step = LOADGEN_STEP_NONE;
+}
+
+//------------------------------------------------------------------------------
+// the UE forgets its registration, its next procedure is an attach with its IMSI
+void loadgen_proc_fail (loadgen_worker_t * const worker, loadgen_ue_t * const ue, const loadgen_failure_t failure)
+{
+  const uint32_t                          ue_index = (uint32_t)(ue - loadgen_ues);
+
+  worker->stats[ue->proc].failures[failure]++;
+  // do not leave the S1 connection to the MME, its Release Command is answered whatever the UE does next
+  if ((ue->mme_ue_s1ap_id_valid) && (failure != LOADGEN_FAILURE_SEND)) {
+    loadgen_s1ap_send_ue_context_release_request (ue_index);
+  }
+  ue->state = LOADGEN_UE_DEREGISTERED;
+  ue->proc = LOADGEN_PROC_MAX;
+  ue->step = LOADGEN_STEP_NONE;
+  ue->mme_ue_s1ap_id_valid = false;
+  ue->guti_valid = false;
+  ue->security_valid = false;
+}
+
+//------------------------------------------------------------------------------
+void loadgen_enb_setup_complete (loadgen_worker_t * const worker, loadgen_enb_t * const enb, const bool success)
+{
+  loadgen_proc_stats_t                   *stats = &worker->stats[LOADGEN_PROC_S1_SETUP];
+
+  if (enb->setup_done) {
+    return;
+  }
+  if (success) {
+    loadgen_histogram_add (&stats->latency, (loadgen_now_ns () - enb->setup_started_ns) / 1000);
+    __atomic_fetch_add (&stats->completed, 1, __ATOMIC_RELAXED);
+    enb->setup_done = true;
+    worker->nb_enbs_setup++;
+  } else {
+    stats->failures[LOADGEN_FAILURE_REJECT]++;
+  }
+}
+
+//------------------------------------------------------------------------------
+static uint64_t loadgen_worker_random (loadgen_worker_t * const worker)
+{
+  // xorshift64*
+  worker->random_state ^= worker->random_state >> 12;
+  worker->random_state ^= worker->random_state << 25;
+  worker->random_state ^= worker->random_state >> 27;
+  return worker->random_state * 0x2545F4914F6CDD1DULL;
+}
+
+//------------------------------------------------------------------------------
+// procedure of the call model for a UE in this state, LOADGEN_PROC_MAX if the model has none
+static loadgen_proc_t loadgen_worker_pick_proc (loadgen_worker_t * const worker, const loadgen_ue_state_t state)
+{
+  static const bool                       allowed[][LOADGEN_PROC_S1_SETUP] = {
+    [LOADGEN_UE_DEREGISTERED] = {[LOADGEN_PROC_ATTACH] = true},
+    [LOADGEN_UE_CONNECTED] = {[LOADGEN_PROC_DETACH] = true, [LOADGEN_PROC_IDLE] = true},
+    [LOADGEN_UE_IDLE] = {[LOADGEN_PROC_DETACH] = true, [LOADGEN_PROC_TAU] = true, [LOADGEN_PROC_SERVICE_REQUEST] = true},
+  };
+  uint32_t                                total = 0;
+  uint64_t                                draw = 0;
+
+  for (int proc = 0; proc < LOADGEN_PROC_S1_SETUP; proc++) {
+    total += allowed[state][proc] ? loadgen_config.weights[proc] : 0;
+  }
+  if (total == 0) {
+    return LOADGEN_PROC_MAX;
+  }
+  draw = loadgen_worker_random (worker) % total;
+  for (int proc = 0; proc < LOADGEN_PROC_S1_SETUP; proc++) {
+    const uint32_t                        weight = allowed[state][proc] ? loadgen_config.weights[proc] : 0;
+
+    if (draw < weight) {
+      return (loadgen_proc_t)proc;
+    }
+    draw -= weight;
+  }
+  return LOADGEN_PROC_MAX;
+}
+
+//------------------------------------------------------------------------------
+// one procedure slot of the rate: the next UE of the worker without procedure in progress starts one
+static void loadgen_worker_schedule (loadgen_worker_t * const worker)
+{
+  for (int i = 0; i < LOADGEN_SCHEDULE_SCAN; i++) {
+    const uint32_t                        ue_index = worker->ues[worker->schedule_cursor];
+    loadgen_ue_t                         *ue = &loadgen_ues[ue_index];
+    loadgen_proc_t                        proc = LOADGEN_PROC_MAX;
+
+    worker->schedule_cursor = (worker->schedule_cursor + 1) % worker->nb_ues;
+    if ((ue->proc != LOADGEN_PROC_MAX) || (!loadgen_ue_enb (ue_index)->setup_done)) {
+      continue;
+    }
+    proc = loadgen_worker_pick_proc (worker, ue->state);
+    switch (proc) {
+    case LOADGEN_PROC_ATTACH:
+      loadgen_ue_start_attach (worker, ue_index);
+      return;
+    case LOADGEN_PROC_DETACH:
+      loadgen_ue_start_detach (worker, ue_index);
+      return;
+    case LOADGEN_PROC_TAU:
+      loadgen_ue_start_tau (worker, ue_index);
+      return;
+    case LOADGEN_PROC_SERVICE_REQUEST:
+      loadgen_ue_start_service_request (worker, ue_index);
+      return;
+    case LOADGEN_PROC_IDLE:
+      loadgen_ue_start_idle (worker, ue_index);
+      return;
+    default:
+      break;
+    }
+  }
+  worker->scheduling_misses++;
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_worker_check_timeouts (loadgen_worker_t * const worker, const uint64_t now_ns)
+{
+  const uint64_t                          timeout_ns = (uint64_t)(loadgen_config.timeout_sec * 1e9);
+
+  for (int i = 0; i < LOADGEN_TIMEOUT_SCAN; i++) {
+    loadgen_ue_t                         *ue = &loadgen_ues[worker->ues[worker->timeout_cursor]];
+
+    worker->timeout_cursor = (worker->timeout_cursor + 1) % worker->nb_ues;
+    if ((ue->proc != LOADGEN_PROC_MAX) && (now_ns - ue->started_ns > timeout_ns)) {
+      loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_TIMEOUT);
+    }
+  }
+  for (uint32_t i = 0; i < worker->nb_enbs; i++) {
+    loadgen_enb_t                        *enb = worker->enbs[i];
+
+    if ((!enb->setup_done) && (enb->setup_started_ns) && (now_ns - enb->setup_started_ns > timeout_ns)) {
+      worker->stats[LOADGEN_PROC_S1_SETUP].failures[LOADGEN_FAILURE_TIMEOUT]++;
+      enb->setup_started_ns = 0;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_worker_close_enb (loadgen_worker_t * const worker, loadgen_enb_t * const enb)
+{
+  epoll_ctl (worker->epoll_fd, EPOLL_CTL_DEL, enb->sd, NULL);
+  close (enb->sd);
+  enb->sd = -1;
+  if (enb->setup_done) {
+    enb->setup_done = false;
+    worker->nb_enbs_setup--;
+  }
+  fprintf (stderr, "eNB %u: SCTP association lost\n", enb->enb_id);
+}
+
+//------------------------------------------------------------------------------
+static void *loadgen_worker_thread (void *arg)
+{
+  loadgen_worker_t                       *worker = arg;
+  const double                            rate = loadgen_config.rate / (double)loadgen_config.nb_workers;
+  struct epoll_event                      events[64];
+  double                                  slots = 0;
+  uint64_t                                last_ns = 0;
+
+  for (uint32_t i = 0; i < worker->nb_enbs; i++) {
+    loadgen_enb_t                        *enb = worker->enbs[i];
+    struct epoll_event                    event = {.events = EPOLLIN, .data.ptr = enb};
+
+    __atomic_fetch_add (&worker->stats[LOADGEN_PROC_S1_SETUP].started, 1, __ATOMIC_RELAXED);
+    if (loadgen_s1ap_connect (enb) < 0) {
+      worker->stats[LOADGEN_PROC_S1_SETUP].failures[LOADGEN_FAILURE_SEND]++;
+      continue;
+    }
+    epoll_ctl (worker->epoll_fd, EPOLL_CTL_ADD, enb->sd, &event);
+    enb->setup_started_ns = loadgen_now_ns ();
+    if (loadgen_s1ap_send_s1_setup_request (enb) < 0) {
+      worker->stats[LOADGEN_PROC_S1_SETUP].failures[LOADGEN_FAILURE_SEND]++;
+      enb->setup_started_ns = 0;
+    }
+  }
+  last_ns = loadgen_now_ns ();
+  while (!loadgen_stop) {
+    const int                             nb_events = epoll_wait (worker->epoll_fd, events, 64, 1);
+    uint64_t                              now_ns = 0;
+
+    for (int i = 0; i < nb_events; i++) {
+      loadgen_enb_t                      *enb = events[i].data.ptr;
+
+      if (loadgen_s1ap_receive (worker, enb) < 0) {
+        loadgen_worker_close_enb (worker, enb);
+      }
+    }
+    now_ns = loadgen_now_ns ();
+    if (worker->nb_enbs_setup) {
+      slots += rate * (double)(now_ns - last_ns) / 1e9;
+      if (slots > rate * LOADGEN_MAX_BURST_SEC + 1) {
+        slots = rate * LOADGEN_MAX_BURST_SEC + 1;
+      }
+      for (; slots >= 1; slots -= 1) {
+        loadgen_worker_schedule (worker);
+      }
+    }
+    last_ns = now_ns;
+    loadgen_worker_check_timeouts (worker, now_ns);
+  }
+  for (uint32_t i = 0; i < worker->nb_enbs; i++) {
+    if (worker->enbs[i]->sd >= 0) {
+      close (worker->enbs[i]->sd);
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int loadgen_worker_init (loadgen_worker_t * const worker, const uint32_t index)
+{
+  worker->index = index;
+  worker->random_state = 0x9E3779B97F4A7C15ULL * (index + 1);
+  worker->epoll_fd = epoll_create1 (0);
+  worker->decode_arena = mem_arena_create (MEM_ARENA_CHUNK_SIZE_DEFAULT);
+  worker->enbs = calloc ((loadgen_config.nb_enbs + loadgen_config.nb_workers - 1) / loadgen_config.nb_workers, sizeof (loadgen_enb_t *));
+  worker->ues = calloc ((loadgen_config.nb_ues + loadgen_config.nb_workers - 1) / loadgen_config.nb_workers + loadgen_config.nb_enbs, sizeof (uint32_t));
+  if ((worker->epoll_fd < 0) || (!worker->decode_arena) || (!worker->enbs) || (!worker->ues)) {
+    return -1;
+  }
+  for (uint32_t i = index; i < loadgen_config.nb_enbs; i += loadgen_config.nb_workers) {
+    worker->enbs[worker->nb_enbs++] = &loadgen_enbs[i];
+    loadgen_enbs[i].worker = worker;
+  }
+  for (uint32_t u = 0; u < loadgen_config.nb_ues; u++) {
+    if (loadgen_ue_enb (u)->worker == worker) {
+      worker->ues[worker->nb_ues++] = u;
+    }
+  }
+  return (worker->nb_ues) ? loadgen_ue_init_worker (worker) : -1;
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_report (FILE * const report, const char * const executable, loadgen_worker_t * const workers, const double seconds)
+{
+  char                                    hostname[64] = {0};
+  uint64_t                                scheduling_misses = 0;
+  uint64_t                                unexpected_messages = 0;
+
+  gethostname (hostname, sizeof (hostname) - 1);
+  for (uint32_t w = 0; w < loadgen_config.nb_workers; w++) {
+    scheduling_misses += workers[w].scheduling_misses;
+    unexpected_messages += workers[w].unexpected_messages;
+  }
+  fprintf (report, "{\n  \"executable\": \"%s\",\n  \"host\": \"%s\",\n  \"timestamp\": %ld,\n  \"enbs\": %u,\n  \"ues\": %u,\n  \"workers\": %u,\n"
+           "  \"target_rate\": %.1f,\n  \"seconds\": %.3f,\n  \"scheduling_misses\": %" PRIu64 ",\n  \"unexpected_messages\": %" PRIu64 ",\n  \"procedures\": [",
+           executable, hostname, (long)time (NULL), loadgen_config.nb_enbs, loadgen_config.nb_ues, loadgen_config.nb_workers,
+           loadgen_config.rate, seconds, scheduling_misses, unexpected_messages);
+  fprintf (stderr, "%-10s %10s %10s %10s %8s %10s %10s %10s %10s %10s\n", "procedure", "started", "completed", "failed", "fail %", "per sec",
+           "p50 us", "p99 us", "p99.9 us", "max us");
+  for (int proc = 0; proc < LOADGEN_PROC_MAX; proc++) {
+    loadgen_proc_stats_t                  total = {0};
+    uint64_t                              failed = 0;
+    bool                                  first = true;
+
+    for (uint32_t w = 0; w < loadgen_config.nb_workers; w++) {
+      const loadgen_proc_stats_t * const  stats = &workers[w].stats[proc];
+
+      total.started += stats->started;
+      total.completed += stats->completed;
+      for (int f = 0; f < LOADGEN_FAILURE_MAX; f++) {
+        total.failures[f] += stats->failures[f];
+      }
+      total.latency.count += stats->latency.count;
+      if (stats->latency.max_us > total.latency.max_us) {
+        total.latency.max_us = stats->latency.max_us;
+      }
+      for (int b = 0; b < LOADGEN_HISTOGRAM_BUCKETS; b++) {
+        total.latency.buckets[b] += stats->latency.buckets[b];
+      }
+    }
+    for (int f = 0; f < LOADGEN_FAILURE_MAX; f++) {
+      failed += total.failures[f];
+    }
+    fprintf (report, "%s\n    {\"procedure\": \"%s\", \"started\": %" PRIu64 ", \"completed\": %" PRIu64 ", \"failed\": %" PRIu64
+             ", \"failure_rate\": %.6f, \"completed_per_sec\": %.1f, \"failures\": {",
+             proc ? "," : "", loadgen_proc_names[proc], total.started, total.completed, failed,
+             (total.completed + failed) ? (double)failed / (double)(total.completed + failed) : 0.0,
+             (double)total.completed / seconds);
+    for (int f = 0; f < LOADGEN_FAILURE_MAX; f++) {
+      fprintf (report, "%s\"%s\": %" PRIu64, f ? ", " : "", loadgen_failure_names[f], total.failures[f]);
+    }
+    fprintf (report, "},\n     \"latency_us\": {\"p50\": %" PRIu64 ", \"p90\": %" PRIu64 ", \"p99\": %" PRIu64 ", \"p999\": %" PRIu64 ", \"max\": %" PRIu64 "},\n"
+             "     \"histogram_us\": [",
+             loadgen_histogram_percentile_us (&total.latency, 0.50), loadgen_histogram_percentile_us (&total.latency, 0.90),
+             loadgen_histogram_percentile_us (&total.latency, 0.99), loadgen_histogram_percentile_us (&total.latency, 0.999), total.latency.max_us);
+    // [highest latency of the bucket, count], empty buckets left out
+    for (int b = 0; b < LOADGEN_HISTOGRAM_BUCKETS; b++) {
+      if (total.latency.buckets[b]) {
+        fprintf (report, "%s[%" PRIu64 ", %" PRIu64 "]", first ? "" : ", ", loadgen_histogram_bucket_us (b), total.latency.buckets[b]);
+        first = false;
+      }
+    }
+    fprintf (report, "]}");
+    fprintf (stderr, "%-10s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %8.3f %10.1f %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+             loadgen_proc_names[proc], total.started, total.completed, failed,
+             (total.completed + failed) ? 100.0 * (double)failed / (double)(total.completed + failed) : 0.0, (double)total.completed / seconds,
+             loadgen_histogram_percentile_us (&total.latency, 0.50), loadgen_histogram_percentile_us (&total.latency, 0.99),
+             loadgen_histogram_percentile_us (&total.latency, 0.999), total.latency.max_us);
+  }
+  fprintf (report, "\n  ]\n}\n");
+}
+
+//------------------------------------------------------------------------------
+static int loadgen_hex_key (const char * const hex, uint8_t key[16])
+{
+  if (strlen (hex) != 32) {
+    return -1;
+  }
+  for (int i = 0; i < 16; i++) {
+    unsigned int                          byte = 0;
+
+    if (sscanf (&hex[2 * i], "%2x", &byte) != 1) {
+      return -1;
+    }
+    key[i] = (uint8_t)byte;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// "attach=1,detach=1,tau=2,service=4,idle=4", the procedures not named keep their weight
+static int loadgen_parse_call_model (const char * const model)
+{
+  bstring                                 b = bfromcstr (model);
+  struct bstrList                        *entries = bsplit (b, ',');
+  int                                     rc = 0;
+
+  for (int i = 0; (entries) && (i < entries->qty); i++) {
+    char                                  name[16] = {0};
+    unsigned int                          weight = 0;
+    int                                   proc = 0;
+
+    if (sscanf (bdata (entries->entry[i]), "%15[a-z_]=%u", name, &weight) != 2) {
+      rc = -1;
+      break;
+    }
+    for (proc = 0; proc < LOADGEN_PROC_S1_SETUP; proc++) {
+      if (!strcmp (name, loadgen_proc_names[proc])) {
+        loadgen_config.weights[proc] = weight;
+        break;
+      }
+    }
+    if (proc == LOADGEN_PROC_S1_SETUP) {
+      rc = -1;
+      break;
+    }
+  }
+  bstrListDestroy (entries);
+  bdestroy (b);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_signal_handler (int signum)
+{
+  loadgen_stop = 1;
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_usage (const char * const exe)
+{
+  fprintf (stderr, "Usage: %s [-m MME address] [-p SCTP port] [-b local address] [-e eNBs] [-u UEs] [-w worker threads]\n"
+           "          [-r procedures per second] [-d seconds] [-t procedure timeout seconds] [-c attach=1,detach=1,tau=2,service=4,idle=4]\n"
+           "          [-i first IMSI] [-P MCC.MNC] [-T TAC] [-E first eNB ID] [-s SCTP outstreams] [-K K] [-O OP | -C OPc]\n"
+           "          [-o report.json] [-v (keep the traces of the NAS library)]\n", exe);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  const char                             *report_file = NULL;
+  const char                             *mcc_mnc = "208.93";
+  bool                                    verbose = false;
+  bool                                    opc_given = false;
+  uint8_t                                 op[16] = {0};
+  char                                    mnc_digits[4] = {0};
+  loadgen_worker_t                       *workers = NULL;
+  pthread_t                              *threads = NULL;
+  struct sigaction                        action = {.sa_handler = loadgen_signal_handler};
+  FILE                                   *report = NULL;
+  uint64_t                                start_ns = 0;
+  double                                  seconds = 0;
+  int                                     c = 0;
+
+  loadgen_hex_key ("8baf473f2f8fd09487cccbd7097c6862", loadgen_config.k);
+  loadgen_hex_key ("1006020f0a478bf6b699f15c062e42b3", op);
+  loadgen_config.mme_address.sin_family = AF_INET;
+  loadgen_config.mme_address.sin_port = htons (36412);
+  loadgen_config.mme_address.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  loadgen_config.local_address.sin_family = AF_INET;
+  loadgen_config.local_address.sin_addr.s_addr = htonl (INADDR_ANY);
+  while ((c = getopt (argc, argv, "m:p:b:e:u:w:r:d:t:c:i:P:T:E:s:K:O:C:o:vh")) != -1) {
+    switch (c) {
+    case 'm':
+      if (inet_pton (AF_INET, optarg, &loadgen_config.mme_address.sin_addr) != 1) {
+        loadgen_usage (argv[0]);
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'p':
+      loadgen_config.mme_address.sin_port = htons ((uint16_t)atoi (optarg));
+      break;
+    case 'b':
+      if (inet_pton (AF_INET, optarg, &loadgen_config.local_address.sin_addr) != 1) {
+        loadgen_usage (argv[0]);
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'e':
+      loadgen_config.nb_enbs = strtoul (optarg, NULL, 0);
+      break;
+    case 'u':
+      loadgen_config.nb_ues = strtoul (optarg, NULL, 0);
+      break;
+    case 'w':
+      loadgen_config.nb_workers = strtoul (optarg, NULL, 0);
+      break;
+    case 'r':
+      loadgen_config.rate = strtod (optarg, NULL);
+      break;
+    case 'd':
+      loadgen_config.duration_sec = strtod (optarg, NULL);
+      break;
+    case 't':
+      loadgen_config.timeout_sec = strtod (optarg, NULL);
+      break;
+    case 'c':
+      if (loadgen_parse_call_model (optarg) < 0) {
+        loadgen_usage (argv[0]);
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'i':
+      loadgen_config.first_imsi = strtoull (optarg, NULL, 10);
+      break;
+    case 'P':
+      mcc_mnc = optarg;
+      break;
+    case 'T':
+      loadgen_config.tac = (uint16_t)strtoul (optarg, NULL, 0);
+      break;
+    case 'E':
+      loadgen_config.first_enb_id = strtoul (optarg, NULL, 0);
+      break;
+    case 's':
+      loadgen_config.sctp_outstreams = (uint16_t)strtoul (optarg, NULL, 0);
+      break;
+    case 'K':
+      if (loadgen_hex_key (optarg, loadgen_config.k) < 0) {
+        loadgen_usage (argv[0]);
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'O':
+      if (loadgen_hex_key (optarg, op) < 0) {
+        loadgen_usage (argv[0]);
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'C':
+      if (loadgen_hex_key (optarg, loadgen_config.opc) < 0) {
+        loadgen_usage (argv[0]);
+        return EXIT_FAILURE;
+      }
+      opc_given = true;
+      break;
+    case 'o':
+      report_file = optarg;
+      break;
+    case 'v':
+      verbose = true;
+      break;
+    default:
+      loadgen_usage (argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if ((sscanf (mcc_mnc, "%hu.%3[0-9]", &loadgen_config.mcc, mnc_digits) != 2) || (strlen (mnc_digits) < 2)) {
+    loadgen_usage (argv[0]);
+    return EXIT_FAILURE;
+  }
+  loadgen_config.mnc = (uint16_t)atoi (mnc_digits);
+  loadgen_config.mnc_digit_length = (uint8_t)strlen (mnc_digits);
+  if ((loadgen_config.nb_enbs < 1) || (loadgen_config.nb_ues < loadgen_config.nb_enbs) || (loadgen_config.nb_workers < 1)
+      || (loadgen_config.nb_workers > loadgen_config.nb_enbs) || ((loadgen_config.nb_ues + loadgen_config.nb_enbs - 1) / loadgen_config.nb_enbs > LOADGEN_MAX_UES_PER_ENB)
+      || (loadgen_config.rate <= 0) || (loadgen_config.duration_sec <= 0) || (loadgen_config.timeout_sec <= 0)
+      || (loadgen_config.sctp_outstreams < 2) || (loadgen_config.first_enb_id + loadgen_config.nb_enbs > (1 << 20))) {
+    fprintf (stderr, "UEs >= eNBs >= workers >= 1, at most %u UEs per eNB, 20 bits eNB IDs, at least 2 SCTP outstreams\n", LOADGEN_MAX_UES_PER_ENB);
+    loadgen_usage (argv[0]);
+    return EXIT_FAILURE;
+  }
+  // TBCD of the serving network, S1AP IEs and KASME
+  loadgen_config.plmn[0] = (MCC_MNC_DECIMAL (loadgen_config.mcc) << 4) | MCC_HUNDREDS (loadgen_config.mcc);
+  loadgen_config.plmn[1] = (MNC_HUNDREDS (loadgen_config.mnc, loadgen_config.mnc_digit_length) << 4) | MCC_MNC_DIGIT (loadgen_config.mcc);
+  loadgen_config.plmn[2] = (MCC_MNC_DIGIT (loadgen_config.mnc) << 4) | MCC_MNC_DECIMAL (loadgen_config.mnc);
+  if (!opc_given) {
+    loadgen_usim_compute_opc (loadgen_config.k, op, loadgen_config.opc);
+  }
+
+  if (report_file) {
+    report = fopen (report_file, "w");
+  } else {
+    report = fdopen (dup (STDOUT_FILENO), "w");
+  }
+  if (!report) {
+    perror ("oai_loadgen report");
+    return EXIT_FAILURE;
+  }
+  // the NAS library and the AuC functions trace on stdout, keep it out of the report
+  if (!verbose) {
+    fflush (stdout);
+    if (!freopen ("/dev/null", "w", stdout)) {
+      perror ("oai_loadgen /dev/null");
+    }
+  }
+  if (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) < 0) {
+    return EXIT_FAILURE;
+  }
+  if (itti_init (TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info, NULL, NULL) < 0) {
+    return EXIT_FAILURE;
+  }
+
+  loadgen_ues = calloc (loadgen_config.nb_ues, sizeof (loadgen_ue_t));
+  loadgen_enbs = calloc (loadgen_config.nb_enbs, sizeof (loadgen_enb_t));
+  workers = calloc (loadgen_config.nb_workers, sizeof (loadgen_worker_t));
+  threads = calloc (loadgen_config.nb_workers, sizeof (pthread_t));
+  if ((!loadgen_ues) || (!loadgen_enbs) || (!workers) || (!threads)) {
+    perror ("oai_loadgen");
+    return EXIT_FAILURE;
+  }
+  for (uint32_t u = 0; u < loadgen_config.nb_ues; u++) {
+    loadgen_ues[u].imsi64 = loadgen_config.first_imsi + u;
+    loadgen_ues[u].proc = LOADGEN_PROC_MAX;
+  }
+  for (uint32_t e = 0; e < loadgen_config.nb_enbs; e++) {
+    loadgen_enbs[e].index = e;
+    loadgen_enbs[e].enb_id = loadgen_config.first_enb_id + e;
+    loadgen_enbs[e].sd = -1;
+  }
+  for (uint32_t w = 0; w < loadgen_config.nb_workers; w++) {
+    if (loadgen_worker_init (&workers[w], w) < 0) {
+      fprintf (stderr, "oai_loadgen: worker %u initialization failed\n", w);
+      return EXIT_FAILURE;
+    }
+  }
+
+  sigaction (SIGINT, &action, NULL);
+  sigaction (SIGTERM, &action, NULL);
+  signal (SIGPIPE, SIG_IGN);
+  start_ns = loadgen_now_ns ();
+  for (uint32_t w = 0; w < loadgen_config.nb_workers; w++) {
+    if (pthread_create (&threads[w], NULL, loadgen_worker_thread, &workers[w])) {
+      perror ("oai_loadgen pthread_create");
+      return EXIT_FAILURE;
+    }
+  }
+  // progress line, the counters of the workers are read without stopping them
+  while ((!loadgen_stop) && (loadgen_now_ns () - start_ns < (uint64_t)(loadgen_config.duration_sec * 1e9))) {
+    uint64_t                              started = 0;
+    uint64_t                              completed = 0;
+
+    sleep (1);
+    for (uint32_t w = 0; w < loadgen_config.nb_workers; w++) {
+      for (int proc = 0; proc < LOADGEN_PROC_S1_SETUP; proc++) {
+        started += __atomic_load_n (&workers[w].stats[proc].started, __ATOMIC_RELAXED);
+        completed += __atomic_load_n (&workers[w].stats[proc].completed, __ATOMIC_RELAXED);
+      }
+    }
+    fprintf (stderr, "%8.1f s: %" PRIu64 " procedures started, %" PRIu64 " completed\n", (double)(loadgen_now_ns () - start_ns) / 1e9, started, completed);
+  }
+  loadgen_stop = 1;
+  for (uint32_t w = 0; w < loadgen_config.nb_workers; w++) {
+    pthread_join (threads[w], NULL);
+  }
+  seconds = (double)(loadgen_now_ns () - start_ns) / 1e9;
+
+  loadgen_report (report, argv[0], workers, seconds);
+  fclose (report);
+  return EXIT_SUCCESS;
+}
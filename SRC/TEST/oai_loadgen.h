@@ -0,0 +1,211 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oai_loadgen.h
+   \brief Not a test: S1-MME signalling load generator, emulated eNBs over SCTP and UEs with their
+          own USIM and NAS security contexts, driven by a call model at a target rate. Shared by
+          oai_loadgen.c (options, workers, scheduler, report), oai_loadgen_s1ap.c (eNB side of S1AP)
+          and oai_loadgen_ue.c (UE NAS procedures).
+*/
+
+#ifndef FILE_OAI_LOADGEN_SEEN
+#define FILE_OAI_LOADGEN_SEEN
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <netinet/in.h>
+
+#include "bstrlib.h"
+#include "emm_msg.h"
+#include "mem_arena.h"
+
+/* the low 16 bits of an eNB UE S1AP ID index the UE in its eNB, the high 8 bits are a generation
+   bumped by each new S1 connection so that late messages of an old one are recognised */
+#define LOADGEN_ENB_UE_S1AP_ID_INDEX_BITS  (16)
+#define LOADGEN_MAX_UES_PER_ENB            (1 << LOADGEN_ENB_UE_S1AP_ID_INDEX_BITS)
+
+/* latency histograms, 32 buckets per power of two of microseconds: 3% resolution up to 2^38 us */
+#define LOADGEN_HISTOGRAM_SUB_BUCKETS      (32)
+#define LOADGEN_HISTOGRAM_BUCKETS          (2 * LOADGEN_HISTOGRAM_SUB_BUCKETS + 32 * LOADGEN_HISTOGRAM_SUB_BUCKETS)
+
+typedef enum {
+  LOADGEN_PROC_ATTACH = 0,
+  LOADGEN_PROC_DETACH,
+  LOADGEN_PROC_TAU,
+  LOADGEN_PROC_SERVICE_REQUEST,
+  LOADGEN_PROC_IDLE,              // S1 release asked by the eNB, UE goes ECM-IDLE
+  LOADGEN_PROC_S1_SETUP,          // not in the call model, one per eNB
+  LOADGEN_PROC_MAX
+} loadgen_proc_t;
+
+typedef enum {
+  LOADGEN_FAILURE_TIMEOUT = 0,
+  LOADGEN_FAILURE_REJECT,         // Attach/Authentication/TAU/Service Reject, S1 Setup Failure
+  LOADGEN_FAILURE_AUTHENTICATION, // the MAC of AUTN does not match: K/OPc differ from the HSS
+  LOADGEN_FAILURE_INTEGRITY,      // the MAC of a downlink NAS message does not match
+  LOADGEN_FAILURE_PROTOCOL,       // unexpected or undecodable message for the procedure step
+  LOADGEN_FAILURE_SEND,           // SCTP send failed, association full or lost
+  LOADGEN_FAILURE_MAX
+} loadgen_failure_t;
+
+typedef enum {
+  LOADGEN_UE_DEREGISTERED = 0,
+  LOADGEN_UE_CONNECTED,           // EMM-REGISTERED, ECM-CONNECTED
+  LOADGEN_UE_IDLE,                // EMM-REGISTERED, ECM-IDLE
+} loadgen_ue_state_t;
+
+typedef enum {
+  LOADGEN_STEP_NONE = 0,
+  LOADGEN_STEP_AUTHENTICATION_REQUEST,
+  LOADGEN_STEP_SECURITY_MODE_COMMAND,
+  LOADGEN_STEP_ATTACH_ACCEPT,
+  LOADGEN_STEP_INITIAL_CONTEXT_SETUP,
+  LOADGEN_STEP_TAU_ACCEPT,
+  LOADGEN_STEP_DETACH_ACCEPT,
+  LOADGEN_STEP_RELEASE_COMMAND,
+} loadgen_step_t;
+
+typedef struct loadgen_config_s {
+  struct sockaddr_in                      mme_address;
+  struct sockaddr_in                      local_address;  // sin_addr INADDR_ANY if not bound
+  uint32_t                                nb_enbs;
+  uint32_t                                nb_ues;
+  uint32_t                                nb_workers;
+  double                                  rate;           // procedures started per second, all workers
+  double                                  duration_sec;
+  double                                  timeout_sec;    // of one procedure
+  uint32_t                                weights[LOADGEN_PROC_S1_SETUP];
+  uint64_t                                first_imsi;
+  uint32_t                                first_enb_id;   // macro eNB ID of the first eNB, 20 bits
+  uint16_t                                mcc;
+  uint16_t                                mnc;
+  uint8_t                                 mnc_digit_length;
+  uint16_t                                tac;
+  uint8_t                                 plmn[3];        // TBCD, serving network of the KASME
+  uint8_t                                 k[16];
+  uint8_t                                 opc[16];
+  uint16_t                                sctp_outstreams;
+} loadgen_config_t;
+
+typedef struct loadgen_histogram_s {
+  uint64_t                                count;
+  uint64_t                                max_us;
+  uint64_t                                buckets[LOADGEN_HISTOGRAM_BUCKETS];
+} loadgen_histogram_t;
+
+typedef struct loadgen_proc_stats_s {
+  uint64_t                                started;        // read by the progress line, atomic
+  uint64_t                                completed;      // read by the progress line, atomic
+  uint64_t                                failures[LOADGEN_FAILURE_MAX];
+  loadgen_histogram_t                     latency;
+} loadgen_proc_stats_t;
+
+typedef struct loadgen_ue_s {
+  uint64_t                                imsi64;
+  uint64_t                                started_ns;     // of the procedure in progress
+  uint32_t                                mme_ue_s1ap_id;
+  uint32_t                                ul_count;       // next uplink NAS COUNT
+  uint32_t                                dl_count;       // next expected downlink NAS COUNT
+  uint8_t                                 generation;
+  uint8_t                                 state;          // loadgen_ue_state_t
+  uint8_t                                 proc;           // loadgen_proc_t, LOADGEN_PROC_MAX when none
+  uint8_t                                 step;           // loadgen_step_t
+  bool                                    mme_ue_s1ap_id_valid;
+  bool                                    guti_valid;
+  bool                                    security_valid;
+  uint8_t                                 ksi;
+  uint8_t                                 eea;
+  uint8_t                                 eia;
+  uint8_t                                 ebi;
+  uint8_t                                 kasme[32];
+  uint8_t                                 knas_int[16];
+  uint8_t                                 knas_enc[16];
+  GutiEpsMobileIdentity_t                 guti;
+} loadgen_ue_t;
+
+struct loadgen_worker_s;
+
+typedef struct loadgen_enb_s {
+  struct loadgen_worker_s                *worker;
+  uint32_t                                index;
+  uint32_t                                enb_id;
+  int                                     sd;
+  uint16_t                                outstreams;
+  bool                                    setup_done;
+  uint64_t                                setup_started_ns;
+} loadgen_enb_t;
+
+typedef struct loadgen_worker_s {
+  uint32_t                                index;
+  int                                     epoll_fd;
+  loadgen_enb_t                         **enbs;
+  uint32_t                                nb_enbs;
+  uint32_t                                nb_enbs_setup;
+  uint32_t                               *ues;            // indexes in loadgen_ues of the UEs of the eNBs of the worker
+  uint32_t                                nb_ues;
+  uint32_t                                schedule_cursor;
+  uint32_t                                timeout_cursor;
+  uint64_t                                random_state;
+  mem_arena_t                            *decode_arena;
+  EMM_msg                                 attach_request; // template, the IMSI is set per UE
+  uint64_t                                scheduling_misses;  // no idle UE found for a procedure slot
+  uint64_t                                unexpected_messages;
+  loadgen_proc_stats_t                    stats[LOADGEN_PROC_MAX];
+} loadgen_worker_t;
+
+extern loadgen_config_t                 loadgen_config;
+extern loadgen_ue_t                    *loadgen_ues;
+extern loadgen_enb_t                   *loadgen_enbs;
+
+/* oai_loadgen.c */
+uint64_t       loadgen_now_ns(void);
+loadgen_enb_t *loadgen_ue_enb(const uint32_t ue_index);
+uint32_t       loadgen_ue_enb_ue_s1ap_id(const uint32_t ue_index);
+loadgen_ue_t  *loadgen_enb_find_ue(const loadgen_enb_t * const enb, const uint32_t enb_ue_s1ap_id);
+void           loadgen_proc_start(loadgen_worker_t * const worker, loadgen_ue_t * const ue, const loadgen_proc_t proc);
+void           loadgen_proc_complete(loadgen_worker_t * const worker, loadgen_ue_t * const ue, const loadgen_ue_state_t state);
+void           loadgen_proc_fail(loadgen_worker_t * const worker, loadgen_ue_t * const ue, const loadgen_failure_t failure);
+void           loadgen_enb_setup_complete(loadgen_worker_t * const worker, loadgen_enb_t * const enb, const bool success);
+
+/* oai_loadgen_s1ap.c, the NAS PDUs are copied, the caller keeps them */
+int  loadgen_s1ap_connect(loadgen_enb_t * const enb);
+int  loadgen_s1ap_send_s1_setup_request(loadgen_enb_t * const enb);
+int  loadgen_s1ap_send_initial_ue_message(const uint32_t ue_index, const uint8_t * const nas_pdu, const uint32_t length);
+int  loadgen_s1ap_send_uplink_nas_transport(const uint32_t ue_index, const uint8_t * const nas_pdu, const uint32_t length);
+int  loadgen_s1ap_send_initial_context_setup_response(const uint32_t ue_index, const uint8_t e_rab_id);
+int  loadgen_s1ap_send_ue_context_release_request(const uint32_t ue_index);
+/* reads what the association has pending and hands it to the UEs, answers the UE Context Release
+   Commands itself, -1 when the association is lost */
+int  loadgen_s1ap_receive(loadgen_worker_t * const worker, loadgen_enb_t * const enb);
+
+/* oai_loadgen_ue.c */
+int  loadgen_ue_init_worker(loadgen_worker_t * const worker);
+void loadgen_ue_start_attach(loadgen_worker_t * const worker, const uint32_t ue_index);
+void loadgen_ue_start_detach(loadgen_worker_t * const worker, const uint32_t ue_index);
+void loadgen_ue_start_tau(loadgen_worker_t * const worker, const uint32_t ue_index);
+void loadgen_ue_start_service_request(loadgen_worker_t * const worker, const uint32_t ue_index);
+void loadgen_ue_start_idle(loadgen_worker_t * const worker, const uint32_t ue_index);
+void loadgen_ue_handle_downlink_nas(loadgen_worker_t * const worker, const uint32_t ue_index, const uint8_t * const nas_pdu, const uint32_t length);
+void loadgen_ue_handle_initial_context_setup_request(loadgen_worker_t * const worker, const uint32_t ue_index, const uint8_t e_rab_id,
+                                                     const uint8_t * const nas_pdu, const uint32_t length);
+void loadgen_ue_handle_ue_context_release_command(loadgen_worker_t * const worker, const uint32_t ue_index);
+
+#endif /* FILE_OAI_LOADGEN_SEEN */
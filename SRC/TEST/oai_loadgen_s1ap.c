@@ -0,0 +1,476 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oai_loadgen_s1ap.c
+   \brief eNB side of oai_loadgen: one SCTP association per eNB, the S1AP messages the eNBs send
+          and the dispatch of the ones the MME sends to the UEs of oai_loadgen_ue.c.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/sctp.h>
+
+#include "bstrlib.h"
+#include "conversions.h"
+#include "mem_arena.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "oai_loadgen.h"
+
+/* S1AP payload protocol identifier (TS 36.412) */
+#define LOADGEN_S1AP_PPID           (18)
+#define LOADGEN_S1AP_BUFFER_SIZE    (8192)
+/* messages read from an association before the worker looks at its other eNBs */
+#define LOADGEN_S1AP_RECEIVE_BURST  (64)
+
+//------------------------------------------------------------------------------
+int loadgen_s1ap_connect (loadgen_enb_t * const enb)
+{
+  struct sctp_initmsg                     init = {0};
+  struct sctp_status                      status = {0};
+  socklen_t                               status_length = sizeof (status);
+  int                                     sd = socket (AF_INET, SOCK_STREAM, IPPROTO_SCTP);
+
+  if (sd < 0) {
+    perror ("oai_loadgen socket");
+    return -1;
+  }
+  init.sinit_num_ostreams = loadgen_config.sctp_outstreams;
+  init.sinit_max_instreams = loadgen_config.sctp_outstreams;
+  if (setsockopt (sd, IPPROTO_SCTP, SCTP_INITMSG, &init, sizeof (init)) < 0) {
+    perror ("oai_loadgen SCTP_INITMSG");
+    close (sd);
+    return -1;
+  }
+  if ((loadgen_config.local_address.sin_addr.s_addr != htonl (INADDR_ANY))
+      && (bind (sd, (struct sockaddr *)&loadgen_config.local_address, sizeof (loadgen_config.local_address)) < 0)) {
+    perror ("oai_loadgen bind");
+    close (sd);
+    return -1;
+  }
+  if (connect (sd, (struct sockaddr *)&loadgen_config.mme_address, sizeof (loadgen_config.mme_address)) < 0) {
+    fprintf (stderr, "eNB %u: connect: %s\n", enb->enb_id, strerror (errno));
+    close (sd);
+    return -1;
+  }
+  // the MME may grant less streams than asked
+  enb->outstreams = loadgen_config.sctp_outstreams;
+  if ((getsockopt (sd, IPPROTO_SCTP, SCTP_STATUS, &status, &status_length) == 0) && (status.sstat_outstrms < enb->outstreams)) {
+    enb->outstreams = status.sstat_outstrms;
+  }
+  fcntl (sd, F_SETFL, fcntl (sd, F_GETFL) | O_NONBLOCK);
+  enb->sd = sd;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// non UE associated signalling on stream 0, the UEs spread on the others
+static int loadgen_s1ap_send (const loadgen_enb_t * const enb, const uint16_t stream, uint8_t * const buffer, const uint32_t length)
+{
+  int                                     rc = 0;
+
+  if (enb->sd < 0) {
+    rc = -1;
+  } else if (sctp_sendmsg (enb->sd, buffer, length, NULL, 0, htonl (LOADGEN_S1AP_PPID), 0, stream, 0, 0) < 0) {
+    rc = -1;
+  }
+  free (buffer);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+static uint16_t loadgen_s1ap_ue_stream (const loadgen_enb_t * const enb, const uint32_t ue_index)
+{
+  return (enb->outstreams > 1) ? 1 + (ue_index / loadgen_config.nb_enbs) % (enb->outstreams - 1) : 0;
+}
+
+//------------------------------------------------------------------------------
+int loadgen_s1ap_send_s1_setup_request (loadgen_enb_t * const enb)
+{
+  S1ap_S1SetupRequestIEs_t                ies = {0};
+  S1ap_S1SetupRequest_t                   s1_setup_request = {0};
+  S1ap_SupportedTAs_Item_t               *ta = calloc (1, sizeof (S1ap_SupportedTAs_Item_t));
+  S1ap_PLMNidentity_t                    *plmn = calloc (1, sizeof (S1ap_PLMNidentity_t));
+  char                                    name[32] = {0};
+  uint8_t                                *buffer = NULL;
+  uint32_t                                length = 0;
+  int                                     rc = -1;
+
+  if ((!ta) || (!plmn)) {
+    free (ta);
+    free (plmn);
+    return -1;
+  }
+  MCC_MNC_TO_TBCD (loadgen_config.mcc, loadgen_config.mnc, loadgen_config.mnc_digit_length, &ies.global_ENB_ID.pLMNidentity);
+  ies.global_ENB_ID.eNB_ID.present = S1ap_ENB_ID_PR_macroENB_ID;
+  MACRO_ENB_ID_TO_BIT_STRING (enb->enb_id, &ies.global_ENB_ID.eNB_ID.choice.macroENB_ID);
+  snprintf (name, sizeof (name), "oai_loadgen %u", enb->enb_id);
+  OCTET_STRING_fromBuf (&ies.eNBname, name, strlen (name));
+  ies.presenceMask |= S1AP_S1SETUPREQUESTIES_ENBNAME_PRESENT;
+  TAC_TO_ASN1 (loadgen_config.tac, &ta->tAC);
+  MCC_MNC_TO_TBCD (loadgen_config.mcc, loadgen_config.mnc, loadgen_config.mnc_digit_length, plmn);
+  ASN_SEQUENCE_ADD (&ta->broadcastPLMNs.list, plmn);
+  ASN_SEQUENCE_ADD (&ies.supportedTAs.list, ta);
+  ies.defaultPagingDRX = S1ap_PagingDRX_v64;
+  if ((s1ap_encode_s1ap_s1setuprequesties (&s1_setup_request, &ies) == 0)
+      && (s1ap_generate_initiating_message (&buffer, &length, S1ap_ProcedureCode_id_S1Setup, S1ap_Criticality_reject,
+                                            &asn_DEF_S1ap_S1SetupRequest, &s1_setup_request) >= 0)) {
+    rc = loadgen_s1ap_send (enb, 0, buffer, length);
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_Global_ENB_ID, &ies.global_ENB_ID);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_ENBname, &ies.eNBname);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_SupportedTAs, &ies.supportedTAs);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+// the TAI and E-UTRAN CGI of the cell of the eNB, every eNB has one cell
+static void loadgen_s1ap_location (const loadgen_enb_t * const enb, S1ap_TAI_t * const tai, S1ap_EUTRAN_CGI_t * const eutran_cgi)
+{
+  MCC_MNC_TO_TBCD (loadgen_config.mcc, loadgen_config.mnc, loadgen_config.mnc_digit_length, &tai->pLMNidentity);
+  TAC_TO_ASN1 (loadgen_config.tac, &tai->tAC);
+  MCC_MNC_TO_TBCD (loadgen_config.mcc, loadgen_config.mnc, loadgen_config.mnc_digit_length, &eutran_cgi->pLMNidentity);
+  MACRO_ENB_ID_TO_CELL_IDENTITY (enb->enb_id, 0, &eutran_cgi->cell_ID);
+}
+
+//------------------------------------------------------------------------------
+int loadgen_s1ap_send_initial_ue_message (const uint32_t ue_index, const uint8_t * const nas_pdu, const uint32_t length)
+{
+  const loadgen_enb_t * const             enb = loadgen_ue_enb (ue_index);
+  const loadgen_ue_t * const              ue = &loadgen_ues[ue_index];
+  S1ap_InitialUEMessageIEs_t              ies = {0};
+  S1ap_InitialUEMessage_t                 initial_ue_message = {0};
+  uint8_t                                *buffer = NULL;
+  uint32_t                                buffer_length = 0;
+  int                                     rc = -1;
+
+  ies.eNB_UE_S1AP_ID = (S1ap_ENB_UE_S1AP_ID_t)loadgen_ue_enb_ue_s1ap_id (ue_index);
+  OCTET_STRING_fromBuf (&ies.nas_pdu, (const char *)nas_pdu, length);
+  loadgen_s1ap_location (enb, &ies.tai, &ies.eutran_cgi);
+  ies.rrC_Establishment_Cause = (ue->proc == LOADGEN_PROC_SERVICE_REQUEST) ? S1ap_RRC_Establishment_Cause_mo_Data : S1ap_RRC_Establishment_Cause_mo_Signalling;
+  // a registered UE is known by its S-TMSI, the MME finds its context with it
+  if ((ue->guti_valid) && (ue->proc != LOADGEN_PROC_ATTACH)) {
+    MME_CODE_TO_OCTET_STRING (ue->guti.mmecode, &ies.s_tmsi.mMEC);
+    M_TMSI_TO_OCTET_STRING (ue->guti.mtmsi, &ies.s_tmsi.m_TMSI);
+    ies.presenceMask |= S1AP_INITIALUEMESSAGEIES_S_TMSI_PRESENT;
+  }
+  if ((s1ap_encode_s1ap_initialuemessageies (&initial_ue_message, &ies) == 0)
+      && (s1ap_generate_initiating_message (&buffer, &buffer_length, S1ap_ProcedureCode_id_initialUEMessage, S1ap_Criticality_ignore,
+                                            &asn_DEF_S1ap_InitialUEMessage, &initial_ue_message) >= 0)) {
+    rc = loadgen_s1ap_send (enb, loadgen_s1ap_ue_stream (enb, ue_index), buffer, buffer_length);
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &ies.nas_pdu);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAI, &ies.tai);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_EUTRAN_CGI, &ies.eutran_cgi);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_S_TMSI, &ies.s_tmsi);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int loadgen_s1ap_send_uplink_nas_transport (const uint32_t ue_index, const uint8_t * const nas_pdu, const uint32_t length)
+{
+  const loadgen_enb_t * const             enb = loadgen_ue_enb (ue_index);
+  const loadgen_ue_t * const              ue = &loadgen_ues[ue_index];
+  S1ap_UplinkNASTransportIEs_t            ies = {0};
+  S1ap_UplinkNASTransport_t               uplink_nas_transport = {0};
+  uint8_t                                *buffer = NULL;
+  uint32_t                                buffer_length = 0;
+  int                                     rc = -1;
+
+  if (!ue->mme_ue_s1ap_id_valid) {
+    return -1;
+  }
+  ies.mme_ue_s1ap_id = (S1ap_MME_UE_S1AP_ID_t)ue->mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = (S1ap_ENB_UE_S1AP_ID_t)loadgen_ue_enb_ue_s1ap_id (ue_index);
+  OCTET_STRING_fromBuf (&ies.nas_pdu, (const char *)nas_pdu, length);
+  loadgen_s1ap_location (enb, &ies.tai, &ies.eutran_cgi);
+  if ((s1ap_encode_s1ap_uplinknastransporties (&uplink_nas_transport, &ies) == 0)
+      && (s1ap_generate_initiating_message (&buffer, &buffer_length, S1ap_ProcedureCode_id_uplinkNASTransport, S1ap_Criticality_ignore,
+                                            &asn_DEF_S1ap_UplinkNASTransport, &uplink_nas_transport) >= 0)) {
+    rc = loadgen_s1ap_send (enb, loadgen_s1ap_ue_stream (enb, ue_index), buffer, buffer_length);
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &ies.nas_pdu);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAI, &ies.tai);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_EUTRAN_CGI, &ies.eutran_cgi);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+// the S1-U end of the default bearer: the local address, one TEID per UE
+int loadgen_s1ap_send_initial_context_setup_response (const uint32_t ue_index, const uint8_t e_rab_id)
+{
+  const loadgen_enb_t * const             enb = loadgen_ue_enb (ue_index);
+  const loadgen_ue_t * const              ue = &loadgen_ues[ue_index];
+  S1ap_InitialContextSetupResponseIEs_t   ies = {0};
+  S1ap_InitialContextSetupResponse_t      initial_context_setup_response = {0};
+  S1ap_E_RABSetupItemCtxtSURes_t         *e_rab = NULL;
+  uint32_t                                s1u_address = ntohl (loadgen_config.local_address.sin_addr.s_addr);
+  uint8_t                                *buffer = NULL;
+  uint32_t                                buffer_length = 0;
+  int                                     rc = -1;
+
+  if ((!ue->mme_ue_s1ap_id_valid) || (!(e_rab = calloc (1, sizeof (S1ap_E_RABSetupItemCtxtSURes_t))))) {
+    return -1;
+  }
+  if (s1u_address == INADDR_ANY) {
+    s1u_address = INADDR_LOOPBACK;
+  }
+  ies.mme_ue_s1ap_id = (S1ap_MME_UE_S1AP_ID_t)ue->mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = (S1ap_ENB_UE_S1AP_ID_t)loadgen_ue_enb_ue_s1ap_id (ue_index);
+  e_rab->e_RAB_ID = e_rab_id;
+  INT32_TO_BIT_STRING (s1u_address, &e_rab->transportLayerAddress);
+  INT32_TO_OCTET_STRING (ue_index + 1, &e_rab->gTP_TEID);
+  ASN_SEQUENCE_ADD (&ies.e_RABSetupListCtxtSURes.s1ap_E_RABSetupItemCtxtSURes, e_rab);
+  if ((s1ap_encode_s1ap_initialcontextsetupresponseies (&initial_context_setup_response, &ies) == 0)
+      && (s1ap_generate_successfull_outcome (&buffer, &buffer_length, S1ap_ProcedureCode_id_InitialContextSetup, S1ap_Criticality_reject,
+                                             &asn_DEF_S1ap_InitialContextSetupResponse, &initial_context_setup_response) >= 0)) {
+    rc = loadgen_s1ap_send (enb, loadgen_s1ap_ue_stream (enb, ue_index), buffer, buffer_length);
+  }
+  ASN_STRUCT_FREE (asn_DEF_S1ap_E_RABSetupItemCtxtSURes, e_rab);
+  free (ies.e_RABSetupListCtxtSURes.s1ap_E_RABSetupItemCtxtSURes.array);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int loadgen_s1ap_send_ue_context_release_request (const uint32_t ue_index)
+{
+  const loadgen_enb_t * const             enb = loadgen_ue_enb (ue_index);
+  const loadgen_ue_t * const              ue = &loadgen_ues[ue_index];
+  S1ap_UEContextReleaseRequestIEs_t       ies = {0};
+  S1ap_UEContextReleaseRequest_t          ue_context_release_request = {0};
+  uint8_t                                *buffer = NULL;
+  uint32_t                                buffer_length = 0;
+
+  if (!ue->mme_ue_s1ap_id_valid) {
+    return -1;
+  }
+  ies.mme_ue_s1ap_id = (S1ap_MME_UE_S1AP_ID_t)ue->mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = (S1ap_ENB_UE_S1AP_ID_t)loadgen_ue_enb_ue_s1ap_id (ue_index);
+  ies.cause.present = S1ap_Cause_PR_radioNetwork;
+  ies.cause.choice.radioNetwork = S1ap_CauseRadioNetwork_user_inactivity;
+  if ((s1ap_encode_s1ap_uecontextreleaserequesties (&ue_context_release_request, &ies) < 0)
+      || (s1ap_generate_initiating_message (&buffer, &buffer_length, S1ap_ProcedureCode_id_UEContextReleaseRequest, S1ap_Criticality_ignore,
+                                            &asn_DEF_S1ap_UEContextReleaseRequest, &ue_context_release_request) < 0)) {
+    return -1;
+  }
+  return loadgen_s1ap_send (enb, loadgen_s1ap_ue_stream (enb, ue_index), buffer, buffer_length);
+}
+
+//------------------------------------------------------------------------------
+static int loadgen_s1ap_send_ue_context_release_complete (const loadgen_enb_t * const enb, const uint32_t mme_ue_s1ap_id, const uint32_t enb_ue_s1ap_id,
+                                                          const uint16_t stream)
+{
+  S1ap_UEContextReleaseCompleteIEs_t      ies = {0};
+  S1ap_UEContextReleaseComplete_t         ue_context_release_complete = {0};
+  uint8_t                                *buffer = NULL;
+  uint32_t                                buffer_length = 0;
+
+  ies.mme_ue_s1ap_id = (S1ap_MME_UE_S1AP_ID_t)mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = (S1ap_ENB_UE_S1AP_ID_t)enb_ue_s1ap_id;
+  if ((s1ap_encode_s1ap_uecontextreleasecompleteies (&ue_context_release_complete, &ies) < 0)
+      || (s1ap_generate_successfull_outcome (&buffer, &buffer_length, S1ap_ProcedureCode_id_UEContextRelease, S1ap_Criticality_reject,
+                                             &asn_DEF_S1ap_UEContextReleaseComplete, &ue_context_release_complete) < 0)) {
+    return -1;
+  }
+  return loadgen_s1ap_send (enb, stream, buffer, buffer_length);
+}
+
+//------------------------------------------------------------------------------
+// a new MME UE S1AP ID comes with the first downlink message of each S1 connection
+static uint32_t loadgen_s1ap_ue_index (loadgen_enb_t * const enb, const uint32_t enb_ue_s1ap_id, const uint32_t mme_ue_s1ap_id)
+{
+  loadgen_ue_t                           *ue = loadgen_enb_find_ue (enb, enb_ue_s1ap_id);
+
+  if (!ue) {
+    return UINT32_MAX;
+  }
+  ue->mme_ue_s1ap_id = mme_ue_s1ap_id;
+  ue->mme_ue_s1ap_id_valid = true;
+  return (uint32_t)(ue - loadgen_ues);
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_s1ap_handle_ue_context_release_command (loadgen_worker_t * const worker, loadgen_enb_t * const enb,
+                                                            const S1ap_UEContextReleaseCommandIEs_t * const ies, const uint16_t stream)
+{
+  loadgen_ue_t                           *ue = NULL;
+  uint32_t                                mme_ue_s1ap_id = 0;
+  uint32_t                                enb_ue_s1ap_id = 0;
+
+  if (ies->uE_S1AP_IDs.present == S1ap_UE_S1AP_IDs_PR_uE_S1AP_ID_pair) {
+    mme_ue_s1ap_id = (uint32_t)ies->uE_S1AP_IDs.choice.uE_S1AP_ID_pair.mME_UE_S1AP_ID;
+    enb_ue_s1ap_id = (uint32_t)ies->uE_S1AP_IDs.choice.uE_S1AP_ID_pair.eNB_UE_S1AP_ID;
+    ue = loadgen_enb_find_ue (enb, enb_ue_s1ap_id);
+  } else if (ies->uE_S1AP_IDs.present == S1ap_UE_S1AP_IDs_PR_mME_UE_S1AP_ID) {
+    // rare, the UEs of the eNB are searched
+    mme_ue_s1ap_id = (uint32_t)ies->uE_S1AP_IDs.choice.mME_UE_S1AP_ID;
+    for (uint32_t ue_index = enb->index; ue_index < loadgen_config.nb_ues; ue_index += loadgen_config.nb_enbs) {
+      if ((loadgen_ues[ue_index].mme_ue_s1ap_id_valid) && (loadgen_ues[ue_index].mme_ue_s1ap_id == mme_ue_s1ap_id)) {
+        ue = &loadgen_ues[ue_index];
+        enb_ue_s1ap_id = loadgen_ue_enb_ue_s1ap_id (ue_index);
+        break;
+      }
+    }
+  }
+  // always completed, the MME keeps the context of an unanswered release
+  loadgen_s1ap_send_ue_context_release_complete (enb, mme_ue_s1ap_id, enb_ue_s1ap_id, stream);
+  if ((ue) && ((!ue->mme_ue_s1ap_id_valid) || (ue->mme_ue_s1ap_id == mme_ue_s1ap_id))) {
+    loadgen_ue_handle_ue_context_release_command (worker, (uint32_t)(ue - loadgen_ues));
+  } else {
+    worker->unexpected_messages++;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_s1ap_handle_message (loadgen_worker_t * const worker, loadgen_enb_t * const enb, s1ap_message * const message, const uint16_t stream)
+{
+  uint32_t                                ue_index = UINT32_MAX;
+
+  switch (message->direction) {
+  case S1AP_PDU_PR_initiatingMessage:
+    if (message->procedureCode == S1ap_ProcedureCode_id_downlinkNASTransport) {
+      const S1ap_DownlinkNASTransportIEs_t * const ies = &message->msg.s1ap_DownlinkNASTransportIEs;
+
+      ue_index = loadgen_s1ap_ue_index (enb, (uint32_t)ies->eNB_UE_S1AP_ID, (uint32_t)ies->mme_ue_s1ap_id);
+      if (ue_index != UINT32_MAX) {
+        loadgen_ue_handle_downlink_nas (worker, ue_index, ies->nas_pdu.buf, ies->nas_pdu.size);
+        return;
+      }
+    } else if (message->procedureCode == S1ap_ProcedureCode_id_InitialContextSetup) {
+      const S1ap_InitialContextSetupRequestIEs_t * const ies = &message->msg.s1ap_InitialContextSetupRequestIEs;
+
+      ue_index = loadgen_s1ap_ue_index (enb, (uint32_t)ies->eNB_UE_S1AP_ID, (uint32_t)ies->mme_ue_s1ap_id);
+      if ((ue_index != UINT32_MAX) && (ies->e_RABToBeSetupListCtxtSUReq.s1ap_E_RABToBeSetupItemCtxtSUReq.count > 0)) {
+        const S1ap_E_RABToBeSetupItemCtxtSUReq_t * const e_rab = ies->e_RABToBeSetupListCtxtSUReq.s1ap_E_RABToBeSetupItemCtxtSUReq.array[0];
+
+        loadgen_ue_handle_initial_context_setup_request (worker, ue_index, (uint8_t)e_rab->e_RAB_ID, (e_rab->nAS_PDU) ? e_rab->nAS_PDU->buf : NULL,
+                                                         (e_rab->nAS_PDU) ? e_rab->nAS_PDU->size : 0);
+        return;
+      }
+    } else if (message->procedureCode == S1ap_ProcedureCode_id_UEContextRelease) {
+      loadgen_s1ap_handle_ue_context_release_command (worker, enb, &message->msg.s1ap_UEContextReleaseCommandIEs, stream);
+      return;
+    } else if (message->procedureCode == S1ap_ProcedureCode_id_Paging) {
+      // the UEs are paged by the call model only
+      return;
+    }
+    break;
+
+  case S1AP_PDU_PR_successfulOutcome:
+    if (message->procedureCode == S1ap_ProcedureCode_id_S1Setup) {
+      loadgen_enb_setup_complete (worker, enb, true);
+      return;
+    }
+    break;
+
+  case S1AP_PDU_PR_unsuccessfulOutcome:
+    if (message->procedureCode == S1ap_ProcedureCode_id_S1Setup) {
+      fprintf (stderr, "eNB %u: S1 Setup Failure\n", enb->enb_id);
+      loadgen_enb_setup_complete (worker, enb, false);
+      return;
+    }
+    break;
+
+  default:
+    break;
+  }
+  worker->unexpected_messages++;
+}
+
+//------------------------------------------------------------------------------
+// everything asn1c allocates for the PDU goes to the arena of the worker, the message lives until the reset
+static int loadgen_s1ap_decode (loadgen_worker_t * const worker, s1ap_message * const message, uint8_t * const buffer, const ssize_t length)
+{
+  S1AP_PDU_t                              pdu = {(S1AP_PDU_PR_NOTHING)};
+  S1AP_PDU_t                             *pdu_p = &pdu;
+  asn_dec_rval_t                          dec_ret = {(RC_OK)};
+  mem_arena_t                            *previous = mem_arena_enter (worker->decode_arena);
+  int                                     rc = -1;
+
+  dec_ret = aper_decode (NULL, &asn_DEF_S1AP_PDU, (void **)&pdu_p, buffer, length, 0, 0);
+  if (dec_ret.code == RC_OK) {
+    message->direction = pdu.present;
+    switch (pdu.present) {
+    case S1AP_PDU_PR_initiatingMessage:
+      message->procedureCode = pdu.choice.initiatingMessage.procedureCode;
+      if (message->procedureCode == S1ap_ProcedureCode_id_downlinkNASTransport) {
+        rc = s1ap_decode_s1ap_downlinknastransporties (&message->msg.s1ap_DownlinkNASTransportIEs, &pdu.choice.initiatingMessage.value);
+      } else if (message->procedureCode == S1ap_ProcedureCode_id_InitialContextSetup) {
+        rc = s1ap_decode_s1ap_initialcontextsetuprequesties (&message->msg.s1ap_InitialContextSetupRequestIEs, &pdu.choice.initiatingMessage.value);
+      } else if (message->procedureCode == S1ap_ProcedureCode_id_UEContextRelease) {
+        rc = s1ap_decode_s1ap_uecontextreleasecommandies (&message->msg.s1ap_UEContextReleaseCommandIEs, &pdu.choice.initiatingMessage.value);
+      } else {
+        rc = 0;
+      }
+      break;
+    case S1AP_PDU_PR_successfulOutcome:
+      message->procedureCode = pdu.choice.successfulOutcome.procedureCode;
+      rc = 0;
+      break;
+    case S1AP_PDU_PR_unsuccessfulOutcome:
+      message->procedureCode = pdu.choice.unsuccessfulOutcome.procedureCode;
+      rc = 0;
+      break;
+    default:
+      break;
+    }
+  }
+  mem_arena_leave (previous);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int loadgen_s1ap_receive (loadgen_worker_t * const worker, loadgen_enb_t * const enb)
+{
+  uint8_t                                 buffer[LOADGEN_S1AP_BUFFER_SIZE];
+
+  for (int i = 0; i < LOADGEN_S1AP_RECEIVE_BURST; i++) {
+    struct sctp_sndrcvinfo                sinfo = {0};
+    int                                   flags = 0;
+    s1ap_message                          message = {0};
+    const ssize_t                         length = sctp_recvmsg (enb->sd, buffer, sizeof (buffer), NULL, NULL, &sinfo, &flags);
+
+    if (length < 0) {
+      return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? 0 : -1;
+    }
+    if (length == 0) {
+      return -1;
+    }
+    if (flags & MSG_NOTIFICATION) {
+      continue;
+    }
+    if (loadgen_s1ap_decode (worker, &message, buffer, length) < 0) {
+      worker->unexpected_messages++;
+    } else {
+      loadgen_s1ap_handle_message (worker, enb, &message, sinfo.sinfo_stream);
+    }
+    mem_arena_reset (worker->decode_arena);
+  }
+  return 0;
+}
@@ -0,0 +1,571 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oai_loadgen_ue.c
+   \brief UE side of oai_loadgen: EMM procedures, EPS AKA with the USIM and the NAS security
+          context of each UE. The S1AP transport is in oai_loadgen_s1ap.c.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "bstrlib.h"
+#include "3gpp_24.007.h"
+#include "3gpp_24.301.h"
+#include "emm_msg.h"
+#include "secu_defs.h"
+#include "oai_loadgen.h"
+#include "oai_loadgen_usim.h"
+
+/* largest NAS PDU built or received by a UE */
+#define LOADGEN_NAS_BUFFER_SIZE     (512)
+/* security header type, MAC and sequence number of a security protected NAS message */
+#define LOADGEN_NAS_SECURITY_HEADER_SIZE  (6)
+
+/* Plain Attach Request of an IMSI, with a PDN Connectivity Request, a DRX parameter and a last visited TAI */
+static uint8_t                          attach_request_pdu[] = {
+  0x07, 0x41, 0x71, 0x08, 0x09, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x10, 0x02, 0xE0, 0xE0, 0x00,
+  0x04, 0x02, 0x01, 0xD0, 0x11, 0x52, 0x02, 0xF8, 0x39, 0x00, 0x01, 0x5C, 0x0A, 0x00
+};
+
+//------------------------------------------------------------------------------
+int loadgen_ue_init_worker (loadgen_worker_t * const worker)
+{
+  if (emm_msg_decode (&worker->attach_request, attach_request_pdu, sizeof (attach_request_pdu)) <= 0) {
+    fprintf (stderr, "oai_loadgen: Attach Request template not decoded\n");
+    return -1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_ue_mac (const loadgen_ue_t * const ue, const uint32_t count, const uint8_t direction, const uint8_t * const message,
+                            const uint32_t length, uint8_t mac[4])
+{
+  nas_stream_cipher_t                     stream_cipher = {
+    .key = (uint8_t *)ue->knas_int,
+    .key_length = 16,
+    .count = count,
+    .bearer = 0,
+    .direction = direction,
+    .message = (uint8_t *)message,
+    .blength = length << 3,
+  };
+
+  memset (mac, 0, 4);
+  switch (ue->eia) {
+  case NAS_SECURITY_ALGORITHMS_EIA1:
+    nas_stream_encrypt_eia1 (&stream_cipher, mac);
+    break;
+  case NAS_SECURITY_ALGORITHMS_EIA2:
+    nas_stream_encrypt_eia2 (&stream_cipher, mac);
+    break;
+  default:
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+// ciphering and deciphering are the same keystream XOR
+static void loadgen_ue_cipher (const loadgen_ue_t * const ue, const uint32_t count, const uint8_t direction, const uint8_t * const in,
+                               const uint32_t length, uint8_t * const out)
+{
+  nas_stream_cipher_t                     stream_cipher = {
+    .key = (uint8_t *)ue->knas_enc,
+    .key_length = 16,
+    .count = count,
+    .bearer = 0,
+    .direction = direction,
+    .message = (uint8_t *)in,
+    .blength = length << 3,
+  };
+
+  switch (ue->eea) {
+  case NAS_SECURITY_ALGORITHMS_EEA1:
+    nas_stream_encrypt_eea1 (&stream_cipher, out);
+    break;
+  case NAS_SECURITY_ALGORITHMS_EEA2:
+    nas_stream_encrypt_eea2 (&stream_cipher, out);
+    break;
+  default:
+    memcpy (out, in, length);
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+// encodes the message and protects it with the current uplink NAS COUNT, the length of the PDU or -1
+static int loadgen_ue_encode (loadgen_ue_t * const ue, EMM_msg * const msg, const uint8_t security_header_type, uint8_t * const pdu,
+                              const uint32_t size)
+{
+  uint8_t                                 plain[LOADGEN_NAS_BUFFER_SIZE];
+  uint8_t                                 mac[4] = {0};
+  int                                     length = 0;
+
+  msg->header.protocol_discriminator = EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  msg->header.security_header_type = SECURITY_HEADER_TYPE_NOT_PROTECTED;
+  if (security_header_type == SECURITY_HEADER_TYPE_NOT_PROTECTED) {
+    return emm_msg_encode (msg, pdu, size);
+  }
+  length = emm_msg_encode (msg, plain, sizeof (plain));
+  if ((length <= 0) || (length + LOADGEN_NAS_SECURITY_HEADER_SIZE > size)) {
+    return -1;
+  }
+  pdu[0] = (security_header_type << 4) | EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  pdu[5] = (uint8_t)ue->ul_count;
+  if ((security_header_type == SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED) || (security_header_type == SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED_NEW)) {
+    loadgen_ue_cipher (ue, ue->ul_count, SECU_DIRECTION_UPLINK, plain, length, &pdu[LOADGEN_NAS_SECURITY_HEADER_SIZE]);
+  } else {
+    memcpy (&pdu[LOADGEN_NAS_SECURITY_HEADER_SIZE], plain, length);
+  }
+  // the MAC covers the sequence number and the message
+  loadgen_ue_mac (ue, ue->ul_count, SECU_DIRECTION_UPLINK, &pdu[5], length + 1, mac);
+  memcpy (&pdu[1], mac, 4);
+  ue->ul_count++;
+  return length + LOADGEN_NAS_SECURITY_HEADER_SIZE;
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_ue_send (loadgen_worker_t * const worker, const uint32_t ue_index, EMM_msg * const msg, const uint8_t security_header_type,
+                             const bool initial)
+{
+  loadgen_ue_t                           *ue = &loadgen_ues[ue_index];
+  uint8_t                                 pdu[LOADGEN_NAS_BUFFER_SIZE];
+  const int                               length = loadgen_ue_encode (ue, msg, security_header_type, pdu, sizeof (pdu));
+
+  if (length <= 0) {
+    loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_PROTOCOL);
+    return;
+  }
+  if (((initial) ? loadgen_s1ap_send_initial_ue_message (ue_index, pdu, length) : loadgen_s1ap_send_uplink_nas_transport (ue_index, pdu, length)) < 0) {
+    loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_SEND);
+  }
+}
+
+//------------------------------------------------------------------------------
+// a new S1 connection: new eNB UE S1AP ID, the MME UE S1AP ID comes with the first downlink message
+static void loadgen_ue_new_connection (loadgen_ue_t * const ue)
+{
+  ue->generation++;
+  ue->mme_ue_s1ap_id_valid = false;
+}
+
+//------------------------------------------------------------------------------
+void loadgen_ue_start_attach (loadgen_worker_t * const worker, const uint32_t ue_index)
+{
+  loadgen_ue_t                           *ue = &loadgen_ues[ue_index];
+  EMM_msg                                 msg = worker->attach_request;
+  ImsiEpsMobileIdentity_t                *imsi = &msg.attach_request.oldgutiorimsi.imsi;
+  uint8_t                                 digits[15];
+  uint64_t                                imsi64 = ue->imsi64;
+
+  for (int i = 14; i >= 0; i--, imsi64 /= 10) {
+    digits[i] = imsi64 % 10;
+  }
+  imsi->typeofidentity = EPS_MOBILE_IDENTITY_IMSI;
+  imsi->oddeven = EPS_MOBILE_IDENTITY_ODD;
+  imsi->digit1 = digits[0];
+  imsi->digit2 = digits[1];
+  imsi->digit3 = digits[2];
+  imsi->digit4 = digits[3];
+  imsi->digit5 = digits[4];
+  imsi->digit6 = digits[5];
+  imsi->digit7 = digits[6];
+  imsi->digit8 = digits[7];
+  imsi->digit9 = digits[8];
+  imsi->digit10 = digits[9];
+  imsi->digit11 = digits[10];
+  imsi->digit12 = digits[11];
+  imsi->digit13 = digits[12];
+  imsi->digit14 = digits[13];
+  imsi->digit15 = digits[14];
+  loadgen_ue_new_connection (ue);
+  ue->guti_valid = false;
+  ue->security_valid = false;
+  loadgen_proc_start (worker, ue, LOADGEN_PROC_ATTACH);
+  ue->step = LOADGEN_STEP_AUTHENTICATION_REQUEST;
+  loadgen_ue_send (worker, ue_index, &msg, SECURITY_HEADER_TYPE_NOT_PROTECTED, true);
+}
+
+//------------------------------------------------------------------------------
+// switch off is not used, the MME answers with a Detach Accept
+void loadgen_ue_start_detach (loadgen_worker_t * const worker, const uint32_t ue_index)
+{
+  loadgen_ue_t                           *ue = &loadgen_ues[ue_index];
+  EMM_msg                                 msg = {.header.message_type = DETACH_REQUEST};
+  const bool                              initial = (ue->state == LOADGEN_UE_IDLE);
+
+  msg.detach_request.detachtype.switchoff = DETACH_TYPE_NORMAL_DETACH;
+  msg.detach_request.detachtype.typeofdetach = DETACH_TYPE_EPS;
+  msg.detach_request.naskeysetidentifier.tsc = NAS_KEY_SET_IDENTIFIER_NATIVE;
+  msg.detach_request.naskeysetidentifier.naskeysetidentifier = ue->ksi;
+  msg.detach_request.gutiorimsi.guti = ue->guti;
+  if (initial) {
+    loadgen_ue_new_connection (ue);
+  }
+  loadgen_proc_start (worker, ue, LOADGEN_PROC_DETACH);
+  ue->step = LOADGEN_STEP_DETACH_ACCEPT;
+  // an Initial UE Message is not ciphered (TS 24.301 4.4.5)
+  loadgen_ue_send (worker, ue_index, &msg, (initial) ? SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED : SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED, initial);
+}
+
+//------------------------------------------------------------------------------
+// normal TA updating from ECM-IDLE without active flag, the S1 connection is released after the accept
+void loadgen_ue_start_tau (loadgen_worker_t * const worker, const uint32_t ue_index)
+{
+  loadgen_ue_t                           *ue = &loadgen_ues[ue_index];
+  EMM_msg                                 msg = {.header.message_type = TRACKING_AREA_UPDATE_REQUEST};
+
+  msg.tracking_area_update_request.epsupdatetype.activeflag = 0;
+  msg.tracking_area_update_request.epsupdatetype.epsupdatetypevalue = EPS_UPDATE_TYPE_TA_UPDATING;
+  msg.tracking_area_update_request.naskeysetidentifier.tsc = NAS_KEY_SET_IDENTIFIER_NATIVE;
+  msg.tracking_area_update_request.naskeysetidentifier.naskeysetidentifier = ue->ksi;
+  msg.tracking_area_update_request.oldguti.guti = ue->guti;
+  loadgen_ue_new_connection (ue);
+  loadgen_proc_start (worker, ue, LOADGEN_PROC_TAU);
+  ue->step = LOADGEN_STEP_TAU_ACCEPT;
+  loadgen_ue_send (worker, ue_index, &msg, SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED, true);
+}
+
+//------------------------------------------------------------------------------
+// the Service Request has its own 4 octets header with a short MAC (TS 24.301 9.9.3.28)
+void loadgen_ue_start_service_request (loadgen_worker_t * const worker, const uint32_t ue_index)
+{
+  loadgen_ue_t                           *ue = &loadgen_ues[ue_index];
+  uint8_t                                 pdu[4] = {0};
+  uint8_t                                 mac[4] = {0};
+
+  pdu[0] = (SECURITY_HEADER_TYPE_SERVICE_REQUEST << 4) | EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  pdu[1] = (uint8_t)((ue->ksi << 5) | (ue->ul_count & 0x1F));
+  loadgen_ue_mac (ue, ue->ul_count, SECU_DIRECTION_UPLINK, pdu, 2, mac);
+  pdu[2] = mac[2];
+  pdu[3] = mac[3];
+  ue->ul_count++;
+  loadgen_ue_new_connection (ue);
+  loadgen_proc_start (worker, ue, LOADGEN_PROC_SERVICE_REQUEST);
+  ue->step = LOADGEN_STEP_INITIAL_CONTEXT_SETUP;
+  if (loadgen_s1ap_send_initial_ue_message (ue_index, pdu, sizeof (pdu)) < 0) {
+    loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_SEND);
+  }
+}
+
+//------------------------------------------------------------------------------
+void loadgen_ue_start_idle (loadgen_worker_t * const worker, const uint32_t ue_index)
+{
+  loadgen_ue_t                           *ue = &loadgen_ues[ue_index];
+
+  loadgen_proc_start (worker, ue, LOADGEN_PROC_IDLE);
+  ue->step = LOADGEN_STEP_RELEASE_COMMAND;
+  if (loadgen_s1ap_send_ue_context_release_request (ue_index) < 0) {
+    loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_SEND);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_ue_handle_authentication_request (loadgen_worker_t * const worker, const uint32_t ue_index, authentication_request_msg * const request)
+{
+  loadgen_ue_t                           *ue = &loadgen_ues[ue_index];
+  EMM_msg                                 msg = {.header.message_type = AUTHENTICATION_RESPONSE};
+  uint8_t                                 res[8] = {0};
+  uint8_t                                 ck_ik[32] = {0};
+  uint8_t                                 s[14] = {0};
+  const uint8_t                          *autn = NULL;
+
+  if ((blength (request->authenticationparameterrand) != 16) || (blength (request->authenticationparameterautn) != 16)) {
+    loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_PROTOCOL);
+    return;
+  }
+  autn = (const uint8_t *)bdata (request->authenticationparameterautn);
+  if (loadgen_usim_authenticate (loadgen_config.k, loadgen_config.opc, (const uint8_t *)bdata (request->authenticationparameterrand), autn,
+                                 res, ck_ik, &ck_ik[16]) < 0) {
+    loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_AUTHENTICATION);
+    return;
+  }
+  // KASME (TS 33.401 A.2): FC, serving network ID, SQN xor AK, and their lengths
+  s[0] = 0x10;
+  memcpy (&s[1], loadgen_config.plmn, 3);
+  s[5] = 0x03;
+  memcpy (&s[6], autn, 6);
+  s[13] = 0x06;
+  kdf (ck_ik, 32, s, sizeof (s), ue->kasme, 32);
+  ue->ksi = request->naskeysetidentifierasme.naskeysetidentifier;
+  ue->security_valid = false;
+  ue->step = LOADGEN_STEP_SECURITY_MODE_COMMAND;
+  msg.authentication_response.authenticationresponseparameter = blk2bstr (res, sizeof (res));
+  loadgen_ue_send (worker, ue_index, &msg, SECURITY_HEADER_TYPE_NOT_PROTECTED, false);
+  bdestroy (msg.authentication_response.authenticationresponseparameter);
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_ue_handle_attach_accept (loadgen_worker_t * const worker, const uint32_t ue_index, attach_accept_msg * const accept)
+{
+  loadgen_ue_t                           *ue = &loadgen_ues[ue_index];
+  EMM_msg                                 msg = {.header.message_type = ATTACH_COMPLETE};
+  uint8_t                                 esm[3] = {0};
+
+  if (blength (accept->esmmessagecontainer) < 1) {
+    loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_PROTOCOL);
+    return;
+  }
+  if (accept->presencemask & ATTACH_ACCEPT_GUTI_PRESENT) {
+    ue->guti = accept->guti.guti;
+    ue->guti_valid = true;
+  }
+  // Activate Default EPS Bearer Context Accept of the bearer of the request
+  ue->ebi = ((uint8_t)bchar (accept->esmmessagecontainer, 0)) >> 4;
+  esm[0] = (ue->ebi << 4) | EPS_SESSION_MANAGEMENT_MESSAGE;
+  esm[2] = ACTIVATE_DEFAULT_EPS_BEARER_CONTEXT_ACCEPT;
+  msg.attach_complete.esmmessagecontainer = blk2bstr (esm, sizeof (esm));
+  loadgen_ue_send (worker, ue_index, &msg, SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED, false);
+  bdestroy (msg.attach_complete.esmmessagecontainer);
+  if (ue->proc == LOADGEN_PROC_ATTACH) {
+    loadgen_proc_complete (worker, ue, (ue->guti_valid) ? LOADGEN_UE_CONNECTED : LOADGEN_UE_DEREGISTERED);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void loadgen_ue_handle_tau_accept (loadgen_worker_t * const worker, const uint32_t ue_index, tracking_area_update_accept_msg * const accept)
+{
+  loadgen_ue_t                           *ue = &loadgen_ues[ue_index];
+  EMM_msg                                 msg = {.header.message_type = TRACKING_AREA_UPDATE_COMPLETE};
+
+  if (accept->presencemask & TRACKING_AREA_UPDATE_ACCEPT_GUTI_PRESENT) {
+    ue->guti = accept->guti.guti;
+    loadgen_ue_send (worker, ue_index, &msg, SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED, false);
+    if (ue->proc == LOADGEN_PROC_MAX) {
+      return;
+    }
+  }
+  // no active flag: the S1 connection is released, the MME may do it first
+  ue->step = LOADGEN_STEP_RELEASE_COMMAND;
+  if (loadgen_s1ap_send_ue_context_release_request (ue_index) < 0) {
+    loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_SEND);
+  }
+}
+
+//------------------------------------------------------------------------------
+// the bstrings of the decoded messages the UE handles
+static void loadgen_ue_free_msg (EMM_msg * const msg)
+{
+  switch (msg->header.message_type) {
+  case AUTHENTICATION_REQUEST:
+    bdestroy (msg->authentication_request.authenticationparameterrand);
+    bdestroy (msg->authentication_request.authenticationparameterautn);
+    break;
+  case ATTACH_ACCEPT:
+    bdestroy (msg->attach_accept.esmmessagecontainer);
+    break;
+  default:
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+void loadgen_ue_handle_downlink_nas (loadgen_worker_t * const worker, const uint32_t ue_index, const uint8_t * const nas_pdu, const uint32_t length)
+{
+  loadgen_ue_t                           *ue = &loadgen_ues[ue_index];
+  const uint8_t                           security_header_type = nas_pdu[0] >> 4;
+  uint8_t                                 plain[LOADGEN_NAS_BUFFER_SIZE];
+  const uint8_t                          *message = nas_pdu;
+  uint32_t                                message_length = length;
+  uint32_t                                count = 0;
+  EMM_msg                                 msg = {.header.message_type = 0};
+
+  if ((length < 2) || ((nas_pdu[0] & 0x0F) != EPS_MOBILITY_MANAGEMENT_MESSAGE)) {
+    worker->unexpected_messages++;
+    return;
+  }
+  if (security_header_type != SECURITY_HEADER_TYPE_NOT_PROTECTED) {
+    if ((length <= LOADGEN_NAS_SECURITY_HEADER_SIZE) || (length - LOADGEN_NAS_SECURITY_HEADER_SIZE > sizeof (plain))) {
+      worker->unexpected_messages++;
+      return;
+    }
+    message = &nas_pdu[LOADGEN_NAS_SECURITY_HEADER_SIZE];
+    message_length = length - LOADGEN_NAS_SECURITY_HEADER_SIZE;
+    if ((security_header_type == SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_NEW) || (security_header_type == SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED_NEW)) {
+      count = nas_pdu[5];
+    } else {
+      // 8 bits of sequence number, the overflow is estimated from the next expected count
+      count = (ue->dl_count & ~0xFFU) | nas_pdu[5];
+      if (count < ue->dl_count) {
+        count += 0x100;
+      }
+    }
+    if ((security_header_type == SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED) || (security_header_type == SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED_NEW)) {
+      if (!ue->security_valid) {
+        worker->unexpected_messages++;
+        return;
+      }
+      loadgen_ue_cipher (ue, count, SECU_DIRECTION_DOWNLINK, message, message_length, plain);
+      message = plain;
+    }
+  }
+  if (emm_msg_decode (&msg, (uint8_t *)message, message_length) <= 0) {
+    if (ue->proc != LOADGEN_PROC_MAX) {
+      loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_PROTOCOL);
+    }
+    return;
+  }
+  // the Security Mode Command starts the security context its MAC is checked with
+  if ((msg.header.message_type == SECURITY_MODE_COMMAND) && (ue->proc == LOADGEN_PROC_ATTACH) && (ue->step == LOADGEN_STEP_SECURITY_MODE_COMMAND)) {
+    ue->eea = msg.security_mode_command.selectednassecurityalgorithms.typeofcipheringalgorithm;
+    ue->eia = msg.security_mode_command.selectednassecurityalgorithms.typeofintegrityalgorithm;
+    ue->ksi = msg.security_mode_command.naskeysetidentifier.naskeysetidentifier;
+    derive_key_nas_enc (ue->eea, ue->kasme, ue->knas_enc);
+    derive_key_nas_int (ue->eia, ue->kasme, ue->knas_int);
+    ue->ul_count = 0;
+    ue->dl_count = 0;
+    ue->security_valid = true;
+  }
+  if (security_header_type != SECURITY_HEADER_TYPE_NOT_PROTECTED) {
+    uint8_t                               mac[4] = {0};
+
+    if (!ue->security_valid) {
+      worker->unexpected_messages++;
+      loadgen_ue_free_msg (&msg);
+      return;
+    }
+    loadgen_ue_mac (ue, count, SECU_DIRECTION_DOWNLINK, &nas_pdu[5], length - 5, mac);
+    if (memcmp (mac, &nas_pdu[1], 4)) {
+      if (ue->proc != LOADGEN_PROC_MAX) {
+        loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_INTEGRITY);
+      }
+      loadgen_ue_free_msg (&msg);
+      return;
+    }
+    ue->dl_count = count + 1;
+  }
+
+  switch (msg.header.message_type) {
+  case AUTHENTICATION_REQUEST:
+    if ((ue->proc == LOADGEN_PROC_ATTACH) && (ue->step == LOADGEN_STEP_AUTHENTICATION_REQUEST)) {
+      loadgen_ue_handle_authentication_request (worker, ue_index, &msg.authentication_request);
+    } else {
+      worker->unexpected_messages++;
+    }
+    break;
+
+  case SECURITY_MODE_COMMAND:
+    if ((ue->proc == LOADGEN_PROC_ATTACH) && (ue->step == LOADGEN_STEP_SECURITY_MODE_COMMAND)) {
+      EMM_msg                             complete = {.header.message_type = SECURITY_MODE_COMPLETE};
+
+      // the Attach Accept comes with the Initial Context Setup Request
+      ue->step = LOADGEN_STEP_INITIAL_CONTEXT_SETUP;
+      loadgen_ue_send (worker, ue_index, &complete, SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED_NEW, false);
+    } else {
+      worker->unexpected_messages++;
+    }
+    break;
+
+  case ATTACH_ACCEPT:
+    if ((ue->proc == LOADGEN_PROC_ATTACH) && ((ue->step == LOADGEN_STEP_INITIAL_CONTEXT_SETUP) || (ue->step == LOADGEN_STEP_ATTACH_ACCEPT))) {
+      loadgen_ue_handle_attach_accept (worker, ue_index, &msg.attach_accept);
+    } else {
+      worker->unexpected_messages++;
+    }
+    break;
+
+  case TRACKING_AREA_UPDATE_ACCEPT:
+    if ((ue->proc == LOADGEN_PROC_TAU) && (ue->step == LOADGEN_STEP_TAU_ACCEPT)) {
+      loadgen_ue_handle_tau_accept (worker, ue_index, &msg.tracking_area_update_accept);
+    } else {
+      worker->unexpected_messages++;
+    }
+    break;
+
+  case DETACH_ACCEPT:
+    if ((ue->proc == LOADGEN_PROC_DETACH) && (ue->step == LOADGEN_STEP_DETACH_ACCEPT)) {
+      // the MME releases the S1 connection
+      ue->step = LOADGEN_STEP_RELEASE_COMMAND;
+      ue->guti_valid = false;
+      ue->security_valid = false;
+    } else {
+      worker->unexpected_messages++;
+    }
+    break;
+
+  case ATTACH_REJECT:
+  case AUTHENTICATION_REJECT:
+  case TRACKING_AREA_UPDATE_REJECT:
+  case SERVICE_REJECT:
+    if (ue->proc != LOADGEN_PROC_MAX) {
+      loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_REJECT);
+    } else {
+      worker->unexpected_messages++;
+    }
+    break;
+
+  case EMM_INFORMATION:
+    break;
+
+  default:
+    worker->unexpected_messages++;
+    break;
+  }
+  loadgen_ue_free_msg (&msg);
+}
+
+//------------------------------------------------------------------------------
+void loadgen_ue_handle_initial_context_setup_request (loadgen_worker_t * const worker, const uint32_t ue_index, const uint8_t e_rab_id,
+                                                      const uint8_t * const nas_pdu, const uint32_t length)
+{
+  loadgen_ue_t                           *ue = &loadgen_ues[ue_index];
+
+  if (((ue->proc != LOADGEN_PROC_ATTACH) && (ue->proc != LOADGEN_PROC_SERVICE_REQUEST)) || (ue->step != LOADGEN_STEP_INITIAL_CONTEXT_SETUP)) {
+    worker->unexpected_messages++;
+    return;
+  }
+  if (loadgen_s1ap_send_initial_context_setup_response (ue_index, e_rab_id) < 0) {
+    loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_SEND);
+    return;
+  }
+  if (ue->proc == LOADGEN_PROC_SERVICE_REQUEST) {
+    loadgen_proc_complete (worker, ue, LOADGEN_UE_CONNECTED);
+  } else if (length) {
+    loadgen_ue_handle_downlink_nas (worker, ue_index, nas_pdu, length);
+  } else {
+    // the Attach Accept follows in a Downlink NAS Transport
+    ue->step = LOADGEN_STEP_ATTACH_ACCEPT;
+  }
+}
+
+//------------------------------------------------------------------------------
+void loadgen_ue_handle_ue_context_release_command (loadgen_worker_t * const worker, const uint32_t ue_index)
+{
+  loadgen_ue_t                           *ue = &loadgen_ues[ue_index];
+
+  ue->mme_ue_s1ap_id_valid = false;
+  if (ue->proc == LOADGEN_PROC_MAX) {
+    // released by the MME, inactivity or a late release of a completed procedure
+    if (ue->state == LOADGEN_UE_CONNECTED) {
+      ue->state = LOADGEN_UE_IDLE;
+    }
+    return;
+  }
+  if (ue->step == LOADGEN_STEP_RELEASE_COMMAND) {
+    loadgen_proc_complete (worker, ue, (ue->proc == LOADGEN_PROC_DETACH) ? LOADGEN_UE_DEREGISTERED : LOADGEN_UE_IDLE);
+  } else {
+    loadgen_proc_fail (worker, ue, LOADGEN_FAILURE_PROTOCOL);
+  }
+}
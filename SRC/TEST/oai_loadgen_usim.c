@@ -0,0 +1,62 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oai_loadgen_usim.c
+   \brief USIM side of the EPS AKA for the oai_loadgen UEs. Built with the HSS AuC sources (fx.c,
+          rijndael.c) and their headers, apart from the MME code the rest of oai_loadgen links.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "auc.h"
+#include "oai_loadgen_usim.h"
+
+/* The AuC Rijndael keeps its round keys in globals, one key schedule + encryptions at a time */
+static pthread_mutex_t                  loadgen_usim_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//------------------------------------------------------------------------------
+void loadgen_usim_compute_opc (const uint8_t k[16], const uint8_t op[16], uint8_t opc[16])
+{
+  pthread_mutex_lock (&loadgen_usim_mutex);
+  ComputeOPc (k, op, opc);
+  pthread_mutex_unlock (&loadgen_usim_mutex);
+}
+
+//------------------------------------------------------------------------------
+int loadgen_usim_authenticate (const uint8_t k[16], const uint8_t opc[16], const uint8_t rand[16], const uint8_t autn[16],
+                               uint8_t res[8], uint8_t ck[16], uint8_t ik[16])
+{
+  uint8_t                                 ak[6] = {0};
+  uint8_t                                 sqn[6] = {0};
+  uint8_t                                 xmac[8] = {0};
+
+  pthread_mutex_lock (&loadgen_usim_mutex);
+  f2345 (opc, k, rand, res, ck, ik, ak);
+  // AUTN = SQN xor AK || AMF || MAC
+  for (int i = 0; i < 6; i++) {
+    sqn[i] = autn[i] ^ ak[i];
+  }
+  f1 (opc, k, rand, sqn, &autn[6], xmac);
+  pthread_mutex_unlock (&loadgen_usim_mutex);
+  return (memcmp (xmac, &autn[8], sizeof (xmac)) == 0) ? 0 : -1;
+}
@@ -0,0 +1,41 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oai_loadgen_usim.h
+   \brief USIM side of the EPS AKA for the oai_loadgen UEs, on top of the HSS AuC Milenage
+*/
+
+#ifndef FILE_OAI_LOADGEN_USIM_SEEN
+#define FILE_OAI_LOADGEN_USIM_SEEN
+
+#include <stdint.h>
+
+/** \brief OPc of the operator key OP for the subscriber key K (TS 35.206) **/
+void loadgen_usim_compute_opc(const uint8_t k[16], const uint8_t op[16], uint8_t opc[16]);
+
+/** \brief Checks the MAC of AUTN and computes RES, CK, IK. The SQN is not checked against the
+ *  USIM one: the generator accepts any vector, it never resynchronises.
+ *  @returns 0, or -1 if the MAC of AUTN does not match (wrong K or OPc)
+ **/
+int loadgen_usim_authenticate(const uint8_t k[16], const uint8_t opc[16], const uint8_t rand[16], const uint8_t autn[16],
+                              uint8_t res[8], uint8_t ck[16], uint8_t ik[16]);
+
+#endif /* FILE_OAI_LOADGEN_USIM_SEEN */
@@ -0,0 +1,323 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s11_gtpv2c_scaling_benchmark.c
+   \brief Measures the S11 Create Session transactions per second of 1..N GTPv2-C stack instances,
+          one per thread as the S11 tasks run them, against an in-memory SGW
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "log.h"
+#include "NwLog.h"
+#include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
+#include "NwGtpv2cMsg.h"
+#include "sgw_ie_defs.h"
+
+#define S11_BENCHMARK_MAX_THREADS        (8)
+// transactions in flight per instance, like UEs attaching at the same time
+#define S11_BENCHMARK_WINDOW             (64)
+#define S11_BENCHMARK_QUEUE_SIZE         (2 * S11_BENCHMARK_WINDOW)
+// the SGW holds each answered request for duplicate detection, on a timer of its stack (10000 at most)
+#define S11_BENCHMARK_MAX_TRANSACTIONS   (9000)
+#define S11_BENCHMARK_MME_IP             (0x7F000001)
+#define S11_BENCHMARK_SGW_IP             (0x7F000002)
+#define S11_BENCHMARK_PORT               (2123)
+
+// not assert(): the stack calls must also run in a release build
+#define S11_BENCHMARK_CHECK(cOND)        do { if (!(cOND)) { fprintf (stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #cOND); exit (EXIT_FAILURE); } } while (0)
+
+typedef struct s11_benchmark_queue_s {
+  uint32_t                                head;
+  uint32_t                                tail;
+  uint32_t                                length[S11_BENCHMARK_QUEUE_SIZE];
+  uint8_t                                 buffer[S11_BENCHMARK_QUEUE_SIZE][1024];
+} s11_benchmark_queue_t;
+
+typedef struct s11_benchmark_thread_s {
+  int                                     index;
+  int                                     num_instances;
+  NwGtpv2cStackHandleT                    mme_stack;
+  NwGtpv2cStackHandleT                    sgw_stack;
+  // datagrams are queued rather than processed in the send callback: the stack inserts a transaction after sending it
+  s11_benchmark_queue_t                   to_sgw;
+  s11_benchmark_queue_t                   to_mme;
+  NwGtpv2cTunnelHandleT                   tunnels[S11_BENCHMARK_WINDOW];
+  long                                    num_outstanding;
+  long                                    num_completed;
+  long                                    num_misrouted;
+} s11_benchmark_thread_t;
+
+static long                             num_transactions = S11_BENCHMARK_MAX_TRANSACTIONS;
+
+//------------------------------------------------------------------------------
+static double timespec_diff_sec (const struct timespec * const start, const struct timespec * const end)
+{
+  return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+//------------------------------------------------------------------------------
+static void s11_benchmark_enqueue (s11_benchmark_queue_t * const queue, const uint8_t * const buffer, const uint32_t length)
+{
+  const uint32_t                          slot = queue->tail % S11_BENCHMARK_QUEUE_SIZE;
+
+  if ((queue->tail - queue->head == S11_BENCHMARK_QUEUE_SIZE) || (length > sizeof (queue->buffer[0]))) {
+    fprintf (stderr, "Loopback queue overflow\n");
+    exit (EXIT_FAILURE);
+  }
+  memcpy (queue->buffer[slot], buffer, length);
+  queue->length[slot] = length;
+  queue->tail++;
+}
+
+//------------------------------------------------------------------------------
+static NwRcT s11_benchmark_mme_send (NwGtpv2cUdpHandleT hUdp, uint8_t * buffer, uint32_t length, uint32_t peerIp, uint32_t peerPort)
+{
+  s11_benchmark_enqueue (&((s11_benchmark_thread_t *) hUdp)->to_sgw, buffer, length);
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+static NwRcT s11_benchmark_sgw_send (NwGtpv2cUdpHandleT hUdp, uint8_t * buffer, uint32_t length, uint32_t peerIp, uint32_t peerPort)
+{
+  s11_benchmark_enqueue (&((s11_benchmark_thread_t *) hUdp)->to_mme, buffer, length);
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+// No retransmission in memory: the timers never expire
+static NwRcT s11_benchmark_start_timer (NwGtpv2cTimerMgrHandleT tmrMgrHandle, uint32_t timeoutSec, uint32_t timeoutUsec,
+                                        uint32_t tmrType, void *timeoutArg, NwGtpv2cTimerHandleT * hTmr)
+{
+  *hTmr = (NwGtpv2cTimerHandleT) 1;
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+static NwRcT s11_benchmark_stop_timer (NwGtpv2cTimerMgrHandleT tmrMgrHandle, NwGtpv2cTimerHandleT hTmr)
+{
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+static NwRcT s11_benchmark_log (NwGtpv2cLogMgrHandleT hLogMgr, uint32_t logLevel, NwCharT * file, uint32_t line, NwCharT * logStr)
+{
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+// Create Session Response of the SGW, its S11 TEID is the one of the MME
+static NwRcT s11_benchmark_sgw_ulp (NwGtpv2cUlpHandleT hUlp, NwGtpv2cUlpApiT * pUlpApi)
+{
+  s11_benchmark_thread_t                 *thread = (s11_benchmark_thread_t *) hUlp;
+  NwGtpv2cUlpApiT                         ulp_req = {0};
+  uint8_t                                 if_type = 0;
+  uint32_t                                mme_teid = 0;
+  uint32_t                                ipv4 = 0;
+  uint8_t                                 ipv6[16];
+
+  if ((pUlpApi->apiType != NW_GTPV2C_ULP_API_INITIAL_REQ_IND) || (pUlpApi->apiInfo.initialReqIndInfo.msgType != NW_GTP_CREATE_SESSION_REQ)) {
+    nwGtpv2cMsgDelete (thread->sgw_stack, pUlpApi->hMsg);
+    return NW_OK;
+  }
+  nwGtpv2cMsgGetIeFteid (pUlpApi->hMsg, NW_GTPV2C_IE_INSTANCE_ZERO, &if_type, &mme_teid, &ipv4, ipv6);
+
+  ulp_req.apiType = NW_GTPV2C_ULP_API_TRIGGERED_RSP;
+  ulp_req.apiInfo.triggeredRspInfo.hTrxn = pUlpApi->apiInfo.initialReqIndInfo.hTrxn;
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cMsgNew (thread->sgw_stack, NW_TRUE, NW_GTP_CREATE_SESSION_RSP, mme_teid, nwGtpv2cMsgGetSeqNumber (pUlpApi->hMsg), &ulp_req.hMsg));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cMsgAddIeCause (ulp_req.hMsg, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_CAUSE_REQUEST_ACCEPTED, 0, 0, 0));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cMsgAddIeFteid (ulp_req.hMsg, NW_GTPV2C_IE_INSTANCE_ZERO, S11_SGW_GTP_C, mme_teid, S11_BENCHMARK_SGW_IP, NULL));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cProcessUlpReq (thread->sgw_stack, &ulp_req));
+  nwGtpv2cMsgDelete (thread->sgw_stack, pUlpApi->hMsg);
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+static NwRcT s11_benchmark_mme_ulp (NwGtpv2cUlpHandleT hUlp, NwGtpv2cUlpApiT * pUlpApi)
+{
+  s11_benchmark_thread_t                 *thread = (s11_benchmark_thread_t *) hUlp;
+
+  if (pUlpApi->apiType == NW_GTPV2C_ULP_API_TRIGGERED_RSP_IND) {
+    const intptr_t                        slot = (intptr_t) pUlpApi->apiInfo.triggeredRspIndInfo.hUlpTrxn;
+    NwGtpv2cUlpApiT                       ulp_req = {0};
+
+    nwGtpv2cMsgDelete (thread->mme_stack, pUlpApi->hMsg);
+    // what the MME does once the session is deleted
+    ulp_req.apiType = NW_GTPV2C_ULP_DELETE_LOCAL_TUNNEL;
+    ulp_req.apiInfo.deleteLocalTunnelInfo.hTunnel = thread->tunnels[slot];
+    S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cProcessUlpReq (thread->mme_stack, &ulp_req));
+    thread->tunnels[slot] = 0;
+    thread->num_outstanding--;
+    thread->num_completed++;
+  }
+  return NW_OK;
+}
+
+//------------------------------------------------------------------------------
+static void s11_benchmark_stack_init (s11_benchmark_thread_t * const thread, NwGtpv2cStackHandleT * const stack,
+    NwRcT (*ulp_cb) (NwGtpv2cUlpHandleT, NwGtpv2cUlpApiT *), NwRcT (*udp_cb) (NwGtpv2cUdpHandleT, uint8_t *, uint32_t, uint32_t, uint32_t))
+{
+  NwGtpv2cUlpEntityT                      ulp = {.hUlp = (NwGtpv2cUlpHandleT) thread, .ulpReqCallback = ulp_cb};
+  NwGtpv2cUdpEntityT                      udp = {.hUdp = (NwGtpv2cUdpHandleT) thread, .udpDataReqCallback = udp_cb};
+  NwGtpv2cTimerMgrEntityT                 tmr_mgr = {.tmrMgrHandle = (NwGtpv2cTimerMgrHandleT) thread,
+                                                     .tmrStartCallback = s11_benchmark_start_timer, .tmrStopCallback = s11_benchmark_stop_timer};
+  NwGtpv2cLogMgrEntityT                   log_mgr = {.logMgrHandle = 0, .logReqCallback = s11_benchmark_log};
+
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cInitialize (stack));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cSetUlpEntity (*stack, &ulp));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cSetUdpEntity (*stack, &udp));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cSetTimerMgrEntity (*stack, &tmr_mgr));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cSetLogMgrEntity (*stack, &log_mgr));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cSetLogLevel (*stack, NW_LOG_LEVEL_ERRO));
+}
+
+//------------------------------------------------------------------------------
+// Create Session Request of UE k, its MME S11 TEID is owned by this instance as S11_TASK_ID() selects it
+static void s11_benchmark_create_session_request (s11_benchmark_thread_t * const thread, const long k)
+{
+  const intptr_t                          slot = k % S11_BENCHMARK_WINDOW;
+  const uint32_t                          mme_teid = (uint32_t)((k + 1) * thread->num_instances + thread->index);
+  static const uint8_t                    imsi[] = {0x02, 0x08, 0x01, 0x00, 0x00, 0x00, 0x00, 0xF1};
+  static const uint8_t                    apn[] = {0x08, 'o', 'p', 'e', 'r', 'a', 't', 'o', 'r'};
+  NwGtpv2cUlpApiT                         ulp_req = {0};
+
+  S11_BENCHMARK_CHECK (thread->tunnels[slot] == 0);
+  ulp_req.apiType = NW_GTPV2C_ULP_API_INITIAL_REQ;
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cMsgNew (thread->mme_stack, NW_TRUE, NW_GTP_CREATE_SESSION_REQ, 0, 0, &ulp_req.hMsg));
+  ulp_req.apiInfo.initialReqInfo.peerIp = S11_BENCHMARK_SGW_IP;
+  ulp_req.apiInfo.initialReqInfo.teidLocal = mme_teid;
+  ulp_req.apiInfo.initialReqInfo.hUlpTrxn = (NwGtpv2cUlpTrxnHandleT) slot;
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cMsgAddIe (ulp_req.hMsg, NW_GTPV2C_IE_IMSI, sizeof (imsi), 0, (uint8_t *) imsi));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cMsgAddIeTV1 (ulp_req.hMsg, NW_GTPV2C_IE_RAT_TYPE, 0, 6));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cMsgAddIeFteid (ulp_req.hMsg, NW_GTPV2C_IE_INSTANCE_ZERO, S11_MME_GTP_C, mme_teid, S11_BENCHMARK_MME_IP, NULL));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cMsgAddIeFteid (ulp_req.hMsg, NW_GTPV2C_IE_INSTANCE_ONE, S5_S8_PGW_GTP_C, 0, S11_BENCHMARK_SGW_IP, NULL));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cMsgAddIe (ulp_req.hMsg, NW_GTPV2C_IE_APN, sizeof (apn), 0, (uint8_t *) apn));
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cProcessUlpReq (thread->mme_stack, &ulp_req));
+  thread->tunnels[slot] = ulp_req.apiInfo.initialReqInfo.hTunnel;
+  thread->num_outstanding++;
+}
+
+//------------------------------------------------------------------------------
+static void *s11_benchmark_thread (void *args)
+{
+  s11_benchmark_thread_t                 *thread = (s11_benchmark_thread_t *) args;
+  long                                    num_sent = 0;
+
+  s11_benchmark_stack_init (thread, &thread->mme_stack, s11_benchmark_mme_ulp, s11_benchmark_mme_send);
+  S11_BENCHMARK_CHECK (NW_OK == nwGtpv2cSetSeqNumRange (thread->mme_stack, thread->index, thread->num_instances));
+  s11_benchmark_stack_init (thread, &thread->sgw_stack, s11_benchmark_sgw_ulp, s11_benchmark_sgw_send);
+
+  while (thread->num_completed < num_transactions) {
+    while ((num_sent < num_transactions) && (thread->num_outstanding < S11_BENCHMARK_WINDOW)) {
+      s11_benchmark_create_session_request (thread, num_sent++);
+    }
+    while (thread->to_sgw.head != thread->to_sgw.tail) {
+      const uint32_t                      slot = thread->to_sgw.head++ % S11_BENCHMARK_QUEUE_SIZE;
+
+      nwGtpv2cProcessUdpReq (thread->sgw_stack, thread->to_sgw.buffer[slot], thread->to_sgw.length[slot], S11_BENCHMARK_PORT, S11_BENCHMARK_MME_IP);
+    }
+    while (thread->to_mme.head != thread->to_mme.tail) {
+      const uint32_t                      slot = thread->to_mme.head++ % S11_BENCHMARK_QUEUE_SIZE;
+      uint32_t                            instance = 0;
+
+      // what TASK_S11 does before forwarding the datagram to the task of its instance
+      if ((nwGtpv2cGetUdpReqInstance (thread->to_mme.buffer[slot], thread->to_mme.length[slot], thread->num_instances, &instance) != NW_OK) ||
+          (instance != thread->index)) {
+        thread->num_misrouted++;
+      }
+      nwGtpv2cProcessUdpReq (thread->mme_stack, thread->to_mme.buffer[slot], thread->to_mme.length[slot], S11_BENCHMARK_PORT, S11_BENCHMARK_SGW_IP);
+    }
+  }
+  nwGtpv2cFinalize (thread->mme_stack);
+  nwGtpv2cFinalize (thread->sgw_stack);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void usage (const char * const exe)
+{
+  fprintf (stderr, "Usage: %s [-t max_instances (1..%d)] [-n transactions per instance (1..%d)]\n", exe, S11_BENCHMARK_MAX_THREADS, S11_BENCHMARK_MAX_TRANSACTIONS);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  int                                     max_threads = S11_BENCHMARK_MAX_THREADS;
+  int                                     c = 0;
+
+  while ((c = getopt (argc, argv, "t:n:h")) != -1) {
+    switch (c) {
+    case 't':
+      max_threads = atoi (optarg);
+      break;
+    case 'n':
+      num_transactions = atol (optarg);
+      break;
+    default:
+      usage (argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if ((max_threads < 1) || (max_threads > S11_BENCHMARK_MAX_THREADS) || (num_transactions < 1) || (num_transactions > S11_BENCHMARK_MAX_TRANSACTIONS)) {
+    usage (argv[0]);
+    return EXIT_FAILURE;
+  }
+  // the stack logs its banner and its errors through OAILOG
+  if (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) < 0) {
+    return EXIT_FAILURE;
+  }
+
+  printf ("instances transactions  seconds   trans/s    misrouted\n");
+  for (int n = 1; n <= max_threads; n++) {
+    pthread_t                             threads[S11_BENCHMARK_MAX_THREADS];
+    static s11_benchmark_thread_t         contexts[S11_BENCHMARK_MAX_THREADS];
+    long                                  total_transactions = 0;
+    long                                  total_misrouted = 0;
+    struct timespec                       start = {0};
+    struct timespec                       end = {0};
+
+    memset (contexts, 0, sizeof (contexts));
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    for (int t = 0; t < n; t++) {
+      contexts[t].index = t;
+      contexts[t].num_instances = n;
+      pthread_create (&threads[t], NULL, s11_benchmark_thread, &contexts[t]);
+    }
+    for (int t = 0; t < n; t++) {
+      pthread_join (threads[t], NULL);
+      total_transactions += contexts[t].num_completed;
+      total_misrouted += contexts[t].num_misrouted;
+    }
+    clock_gettime (CLOCK_MONOTONIC, &end);
+
+    double                                seconds = timespec_diff_sec (&start, &end);
+
+    printf ("%-9d %-13ld %-9.3f %-10.0f %ld\n", n, total_transactions, seconds, (double)total_transactions / seconds, total_misrouted);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,242 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s11_udp_echo_benchmark.c
+   \brief Loopback GTPv2-C Echo Request/Response over the S11 UDP transport (udp_mmsg),
+          one datagram per system call versus recvmmsg/sendmmsg batches: messages/s and RTT percentiles
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <arpa/inet.h>
+
+#include "log.h"
+#include "udp_mmsg.h"
+
+#define S11_BENCHMARK_SERVER_PORT   (21230)
+#define S11_BENCHMARK_CLIENT_PORT   (21231)
+#define S11_BENCHMARK_MAX_WINDOW    (4096)
+#define S11_BENCHMARK_TIMEOUT_MS    (100)
+
+#define GTPV2C_ECHO_REQUEST         (1)
+#define GTPV2C_ECHO_RESPONSE        (2)
+#define GTPV2C_IE_RECOVERY          (3)
+
+typedef struct s11_benchmark_server_s {
+  udp_mmsg_endpoint_t                    *endpoint;
+  volatile bool                           stop;
+} s11_benchmark_server_t;
+
+typedef struct s11_benchmark_client_s {
+  struct timespec                         send_time[S11_BENCHMARK_MAX_WINDOW];
+  bool                                    in_flight[S11_BENCHMARK_MAX_WINDOW];
+  double                                 *rtt_us;
+  long                                    num_received;
+  long                                    num_outstanding;
+} s11_benchmark_client_t;
+
+static long                             num_messages = 1000000;
+static int                              window = 256;
+
+//------------------------------------------------------------------------------
+static double timespec_diff_sec (const struct timespec * const start, const struct timespec * const end)
+{
+  return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+//------------------------------------------------------------------------------
+static int compare_double (const void *a, const void *b)
+{
+  const double                            da = *(const double *)a;
+  const double                            db = *(const double *)b;
+
+  return (da > db) - (da < db);
+}
+
+//------------------------------------------------------------------------------
+// What the S11 tasks do per datagram: process it in place and queue the response
+static void s11_benchmark_echo (void *arg, uint8_t * buffer, uint32_t length, uint32_t peer_address, uint16_t peer_port)
+{
+  udp_mmsg_endpoint_t                    *endpoint = (udp_mmsg_endpoint_t *)arg;
+
+  if ((length >= 8) && (GTPV2C_ECHO_REQUEST == buffer[1])) {
+    buffer[1] = GTPV2C_ECHO_RESPONSE;
+    udp_mmsg_send (endpoint, buffer, length, peer_address, peer_port);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void *s11_benchmark_server_thread (void *args)
+{
+  s11_benchmark_server_t                 *server = (s11_benchmark_server_t *)args;
+  struct pollfd                           pfd = {.fd = udp_mmsg_endpoint_get_fd (server->endpoint), .events = POLLIN};
+
+  while (!server->stop) {
+    if (poll (&pfd, 1, S11_BENCHMARK_TIMEOUT_MS) > 0) {
+      udp_mmsg_receive (server->endpoint, s11_benchmark_echo, server->endpoint);
+      udp_mmsg_flush (server->endpoint);
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void s11_benchmark_response (void *arg, uint8_t * buffer, uint32_t length, uint32_t peer_address, uint16_t peer_port)
+{
+  s11_benchmark_client_t                 *client = (s11_benchmark_client_t *)arg;
+  struct timespec                         now = {0};
+  uint32_t                                seq = 0;
+
+  if ((length < 8) || (GTPV2C_ECHO_RESPONSE != buffer[1])) {
+    return;
+  }
+  seq = ((uint32_t)buffer[4] << 16) | ((uint32_t)buffer[5] << 8) | buffer[6];
+  if (!client->in_flight[seq % window]) {
+    // late response of a message declared lost
+    return;
+  }
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  client->in_flight[seq % window] = false;
+  client->rtt_us[client->num_received++] = timespec_diff_sec (&client->send_time[seq % window], &now) * 1e6;
+  client->num_outstanding--;
+}
+
+//------------------------------------------------------------------------------
+static int s11_benchmark_run (const int batch_size)
+{
+  const uint32_t                          loopback = htonl (INADDR_LOOPBACK);
+  s11_benchmark_server_t                  server = {0};
+  s11_benchmark_client_t                  client = {{{0}}};
+  udp_mmsg_endpoint_t                    *client_endpoint = NULL;
+  pthread_t                               server_thread;
+  struct pollfd                           pfd = {0};
+  struct timespec                         start = {0};
+  struct timespec                         end = {0};
+  long                                    num_sent = 0;
+  long                                    num_lost = 0;
+  // Echo Request with a Recovery IE
+  uint8_t                                 echo[] = {0x40, GTPV2C_ECHO_REQUEST, 0x00, 0x09, 0x00, 0x00, 0x00, 0x00,
+                                                    GTPV2C_IE_RECOVERY, 0x00, 0x01, 0x00, 0x01};
+
+  server.endpoint = udp_mmsg_endpoint_create (loopback, S11_BENCHMARK_SERVER_PORT, batch_size);
+  client_endpoint = udp_mmsg_endpoint_create (loopback, S11_BENCHMARK_CLIENT_PORT, batch_size);
+  client.rtt_us = calloc (num_messages, sizeof (double));
+  if ((!server.endpoint) || (!client_endpoint) || (!client.rtt_us)) {
+    fprintf (stderr, "Failed to create the loopback endpoints\n");
+    return -1;
+  }
+  pthread_create (&server_thread, NULL, s11_benchmark_server_thread, &server);
+  pfd.fd = udp_mmsg_endpoint_get_fd (client_endpoint);
+  pfd.events = POLLIN;
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  while ((client.num_received + num_lost) < num_messages) {
+    while ((client.num_outstanding < window) && (num_sent < num_messages)) {
+      const uint32_t                      seq = (uint32_t)num_sent & 0x00FFFFFF;
+
+      echo[4] = (uint8_t)(seq >> 16);
+      echo[5] = (uint8_t)(seq >> 8);
+      echo[6] = (uint8_t)seq;
+      clock_gettime (CLOCK_MONOTONIC, &client.send_time[seq % window]);
+      client.in_flight[seq % window] = true;
+      udp_mmsg_send (client_endpoint, echo, sizeof (echo), loopback, S11_BENCHMARK_SERVER_PORT);
+      client.num_outstanding++;
+      num_sent++;
+    }
+    udp_mmsg_flush (client_endpoint);
+
+    if (poll (&pfd, 1, S11_BENCHMARK_TIMEOUT_MS) <= 0) {
+      // no response in time, the outstanding messages are lost
+      num_lost += client.num_outstanding;
+      client.num_outstanding = 0;
+      memset (client.in_flight, 0, sizeof (client.in_flight));
+      continue;
+    }
+    udp_mmsg_receive (client_endpoint, s11_benchmark_response, &client);
+  }
+  clock_gettime (CLOCK_MONOTONIC, &end);
+
+  server.stop = true;
+  pthread_join (server_thread, NULL);
+  udp_mmsg_endpoint_destroy (server.endpoint);
+  udp_mmsg_endpoint_destroy (client_endpoint);
+
+  const double                            seconds = timespec_diff_sec (&start, &end);
+  double                                  p50 = 0;
+  double                                  p99 = 0;
+
+  if (client.num_received) {
+    qsort (client.rtt_us, client.num_received, sizeof (double), compare_double);
+    p50 = client.rtt_us[(client.num_received * 50) / 100];
+    p99 = client.rtt_us[(client.num_received * 99) / 100];
+  }
+  printf ("%-7d %-10ld %-8ld %-9.3f %-11.0f %-9.1f %.1f\n", batch_size, client.num_received, num_lost, seconds,
+      (double)client.num_received / seconds, p50, p99);
+  free (client.rtt_us);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static void usage (const char * const exe)
+{
+  fprintf (stderr, "Usage: %s [-n messages] [-w window (1..%d)]\n", exe, S11_BENCHMARK_MAX_WINDOW);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  int                                     c = 0;
+
+  while ((c = getopt (argc, argv, "n:w:h")) != -1) {
+    switch (c) {
+    case 'n':
+      num_messages = atol (optarg);
+      break;
+    case 'w':
+      window = atoi (optarg);
+      break;
+    default:
+      usage (argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if ((num_messages < 1) || (window < 1) || (window > S11_BENCHMARK_MAX_WINDOW)) {
+    usage (argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (OAILOG_INIT (LOG_SPGW_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) < 0) {
+    return EXIT_FAILURE;
+  }
+
+  printf ("batch   messages   lost     seconds   msg/s       p50(us)   p99(us)\n");
+  // one datagram per system call, as recvfrom/sendto did, then full batches
+  if ((s11_benchmark_run (1) < 0) || (s11_benchmark_run (UDP_MMSG_BATCH_SIZE) < 0)) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,202 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_enb_memory_benchmark.c
+   \brief Memory taken by the eNB descriptors and their UE collections once thousands of eNBs did their
+          S1 setup, their eNB id lookups, and the UE collections shrinking back when the UEs leave
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "log.h"
+#include "intertask_interface_init.h"
+#include "hashtable.h"
+#include "dynamic_memory_check.h"
+#include "mme_config.h"
+#include "s1ap_mme.h"
+
+extern hash_table_ts_t                  g_s1ap_enb_coll;
+extern hash_table_ts_t                  g_s1ap_enb_id2assoc_id_coll;
+
+static long                             num_enbs = 2000;
+static long                             num_ues_per_enb = 64;
+static long                             num_lookups = 1000000;
+
+//------------------------------------------------------------------------------
+static double now_sec (void)
+{
+  struct timespec                         ts = {0};
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+//------------------------------------------------------------------------------
+// resident set, the bucket mutexes are written by their init so they are all resident
+static size_t rss_bytes (void)
+{
+  FILE                                   *f = fopen ("/proc/self/statm", "r");
+  unsigned long                           size = 0;
+  unsigned long                           resident = 0;
+
+  if (f) {
+    if (fscanf (f, "%lu %lu", &size, &resident) != 2) {
+      resident = 0;
+    }
+    fclose (f);
+  }
+  return (size_t)resident * (size_t)sysconf (_SC_PAGESIZE);
+}
+
+//------------------------------------------------------------------------------
+static size_t ue_coll_bytes (void)
+{
+  size_t                                  bytes = 0;
+
+  for (long e = 0; e < num_enbs; e++) {
+    enb_description_t                    *enb_ref = s1ap_is_enb_assoc_id_in_list ((sctp_assoc_id_t)(e + 1));
+
+    bytes += enb_ref->ue_coll.size * (sizeof (hash_node_t *) + sizeof (pthread_mutex_t));
+  }
+  return bytes;
+}
+
+//------------------------------------------------------------------------------
+// the S1AP side of SCTP_NEW_ASSOCIATION then S1 SETUP REQUEST, then INITIAL UE MESSAGEs
+static void setup_enbs (void)
+{
+  for (long e = 0; e < num_enbs; e++) {
+    enb_description_t                    *enb_ref = s1ap_new_enb ();
+
+    enb_ref->sctp_assoc_id = (sctp_assoc_id_t)(e + 1);
+    hashtable_ts_insert (&g_s1ap_enb_coll, (const hash_key_t)enb_ref->sctp_assoc_id, (void *)enb_ref);
+    s1ap_set_enb_id (enb_ref, (uint32_t)(0xE0000 + e));
+    enb_ref->s1_state = S1AP_READY;
+    for (long u = 0; u < num_ues_per_enb; u++) {
+      if (!s1ap_new_ue (enb_ref->sctp_assoc_id, (enb_ue_s1ap_id_t)u)) {
+        fprintf (stderr, "Failed to add UE %ld to eNB %ld\n", u, e);
+        exit (EXIT_FAILURE);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void lookup_enbs (void)
+{
+  double                                  start = now_sec ();
+
+  for (long i = 0; i < num_lookups; i++) {
+    const long                            e = (i * 7919) % num_enbs;
+
+    if (!s1ap_is_enb_id_in_list ((uint32_t)(0xE0000 + e))) {
+      fprintf (stderr, "eNB id %lx not found\n", 0xE0000 + e);
+      exit (EXIT_FAILURE);
+    }
+  }
+  printf ("eNB id lookup            %9.1f ns\n", (now_sec () - start) * 1e9 / (double)num_lookups);
+}
+
+//------------------------------------------------------------------------------
+static void release_ues (const long num_ues_left)
+{
+  for (long e = 0; e < num_enbs; e++) {
+    enb_description_t                    *enb_ref = s1ap_is_enb_assoc_id_in_list ((sctp_assoc_id_t)(e + 1));
+
+    for (long u = num_ues_left; u < num_ues_per_enb; u++) {
+      s1ap_remove_ue (s1ap_is_ue_enb_id_in_list (enb_ref, (enb_ue_s1ap_id_t)u));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  int                                     c = 0;
+  size_t                                  rss = 0;
+  bstring                                 bs = NULL;
+
+  while ((c = getopt (argc, argv, "e:u:m:n:h")) != -1) {
+    switch (c) {
+    case 'e':
+      num_enbs = atol (optarg);
+      break;
+    case 'u':
+      num_ues_per_enb = atol (optarg);
+      break;
+    case 'm':
+      mme_config.max_ues = (uint32_t)atol (optarg);
+      break;
+    case 'n':
+      num_lookups = atol (optarg);
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-e eNBs] [-u UEs per eNB] [-m MME max UEs] [-n lookups]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (!mme_config.max_ues) {
+    mme_config.max_ues = 1000000;
+  }
+  if ((num_enbs < 1) || (num_ues_per_enb < 1) || (num_lookups < 1)) {
+    return EXIT_FAILURE;
+  }
+  if (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) < 0) {
+    return EXIT_FAILURE;
+  }
+  if (itti_init (TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info, NULL, NULL) < 0) {
+    return EXIT_FAILURE;
+  }
+  // what s1ap_mme_init() allocates, without the S1AP task
+  mme_config.max_enbs = (uint32_t)num_enbs;
+  bs = bfromcstr ("s1ap_eNB_coll");
+  hashtable_ts_init (&g_s1ap_enb_coll, mme_config.max_enbs, NULL, free_wrapper, bs);
+  bdestroy (bs);
+  bs = bfromcstr ("s1ap_enb_id2assoc_id_coll");
+  hashtable_ts_init (&g_s1ap_enb_id2assoc_id_coll, mme_config.max_enbs, NULL, hash_free_int_func, bs);
+  bdestroy (bs);
+
+  rss = rss_bytes ();
+  setup_enbs ();
+  rss = rss_bytes () - rss;
+  printf ("%ld eNBs, %ld UEs per eNB\n", num_enbs, num_ues_per_enb);
+  printf ("resident after S1 setup  %9zu KiB, %zu bytes per eNB\n", rss >> 10, rss / (size_t)num_enbs);
+  printf ("UE collection buckets    %9zu KiB\n", ue_coll_bytes () >> 10);
+  printf ("  sized for max_ues %u   %9zu KiB\n", mme_config.max_ues,
+          ((size_t)num_enbs * mme_config.max_ues * (sizeof (hash_node_t *) + sizeof (pthread_mutex_t))) >> 10);
+  lookup_enbs ();
+
+  release_ues (1);
+  printf ("UE collection buckets    %9zu KiB with 1 UE per eNB\n", ue_coll_bytes () >> 10);
+  release_ues (0);
+  for (long e = 0; e < num_enbs; e++) {
+    s1ap_remove_enb (s1ap_is_enb_assoc_id_in_list ((sctp_assoc_id_t)(e + 1)));
+  }
+  return EXIT_SUCCESS;
+}
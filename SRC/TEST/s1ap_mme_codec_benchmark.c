@@ -0,0 +1,367 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_codec_benchmark.c
+   \brief Measures the S1AP PDUs decoded/encoded per second by 1..N concurrent codec threads,
+          the asn1c allocations per decoded PDU with and without a per-PDU arena, and the cost of
+          decoding an InitialUEMessage with the C library (as before the arena) and in an arena
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "log.h"
+#include "intertask_interface_init.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme_decoder.h"
+#include "s1ap_mme_encoder.h"
+#include "conversions.h"
+#include "dynamic_memory_check.h"
+#include "mem_arena.h"
+
+#include "test_s1ap_pdus.h"
+
+#define S1AP_BENCHMARK_MAX_THREADS   (16)
+
+static uint8_t                          nas_pdu[] = {0x27, 0x9D, 0x4E, 0x6B, 0x70, 0x04, 0x07, 0x42, 0x01, 0x49};
+
+// Attach Request with a PDN Connectivity Request, the NAS PDU of the InitialUEMessage
+static uint8_t                          attach_request_pdu[] = {
+  0x07, 0x41, 0x71, 0x08, 0x09, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x10, 0x02, 0xE0, 0xE0, 0x00,
+  0x04, 0x02, 0x01, 0xD0, 0x11, 0x52, 0x02, 0xF8, 0x39, 0x00, 0x01, 0x5C, 0x0A, 0x00
+};
+
+static long                             num_iterations = 100000;
+static bool                             use_arena = false;
+
+//------------------------------------------------------------------------------
+static double timespec_diff_sec (const struct timespec * const start, const struct timespec * const end)
+{
+  return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t s1ap_benchmark_cycles (void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc ();
+#else
+  return 0;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// The InitialUEMessage an eNB sends for an attach, the test PDU set has none
+static bstring s1ap_benchmark_initial_ue_message (void)
+{
+  S1ap_InitialUEMessageIEs_t              ies = {0};
+  S1ap_InitialUEMessage_t                 initial_ue_message = {0};
+  uint8_t                                *buffer = NULL;
+  uint32_t                                length = 0;
+  bstring                                 b = NULL;
+
+  ies.eNB_UE_S1AP_ID = 1;
+  OCTET_STRING_fromBuf (&ies.nas_pdu, (char *)attach_request_pdu, sizeof (attach_request_pdu));
+  MCC_MNC_TO_TBCD (208, 93, 2, &ies.tai.pLMNidentity);
+  TAC_TO_ASN1 (1, &ies.tai.tAC);
+  MCC_MNC_TO_TBCD (208, 93, 2, &ies.eutran_cgi.pLMNidentity);
+  MACRO_ENB_ID_TO_CELL_IDENTITY (0xE000, 0, &ies.eutran_cgi.cell_ID);
+  ies.rrC_Establishment_Cause = S1ap_RRC_Establishment_Cause_mo_Signalling;
+  if ((s1ap_encode_s1ap_initialuemessageies (&initial_ue_message, &ies) < 0) ||
+      (s1ap_generate_initiating_message (&buffer, &length, S1ap_ProcedureCode_id_initialUEMessage, S1ap_Criticality_ignore,
+                                         &asn_DEF_S1ap_InitialUEMessage, &initial_ue_message) < 0)) {
+    fprintf (stderr, "Failed to encode InitialUEMessage\n");
+    exit (EXIT_FAILURE);
+  }
+  b = blk2bstr (buffer, length);
+  free_wrapper ((void**) &buffer);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &ies.nas_pdu);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAI, &ies.tai);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_EUTRAN_CGI, &ies.eutran_cgi);
+  return b;
+}
+
+//------------------------------------------------------------------------------
+// The decoder leaves the IEs of a PDU decoded out of an arena to the caller, as the handlers get them
+static void s1ap_benchmark_free_ies (s1ap_message * const message)
+{
+  switch (message->procedureCode) {
+  case S1ap_ProcedureCode_id_initialUEMessage:
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &message->msg.s1ap_InitialUEMessageIEs.nas_pdu);
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAI, &message->msg.s1ap_InitialUEMessageIEs.tai);
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_EUTRAN_CGI, &message->msg.s1ap_InitialUEMessageIEs.eutran_cgi);
+    break;
+
+  case S1ap_ProcedureCode_id_uplinkNASTransport:
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &message->msg.s1ap_UplinkNASTransportIEs.nas_pdu);
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_EUTRAN_CGI, &message->msg.s1ap_UplinkNASTransportIEs.eutran_cgi);
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAI, &message->msg.s1ap_UplinkNASTransportIEs.tai);
+    break;
+
+  case S1ap_ProcedureCode_id_UECapabilityInfoIndication:
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_UERadioCapability, &message->msg.s1ap_UECapabilityInfoIndicationIEs.ueRadioCapability);
+    break;
+
+  case S1ap_ProcedureCode_id_InitialContextSetup:
+    // the response, the only Initial Context Setup PDU an eNB sends
+    for (int i = 0; i < message->msg.s1ap_InitialContextSetupResponseIEs.e_RABSetupListCtxtSURes.s1ap_E_RABSetupItemCtxtSURes.count; i++) {
+      ASN_STRUCT_FREE (asn_DEF_S1ap_E_RABSetupItemCtxtSURes,
+          message->msg.s1ap_InitialContextSetupResponseIEs.e_RABSetupListCtxtSURes.s1ap_E_RABSetupItemCtxtSURes.array[i]);
+    }
+    free (message->msg.s1ap_InitialContextSetupResponseIEs.e_RABSetupListCtxtSURes.s1ap_E_RABSetupItemCtxtSURes.array);
+    break;
+
+  default:
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void *s1ap_benchmark_thread (void *args)
+{
+  long                                   *num_pdus = (long *)args;
+  mem_arena_t                            *arena = use_arena ? mem_arena_create (0) : NULL;
+
+  for (long i = 0; i < num_iterations; i++) {
+    // decode what an eNB sends
+    for (int t = 0; t < sizeof (s1ap_test) / sizeof (s1ap_test_t); t++) {
+      if (s1ap_test[t].originating == ENB) {
+        s1ap_message                      message = {0};
+        bstring                           b = blk2bstr (s1ap_test[t].buffer, s1ap_test[t].buf_len);
+        mem_arena_t                      *previous = mem_arena_enter (arena);
+
+        if (s1ap_mme_decode_pdu (&message, b) < 0) {
+          fprintf (stderr, "Failed to decode %s\n", s1ap_test[t].procedure_name);
+          exit (EXIT_FAILURE);
+        }
+        mem_arena_leave (previous);
+        if (arena) {
+          mem_arena_reset (arena);
+        } else {
+          s1ap_benchmark_free_ies (&message);
+        }
+        bdestroy (b);
+        *num_pdus += 1;
+      }
+    }
+    // encode what the MME sends the most
+    {
+      s1ap_message                        message = {0};
+      S1ap_DownlinkNASTransportIEs_t     *downlinkNasTransport = &message.msg.s1ap_DownlinkNASTransportIEs;
+      uint8_t                            *buffer_p = NULL;
+      uint32_t                            length = 0;
+
+      message.procedureCode = S1ap_ProcedureCode_id_downlinkNASTransport;
+      message.direction = S1AP_PDU_PR_initiatingMessage;
+      downlinkNasTransport->mme_ue_s1ap_id = (mme_ue_s1ap_id_t)(i + 1);
+      downlinkNasTransport->eNB_UE_S1AP_ID = (enb_ue_s1ap_id_t)(i & 0x00FFFFFF);
+      OCTET_STRING_fromBuf (&downlinkNasTransport->nas_pdu, (char *)nas_pdu, sizeof (nas_pdu));
+      if (s1ap_mme_encode_pdu (&message, &buffer_p, &length) < 0) {
+        fprintf (stderr, "Failed to encode DownlinkNASTransport\n");
+        exit (EXIT_FAILURE);
+      }
+      free_wrapper ((void**) &buffer_p);
+      ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &downlinkNasTransport->nas_pdu);
+      *num_pdus += 1;
+    }
+  }
+  mem_arena_destroy (&arena);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_benchmark_pdu_allocations (const char * const name, const_bstring const pdu, mem_arena_t * const arena)
+{
+  s1ap_message                            message = {0};
+  mem_arena_stats_t                       before = {0};
+  mem_arena_stats_t                       after = {0};
+  mem_arena_t                            *previous = NULL;
+  uint64_t                                libc_allocs = 0;
+
+  mem_arena_thread_stats (&before);
+  if (s1ap_mme_decode_pdu (&message, pdu) < 0) {
+    fprintf (stderr, "Failed to decode %s\n", name);
+    exit (EXIT_FAILURE);
+  }
+  mem_arena_thread_stats (&after);
+  libc_allocs = after.nb_libc_allocs - before.nb_libc_allocs;
+  s1ap_benchmark_free_ies (&message);
+
+  memset (&message, 0, sizeof (message));
+  mem_arena_thread_stats (&before);
+  previous = mem_arena_enter (arena);
+  if (s1ap_mme_decode_pdu (&message, pdu) < 0) {
+    fprintf (stderr, "Failed to decode %s\n", name);
+    exit (EXIT_FAILURE);
+  }
+  mem_arena_leave (previous);
+  mem_arena_thread_stats (&after);
+  printf ("%-37s %-12" PRIu64 " %-13" PRIu64 " %zu\n", name, libc_allocs,
+      after.nb_arena_allocs - before.nb_arena_allocs, mem_arena_used (arena));
+  mem_arena_reset (arena);
+}
+
+//------------------------------------------------------------------------------
+// Hooked asn1c allocations of one decode of each PDU an eNB sends, out of and in an arena
+static void s1ap_benchmark_allocations (const_bstring const initial_ue_message)
+{
+  mem_arena_t                            *arena = mem_arena_create (0);
+
+  printf ("PDU                                   libc allocs  arena allocs  arena bytes\n");
+  s1ap_benchmark_pdu_allocations ("Initial UE message", initial_ue_message, arena);
+  for (int t = 0; t < sizeof (s1ap_test) / sizeof (s1ap_test_t); t++) {
+    if (s1ap_test[t].originating == ENB) {
+      bstring                             b = blk2bstr (s1ap_test[t].buffer, s1ap_test[t].buf_len);
+
+      s1ap_benchmark_pdu_allocations (s1ap_test[t].procedure_name, b, arena);
+      bdestroy (b);
+    }
+  }
+  // not hooked, the 10000 bytes XER log buffer is one more calloc per PDU without arena
+  printf ("(without arena, +1 calloc of the XER log buffer per PDU)\n\n");
+  mem_arena_destroy (&arena);
+}
+
+//------------------------------------------------------------------------------
+// Decodes of an InitialUEMessage on one thread: with the C library as before the per-PDU arena,
+// its IEs freed as the handlers would have had to, then in an arena reset after each PDU
+static void s1ap_benchmark_initial_ue_message_cost (const_bstring const initial_ue_message)
+{
+  mem_arena_t                            *arena = mem_arena_create (0);
+
+  printf ("InitialUEMessage decode  ns/PDU    cycles/PDU  hooked allocs/PDU\n");
+  for (int with_arena = 0; with_arena < 2; with_arena++) {
+    mem_arena_stats_t                     before = {0};
+    mem_arena_stats_t                     after = {0};
+    struct timespec                       start = {0};
+    struct timespec                       end = {0};
+    uint64_t                              start_cycles = 0;
+    uint64_t                              cycles = 0;
+
+    mem_arena_thread_stats (&before);
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    start_cycles = s1ap_benchmark_cycles ();
+    for (long i = 0; i < num_iterations; i++) {
+      s1ap_message                        message = {0};
+      mem_arena_t                        *previous = mem_arena_enter (with_arena ? arena : NULL);
+
+      if (s1ap_mme_decode_pdu (&message, initial_ue_message) < 0) {
+        fprintf (stderr, "Failed to decode InitialUEMessage\n");
+        exit (EXIT_FAILURE);
+      }
+      mem_arena_leave (previous);
+      if (with_arena) {
+        mem_arena_reset (arena);
+      } else {
+        s1ap_benchmark_free_ies (&message);
+      }
+    }
+    cycles = s1ap_benchmark_cycles () - start_cycles;
+    clock_gettime (CLOCK_MONOTONIC, &end);
+    mem_arena_thread_stats (&after);
+    printf ("%-24s %-9.0f %-11.0f %.1f\n", with_arena ? "in a per-PDU arena" : "libc (before arena)",
+        timespec_diff_sec (&start, &end) * 1e9 / (double)num_iterations, (double)cycles / (double)num_iterations,
+        (double)((after.nb_libc_allocs - before.nb_libc_allocs) + (after.nb_arena_allocs - before.nb_arena_allocs)) / (double)num_iterations);
+  }
+  printf ("\n");
+  mem_arena_destroy (&arena);
+}
+
+//------------------------------------------------------------------------------
+static void usage (const char * const exe)
+{
+  fprintf (stderr, "Usage: %s [-t max_threads (1..%d)] [-n iterations] [-a (decode in a per-PDU arena)]\n", exe, S1AP_BENCHMARK_MAX_THREADS);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  int                                     max_threads = 4;
+  int                                     c = 0;
+  bstring                                 initial_ue_message = NULL;
+
+  while ((c = getopt (argc, argv, "t:n:ah")) != -1) {
+    switch (c) {
+    case 't':
+      max_threads = atoi (optarg);
+      break;
+    case 'n':
+      num_iterations = atol (optarg);
+      break;
+    case 'a':
+      use_arena = true;
+      break;
+    default:
+      usage (argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if ((max_threads < 1) || (max_threads > S1AP_BENCHMARK_MAX_THREADS) || (num_iterations < 1)) {
+    usage (argv[0]);
+    return EXIT_FAILURE;
+  }
+  // the decoder logs the XER form of the PDUs through ITTI
+  if (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) < 0) {
+    return EXIT_FAILURE;
+  }
+  if (itti_init (TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info, NULL, NULL) < 0) {
+    return EXIT_FAILURE;
+  }
+
+  initial_ue_message = s1ap_benchmark_initial_ue_message ();
+  s1ap_benchmark_allocations (initial_ue_message);
+  s1ap_benchmark_initial_ue_message_cost (initial_ue_message);
+  bdestroy (initial_ue_message);
+
+  printf ("decode %s arena\n", use_arena ? "in a per-PDU" : "without");
+  printf ("threads   PDUs          seconds   PDUs/s\n");
+  for (int n = 1; n <= max_threads; n++) {
+    pthread_t                             threads[S1AP_BENCHMARK_MAX_THREADS];
+    long                                  num_pdus[S1AP_BENCHMARK_MAX_THREADS] = {0};
+    long                                  total_pdus = 0;
+    struct timespec                       start = {0};
+    struct timespec                       end = {0};
+
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    for (int t = 0; t < n; t++) {
+      pthread_create (&threads[t], NULL, s1ap_benchmark_thread, &num_pdus[t]);
+    }
+    for (int t = 0; t < n; t++) {
+      pthread_join (threads[t], NULL);
+      total_pdus += num_pdus[t];
+    }
+    clock_gettime (CLOCK_MONOTONIC, &end);
+
+    double                                seconds = timespec_diff_sec (&start, &end);
+
+    printf ("%-9d %-13ld %-9.3f %.0f\n", n, total_pdus, seconds, (double)total_pdus / seconds);
+  }
+  return EXIT_SUCCESS;
+}
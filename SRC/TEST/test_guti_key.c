@@ -0,0 +1,113 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common_defs.h"
+#include "common_types.h"
+#include "guti_key.h"
+
+static void guti_set(guti_t *guti, const int mcc, const int mnc, const uint32_t m_tmsi)
+{
+    memset(guti, 0, sizeof(*guti));
+    guti->gummei.plmn.mcc_digit1 = (mcc / 100) % 10;
+    guti->gummei.plmn.mcc_digit2 = (mcc / 10) % 10;
+    guti->gummei.plmn.mcc_digit3 = mcc % 10;
+    guti->gummei.plmn.mnc_digit1 = (mnc / 10) % 10;
+    guti->gummei.plmn.mnc_digit2 = mnc % 10;
+    guti->gummei.plmn.mnc_digit3 = 0xF;
+    guti->gummei.mme_gid = 4;
+    guti->gummei.mme_code = 1;
+    guti->m_tmsi = m_tmsi;
+}
+
+START_TEST(guti_key_plmn_test)
+{
+    guti_t a, b;
+    guti_key_t key_a = INVALID_GUTI_KEY;
+    guti_key_t key_b = INVALID_GUTI_KEY;
+
+    /* 208/93 and 209/83 gave the same key when the PLMN octets were XORed */
+    guti_set(&a, 208, 93, 0x12345678);
+    guti_set(&b, 209, 83, 0x12345678);
+
+    /* Nothing of the PLMN was inserted yet, nothing to find */
+    ck_assert(guti_key(&a) == INVALID_GUTI_KEY);
+
+    ck_assert_int_eq(guti_key_new(&a, &key_a), RETURNok);
+    ck_assert_int_eq(guti_key_new(&b, &key_b), RETURNok);
+    ck_assert(key_a != INVALID_GUTI_KEY);
+    ck_assert(key_b != INVALID_GUTI_KEY);
+    ck_assert(key_a != key_b);
+    ck_assert(guti_key(&a) == key_a);
+    ck_assert(guti_key(&b) == key_b);
+
+    /* Only the PLMN is indexed, the rest of the GUTI is in the key as it is */
+    a.m_tmsi = 0x87654321;
+    ck_assert(guti_key(&a) != key_a);
+    ck_assert(guti_key(&a) != INVALID_GUTI_KEY);
+}
+END_TEST
+
+START_TEST(guti_key_full_test)
+{
+    guti_t guti;
+    guti_key_t key = INVALID_GUTI_KEY;
+    guti_key_t first = INVALID_GUTI_KEY;
+    int i;
+
+    guti_set(&guti, 100, 1, 1);
+    ck_assert_int_eq(guti_key_new(&guti, &first), RETURNok);
+    /* Other tests may have indexed PLMNs already, the table fills before the loop ends */
+    for (i = 1; i <= GUTI_KEY_PLMNS_MAX; i++) {
+        guti_set(&guti, 100 + i, 1, 1);
+        if (guti_key_new(&guti, &key) != RETURNok) {
+            break;
+        }
+    }
+    ck_assert(i <= GUTI_KEY_PLMNS_MAX);
+    /* One PLMN too many: refused rather than sharing a key */
+    ck_assert(key == INVALID_GUTI_KEY);
+    ck_assert(guti_key(&guti) == INVALID_GUTI_KEY);
+
+    /* The PLMNs already indexed keep their keys */
+    guti_set(&guti, 100, 1, 1);
+    ck_assert(guti_key(&guti) == first);
+    ck_assert_int_eq(guti_key_new(&guti, &key), RETURNok);
+    ck_assert(key == first);
+}
+END_TEST
+
+Suite * guti_key_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("GUTI key tests");
+
+    /* Core test case */
+    tc_core = tcase_create("GUTI key test");
+    tcase_add_test(tc_core, guti_key_plmn_test);
+    /* fills the PLMN table, last */
+    tcase_add_test(tc_core, guti_key_full_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = guti_key_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
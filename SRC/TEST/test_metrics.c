@@ -0,0 +1,156 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "metrics.h"
+
+#define TEST_NB_THREADS     8
+#define TEST_NB_INCREMENTS  1000000
+
+static metric_id_t test_counter;
+static metric_id_t test_gauge;
+
+static void *increment_thread(void *args)
+{
+    (void)args;
+    for (int i = 0; i < TEST_NB_INCREMENTS; i++) {
+        metrics_inc(test_counter);
+        metrics_inc(test_gauge);
+    }
+    return NULL;
+}
+
+static void *decrement_thread(void *args)
+{
+    (void)args;
+    for (int i = 0; i < TEST_NB_INCREMENTS; i++) {
+        metrics_dec(test_gauge);
+    }
+    return NULL;
+}
+
+START_TEST(metrics_threads_test)
+{
+    pthread_t threads[TEST_NB_THREADS];
+    int i;
+
+    test_counter = metrics_register("test_events_total", METRIC_COUNTER, "Test events", "thread=\"any\"");
+    test_gauge = metrics_register("test_in_progress", METRIC_GAUGE, "Test events in progress", NULL);
+    ck_assert(test_counter >= 0);
+    ck_assert(test_gauge >= 0);
+
+    /* Every thread writes its own values, the read sums them */
+    for (i = 0; i < TEST_NB_THREADS; i++) {
+        ck_assert(pthread_create(&threads[i], NULL, increment_thread, NULL) == 0);
+    }
+    for (i = 0; i < TEST_NB_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    ck_assert_int_eq(metrics_get(test_counter), (int64_t)TEST_NB_THREADS * TEST_NB_INCREMENTS);
+    ck_assert_int_eq(metrics_get(test_gauge), (int64_t)TEST_NB_THREADS * TEST_NB_INCREMENTS);
+
+    /* A gauge goes down on other threads than the ones that made it go up */
+    for (i = 0; i < TEST_NB_THREADS; i++) {
+        ck_assert(pthread_create(&threads[i], NULL, decrement_thread, NULL) == 0);
+    }
+    for (i = 0; i < TEST_NB_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    ck_assert_int_eq(metrics_get(test_gauge), 0);
+    ck_assert_int_eq(metrics_get(test_counter), (int64_t)TEST_NB_THREADS * TEST_NB_INCREMENTS);
+}
+END_TEST
+
+START_TEST(metrics_register_test)
+{
+    const metric_id_t ok = metrics_register("test_messages_total", METRIC_COUNTER, "Test messages", "result=\"%s\"", "ok");
+    const metric_id_t error = metrics_register("test_messages_total", METRIC_COUNTER, "Test messages", "result=\"%s\"", "error");
+    const metric_id_t plain = metrics_register("test_plain_total", METRIC_COUNTER, "Test plain counter", NULL);
+
+    ck_assert(ok >= 0);
+    ck_assert(ok != error);
+    ck_assert(plain != ok);
+    /* Registering a series again, from any module, gives back the same one */
+    ck_assert(metrics_register("test_messages_total", METRIC_COUNTER, "Test messages", "result=\"ok\"") == ok);
+    ck_assert(metrics_register("test_plain_total", METRIC_COUNTER, "Test plain counter", NULL) == plain);
+
+    metrics_add(ok, 3);
+    metrics_inc(error);
+    metrics_inc(plain);
+
+    bstring b = bfromcstr("");
+    metrics_render(b);
+    ck_assert(strstr(bdata(b), "# HELP test_messages_total Test messages\n") != NULL);
+    ck_assert(strstr(bdata(b), "# TYPE test_messages_total counter\n") != NULL);
+    ck_assert(strstr(bdata(b), "test_messages_total{result=\"ok\"} 3\n") != NULL);
+    ck_assert(strstr(bdata(b), "test_messages_total{result=\"error\"} 1\n") != NULL);
+    ck_assert(strstr(bdata(b), "test_plain_total 1\n") != NULL);
+    /* One header per family, whatever the number of its series */
+    ck_assert(strstr(strstr(bdata(b), "# TYPE test_messages_total") + 1, "# TYPE test_messages_total") == NULL);
+    bdestroy(b);
+}
+END_TEST
+
+START_TEST(metrics_full_registry_test)
+{
+    metric_id_t id = 0;
+    int i = 0;
+
+    /* Past the last slot the series are not exported but can still be updated */
+    for (i = 0; i < METRICS_SERIES_MAX; i++) {
+        id = metrics_register("test_full_total", METRIC_COUNTER, "Test full registry", "i=\"%d\"", i);
+        if (METRICS_SINK_ID == id) {
+            break;
+        }
+    }
+    ck_assert_int_eq(id, METRICS_SINK_ID);
+    metrics_inc(id);
+
+    bstring b = bfromcstr("");
+    metrics_render(b);
+    ck_assert(strstr(bdata(b), "test_full_total{i=\"0\"} 0\n") != NULL);
+    char sink_labels[32];
+    snprintf(sink_labels, sizeof(sink_labels), "{i=\"%d\"}", i);
+    ck_assert(strstr(bdata(b), sink_labels) == NULL);
+    bdestroy(b);
+}
+END_TEST
+
+Suite * metrics_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Metrics tests");
+
+    /* Core test case */
+    tc_core = tcase_create("Metrics test");
+    tcase_set_timeout(tc_core, 60);
+    tcase_add_test(tc_core, metrics_threads_test);
+    tcase_add_test(tc_core, metrics_register_test);
+    /* fills the registry, last */
+    tcase_add_test(tc_core, metrics_full_registry_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = metrics_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,183 @@
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "common_defs.h"
+#include "common_types.h"
+#include "mme_app_subscription_profile.h"
+
+#define TEST_NB_UES       1000000
+#define TEST_NB_PROFILES  4
+
+static void build_profile(apn_config_profile_t * const profile, const int variant)
+{
+    memset(profile, 0xA5, sizeof(*profile)); // garbage in the unused bytes, as left by the S6A decoder
+    profile->context_identifier = 1;
+    profile->all_apn_conf_ind = ALL_APN_CONFIGURATIONS_INCLUDED;
+    profile->nb_apns = 1;
+    profile->apn_configuration[0].context_identifier = 1;
+    profile->apn_configuration[0].nb_ip_address = 0;
+    profile->apn_configuration[0].pdn_type = IPv4;
+    profile->apn_configuration[0].service_selection_length = snprintf(profile->apn_configuration[0].service_selection,
+                                                                       APN_MAX_LENGTH, "apn%d.operator.com", variant);
+    profile->apn_configuration[0].subscribed_qos.qci = 9;
+    profile->apn_configuration[0].subscribed_qos.allocation_retention_priority.priority_level = 15;
+    profile->apn_configuration[0].ambr.br_ul = 50000000;
+    profile->apn_configuration[0].ambr.br_dl = 100000000;
+}
+
+START_TEST(profile_sharing_test)
+{
+    static const apn_config_profile_t *ue_profiles[TEST_NB_UES];
+    apn_config_profile_t profile;
+    subscription_profile_stats_t stats;
+    int i;
+
+    ck_assert(subscription_profile_init(SUBSCRIPTION_PROFILE_HTBL_SIZE) == RETURNok);
+
+    /* Every UE decodes its own copy of one of a few profiles */
+    for (i = 0; i < TEST_NB_UES; i++) {
+        build_profile(&profile, i % TEST_NB_PROFILES);
+        ue_profiles[i] = subscription_profile_intern(&profile);
+        ck_assert(ue_profiles[i] != NULL);
+    }
+    for (i = TEST_NB_PROFILES; i < TEST_NB_UES; i++) {
+        ck_assert(ue_profiles[i] == ue_profiles[i % TEST_NB_PROFILES]);
+    }
+
+    subscription_profile_get_stats(&stats);
+    ck_assert_uint_eq(stats.nb_profiles, TEST_NB_PROFILES);
+    ck_assert_uint_eq(stats.nb_references, TEST_NB_UES);
+    printf("%d UEs: %" PRIu64 " bytes of shared profiles + %zu bytes of references, instead of %zu bytes of copies\n",
+           TEST_NB_UES, stats.bytes, TEST_NB_UES * sizeof(ue_profiles[0]), TEST_NB_UES * sizeof(apn_config_profile_t));
+
+    for (i = 0; i < TEST_NB_UES; i++) {
+        subscription_profile_release(&ue_profiles[i]);
+        ck_assert(ue_profiles[i] == NULL);
+    }
+    subscription_profile_get_stats(&stats);
+    ck_assert_uint_eq(stats.nb_profiles, 0);
+    ck_assert_uint_eq(stats.nb_references, 0);
+    subscription_profile_exit();
+}
+END_TEST
+
+START_TEST(profile_copy_on_write_test)
+{
+    const apn_config_profile_t *ue_a = NULL;
+    const apn_config_profile_t *ue_b = NULL;
+    const apn_config_profile_t *shared = NULL;
+    apn_config_profile_t profile;
+    apn_config_profile_t changes;
+    subscription_profile_stats_t stats;
+
+    ck_assert(subscription_profile_init(SUBSCRIPTION_PROFILE_HTBL_SIZE) == RETURNok);
+
+    build_profile(&profile, 0);
+    ue_a = subscription_profile_intern(&profile);
+    ue_b = subscription_profile_intern(&profile);
+    ck_assert(ue_a == ue_b);
+    shared = ue_b;
+
+    /* Insert Subscriber Data for UE a: APN 1 modified, APN 2 added */
+    build_profile(&changes, 1);
+    changes.all_apn_conf_ind = MODIFIED_ADDED_APN_CONFIGURATIONS_INCLUDED;
+    changes.nb_apns = 2;
+    changes.apn_configuration[1] = changes.apn_configuration[0];
+    changes.apn_configuration[1].context_identifier = 2;
+    changes.apn_configuration[0].ambr.br_dl = 200000000;
+    subscription_profile_update(&ue_a, &changes);
+
+    ck_assert(ue_a != shared);
+    ck_assert(ue_b == shared);
+    ck_assert_uint_eq(ue_a->nb_apns, 2);
+    ck_assert_uint_eq(ue_a->apn_configuration[0].ambr.br_dl, 200000000);
+    ck_assert_uint_eq(ue_a->apn_configuration[1].context_identifier, 2);
+    /* The profile still shared with UE b is untouched */
+    ck_assert_uint_eq(shared->nb_apns, 1);
+    ck_assert_uint_eq(shared->apn_configuration[0].ambr.br_dl, 100000000);
+
+    subscription_profile_get_stats(&stats);
+    ck_assert_uint_eq(stats.nb_profiles, 2);
+    ck_assert_uint_eq(stats.nb_references, 2);
+
+    /* The same change on UE b lands on the profile of UE a */
+    subscription_profile_update(&ue_b, &changes);
+    ck_assert(ue_a == ue_b);
+    subscription_profile_get_stats(&stats);
+    ck_assert_uint_eq(stats.nb_profiles, 1);
+    ck_assert_uint_eq(stats.nb_references, 2);
+
+    subscription_profile_release(&ue_a);
+    subscription_profile_release(&ue_b);
+    subscription_profile_exit();
+}
+END_TEST
+
+START_TEST(profile_release_after_exit_test)
+{
+    const apn_config_profile_t *ue_a = NULL;
+    const apn_config_profile_t *ue_b = NULL;
+    apn_config_profile_t profile;
+    subscription_profile_stats_t stats;
+
+    ck_assert(subscription_profile_init(SUBSCRIPTION_PROFILE_HTBL_SIZE) == RETURNok);
+    build_profile(&profile, 0);
+    ue_a = subscription_profile_intern(&profile);
+
+    /* A UE context still holds its profile when the store exits: the profile stays readable */
+    subscription_profile_exit();
+    ck_assert_uint_eq(ue_a->apn_configuration[0].ambr.br_dl, 100000000);
+
+    /* The same profile in a new store is a new one, releasing the old one leaves it indexed */
+    ck_assert(subscription_profile_init(SUBSCRIPTION_PROFILE_HTBL_SIZE) == RETURNok);
+    ue_b = subscription_profile_intern(&profile);
+    subscription_profile_release(&ue_a);
+    ck_assert(ue_a == NULL);
+    ue_a = subscription_profile_intern(&profile);
+    ck_assert(ue_a == ue_b);
+
+    subscription_profile_get_stats(&stats);
+    ck_assert_uint_eq(stats.nb_profiles, 1);
+    ck_assert_uint_eq(stats.nb_references, 2);
+    subscription_profile_release(&ue_a);
+    subscription_profile_release(&ue_b);
+    subscription_profile_exit();
+}
+END_TEST
+
+Suite * subscription_profile_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Subscription profile tests");
+
+    /* Core test case */
+    tc_core = tcase_create("Subscription profile test");
+    tcase_set_timeout(tc_core, 60);
+    tcase_add_test(tc_core, profile_sharing_test);
+    tcase_add_test(tc_core, profile_copy_on_write_test);
+    tcase_add_test(tc_core, profile_release_after_exit_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = subscription_profile_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,122 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+#include "queue.h"
+#include "hashtable.h"
+#include "obj_hashtable.h"
+#include "common_defs.h"
+#include "intertask_interface.h"
+#include "sgw_ie_defs.h"
+#include "3gpp_23.401.h"
+#include "sgw_defs.h"
+#include "spgw_config.h"
+#include "sgw.h"
+#include "pgw_lite_paa.h"
+
+/* Owned by sgw_task.c and spgw_config.c, not linked here */
+pgw_app_t     pgw_app;
+spgw_config_t spgw_config;
+
+/* 192.168.10.0/29 and 10.0.0.0/24 bound to the APN "ims" */
+static void load_pools(void)
+{
+    memset(&spgw_config, 0, sizeof(spgw_config));
+    inet_aton("192.168.10.0", &spgw_config.pgw_config.ue_pool_addr[0]);
+    spgw_config.pgw_config.ue_pool_mask[0] = 29;
+    inet_aton("10.0.0.0", &spgw_config.pgw_config.ue_pool_addr[1]);
+    spgw_config.pgw_config.ue_pool_mask[1] = 24;
+    spgw_config.pgw_config.ue_pool_apn[1] = bfromcstr("ims");
+    spgw_config.pgw_config.num_ue_pool = 2;
+    pgw_load_pool_ip_addresses();
+}
+
+static void free_pools(void)
+{
+    pgw_free_pool_ip_addresses();
+    bdestroy(spgw_config.pgw_config.ue_pool_apn[1]);
+}
+
+START_TEST(pool_select_test)
+{
+    load_pools();
+    ck_assert_int_eq(pgw_select_ue_ipv4_pool("ims"), 1);
+    ck_assert_int_eq(pgw_select_ue_ipv4_pool("IMS"), 1);
+    ck_assert_int_eq(pgw_select_ue_ipv4_pool("internet"), 0);
+    ck_assert_int_eq(pgw_select_ue_ipv4_pool(NULL), 0);
+    free_pools();
+}
+END_TEST
+
+START_TEST(pool_round_trip_test)
+{
+    /* .0 network, .1 GTP device and .7 broadcast are never given */
+    const char *expected[] = {"192.168.10.2", "192.168.10.3", "192.168.10.4", "192.168.10.5", "192.168.10.6"};
+    struct in_addr addrs[5];
+    struct in_addr addr;
+    int i;
+
+    load_pools();
+    for (i = 0; i < 5; i++) {
+        ck_assert_int_eq(pgw_get_free_ipv4_paa_address(0, &addrs[i]), RETURNok);
+        /* network byte order, as struct in_addr is everywhere else */
+        ck_assert_str_eq(inet_ntoa(addrs[i]), expected[i]);
+    }
+    ck_assert_int_eq(pgw_get_free_ipv4_paa_address(0, &addr), RETURNerror);
+
+    /* What get returns is what release takes */
+    for (i = 0; i < 5; i++) {
+        ck_assert_int_eq(pgw_release_free_ipv4_paa_address(&addrs[i]), RETURNok);
+    }
+    ck_assert_int_eq(pgw_release_free_ipv4_paa_address(&addrs[0]), RETURNerror);
+    inet_aton("192.168.10.7", &addr);
+    ck_assert_int_eq(pgw_release_free_ipv4_paa_address(&addr), RETURNerror);
+
+    ck_assert_int_eq(pgw_get_free_ipv4_paa_address(0, &addr), RETURNok);
+    ck_assert_int_eq(pgw_release_free_ipv4_paa_address(&addr), RETURNok);
+
+    /* The APN pool gives its own addresses */
+    ck_assert_int_eq(pgw_get_free_ipv4_paa_address(1, &addr), RETURNok);
+    ck_assert_str_eq(inet_ntoa(addr), "10.0.0.2");
+    ck_assert_int_eq(pgw_release_free_ipv4_paa_address(&addr), RETURNok);
+    free_pools();
+}
+END_TEST
+
+Suite * pgw_ue_ipv4_pool_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("PGW UE IPv4 pool tests");
+
+    /* Core test case */
+    tc_core = tcase_create("PGW UE IPv4 pool test");
+    tcase_add_test(tc_core, pool_select_test);
+    tcase_add_test(tc_core, pool_round_trip_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = pgw_ue_ipv4_pool_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
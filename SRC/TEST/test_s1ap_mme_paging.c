@@ -0,0 +1,404 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bstrlib.h"
+#include "log.h"
+#include "intertask_interface_init.h"
+#include "timer.h"
+#include "conversions.h"
+#include "mme_config.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme.h"
+#include "s1ap_mme_paging.h"
+
+#define TEST_NB_ENBS        4
+#define TEST_MAX_SENT       16
+
+/* eNB 1 serves TACs 1 and 2, eNB 2 TAC 2, eNB 3 TAC 3, eNB 4 TAC 1 but is not S1 ready */
+static enb_description_t test_enbs[TEST_NB_ENBS];
+
+/* PAGING sent to the SCTP task, in the order they were sent */
+typedef struct test_sent_s {
+    int nb_sent;
+    sctp_assoc_id_t assoc_id[TEST_MAX_SENT];
+    bstring pdu;
+} test_sent_t;
+
+static void test_set_enb_tacs(enb_description_t *enb, const uint16_t *tacs, int nb_tacs)
+{
+    S1ap_SupportedTAs_t supported_tas = {0};
+    S1ap_SupportedTAs_Item_t ta[4];
+    S1ap_PLMNidentity_t plmn = {0};
+
+    memset(ta, 0, sizeof(ta));
+    MCC_MNC_TO_TBCD(208, 93, 2, &plmn);
+    for (int i = 0; i < nb_tacs; i++) {
+        TAC_TO_ASN1(tacs[i], &ta[i].tAC);
+        ASN_SEQUENCE_ADD(&ta[i].broadcastPLMNs, &plmn);
+        ASN_SEQUENCE_ADD(&supported_tas, &ta[i]);
+    }
+    ck_assert_int_eq(s1ap_paging_update_enb_tais(enb, &supported_tas), RETURNok);
+    for (int i = 0; i < nb_tacs; i++) {
+        ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_TAC, &ta[i].tAC);
+        free(ta[i].broadcastPLMNs.list.array);
+    }
+    ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_PLMNidentity, &plmn);
+    free(supported_tas.list.array);
+}
+
+static void test_set_tai(tai_t *tai, uint16_t tac)
+{
+    tai->plmn.mcc_digit1 = 2;
+    tai->plmn.mcc_digit2 = 0;
+    tai->plmn.mcc_digit3 = 8;
+    tai->plmn.mnc_digit1 = 9;
+    tai->plmn.mnc_digit2 = 3;
+    tai->plmn.mnc_digit3 = 0x0F;
+    tai->tac = tac;
+}
+
+static void test_build_request(itti_s1ap_paging_request_t *request, uint32_t m_tmsi, const uint16_t *tacs, int nb_tacs)
+{
+    memset(request, 0, sizeof(*request));
+    request->mme_ue_s1ap_id = m_tmsi;
+    request->imsi64 = 208930000001234ULL;
+    request->mme_code = 1;
+    request->m_tmsi = m_tmsi;
+    request->cn_domain = S1AP_CN_DOMAIN_PS;
+    request->last_visited_tai.tac = INVALID_TAC_0000;
+    request->tai_list.n_tais = nb_tacs;
+    for (int i = 0; i < nb_tacs; i++) {
+        test_set_tai(&request->tai_list.tai[i], tacs[i]);
+    }
+}
+
+/* Drain the SCTP task queue, the first PDU is kept for decoding */
+static void test_collect(test_sent_t *sent)
+{
+    MessageDef *message_p = NULL;
+
+    memset(sent, 0, sizeof(*sent));
+    for (itti_poll_msg(TASK_SCTP, &message_p); message_p; itti_poll_msg(TASK_SCTP, &message_p)) {
+        ck_assert(sent->nb_sent < TEST_MAX_SENT);
+        sent->assoc_id[sent->nb_sent++] = SCTP_DATA_REQ(message_p).assoc_id;
+        if (!sent->pdu) {
+            sent->pdu = SCTP_DATA_REQ(message_p).payload;
+        } else {
+            bdestroy(SCTP_DATA_REQ(message_p).payload);
+        }
+        itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
+        message_p = NULL;
+    }
+}
+
+static void test_release(test_sent_t *sent)
+{
+    bdestroy(sent->pdu);
+    sent->pdu = NULL;
+}
+
+static int test_sent_to(const test_sent_t *sent, sctp_assoc_id_t assoc_id)
+{
+    int n = 0;
+
+    for (int i = 0; i < sent->nb_sent; i++) {
+        n += (sent->assoc_id[i] == assoc_id);
+    }
+    return n;
+}
+
+static void test_setup_enbs(void)
+{
+    static const uint16_t tacs_1[] = {1, 2};
+    static const uint16_t tacs_2[] = {2};
+    static const uint16_t tacs_3[] = {3};
+    static const uint16_t tacs_4[] = {1};
+
+    memset(test_enbs, 0, sizeof(test_enbs));
+    for (int i = 0; i < TEST_NB_ENBS; i++) {
+        test_enbs[i].enb_id = i + 1;
+        test_enbs[i].sctp_assoc_id = i + 1;
+        test_enbs[i].s1_state = S1AP_READY;
+    }
+    test_enbs[3].s1_state = S1AP_INIT;
+    test_set_enb_tacs(&test_enbs[0], tacs_1, 2);
+    test_set_enb_tacs(&test_enbs[1], tacs_2, 1);
+    test_set_enb_tacs(&test_enbs[2], tacs_3, 1);
+    test_set_enb_tacs(&test_enbs[3], tacs_4, 1);
+}
+
+static void test_teardown_enbs(void)
+{
+    for (int i = 0; i < TEST_NB_ENBS; i++) {
+        s1ap_paging_remove_enb(&test_enbs[i]);
+    }
+}
+
+START_TEST(paging_ta_index_test)
+{
+    static const uint16_t tacs_12[] = {1, 2};
+    static const uint16_t tacs_2[] = {2};
+    static const uint16_t tacs_3[] = {3};
+    itti_s1ap_paging_request_t request;
+    test_sent_t sent;
+
+    mme_config.s1ap_config.paging_timer_ms = 4000;
+    mme_config.s1ap_config.paging_max_attempts = 1;
+    mme_config.s1ap_config.max_paging_per_enb_per_sec = 0;
+    test_setup_enbs();
+
+    /* eNB 1 serves both TAIs and gets the PAGING once, eNB 4 is not S1 ready */
+    test_build_request(&request, 1, tacs_12, 2);
+    ck_assert_int_eq(s1ap_handle_paging_request(&request), RETURNok);
+    test_collect(&sent);
+    ck_assert_int_eq(sent.nb_sent, 2);
+    ck_assert_int_eq(test_sent_to(&sent, 1), 1);
+    ck_assert_int_eq(test_sent_to(&sent, 2), 1);
+    test_release(&sent);
+
+    /* Paged again while being paged: nothing sent */
+    ck_assert_int_eq(s1ap_handle_paging_request(&request), RETURNok);
+    test_collect(&sent);
+    ck_assert_int_eq(sent.nb_sent, 0);
+    s1ap_paging_stop(request.mme_code, request.m_tmsi);
+
+    /* ENB CONFIGURATION UPDATE: eNB 1 now only serves TAC 3 */
+    test_set_enb_tacs(&test_enbs[0], tacs_3, 1);
+    test_build_request(&request, 2, tacs_12, 2);
+    ck_assert_int_eq(s1ap_handle_paging_request(&request), RETURNok);
+    test_collect(&sent);
+    ck_assert_int_eq(sent.nb_sent, 1);
+    ck_assert_int_eq(test_sent_to(&sent, 2), 1);
+    test_release(&sent);
+    s1ap_paging_stop(request.mme_code, request.m_tmsi);
+
+    /* eNB 2 association lost: no eNB left for TAC 2 */
+    s1ap_paging_remove_enb(&test_enbs[1]);
+    ck_assert(test_enbs[1].supported_tai == NULL);
+    test_build_request(&request, 3, tacs_2, 1);
+    ck_assert_int_eq(s1ap_handle_paging_request(&request), RETURNok);
+    test_collect(&sent);
+    ck_assert_int_eq(sent.nb_sent, 0);
+    s1ap_paging_stop(request.mme_code, request.m_tmsi);
+
+    test_teardown_enbs();
+}
+END_TEST
+
+START_TEST(paging_attempts_test)
+{
+    static const uint16_t tacs_123[] = {1, 2, 3};
+    itti_s1ap_paging_request_t request;
+    test_sent_t sent;
+
+    mme_config.s1ap_config.paging_timer_ms = 50;
+    mme_config.s1ap_config.paging_max_attempts = 2;
+    mme_config.s1ap_config.max_paging_per_enb_per_sec = 0;
+    test_setup_enbs();
+
+    /* First attempt on the last visited TAI only */
+    test_build_request(&request, 4, tacs_123, 3);
+    test_set_tai(&request.last_visited_tai, 3);
+    ck_assert_int_eq(s1ap_handle_paging_request(&request), RETURNok);
+    test_collect(&sent);
+    ck_assert_int_eq(sent.nb_sent, 1);
+    ck_assert_int_eq(test_sent_to(&sent, 3), 1);
+    test_release(&sent);
+
+    /* Not expired yet */
+    s1ap_paging_tick();
+    test_collect(&sent);
+    ck_assert_int_eq(sent.nb_sent, 0);
+
+    /* Second attempt on the whole TAI list, then the UE is given up */
+    usleep(100000);
+    s1ap_paging_tick();
+    test_collect(&sent);
+    ck_assert_int_eq(sent.nb_sent, 3);
+    test_release(&sent);
+    usleep(100000);
+    s1ap_paging_tick();
+    test_collect(&sent);
+    ck_assert_int_eq(sent.nb_sent, 0);
+
+    /* A UE that answers is not paged again */
+    test_build_request(&request, 5, tacs_123, 3);
+    ck_assert_int_eq(s1ap_handle_paging_request(&request), RETURNok);
+    test_collect(&sent);
+    test_release(&sent);
+    s1ap_paging_stop(request.mme_code, request.m_tmsi);
+    usleep(100000);
+    s1ap_paging_tick();
+    test_collect(&sent);
+    ck_assert_int_eq(sent.nb_sent, 0);
+
+    test_teardown_enbs();
+}
+END_TEST
+
+/* Decode a PAGING sent to an eNB, the IEs are freed with the PDU by test_free_paging() */
+static void test_decode_paging(const_bstring pdu, S1AP_PDU_t *pdu_p, S1ap_PagingIEs_t *paging)
+{
+    asn_dec_rval_t dec_ret;
+
+    memset(pdu_p, 0, sizeof(*pdu_p));
+    memset(paging, 0, sizeof(*paging));
+    dec_ret = aper_decode(NULL, &asn_DEF_S1AP_PDU, (void **)&pdu_p, bdata(pdu), blength(pdu), 0, 0);
+    ck_assert_int_eq(dec_ret.code, RC_OK);
+    ck_assert_int_eq(pdu_p->present, S1AP_PDU_PR_initiatingMessage);
+    ck_assert_int_eq(pdu_p->choice.initiatingMessage.procedureCode, S1ap_ProcedureCode_id_Paging);
+    ck_assert_int_eq(s1ap_decode_s1ap_pagingies(paging, &pdu_p->choice.initiatingMessage.value), 0);
+}
+
+static void test_free_paging(S1AP_PDU_t *pdu_p, S1ap_PagingIEs_t *paging)
+{
+    ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_UEIdentityIndexValue, &paging->ueIdentityIndexValue);
+    ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1ap_UEPagingID, &paging->uePagingID);
+    for (int i = 0; i < paging->taiList.s1ap_TAIItem.count; i++) {
+        ASN_STRUCT_FREE(asn_DEF_S1ap_TAIItem, paging->taiList.s1ap_TAIItem.array[i]);
+    }
+    free(paging->taiList.s1ap_TAIItem.array);
+    ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1AP_PDU, pdu_p);
+}
+
+START_TEST(paging_encoder_test)
+{
+    static const uint16_t tacs_3[] = {3};
+    static const uint8_t plmn[3] = {0x02, 0xF8, 0x39};
+    /* 208930000001234 */
+    static const uint8_t imsi[8] = {0x02, 0x98, 0x03, 0x00, 0x00, 0x10, 0x32, 0xF4};
+    itti_s1ap_paging_request_t request;
+    test_sent_t sent;
+    S1AP_PDU_t pdu;
+    S1ap_PagingIEs_t paging;
+    const uint16_t index_value = (uint16_t)(208930000001234ULL % 1024);
+    uint32_t m_tmsi = 0;
+    uint16_t tac = 0;
+    const S1ap_TAIItem_t *tai_item = NULL;
+
+    mme_config.s1ap_config.paging_timer_ms = 4000;
+    mme_config.s1ap_config.paging_max_attempts = 1;
+    mme_config.s1ap_config.max_paging_per_enb_per_sec = 0;
+    test_setup_enbs();
+
+    /* S-TMSI paging */
+    test_build_request(&request, 0x12345678, tacs_3, 1);
+    ck_assert_int_eq(s1ap_handle_paging_request(&request), RETURNok);
+    test_collect(&sent);
+    ck_assert_int_eq(sent.nb_sent, 1);
+    test_decode_paging(sent.pdu, &pdu, &paging);
+
+    ck_assert_int_eq(paging.ueIdentityIndexValue.size, 2);
+    ck_assert_int_eq(paging.ueIdentityIndexValue.bits_unused, 6);
+    ck_assert_int_eq((paging.ueIdentityIndexValue.buf[0] << 2) | (paging.ueIdentityIndexValue.buf[1] >> 6), index_value);
+    ck_assert_int_eq(paging.uePagingID.present, S1ap_UEPagingID_PR_s_TMSI);
+    ck_assert_int_eq(paging.uePagingID.choice.s_TMSI.mMEC.size, 1);
+    ck_assert_int_eq(paging.uePagingID.choice.s_TMSI.mMEC.buf[0], 1);
+    ck_assert_int_eq(paging.uePagingID.choice.s_TMSI.m_TMSI.size, 4);
+    BUFFER_TO_INT32(paging.uePagingID.choice.s_TMSI.m_TMSI.buf, m_tmsi);
+    ck_assert_int_eq(m_tmsi, 0x12345678);
+    ck_assert_int_eq(paging.cnDomain, S1ap_CNDomain_ps);
+    ck_assert_int_eq(paging.taiList.s1ap_TAIItem.count, 1);
+    tai_item = (const S1ap_TAIItem_t *)paging.taiList.s1ap_TAIItem.array[0];
+    ck_assert_int_eq(tai_item->tAI.pLMNidentity.size, 3);
+    ck_assert(memcmp(tai_item->tAI.pLMNidentity.buf, plmn, 3) == 0);
+    BUFFER_TO_INT16(tai_item->tAI.tAC.buf, tac);
+    ck_assert_int_eq(tac, 3);
+    test_free_paging(&pdu, &paging);
+    test_release(&sent);
+    s1ap_paging_stop(request.mme_code, request.m_tmsi);
+
+    /* IMSI paging: 15 digits in TBCD, filler in the last octet */
+    test_build_request(&request, 0x12345679, tacs_3, 1);
+    request.is_imsi_paging = true;
+    ck_assert_int_eq(s1ap_handle_paging_request(&request), RETURNok);
+    test_collect(&sent);
+    ck_assert_int_eq(sent.nb_sent, 1);
+    test_decode_paging(sent.pdu, &pdu, &paging);
+
+    ck_assert_int_eq(paging.uePagingID.present, S1ap_UEPagingID_PR_iMSI);
+    ck_assert_int_eq(paging.uePagingID.choice.iMSI.size, 8);
+    ck_assert(memcmp(paging.uePagingID.choice.iMSI.buf, imsi, 8) == 0);
+    test_free_paging(&pdu, &paging);
+    test_release(&sent);
+
+    test_teardown_enbs();
+}
+END_TEST
+
+Suite * s1ap_paging_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("S1AP paging tests");
+
+    /* Core test case */
+    tc_core = tcase_create("S1AP paging test");
+    tcase_set_timeout(tc_core, 60);
+    tcase_add_test(tc_core, paging_ta_index_test);
+    tcase_add_test(tc_core, paging_attempts_test);
+    tcase_add_test(tc_core, paging_encoder_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    if (OAILOG_INIT(LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) < 0) {
+        return EXIT_FAILURE;
+    }
+    if (itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info, NULL, NULL) < 0) {
+        return EXIT_FAILURE;
+    }
+    if (timer_init() < 0) {
+        return EXIT_FAILURE;
+    }
+    /* The PAGING are read back from the SCTP task queue */
+    itti_mark_task_ready(TASK_SCTP);
+    if (s1ap_paging_init(&mme_config) != RETURNok) {
+        return EXIT_FAILURE;
+    }
+
+    s = s1ap_paging_suite();
+    sr = srunner_create(s);
+    /* the ITTI queues and the paging contexts live in this process */
+    srunner_set_fork_status(sr, CK_NOFORK);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,249 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file udp_mmsg.c
+  \brief UDP endpoint owned by a task, batched receive and send with recvmmsg/sendmmsg
+
+  Replaces the TASK_UDP hop for the tasks that own their socket: no copy of the
+  received datagrams in ITTI messages, no socket list lookup and mutex per
+  datagram, one system call per batch in both directions.
+*/
+
+#ifndef _GNU_SOURCE
+#  define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "assertions.h"
+#include "log.h"
+#include "conversions.h"
+#include "common_defs.h"
+#include "udp_mmsg.h"
+
+// receive drains at most this number of batches per call, leaving room for ITTI messages
+#define UDP_MMSG_MAX_RX_BATCHES  4
+#define UDP_MMSG_SOCKET_BUFFER   (4 * 1024 * 1024)
+
+struct udp_mmsg_endpoint_s {
+  int                                     sd;
+  bool                                    is_owner;   // false: sends on the socket of another endpoint
+  int                                     batch_size;
+
+  // receive pool
+  struct mmsghdr                          rx_msg[UDP_MMSG_BATCH_SIZE];
+  struct iovec                            rx_iov[UDP_MMSG_BATCH_SIZE];
+  struct sockaddr_in                      rx_addr[UDP_MMSG_BATCH_SIZE];
+  uint8_t                                 rx_buffer[UDP_MMSG_BATCH_SIZE][UDP_MMSG_BUFFER_SIZE];
+
+  // send queue
+  int                                     nb_tx;
+  struct mmsghdr                          tx_msg[UDP_MMSG_BATCH_SIZE];
+  struct iovec                            tx_iov[UDP_MMSG_BATCH_SIZE];
+  struct sockaddr_in                      tx_addr[UDP_MMSG_BATCH_SIZE];
+  uint8_t                                 tx_buffer[UDP_MMSG_BATCH_SIZE][UDP_MMSG_BUFFER_SIZE];
+};
+
+//------------------------------------------------------------------------------
+static udp_mmsg_endpoint_t *udp_mmsg_endpoint_alloc (const int sd, const int batch_size)
+{
+  udp_mmsg_endpoint_t                    *endpoint_p = calloc (1, sizeof (udp_mmsg_endpoint_t));
+
+  DevAssert (endpoint_p != NULL);
+  endpoint_p->sd = sd;
+  endpoint_p->batch_size = ((0 < batch_size) && (UDP_MMSG_BATCH_SIZE >= batch_size)) ? batch_size : UDP_MMSG_BATCH_SIZE;
+
+  for (int i = 0; i < UDP_MMSG_BATCH_SIZE; i++) {
+    endpoint_p->rx_iov[i].iov_base = endpoint_p->rx_buffer[i];
+    endpoint_p->rx_iov[i].iov_len = UDP_MMSG_BUFFER_SIZE;
+    endpoint_p->rx_msg[i].msg_hdr.msg_iov = &endpoint_p->rx_iov[i];
+    endpoint_p->rx_msg[i].msg_hdr.msg_iovlen = 1;
+    endpoint_p->rx_msg[i].msg_hdr.msg_name = &endpoint_p->rx_addr[i];
+    endpoint_p->tx_iov[i].iov_base = endpoint_p->tx_buffer[i];
+    endpoint_p->tx_msg[i].msg_hdr.msg_iov = &endpoint_p->tx_iov[i];
+    endpoint_p->tx_msg[i].msg_hdr.msg_iovlen = 1;
+    endpoint_p->tx_msg[i].msg_hdr.msg_name = &endpoint_p->tx_addr[i];
+    endpoint_p->tx_msg[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_in);
+  }
+
+  return endpoint_p;
+}
+
+//------------------------------------------------------------------------------
+udp_mmsg_endpoint_t *udp_mmsg_endpoint_create (const uint32_t address, const uint16_t port, const int batch_size)
+{
+  struct sockaddr_in                      addr = {0};
+  udp_mmsg_endpoint_t                    *endpoint_p = NULL;
+  int                                     sd = -1;
+  int                                     size = UDP_MMSG_SOCKET_BUFFER;
+
+  OAILOG_DEBUG (LOG_UDP, "Creating UDP endpoint on address " IPV4_ADDR " and port %u\n", IPV4_ADDR_FORMAT (address), port);
+
+  if ((sd = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0) {
+    OAILOG_ERROR (LOG_UDP, "Socket creation failed (%s)\n", strerror (errno));
+    return NULL;
+  }
+
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons (port);
+  addr.sin_addr.s_addr = address;
+
+  if (bind (sd, (struct sockaddr *)&addr, sizeof (struct sockaddr_in)) < 0) {
+    OAILOG_ERROR (LOG_UDP, "Socket bind failed (%s) for address " IPV4_ADDR " and port %u\n", strerror (errno), IPV4_ADDR_FORMAT (address), port);
+    close (sd);
+    return NULL;
+  }
+
+  if (fcntl (sd, F_SETFL, O_NONBLOCK) < 0) {
+    OAILOG_ERROR (LOG_UDP, "fcntl F_SETFL O_NONBLOCK failed: %s\n", strerror (errno));
+    close (sd);
+    return NULL;
+  }
+
+  // bursts of signalling, not fatal if the system limits are lower
+  if ((setsockopt (sd, SOL_SOCKET, SO_RCVBUF, &size, sizeof (size)) < 0) ||
+      (setsockopt (sd, SOL_SOCKET, SO_SNDBUF, &size, sizeof (size)) < 0)) {
+    OAILOG_WARNING (LOG_UDP, "Failed to set socket buffers to %d bytes: %s\n", size, strerror (errno));
+  }
+
+  endpoint_p = udp_mmsg_endpoint_alloc (sd, batch_size);
+  endpoint_p->is_owner = true;
+  return endpoint_p;
+}
+
+//------------------------------------------------------------------------------
+udp_mmsg_endpoint_t *udp_mmsg_endpoint_share (const udp_mmsg_endpoint_t * const owner_p, const int batch_size)
+{
+  if ((!owner_p) || (!owner_p->is_owner)) {
+    return NULL;
+  }
+  return udp_mmsg_endpoint_alloc (owner_p->sd, batch_size);
+}
+
+//------------------------------------------------------------------------------
+void udp_mmsg_endpoint_destroy (udp_mmsg_endpoint_t * const endpoint_p)
+{
+  if (endpoint_p) {
+    udp_mmsg_flush (endpoint_p);
+    if (endpoint_p->is_owner) {
+      close (endpoint_p->sd);
+    }
+    free (endpoint_p);
+  }
+}
+
+//------------------------------------------------------------------------------
+int udp_mmsg_endpoint_get_fd (const udp_mmsg_endpoint_t * const endpoint_p)
+{
+  return endpoint_p->sd;
+}
+
+//------------------------------------------------------------------------------
+int udp_mmsg_receive (udp_mmsg_endpoint_t * const endpoint_p, udp_mmsg_rx_cb_t rx_cb, void *arg)
+{
+  int                                     nb_received = 0;
+
+  for (int batch = 0; batch < UDP_MMSG_MAX_RX_BATCHES; batch++) {
+    int                                   nb_msg = 0;
+
+    for (int i = 0; i < endpoint_p->batch_size; i++) {
+      endpoint_p->rx_msg[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_in);
+    }
+
+    nb_msg = recvmmsg (endpoint_p->sd, endpoint_p->rx_msg, endpoint_p->batch_size, MSG_DONTWAIT, NULL);
+    if (nb_msg <= 0) {
+      if ((nb_msg < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+        OAILOG_ERROR (LOG_UDP, "recvmmsg failed on sd %d: %s\n", endpoint_p->sd, strerror (errno));
+      }
+      break;
+    }
+
+    for (int i = 0; i < nb_msg; i++) {
+      if (endpoint_p->rx_msg[i].msg_hdr.msg_flags & MSG_TRUNC) {
+        OAILOG_ERROR (LOG_UDP, "Datagram from " IPV4_ADDR " truncated to %d bytes, discarded\n",
+            IPV4_ADDR_FORMAT (endpoint_p->rx_addr[i].sin_addr.s_addr), UDP_MMSG_BUFFER_SIZE);
+        continue;
+      }
+      rx_cb (arg, endpoint_p->rx_buffer[i], endpoint_p->rx_msg[i].msg_len, endpoint_p->rx_addr[i].sin_addr.s_addr, ntohs (endpoint_p->rx_addr[i].sin_port));
+    }
+    nb_received += nb_msg;
+
+    if (nb_msg < endpoint_p->batch_size) {
+      break;
+    }
+  }
+  return nb_received;
+}
+
+//------------------------------------------------------------------------------
+int udp_mmsg_send (udp_mmsg_endpoint_t * const endpoint_p, const uint8_t * const buffer, const uint32_t length,
+                   const uint32_t peer_address, const uint16_t peer_port)
+{
+  int                                     i = 0;
+
+  if (UDP_MMSG_BUFFER_SIZE < length) {
+    OAILOG_ERROR (LOG_UDP, "Datagram of %u bytes to " IPV4_ADDR " too long\n", length, IPV4_ADDR_FORMAT (peer_address));
+    return RETURNerror;
+  }
+
+  if (endpoint_p->nb_tx >= endpoint_p->batch_size) {
+    udp_mmsg_flush (endpoint_p);
+  }
+
+  i = endpoint_p->nb_tx++;
+  memcpy (endpoint_p->tx_buffer[i], buffer, length);
+  endpoint_p->tx_iov[i].iov_len = length;
+  endpoint_p->tx_addr[i].sin_family = AF_INET;
+  endpoint_p->tx_addr[i].sin_port = htons (peer_port);
+  endpoint_p->tx_addr[i].sin_addr.s_addr = peer_address;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int udp_mmsg_flush (udp_mmsg_endpoint_t * const endpoint_p)
+{
+  int                                     nb_sent = 0;
+
+  while (nb_sent < endpoint_p->nb_tx) {
+    int                                   rc = sendmmsg (endpoint_p->sd, &endpoint_p->tx_msg[nb_sent], endpoint_p->nb_tx - nb_sent, 0);
+
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // non blocking socket with a full send buffer, GTPv2-C retransmissions recover from the loss
+      OAILOG_ERROR (LOG_UDP, "sendmmsg failed on sd %d, %d datagrams dropped: %s\n", endpoint_p->sd, endpoint_p->nb_tx - nb_sent, strerror (errno));
+      break;
+    }
+    nb_sent += rc;
+  }
+  endpoint_p->nb_tx = 0;
+  return nb_sent;
+}
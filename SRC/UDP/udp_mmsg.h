@@ -0,0 +1,77 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file udp_mmsg.h
+  \brief UDP endpoint owned by a task, batched receive and send with recvmmsg/sendmmsg
+*/
+
+#ifndef FILE_UDP_MMSG_SEEN
+#define FILE_UDP_MMSG_SEEN
+
+#include <stdint.h>
+
+#define UDP_MMSG_BATCH_SIZE   64    ///< Max datagrams per recvmmsg/sendmmsg
+#define UDP_MMSG_BUFFER_SIZE  4096  ///< Max datagram size
+
+/* Called for each datagram received, buffer is only valid during the call */
+typedef void (*udp_mmsg_rx_cb_t) (void *arg, uint8_t * buffer, uint32_t length, uint32_t peer_address, uint16_t peer_port);
+
+typedef struct udp_mmsg_endpoint_s udp_mmsg_endpoint_t;
+
+/** \brief Create a non blocking UDP socket bound to address:port with its receive and send buffer pools.
+ * The owner task has to add the socket to its epoll set (itti_subscribe_event_fd).
+ * \param address     Local IPv4 address, network byte order
+ * \param port        Local port, host byte order
+ * \param batch_size  Datagrams per system call (1..UDP_MMSG_BATCH_SIZE)
+ * @returns NULL on error
+ **/
+udp_mmsg_endpoint_t *udp_mmsg_endpoint_create(const uint32_t address, const uint16_t port, const int batch_size);
+
+/** \brief Create an endpoint sending on the socket of owner_p, with its own send queue, for another task than the owner.
+ * sendmmsg on the same socket from several threads is safe, only the owner receives.
+ * The owner has to be destroyed after all its shared endpoints.
+ * @returns NULL on error
+ **/
+udp_mmsg_endpoint_t *udp_mmsg_endpoint_share(const udp_mmsg_endpoint_t * const owner_p, const int batch_size);
+
+void udp_mmsg_endpoint_destroy(udp_mmsg_endpoint_t * const endpoint_p);
+
+int udp_mmsg_endpoint_get_fd(const udp_mmsg_endpoint_t * const endpoint_p);
+
+/** \brief Drain the socket with recvmmsg, rx_cb is called for each datagram, from the pooled buffers (no copy)
+ * @returns number of datagrams received
+ **/
+int udp_mmsg_receive(udp_mmsg_endpoint_t * const endpoint_p, udp_mmsg_rx_cb_t rx_cb, void *arg);
+
+/** \brief Queue a datagram, buffer is copied. The queue is flushed when full.
+ * \param peer_address  IPv4 address, network byte order
+ * \param peer_port     Port, host byte order
+ * @returns RETURNok or RETURNerror
+ **/
+int udp_mmsg_send(udp_mmsg_endpoint_t * const endpoint_p, const uint8_t * const buffer, const uint32_t length,
+                  const uint32_t peer_address, const uint16_t peer_port);
+
+/** \brief Send the queued datagrams with sendmmsg, to be called at the end of each event loop iteration
+ * @returns number of datagrams sent
+ **/
+int udp_mmsg_flush(udp_mmsg_endpoint_t * const endpoint_p);
+
+#endif /* FILE_UDP_MMSG_SEEN */
@@ -31,6 +31,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#if defined(__SSE4_2__) && defined(__x86_64__)
+#  include <nmmintrin.h>
+#endif
 #include "dynamic_memory_check.h"
 #include "hashtable.h"
 #include "assertions.h"
@@ -81,16 +84,65 @@ hashtable_rc_code2string (
 
 void hash_free_int_func (void **memoryP) {}
 
+//------------------------------------------------------------------------------
+/*
+   Hash functions
+   hash_mix64() is the finalizer of MurmurHash3, every bit of the key changes about half of the bits of the result,
+   so keys having their entropy in few bits (TEIDs, packed identities) still spread on all the buckets.
+   hash_bytes() hashes a buffer with CRC32C when SSE4.2 is available, with FNV-1a otherwise, then goes through
+   hash_mix64().
+*/
+hash_size_t hash_mix64 (uint64_t key)
+{
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return (hash_size_t) key;
+}
+
+//------------------------------------------------------------------------------
+hash_size_t hash_bytes (const void * const buffer, const size_t length)
+{
+  const uint8_t                          *p = (const uint8_t *)buffer;
+  size_t                                  remaining = length;
+#if defined(__SSE4_2__) && defined(__x86_64__)
+  uint64_t                                crc = UINT32_MAX;
+  uint64_t                                word = 0;
+
+  while (remaining >= sizeof (word)) {
+    memcpy (&word, p, sizeof (word));
+    crc = _mm_crc32_u64 (crc, word);
+    p += sizeof (word);
+    remaining -= sizeof (word);
+  }
+  while (remaining) {
+    crc = _mm_crc32_u8 ((uint32_t)crc, *p++);
+    remaining--;
+  }
+  return hash_mix64 ((crc << 32) ^ crc ^ length);
+#else
+  uint64_t                                hash = 0xcbf29ce484222325ULL;
+
+  while (remaining) {
+    hash ^= *p++;
+    hash *= 0x100000001b3ULL;
+    remaining--;
+  }
+  return hash_mix64 (hash);
+#endif
+}
+
 //------------------------------------------------------------------------------
 /*
    Default hash function
    def_hashfunc() is the default used by hashtable_create() when the user didn't specify one.
-   This is a simple/naive hash function which adds the key's ASCII char values. It will probably generate lots of collisions on large hash tables.
 */
 
 static inline hash_size_t def_hashfunc (const uint64_t keyP)
 {
-  return (hash_size_t) keyP;
+  return hash_mix64 (keyP);
 }
 
 //------------------------------------------------------------------------------
@@ -691,11 +743,12 @@ hashtable_ts_insert (
   __sync_fetch_and_add (&hashtblP->num_elements, 1);
   pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) next %p return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP, dataP, node->next);
-#define TEMPORARY_DEBUG 1
-#if TEMPORARY_DEBUG
+#if TRACE_HASHTABLE
+  // walks the whole table, only when tracing
   bstring b = bfromcstr(" ");
   hashtable_ts_dump_content(hashtblP, b);
   PRINT_HASHTABLE (hashtblP, "%s:%s\n", bdata(hashtblP->name), bdata(b));
+  bdestroy(b);
 #endif
   return HASH_TABLE_OK;
 }
@@ -892,6 +945,55 @@ hashtable_ts_remove (
   return HASH_TABLE_KEY_NOT_EXISTS;
 }
 
+//------------------------------------------------------------------------------
+/*
+   Removes the node only if it still holds dataP. Tables keyed by a lossy key (GUTI) use it so that
+   a UE never unlinks the entry another UE inserted later under the same key.
+*/
+hashtable_rc_t
+hashtable_ts_remove_if_element (
+  hash_table_ts_t * const hashtblP,
+  const hash_key_t keyP,
+  void * const dataP)
+{
+  hash_node_t                            *node,
+                                         *prevnode = NULL;
+  hash_size_t                             hash = 0;
+
+  if (!hashtblP) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+
+  hash = hashtblP->hashfunc (keyP) % hashtblP->size;
+  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
+  node = hashtblP->nodes[hash];
+
+  while (node) {
+    if (node->key == keyP) {
+      if (node->data != dataP) {
+        break;
+      }
+      if (prevnode)
+        prevnode->next = node->next;
+      else
+        hashtblP->nodes[hash] = node->next;
+
+      free_wrapper((void **) &node);
+      __sync_fetch_and_sub (&hashtblP->num_elements, 1);
+      pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
+      PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
+      return HASH_TABLE_OK;
+    }
+
+    prevnode = node;
+    node = node->next;
+  }
+  pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
+
+  PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return KEY_NOT_EXISTS\n", __FUNCTION__, bdata(hashtblP->name), keyP);
+  return HASH_TABLE_KEY_NOT_EXISTS;
+}
+
 
 //------------------------------------------------------------------------------
 /*
@@ -967,11 +1069,12 @@ hashtable_ts_get (
   pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return KEY_NOT_EXISTS\n", __FUNCTION__, bdata(hashtblP->name), keyP);
 
-#define TEMPORARY_DEBUG 1
-#if TEMPORARY_DEBUG
+#if TRACE_HASHTABLE
+  // walks the whole table, only when tracing
   bstring b = bfromcstr(" ");
   hashtable_ts_dump_content(hashtblP, b);
   PRINT_HASHTABLE (hashtblP, "%s:%s\n", bdata(hashtblP->name), bdata(b));
+  bdestroy(b);
 #endif
   return HASH_TABLE_KEY_NOT_EXISTS;
 }
@@ -984,8 +1087,7 @@ hashtable_ts_get (
    If the number of elements are reduced, the hash table will waste memory. That is why we provide a function for resizing the table.
    Resizing a hash table is not as easy as a realloc(). All hash values must be recalculated and each element must be inserted into its new position.
    We create a temporary hash_table_t object (newtbl) to be used while building the new hashes.
-   This allows us to reuse hashtable_insert() and hashtable_free(), when moving the elements to the new table.
-   After that, we can just free_wrapper the old table and copy the elements from newtbl to hashtbl.
+   The nodes are relinked into the buckets of newtbl, then we can just free_wrapper the old buckets and copy the ones of newtbl to hashtbl.
 */
 
 hashtable_rc_t
@@ -995,9 +1097,9 @@ hashtable_resize (
 {
   hash_table_t                            newtbl;
   hash_size_t                             n;
+  hash_size_t                             hash = 0;
   hash_node_t                            *node,
                                          *next;
-  void                                   *dummy = NULL;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
@@ -1027,12 +1129,13 @@ hashtable_resize (
   if (!(newtbl.nodes = calloc (size, sizeof (hash_node_t *))))
     return -1;
 
-
+  // the nodes are moved, not reallocated: num_elements does not change
   for (n = 0; n < hashtblP->size; ++n) {
     for (node = hashtblP->nodes[n]; node; node = next) {
       next = node->next;
-      hashtable_remove (hashtblP, node->key, &dummy);
-      hashtable_insert (&newtbl, node->key, node->data);
+      hash = newtbl.hashfunc (node->key) % newtbl.size;
+      node->next = newtbl.nodes[hash];
+      newtbl.nodes[hash] = node;
     }
   }
 
@@ -1051,8 +1154,7 @@ hashtable_resize (
    If the number of elements are reduced, the hash table will waste memory. That is why we provide a function for resizing the table.
    Resizing a hash table is not as easy as a realloc(). All hash values must be recalculated and each element must be inserted into its new position.
    We create a temporary hash_table_t object (newtbl) to be used while building the new hashes.
-   This allows us to reuse hashtable_insert() and hashtable_free(), when moving the elements to the new table.
-   After that, we can just free_wrapper the old table and copy the elements from newtbl to hashtbl.
+   The nodes are relinked into the buckets of newtbl, then we can just free_wrapper the old buckets and copy the ones of newtbl to hashtbl.
    Dangerous not really thread safe.
 */
 
@@ -1063,9 +1165,9 @@ hashtable_ts_resize (
 {
   hash_table_ts_t                         newtbl = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0};
   hash_size_t                             n      = 0;
+  hash_size_t                             hash   = 0;
   hash_node_t                            *node   = NULL,
                                          *next   = NULL;
-  void                                   *dummy  = NULL;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
@@ -1099,17 +1201,23 @@ hashtable_ts_resize (
     free_wrapper((void **) &newtbl.nodes);
     return HASH_TABLE_SYSTEM_ERROR;
   }
-  for (n = 0; n < hashtblP->size; ++n) {
+  for (n = 0; n < size; ++n) {
     pthread_mutex_init(&newtbl.lock_nodes[n], NULL);
   }
 
   pthread_mutex_lock(&hashtblP->mutex);
+  // the nodes are moved, not reallocated: num_elements does not change
   for (n = 0; n < hashtblP->size; ++n) {
+    pthread_mutex_lock(&hashtblP->lock_nodes[n]);
     for (node = hashtblP->nodes[n]; node; node = next) {
       next = node->next;
-      hashtable_ts_remove (hashtblP, node->key, &dummy);
-      hashtable_ts_insert (&newtbl, node->key, node->data);
+      hash = newtbl.hashfunc (node->key) % newtbl.size;
+      node->next = newtbl.nodes[hash];
+      newtbl.nodes[hash] = node;
     }
+    hashtblP->nodes[n] = NULL;
+    pthread_mutex_unlock(&hashtblP->lock_nodes[n]);
+    pthread_mutex_destroy(&hashtblP->lock_nodes[n]);
   }
 
   free_wrapper((void **) &hashtblP->nodes);
@@ -1120,3 +1228,94 @@ hashtable_ts_resize (
   pthread_mutex_unlock(&hashtblP->mutex);
   return HASH_TABLE_OK;
 }
+
+//------------------------------------------------------------------------------
+/*
+   Statistics
+   A lookup of a present key visits on average (L+1)/2 nodes of a chain of length L, a lookup of an absent key visits the
+   whole chain.
+*/
+void hashtable_stats_add_chain (hashtable_stats_t * const stats, const hash_size_t chain_length)
+{
+  if (chain_length) {
+    stats->num_used_buckets += 1;
+    stats->num_elements     += chain_length;
+    stats->avg_probes_hit   += (double)chain_length * (double)(chain_length + 1) / 2.0;
+    if (chain_length > stats->max_chain_length) {
+      stats->max_chain_length = chain_length;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void hashtable_stats_finalize (hashtable_stats_t * const stats)
+{
+  if (stats->num_elements) {
+    stats->avg_probes_hit = stats->avg_probes_hit / (double)stats->num_elements;
+  }
+  if (stats->size) {
+    stats->avg_probes_miss = (double)stats->num_elements / (double)stats->size;
+  }
+}
+
+//------------------------------------------------------------------------------
+void hashtable_stats_display (const hashtable_stats_t * const stats, bstring name, bstring str)
+{
+  bformata (str, "%s: %zu elements in %zu/%zu buckets, max chain %zu, probes hit %.2f miss %.2f\n",
+      bdata(name), stats->num_elements, stats->num_used_buckets, stats->size, stats->max_chain_length,
+      stats->avg_probes_hit, stats->avg_probes_miss);
+}
+
+//------------------------------------------------------------------------------
+hashtable_rc_t
+hashtable_get_stats (
+  const hash_table_t * const hashtblP,
+  hashtable_stats_t * const statsP)
+{
+  hash_node_t                            *node = NULL;
+
+  if (!hashtblP) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+
+  memset (statsP, 0, sizeof (*statsP));
+  statsP->size = hashtblP->size;
+  for (hash_size_t i = 0; i < hashtblP->size; i++) {
+    hash_size_t                           chain_length = 0;
+
+    for (node = hashtblP->nodes[i]; node; node = node->next) {
+      chain_length += 1;
+    }
+    hashtable_stats_add_chain (statsP, chain_length);
+  }
+  hashtable_stats_finalize (statsP);
+  return HASH_TABLE_OK;
+}
+
+//------------------------------------------------------------------------------
+hashtable_rc_t
+hashtable_ts_get_stats (
+  const hash_table_ts_t * const hashtblP,
+  hashtable_stats_t * const statsP)
+{
+  hash_node_t                            *node = NULL;
+
+  if (!hashtblP) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+
+  memset (statsP, 0, sizeof (*statsP));
+  statsP->size = hashtblP->size;
+  for (hash_size_t i = 0; i < hashtblP->size; i++) {
+    hash_size_t                           chain_length = 0;
+
+    pthread_mutex_lock (&hashtblP->lock_nodes[i]);
+    for (node = hashtblP->nodes[i]; node; node = node->next) {
+      chain_length += 1;
+    }
+    pthread_mutex_unlock (&hashtblP->lock_nodes[i]);
+    hashtable_stats_add_chain (statsP, chain_length);
+  }
+  hashtable_stats_finalize (statsP);
+  return HASH_TABLE_OK;
+}
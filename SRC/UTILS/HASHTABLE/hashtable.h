@@ -89,6 +89,23 @@ typedef struct hash_table_ts_s {
     bool                log_enabled;
 } hash_table_ts_t;
 
+/* Occupancy of a hashtable, hashtable_*_get_stats() walk all the buckets, not for the fast path */
+typedef struct hashtable_stats_s {
+    hash_size_t         size;                    // number of buckets
+    hash_size_t         num_elements;
+    hash_size_t         num_used_buckets;
+    hash_size_t         max_chain_length;
+    double              avg_probes_hit;          // nodes visited by the lookup of a present key
+    double              avg_probes_miss;         // nodes visited by the lookup of an absent key
+} hashtable_stats_t;
+
+hash_size_t     hash_mix64(uint64_t key) __attribute__ ((const));
+hash_size_t     hash_bytes(const void * const buffer, const size_t length) __attribute__ ((pure));
+
+void            hashtable_stats_add_chain(hashtable_stats_t * const stats, const hash_size_t chain_length);
+void            hashtable_stats_finalize(hashtable_stats_t * const stats);
+void            hashtable_stats_display(const hashtable_stats_t * const stats, bstring name, bstring str);
+
 char*           hashtable_rc_code2string(hashtable_rc_t rc);
 void            hash_free_int_func(void** memory);
 hash_table_t * hashtable_init (hash_table_t * const hashtbl,const hash_size_t size,hash_size_t (*hashfunc) (const
@@ -107,6 +124,7 @@ hashtable_rc_t  hashtable_free (hash_table_t * const hashtbl, const hash_key_t k
 hashtable_rc_t  hashtable_remove(hash_table_t * const hashtbl, const hash_key_t key, void** element);
 hashtable_rc_t  hashtable_get    (const hash_table_t * const hashtbl, const hash_key_t key, void **element) __attribute__ ((hot));
 hashtable_rc_t  hashtable_resize (hash_table_t * const hashtbl, const hash_size_t size);
+hashtable_rc_t  hashtable_get_stats (const hash_table_t * const hashtbl, hashtable_stats_t * const stats);
 
 // Thread-safe functions
 hash_table_ts_t * hashtable_ts_init (hash_table_ts_t * const hashtbl,const hash_size_t size,hash_size_t (*hashfunc)
@@ -123,8 +141,10 @@ hashtable_rc_t  hashtable_ts_dump_content (const hash_table_ts_t * const hashtbl
 hashtable_rc_t  hashtable_ts_insert (hash_table_ts_t * const hashtbl, const hash_key_t key, void *element);
 hashtable_rc_t  hashtable_ts_free (hash_table_ts_t * const hashtbl, const hash_key_t key);
 hashtable_rc_t  hashtable_ts_remove(hash_table_ts_t * const hashtbl, const hash_key_t key, void** element);
+hashtable_rc_t  hashtable_ts_remove_if_element(hash_table_ts_t * const hashtbl, const hash_key_t key, void * const element);
 hashtable_rc_t  hashtable_ts_get    (const hash_table_ts_t * const hashtbl, const hash_key_t key, void **element) __attribute__ ((hot));
 hashtable_rc_t  hashtable_ts_resize (hash_table_ts_t * const hashtbl, const hash_size_t size);
+hashtable_rc_t  hashtable_ts_get_stats (const hash_table_ts_t * const hashtbl, hashtable_stats_t * const stats);
 
 #endif
 
@@ -54,7 +54,6 @@ obj_hashtable_no_free_key_callback (
 /*
    Default hash function
    def_hashfunc() is the default used by hashtable_create() when the user didn't specify one.
-   This is a simple/naive hash function which adds the key's ASCII char values. It will probably generate lots of collisions on large hash tables.
 */
 
 static                                  hash_size_t
@@ -62,12 +61,7 @@ def_hashfunc (
   const void *const keyP,
   int key_sizeP)
 {
-  hash_size_t                             hash = 0;
-
-  while (key_sizeP)
-    hash ^= ((unsigned char *)keyP)[--key_sizeP];
-
-  return hash;
+  return hash_bytes (keyP, (size_t)key_sizeP);
 }
 
 //------------------------------------------------------------------------------
@@ -1147,3 +1141,57 @@ obj_hashtable_ts_resize (
   PRINT_HASHTABLE (hashtblP, "return OK\n");
   return HASH_TABLE_OK;
 }
+
+//------------------------------------------------------------------------------
+hashtable_rc_t
+obj_hashtable_get_stats (
+  const obj_hash_table_t * const hashtblP,
+  hashtable_stats_t * const statsP)
+{
+  obj_hash_node_t                        *node = NULL;
+
+  if (!hashtblP) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+
+  memset (statsP, 0, sizeof (*statsP));
+  statsP->size = hashtblP->size;
+  for (hash_size_t i = 0; i < hashtblP->size; i++) {
+    hash_size_t                           chain_length = 0;
+
+    for (node = hashtblP->nodes[i]; node; node = node->next) {
+      chain_length += 1;
+    }
+    hashtable_stats_add_chain (statsP, chain_length);
+  }
+  hashtable_stats_finalize (statsP);
+  return HASH_TABLE_OK;
+}
+
+//------------------------------------------------------------------------------
+hashtable_rc_t
+obj_hashtable_ts_get_stats (
+  const obj_hash_table_t * const hashtblP,
+  hashtable_stats_t * const statsP)
+{
+  obj_hash_node_t                        *node = NULL;
+
+  if (!hashtblP) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+
+  memset (statsP, 0, sizeof (*statsP));
+  statsP->size = hashtblP->size;
+  for (hash_size_t i = 0; i < hashtblP->size; i++) {
+    hash_size_t                           chain_length = 0;
+
+    pthread_mutex_lock (&hashtblP->lock_nodes[i]);
+    for (node = hashtblP->nodes[i]; node; node = node->next) {
+      chain_length += 1;
+    }
+    pthread_mutex_unlock (&hashtblP->lock_nodes[i]);
+    hashtable_stats_add_chain (statsP, chain_length);
+  }
+  hashtable_stats_finalize (statsP);
+  return HASH_TABLE_OK;
+}
@@ -71,6 +71,7 @@ hashtable_rc_t      obj_hashtable_remove(obj_hash_table_t *hashtblP, const void*
 hashtable_rc_t      obj_hashtable_get     (const obj_hash_table_t * const hashtblP, const void* const keyP, const int key_sizeP, void ** dataP) __attribute__ ((hot));
 hashtable_rc_t      obj_hashtable_get_keys(const obj_hash_table_t * const hashtblP, void ** keysP, unsigned int * sizeP);
 hashtable_rc_t      obj_hashtable_resize  (obj_hash_table_t * const hashtblP, const hash_size_t sizeP);
+hashtable_rc_t      obj_hashtable_get_stats (const obj_hash_table_t * const hashtblP, hashtable_stats_t * const statsP);
 
 // Thread-safe functions
 obj_hash_table_t   *obj_hashtable_ts_init (obj_hash_table_t * const hashtblP, const hash_size_t sizeP, hash_size_t
@@ -87,6 +88,7 @@ hashtable_rc_t      obj_hashtable_ts_remove(obj_hash_table_t *hashtblP, const vo
 hashtable_rc_t      obj_hashtable_ts_get     (const obj_hash_table_t * const hashtblP, const void* const keyP, const int key_sizeP, void ** dataP) __attribute__ ((hot));
 hashtable_rc_t      obj_hashtable_ts_get_keys(const obj_hash_table_t * const hashtblP, void ** keysP, unsigned int * sizeP);
 hashtable_rc_t      obj_hashtable_ts_resize  (obj_hash_table_t * const hashtblP, const hash_size_t sizeP);
+hashtable_rc_t      obj_hashtable_ts_get_stats (const obj_hash_table_t * const hashtblP, hashtable_stats_t * const statsP);
 
 #endif
 
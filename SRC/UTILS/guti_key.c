@@ -0,0 +1,98 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file guti_key.c
+  \brief GUTI packed in an integer hashtable key, one key per GUTI
+
+  The PLMN table only grows. Lookups read it without lock: a PLMN is written
+  before the count that makes it visible is published, the lock is only taken
+  to add one.
+*/
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "common_defs.h"
+#include "common_types.h"
+#include "guti_key.h"
+
+// the 6 BCD digits of the PLMN
+#define GUTI_KEY_PLMN(PlMn_PtR) \
+  ((uint32_t)((((PlMn_PtR)->mcc_digit2 << 4) | (PlMn_PtR)->mcc_digit1) << 16) | \
+   (uint32_t)((((PlMn_PtR)->mnc_digit3 << 4) | (PlMn_PtR)->mcc_digit3) << 8) |  \
+   (uint32_t)(((PlMn_PtR)->mnc_digit2 << 4) | (PlMn_PtR)->mnc_digit1))
+#define GUTI_KEY(InDeX, GuTi_PtR) \
+  ((guti_key_t)((((uint64_t)(InDeX)) << 56) |                      \
+                (((uint64_t)(GuTi_PtR)->gummei.mme_gid) << 40) |   \
+                (((uint64_t)(GuTi_PtR)->gummei.mme_code) << 32) |  \
+                ((uint64_t)(GuTi_PtR)->m_tmsi)))
+
+static uint32_t                         guti_key_plmns[GUTI_KEY_PLMNS_MAX];
+static uint32_t                         guti_key_nb_plmns = 0;
+static pthread_mutex_t                  guti_key_plmns_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//------------------------------------------------------------------------------
+static int guti_key_plmn_index (const uint32_t plmn, const uint32_t nb_plmns)
+{
+  for (uint32_t i = 0; i < nb_plmns; i++) {
+    if (guti_key_plmns[i] == plmn) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+guti_key_t guti_key (const guti_t * const guti)
+{
+  const int                               index = guti_key_plmn_index (GUTI_KEY_PLMN(&guti->gummei.plmn),
+                                                                       __atomic_load_n (&guti_key_nb_plmns, __ATOMIC_ACQUIRE));
+
+  if (index < 0) {
+    return INVALID_GUTI_KEY;
+  }
+  return GUTI_KEY(index, guti);
+}
+
+//------------------------------------------------------------------------------
+int guti_key_new (const guti_t * const guti, guti_key_t * const key)
+{
+  const uint32_t                          plmn = GUTI_KEY_PLMN(&guti->gummei.plmn);
+  int                                     index = guti_key_plmn_index (plmn, __atomic_load_n (&guti_key_nb_plmns, __ATOMIC_ACQUIRE));
+
+  if (index < 0) {
+    pthread_mutex_lock (&guti_key_plmns_mutex);
+    // another thread may have added it since
+    index = guti_key_plmn_index (plmn, guti_key_nb_plmns);
+    if ((index < 0) && (guti_key_nb_plmns < GUTI_KEY_PLMNS_MAX)) {
+      index = (int)guti_key_nb_plmns;
+      guti_key_plmns[index] = plmn;
+      __atomic_store_n (&guti_key_nb_plmns, guti_key_nb_plmns + 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock (&guti_key_plmns_mutex);
+    if (index < 0) {
+      *key = INVALID_GUTI_KEY;
+      return RETURNerror;
+    }
+  }
+  *key = GUTI_KEY(index, guti);
+  return RETURNok;
+}
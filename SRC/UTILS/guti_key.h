@@ -0,0 +1,47 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file guti_key.h
+  \brief GUTI packed in an integer hashtable key, one key per GUTI
+*/
+
+#ifndef FILE_GUTI_KEY_SEEN
+#define FILE_GUTI_KEY_SEEN
+
+#include <stdint.h>
+#include "common_types.h"
+
+/* The key holds the M-TMSI in bits 0..31, the MMEC in bits 32..39, the MMEGI in bits 40..55
+ * and in bits 56..63 the index of the PLMN in a process wide table. A PLMN gets its index
+ * the first time a GUTI of it is inserted and keeps it until the process exits, so two
+ * GUTIs never share a key.
+ */
+#define GUTI_KEY_PLMNS_MAX       (255)
+// key of a GUTI whose PLMN has no index: never inserted, its lookups miss
+#define INVALID_GUTI_KEY         UINT64_MAX
+
+// Key to look up or remove a GUTI, INVALID_GUTI_KEY if no GUTI of its PLMN was ever inserted
+guti_key_t guti_key (const guti_t * const guti) __attribute__ ((hot));
+
+// Key to insert a GUTI, gives its PLMN an index if needed, RETURNerror when all the indexes are taken
+int guti_key_new (const guti_t * const guti, guti_key_t * const key);
+
+#endif /* FILE_GUTI_KEY_SEEN */
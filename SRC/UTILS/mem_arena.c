@@ -0,0 +1,263 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mem_arena.c
+  \brief Bump allocator for objects that all die together, like the tree of a decoded PDU
+
+  Each allocation is preceded by a header holding its size so that a realloc
+  of the last block can grow in place and others can be copied. The first
+  chunk is allocated with the arena itself, a PDU decoded in an arena costs
+  one malloc and one free whatever the number of its IEs.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "assertions.h"
+#include "dynamic_memory_check.h"
+#include "mem_arena.h"
+
+#define MEM_ARENA_ALIGN(sIZE)   (((sIZE) + 15) & ~((size_t)15))
+
+typedef struct mem_arena_chunk_s {
+  struct mem_arena_chunk_s               *next;
+  size_t                                  size;        // bytes of data
+  size_t                                  used;
+  size_t                                  pad;
+  uint8_t                                 data[] __attribute__ ((aligned (16)));
+} mem_arena_chunk_t;
+
+typedef struct mem_arena_block_s {
+  size_t                                  size;        // requested bytes
+  size_t                                  pad;
+} mem_arena_block_t;
+
+struct mem_arena_s {
+  mem_arena_chunk_t                      *chunks;      // the one being filled first, the first one last
+  size_t                                  chunk_size;
+  mem_arena_chunk_t                       first;       // must be last, its data follows
+};
+
+static __thread mem_arena_t            *mem_arena_tls = NULL;
+static __thread mem_arena_stats_t       mem_arena_tls_stats = {0};
+
+//------------------------------------------------------------------------------
+mem_arena_t *mem_arena_create (const size_t chunk_size)
+{
+  const size_t                            size = MEM_ARENA_ALIGN (chunk_size ? chunk_size : MEM_ARENA_CHUNK_SIZE_DEFAULT);
+  mem_arena_t                            *arena = malloc (sizeof (mem_arena_t) + size);
+
+  if (arena) {
+    arena->chunk_size = size;
+    arena->first.next = NULL;
+    arena->first.size = size;
+    arena->first.used = 0;
+    arena->chunks = &arena->first;
+  }
+  return arena;
+}
+
+//------------------------------------------------------------------------------
+void mem_arena_reset (mem_arena_t * const arena)
+{
+  mem_arena_chunk_t                      *chunk = arena->chunks;
+
+  while (chunk != &arena->first) {
+    mem_arena_chunk_t                    *next = chunk->next;
+
+    free_wrapper ((void**) &chunk);
+    chunk = next;
+  }
+  arena->first.used = 0;
+  arena->chunks = &arena->first;
+}
+
+//------------------------------------------------------------------------------
+void mem_arena_destroy (mem_arena_t ** const arena)
+{
+  if (*arena) {
+    DevAssert (*arena != mem_arena_tls);
+    mem_arena_reset (*arena);
+    free_wrapper ((void**) arena);
+  }
+}
+
+//------------------------------------------------------------------------------
+void *mem_arena_alloc (mem_arena_t * const arena, const size_t size)
+{
+  const size_t                            needed = sizeof (mem_arena_block_t) + MEM_ARENA_ALIGN (size);
+  mem_arena_chunk_t                      *chunk = arena->chunks;
+  mem_arena_block_t                      *block = NULL;
+
+  if ((chunk->size - chunk->used) < needed) {
+    const size_t                          chunk_size = (needed > arena->chunk_size) ? needed : arena->chunk_size;
+
+    chunk = malloc (sizeof (mem_arena_chunk_t) + chunk_size);
+    if (!chunk) {
+      return NULL;
+    }
+    chunk->size = chunk_size;
+    chunk->used = 0;
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+  }
+  block = (mem_arena_block_t *)&chunk->data[chunk->used];
+  block->size = size;
+  chunk->used += needed;
+  return block + 1;
+}
+
+//------------------------------------------------------------------------------
+void *mem_arena_calloc (mem_arena_t * const arena, const size_t nmemb, const size_t size)
+{
+  void                                   *ptr = NULL;
+
+  if ((size) && (nmemb > SIZE_MAX / size)) {
+    return NULL;
+  }
+  ptr = mem_arena_alloc (arena, nmemb * size);
+  if (ptr) {
+    memset (ptr, 0, nmemb * size);
+  }
+  return ptr;
+}
+
+//------------------------------------------------------------------------------
+bool mem_arena_owns (const mem_arena_t * const arena, const void * const ptr)
+{
+  const mem_arena_chunk_t                *chunk = NULL;
+
+  if (!arena) {
+    return false;
+  }
+  for (chunk = arena->chunks; chunk; chunk = chunk->next) {
+    if (((const uint8_t *)ptr >= chunk->data) && ((const uint8_t *)ptr < &chunk->data[chunk->used])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+size_t mem_arena_used (const mem_arena_t * const arena)
+{
+  const mem_arena_chunk_t                *chunk = NULL;
+  size_t                                  used = 0;
+
+  for (chunk = arena->chunks; chunk; chunk = chunk->next) {
+    used += chunk->used;
+  }
+  return used;
+}
+
+//------------------------------------------------------------------------------
+mem_arena_t *mem_arena_enter (mem_arena_t * const arena)
+{
+  mem_arena_t                            *previous = mem_arena_tls;
+
+  mem_arena_tls = arena;
+  return previous;
+}
+
+//------------------------------------------------------------------------------
+void mem_arena_leave (mem_arena_t * const previous)
+{
+  mem_arena_tls = previous;
+}
+
+//------------------------------------------------------------------------------
+mem_arena_t *mem_arena_current (void)
+{
+  return mem_arena_tls;
+}
+
+//------------------------------------------------------------------------------
+void *mem_arena_hook_malloc (size_t size)
+{
+  if (mem_arena_tls) {
+    mem_arena_tls_stats.nb_arena_allocs += 1;
+    return mem_arena_alloc (mem_arena_tls, size);
+  }
+  mem_arena_tls_stats.nb_libc_allocs += 1;
+  return malloc (size);
+}
+
+//------------------------------------------------------------------------------
+void *mem_arena_hook_calloc (size_t nmemb, size_t size)
+{
+  if (mem_arena_tls) {
+    mem_arena_tls_stats.nb_arena_allocs += 1;
+    return mem_arena_calloc (mem_arena_tls, nmemb, size);
+  }
+  mem_arena_tls_stats.nb_libc_allocs += 1;
+  return calloc (nmemb, size);
+}
+
+//------------------------------------------------------------------------------
+void *mem_arena_hook_realloc (void *ptr, size_t size)
+{
+  mem_arena_block_t                      *block = NULL;
+  mem_arena_chunk_t                      *chunk = NULL;
+  void                                   *new_ptr = NULL;
+
+  if (!mem_arena_owns (mem_arena_tls, ptr)) {
+    if (ptr || !mem_arena_tls) {
+      mem_arena_tls_stats.nb_libc_allocs += 1;
+      return realloc (ptr, size);
+    }
+    return mem_arena_hook_malloc (size);
+  }
+  block = (mem_arena_block_t *)ptr - 1;
+  if (size <= MEM_ARENA_ALIGN (block->size)) {
+    block->size = size;
+    return ptr;
+  }
+  chunk = mem_arena_tls->chunks;
+  if (((uint8_t *)ptr + MEM_ARENA_ALIGN (block->size) == &chunk->data[chunk->used]) &&
+      ((chunk->size - chunk->used) >= (MEM_ARENA_ALIGN (size) - MEM_ARENA_ALIGN (block->size)))) {
+    // last block of the chunk being filled: grow in place
+    chunk->used += MEM_ARENA_ALIGN (size) - MEM_ARENA_ALIGN (block->size);
+    block->size = size;
+    return ptr;
+  }
+  mem_arena_tls_stats.nb_arena_allocs += 1;
+  new_ptr = mem_arena_alloc (mem_arena_tls, size);
+  if (new_ptr) {
+    memcpy (new_ptr, ptr, block->size);
+  }
+  return new_ptr;
+}
+
+//------------------------------------------------------------------------------
+void mem_arena_hook_free (void *ptr)
+{
+  if (!mem_arena_owns (mem_arena_tls, ptr)) {
+    free (ptr);
+  }
+}
+
+//------------------------------------------------------------------------------
+void mem_arena_thread_stats (mem_arena_stats_t * const stats)
+{
+  *stats = mem_arena_tls_stats;
+}
@@ -0,0 +1,71 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mem_arena.h
+  \brief Bump allocator for objects that all die together, like the tree of a decoded PDU
+*/
+
+#ifndef FILE_MEM_ARENA_SEEN
+#define FILE_MEM_ARENA_SEEN
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MEM_ARENA_CHUNK_SIZE_DEFAULT    (16 * 1024)
+
+typedef struct mem_arena_s mem_arena_t;
+
+typedef struct mem_arena_stats_s {
+  uint64_t  nb_arena_allocs;   // hooked allocations served by an arena
+  uint64_t  nb_libc_allocs;    // hooked allocations passed to the C library
+} mem_arena_stats_t;
+
+/* An arena is one malloc'd block, more chunks are chained when it is full.
+ * Memory is only given back by mem_arena_reset and mem_arena_destroy.
+ */
+mem_arena_t *mem_arena_create(const size_t chunk_size);
+void   mem_arena_destroy(mem_arena_t ** const arena);
+void   mem_arena_reset(mem_arena_t * const arena);
+void  *mem_arena_alloc(mem_arena_t * const arena, const size_t size) __attribute__ ((malloc));
+void  *mem_arena_calloc(mem_arena_t * const arena, const size_t nmemb, const size_t size) __attribute__ ((malloc));
+bool   mem_arena_owns(const mem_arena_t * const arena, const void * const ptr);
+size_t mem_arena_used(const mem_arena_t * const arena);
+
+/* Scope of the calling thread: until it is left, the allocations of the hooked
+ * libraries (asn1c) go to the arena entered last, freeing them is a no-op.
+ * Memory allocated in a scope must not be freed by the hooked libraries out of
+ * it, only destroying the arena releases it.
+ */
+mem_arena_t *mem_arena_enter(mem_arena_t * const arena);  // returns the arena to give back to mem_arena_leave
+void   mem_arena_leave(mem_arena_t * const previous);
+mem_arena_t *mem_arena_current(void);
+
+/* Allocation functions of the hooked libraries, see BUILD/TOOLS/generate_asn1 */
+void  *mem_arena_hook_malloc(size_t size);
+void  *mem_arena_hook_calloc(size_t nmemb, size_t size);
+void  *mem_arena_hook_realloc(void *ptr, size_t size);
+void   mem_arena_hook_free(void *ptr);
+
+/* Counters of the calling thread */
+void   mem_arena_thread_stats(mem_arena_stats_t * const stats);
+
+#endif /* FILE_MEM_ARENA_SEEN */
@@ -0,0 +1,295 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file metrics.c
+  \brief Counters and gauges registered by name, updated without lock by each thread, summed on read
+
+  A thread gets its block of values on its first update. Updating is a load and
+  a store in this block, the registry lock is only taken to register a series,
+  to attach a thread and to read. Blocks of exited threads are kept so that
+  counters never go back.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+#include "common_defs.h"
+#include "assertions.h"
+#include "dynamic_memory_check.h"
+#include "log.h"
+#include "metrics.h"
+
+#define METRICS_LABELS_MAX_LENGTH   (256)
+#define METRICS_REQUEST_MAX_LENGTH  (1024)
+
+typedef struct metrics_series_s {
+  char                                   *name;
+  char                                   *labels;      // "" when none
+  char                                   *help;
+  metric_type_t                           type;
+  metric_id_t                             next;        // next series of the family, -1: none
+  metric_id_t                             last;        // last series of the family, kept by its first one
+  bool                                    is_first;    // first series of its family, rendered with HELP and TYPE
+} metrics_series_t;
+
+static struct {
+  pthread_mutex_t                         mutex;
+  metric_id_t                             nb_series;
+  metrics_series_t                        series[METRICS_SERIES_MAX];
+  metrics_thread_t                       *threads;
+  int                                     server_sd;
+  pthread_t                               server_thread;
+} metrics = {.mutex = PTHREAD_MUTEX_INITIALIZER, .nb_series = 0, .threads = NULL, .server_sd = -1};
+
+__thread metrics_thread_t              *metrics_thread_tls = NULL;
+
+static const char                      *metric_type_str[] = {"counter", "gauge"};
+
+//------------------------------------------------------------------------------
+metric_id_t metrics_register (const char * const name, const metric_type_t type, const char * const help, const char * const labels_fmt, ...)
+{
+  char                                    labels[METRICS_LABELS_MAX_LENGTH] = {0};
+  metric_id_t                             family = -1;
+  metric_id_t                             id = 0;
+  va_list                                 args;
+
+  if (labels_fmt) {
+    va_start (args, labels_fmt);
+    vsnprintf (labels, sizeof (labels), labels_fmt, args);
+    va_end (args);
+  }
+
+  pthread_mutex_lock (&metrics.mutex);
+  for (id = 0; id < metrics.nb_series; id++) {
+    if (strcmp (metrics.series[id].name, name)) {
+      continue;
+    }
+    if (!strcmp (metrics.series[id].labels, labels)) {
+      pthread_mutex_unlock (&metrics.mutex);
+      return id;
+    }
+    if (metrics.series[id].is_first) {
+      family = id;
+    }
+  }
+  if (METRICS_SINK_ID <= metrics.nb_series) {
+    pthread_mutex_unlock (&metrics.mutex);
+    OAILOG_ERROR (LOG_UTIL, "Metrics: too many series (max %d), %s{%s} not exported\n", METRICS_SINK_ID, name, labels);
+    return METRICS_SINK_ID;
+  }
+  AssertFatal ((0 > family) || (metrics.series[family].type == type), "Metric %s registered as %s and %s\n",
+      name, metric_type_str[metrics.series[family].type], metric_type_str[type]);
+
+  id = metrics.nb_series;
+  metrics.series[id].name = strdup (name);
+  metrics.series[id].labels = strdup (labels);
+  metrics.series[id].help = strdup (help ? help : "");
+  metrics.series[id].type = type;
+  metrics.series[id].next = -1;
+  if (0 > family) {
+    metrics.series[id].is_first = true;
+    metrics.series[id].last = id;
+  } else {
+    metrics.series[metrics.series[family].last].next = id;
+    metrics.series[family].last = id;
+  }
+  metrics.nb_series++;
+  pthread_mutex_unlock (&metrics.mutex);
+  return id;
+}
+
+//------------------------------------------------------------------------------
+metrics_thread_t *metrics_thread_attach (void)
+{
+  metrics_thread_t                       *thread = NULL;
+
+  AssertFatal (0 == posix_memalign ((void **)&thread, 64, sizeof (metrics_thread_t)), "Cannot allocate the metrics of a thread\n");
+  memset (thread, 0, sizeof (metrics_thread_t));
+  pthread_mutex_lock (&metrics.mutex);
+  thread->next = metrics.threads;
+  metrics.threads = thread;
+  pthread_mutex_unlock (&metrics.mutex);
+  metrics_thread_tls = thread;
+  return thread;
+}
+
+//------------------------------------------------------------------------------
+int64_t metrics_get (const metric_id_t id)
+{
+  int64_t                                 value = 0;
+
+  pthread_mutex_lock (&metrics.mutex);
+  for (metrics_thread_t *thread = metrics.threads; thread; thread = thread->next) {
+    value += __atomic_load_n (&thread->value[id], __ATOMIC_RELAXED);
+  }
+  pthread_mutex_unlock (&metrics.mutex);
+  return value;
+}
+
+//------------------------------------------------------------------------------
+void metrics_render (bstring b)
+{
+  int64_t                                *values = NULL;
+  metric_id_t                             nb_series = 0;
+
+  pthread_mutex_lock (&metrics.mutex);
+  nb_series = metrics.nb_series;
+  values = calloc (nb_series + 1, sizeof (int64_t));
+  // one pass over each block, they are read in the order they are laid out
+  for (metrics_thread_t *thread = metrics.threads; thread; thread = thread->next) {
+    for (metric_id_t id = 0; id < nb_series; id++) {
+      values[id] += __atomic_load_n (&thread->value[id], __ATOMIC_RELAXED);
+    }
+  }
+  for (metric_id_t first = 0; first < nb_series; first++) {
+    const metrics_series_t               *family = &metrics.series[first];
+
+    if (!family->is_first) {
+      continue;
+    }
+    bformata (b, "# HELP %s %s\n# TYPE %s %s\n", family->name, family->help, family->name, metric_type_str[family->type]);
+    for (metric_id_t id = first; 0 <= id; id = metrics.series[id].next) {
+      if (metrics.series[id].labels[0]) {
+        bformata (b, "%s{%s} %" PRId64 "\n", family->name, metrics.series[id].labels, values[id]);
+      } else {
+        bformata (b, "%s %" PRId64 "\n", family->name, values[id]);
+      }
+    }
+  }
+  pthread_mutex_unlock (&metrics.mutex);
+  free_wrapper ((void **)&values);
+}
+
+//------------------------------------------------------------------------------
+static void metrics_server_send (const int sd, const_bstring response)
+{
+  int                                     sent = 0;
+
+  while (sent < blength (response)) {
+    ssize_t                               n = send (sd, bdata (response) + sent, blength (response) - sent, MSG_NOSIGNAL);
+
+    if (0 > n) {
+      if (EINTR == errno) {
+        continue;
+      }
+      OAILOG_WARNING (LOG_UTIL, "Metrics: send failed: %s\n", strerror (errno));
+      return;
+    }
+    sent += n;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void metrics_server_serve (const int sd)
+{
+  char                                    request[METRICS_REQUEST_MAX_LENGTH];
+  const size_t                            get_length = strlen ("GET " METRICS_SERVER_PATH);
+  struct timeval                          timeout = {.tv_sec = 1, .tv_usec = 0};
+  bstring                                 body = NULL;
+  bstring                                 response = NULL;
+  ssize_t                                 n = 0;
+
+  // A client that sends nothing does not hold the scrapes of the others
+  setsockopt (sd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+  setsockopt (sd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof (timeout));
+  n = recv (sd, request, sizeof (request) - 1, 0);
+  if (0 >= n) {
+    return;
+  }
+  request[n] = '\0';
+
+  if (strncmp (request, "GET " METRICS_SERVER_PATH, get_length) || ((' ' != request[get_length]) && ('?' != request[get_length]))) {
+    response = bfromcstr ("HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+  } else {
+    body = bfromcstralloc (64 * 1024, "");
+    metrics_render (body);
+    response = bformat ("HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %d\r\nConnection: close\r\n\r\n", blength (body));
+    bconcat (response, body);
+    bdestroy (body);
+  }
+  metrics_server_send (sd, response);
+  bdestroy (response);
+}
+
+//------------------------------------------------------------------------------
+static void *metrics_server_thread (__attribute__ ((unused)) void *args)
+{
+  while (1) {
+    int                                   sd = accept (metrics.server_sd, NULL, NULL);
+
+    if (0 > sd) {
+      if ((EINTR == errno) || (ECONNABORTED == errno)) {
+        continue;
+      }
+      OAILOG_ERROR (LOG_UTIL, "Metrics: accept failed: %s, no more scrapes\n", strerror (errno));
+      break;
+    }
+    metrics_server_serve (sd);
+    close (sd);
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+int metrics_server_start (const uint16_t port)
+{
+  struct sockaddr_in                      addr = {0};
+  int                                     reuse = 1;
+  int                                     sd = -1;
+
+  if (0 > (sd = socket (AF_INET, SOCK_STREAM, 0))) {
+    OAILOG_ERROR (LOG_UTIL, "Metrics: socket failed: %s\n", strerror (errno));
+    return RETURNerror;
+  }
+  setsockopt (sd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof (reuse));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons (port);
+  inet_pton (AF_INET, METRICS_SERVER_ADDRESS, &addr.sin_addr);
+
+  if ((0 > bind (sd, (struct sockaddr *)&addr, sizeof (addr))) || (0 > listen (sd, 16))) {
+    OAILOG_ERROR (LOG_UTIL, "Metrics: cannot listen on %s:%u: %s\n", METRICS_SERVER_ADDRESS, port, strerror (errno));
+    close (sd);
+    return RETURNerror;
+  }
+  metrics.server_sd = sd;
+
+  if (pthread_create (&metrics.server_thread, NULL, metrics_server_thread, NULL)) {
+    OAILOG_ERROR (LOG_UTIL, "Metrics: cannot create the server thread\n");
+    close (sd);
+    metrics.server_sd = -1;
+    return RETURNerror;
+  }
+  OAILOG_NOTICE (LOG_UTIL, "Metrics served on http://%s:%u%s\n", METRICS_SERVER_ADDRESS, port, METRICS_SERVER_PATH);
+  return RETURNok;
+}
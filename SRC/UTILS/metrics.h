@@ -0,0 +1,90 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file metrics.h
+  \brief Counters and gauges registered by name, updated without lock by each thread, summed on read
+*/
+
+#ifndef FILE_METRICS_SEEN
+#define FILE_METRICS_SEEN
+
+#include <stdint.h>
+#include "bstrlib.h"
+
+#define METRICS_SERIES_MAX        (2048)
+// Returned when the registry is full: updates land in it and it is never rendered
+#define METRICS_SINK_ID           (METRICS_SERIES_MAX - 1)
+#define METRICS_SERVER_ADDRESS    "127.0.0.1"
+#define METRICS_SERVER_PATH       "/metrics"
+
+typedef int32_t metric_id_t;
+
+typedef enum metric_type_e {
+  METRIC_COUNTER = 0,   // only goes up
+  METRIC_GAUGE,         // goes up and down, the sum of the additions of all threads
+} metric_type_t;
+
+/* Values of the series updated by one thread, only this thread writes them.
+ * The block is aligned on a cache line and its size is a multiple of it, no
+ * two threads ever write the same line. Blocks live until the process exits.
+ */
+typedef struct metrics_thread_s {
+  int64_t                   value[METRICS_SERIES_MAX];
+  struct metrics_thread_s  *next;
+} __attribute__ ((aligned (64))) metrics_thread_t;
+
+extern __thread metrics_thread_t *metrics_thread_tls;
+
+/* Series of a family share its name, help and type and differ by their labels:
+ * metrics_register ("mme_s1ap_messages_total", METRIC_COUNTER, "S1AP PDUs received",
+ *                   "procedure=\"%s\",result=\"%s\"", "S1Setup", "ok");
+ * Registering the same name and labels again returns the same id.
+ */
+metric_id_t metrics_register (const char * const name, const metric_type_t type, const char * const help, const char * const labels_fmt, ...)
+  __attribute__ ((format (printf, 4, 5)));
+
+metrics_thread_t *metrics_thread_attach (void);
+
+/* Sum over the threads, takes the registry lock but never blocks the updates */
+int64_t metrics_get (const metric_id_t id);
+
+/* All series in the Prometheus text exposition format, appended to b */
+void metrics_render (bstring b);
+
+/* HTTP server of metrics_render on METRICS_SERVER_ADDRESS:port, in its own thread */
+int metrics_server_start (const uint16_t port);
+
+//------------------------------------------------------------------------------
+static inline void metrics_add (const metric_id_t id, const int64_t value)
+{
+  metrics_thread_t *thread = metrics_thread_tls;
+
+  if (thread == NULL) {
+    thread = metrics_thread_attach ();
+  }
+  // Single writer: the atomics only keep the readers from seeing a torn value, no locked instruction
+  __atomic_store_n (&thread->value[id], __atomic_load_n (&thread->value[id], __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+#define metrics_inc(iD)  metrics_add ((iD), 1)
+#define metrics_dec(iD)  metrics_add ((iD), -1)
+
+#endif /* FILE_METRICS_SEEN */
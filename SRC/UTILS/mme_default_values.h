@@ -49,6 +49,28 @@
 
 #define S1AP_OUTCOME_TIMER_DEFAULT (5)     ///< S1AP Outcome drop timer (s)
 
+#define S1AP_PAGING_TIMER_MS_DEFAULT            (4000) ///< Paging retransmission timer, T3413 (ms)
+#define S1AP_PAGING_MAX_ATTEMPTS_DEFAULT        (3)    ///< Paging attempts before giving up on a UE
+#define S1AP_MAX_PAGING_PER_ENB_PER_SEC_DEFAULT (1000) ///< Paging messages sent to one eNB per second, 0: no limit
+
+/*******************************************************************************
+ * Overload control Constants
+ ******************************************************************************/
+
+#define OVERLOAD_CHECK_PERIOD_MS_DEFAULT     (500)   ///< Period of the task queues check (ms)
+#define OVERLOAD_QUEUE_DEPTH_HIGH_DEFAULT    (20000) ///< Messages queued in a task to enter overload
+#define OVERLOAD_QUEUE_DEPTH_LOW_DEFAULT     (2000)  ///< Messages queued in every task to leave overload
+#define OVERLOAD_QUEUE_DELAY_HIGH_MS_DEFAULT (500)   ///< Queueing delay of a task to enter overload (ms)
+#define OVERLOAD_QUEUE_DELAY_LOW_MS_DEFAULT  (50)    ///< Queueing delay of every task to leave overload (ms)
+#define OVERLOAD_ENB_PERCENT_DEFAULT         (100)   ///< Share of the eNBs receiving OVERLOAD START
+
+/*******************************************************************************
+ * Idle UE supervision Constants
+ ******************************************************************************/
+
+#define IMPLICIT_DETACH_JITTER_SEC_DEFAULT   (120)   ///< Implicit detach timers spread over [0..jitter] extra seconds
+#define MAX_IMPLICIT_DETACH_PER_SEC_DEFAULT  (200)   ///< Implicit detaches started per second, 0 for no pacing
+
 /*******************************************************************************
  * S6A Constants
  ******************************************************************************/
@@ -63,6 +85,7 @@
 #define SCTP_OUT_STREAMS      (32)
 #define SCTP_IN_STREAMS       (32)
 #define SCTP_MAX_ATTEMPTS     (5)
+#define SCTP_SEND_QUEUE_SIZE  (1024) // S1AP PDUs queued per association while its send window is full
 
 /*******************************************************************************
  * MME global definitions